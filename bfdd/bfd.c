@@ -430,30 +430,20 @@ struct bfd_session *ptm_bfd_sess_find(struct bfd_pkt *cp,
 	return bfd_key_lookup(key);
 }
 
-int bfd_xmt_cb(struct thread *t)
+void bfd_xmt_cb(struct bfd_session *bs)
 {
-	struct bfd_session *bs = THREAD_ARG(t);
-
 	ptm_bfd_xmt_TO(bs, 0);
-
-	return 0;
 }
 
-int bfd_echo_xmt_cb(struct thread *t)
+void bfd_echo_xmt_cb(struct bfd_session *bs)
 {
-	struct bfd_session *bs = THREAD_ARG(t);
-
 	if (bs->echo_xmt_TO > 0)
 		ptm_bfd_echo_xmt_TO(bs);
-
-	return 0;
 }
 
 /* Was ptm_bfd_detect_TO() */
-int bfd_recvtimer_cb(struct thread *t)
+void bfd_recvtimer_cb(struct bfd_session *bs)
 {
-	struct bfd_session *bs = THREAD_ARG(t);
-
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
 	case PTM_BFD_UP:
@@ -468,23 +458,17 @@ int bfd_recvtimer_cb(struct thread *t)
 		bs->discrs.remote_discr = 0;
 		break;
 	}
-
-	return 0;
 }
 
 /* Was ptm_bfd_echo_detect_TO() */
-int bfd_echo_recvtimer_cb(struct thread *t)
+void bfd_echo_recvtimer_cb(struct bfd_session *bs)
 {
-	struct bfd_session *bs = THREAD_ARG(t);
-
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
 	case PTM_BFD_UP:
 		ptm_bfd_sess_dn(bs, BD_ECHO_FAILED);
 		break;
 	}
-
-	return 0;
 }
 
 struct bfd_session *bfd_session_new(void)
@@ -511,6 +495,8 @@ struct bfd_session *bfd_session_new(void)
 	monotime(&bs->uptime);
 	bs->downtime = bs->uptime;
 
+	bfd_timers_init(bs);
+
 	return bs;
 }
 
@@ -1290,6 +1276,17 @@ void bs_observer_del(struct bfd_session_observer *bso)
 	XFREE(MTYPE_BFDD_SESSION_OBSERVER, bso);
 }
 
+/*
+ * Copy a session for reading outside the fast path: its protocol state,
+ * timers and counters may only be read with `bglobal.bg_mtx` held.
+ */
+void bs_snapshot(const struct bfd_session *bs, struct bfd_session *copy)
+{
+	frr_with_mutex(&bglobal.bg_mtx) {
+		memcpy(copy, bs, sizeof(*copy));
+	}
+}
+
 void bs_to_bpc(struct bfd_session *bs, struct bfd_peer_cfg *bpc)
 {
 	memset(bpc, 0, sizeof(*bpc));
@@ -1588,7 +1585,9 @@ void bfd_shutdown(void)
 	 * of removing the session from all hashes, so we just run an
 	 * assert() here to make sure it really happened.
 	 */
-	bfd_id_iterate(_bfd_free, NULL);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfd_id_iterate(_bfd_free, NULL);
+	}
 	assert(bfd_key_hash->count == 0);
 
 	/* Now free the hashes themselves. */
@@ -1709,13 +1708,16 @@ static int bfd_vrf_update(struct vrf *vrf)
 		zlog_debug("VRF update: %s(%u)", vrf->name, vrf->vrf_id);
 
 	/* a different name is given; update bfd list */
-	bfdd_sessions_enable_vrf(vrf);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfdd_sessions_enable_vrf(vrf);
+	}
 	return 0;
 }
 
 static int bfd_vrf_enable(struct vrf *vrf)
 {
 	struct bfd_vrf_global *bvrf;
+	struct thread_master *m;
 
 	/* a different name */
 	if (!vrf->info) {
@@ -1743,33 +1745,51 @@ static int bfd_vrf_enable(struct vrf *vrf)
 		if (!bvrf->bg_echov6)
 			bvrf->bg_echov6 = bp_echov6_socket(vrf);
 
-		/* Add descriptors to the event loop. */
-		if (!bvrf->bg_ev[0])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop,
-					&bvrf->bg_ev[0]);
-		if (!bvrf->bg_ev[1])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop,
-					&bvrf->bg_ev[1]);
-		if (!bvrf->bg_ev[2])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop6,
-					&bvrf->bg_ev[2]);
-		if (!bvrf->bg_ev[3])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
-					&bvrf->bg_ev[3]);
-		if (!bvrf->bg_ev[4])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_echo,
-					&bvrf->bg_ev[4]);
-		if (!bvrf->bg_ev[5])
-			thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_echov6,
-					&bvrf->bg_ev[5]);
+		/* Add descriptors to the fast path event loop. */
+		m = bfd_fastpath_master();
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_shop,
+				&bvrf->bg_ev[0]);
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_mhop,
+				&bvrf->bg_ev[1]);
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_shop6,
+				&bvrf->bg_ev[2]);
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
+				&bvrf->bg_ev[3]);
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_echo,
+				&bvrf->bg_ev[4]);
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_echov6,
+				&bvrf->bg_ev[5]);
 	}
 	if (vrf->vrf_id != VRF_DEFAULT) {
 		bfdd_zclient_register(vrf->vrf_id);
-		bfdd_sessions_enable_vrf(vrf);
+		frr_with_mutex(&bglobal.bg_mtx) {
+			bfdd_sessions_enable_vrf(vrf);
+		}
 	}
 	return 0;
 }
 
+/* Stops reading from a VRF's sockets, on the fast path. */
+static void bfd_vrf_stop_reads(void *arg)
+{
+	struct bfd_vrf_global *bvrf = arg;
+	size_t i;
+
+	for (i = 0; i < array_size(bvrf->bg_ev); i++)
+		THREAD_OFF(bvrf->bg_ev[i]);
+}
+
+/* Stops reading from all VRFs' sockets, on the fast path. */
+void bfd_vrfs_stop_reads(void)
+{
+	struct vrf *vrf;
+
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		if (vrf->info)
+			bfd_vrf_stop_reads(vrf->info);
+	}
+}
+
 static int bfd_vrf_disable(struct vrf *vrf)
 {
 	struct bfd_vrf_global *bvrf;
@@ -1779,20 +1799,20 @@ static int bfd_vrf_disable(struct vrf *vrf)
 	bvrf = vrf->info;
 
 	if (vrf->vrf_id != VRF_DEFAULT) {
-		bfdd_sessions_disable_vrf(vrf);
+		frr_with_mutex(&bglobal.bg_mtx) {
+			bfdd_sessions_disable_vrf(vrf);
+		}
 		bfdd_zclient_unregister(vrf->vrf_id);
 	}
 
 	if (bglobal.debug_zebra)
 		zlog_debug("VRF disable %s id %d", vrf->name, vrf->vrf_id);
 
-	/* Disable read/write poll triggering. */
-	THREAD_OFF(bvrf->bg_ev[0]);
-	THREAD_OFF(bvrf->bg_ev[1]);
-	THREAD_OFF(bvrf->bg_ev[2]);
-	THREAD_OFF(bvrf->bg_ev[3]);
-	THREAD_OFF(bvrf->bg_ev[4]);
-	THREAD_OFF(bvrf->bg_ev[5]);
+	/*
+	 * Disable read/write poll triggering.  This runs on the fast path, so
+	 * once it returns no bfd_recv_cb() is using the sockets or bvrf.
+	 */
+	bfd_fastpath_call(bfd_vrf_stop_reads, bvrf);
 
 	/* Close all descriptors. */
 	socket_close(&bvrf->bg_echo);
@@ -27,10 +27,12 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#include "lib/frr_pthread.h"
 #include "lib/hash.h"
 #include "lib/libfrr.h"
 #include "lib/qobj.h"
 #include "lib/queue.h"
+#include "lib/typesafe.h"
 #include "lib/vrf.h"
 
 #include "bfdctl.h"
@@ -195,6 +197,29 @@ struct bfd_session_stats {
 /* bfd_session shortcut label forwarding. */
 struct peer_label;
 
+/*
+ * Session timers.  They don't use `struct thread`: they live on a heap owned
+ * by the fast path pthread, see `event.c`.
+ */
+enum bfd_timer_type {
+	BFD_TIMER_RECV = 0,
+	BFD_TIMER_ECHO_RECV,
+	BFD_TIMER_XMT,
+	BFD_TIMER_ECHO_XMT,
+	BFD_TIMER_MAX,
+};
+
+PREDECL_HEAP(bfd_timer_heap)
+
+struct bfd_timer {
+	struct bfd_timer_heap_item item;
+
+	/* Expiration time in monotonic microseconds, 0 when not armed. */
+	int64_t deadline;
+	struct bfd_session *bs;
+	enum bfd_timer_type type;
+};
+
 /*
  * Session state information
  */
@@ -214,13 +239,10 @@ struct bfd_session {
 	struct bfd_timers timers;
 	struct bfd_timers cur_timers;
 	uint64_t detect_TO;
-	struct thread *echo_recvtimer_ev;
-	struct thread *recvtimer_ev;
 	uint64_t xmt_TO;
 	uint64_t echo_xmt_TO;
-	struct thread *xmttimer_ev;
-	struct thread *echo_xmttimer_ev;
 	uint64_t echo_detect_TO;
+	struct bfd_timer timer[BFD_TIMER_MAX];
 
 	/* software object state */
 	uint8_t polling;
@@ -240,6 +262,18 @@ struct bfd_session {
 
 	struct bfd_session_stats stats;
 
+	/*
+	 * Bumped by the state notifications sent by the main pthread, so
+	 * the ones still queued by the fast path can be told to be stale.
+	 */
+	uint32_t notify_gen;
+
+	/* Notifications the fast path couldn't hand over yet. */
+	bool notify_pending;
+	uint8_t notify_state;
+	uint32_t notify_pending_gen;
+	bool notify_config_pending;
+
 	struct timeval uptime;   /* last up time */
 	struct timeval downtime; /* last down time */
 
@@ -388,6 +422,29 @@ struct bfd_global {
 	struct thread *bg_csockev;
 	struct bcslist bg_bcslist;
 
+	/*
+	 * Fast path: packet I/O and session timers run on their own pthread,
+	 * see `event.c`.
+	 *
+	 * `bg_mtx` protects the sessions protocol state, their timers and
+	 * the discriminator hash.  The fast path holds it while processing
+	 * a batch of packets or expired timers, the main pthread while
+	 * changing sessions.
+	 */
+	struct frr_pthread *bg_pth;
+	pthread_mutex_t bg_mtx;
+	struct bfd_timer_heap_head bg_timers;
+	/* Deadline the fast path is sleeping until, 0 for none. */
+	int64_t bg_wakeup;
+	struct thread *bg_timer_ev;
+	struct thread *bg_kick_ev;
+
+	/* Fast path to main pthread messages, see `bfd_fp_msg`. */
+	struct spsc_ring *bg_fp_ring;
+	struct thread *bg_fp_ev;
+	_Atomic bool bg_fp_resync;
+	_Atomic uint64_t bg_fp_overflow;
+
 	struct pllist bg_pllist;
 
 	struct obslist bg_obslist;
@@ -476,6 +533,9 @@ void ptm_bfd_snd(struct bfd_session *bfd, int fbit);
 void ptm_bfd_echo_snd(struct bfd_session *bfd);
 
 int bfd_recv_cb(struct thread *t);
+void bfd_recv_ctrl_pkt(struct bfd_pkt *cp, ssize_t mlen, bool is_mhop,
+		       uint8_t ttl, ifindex_t ifindex, vrf_id_t vrfid,
+		       struct sockaddr_any *local, struct sockaddr_any *peer);
 
 
 /*
@@ -483,8 +543,6 @@ int bfd_recv_cb(struct thread *t);
  *
  * Contains the code related with event loop.
  */
-typedef void (*bfd_ev_cb)(struct thread *t);
-
 void bfd_recvtimer_update(struct bfd_session *bs);
 void bfd_echo_recvtimer_update(struct bfd_session *bs);
 void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter);
@@ -495,10 +553,35 @@ void bfd_echo_xmttimer_delete(struct bfd_session *bs);
 void bfd_recvtimer_delete(struct bfd_session *bs);
 void bfd_echo_recvtimer_delete(struct bfd_session *bs);
 
-void bfd_recvtimer_assign(struct bfd_session *bs, bfd_ev_cb cb, int sd);
-void bfd_echo_recvtimer_assign(struct bfd_session *bs, bfd_ev_cb cb, int sd);
-void bfd_xmttimer_assign(struct bfd_session *bs, bfd_ev_cb cb);
-void bfd_echo_xmttimer_assign(struct bfd_session *bs, bfd_ev_cb cb);
+void bfd_timers_init(struct bfd_session *bs);
+void bfd_timers_schedule(void);
+
+/* Fast path pthread. */
+void bfd_fastpath_init(void);
+void bfd_fastpath_run(void);
+void bfd_fastpath_stop(void);
+void bfd_fastpath_fini(void);
+struct thread_master *bfd_fastpath_master(void);
+void bfd_fastpath_call(void (*func)(void *arg), void *arg);
+
+/* Whether the caller is running on the fast path pthread. */
+static inline bool bfd_fastpath_self(void)
+{
+	return bglobal.bg_pth
+	       && pthread_equal(bglobal.bg_pth->thread, pthread_self());
+}
+
+/*
+ * Things the fast path must leave to the main pthread: notifying clients
+ * about session changes and handling packets that need the interface or
+ * VRF tables.
+ */
+void bfd_fastpath_notify(struct bfd_session *bs, uint8_t notify_state);
+void bfd_fastpath_notify_config(struct bfd_session *bs, const char *op);
+void bfd_fastpath_slow_pkt(struct bfd_pkt *cp, ssize_t mlen, bool is_mhop,
+			   uint8_t ttl, ifindex_t ifindex, vrf_id_t vrfid,
+			   struct sockaddr_any *local,
+			   struct sockaddr_any *peer);
 
 
 /*
@@ -539,6 +622,7 @@ int bs_observer_add(struct bfd_session *bs);
 void bs_observer_del(struct bfd_session_observer *bso);
 
 void bs_to_bpc(struct bfd_session *bs, struct bfd_peer_cfg *bpc);
+void bs_snapshot(const struct bfd_session *bs, struct bfd_session *copy);
 
 void gen_bfd_key(struct bfd_key *key, struct sockaddr_any *peer,
 		 struct sockaddr_any *local, bool mhop, const char *ifname,
@@ -555,6 +639,7 @@ void bfd_initialize(void);
 void bfd_shutdown(void);
 void bfd_vrf_init(void);
 void bfd_vrf_terminate(void);
+void bfd_vrfs_stop_reads(void);
 struct bfd_vrf_global *bfd_vrf_look_by_session(struct bfd_session *bfd);
 struct bfd_session *bfd_id_lookup(uint32_t id);
 struct bfd_session *bfd_key_lookup(struct bfd_key key);
@@ -574,10 +659,10 @@ unsigned long bfd_get_session_count(void);
 /* Export callback functions for `event.c`. */
 extern struct thread_master *master;
 
-int bfd_recvtimer_cb(struct thread *t);
-int bfd_echo_recvtimer_cb(struct thread *t);
-int bfd_xmt_cb(struct thread *t);
-int bfd_echo_xmt_cb(struct thread *t);
+void bfd_recvtimer_cb(struct bfd_session *bs);
+void bfd_echo_recvtimer_cb(struct bfd_session *bs);
+void bfd_xmt_cb(struct bfd_session *bs);
+void bfd_echo_xmt_cb(struct bfd_session *bs);
 
 extern struct in6_addr zero_addr;
 
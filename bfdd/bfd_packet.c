@@ -37,24 +37,52 @@
 
 #include "bfd.h"
 
+/*
+ * Packets read from a socket at once.  Echo packets to be looped back are
+ * sent back in one go as well.
+ */
+#define BFD_RECV_BATCH 32
+
+/* Ancillary data buffer size for bp_udp_msg(). */
+#define BP_UDP_CTLLEN CMSG_SPACE(sizeof(int))
+
+struct bfd_recv_pkt {
+	struct msghdr msg;
+	struct iovec iov;
+	struct sockaddr_any name;
+	uint8_t cmsgbuf[255];
+	uint8_t data[1516];
+	ssize_t len;
+
+	/* Filled in by bfd_parse_ipv4() and bfd_parse_ipv6(). */
+	uint8_t ttl;
+	ifindex_t ifindex;
+	struct sockaddr_any local;
+	struct sockaddr_any peer;
+};
+
+/* Receive buffers, only used by the fast path pthread. */
+static struct bfd_recv_pkt bfd_rpkts[BFD_RECV_BATCH];
+static struct bfd_recv_pkt *bfd_echo_loop[BFD_RECV_BATCH];
+static int bfd_echo_loop_count;
+
 /*
  * Prototypes
  */
-static int ptm_bfd_process_echo_pkt(struct bfd_vrf_global *bvrf, int s);
 int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
 		  size_t datalen);
 
 static void bfd_sd_reschedule(struct bfd_vrf_global *bvrf, int sd);
-ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
-		      ifindex_t *ifindex, struct sockaddr_any *local,
-		      struct sockaddr_any *peer);
-ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
-		      ifindex_t *ifindex, struct sockaddr_any *local,
-		      struct sockaddr_any *peer);
+static int bfd_recv_batch(int sd);
+static int bfd_parse_ipv4(struct bfd_recv_pkt *rp);
+static int bfd_parse_ipv6(struct bfd_recv_pkt *rp);
+static void bfd_recv_echo(struct bfd_recv_pkt *rp, bool is_ipv6);
+static void bfd_echo_loopback(int sd, bool is_ipv6);
 int bp_udp_send(int sd, uint8_t ttl, uint8_t *data, size_t datalen,
 		struct sockaddr *to, socklen_t tolen);
-int bp_bfd_echo_in(struct bfd_vrf_global *bvrf, int sd,
-		   uint8_t *ttl, uint32_t *my_discr);
+static void bp_udp_msg(int sd, struct msghdr *msg, struct iovec *iov,
+		       uint8_t *msgctl, uint8_t ttl, uint8_t *data,
+		       size_t datalen, struct sockaddr *to, socklen_t tolen);
 
 /* socket related prototypes */
 static void bp_set_ipopts(int sd);
@@ -182,44 +210,6 @@ void ptm_bfd_echo_snd(struct bfd_session *bfd)
 	bfd->stats.tx_echo_pkt++;
 }
 
-static int ptm_bfd_process_echo_pkt(struct bfd_vrf_global *bvrf, int s)
-{
-	struct bfd_session *bfd;
-	uint32_t my_discr = 0;
-	uint8_t ttl = 0;
-
-	/* Receive and parse echo packet. */
-	if (bp_bfd_echo_in(bvrf, s, &ttl, &my_discr) == -1)
-		return 0;
-
-	/* Your discriminator not zero - use it to find session */
-	bfd = bfd_id_lookup(my_discr);
-	if (bfd == NULL) {
-		if (bglobal.debug_network)
-			zlog_debug("echo-packet: no matching session (id:%u)",
-				   my_discr);
-		return -1;
-	}
-
-	if (!CHECK_FLAG(bfd->flags, BFD_SESS_FLAG_ECHO_ACTIVE)) {
-		if (bglobal.debug_network)
-			zlog_debug("echo-packet: echo disabled [%s] (id:%u)",
-				   bs_to_string(bfd), my_discr);
-		return -1;
-	}
-
-	bfd->stats.rx_echo_pkt++;
-
-	/* Compute detect time */
-	bfd->echo_detect_TO = bfd->remote_detect_mult * bfd->echo_xmt_TO;
-
-	/* Update echo receive timeout. */
-	if (bfd->echo_detect_TO > 0)
-		bfd_echo_recvtimer_update(bfd);
-
-	return 0;
-}
-
 void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
 {
 	struct bfd_pkt cp = {};
@@ -273,43 +263,89 @@ void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
 	bfd->stats.tx_ctrl_pkt++;
 }
 
-ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
-		      ifindex_t *ifindex, struct sockaddr_any *local,
-		      struct sockaddr_any *peer)
+/*
+ * Reads as many packets as available, up to `BFD_RECV_BATCH`, into
+ * `bfd_rpkts`.
+ *
+ * Returns the number of packets read.
+ */
+static int bfd_recv_batch(int sd)
 {
-	struct cmsghdr *cm;
-	ssize_t mlen;
-	struct sockaddr_in msgaddr;
-	struct msghdr msghdr;
-	struct iovec iov[1];
-	uint8_t cmsgbuf[255];
+	struct bfd_recv_pkt *rp;
+	int i, count;
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr mmsg[BFD_RECV_BATCH];
+#endif /* HAVE_RECVMMSG */
 
 	/* Prepare the recvmsg params. */
-	iov[0].iov_base = msgbuf;
-	iov[0].iov_len = msgbuflen;
-
-	memset(&msghdr, 0, sizeof(msghdr));
-	msghdr.msg_name = &msgaddr;
-	msghdr.msg_namelen = sizeof(msgaddr);
-	msghdr.msg_iov = iov;
-	msghdr.msg_iovlen = 1;
-	msghdr.msg_control = cmsgbuf;
-	msghdr.msg_controllen = sizeof(cmsgbuf);
-
-	mlen = recvmsg(sd, &msghdr, MSG_DONTWAIT);
-	if (mlen == -1) {
-		if (errno != EAGAIN)
-			zlog_err("ipv4-recv: recv failed: %s", strerror(errno));
+	for (i = 0; i < BFD_RECV_BATCH; i++) {
+		rp = &bfd_rpkts[i];
+		rp->iov.iov_base = rp->data;
+		rp->iov.iov_len = sizeof(rp->data);
+
+		memset(&rp->msg, 0, sizeof(rp->msg));
+		rp->msg.msg_name = &rp->name;
+		rp->msg.msg_namelen = sizeof(rp->name);
+		rp->msg.msg_iov = &rp->iov;
+		rp->msg.msg_iovlen = 1;
+		rp->msg.msg_control = rp->cmsgbuf;
+		rp->msg.msg_controllen = sizeof(rp->cmsgbuf);
+	}
 
-		return -1;
+#ifdef HAVE_RECVMMSG
+	memset(mmsg, 0, sizeof(mmsg));
+	for (i = 0; i < BFD_RECV_BATCH; i++)
+		mmsg[i].msg_hdr = bfd_rpkts[i].msg;
+
+	count = recvmmsg(sd, mmsg, BFD_RECV_BATCH, MSG_DONTWAIT, NULL);
+	if (count == -1) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			zlog_err("packet-recv: recv failed: %s",
+				 strerror(errno));
+		return 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		bfd_rpkts[i].msg = mmsg[i].msg_hdr;
+		bfd_rpkts[i].len = mmsg[i].msg_len;
+	}
+#else
+	for (count = 0; count < BFD_RECV_BATCH; count++) {
+		rp = &bfd_rpkts[count];
+		rp->len = recvmsg(sd, &rp->msg, MSG_DONTWAIT);
+		if (rp->len == -1) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK
+			    && errno != EINTR)
+				zlog_err("packet-recv: recv failed: %s",
+					 strerror(errno));
+			break;
+		}
 	}
+#endif /* HAVE_RECVMMSG */
+
+	return count;
+}
+
+static int bfd_parse_ipv4(struct bfd_recv_pkt *rp)
+{
+	struct cmsghdr *cm;
+	uint8_t *ttl = &rp->ttl;
+	ifindex_t *ifindex = &rp->ifindex;
+	struct sockaddr_any *local = &rp->local;
+	struct sockaddr_any *peer = &rp->peer;
+
+	/* Sanitize input/output. */
+	*ttl = 0;
+	*ifindex = IFINDEX_INTERNAL;
+	memset(local, 0, sizeof(*local));
+	memset(peer, 0, sizeof(*peer));
 
 	/* Get source address */
-	peer->sa_sin = *((struct sockaddr_in *)(msghdr.msg_name));
+	peer->sa_sin = rp->name.sa_sin;
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr, cm)) {
+	for (cm = CMSG_FIRSTHDR(&rp->msg); cm != NULL;
+	     cm = CMSG_NXTHDR(&rp->msg, cm)) {
 		if (cm->cmsg_level != IPPROTO_IP)
 			continue;
 
@@ -378,50 +414,33 @@ ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 
 	/* OS agnostic way of getting interface name. */
 	if (*ifindex == IFINDEX_INTERNAL)
-		*ifindex = getsockopt_ifindex(AF_INET, &msghdr);
+		*ifindex = getsockopt_ifindex(AF_INET, &rp->msg);
 
-	return mlen;
+	return 0;
 }
 
-ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
-		      ifindex_t *ifindex, struct sockaddr_any *local,
-		      struct sockaddr_any *peer)
+static int bfd_parse_ipv6(struct bfd_recv_pkt *rp)
 {
 	struct cmsghdr *cm;
 	struct in6_pktinfo *pi6 = NULL;
-	ssize_t mlen;
 	uint32_t ttlval;
-	struct sockaddr_in6 msgaddr6;
-	struct msghdr msghdr6;
-	struct iovec iov[1];
-	uint8_t cmsgbuf6[255];
+	uint8_t *ttl = &rp->ttl;
+	ifindex_t *ifindex = &rp->ifindex;
+	struct sockaddr_any *local = &rp->local;
+	struct sockaddr_any *peer = &rp->peer;
 
-	/* Prepare the recvmsg params. */
-	iov[0].iov_base = msgbuf;
-	iov[0].iov_len = msgbuflen;
-
-	memset(&msghdr6, 0, sizeof(msghdr6));
-	msghdr6.msg_name = &msgaddr6;
-	msghdr6.msg_namelen = sizeof(msgaddr6);
-	msghdr6.msg_iov = iov;
-	msghdr6.msg_iovlen = 1;
-	msghdr6.msg_control = cmsgbuf6;
-	msghdr6.msg_controllen = sizeof(cmsgbuf6);
-
-	mlen = recvmsg(sd, &msghdr6, MSG_DONTWAIT);
-	if (mlen == -1) {
-		if (errno != EAGAIN)
-			zlog_err("ipv6-recv: recv failed: %s", strerror(errno));
-
-		return -1;
-	}
+	/* Sanitize input/output. */
+	*ttl = 0;
+	*ifindex = IFINDEX_INTERNAL;
+	memset(local, 0, sizeof(*local));
+	memset(peer, 0, sizeof(*peer));
 
 	/* Get source address */
-	peer->sa_sin6 = *((struct sockaddr_in6 *)(msghdr6.msg_name));
+	peer->sa_sin6 = rp->name.sa_sin6;
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr6); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr6, cm)) {
+	for (cm = CMSG_FIRSTHDR(&rp->msg); cm != NULL;
+	     cm = CMSG_NXTHDR(&rp->msg, cm)) {
 		if (cm->cmsg_level != IPPROTO_IPV6)
 			continue;
 
@@ -457,34 +476,36 @@ ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		}
 	}
 
-	return mlen;
+	return 0;
 }
 
 static void bfd_sd_reschedule(struct bfd_vrf_global *bvrf, int sd)
 {
+	struct thread_master *m = bfd_fastpath_master();
+
 	if (sd == bvrf->bg_shop) {
 		THREAD_OFF(bvrf->bg_ev[0]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_shop,
 				&bvrf->bg_ev[0]);
 	} else if (sd == bvrf->bg_mhop) {
 		THREAD_OFF(bvrf->bg_ev[1]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_mhop,
 				&bvrf->bg_ev[1]);
 	} else if (sd == bvrf->bg_shop6) {
 		THREAD_OFF(bvrf->bg_ev[2]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop6,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_shop6,
 				&bvrf->bg_ev[2]);
 	} else if (sd == bvrf->bg_mhop6) {
 		THREAD_OFF(bvrf->bg_ev[3]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
 				&bvrf->bg_ev[3]);
 	} else if (sd == bvrf->bg_echo) {
 		THREAD_OFF(bvrf->bg_ev[4]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_echo,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_echo,
 				&bvrf->bg_ev[4]);
 	} else if (sd == bvrf->bg_echov6) {
 		THREAD_OFF(bvrf->bg_ev[5]);
-		thread_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_echov6,
+		thread_add_read(m, bfd_recv_cb, bvrf, bvrf->bg_echov6,
 				&bvrf->bg_ev[5]);
 	}
 }
@@ -532,56 +553,84 @@ static void cp_debug(bool mhop, struct sockaddr_any *peer,
 int bfd_recv_cb(struct thread *t)
 {
 	int sd = THREAD_FD(t);
-	struct bfd_session *bfd;
-	struct bfd_pkt *cp;
-	bool is_mhop;
-	ssize_t mlen = 0;
-	uint8_t ttl = 0;
-	vrf_id_t vrfid;
-	ifindex_t ifindex = IFINDEX_INTERNAL;
-	struct sockaddr_any local, peer;
-	uint8_t msgbuf[1516];
+	struct bfd_recv_pkt *rp;
+	bool is_mhop, is_ipv6, is_echo;
+	int i, count;
 	struct bfd_vrf_global *bvrf = THREAD_ARG(t);
 
-	vrfid = bvrf->vrf->vrf_id;
-
-	/* Schedule next read. */
+	/*
+	 * Schedule next read.  bvrf's sockets and tasks only change on the
+	 * fast path or while the main pthread waits for it (see
+	 * `bfd_vrf_disable()`), so they don't need the lock.
+	 */
 	bfd_sd_reschedule(bvrf, sd);
 
-	/* Handle echo packets. */
-	if (sd == bvrf->bg_echo || sd == bvrf->bg_echov6) {
-		ptm_bfd_process_echo_pkt(bvrf, sd);
+	is_echo = sd == bvrf->bg_echo || sd == bvrf->bg_echov6;
+	is_ipv6 = sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6
+		  || sd == bvrf->bg_echov6;
+	is_mhop = sd == bvrf->bg_mhop || sd == bvrf->bg_mhop6;
+
+	count = bfd_recv_batch(sd);
+	if (count == 0)
 		return 0;
-	}
 
-	/* Sanitize input/output. */
-	memset(&local, 0, sizeof(local));
-	memset(&peer, 0, sizeof(peer));
-
-	/* Handle control packets. */
-	is_mhop = false;
-	if (sd == bvrf->bg_shop || sd == bvrf->bg_mhop) {
-		is_mhop = sd == bvrf->bg_mhop;
-		mlen = bfd_recv_ipv4(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
-	} else if (sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6) {
-		is_mhop = sd == bvrf->bg_mhop6;
-		mlen = bfd_recv_ipv6(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		for (i = 0; i < count; i++) {
+			rp = &bfd_rpkts[i];
+			if (is_ipv6) {
+				if (bfd_parse_ipv6(rp) == -1)
+					continue;
+			} else if (bfd_parse_ipv4(rp) == -1)
+				continue;
+
+			/* Handle echo packets. */
+			if (is_echo) {
+				bfd_recv_echo(rp, is_ipv6);
+				continue;
+			}
+
+			/* Handle control packets. */
+			bfd_recv_ctrl_pkt((struct bfd_pkt *)rp->data, rp->len,
+					  is_mhop, rp->ttl, rp->ifindex,
+					  bvrf->vrf->vrf_id, &rp->local,
+					  &rp->peer);
+		}
+
+		bfd_timers_schedule();
 	}
 
+	/* Echo packets to loop back don't need the lock. */
+	if (bfd_echo_loop_count)
+		bfd_echo_loopback(sd, is_ipv6);
+
+	return 0;
+}
+
+/*
+ * Handles a control packet: `bfd_recv_cb()` calls this for every packet
+ * read from the sockets and the main pthread for the packets the fast path
+ * leaves to it (see `bfd_fastpath_slow_pkt()`).
+ *
+ * Must be called with `bglobal.bg_mtx` held.
+ */
+void bfd_recv_ctrl_pkt(struct bfd_pkt *cp, ssize_t mlen, bool is_mhop,
+		       uint8_t ttl, ifindex_t ifindex, vrf_id_t vrfid,
+		       struct sockaddr_any *local, struct sockaddr_any *peer)
+{
+	struct bfd_session *bfd;
+
 	/* Implement RFC 5880 6.8.6 */
 	if (mlen < BFD_PKT_LEN) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "too small (%ld bytes)", mlen);
-		return 0;
+		return;
 	}
 
 	/* Validate packet TTL. */
 	if ((!is_mhop) && (ttl != BFD_TTL_VAL)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "invalid TTL: %d expected %d", ttl, BFD_TTL_VAL);
-		return 0;
+		return;
 	}
 
 	/*
@@ -591,36 +640,53 @@ int bfd_recv_cb(struct thread *t)
 	 * - Short packets;
 	 * - Invalid discriminator;
 	 */
-	cp = (struct bfd_pkt *)(msgbuf);
 	if (BFD_GETVER(cp->diag) != BFD_VERSION) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "bad version %d", BFD_GETVER(cp->diag));
-		return 0;
+		return;
 	}
 
 	if (cp->detect_mult == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "detect multiplier set to zero");
-		return 0;
+		return;
 	}
 
 	if ((cp->len < BFD_PKT_LEN) || (cp->len > mlen)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid, "too small");
-		return 0;
+		cp_debug(is_mhop, peer, local, ifindex, vrfid, "too small");
+		return;
 	}
 
 	if (cp->discrs.my_discr == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "'my discriminator' is zero");
-		return 0;
+		return;
+	}
+
+	/*
+	 * Without our discriminator the session can only be found by its
+	 * interface and VRF names, which the fast path can't look up.
+	 */
+	if (cp->discrs.remote_discr == 0 && bfd_fastpath_self()) {
+		bfd_fastpath_slow_pkt(cp, mlen, is_mhop, ttl, ifindex, vrfid,
+				      local, peer);
+		return;
 	}
 
 	/* Find the session that this packet belongs. */
-	bfd = ptm_bfd_sess_find(cp, &peer, &local, ifindex, vrfid, is_mhop);
+	bfd = ptm_bfd_sess_find(cp, peer, local, ifindex, vrfid, is_mhop);
 	if (bfd == NULL) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "no session found");
-		return 0;
+		return;
+	}
+
+	/* Same for learning the interface the packet came in. */
+	if (bfd->ifp == NULL && ifindex != IFINDEX_INTERNAL
+	    && bfd_fastpath_self()) {
+		bfd_fastpath_slow_pkt(cp, mlen, is_mhop, ttl, ifindex, vrfid,
+				      local, peer);
+		return;
 	}
 
 	bfd->stats.rx_ctrl_pkt++;
@@ -631,26 +697,27 @@ int bfd_recv_cb(struct thread *t)
 	 */
 	if (is_mhop) {
 		if ((BFD_TTL_VAL - bfd->mh_ttl) > BFD_TTL_VAL) {
-			cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+			cp_debug(is_mhop, peer, local, ifindex, vrfid,
 				 "exceeded max hop count (expected %d, got %d)",
 				 bfd->mh_ttl, BFD_TTL_VAL);
-			return 0;
+			return;
 		}
 	} else if (bfd->local_address.sa_sin.sin_family == AF_UNSPEC) {
-		bfd->local_address = local;
+		bfd->local_address = *local;
 	}
 
 	/*
 	 * If no interface was detected, save the interface where the
-	 * packet came in.
+	 * packet came in.  The fast path left packets with an interface to
+	 * the main pthread above.
 	 */
-	if (bfd->ifp == NULL)
+	if (bfd->ifp == NULL && ifindex != IFINDEX_INTERNAL)
 		bfd->ifp = if_lookup_by_index(ifindex, vrfid);
 
 	/* Log remote discriminator changes. */
 	if ((bfd->discrs.remote_discr != 0)
 	    && (bfd->discrs.remote_discr != ntohl(cp->discrs.my_discr)))
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "remote discriminator mismatch (expected %u, got %u)",
 			 bfd->discrs.remote_discr, ntohl(cp->discrs.my_discr));
 
@@ -702,92 +769,140 @@ int bfd_recv_cb(struct thread *t)
 		/* Send the control packet with the final bit immediately. */
 		ptm_bfd_snd(bfd, 1);
 	}
-
-	return 0;
 }
 
 /*
- * bp_bfd_echo_in: proccesses an BFD echo packet. On TTL == BFD_TTL_VAL
- * the packet is looped back or returns the my discriminator ID along
- * with the TTL.
- *
- * Returns -1 on error or loopback or 0 on success.
+ * bfd_recv_echo: proccesses an BFD echo packet. On TTL == BFD_TTL_VAL
+ * the packet is queued to be looped back by `bfd_echo_loopback()`,
+ * otherwise the session echo receive timer is updated.
  */
-int bp_bfd_echo_in(struct bfd_vrf_global *bvrf, int sd,
-		   uint8_t *ttl, uint32_t *my_discr)
+static void bfd_recv_echo(struct bfd_recv_pkt *rp, bool is_ipv6)
 {
 	struct bfd_echo_pkt *bep;
-	ssize_t rlen;
-	struct sockaddr_any local, peer;
-	ifindex_t ifindex = IFINDEX_INTERNAL;
+	struct bfd_session *bfd;
+	uint32_t my_discr;
 	vrf_id_t vrfid = VRF_DEFAULT;
-	uint8_t msgbuf[1516];
-
-	if (sd == bvrf->bg_echo)
-		rlen = bfd_recv_ipv4(sd, msgbuf, sizeof(msgbuf), ttl, &ifindex,
-				     &local, &peer);
-	else
-		rlen = bfd_recv_ipv6(sd, msgbuf, sizeof(msgbuf), ttl, &ifindex,
-				     &local, &peer);
 
 	/* Short packet, better not risk reading it. */
-	if (rlen < (ssize_t)sizeof(*bep)) {
-		cp_debug(false, &peer, &local, ifindex, vrfid,
+	if (rp->len < (ssize_t)sizeof(*bep)) {
+		cp_debug(false, &rp->peer, &rp->local, rp->ifindex, vrfid,
 			 "small echo packet");
-		return -1;
+		return;
 	}
 
 	/* Test for loopback. */
-	if (*ttl == BFD_TTL_VAL) {
-		bp_udp_send(sd, *ttl - 1, msgbuf, rlen,
-			    (struct sockaddr *)&peer,
-			    (sd == bvrf->bg_echo) ? sizeof(peer.sa_sin)
-						    : sizeof(peer.sa_sin6));
-		return -1;
+	if (rp->ttl == BFD_TTL_VAL) {
+		bfd_echo_loop[bfd_echo_loop_count++] = rp;
+		return;
 	}
 
 	/* Read my discriminator from BFD Echo packet. */
-	bep = (struct bfd_echo_pkt *)msgbuf;
-	*my_discr = ntohl(bep->my_discr);
-	if (*my_discr == 0) {
-		cp_debug(false, &peer, &local, ifindex, vrfid,
+	bep = (struct bfd_echo_pkt *)rp->data;
+	my_discr = ntohl(bep->my_discr);
+	if (my_discr == 0) {
+		cp_debug(false, &rp->peer, &rp->local, rp->ifindex, vrfid,
 			 "invalid echo packet discriminator (zero)");
-		return -1;
+		return;
 	}
 
-	return 0;
+	/* Your discriminator not zero - use it to find session */
+	bfd = bfd_id_lookup(my_discr);
+	if (bfd == NULL) {
+		if (bglobal.debug_network)
+			zlog_debug("echo-packet: no matching session (id:%u)",
+				   my_discr);
+		return;
+	}
+
+	if (!CHECK_FLAG(bfd->flags, BFD_SESS_FLAG_ECHO_ACTIVE)) {
+		if (bglobal.debug_network)
+			zlog_debug("echo-packet: echo disabled [%s] (id:%u)",
+				   bs_to_string(bfd), my_discr);
+		return;
+	}
+
+	bfd->stats.rx_echo_pkt++;
+
+	/* Compute detect time */
+	bfd->echo_detect_TO = bfd->remote_detect_mult * bfd->echo_xmt_TO;
+
+	/* Update echo receive timer. */
+	if (bfd->echo_detect_TO > 0)
+		bfd_echo_recvtimer_update(bfd);
 }
 
-int bp_udp_send(int sd, uint8_t ttl, uint8_t *data, size_t datalen,
-		struct sockaddr *to, socklen_t tolen)
+/* Sends back the echo packets queued by `bfd_recv_echo()`. */
+static void bfd_echo_loopback(int sd, bool is_ipv6)
+{
+	struct bfd_recv_pkt *rp;
+	socklen_t salen = is_ipv6 ? sizeof(struct sockaddr_in6)
+				  : sizeof(struct sockaddr_in);
+	int i;
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr mmsg[BFD_RECV_BATCH];
+	struct iovec iov[BFD_RECV_BATCH];
+	uint8_t msgctl[BFD_RECV_BATCH][BP_UDP_CTLLEN]
+		__attribute__((aligned(sizeof(struct cmsghdr))));
+	int rv, sent = 0;
+
+	memset(mmsg, 0, sizeof(mmsg));
+	for (i = 0; i < bfd_echo_loop_count; i++) {
+		rp = bfd_echo_loop[i];
+		bp_udp_msg(sd, &mmsg[i].msg_hdr, &iov[i], msgctl[i],
+			   BFD_TTL_VAL - 1, rp->data, rp->len,
+			   (struct sockaddr *)&rp->peer, salen);
+	}
+
+	while (sent < bfd_echo_loop_count) {
+		rv = sendmmsg(sd, &mmsg[sent], bfd_echo_loop_count - sent, 0);
+		if (rv <= 0) {
+			if (bglobal.debug_network)
+				zlog_debug(
+					"udp-send: loopback failure: (%d) %s",
+					errno, strerror(errno));
+			break;
+		}
+		sent += rv;
+	}
+#else
+	for (i = 0; i < bfd_echo_loop_count; i++) {
+		rp = bfd_echo_loop[i];
+		bp_udp_send(sd, BFD_TTL_VAL - 1, rp->data, rp->len,
+			    (struct sockaddr *)&rp->peer, salen);
+	}
+#endif /* HAVE_SENDMMSG */
+
+	bfd_echo_loop_count = 0;
+}
+
+/* Prepares `msg` to send `data` to `to` with the specified TTL. */
+static void bp_udp_msg(int sd, struct msghdr *msg, struct iovec *iov,
+		       uint8_t *msgctl, uint8_t ttl, uint8_t *data,
+		       size_t datalen, struct sockaddr *to, socklen_t tolen)
 {
 	struct cmsghdr *cmsg;
-	ssize_t wlen;
 	int ttlval = ttl;
 	bool is_ipv6 = to->sa_family == AF_INET6;
-	struct msghdr msg;
-	struct iovec iov[1];
-	uint8_t msgctl[255];
 
 	/* Prepare message data. */
-	iov[0].iov_base = data;
-	iov[0].iov_len = datalen;
+	iov->iov_base = data;
+	iov->iov_len = datalen;
 
-	memset(&msg, 0, sizeof(msg));
-	memset(msgctl, 0, sizeof(msgctl));
-	msg.msg_name = to;
-	msg.msg_namelen = tolen;
-	msg.msg_iov = iov;
-	msg.msg_iovlen = 1;
+	memset(msg, 0, sizeof(*msg));
+	memset(msgctl, 0, BP_UDP_CTLLEN);
+	msg->msg_name = to;
+	msg->msg_namelen = tolen;
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
 
 	/* Prepare the packet TTL information. */
 	if (ttl > 0) {
 		/* Use ancillary data. */
-		msg.msg_control = msgctl;
-		msg.msg_controllen = CMSG_LEN(sizeof(ttlval));
+		msg->msg_control = msgctl;
+		msg->msg_controllen = CMSG_LEN(sizeof(ttlval));
 
 		/* Configure the ancillary data. */
-		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg = CMSG_FIRSTHDR(msg);
 		cmsg->cmsg_len = CMSG_LEN(sizeof(ttlval));
 		if (is_ipv6) {
 			cmsg->cmsg_level = IPPROTO_IPV6;
@@ -798,14 +913,26 @@ int bp_udp_send(int sd, uint8_t ttl, uint8_t *data, size_t datalen,
 			cmsg->cmsg_type = IP_TTL;
 #else
 			/* FreeBSD does not support TTL in ancillary data. */
-			msg.msg_control = NULL;
-			msg.msg_controllen = 0;
+			msg->msg_control = NULL;
+			msg->msg_controllen = 0;
 
 			bp_set_ttl(sd, ttl);
 #endif /* BFD_BSD */
 		}
 		memcpy(CMSG_DATA(cmsg), &ttlval, sizeof(ttlval));
 	}
+}
+
+int bp_udp_send(int sd, uint8_t ttl, uint8_t *data, size_t datalen,
+		struct sockaddr *to, socklen_t tolen)
+{
+	ssize_t wlen;
+	struct msghdr msg;
+	struct iovec iov[1];
+	uint8_t msgctl[BP_UDP_CTLLEN]
+		__attribute__((aligned(sizeof(struct cmsghdr))));
+
+	bp_udp_msg(sd, &msg, iov, msgctl, ttl, data, datalen, to, tolen);
 
 	/* Send echo back. */
 	wlen = sendmsg(sd, &msg, 0);
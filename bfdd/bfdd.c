@@ -39,7 +39,8 @@ DEFINE_MTYPE(BFDD, BFDD_NOTIFICATION, "short-lived control notification data")
 struct thread_master *master;
 
 /* BFDd privileges */
-static zebra_capabilities_t _caps_p[] = {ZCAP_BIND, ZCAP_SYS_ADMIN, ZCAP_NET_RAW};
+static zebra_capabilities_t _caps_p[] = {ZCAP_BIND, ZCAP_SYS_ADMIN,
+					 ZCAP_NET_RAW, ZCAP_NICE};
 
 /* BFD daemon information. */
 static struct frr_daemon_info bfdd_di;
@@ -72,11 +73,16 @@ static void sigterm_handler(void)
 	/* Shutdown controller to avoid receiving anymore commands. */
 	control_shutdown();
 
+	/* Stop the fast path before freeing anything it uses. */
+	bfd_fastpath_stop();
+
 	/* Shutdown and free all protocol related memory. */
 	bfd_shutdown();
 
 	bfd_vrf_terminate();
 
+	bfd_fastpath_fini();
+
 	/* Terminate and free() FRR related memory. */
 	frr_fini();
 
@@ -226,6 +232,9 @@ int main(int argc, char *argv[])
 	/* Initialize BFD data structures. */
 	bfd_initialize();
 
+	/* Sockets and timers are handled by the fast path pthread. */
+	bfd_fastpath_init();
+
 	bfd_vrf_init();
 
 	access_list_init();
@@ -242,6 +251,8 @@ int main(int argc, char *argv[])
 	/* read configuration file and daemonize  */
 	frr_config_fork();
 
+	bfd_fastpath_run();
+
 	frr_run(master);
 	/* NOTREACHED */
 
@@ -63,6 +63,8 @@ static int bfd_session_create(enum nb_event event, const struct lyd_node *dnode,
 	struct bfd_key bk;
 	struct prefix p;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		/*
@@ -148,6 +150,8 @@ static int bfd_session_destroy(enum nb_event event,
 	struct bfd_session *bs;
 	struct bfd_key bk;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		bfd_session_get_key(mhop, dnode, &bk);
@@ -195,6 +199,8 @@ int bfdd_bfd_create(enum nb_event event,
 
 int bfdd_bfd_destroy(enum nb_event event, const struct lyd_node *dnode)
 {
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		/* NOTHING */
@@ -262,6 +268,8 @@ int bfdd_bfd_sessions_single_hop_detection_multiplier_modify(
 	uint8_t detection_multiplier = yang_dnode_get_uint8(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		break;
@@ -293,6 +301,8 @@ int bfdd_bfd_sessions_single_hop_desired_transmission_interval_modify(
 	uint32_t tx_interval = yang_dnode_get_uint32(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		if (tx_interval < 10000 || tx_interval > 60000000)
@@ -330,6 +340,8 @@ int bfdd_bfd_sessions_single_hop_required_receive_interval_modify(
 	uint32_t rx_interval = yang_dnode_get_uint32(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		if (rx_interval < 10000 || rx_interval > 60000000)
@@ -367,6 +379,8 @@ int bfdd_bfd_sessions_single_hop_administrative_down_modify(
 	bool shutdown = yang_dnode_get_bool(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 	case NB_EV_PREPARE:
@@ -431,6 +445,8 @@ int bfdd_bfd_sessions_single_hop_echo_mode_modify(enum nb_event event,
 	bool echo = yang_dnode_get_bool(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 	case NB_EV_PREPARE:
@@ -475,6 +491,8 @@ int bfdd_bfd_sessions_single_hop_desired_echo_transmission_interval_modify(
 	uint32_t echo_interval = yang_dnode_get_uint32(dnode, NULL);
 	struct bfd_session *bs;
 
+	frr_mutex_lock_autounlock(&bglobal.bg_mtx);
+
 	switch (event) {
 	case NB_EV_VALIDATE:
 		if (echo_interval < 10000 || echo_interval > 60000000)
@@ -91,9 +91,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_local_state_get_elem(const char *xpath,
 							const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_enum(xpath, bs->ses_state);
+	return yang_data_new_enum(xpath, bs.ses_state);
 }
 
 /*
@@ -102,9 +104,11 @@ bfdd_bfd_sessions_single_hop_stats_local_state_get_elem(const char *xpath,
 struct yang_data *bfdd_bfd_sessions_single_hop_stats_local_diagnostic_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_enum(xpath, bs->local_diag);
+	return yang_data_new_enum(xpath, bs.local_diag);
 }
 
 /*
@@ -125,12 +129,14 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_remote_discriminator_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	if (bs->discrs.remote_discr == 0)
+	if (bs.discrs.remote_discr == 0)
 		return NULL;
 
-	return yang_data_new_uint32(xpath, bs->discrs.remote_discr);
+	return yang_data_new_uint32(xpath, bs.discrs.remote_discr);
 }
 
 /*
@@ -140,9 +146,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_remote_state_get_elem(const char *xpath,
 							 const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_enum(xpath, bs->ses_state);
+	return yang_data_new_enum(xpath, bs.ses_state);
 }
 
 /*
@@ -151,9 +159,11 @@ bfdd_bfd_sessions_single_hop_stats_remote_state_get_elem(const char *xpath,
 struct yang_data *bfdd_bfd_sessions_single_hop_stats_remote_diagnostic_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_enum(xpath, bs->remote_diag);
+	return yang_data_new_enum(xpath, bs.remote_diag);
 }
 
 /*
@@ -162,9 +172,11 @@ struct yang_data *bfdd_bfd_sessions_single_hop_stats_remote_diagnostic_get_elem(
 struct yang_data *bfdd_bfd_sessions_single_hop_stats_remote_multiplier_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_int8(xpath, bs->remote_detect_mult);
+	return yang_data_new_int8(xpath, bs.remote_detect_mult);
 }
 
 /*
@@ -175,9 +187,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_negotiated_transmission_interval_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint32(xpath, bs->remote_timers.desired_min_tx);
+	return yang_data_new_uint32(xpath, bs.remote_timers.desired_min_tx);
 }
 
 /*
@@ -188,9 +202,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_negotiated_receive_interval_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint32(xpath, bs->remote_timers.required_min_rx);
+	return yang_data_new_uint32(xpath, bs.remote_timers.required_min_rx);
 }
 
 /*
@@ -199,9 +215,11 @@ bfdd_bfd_sessions_single_hop_stats_negotiated_receive_interval_get_elem(
 struct yang_data *bfdd_bfd_sessions_single_hop_stats_detection_mode_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
 	int detection_mode;
 
+	bs_snapshot(list_entry, &bs);
+
 	/*
 	 * Detection mode:
 	 *   1. Async with echo
@@ -211,7 +229,7 @@ struct yang_data *bfdd_bfd_sessions_single_hop_stats_detection_mode_get_elem(
 	 *
 	 * TODO: support demand mode.
 	 */
-	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_ECHO))
+	if (CHECK_FLAG(bs.flags, BFD_SESS_FLAG_ECHO))
 		detection_mode = 1;
 	else
 		detection_mode = 2;
@@ -256,9 +274,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_session_down_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.session_down);
+	return yang_data_new_uint64(xpath, bs.stats.session_down);
 }
 
 /*
@@ -267,9 +287,11 @@ bfdd_bfd_sessions_single_hop_stats_session_down_count_get_elem(
 struct yang_data *bfdd_bfd_sessions_single_hop_stats_session_up_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.session_up);
+	return yang_data_new_uint64(xpath, bs.stats.session_up);
 }
 
 /*
@@ -280,9 +302,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_control_packet_input_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.rx_ctrl_pkt);
+	return yang_data_new_uint64(xpath, bs.stats.rx_ctrl_pkt);
 }
 
 /*
@@ -293,9 +317,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_control_packet_output_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.tx_ctrl_pkt);
+	return yang_data_new_uint64(xpath, bs.stats.tx_ctrl_pkt);
 }
 
 /*
@@ -306,9 +332,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_negotiated_echo_transmission_interval_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint32(xpath, bs->remote_timers.required_min_echo);
+	return yang_data_new_uint32(xpath, bs.remote_timers.required_min_echo);
 }
 
 /*
@@ -318,9 +346,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_echo_packet_input_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.rx_echo_pkt);
+	return yang_data_new_uint64(xpath, bs.stats.rx_echo_pkt);
 }
 
 /*
@@ -330,9 +360,11 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_echo_packet_output_count_get_elem(
 	const char *xpath, const void *list_entry)
 {
-	const struct bfd_session *bs = list_entry;
+	struct bfd_session bs;
+
+	bs_snapshot(list_entry, &bs);
 
-	return yang_data_new_uint64(xpath, bs->stats.tx_echo_pkt);
+	return yang_data_new_uint64(xpath, bs.stats.tx_echo_pkt);
 }
 
 /*
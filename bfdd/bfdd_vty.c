@@ -104,9 +104,13 @@ static void _display_peer_header(struct vty *vty, struct bfd_session *bs)
 
 static void _display_peer(struct vty *vty, struct bfd_session *bs)
 {
+	struct bfd_session bs_copy;
 	char buf[256];
 	time_t now;
 
+	bs_snapshot(bs, &bs_copy);
+	bs = &bs_copy;
+
 	_display_peer_header(vty, bs);
 
 	vty_out(vty, "\t\tID: %u\n", bs->discrs.my_discr);
@@ -199,7 +203,12 @@ static struct json_object *_peer_json_header(struct bfd_session *bs)
 
 static struct json_object *__display_peer_json(struct bfd_session *bs)
 {
-	struct json_object *jo = _peer_json_header(bs);
+	struct bfd_session bs_copy;
+	struct json_object *jo;
+
+	bs_snapshot(bs, &bs_copy);
+	bs = &bs_copy;
+	jo = _peer_json_header(bs);
 
 	json_object_int_add(jo, "id", bs->discrs.my_discr);
 	json_object_int_add(jo, "remote-id", bs->discrs.remote_discr);
@@ -336,6 +345,10 @@ static void _display_all_peers(struct vty *vty, char *vrfname, bool use_json)
 
 static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
 {
+	struct bfd_session bs_copy;
+
+	bs_snapshot(bs, &bs_copy);
+	bs = &bs_copy;
 	_display_peer_header(vty, bs);
 
 	vty_out(vty, "\t\tControl packet input: %" PRIu64 " packets\n",
@@ -357,7 +370,12 @@ static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
 
 static struct json_object *__display_peer_counters_json(struct bfd_session *bs)
 {
-	struct json_object *jo = _peer_json_header(bs);
+	struct bfd_session bs_copy;
+	struct json_object *jo;
+
+	bs_snapshot(bs, &bs_copy);
+	bs = &bs_copy;
+	jo = _peer_json_header(bs);
 
 	json_object_int_add(jo, "control-packet-input", bs->stats.rx_ctrl_pkt);
 	json_object_int_add(jo, "control-packet-output", bs->stats.tx_ctrl_pkt);
@@ -455,8 +473,12 @@ static void _clear_peer_counter(struct bfd_session *bs)
 
 static void _display_peer_brief(struct vty *vty, struct bfd_session *bs)
 {
+	struct bfd_session bs_copy;
 	char addr_buf[INET6_ADDRSTRLEN];
 
+	bs_snapshot(bs, &bs_copy);
+	bs = &bs_copy;
+
 	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH)) {
 		vty_out(vty, "%-10u", bs->discrs.my_discr);
 		inet_ntop(bs->key.family, &bs->key.local, addr_buf, sizeof(addr_buf));
@@ -713,7 +735,9 @@ DEFPY(bfd_clear_peer_counters, bfd_clear_peer_counters_cmd,
 	if (bs == NULL)
 		return CMD_WARNING_CONFIG_FAILED;
     
-	_clear_peer_counter(bs);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		_clear_peer_counter(bs);
+	}
 
 	return CMD_SUCCESS;
 }
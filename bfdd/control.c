@@ -500,29 +500,33 @@ skip_header:
 	if (bcb->bcb_left > 0)
 		goto schedule_next_read;
 
-	switch (bcb->bcb_bcm->bcm_type) {
-	case BMT_REQUEST_ADD:
-		control_handle_request_add(bcs, bcb->bcb_bcm);
-		break;
-	case BMT_REQUEST_DEL:
-		control_handle_request_del(bcs, bcb->bcb_bcm);
-		break;
-	case BMT_NOTIFY:
-		control_handle_notify(bcs, bcb->bcb_bcm);
-		break;
-	case BMT_NOTIFY_ADD:
-		control_handle_notify_add(bcs, bcb->bcb_bcm);
-		break;
-	case BMT_NOTIFY_DEL:
-		control_handle_notify_del(bcs, bcb->bcb_bcm);
-		break;
-
-	default:
-		zlog_debug("%s: unhandled message type: %d", __func__,
-			   bcb->bcb_bcm->bcm_type);
-		control_response(bcs, bcb->bcb_bcm->bcm_id, BCM_RESPONSE_ERROR,
-				 "invalid message type");
-		break;
+	/* Requests change the sessions the fast path works on. */
+	frr_with_mutex(&bglobal.bg_mtx) {
+		switch (bcb->bcb_bcm->bcm_type) {
+		case BMT_REQUEST_ADD:
+			control_handle_request_add(bcs, bcb->bcb_bcm);
+			break;
+		case BMT_REQUEST_DEL:
+			control_handle_request_del(bcs, bcb->bcb_bcm);
+			break;
+		case BMT_NOTIFY:
+			control_handle_notify(bcs, bcb->bcb_bcm);
+			break;
+		case BMT_NOTIFY_ADD:
+			control_handle_notify_add(bcs, bcb->bcb_bcm);
+			break;
+		case BMT_NOTIFY_DEL:
+			control_handle_notify_del(bcs, bcb->bcb_bcm);
+			break;
+
+		default:
+			zlog_debug("%s: unhandled message type: %d", __func__,
+				   bcb->bcb_bcm->bcm_type);
+			control_response(bcs, bcb->bcb_bcm->bcm_id,
+					 BCM_RESPONSE_ERROR,
+					 "invalid message type");
+			break;
+		}
 	}
 
 	bcs->bcs_version = 0;
@@ -774,6 +778,14 @@ int control_notify(struct bfd_session *bs, uint8_t notify_state)
 	struct bfd_control_socket *bcs;
 	struct bfd_notify_peer *bnp;
 
+	/* Clients are served by the main pthread. */
+	if (bfd_fastpath_self()) {
+		bfd_fastpath_notify(bs, notify_state);
+		return 0;
+	}
+
+	bs->notify_gen++;
+
 	/* Notify zebra listeners as well. */
 	ptm_bfd_notify(bs, notify_state);
 
@@ -837,6 +849,11 @@ int control_notify_config(const char *op, struct bfd_session *bs)
 	struct bfd_control_socket *bcs;
 	struct bfd_notify_peer *bnp;
 
+	if (bfd_fastpath_self()) {
+		bfd_fastpath_notify_config(bs, op);
+		return 0;
+	}
+
 	/* Remove the control sockets notification for this peer. */
 	if (strcmp(op, BCM_NOTIFY_CONFIG_DELETE) == 0 && bs->refcount > 0) {
 		TAILQ_FOREACH (bcs, &bglobal.bg_bcslist, bcs_entry) {
@@ -23,105 +23,594 @@
  */
 
 #include <zebra.h>
+#include <sched.h>
+
+#include "lib/frratomic.h"
+#include "lib/monotime.h"
+#include "lib/spsc_ring.h"
 
 #include "bfd.h"
 
-void tv_normalize(struct timeval *tv);
+DEFINE_MTYPE_STATIC(BFDD, BFDD_FP_MSG, "BFD fast path message")
+
+/*
+ * Session timers and packet processing run on a dedicated pthread, so that
+ * a busy main pthread (CLI, northbound, zebra) can't make sessions miss
+ * their detection time.
+ *
+ * Timers are kept on a heap ordered by deadline instead of being one
+ * `struct thread` each: the main pthread must be able to arm and disarm
+ * them (configuration changes), and `thread_cancel()` may only be used by
+ * the pthread owning the task.  The fast path runs a single thread_master
+ * timer for the earliest deadline.
+ *
+ * Whatever the fast path can't do itself is passed to the main pthread
+ * through a lock-free ring, see `struct bfd_fp_msg`.
+ */
+
+/* Maximum number of messages waiting for the main pthread. */
+#define BFD_FP_RING_SIZE 4096
+/* Messages handled by the main pthread per event run. */
+#define BFD_FP_DRAIN_MAX 256
 
-void tv_normalize(struct timeval *tv)
+enum bfd_fp_msg_type {
+	/* State change notification for clients (zebra, control socket). */
+	BFD_FP_NOTIFY,
+	/* Timers change notification for control socket clients. */
+	BFD_FP_NOTIFY_CONFIG,
+	/* Control packet that needs the interface or VRF tables. */
+	BFD_FP_PACKET,
+};
+
+struct bfd_fp_msg {
+	enum bfd_fp_msg_type type;
+
+	/* BFD_FP_NOTIFY and BFD_FP_NOTIFY_CONFIG */
+	uint32_t discr;
+	uint8_t notify_state;
+	uint32_t notify_gen;
+	const char *op;
+
+	/* BFD_FP_PACKET */
+	bool is_mhop;
+	uint8_t ttl;
+	ifindex_t ifindex;
+	vrf_id_t vrfid;
+	struct sockaddr_any local;
+	struct sockaddr_any peer;
+	ssize_t mlen;
+	uint8_t data[];
+};
+
+static int bfd_timer_cmp(const struct bfd_timer *a, const struct bfd_timer *b)
 {
-	/* Remove seconds part from microseconds. */
-	tv->tv_sec = tv->tv_usec / 1000000;
-	tv->tv_usec = tv->tv_usec % 1000000;
+	if (a->deadline < b->deadline)
+		return -1;
+	if (a->deadline > b->deadline)
+		return 1;
+	return 0;
 }
 
-void bfd_recvtimer_update(struct bfd_session *bs)
+DECLARE_HEAP(bfd_timer_heap, struct bfd_timer, item, bfd_timer_cmp)
+
+static int bfd_timers_cb(struct thread *t);
+static int bfd_fp_drain(struct thread *t);
+
+static int64_t bfd_monotime_usec(void)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = bs->detect_TO};
+	struct timeval tv;
 
-	/* Remove previous schedule if any. */
-	bfd_recvtimer_delete(bs);
+	monotime(&tv);
+	return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
 
-	/* Don't add event if peer is deactivated. */
-	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
-	    bs->sock == -1)
-		return;
 
-	tv_normalize(&tv);
+/*
+ * Timers.
+ *
+ * All of these must be called with `bglobal.bg_mtx` held.
+ */
+void bfd_timers_init(struct bfd_session *bs)
+{
+	int type;
 
-	thread_add_timer_tv(master, bfd_recvtimer_cb, bs, &tv,
-			    &bs->recvtimer_ev);
+	for (type = 0; type < BFD_TIMER_MAX; type++) {
+		bs->timer[type].bs = bs;
+		bs->timer[type].type = type;
+	}
 }
 
-void bfd_echo_recvtimer_update(struct bfd_session *bs)
+/*
+ * Makes the fast path sleep until the earliest timer expires.  Must be
+ * called from the fast path.
+ */
+void bfd_timers_schedule(void)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = bs->echo_detect_TO};
+	struct bfd_timer *bt = bfd_timer_heap_first(&bglobal.bg_timers);
+	struct timeval tv;
+	int64_t delay;
 
-	/* Remove previous schedule if any. */
-	bfd_echo_recvtimer_delete(bs);
+	if (bt == NULL) {
+		THREAD_OFF(bglobal.bg_timer_ev);
+		bglobal.bg_wakeup = 0;
+		return;
+	}
 
-	/* Don't add event if peer is deactivated. */
-	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
-	    bs->sock == -1)
+	/* Waking up early is harmless, we just go back to sleep. */
+	if (bglobal.bg_timer_ev && bglobal.bg_wakeup <= bt->deadline)
 		return;
 
-	tv_normalize(&tv);
+	THREAD_OFF(bglobal.bg_timer_ev);
+
+	delay = bt->deadline - bfd_monotime_usec();
+	if (delay < 0)
+		delay = 0;
+	tv.tv_sec = delay / 1000000;
+	tv.tv_usec = delay % 1000000;
 
-	thread_add_timer_tv(master, bfd_echo_recvtimer_cb, bs, &tv,
-			    &bs->echo_recvtimer_ev);
+	thread_add_timer_tv(bglobal.bg_pth->master, bfd_timers_cb, NULL, &tv,
+			    &bglobal.bg_timer_ev);
+	bglobal.bg_wakeup = bt->deadline;
 }
 
-void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
+static int bfd_timers_kick(struct thread *t)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = jitter};
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfd_timers_schedule();
+	}
 
-	/* Remove previous schedule if any. */
-	bfd_xmttimer_delete(bs);
+	return 0;
+}
 
-	/* Don't add event if peer is deactivated. */
-	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
-	    bs->sock == -1)
+static void bfd_timer_delete(struct bfd_timer *bt)
+{
+	if (bt->deadline == 0)
 		return;
 
-	tv_normalize(&tv);
-
-	thread_add_timer_tv(master, bfd_xmt_cb, bs, &tv, &bs->xmttimer_ev);
+	bfd_timer_heap_del(&bglobal.bg_timers, bt);
+	bt->deadline = 0;
 }
 
-void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
+static void bfd_timer_update(struct bfd_session *bs, enum bfd_timer_type type,
+			     uint64_t usec)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = jitter};
+	struct bfd_timer *bt = &bs->timer[type];
 
 	/* Remove previous schedule if any. */
-	bfd_echo_xmttimer_delete(bs);
+	bfd_timer_delete(bt);
 
 	/* Don't add event if peer is deactivated. */
 	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
 	    bs->sock == -1)
 		return;
 
-	tv_normalize(&tv);
+	/* Nothing would run it once the fast path is stopped. */
+	if (bglobal.bg_pth == NULL)
+		return;
+
+	bt->deadline = bfd_monotime_usec() + usec;
+	bfd_timer_heap_add(&bglobal.bg_timers, bt);
 
-	thread_add_timer_tv(master, bfd_echo_xmt_cb, bs, &tv,
-			    &bs->echo_xmttimer_ev);
+	/*
+	 * The fast path reschedules itself once it is done with the current
+	 * batch; from the main pthread, wake it up if it would otherwise
+	 * sleep past the new deadline.
+	 */
+	if (bfd_fastpath_self())
+		return;
+	if (bglobal.bg_wakeup == 0 || bt->deadline < bglobal.bg_wakeup)
+		thread_add_event(bglobal.bg_pth->master, bfd_timers_kick, NULL,
+				 0, &bglobal.bg_kick_ev);
+}
+
+static void bfd_timers_expire(void)
+{
+	struct bfd_timer *bt;
+	int64_t now = bfd_monotime_usec();
+
+	while ((bt = bfd_timer_heap_first(&bglobal.bg_timers))
+	       && bt->deadline <= now) {
+		bfd_timer_heap_pop(&bglobal.bg_timers);
+		bt->deadline = 0;
+
+		switch (bt->type) {
+		case BFD_TIMER_RECV:
+			bfd_recvtimer_cb(bt->bs);
+			break;
+		case BFD_TIMER_ECHO_RECV:
+			bfd_echo_recvtimer_cb(bt->bs);
+			break;
+		case BFD_TIMER_XMT:
+			bfd_xmt_cb(bt->bs);
+			break;
+		case BFD_TIMER_ECHO_XMT:
+			bfd_echo_xmt_cb(bt->bs);
+			break;
+		case BFD_TIMER_MAX:
+			break;
+		}
+	}
+}
+
+static int bfd_timers_cb(struct thread *t)
+{
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfd_timers_expire();
+		bfd_timers_schedule();
+	}
+
+	return 0;
+}
+
+void bfd_recvtimer_update(struct bfd_session *bs)
+{
+	bfd_timer_update(bs, BFD_TIMER_RECV, bs->detect_TO);
+}
+
+void bfd_echo_recvtimer_update(struct bfd_session *bs)
+{
+	bfd_timer_update(bs, BFD_TIMER_ECHO_RECV, bs->echo_detect_TO);
+}
+
+void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
+{
+	bfd_timer_update(bs, BFD_TIMER_XMT, jitter);
+}
+
+void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
+{
+	bfd_timer_update(bs, BFD_TIMER_ECHO_XMT, jitter);
 }
 
 void bfd_recvtimer_delete(struct bfd_session *bs)
 {
-	THREAD_OFF(bs->recvtimer_ev);
+	bfd_timer_delete(&bs->timer[BFD_TIMER_RECV]);
 }
 
 void bfd_echo_recvtimer_delete(struct bfd_session *bs)
 {
-	THREAD_OFF(bs->echo_recvtimer_ev);
+	bfd_timer_delete(&bs->timer[BFD_TIMER_ECHO_RECV]);
 }
 
 void bfd_xmttimer_delete(struct bfd_session *bs)
 {
-	THREAD_OFF(bs->xmttimer_ev);
+	bfd_timer_delete(&bs->timer[BFD_TIMER_XMT]);
 }
 
 void bfd_echo_xmttimer_delete(struct bfd_session *bs)
 {
-	THREAD_OFF(bs->echo_xmttimer_ev);
+	bfd_timer_delete(&bs->timer[BFD_TIMER_ECHO_XMT]);
+}
+
+
+/*
+ * Fast path to main pthread messages.
+ *
+ * The fast path is the only producer, the main pthread the only consumer.
+ */
+static bool bfd_fp_push(struct bfd_fp_msg *msg)
+{
+	bool queued = spsc_ring_push(bglobal.bg_fp_ring, msg);
+
+	if (!queued) {
+		atomic_fetch_add_explicit(&bglobal.bg_fp_overflow, 1,
+					  memory_order_relaxed);
+		XFREE(MTYPE_BFDD_FP_MSG, msg);
+	}
+
+	thread_add_event(master, bfd_fp_drain, NULL, 0, &bglobal.bg_fp_ev);
+
+	return queued;
+}
+
+/*
+ * Notifications that don't fit on the ring are kept in the session until
+ * the main pthread catches up; the session then stays off the ring so that
+ * its notifications can't be reordered.
+ */
+void bfd_fastpath_notify(struct bfd_session *bs, uint8_t notify_state)
+{
+	struct bfd_fp_msg *msg;
+
+	if (!bs->notify_pending) {
+		msg = XCALLOC(MTYPE_BFDD_FP_MSG, sizeof(*msg));
+		msg->type = BFD_FP_NOTIFY;
+		msg->discr = bs->discrs.my_discr;
+		msg->notify_state = notify_state;
+		msg->notify_gen = bs->notify_gen;
+		if (bfd_fp_push(msg))
+			return;
+	}
+
+	bs->notify_pending = true;
+	bs->notify_state = notify_state;
+	bs->notify_pending_gen = bs->notify_gen;
+	atomic_store_explicit(&bglobal.bg_fp_resync, true,
+			      memory_order_relaxed);
+}
+
+void bfd_fastpath_notify_config(struct bfd_session *bs, const char *op)
+{
+	struct bfd_fp_msg *msg;
+
+	if (!bs->notify_config_pending) {
+		msg = XCALLOC(MTYPE_BFDD_FP_MSG, sizeof(*msg));
+		msg->type = BFD_FP_NOTIFY_CONFIG;
+		msg->discr = bs->discrs.my_discr;
+		msg->op = op;
+		if (bfd_fp_push(msg))
+			return;
+	}
+
+	bs->notify_config_pending = true;
+	atomic_store_explicit(&bglobal.bg_fp_resync, true,
+			      memory_order_relaxed);
+}
+
+void bfd_fastpath_slow_pkt(struct bfd_pkt *cp, ssize_t mlen, bool is_mhop,
+			   uint8_t ttl, ifindex_t ifindex, vrf_id_t vrfid,
+			   struct sockaddr_any *local,
+			   struct sockaddr_any *peer)
+{
+	struct bfd_fp_msg *msg;
+
+	msg = XCALLOC(MTYPE_BFDD_FP_MSG, sizeof(*msg) + mlen);
+	msg->type = BFD_FP_PACKET;
+	msg->is_mhop = is_mhop;
+	msg->ttl = ttl;
+	msg->ifindex = ifindex;
+	msg->vrfid = vrfid;
+	msg->local = *local;
+	msg->peer = *peer;
+	msg->mlen = mlen;
+	memcpy(msg->data, cp, mlen);
+
+	/* Dropping it is fine, the peer sends another one soon. */
+	bfd_fp_push(msg);
+}
+
+/*
+ * Sends a state notification queued by the fast path, unless the main
+ * pthread notified a newer state in the meantime.
+ */
+static void bfd_fp_notify(struct bfd_session *bs, uint8_t notify_state,
+			  uint32_t notify_gen)
+{
+	if (bs->notify_gen != notify_gen)
+		return;
+
+	control_notify(bs, notify_state);
+
+	/* This one isn't newer than the fast path's. */
+	bs->notify_gen = notify_gen;
+}
+
+/* Sends the notifications that didn't fit on the ring. */
+static void bfd_fp_resync_session(struct hash_bucket *hb, void *arg)
+{
+	struct bfd_session *bs = hb->data;
+
+	if (bs->notify_pending) {
+		bs->notify_pending = false;
+		bfd_fp_notify(bs, bs->notify_state, bs->notify_pending_gen);
+	}
+	if (bs->notify_config_pending) {
+		bs->notify_config_pending = false;
+		control_notify_config(BCM_NOTIFY_CONFIG_UPDATE, bs);
+	}
+}
+
+static void bfd_fp_handle(struct bfd_fp_msg *msg)
+{
+	struct bfd_session *bs;
+
+	switch (msg->type) {
+	case BFD_FP_NOTIFY:
+		bs = bfd_id_lookup(msg->discr);
+		if (bs)
+			bfd_fp_notify(bs, msg->notify_state, msg->notify_gen);
+		break;
+
+	case BFD_FP_NOTIFY_CONFIG:
+		bs = bfd_id_lookup(msg->discr);
+		if (bs)
+			control_notify_config(msg->op, bs);
+		break;
+
+	case BFD_FP_PACKET:
+		bfd_recv_ctrl_pkt((struct bfd_pkt *)msg->data, msg->mlen,
+				  msg->is_mhop, msg->ttl, msg->ifindex,
+				  msg->vrfid, &msg->local, &msg->peer);
+		break;
+	}
+}
+
+static int bfd_fp_drain(struct thread *t)
+{
+	struct bfd_fp_msg *msg;
+	unsigned int count;
+
+	/*
+	 * Take the lock per message, the fast path shouldn't wait for us
+	 * to go through the whole ring.
+	 */
+	for (count = 0; count < BFD_FP_DRAIN_MAX; count++) {
+		msg = spsc_ring_pop(bglobal.bg_fp_ring);
+		if (msg == NULL)
+			break;
+
+		frr_with_mutex(&bglobal.bg_mtx) {
+			bfd_fp_handle(msg);
+		}
+		XFREE(MTYPE_BFDD_FP_MSG, msg);
+	}
+
+	if (count == BFD_FP_DRAIN_MAX) {
+		thread_add_event(master, bfd_fp_drain, NULL, 0,
+				 &bglobal.bg_fp_ev);
+		return 0;
+	}
+
+	if (atomic_exchange_explicit(&bglobal.bg_fp_resync, false,
+				     memory_order_relaxed)) {
+		frr_with_mutex(&bglobal.bg_mtx) {
+			bfd_id_iterate(bfd_fp_resync_session, NULL);
+		}
+	}
+
+	return 0;
+}
+
+static void bfd_fp_msg_free(void *arg)
+{
+	struct bfd_fp_msg *msg = arg;
+
+	XFREE(MTYPE_BFDD_FP_MSG, msg);
+}
+
+
+/*
+ * Fast path pthread.
+ */
+void bfd_fastpath_init(void)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+
+	pthread_mutex_init(&bglobal.bg_mtx, NULL);
+	bfd_timer_heap_init(&bglobal.bg_timers);
+	bglobal.bg_fp_ring = spsc_ring_new(BFD_FP_RING_SIZE);
+	bglobal.bg_pth = frr_pthread_new(&attr, "BFD fast path", "bfdd_fp");
+}
+
+void bfd_fastpath_run(void)
+{
+	struct sched_param param = {};
+	int rv = 0;
+
+	frr_pthread_run(bglobal.bg_pth, NULL);
+	frr_pthread_wait_running(bglobal.bg_pth);
+
+	/*
+	 * Detection times go down to tens of milliseconds, don't let other
+	 * processes on a busy box delay us.
+	 */
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+	frr_with_privs(&bglobal.bfdd_privs) {
+		rv = pthread_setschedparam(bglobal.bg_pth->thread, SCHED_FIFO,
+					   &param);
+	}
+	if (rv != 0)
+		zlog_warn("%s: failed to set realtime priority: %s", __func__,
+			  safe_strerror(rv));
+
+	/* Timers armed while reading the configuration. */
+	thread_add_event(bglobal.bg_pth->master, bfd_timers_kick, NULL, 0,
+			 &bglobal.bg_kick_ev);
+}
+
+/* Cancels the fast path's own tasks, on the fast path. */
+static void bfd_fp_cancel_tasks(void *arg)
+{
+	THREAD_OFF(bglobal.bg_timer_ev);
+	THREAD_OFF(bglobal.bg_kick_ev);
+	bfd_vrfs_stop_reads();
+}
+
+/*
+ * Stops the fast path pthread.  Must be called before any of the state it
+ * uses (sessions, hashes, VRF sockets) is torn down.
+ */
+void bfd_fastpath_stop(void)
+{
+	struct bfd_timer *bt;
+
+	if (bglobal.bg_pth == NULL)
+		return;
+
+	/*
+	 * Don't leave references to tasks behind, they go away with the
+	 * pthread's thread_master.
+	 */
+	bfd_fastpath_call(bfd_fp_cancel_tasks, NULL);
+
+	frr_pthread_stop(bglobal.bg_pth, NULL);
+	frr_pthread_destroy(bglobal.bg_pth);
+	bglobal.bg_pth = NULL;
+
+	THREAD_OFF(bglobal.bg_fp_ev);
+	spsc_ring_del(bglobal.bg_fp_ring, bfd_fp_msg_free);
+	bglobal.bg_fp_ring = NULL;
+
+	frr_with_mutex(&bglobal.bg_mtx) {
+		while ((bt = bfd_timer_heap_pop(&bglobal.bg_timers)))
+			bt->deadline = 0;
+	}
+}
+
+/* Releases what is left once all sessions and VRFs are gone. */
+void bfd_fastpath_fini(void)
+{
+	bfd_timer_heap_fini(&bglobal.bg_timers);
+	pthread_mutex_destroy(&bglobal.bg_mtx);
+}
+
+struct thread_master *bfd_fastpath_master(void)
+{
+	return bglobal.bg_pth->master;
+}
+
+struct bfd_fp_call {
+	void (*func)(void *arg);
+	void *arg;
+
+	bool done;
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+};
+
+static int bfd_fp_call_cb(struct thread *t)
+{
+	struct bfd_fp_call *call = THREAD_ARG(t);
+
+	call->func(call->arg);
+
+	frr_with_mutex(&call->mtx) {
+		call->done = true;
+		pthread_cond_signal(&call->cond);
+	}
+
+	return 0;
+}
+
+/*
+ * Runs func on the fast path from the main pthread and waits for it to
+ * return, so nothing func cancels can still be running afterwards.  Before
+ * the fast path was started, or once it is stopped, func runs right away.
+ */
+void bfd_fastpath_call(void (*func)(void *arg), void *arg)
+{
+	struct bfd_fp_call call = {.func = func, .arg = arg};
+	struct thread_master *m;
+
+	if (bglobal.bg_pth == NULL
+	    || (m = bfd_fastpath_master())->owner == pthread_self()) {
+		func(arg);
+		return;
+	}
+
+	pthread_mutex_init(&call.mtx, NULL);
+	pthread_cond_init(&call.cond, NULL);
+
+	thread_add_event(m, bfd_fp_call_cb, &call, 0, NULL);
+
+	frr_with_mutex(&call.mtx) {
+		while (!call.done)
+			pthread_cond_wait(&call.cond, &call.mtx);
+	}
+
+	pthread_cond_destroy(&call.cond);
+	pthread_mutex_destroy(&call.mtx);
 }
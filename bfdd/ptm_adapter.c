@@ -517,25 +517,29 @@ static int bfdd_replay(ZAPI_CALLBACK_ARGS)
 
 	STREAM_GETL(msg, rcmd);
 
-	switch (rcmd) {
-	case ZEBRA_BFD_DEST_REGISTER:
-	case ZEBRA_BFD_DEST_UPDATE:
-		bfdd_dest_register(msg, vrf_id);
-		break;
-	case ZEBRA_BFD_DEST_DEREGISTER:
-		bfdd_dest_deregister(msg, vrf_id);
-		break;
-	case ZEBRA_BFD_CLIENT_REGISTER:
-		bfdd_client_register(msg);
-		break;
-	case ZEBRA_BFD_CLIENT_DEREGISTER:
-		bfdd_client_deregister(msg);
-		break;
-
-	default:
-		if (bglobal.debug_zebra)
-			zlog_debug("ptm-replay: invalid message type %u", rcmd);
-		return -1;
+	frr_with_mutex(&bglobal.bg_mtx) {
+		switch (rcmd) {
+		case ZEBRA_BFD_DEST_REGISTER:
+		case ZEBRA_BFD_DEST_UPDATE:
+			bfdd_dest_register(msg, vrf_id);
+			break;
+		case ZEBRA_BFD_DEST_DEREGISTER:
+			bfdd_dest_deregister(msg, vrf_id);
+			break;
+		case ZEBRA_BFD_CLIENT_REGISTER:
+			bfdd_client_register(msg);
+			break;
+		case ZEBRA_BFD_CLIENT_DEREGISTER:
+			bfdd_client_deregister(msg);
+			break;
+
+		default:
+			if (bglobal.debug_zebra)
+				zlog_debug(
+					"ptm-replay: invalid message type %u",
+					rcmd);
+			return -1;
+		}
 	}
 
 	return 0;
@@ -665,7 +669,9 @@ static int bfd_ifp_destroy(struct interface *ifp)
 	if (bglobal.debug_zebra)
 		zlog_debug("zclient: delete interface %s", ifp->name);
 
-	bfdd_sessions_disable_interface(ifp);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfdd_sessions_disable_interface(ifp);
+	}
 
 	return 0;
 }
@@ -722,7 +728,9 @@ static int bfdd_interface_address_update(ZAPI_CALLBACK_ARGS)
 							      : "delete",
 			   prefix2str(ifc->address, buf, sizeof(buf)));
 
-	bfdd_sessions_enable_address(ifc);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfdd_sessions_enable_address(ifc);
+	}
 
 	return 0;
 }
@@ -732,7 +740,9 @@ static int bfd_ifp_create(struct interface *ifp)
 	if (bglobal.debug_zebra)
 		zlog_debug("zclient: add interface %s", ifp->name);
 
-	bfdd_sessions_enable_interface(ifp);
+	frr_with_mutex(&bglobal.bg_mtx) {
+		bfdd_sessions_enable_interface(ifp);
+	}
 
 	return 0;
 }
@@ -88,6 +88,9 @@ struct assegment_header {
 /* Hash for aspath.  This is the top level structure of AS path. */
 static struct hash *ashash;
 
+/* Id for the next newly interned AS path */
+static uint32_t aspath_id_next;
+
 /* Stream for SNMP. See aspath_snmp_pathseg */
 static struct stream *snmp_stream;
 
@@ -676,6 +679,12 @@ struct aspath *aspath_intern(struct aspath *aspath)
 	find = hash_get(ashash, aspath, hash_alloc_intern);
 	if (find != aspath)
 		aspath_free(aspath);
+	else {
+		/* Newly interned */
+		if (++aspath_id_next == 0)
+			aspath_id_next++;
+		find->id = aspath_id_next;
+	}
 
 	find->refcnt++;
 
@@ -72,6 +72,10 @@ struct aspath {
 	   and AS path regular expression match.  */
 	char *str;
 	unsigned short str_len;
+
+	/* Unique among interned AS paths, 0 if not interned.  Lets AS path
+	   filters cache their verdicts. */
+	uint32_t id;
 };
 
 #define ASPATH_STR_DEFAULT_LEN 32
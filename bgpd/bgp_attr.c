@@ -802,12 +802,10 @@ static void *bgp_attr_hash_alloc(void *p)
 	return attr;
 }
 
-/* Internet argument attribute. */
-struct attr *bgp_attr_intern(struct attr *attr)
+/* Intern the structures referenced by an attribute, taking one reference on
+ * each.  Balanced by bgp_attr_unintern_sub(). */
+void bgp_attr_intern_sub(struct attr *attr)
 {
-	struct attr *find;
-
-	/* Intern referenced strucutre. */
 	if (attr->aspath) {
 		if (!attr->aspath->refcnt)
 			attr->aspath = aspath_intern(attr->aspath);
@@ -873,6 +871,46 @@ struct attr *bgp_attr_intern(struct attr *attr)
 			attr->vnc_subtlvs->refcnt++;
 	}
 #endif
+}
+
+/* Whether all structures referenced by an attribute are interned already, in
+ * which case bgp_attr_intern_sub() only takes references and leaves the
+ * pointers alone. */
+bool bgp_attr_sub_interned(const struct attr *attr)
+{
+	if (attr->aspath && !attr->aspath->refcnt)
+		return false;
+	if (attr->community && !attr->community->refcnt)
+		return false;
+	if (attr->ecommunity && !attr->ecommunity->refcnt)
+		return false;
+	if (attr->lcommunity && !attr->lcommunity->refcnt)
+		return false;
+	if (attr->cluster && !attr->cluster->refcnt)
+		return false;
+	if (attr->transit && !attr->transit->refcnt)
+		return false;
+	if (attr->encap_subtlvs && !attr->encap_subtlvs->refcnt)
+		return false;
+	if (attr->srv6_l3vpn && !attr->srv6_l3vpn->refcnt)
+		return false;
+	if (attr->srv6_vpn && !attr->srv6_vpn->refcnt)
+		return false;
+#ifdef ENABLE_BGP_VNC
+	if (attr->vnc_subtlvs && !attr->vnc_subtlvs->refcnt)
+		return false;
+#endif
+
+	return true;
+}
+
+/* Internet argument attribute. */
+struct attr *bgp_attr_intern(struct attr *attr)
+{
+	struct attr *find;
+
+	/* Intern referenced strucutre. */
+	bgp_attr_intern_sub(attr);
 
 	/* At this point, attr only contains intern'd pointers.  that means
 	 * if we find it in attrhash, it has all the same pointers and we
@@ -67,6 +67,7 @@ DEFINE_MTYPE_STATIC(BMP, BMP_LISTENER,	"BMP listener")
 DEFINE_MTYPE_STATIC(BMP, BMP_ACTIVE,	"BMP active connection config")
 DEFINE_MTYPE_STATIC(BMP, BMP_ACLNAME,	"BMP access-list name")
 DEFINE_MTYPE_STATIC(BMP, BMP_QUEUE,	"BMP update queue item")
+DEFINE_MTYPE_STATIC(BMP, BMP_MONCACHE,	"BMP route monitoring cache")
 DEFINE_MTYPE_STATIC(BMP, BMP,		"BMP instance state")
 DEFINE_MTYPE_STATIC(BMP, BMP_MIRRORQ,	"BMP route mirroring buffer")
 DEFINE_MTYPE_STATIC(BMP, BMP_PEER,	"BMP per BGP peer data")
@@ -173,6 +174,34 @@ static uint32_t bmp_qhash_hkey(const struct bmp_queue_entry *e)
 DECLARE_HASH(bmp_qhash, struct bmp_queue_entry, bhi,
 		bmp_qhash_cmp, bmp_qhash_hkey)
 
+static int bmp_mchash_cmp(const struct bmp_moncache *a,
+		const struct bmp_moncache *b)
+{
+	int ret;
+	ret = prefix_cmp(&a->p, &b->p);
+	if (ret)
+		return ret;
+	ret = memcmp(&a->peerid, &b->peerid,
+			offsetof(struct bmp_moncache, refcount) -
+			offsetof(struct bmp_moncache, peerid));
+	return ret;
+}
+
+static uint32_t bmp_mchash_hkey(const struct bmp_moncache *e)
+{
+	uint32_t key;
+
+	key = prefix_hash_key((void *)&e->p);
+	key = jhash(&e->peerid,
+			offsetof(struct bmp_moncache, refcount) -
+			offsetof(struct bmp_moncache, peerid),
+			key);
+	return key;
+}
+
+DECLARE_HASH(bmp_mchash, struct bmp_moncache, bmi,
+		bmp_mchash_cmp, bmp_mchash_hkey)
+
 static int bmp_active_cmp(const struct bmp_active *a,
 		const struct bmp_active *b)
 {
@@ -853,11 +882,12 @@ static struct stream *bmp_withdraw(const struct prefix *p, afi_t afi,
 	return s;
 }
 
-static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
-			const struct prefix *p, struct attr *attr, afi_t afi,
-			safi_t safi, time_t uptime)
+static struct stream *bmp_monitor_encode(struct peer *peer, uint8_t flags,
+					 const struct prefix *p,
+					 struct attr *attr, afi_t afi,
+					 safi_t safi, time_t uptime)
 {
-	struct stream *hdr, *msg;
+	struct stream *hdr, *msg, *s;
 	struct timeval tv = { .tv_sec = uptime, .tv_usec = 0 };
 
 	if (attr)
@@ -872,11 +902,26 @@ static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
 	stream_putl_at(hdr, BMP_LENGTH_POS,
 			stream_get_endp(hdr) + stream_get_endp(msg));
 
-	bmp->cnt_update++;
-	pullwr_write_stream(bmp->pullwr, hdr);
-	pullwr_write_stream(bmp->pullwr, msg);
+	s = stream_new(stream_get_endp(hdr) + stream_get_endp(msg));
+	stream_put(s, STREAM_DATA(hdr), stream_get_endp(hdr));
+	stream_put(s, STREAM_DATA(msg), stream_get_endp(msg));
+
 	stream_free(hdr);
 	stream_free(msg);
+	return s;
+}
+
+static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
+			const struct prefix *p, struct attr *attr, afi_t afi,
+			safi_t safi, time_t uptime)
+{
+	struct stream *s;
+
+	s = bmp_monitor_encode(peer, flags, p, attr, afi, safi, uptime);
+
+	bmp->cnt_update++;
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
 }
 
 static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
@@ -1001,6 +1046,108 @@ afibreak:
 	return true;
 }
 
+static struct bmp_moncache *bmp_moncache_get(struct bmp_bgp *bmpbgp,
+					     const struct bmp_queue_entry *bqe)
+{
+	struct bmp_moncache *mc, mcref;
+
+	memset(&mcref, 0, sizeof(mcref));
+	prefix_copy(&mcref.p, &bqe->p);
+	mcref.peerid = bqe->peerid;
+	mcref.afi = bqe->afi;
+	mcref.safi = bqe->safi;
+
+	mc = bmp_mchash_find(&bmpbgp->mchash, &mcref);
+	if (!mc) {
+		mc = XCALLOC(MTYPE_BMP_MONCACHE, sizeof(*mc));
+		memcpy(mc, &mcref, sizeof(*mc));
+		bmp_mchash_add(&bmpbgp->mchash, mc);
+	}
+
+	mc->refcount++;
+	return mc;
+}
+
+static void bmp_moncache_flush(struct bmp_moncache *mc)
+{
+	stream_free(mc->msg[BMP_MC_PREPOLICY]);
+	stream_free(mc->msg[BMP_MC_POSTPOLICY]);
+	mc->msg[BMP_MC_PREPOLICY] = NULL;
+	mc->msg[BMP_MC_POSTPOLICY] = NULL;
+}
+
+/* for queue entries pulled by the last session wanting them */
+static void bmp_qentry_free(struct bmp_bgp *bmpbgp,
+			    struct bmp_queue_entry *bqe)
+{
+	struct bmp_moncache *mc = bqe->mc;
+
+	if (!--mc->refcount) {
+		bmp_moncache_flush(mc);
+		bmp_mchash_del(&bmpbgp->mchash, mc);
+		XFREE(MTYPE_BMP_MONCACHE, mc);
+	}
+
+	XFREE(MTYPE_BMP_QUEUE, bqe);
+}
+
+/* Sends the cached message, encoding it first if no other session did yet;
+ * bn is looked up on demand.
+ */
+static void bmp_monitor_cached(struct bmp *bmp, struct bmp_queue_entry *bqe,
+			       struct peer *peer, int policy,
+			       struct bgp_node **bn)
+{
+	struct bmp_bgp *bmpbgp = bmp->targets->bmpbgp;
+	struct bmp_moncache *mc = bqe->mc;
+	struct attr *attr = NULL;
+	time_t uptime = monotime(NULL);
+
+	if (mc->msg[policy]) {
+		bmpbgp->cnt_mon_shared++;
+		goto send;
+	}
+
+	if (!*bn)
+		*bn = bgp_node_lookup(bmp->targets->bgp->rib[bqe->afi][bqe->safi],
+				      &bqe->p);
+
+	if (policy == BMP_MC_POSTPOLICY) {
+		struct bgp_path_info *bpi;
+
+		for (bpi = *bn ? (*bn)->info : NULL; bpi; bpi = bpi->next) {
+			if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
+				continue;
+			if (bpi->peer == peer)
+				break;
+		}
+		if (bpi) {
+			attr = bpi->attr;
+			uptime = bpi->uptime;
+		}
+	} else {
+		struct bgp_adj_in *adjin;
+
+		for (adjin = *bn ? (*bn)->adj_in : NULL; adjin;
+		     adjin = adjin->next) {
+			if (adjin->peer == peer)
+				break;
+		}
+		if (adjin) {
+			attr = adjin->attr;
+			uptime = adjin->uptime;
+		}
+	}
+
+	mc->msg[policy] = bmp_monitor_encode(peer, BMP_PEER_FLAG_L, &bqe->p,
+					     attr, bqe->afi, bqe->safi, uptime);
+	bmpbgp->cnt_mon_encoded++;
+
+send:
+	bmp->cnt_update++;
+	pullwr_write_stream(bmp->pullwr, mc->msg[policy]);
+}
+
 static struct bmp_queue_entry *bmp_pull(struct bmp *bmp)
 {
 	struct bmp_queue_entry *bqe;
@@ -1023,7 +1170,7 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 {
 	struct bmp_queue_entry *bqe;
 	struct peer *peer;
-	struct bgp_node *bn;
+	struct bgp_node *bn = NULL;
 	bool written = false;
 
 	bqe = bmp_pull(bmp);
@@ -1058,41 +1205,22 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 	if (peer->status != Established)
 		goto out;
 
-	bn = bgp_node_lookup(bmp->targets->bgp->rib[afi][safi], &bqe->p);
-
 	if (bmp->targets->afimon[afi][safi] & BMP_MON_POSTPOLICY) {
-		struct bgp_path_info *bpi;
-
-		for (bpi = bn ? bn->info : NULL; bpi; bpi = bpi->next) {
-			if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
-				continue;
-			if (bpi->peer == peer)
-				break;
-		}
-
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p,
-			    bpi ? bpi->attr : NULL, afi, safi,
-			    bpi ? bpi->uptime : monotime(NULL));
+		bmp_monitor_cached(bmp, bqe, peer, BMP_MC_POSTPOLICY, &bn);
 		written = true;
 	}
 
 	if (bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) {
-		struct bgp_adj_in *adjin;
-
-		for (adjin = bn ? bn->adj_in : NULL; adjin;
-		     adjin = adjin->next) {
-			if (adjin->peer == peer)
-				break;
-		}
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p,
-			    adjin ? adjin->attr : NULL, afi, safi,
-			    adjin ? adjin->uptime : monotime(NULL));
+		bmp_monitor_cached(bmp, bqe, peer, BMP_MC_PREPOLICY, &bn);
 		written = true;
 	}
 
+	if (bn)
+		bgp_unlock_node(bn);
+
 out:
 	if (!bqe->refcount)
-		XFREE(MTYPE_BMP_QUEUE, bqe);
+		bmp_qentry_free(bmp->targets->bmpbgp, bqe);
 	return written;
 }
 
@@ -1154,6 +1282,7 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp,
 	} else {
 		bqe = XMALLOC(MTYPE_BMP_QUEUE, sizeof(*bqe));
 		memcpy(bqe, &bqeref, sizeof(*bqe));
+		bqe->mc = bmp_moncache_get(bt->bmpbgp, bqe);
 
 		bmp_qhash_add(&bt->updhash, bqe);
 	}
@@ -1172,10 +1301,22 @@ static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
 	struct bmp_bgp *bmpbgp = bmp_bgp_find(peer->bgp);
 	struct bmp_targets *bt;
 	struct bmp *bmp;
+	struct bmp_moncache *mc, mcref;
 
 	if (!bmpbgp)
 		return 0;
 
+	/* the route changed, messages encoded earlier are stale now */
+	memset(&mcref, 0, sizeof(mcref));
+	prefix_copy(&mcref.p, bgp_node_get_prefix(bn));
+	mcref.peerid = peer->qobj_node.nid;
+	mcref.afi = afi;
+	mcref.safi = safi;
+
+	mc = bmp_mchash_find(&bmpbgp->mchash, &mcref);
+	if (mc)
+		bmp_moncache_flush(mc);
+
 	frr_each(bmp_targets, &bmpbgp->targets, bt) {
 		if (!bt->afimon[afi][safi])
 			continue;
@@ -1362,7 +1503,7 @@ static void bmp_close(struct bmp *bmp)
 			XFREE(MTYPE_BMP_MIRRORQ, bmq);
 	while ((bqe = bmp_pull(bmp)))
 		if (!bqe->refcount)
-			XFREE(MTYPE_BMP_QUEUE, bqe);
+			bmp_qentry_free(bmp->targets->bmpbgp, bqe);
 
 	THREAD_OFF(bmp->t_read);
 	pullwr_del(bmp->pullwr);
@@ -1387,6 +1528,7 @@ static struct bmp_bgp *bmp_bgp_get(struct bgp *bgp)
 	bmpbgp->bgp = bgp;
 	bmpbgp->mirror_qsizelimit = ~0UL;
 	bmp_mirrorq_init(&bmpbgp->mirrorq);
+	bmp_mchash_init(&bmpbgp->mchash);
 	bmp_bgph_add(&bmp_bgph, bmpbgp);
 
 	return bmpbgp;
@@ -1402,6 +1544,7 @@ static void bmp_bgp_put(struct bmp_bgp *bmpbgp)
 		bmp_targets_put(bt);
 
 	bmp_mirrorq_fini(&bmpbgp->mirrorq);
+	bmp_mchash_fini(&bmpbgp->mchash);
 	XFREE(MTYPE_BMP, bmpbgp);
 }
 
@@ -2095,6 +2238,9 @@ DEFPY(show_bmp,
 		if (bmpbgp->mirror_qsizelimit != ~0UL)
 			vty_out(vty, "                  %9zu bytes buffer size limit\n",
 					bmpbgp->mirror_qsizelimit);
+		vty_out(vty, "  Route Monitoring %8" PRIu64 " messages encoded, %" PRIu64 " shared\n",
+				bmpbgp->cnt_mon_encoded,
+				bmpbgp->cnt_mon_shared);
 		vty_out(vty, "\n");
 
 		frr_each(bmp_targets, &bmpbgp->targets, bt) {
@@ -69,6 +69,8 @@
 PREDECL_DLIST(bmp_qlist)
 PREDECL_HASH(bmp_qhash)
 
+struct bmp_moncache;
+
 struct bmp_queue_entry {
 	struct bmp_qlist_item bli;
 	struct bmp_qhash_item bhi;
@@ -79,6 +81,38 @@ struct bmp_queue_entry {
 	safi_t safi;
 
 	size_t refcount;
+
+	/* shared with the entries for the same tuple in other targets */
+	struct bmp_moncache *mc;
+};
+
+/* The Route Monitoring message for a (bgp, afi, safi, prefix, peerid) tuple
+ * is the same for every session and every target, until the route changes.
+ * The first session to send it out encodes it and keeps it here for the
+ * others to copy; bmp_process() drops it when the route changes, which is
+ * also when the queue entries leading here are queued again.
+ *
+ * These are kept per "struct bgp *", refcount = number of queue entries,
+ * across all targets, pointing here.
+ */
+
+PREDECL_HASH(bmp_mchash)
+
+#define BMP_MC_PREPOLICY	0
+#define BMP_MC_POSTPOLICY	1
+
+struct bmp_moncache {
+	struct bmp_mchash_item bmi;
+
+	struct prefix p;
+	uint64_t peerid;
+	afi_t afi;
+	safi_t safi;
+
+	size_t refcount;
+
+	/* complete BMP messages, NULL until encoded */
+	struct stream *msg[2];
 };
 
 /* This is for BMP Route Mirroring, which feeds fully raw BGP PDUs out to BMP
@@ -271,6 +305,10 @@ struct bmp_bgp {
 	size_t mirror_qsize, mirror_qsizemax;
 
 	size_t mirror_qsizelimit;
+
+	struct bmp_mchash_head mchash;
+	/* Route Monitoring messages encoded vs. copied from the cache */
+	uint64_t cnt_mon_encoded, cnt_mon_shared;
 };
 
 enum {
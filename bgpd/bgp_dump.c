@@ -30,6 +30,9 @@
 #include "queue.h"
 #include "memory.h"
 #include "filter.h"
+#include "frr_pthread.h"
+#include "monotime.h"
+#include "network.h"
 
 #include "bgpd/bgp_table.h"
 #include "bgpd/bgpd.h"
@@ -39,6 +42,8 @@
 #include "bgpd/bgp_errors.h"
 #include "bgpd/bgp_packet.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_DUMP_PEERS, "BGP dump peer index")
+
 enum bgp_dump_type {
 	BGP_DUMP_ALL,
 	BGP_DUMP_ALL_ET,
@@ -90,6 +95,79 @@ struct bgp_dump {
 static int bgp_dump_unset(struct bgp_dump *bgp_dump);
 static int bgp_dump_interval_func(struct thread *);
 
+/*
+ * Table dumps.
+ *
+ * Walking a full table and writing it out in one go stalls bgpd for
+ * seconds.  Instead, the main pthread walks the table in slices of
+ * BGP_DUMP_SLICE_NODES route nodes, yielding to other events in between,
+ * and packs the records into large chunks that a pthread of its own
+ * writes to the file.  The walk holds a lock on the node it is to resume
+ * from, as well as on the table and the bgp instance.
+ *
+ * Since the table can change between two slices, the dump is not a
+ * snapshot of a single instant, as with any other dump taken while bgpd
+ * keeps running.  The peers are fixed by the index table written first
+ * though: routes from peers configured after that are left out.
+ */
+#define BGP_DUMP_SLICE_NODES 2000
+#define BGP_DUMP_CHUNK_SIZE (256 * 1024)
+/* bytes waiting for the writer before the walk pauses */
+#define BGP_DUMP_QUEUE_MAX (32 * 1024 * 1024)
+#define BGP_DUMP_QUEUE_RETRY_MSEC 10
+
+static struct bgp_dump_walk {
+	struct bgp *bgp;
+	afi_t afi;
+	struct bgp_table *table;
+	/* next node to dump, locked */
+	struct bgp_node *rn;
+	unsigned int seq;
+
+	/* peers in the index table, locked; peer->table_dump_index - 1 */
+	struct peer **peers;
+	uint16_t npeers;
+
+	/* records not handed to the writer yet */
+	struct stream *chunk;
+
+	struct thread *t_slice;
+} bgp_dump_walk;
+
+/* Everything below is shared with the writer pthread, under bgp_dump_mtx. */
+static pthread_mutex_t bgp_dump_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct frr_pthread *bgp_dump_pth;
+static struct thread *t_bgp_dump_write;
+
+static struct stream_fifo *bgp_dump_wqueue;
+static size_t bgp_dump_wqueued;
+/* -1 while no dump is being written */
+static int bgp_dump_wfd = -1;
+/* the last chunk of the dump was queued */
+static bool bgp_dump_wlast;
+
+static struct bgp_dump_stats {
+	char filename[MAXPATHLEN];
+	time_t started;
+	struct timeval start;
+	bool running;
+
+	uint64_t records;
+	uint64_t prefixes;
+	uint64_t bytes;
+	bool write_error;
+
+	/* time spent on the main pthread */
+	uint64_t walk_usec;
+	uint64_t max_slice_usec;
+	unsigned long slices;
+	/* from start to the file being closed */
+	uint64_t total_usec;
+
+	unsigned long dumps;
+	unsigned long skipped;
+} bgp_dump_stats;
+
 /* BGP packet dump output buffer. */
 struct stream *bgp_dump_obuf;
 
@@ -102,14 +180,13 @@ struct bgp_dump bgp_dump_updates;
 /* BGP dump structure for 'dump bgp routes' */
 struct bgp_dump bgp_dump_routes;
 
-static FILE *bgp_dump_open_file(struct bgp_dump *bgp_dump)
+/* Expands the configured filename into realpath, MAXPATHLEN long. */
+static bool bgp_dump_path(struct bgp_dump *bgp_dump, char *realpath)
 {
 	int ret;
 	time_t clock;
 	struct tm tm;
 	char fullpath[MAXPATHLEN];
-	char realpath[MAXPATHLEN];
-	mode_t oldumask;
 
 	time(&clock);
 	localtime_r(&clock, &tm);
@@ -121,10 +198,21 @@ static FILE *bgp_dump_open_file(struct bgp_dump *bgp_dump)
 		ret = strftime(realpath, MAXPATHLEN, bgp_dump->filename, &tm);
 
 	if (ret == 0) {
-		flog_warn(EC_BGP_DUMP, "bgp_dump_open_file: strftime error");
-		return NULL;
+		flog_warn(EC_BGP_DUMP, "%s: strftime error", __func__);
+		return false;
 	}
 
+	return true;
+}
+
+static FILE *bgp_dump_open_file(struct bgp_dump *bgp_dump)
+{
+	char realpath[MAXPATHLEN];
+	mode_t oldumask;
+
+	if (!bgp_dump_path(bgp_dump, realpath))
+		return NULL;
+
 	if (bgp_dump->fp)
 		fclose(bgp_dump->fp);
 
@@ -216,8 +304,152 @@ static void bgp_dump_set_size(struct stream *s, int type)
 	stream_putl_at(s, 8, stream_get_endp(s) - BGP_DUMP_HEADER_SIZE);
 }
 
+/* Writer pthread ---------------------------------------------------------- */
+
+static int bgp_dump_write_fd(int fd, struct stream *s)
+{
+	size_t done = 0, len = stream_get_endp(s);
+	ssize_t nbytes;
+
+	while (done < len) {
+		nbytes = write(fd, STREAM_DATA(s) + done, len - done);
+		if (nbytes < 0) {
+			if (ERRNO_IO_RETRY(errno))
+				continue;
+			return -1;
+		}
+		done += nbytes;
+	}
+
+	return 0;
+}
+
+/* Writes out whatever is queued, closes the file after the last chunk. */
+static void bgp_dump_write_queued(void)
+{
+	struct stream *s;
+	bool last = false;
+	bool error;
+	int fd;
+
+	/* after an error, the rest of the dump is dropped */
+	frr_with_mutex(&bgp_dump_mtx) {
+		fd = bgp_dump_wfd;
+		error = bgp_dump_stats.write_error;
+	}
+
+	do {
+		frr_with_mutex(&bgp_dump_mtx) {
+			s = stream_fifo_pop(bgp_dump_wqueue);
+			if (s)
+				bgp_dump_wqueued -= stream_get_endp(s);
+			else
+				last = bgp_dump_wlast;
+		}
+
+		if (s && !error && bgp_dump_write_fd(fd, s) < 0) {
+			flog_warn(EC_BGP_DUMP, "%s: write error: %s",
+				  bgp_dump_stats.filename,
+				  safe_strerror(errno));
+			error = true;
+		}
+
+		frr_with_mutex(&bgp_dump_mtx) {
+			if (s && !error)
+				bgp_dump_stats.bytes += stream_get_endp(s);
+			if (error)
+				bgp_dump_stats.write_error = true;
+		}
+
+		if (s)
+			stream_free(s);
+	} while (s);
+
+	if (!last)
+		return;
+
+	close(fd);
+
+	frr_with_mutex(&bgp_dump_mtx) {
+		bgp_dump_wfd = -1;
+		bgp_dump_wlast = false;
+		bgp_dump_stats.running = false;
+		bgp_dump_stats.total_usec =
+			monotime_since(&bgp_dump_stats.start, NULL);
+	}
+}
+
+static int bgp_dump_write(struct thread *thread)
+{
+	bgp_dump_write_queued();
+	return 0;
+}
+
+/* Hands a chunk, if any, to the writer; last ends the dump. */
+static void bgp_dump_queue(struct stream *s, bool last)
+{
+	frr_with_mutex(&bgp_dump_mtx) {
+		if (s) {
+			stream_fifo_push(bgp_dump_wqueue, s);
+			bgp_dump_wqueued += stream_get_endp(s);
+		}
+		if (last)
+			bgp_dump_wlast = true;
+	}
+
+	thread_add_event(bgp_dump_pth->master, bgp_dump_write, NULL, 0,
+			 &t_bgp_dump_write);
+}
+
+static void bgp_dump_writer_start(void)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+
+	if (bgp_dump_pth)
+		return;
+
+	bgp_dump_pth = frr_pthread_new(&attr, "BGP dump writer", "bgpd_dump");
+	frr_pthread_run(bgp_dump_pth, NULL);
+	frr_pthread_wait_running(bgp_dump_pth);
+}
+
+static void bgp_dump_writer_stop(void)
+{
+	if (!bgp_dump_pth)
+		return;
+
+	frr_pthread_stop(bgp_dump_pth, NULL);
+	frr_pthread_destroy(bgp_dump_pth);
+	bgp_dump_pth = NULL;
+
+	/* finish off what the writer didn't get to */
+	if (bgp_dump_wfd >= 0)
+		bgp_dump_write_queued();
+}
+
+/* Table walk -------------------------------------------------------------- */
+
+/* Appends the record in obuf to the current chunk. */
+static void bgp_dump_routes_put(struct stream *obuf)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	size_t len = stream_get_endp(obuf);
+
+	if (STREAM_WRITEABLE(walk->chunk) < len) {
+		bgp_dump_queue(walk->chunk, false);
+		walk->chunk = stream_new(BGP_DUMP_CHUNK_SIZE);
+	}
+
+	stream_put(walk->chunk, STREAM_DATA(obuf), len);
+	bgp_dump_stats.records++;
+}
+
 static void bgp_dump_routes_index_table(struct bgp *bgp)
 {
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
 	struct peer *peer;
 	struct listnode *node;
 	uint16_t peerno = 1;
@@ -256,6 +488,9 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 	/* Peer ASN (0) */
 	stream_putl(obuf, 0);
 
+	walk->peers = XCALLOC(MTYPE_BGP_DUMP_PEERS,
+			      sizeof(*walk->peers) * listcount(bgp->peer));
+
 	/* Walk down all peers */
 	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
 
@@ -290,19 +525,39 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 
 		/* Store the peer number for this peer */
 		peer->table_dump_index = peerno;
+		walk->peers[walk->npeers++] = peer_lock(peer);
 		peerno++;
 	}
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
-
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
-	fflush(bgp_dump_routes.fp);
+	bgp_dump_routes_put(obuf);
 }
 
+/*
+ * Looks up the index table entry for a path's peer.  Peers that were not
+ * around when the index table was written have none.
+ */
+static bool bgp_dump_routes_peer_index(struct peer *peer, uint16_t *index)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+
+	if (peer == walk->bgp->peer_self) {
+		*index = 0;
+		return true;
+	}
+
+	if (peer->table_dump_index == 0
+	    || peer->table_dump_index > walk->npeers
+	    || walk->peers[peer->table_dump_index - 1] != peer)
+		return false;
+
+	*index = peer->table_dump_index;
+	return true;
+}
 
 static struct bgp_path_info *
 bgp_dump_route_node_record(int afi, struct bgp_node *rn,
-			   struct bgp_path_info *path, unsigned int seq)
+			   struct bgp_path_info *path, unsigned int *seq)
 {
 	struct stream *obuf;
 	size_t sizep;
@@ -323,7 +578,7 @@ bgp_dump_route_node_record(int afi, struct bgp_node *rn,
 				BGP_DUMP_ROUTES);
 
 	/* Sequence number */
-	stream_putl(obuf, seq);
+	stream_putl(obuf, *seq);
 
 	/* Prefix length */
 	stream_putc(obuf, p->prefixlen);
@@ -353,9 +608,13 @@ bgp_dump_route_node_record(int afi, struct bgp_node *rn,
 	endp = stream_get_endp(obuf);
 	for (; path; path = path->next) {
 		size_t cur_endp;
+		uint16_t peer_index;
+
+		if (!bgp_dump_routes_peer_index(path->peer, &peer_index))
+			continue;
 
 		/* Peer index */
-		stream_putw(obuf, path->peer->table_dump_index);
+		stream_putw(obuf, peer_index);
 
 		/* Originated */
 		stream_putl(obuf, time(NULL) - (bgp_clock() - path->uptime));
@@ -375,53 +634,189 @@ bgp_dump_route_node_record(int afi, struct bgp_node *rn,
 		endp = cur_endp;
 	}
 
+	/* Nothing to dump, or a single entry too large for a record */
+	if (entry_count == 0)
+		return path ? path->next : NULL;
+
 	/* Overwrite the entry count, now that we know the right number */
 	stream_putw_at(obuf, sizep, entry_count);
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
+	bgp_dump_routes_put(obuf);
+	(*seq)++;
 
 	return path;
 }
 
 
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
+/* Ends the walk, the writer closes the file once it is done. */
+static void bgp_dump_routes_stop(void)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+
+	if (!walk->bgp)
+		return;
+
+	THREAD_OFF(walk->t_slice);
+
+	if (walk->rn)
+		bgp_unlock_node(walk->rn);
+	if (walk->table)
+		bgp_table_unlock(walk->table);
+	while (walk->npeers)
+		peer_unlock(walk->peers[--walk->npeers]);
+	XFREE(MTYPE_BGP_DUMP_PEERS, walk->peers);
+	bgp_unlock(walk->bgp);
+
+	bgp_dump_queue(walk->chunk, true);
+
+	memset(walk, 0, sizeof(*walk));
+}
+
+static bool bgp_dump_routes_next_table(void)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+
+	if (walk->table) {
+		bgp_table_unlock(walk->table);
+		walk->table = NULL;
+
+		/* dump IPv4, then IPv6 */
+		if (walk->afi == AFI_IP6)
+			return false;
+		walk->afi = AFI_IP6;
+	}
+
+	walk->table = walk->bgp->rib[walk->afi][SAFI_UNICAST];
+	bgp_table_lock(walk->table);
+	walk->rn = bgp_table_top(walk->table);
+
+	return true;
+}
+
+static int bgp_dump_routes_slice(struct thread *thread)
 {
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
 	struct bgp_path_info *path;
-	struct bgp_node *rn;
+	struct timeval start;
+	unsigned int nodes = 0;
+	uint64_t usec;
+	size_t queued;
+
+	frr_with_mutex(&bgp_dump_mtx) {
+		queued = bgp_dump_wqueued;
+	}
+
+	/* don't let the queue grow without bounds if the disk is slow */
+	if (queued > BGP_DUMP_QUEUE_MAX) {
+		thread_add_timer_msec(bm->master, bgp_dump_routes_slice, NULL,
+				      BGP_DUMP_QUEUE_RETRY_MSEC,
+				      &walk->t_slice);
+		return 0;
+	}
+
+	if (CHECK_FLAG(walk->bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS)) {
+		bgp_dump_routes_stop();
+		return 0;
+	}
+
+	monotime(&start);
+
+	while (nodes < BGP_DUMP_SLICE_NODES) {
+		if (!walk->rn && !bgp_dump_routes_next_table())
+			break;
+		if (!walk->rn)
+			continue;
+
+		path = bgp_node_get_bgp_path_info(walk->rn);
+		if (path)
+			bgp_dump_stats.prefixes++;
+		while (path)
+			path = bgp_dump_route_node_record(walk->afi, walk->rn,
+							  path, &walk->seq);
+
+		walk->rn = bgp_route_next(walk->rn);
+		nodes++;
+	}
+
+	usec = monotime_since(&start, NULL);
+	bgp_dump_stats.walk_usec += usec;
+	bgp_dump_stats.max_slice_usec =
+		MAX(bgp_dump_stats.max_slice_usec, usec);
+	bgp_dump_stats.slices++;
+
+	if (!walk->table)
+		bgp_dump_routes_stop();
+	else
+		thread_add_event(bm->master, bgp_dump_routes_slice, NULL, 0,
+				 &walk->t_slice);
+
+	return 0;
+}
+
+static void bgp_dump_routes_start(struct bgp_dump *bgp_dump)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	char realpath[MAXPATHLEN];
+	mode_t oldumask;
+	bool busy;
 	struct bgp *bgp;
-	struct bgp_table *table;
+	int fd;
 
 	bgp = bgp_get_default();
 	if (!bgp)
-		return seq;
-
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
-
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
-
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
-
-	for (rn = bgp_table_top(table); rn; rn = bgp_route_next(rn)) {
-		path = bgp_node_get_bgp_path_info(rn);
-		while (path) {
-			path = bgp_dump_route_node_record(afi, rn, path, seq);
-			seq++;
-		}
+		return;
+
+	frr_with_mutex(&bgp_dump_mtx) {
+		busy = bgp_dump_wfd >= 0;
+	}
+
+	if (busy) {
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous routes dump still in progress, skipping",
+			  bgp_dump->filename);
+		bgp_dump_stats.skipped++;
+		return;
+	}
+
+	if (!bgp_dump_path(bgp_dump, realpath))
+		return;
+
+	oldumask = umask(0777 & ~LOGFILE_MASK);
+	fd = open(realpath, O_WRONLY | O_CREAT | O_TRUNC, LOGFILE_MASK);
+	umask(oldumask);
+
+	if (fd < 0) {
+		flog_warn(EC_BGP_DUMP, "%s: %s: %s", __func__, realpath,
+			  safe_strerror(errno));
+		return;
 	}
 
-	fflush(bgp_dump_routes.fp);
+	bgp_dump_writer_start();
 
-	return seq;
+	frr_with_mutex(&bgp_dump_mtx) {
+		memset(&bgp_dump_stats, 0,
+		       offsetof(struct bgp_dump_stats, dumps));
+		strlcpy(bgp_dump_stats.filename, realpath,
+			sizeof(bgp_dump_stats.filename));
+		bgp_dump_stats.started = time(NULL);
+		monotime(&bgp_dump_stats.start);
+		bgp_dump_stats.running = true;
+		bgp_dump_stats.dumps++;
+
+		bgp_dump_wfd = fd;
+	}
+
+	walk->bgp = bgp_lock(bgp);
+	walk->afi = AFI_IP;
+	walk->seq = 0;
+	walk->chunk = stream_new(BGP_DUMP_CHUNK_SIZE);
+
+	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers */
+	bgp_dump_routes_index_table(bgp);
+
+	thread_add_event(bm->master, bgp_dump_routes_slice, NULL, 0,
+			 &walk->t_slice);
 }
 
 static int bgp_dump_interval_func(struct thread *t)
@@ -430,20 +825,13 @@ static int bgp_dump_interval_func(struct thread *t)
 	bgp_dump = THREAD_ARG(t);
 	bgp_dump->t_interval = NULL;
 
-	/* Reschedule dump even if file couldn't be opened this time... */
-	if (bgp_dump_open_file(bgp_dump) != NULL) {
-		/* In case of bgp_dump_routes, we need special route dump
-		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
-			fclose(bgp_dump->fp);
-			bgp_dump->fp = NULL;
-		}
-	}
+	/* In case of bgp_dump_routes, we need special route dump
+	 * function.  Reschedule dump even if file couldn't be opened
+	 * this time... */
+	if (bgp_dump->type == BGP_DUMP_ROUTES)
+		bgp_dump_routes_start(bgp_dump);
+	else
+		bgp_dump_open_file(bgp_dump);
 
 	/* if interval is set reschedule */
 	if (bgp_dump->interval > 0)
@@ -659,8 +1047,10 @@ static int bgp_dump_set(struct vty *vty, struct bgp_dump *bgp_dump,
 	/* Create interval thread. */
 	bgp_dump_interval_add(bgp_dump, interval);
 
-	/* This should be called when interval is expired. */
-	bgp_dump_open_file(bgp_dump);
+	/* This should be called when interval is expired.  Routes dumps
+	 * open their file each time they start. */
+	if (type != BGP_DUMP_ROUTES)
+		bgp_dump_open_file(bgp_dump);
 
 	return CMD_SUCCESS;
 }
@@ -670,6 +1060,10 @@ static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
+	/* Stopping a routes dump in progress. */
+	if (bgp_dump == &bgp_dump_routes)
+		bgp_dump_routes_stop();
+
 	/* Closing file. */
 	if (bgp_dump->fp) {
 		fclose(bgp_dump->fp);
@@ -777,6 +1171,66 @@ DEFUN (no_dump_bgp_all,
 	return bgp_dump_unset(bgp_dump_struct);
 }
 
+DEFUN (show_dump_bgp,
+       show_dump_bgp_cmd,
+       "show dump bgp",
+       SHOW_STR
+       "Dump packet\n"
+       "BGP packet dump\n")
+{
+	struct bgp_dump_stats stats;
+	size_t queued;
+	char buf[64];
+
+	frr_with_mutex(&bgp_dump_mtx) {
+		stats = bgp_dump_stats;
+		queued = bgp_dump_wqueued;
+	}
+
+	if (bgp_dump_all.filename)
+		vty_out(vty, "Packets (%s): %s\n",
+			bgp_dump_all.type == BGP_DUMP_ALL_ET ? "all-et" : "all",
+			bgp_dump_all.filename);
+	if (bgp_dump_updates.filename)
+		vty_out(vty, "Updates (%s): %s\n",
+			bgp_dump_updates.type == BGP_DUMP_UPDATES_ET
+				? "updates-et"
+				: "updates",
+			bgp_dump_updates.filename);
+	if (bgp_dump_routes.filename)
+		vty_out(vty, "Routes (routes-mrt): %s\n",
+			bgp_dump_routes.filename);
+
+	if (!stats.dumps) {
+		vty_out(vty, "No routes dump taken yet\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "\nLast routes dump: %s\n", stats.filename);
+	ctime_r(&stats.started, buf);
+	vty_out(vty, "  Started: %s", buf);
+	if (stats.running)
+		vty_out(vty, "  In progress, %zu bytes waiting to be written\n",
+			queued);
+	else
+		vty_out(vty, "  Latency: %" PRIu64 ".%06" PRIu64 " s%s\n",
+			stats.total_usec / 1000000,
+			stats.total_usec % 1000000,
+			stats.write_error ? " (write error)" : "");
+	vty_out(vty, "  Prefixes: %" PRIu64 ", records: %" PRIu64
+		     ", bytes: %" PRIu64 "\n",
+		stats.prefixes, stats.records, stats.bytes);
+	vty_out(vty,
+		"  Main pthread: %" PRIu64 ".%06" PRIu64
+		" s in %lu slices, longest %" PRIu64 " us\n",
+		stats.walk_usec / 1000000, stats.walk_usec % 1000000,
+		stats.slices, stats.max_slice_usec);
+	vty_out(vty, "Routes dumps: %lu, skipped: %lu\n", stats.dumps,
+		stats.skipped);
+
+	return CMD_SUCCESS;
+}
+
 /* BGP node structure. */
 static struct cmd_node bgp_dump_node = {DUMP_NODE, "", 1};
 
@@ -856,11 +1310,13 @@ void bgp_dump_init(void)
 	bgp_dump_obuf =
 		stream_new((BGP_MAX_PACKET_SIZE << 1) + BGP_DUMP_MSG_HEADER
 			   + BGP_DUMP_HEADER_SIZE);
+	bgp_dump_wqueue = stream_fifo_new();
 
 	install_node(&bgp_dump_node, config_write_bgp_dump);
 
 	install_element(CONFIG_NODE, &dump_bgp_all_cmd);
 	install_element(CONFIG_NODE, &no_dump_bgp_all_cmd);
+	install_element(VIEW_NODE, &show_dump_bgp_cmd);
 
 	hook_register(bgp_packet_dump, bgp_dump_packet);
 	hook_register(peer_status_changed, bgp_dump_state);
@@ -871,7 +1327,10 @@ void bgp_dump_finish(void)
 	bgp_dump_unset(&bgp_dump_all);
 	bgp_dump_unset(&bgp_dump_updates);
 	bgp_dump_unset(&bgp_dump_routes);
+	bgp_dump_writer_stop();
 
+	stream_fifo_free(bgp_dump_wqueue);
+	bgp_dump_wqueue = NULL;
 	stream_free(bgp_dump_obuf);
 	bgp_dump_obuf = NULL;
 	hook_unregister(bgp_packet_dump, bgp_dump_packet);
@@ -60,7 +60,7 @@ struct as_filter {
 
 	enum as_filter_type type;
 
-	regex_t *reg;
+	struct bgp_aspath_regex *reg;
 	char *reg_str;
 };
 
@@ -94,13 +94,14 @@ static struct as_filter *as_filter_new(void)
 static void as_filter_free(struct as_filter *asfilter)
 {
 	if (asfilter->reg)
-		bgp_regex_free(asfilter->reg);
+		bgp_aspath_regex_free(asfilter->reg);
 	XFREE(MTYPE_AS_FILTER_STR, asfilter->reg_str);
 	XFREE(MTYPE_AS_FILTER, asfilter);
 }
 
 /* Make new AS filter. */
-static struct as_filter *as_filter_make(regex_t *reg, const char *reg_str,
+static struct as_filter *as_filter_make(struct bgp_aspath_regex *reg,
+					const char *reg_str,
 					enum as_filter_type type)
 {
 	struct as_filter *asfilter;
@@ -336,7 +337,7 @@ static void as_list_filter_delete(struct as_list *aslist,
 
 static bool as_filter_match(struct as_filter *asfilter, struct aspath *aspath)
 {
-	return bgp_regexec(asfilter->reg, aspath) != REG_NOMATCH;
+	return bgp_aspath_regexec(asfilter->reg, aspath);
 }
 
 /* Apply AS path filter to AS. */
@@ -404,7 +405,7 @@ DEFUN(as_path, bgp_as_path_cmd,
 	enum as_filter_type type;
 	struct as_filter *asfilter;
 	struct as_list *aslist;
-	regex_t *regex;
+	struct bgp_aspath_regex *regex;
 	char *regstr;
 
 	/* Retrieve access list name */
@@ -419,7 +420,7 @@ DEFUN(as_path, bgp_as_path_cmd,
 	argv_find(argv, argc, "LINE", &idx);
 	regstr = argv_concat(argv, argc, idx);
 
-	regex = bgp_regcomp(regstr);
+	regex = bgp_aspath_regcomp(regstr);
 	if (!regex) {
 		vty_out(vty, "can't compile regexp %s\n", regstr);
 		XFREE(MTYPE_TMP, regstr);
@@ -464,7 +465,7 @@ DEFUN(no_as_path, no_bgp_as_path_cmd,
 	struct as_filter *asfilter;
 	struct as_list *aslist;
 	char *regstr;
-	regex_t *regex;
+	struct bgp_aspath_regex *regex;
 
 	char *aslistname =
 		argv_find(argv, argc, "WORD", &idx) ? argv[idx]->arg : NULL;
@@ -497,7 +498,7 @@ DEFUN(no_as_path, no_bgp_as_path_cmd,
 		return CMD_WARNING_CONFIG_FAILED;
 	}
 
-	regex = bgp_regcomp(regstr);
+	regex = bgp_aspath_regcomp(regstr);
 	if (!regex) {
 		vty_out(vty, "can't compile regexp %s\n", regstr);
 		XFREE(MTYPE_TMP, regstr);
@@ -508,7 +509,7 @@ DEFUN(no_as_path, no_bgp_as_path_cmd,
 	asfilter = as_filter_lookup(aslist, regstr, type);
 
 	XFREE(MTYPE_TMP, regstr);
-	bgp_regex_free(regex);
+	bgp_aspath_regex_free(regex);
 
 	if (asfilter == NULL) {
 		vty_out(vty, "\n");
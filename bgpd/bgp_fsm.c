@@ -55,6 +55,7 @@
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
 #include "bgpd/bgp_zebra.h"
+#include "bgpd/bgp_rmap_cache.h"
 
 DEFINE_HOOK(peer_backward_transition, (struct peer * peer), (peer))
 DEFINE_HOOK(peer_status_changed, (struct peer * peer), (peer))
@@ -130,6 +131,8 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 	afi_t afi;
 	safi_t safi;
 	int fd;
+	struct spsc_ring *ibuf, *obuf;
+	struct bgp_opkt_fifo *obuf_spill;
 	enum bgp_fsm_status status, pstatus;
 	enum bgp_fsm_events last_evt, last_maj_evt;
 
@@ -192,8 +195,7 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 		peer->fd = from_peer->fd;
 		from_peer->fd = fd;
 
-		stream_fifo_clean(peer->ibuf);
-		stream_fifo_clean(peer->obuf);
+		bgp_io_bufs_clean(peer);
 
 		/*
 		 * this should never happen, since bgp_process_packet() is the
@@ -214,15 +216,20 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 			peer->curr = NULL;
 		}
 
-		// copy each packet from old peer's output queue to new peer
-		while (from_peer->obuf->head)
-			stream_fifo_push(peer->obuf,
-					 stream_fifo_pop(from_peer->obuf));
+		// hand old peer's queues over to new peer
+		ibuf = peer->ibuf;
+		peer->ibuf = from_peer->ibuf;
+		from_peer->ibuf = ibuf;
 
-		// copy each packet from old peer's input queue to new peer
-		while (from_peer->ibuf->head)
-			stream_fifo_push(peer->ibuf,
-					 stream_fifo_pop(from_peer->ibuf));
+		frr_with_mutex(&peer->obuf_mtx, &from_peer->obuf_mtx) {
+			obuf = peer->obuf;
+			peer->obuf = from_peer->obuf;
+			from_peer->obuf = obuf;
+
+			obuf_spill = peer->obuf_spill;
+			peer->obuf_spill = from_peer->obuf_spill;
+			from_peer->obuf_spill = obuf_spill;
+		}
 
 		ringbuf_wipe(peer->ibuf_work);
 		ringbuf_copy(peer->ibuf_work, from_peer->ibuf_work,
@@ -1281,10 +1288,7 @@ int bgp_stop(struct peer *peer)
 
 	/* Clear input and output buffer.  */
 	frr_with_mutex(&peer->io_mtx) {
-		if (peer->ibuf)
-			stream_fifo_clean(peer->ibuf);
-		if (peer->obuf)
-			stream_fifo_clean(peer->obuf);
+		bgp_io_bufs_clean(peer);
 
 		if (peer->ibuf_work)
 			ringbuf_wipe(peer->ibuf_work);
@@ -1796,6 +1800,11 @@ static int bgp_establish(struct peer *peer)
 
 	/* Increment established count. */
 	peer->established++;
+
+	/* route-maps setting the next-hop to the peer address look at the
+	 * new session */
+	bgp_rmap_cache_flush();
+
 	bgp_fsm_change_status(peer, Established);
 
 	/* bgp log-neighbor-changes of neighbor Up */
@@ -24,13 +24,16 @@
 #include <pthread.h>		// for pthread_mutex_unlock, pthread_mutex_lock
 #include <sys/uio.h>		// for writev
 
+#include "command.h"		// for DEFUN, install_element, CMD_SUCCESS
 #include "frr_pthread.h"
+#include "json.h"		// for json_object_new_object, use_json
 #include "linklist.h"		// for list_delete, list_delete_all_node, lis...
 #include "log.h"		// for zlog_debug, safe_strerror, zlog_err
 #include "memory.h"		// for MTYPE_TMP, XCALLOC, XFREE
 #include "network.h"		// for ERRNO_IO_RETRY
 #include "stream.h"		// for stream_get_endp, stream_getw_from, str...
 #include "ringbuf.h"		// for ringbuf_remain, ringbuf_peek, ringbuf_...
+#include "spsc_ring.h"		// for spsc_ring_push, spsc_ring_pop, spsc_r...
 #include "thread.h"		// for THREAD_OFF, THREAD_ARG, thread, thread...
 #include "zassert.h"		// for assert
 
@@ -43,21 +46,168 @@
 /* clang-format on */
 
 /* forward declarations */
-static uint16_t bgp_write(struct peer *);
-static uint16_t bgp_read(struct peer *);
+static uint16_t bgp_write(struct peer *, struct bgp_io_pthread *);
+static uint16_t bgp_read(struct peer *, struct bgp_io_pthread *);
 static int bgp_process_writes(struct thread *);
 static int bgp_process_reads(struct thread *);
+static int bgp_process_reads_resume(struct thread *);
+static void bgp_process_ibuf_work(struct peer *, struct bgp_io_pthread *);
 static bool validate_header(struct peer *);
 
 /* generic i/o status codes */
 #define BGP_IO_TRANS_ERR (1 << 0) // EAGAIN or similar occurred
 #define BGP_IO_FATAL_ERR (1 << 1) // some kind of fatal TCP error
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_IO_PTHREAD, "BGP I/O pthread")
+DEFINE_MTYPE_STATIC(BGPD, BGP_PKTBUF, "BGP shared packet")
+DEFINE_MTYPE_STATIC(BGPD, BGP_OPKT, "BGP output queue entry")
+DEFINE_MTYPE_STATIC(BGPD, BGP_OPKT_FIFO, "BGP output queue spill")
+
+static struct bgp_io_pthread *bgp_io_pool;
+static unsigned int bgp_io_pool_size;
+
+/* I/O pthread pool -------------------------------------------------------- */
+
+void bgp_io_pthreads_init(unsigned int count)
+{
+	struct frr_pthread_attr io = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32], os_name[OS_THREAD_NAMELEN];
+	unsigned int i;
+
+	assert(!bgp_io_pool);
+	assert(count >= 1 && count <= BGP_IO_PTHREADS_MAX);
+
+	bgp_io_pool = XCALLOC(MTYPE_BGP_IO_PTHREAD,
+			      sizeof(*bgp_io_pool) * count);
+	bgp_io_pool_size = count;
+
+	for (i = 0; i < count; i++) {
+		if (count == 1) {
+			snprintf(name, sizeof(name), "BGP I/O thread");
+			snprintf(os_name, sizeof(os_name), "bgpd_io");
+		} else {
+			snprintf(name, sizeof(name), "BGP I/O thread %u", i);
+			snprintf(os_name, sizeof(os_name), "bgpd_io%u", i);
+		}
+		bgp_io_pool[i].fpt = frr_pthread_new(&io, name, os_name);
+	}
+}
+
+void bgp_io_pthreads_run(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < bgp_io_pool_size; i++)
+		frr_pthread_run(bgp_io_pool[i].fpt, NULL);
+}
+
+void bgp_io_pthreads_wait_running(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < bgp_io_pool_size; i++)
+		frr_pthread_wait_running(bgp_io_pool[i].fpt);
+}
+
+void bgp_io_pthreads_finish(void)
+{
+	XFREE(MTYPE_BGP_IO_PTHREAD, bgp_io_pool);
+	bgp_io_pool_size = 0;
+}
+
+/*
+ * Returns the I/O pthread serving a peer, first handing the peer to the
+ * least loaded one if it has none yet.
+ *
+ * Main pthread only.  peer->io_pth is changed with peer->io_mtx held, since
+ * the keepalives pthread and the I/O pthreads read it.
+ */
+static struct bgp_io_pthread *bgp_io_pthread_get(struct peer *peer)
+{
+	struct bgp_io_pthread *io;
+	unsigned int i;
+
+	if (peer->io_pth)
+		return peer->io_pth;
+
+	io = &bgp_io_pool[0];
+	for (i = 1; i < bgp_io_pool_size; i++)
+		if (bgp_io_pool[i].peers < io->peers)
+			io = &bgp_io_pool[i];
+
+	io->peers++;
+	frr_with_mutex(&peer->io_mtx) {
+		peer->io_pth = io;
+	}
+
+	return io;
+}
+
+/*
+ * Lets go of a peer's I/O pthread once neither reads nor writes are on.
+ * Main pthread only, like bgp_io_pthread_get().
+ */
+static void bgp_io_pthread_put(struct peer *peer)
+{
+	struct bgp_io_pthread *io = peer->io_pth;
+
+	if (!io
+	    || CHECK_FLAG(peer->thread_flags,
+			  PEER_THREAD_READS_ON | PEER_THREAD_WRITES_ON))
+		return;
+
+	frr_with_mutex(&peer->io_mtx) {
+		peer->io_pth = NULL;
+	}
+	io->peers--;
+}
+
+/*
+ * Returns the I/O pthread a task for the peer should run on, or NULL if the
+ * peer has none (anymore).  Used by the I/O pthread tasks, which may have been
+ * scheduled by the keepalives pthread just as the main pthread turned I/O off
+ * for the peer.
+ */
+static struct bgp_io_pthread *bgp_io_pthread_check(struct peer *peer,
+						   struct thread *thread)
+{
+	struct bgp_io_pthread *io;
+
+	frr_with_mutex(&peer->io_mtx) {
+		io = peer->io_pth;
+	}
+
+	if (!io || io->fpt->master != thread->master)
+		return NULL;
+	return io;
+}
+
 /* Thread external API ----------------------------------------------------- */
 
 void bgp_writes_on(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct bgp_io_pthread *io;
+	struct frr_pthread *fpt;
+
+	/*
+	 * The keepalives pthread gets here too.  It must not pick an I/O
+	 * pthread for the peer, and has nothing to do if the main pthread has
+	 * turned I/O off; the packet goes out once it's turned back on.
+	 */
+	if (pthread_equal(pthread_self(), bm->master->owner)) {
+		io = bgp_io_pthread_get(peer);
+	} else {
+		frr_with_mutex(&peer->io_mtx) {
+			io = peer->io_pth;
+		}
+		if (!io)
+			return;
+	}
+
+	fpt = io->fpt;
 	assert(fpt->running);
 
 	assert(peer->status != Deleted);
@@ -75,18 +225,21 @@ void bgp_writes_on(struct peer *peer)
 
 void bgp_writes_off(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	if (peer->io_pth) {
+		struct frr_pthread *fpt = peer->io_pth->fpt;
+		assert(fpt->running);
 
-	thread_cancel_async(fpt->master, &peer->t_write, NULL);
+		thread_cancel_async(fpt->master, &peer->t_write, NULL);
+	}
 	THREAD_OFF(peer->t_generate_updgrp_packets);
 
 	UNSET_FLAG(peer->thread_flags, PEER_THREAD_WRITES_ON);
+	bgp_io_pthread_put(peer);
 }
 
 void bgp_reads_on(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct frr_pthread *fpt = bgp_io_pthread_get(peer)->fpt;
 	assert(fpt->running);
 
 	assert(peer->status != Deleted);
@@ -98,21 +251,290 @@ void bgp_reads_on(struct peer *peer)
 	assert(!peer->t_connect_check_w);
 	assert(peer->fd);
 
-	thread_add_read(fpt->master, bgp_process_reads, peer, peer->fd,
-			&peer->t_read);
+	atomic_store_explicit(&peer->ibuf_stalled, false, memory_order_relaxed);
+
+	/*
+	 * A connection taken over from a doppelganger may come with packets
+	 * in ibuf_work which did not fit onto ibuf; process those first.
+	 */
+	if (ringbuf_remain(peer->ibuf_work) >= BGP_HEADER_SIZE)
+		thread_add_event(fpt->master, bgp_process_reads_resume, peer, 0,
+				 &peer->t_read);
+	else
+		thread_add_read(fpt->master, bgp_process_reads, peer, peer->fd,
+				&peer->t_read);
 
 	SET_FLAG(peer->thread_flags, PEER_THREAD_READS_ON);
 }
 
 void bgp_reads_off(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	if (peer->io_pth) {
+		struct frr_pthread *fpt = peer->io_pth->fpt;
+		assert(fpt->running);
 
-	thread_cancel_async(fpt->master, &peer->t_read, NULL);
+		thread_cancel_async(fpt->master, &peer->t_read, NULL);
+	}
 	THREAD_OFF(peer->t_process_packet);
 
 	UNSET_FLAG(peer->thread_flags, PEER_THREAD_READS_ON);
+	bgp_io_pthread_put(peer);
+}
+
+void bgp_reads_resume(struct peer *peer)
+{
+	struct frr_pthread *fpt;
+
+	if (!CHECK_FLAG(peer->thread_flags, PEER_THREAD_READS_ON))
+		return;
+
+	fpt = peer->io_pth->fpt;
+
+	thread_add_event(fpt->master, bgp_process_reads_resume, peer, 0,
+			 &peer->t_read);
+}
+
+/* Packet buffers ---------------------------------------------------------- */
+
+static void bgp_io_stream_free(void *arg)
+{
+	stream_free(arg);
+}
+
+struct bgp_pktbuf *bgp_pktbuf_new(struct stream *s)
+{
+	struct bgp_pktbuf *pb;
+
+	pb = XMALLOC(MTYPE_BGP_PKTBUF, sizeof(*pb));
+	pb->s = s;
+	atomic_store_explicit(&pb->refcnt, 1, memory_order_relaxed);
+	return pb;
+}
+
+void bgp_pktbuf_unref(struct bgp_pktbuf *pb)
+{
+	if (atomic_fetch_sub_explicit(&pb->refcnt, 1, memory_order_acq_rel)
+	    > 1)
+		return;
+
+	stream_free(pb->s);
+	XFREE(MTYPE_BGP_PKTBUF, pb);
+}
+
+struct bgp_opkt *bgp_opkt_new(struct stream *s, struct bgp_pktbuf *shared,
+			      size_t shared_off)
+{
+	struct bgp_opkt *op;
+
+	op = XCALLOC(MTYPE_BGP_OPKT, sizeof(*op));
+	op->s = s;
+	op->shared = shared;
+	op->shared_off = shared_off;
+
+	if (shared)
+		atomic_fetch_add_explicit(&shared->refcnt, 1,
+					  memory_order_relaxed);
+	return op;
+}
+
+static void bgp_opkt_free(void *arg)
+{
+	struct bgp_opkt *op = arg;
+
+	if (op->s)
+		stream_free(op->s);
+	if (op->shared)
+		bgp_pktbuf_unref(op->shared);
+	XFREE(MTYPE_BGP_OPKT, op);
+}
+
+static size_t bgp_opkt_len(const struct bgp_opkt *op)
+{
+	if (!op->shared)
+		return stream_get_endp(op->s);
+
+	return stream_get_endp(op->shared->s);
+}
+
+static uint8_t bgp_opkt_type(const struct bgp_opkt *op)
+{
+	if (!op->shared || op->shared_off > BGP_MARKER_SIZE + 2)
+		return stream_getc_from(op->s, BGP_MARKER_SIZE + 2);
+
+	return stream_getc_from(op->shared->s, BGP_MARKER_SIZE + 2);
+}
+
+/*
+ * Fills in up to two iovecs for what is left to write of a packet.
+ *
+ * @return number of iovecs used
+ */
+static unsigned int bgp_opkt_iov(const struct bgp_opkt *op,
+				 struct iovec *iov)
+{
+	size_t head = op->shared ? op->shared_off : stream_get_endp(op->s);
+	unsigned int n = 0;
+
+	if (op->written < head) {
+		iov[n].iov_base = STREAM_DATA(op->s) + op->written;
+		iov[n].iov_len = head - op->written;
+		n++;
+	}
+
+	if (op->shared) {
+		size_t off = MAX(op->written, op->shared_off);
+
+		iov[n].iov_base = STREAM_DATA(op->shared->s) + off;
+		iov[n].iov_len = stream_get_endp(op->shared->s) - off;
+		n++;
+	}
+
+	return n;
+}
+
+static void bgp_opkt_fifo_clean(struct bgp_opkt_fifo *fifo)
+{
+	struct bgp_opkt *op;
+
+	while ((op = fifo->head)) {
+		fifo->head = op->next;
+		bgp_opkt_free(op);
+	}
+	fifo->tailp = &fifo->head;
+	atomic_store_explicit(&fifo->count, 0, memory_order_relaxed);
+}
+
+void bgp_io_bufs_new(struct peer *peer)
+{
+	peer->ibuf = spsc_ring_new(BGP_IBUF_RING_SIZE);
+	peer->obuf = spsc_ring_new(BGP_OBUF_RING_SIZE);
+	peer->obuf_spill = XCALLOC(MTYPE_BGP_OPKT_FIFO,
+				   sizeof(*peer->obuf_spill));
+	peer->obuf_spill->tailp = &peer->obuf_spill->head;
+	atomic_store_explicit(&peer->ibuf_stalled, false, memory_order_relaxed);
+}
+
+void bgp_io_bufs_free(struct peer *peer)
+{
+	if (peer->ibuf) {
+		spsc_ring_del(peer->ibuf, bgp_io_stream_free);
+		peer->ibuf = NULL;
+	}
+
+	if (peer->obuf) {
+		spsc_ring_del(peer->obuf, bgp_opkt_free);
+		peer->obuf = NULL;
+	}
+
+	if (peer->obuf_spill) {
+		bgp_opkt_fifo_clean(peer->obuf_spill);
+		XFREE(MTYPE_BGP_OPKT_FIFO, peer->obuf_spill);
+	}
+}
+
+void bgp_io_bufs_clean(struct peer *peer)
+{
+	if (peer->ibuf)
+		spsc_ring_clean(peer->ibuf, bgp_io_stream_free);
+
+	if (peer->obuf)
+		bgp_obuf_clean(peer);
+}
+
+void bgp_obuf_clean(struct peer *peer)
+{
+	spsc_ring_clean(peer->obuf, bgp_opkt_free);
+
+	frr_with_mutex(&peer->obuf_mtx) {
+		bgp_opkt_fifo_clean(peer->obuf_spill);
+	}
+}
+
+static bool bgp_obuf_spilled(struct peer *peer)
+{
+	return atomic_load_explicit(&peer->obuf_spill->count,
+				    memory_order_relaxed)
+	       > 0;
+}
+
+void bgp_obuf_push_opkt(struct peer *peer, struct bgp_opkt *op)
+{
+	struct bgp_opkt_fifo *spill;
+
+	frr_with_mutex(&peer->obuf_mtx) {
+		spill = peer->obuf_spill;
+		if (spill->head || !spsc_ring_push(peer->obuf, op)) {
+			op->next = NULL;
+			*spill->tailp = op;
+			spill->tailp = &op->next;
+			atomic_fetch_add_explicit(&spill->count, 1,
+						  memory_order_relaxed);
+		}
+	}
+}
+
+void bgp_obuf_push(struct peer *peer, struct stream *s)
+{
+	bgp_obuf_push_opkt(peer, bgp_opkt_new(s, NULL, 0));
+}
+
+/*
+ * Moves packets which did not fit onto peer->obuf when they were queued over
+ * from peer->obuf_spill, as far as there is room now.
+ *
+ * @requires peer->io_mtx
+ */
+static void bgp_obuf_unspill(struct peer *peer)
+{
+	struct bgp_opkt_fifo *spill;
+	struct bgp_opkt *op;
+
+	if (!bgp_obuf_spilled(peer))
+		return;
+
+	frr_with_mutex(&peer->obuf_mtx) {
+		spill = peer->obuf_spill;
+		while ((op = spill->head) && spsc_ring_push(peer->obuf, op)) {
+			spill->head = op->next;
+			if (!spill->head)
+				spill->tailp = &spill->head;
+			atomic_fetch_sub_explicit(&spill->count, 1,
+						  memory_order_relaxed);
+		}
+	}
+}
+
+size_t bgp_ibuf_count(struct peer *peer)
+{
+	return spsc_ring_count(peer->ibuf);
+}
+
+size_t bgp_obuf_count(struct peer *peer)
+{
+	return spsc_ring_count(peer->obuf)
+	       + atomic_load_explicit(&peer->obuf_spill->count,
+				      memory_order_relaxed);
+}
+
+/*
+ * Called from the I/O pthread when peer->ibuf is full.
+ *
+ * Raises peer->ibuf_stalled for the main thread to see when it next takes a
+ * packet off peer->ibuf, then looks again, in case the main thread emptied
+ * peer->ibuf in the meantime without noticing the flag.
+ *
+ * @return true if reading must pause until bgp_reads_resume() is called
+ */
+static bool bgp_ibuf_stall(struct peer *peer)
+{
+	atomic_store_explicit(&peer->ibuf_stalled, true, memory_order_seq_cst);
+
+	if (!spsc_ring_full(peer->ibuf)
+	    && atomic_exchange_explicit(&peer->ibuf_stalled, false,
+					memory_order_seq_cst))
+		return false;
+
+	return true;
 }
 
 /* Thread internal functions ----------------------------------------------- */
@@ -122,8 +544,7 @@ void bgp_reads_off(struct peer *peer)
  */
 static int bgp_process_writes(struct thread *thread)
 {
-	static struct peer *peer;
-	peer = THREAD_ARG(thread);
+	struct peer *peer = THREAD_ARG(thread);
 	uint16_t status;
 	bool reschedule;
 	bool fatal = false;
@@ -131,11 +552,18 @@ static int bgp_process_writes(struct thread *thread)
 	if (peer->fd < 0)
 		return -1;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct bgp_io_pthread *io = bgp_io_pthread_check(peer, thread);
+
+	if (!io)
+		return 0;
+
+	struct frr_pthread *fpt = io->fpt;
 
 	frr_with_mutex(&peer->io_mtx) {
-		status = bgp_write(peer);
-		reschedule = (stream_fifo_head(peer->obuf) != NULL);
+		bgp_obuf_unspill(peer);
+		status = bgp_write(peer, io);
+		reschedule = spsc_ring_peek(peer->obuf, 0)
+			     || bgp_obuf_spilled(peer);
 	}
 
 	/* no problem */
@@ -168,40 +596,88 @@ static int bgp_process_writes(struct thread *thread)
  */
 static int bgp_process_reads(struct thread *thread)
 {
-	/* clang-format off */
-	static struct peer *peer;	// peer to read from
+	struct peer *peer;		// peer to read from
 	uint16_t status;		// bgp_read status code
-	bool more = true;		// whether we got more data
-	bool fatal = false;		// whether fatal error occurred
-	bool added_pkt = false;		// whether we pushed onto ->ibuf
-	/* clang-format on */
 
 	peer = THREAD_ARG(thread);
 
 	if (peer->fd < 0 || bm->terminating)
 		return -1;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct bgp_io_pthread *io = bgp_io_pthread_check(peer, thread);
+
+	if (!io)
+		return 0;
+
+	struct frr_pthread *fpt = io->fpt;
 
 	frr_with_mutex(&peer->io_mtx) {
-		status = bgp_read(peer);
+		status = bgp_read(peer, io);
+	}
+
+	if (CHECK_FLAG(status, BGP_IO_FATAL_ERR)) {
+		/* problem; tear down session */
+		ringbuf_wipe(peer->ibuf_work);
+		return 0;
 	}
 
-	/* error checking phase */
 	if (CHECK_FLAG(status, BGP_IO_TRANS_ERR)) {
 		/* no problem; just don't process packets */
-		more = false;
+		thread_add_read(fpt->master, bgp_process_reads, peer, peer->fd,
+				&peer->t_read);
+		return 0;
 	}
 
-	if (CHECK_FLAG(status, BGP_IO_FATAL_ERR)) {
-		/* problem; tear down session */
-		more = false;
-		fatal = true;
-	}
+	bgp_process_ibuf_work(peer, io);
+
+	return 0;
+}
+
+/*
+ * Called from I/O pthread once the main thread has made room on a peer->ibuf
+ * which filled up while reading.
+ *
+ * Packets left in peer->ibuf_work are processed before reading any more.
+ */
+static int bgp_process_reads_resume(struct thread *thread)
+{
+	struct peer *peer = THREAD_ARG(thread);
+	struct bgp_io_pthread *io;
+
+	if (peer->fd < 0 || bm->terminating)
+		return -1;
+
+	io = bgp_io_pthread_check(peer, thread);
+	if (!io)
+		return 0;
+
+	bgp_process_ibuf_work(peer, io);
 
-	while (more) {
-		/* static buffer for transferring packets */
-		static unsigned char pktbuf[BGP_MAX_PACKET_SIZE];
+	return 0;
+}
+
+/*
+ * Splits the data in peer->ibuf_work into packets and places them on
+ * peer->ibuf, then waits for more data on peer->fd.
+ *
+ * If peer->ibuf fills up first, the remaining data stays in peer->ibuf_work
+ * and nothing more is read until the main thread has caught up; this keeps
+ * a fast peer from queueing up an unbounded amount of packets.
+ */
+static void bgp_process_ibuf_work(struct peer *peer,
+				  struct bgp_io_pthread *io)
+{
+	/* clang-format off */
+	bool fatal = false;		// whether fatal error occurred
+	bool stalled = false;		// whether ->ibuf filled up
+	bool added_pkt = false;		// whether we pushed onto ->ibuf
+	/* clang-format on */
+
+	struct frr_pthread *fpt = io->fpt;
+
+	while (true) {
+		/* per-pthread buffer for transferring packets */
+		uint8_t *pktbuf = io->pktbuf;
 		/* shorter alias to peer's input buffer */
 		struct ringbuf *ibw = peer->ibuf_work;
 		/* packet size as given by header */
@@ -225,45 +701,56 @@ static int bgp_process_reads(struct thread *thread)
 		/* if this fails we are seriously screwed */
 		assert(pktsize <= BGP_MAX_PACKET_SIZE);
 
+		if (ringbuf_remain(ibw) < pktsize)
+			break;
+
+		/* no room for it; leave it in ibuf_work for later */
+		if (spsc_ring_full(peer->ibuf) && bgp_ibuf_stall(peer)) {
+			atomic_fetch_add_explicit(&io->stalls, 1,
+						  memory_order_relaxed);
+			stalled = true;
+			break;
+		}
+
 		/*
-		 * If we have that much data, chuck it into its own
-		 * stream and append to input queue for processing.
+		 * We have that much data, chuck it into its own stream and
+		 * append to input queue for processing.
 		 */
-		if (ringbuf_remain(ibw) >= pktsize) {
-			struct stream *pkt = stream_new(pktsize);
-			assert(ringbuf_get(ibw, pktbuf, pktsize) == pktsize);
-			stream_put(pkt, pktbuf, pktsize);
+		struct stream *pkt = stream_new(pktsize);
+		assert(ringbuf_get(ibw, pktbuf, pktsize) == pktsize);
+		stream_put(pkt, pktbuf, pktsize);
 
-			frr_with_mutex(&peer->io_mtx) {
-				stream_fifo_push(peer->ibuf, pkt);
-			}
+		assert(spsc_ring_push(peer->ibuf, pkt));
+		atomic_fetch_add_explicit(&io->packets_in, 1,
+					  memory_order_relaxed);
 
-			added_pkt = true;
-		} else
-			break;
+		added_pkt = true;
 	}
 
 	/* handle invalid header */
 	if (fatal) {
 		/* wipe buffer just in case someone screwed up */
 		ringbuf_wipe(peer->ibuf_work);
-	} else {
+		return;
+	}
+
+	if (!stalled) {
 		assert(ringbuf_space(peer->ibuf_work) >= BGP_MAX_PACKET_SIZE);
 
 		thread_add_read(fpt->master, bgp_process_reads, peer, peer->fd,
 				&peer->t_read);
-		if (added_pkt)
-			thread_add_timer_msec(bm->master, bgp_process_packet,
-					      peer, 0, &peer->t_process_packet);
 	}
 
-	return 0;
+	if (added_pkt)
+		thread_add_timer_msec(bm->master, bgp_process_packet, peer, 0,
+				      &peer->t_process_packet);
 }
 
 /*
  * Flush peer output buffer.
  *
  * This function pops packets off of peer->obuf and writes them to peer->fd.
+ * Being the consumer of peer->obuf, it must be called with peer->io_mtx held.
  * The amount of packets written is equal to the minimum of peer->wpkt_quanta
  * and the number of packets on the output buffer, unless an error occurs.
  *
@@ -272,48 +759,41 @@ static int bgp_process_reads(struct thread *thread)
  * The return value is equal to the number of packets written
  * (which may be zero).
  */
-static uint16_t bgp_write(struct peer *peer)
+static uint16_t bgp_write(struct peer *peer, struct bgp_io_pthread *io)
 {
 	uint8_t type;
-	struct stream *s;
+	struct bgp_opkt *op;
 	int update_last_write = 0;
 	unsigned int count;
 	uint32_t uo = 0;
 	uint16_t status = 0;
 	uint32_t wpkt_quanta_old;
 
-	int writenum = 0;
-	int num;
+	ssize_t num;
 	unsigned int iovsz;
-	unsigned int strmsz;
 	unsigned int total_written;
 
 	wpkt_quanta_old = atomic_load_explicit(&peer->bgp->wpkt_quanta,
 					       memory_order_relaxed);
-	struct stream *ostreams[wpkt_quanta_old];
-	struct stream **streams = ostreams;
-	struct iovec iov[wpkt_quanta_old];
+	struct bgp_opkt *opkts[wpkt_quanta_old];
+	struct iovec iov[wpkt_quanta_old * 2];
 
-	s = stream_fifo_head(peer->obuf);
+	op = spsc_ring_peek(peer->obuf, 0);
 
-	if (!s)
+	if (!op)
 		goto done;
 
 	count = iovsz = 0;
-	while (count < wpkt_quanta_old && iovsz < array_size(iov) && s) {
-		ostreams[iovsz] = s;
-		iov[iovsz].iov_base = stream_pnt(s);
-		iov[iovsz].iov_len = STREAM_READABLE(s);
-		writenum += STREAM_READABLE(s);
-		s = s->next;
-		++iovsz;
+	while (count < wpkt_quanta_old && op) {
+		opkts[count] = op;
+		iovsz += bgp_opkt_iov(op, &iov[iovsz]);
 		++count;
+		op = spsc_ring_peek(peer->obuf, count);
 	}
 
-	strmsz = iovsz;
 	total_written = 0;
 
-	do {
+	while (true) {
 		num = writev(peer->fd, iov, iovsz);
 
 		if (num < 0) {
@@ -325,51 +805,48 @@ static uint16_t bgp_write(struct peer *peer)
 			}
 
 			break;
-		} else if (num != writenum) {
-			unsigned int msg_written = 0;
-			unsigned int ic = iovsz;
+		}
 
-			for (unsigned int i = 0; i < ic; i++) {
-				size_t ss = iov[i].iov_len;
+		while (num > 0 && total_written < count) {
+			size_t left;
 
-				if (ss > (unsigned int) num)
-					break;
+			op = opkts[total_written];
+			left = bgp_opkt_len(op) - op->written;
 
-				msg_written++;
-				iovsz--;
-				writenum -= ss;
-				num -= ss;
+			if ((size_t)num < left) {
+				op->written += num;
+				break;
 			}
 
-			total_written += msg_written;
-
-			assert(total_written < count);
+			op->written += left;
+			num -= left;
+			total_written++;
+		}
 
-			memmove(&iov, &iov[msg_written],
-				sizeof(iov[0]) * iovsz);
-			streams = &streams[msg_written];
-			stream_forward_getp(streams[0], num);
-			iov[0].iov_base = stream_pnt(streams[0]);
-			iov[0].iov_len = STREAM_READABLE(streams[0]);
+		if (total_written == count)
+			break;
 
-			writenum -= num;
-			num = 0;
-			assert(writenum > 0);
-		} else {
-			total_written = strmsz;
-		}
+		/* partial write, go on with what is left */
+		iovsz = 0;
+		for (unsigned int i = total_written; i < count; i++)
+			iovsz += bgp_opkt_iov(opkts[i], &iov[iovsz]);
+	}
 
-	} while (num != writenum);
+	if (total_written) {
+		atomic_fetch_add_explicit(&io->writes, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&io->packets_out,
+					  total_written, memory_order_relaxed);
+	}
 
 	/* Handle statistics */
 	for (unsigned int i = 0; i < total_written; i++) {
-		s = stream_fifo_pop(peer->obuf);
+		op = spsc_ring_pop(peer->obuf);
 
-		assert(s == ostreams[i]);
+		assert(op == opkts[i]);
 
 		/* Retrieve BGP packet type. */
-		stream_set_getp(s, BGP_MARKER_SIZE + 2);
-		type = stream_getc(s);
+		type = bgp_opkt_type(op);
 
 		switch (type) {
 		case BGP_MSG_OPEN:
@@ -396,6 +873,7 @@ static uint16_t bgp_write(struct peer *peer)
 			 * to Connect instead of Idle.
 			 */
 			BGP_EVENT_ADD(peer, BGP_Stop);
+			bgp_opkt_free(op);
 			goto done;
 
 		case BGP_MSG_KEEPALIVE:
@@ -413,8 +891,8 @@ static uint16_t bgp_write(struct peer *peer)
 			break;
 		}
 
-		stream_free(s);
-		ostreams[i] = NULL;
+		bgp_opkt_free(op);
+		opkts[i] = NULL;
 		update_last_write = 1;
 	}
 
@@ -442,14 +920,14 @@ done : {
  *
  * @return status flag (see top-of-file)
  */
-static uint16_t bgp_read(struct peer *peer)
+static uint16_t bgp_read(struct peer *peer, struct bgp_io_pthread *io)
 {
 	size_t readsize; // how many bytes we want to read
 	ssize_t nbytes;  // how many bytes we actually read
 	uint16_t status = 0;
-	static uint8_t ibw[BGP_MAX_PACKET_SIZE * BGP_READ_PACKET_MAX];
+	uint8_t *ibw = io->ibw;
 
-	readsize = MIN(ringbuf_space(peer->ibuf_work), sizeof(ibw));
+	readsize = MIN(ringbuf_space(peer->ibuf_work), sizeof(io->ibw));
 	nbytes = read(peer->fd, ibw, readsize);
 
 	/* EAGAIN or EWOULDBLOCK; come back later */
@@ -496,6 +974,9 @@ static uint16_t bgp_read(struct peer *peer)
 	} else {
 		assert(ringbuf_put(peer->ibuf_work, ibw, nbytes)
 		       == (size_t)nbytes);
+		atomic_fetch_add_explicit(&io->reads, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&io->read_bytes, nbytes,
+					  memory_order_relaxed);
 	}
 
 	return status;
@@ -579,3 +1060,73 @@ static bool validate_header(struct peer *peer)
 
 	return true;
 }
+
+/* vty --------------------------------------------------------------------- */
+
+DEFUN (show_bgp_io,
+       show_bgp_io_cmd,
+       "show bgp io [json]",
+       SHOW_STR
+       BGP_STR
+       "BGP peer I/O pthreads\n"
+       JSON_STR)
+{
+	bool uj = use_json(argc, argv);
+	json_object *json = NULL, *json_pth;
+	struct bgp_io_pthread *io;
+	unsigned int i;
+
+	if (uj)
+		json = json_object_new_object();
+	else {
+		vty_out(vty, "%u I/O pthread%s\n\n", bgp_io_pool_size,
+			bgp_io_pool_size == 1 ? "" : "s");
+		vty_out(vty,
+			"%-18s %6s %10s %12s %10s %10s %10s %7s\n",
+			"Thread", "Peers", "Reads", "Bytes in", "Pkts in",
+			"Writes", "Pkts out", "Stalls");
+	}
+
+	for (i = 0; i < bgp_io_pool_size; i++) {
+		io = &bgp_io_pool[i];
+
+		if (uj) {
+			json_pth = json_object_new_object();
+			json_object_int_add(json_pth, "peers", io->peers);
+			json_object_int_add(json_pth, "reads", io->reads);
+			json_object_int_add(json_pth, "bytesIn",
+					    io->read_bytes);
+			json_object_int_add(json_pth, "packetsIn",
+					    io->packets_in);
+			json_object_int_add(json_pth, "writes", io->writes);
+			json_object_int_add(json_pth, "packetsOut",
+					    io->packets_out);
+			json_object_int_add(json_pth, "stalls", io->stalls);
+			json_object_object_add(json, io->fpt->os_name,
+					       json_pth);
+			continue;
+		}
+
+		vty_out(vty,
+			"%-18s %6u %10" PRIu64 " %12" PRIu64 " %10" PRIu64
+			" %10" PRIu64 " %10" PRIu64 " %7" PRIu64 "\n",
+			io->fpt->os_name, io->peers, (uint64_t)io->reads,
+			(uint64_t)io->read_bytes, (uint64_t)io->packets_in,
+			(uint64_t)io->writes, (uint64_t)io->packets_out,
+			(uint64_t)io->stalls);
+	}
+
+	if (uj) {
+		vty_out(vty, "%s\n",
+			json_object_to_json_string_ext(
+				json, JSON_C_TO_STRING_PRETTY));
+		json_object_free(json);
+	}
+
+	return CMD_SUCCESS;
+}
+
+void bgp_io_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_bgp_io_cmd);
+}
@@ -25,9 +25,66 @@
 #define BGP_WRITE_PACKET_MAX 64U
 #define BGP_READ_PACKET_MAX  10U
 
+/* Slots in peer->ibuf and peer->obuf */
+#define BGP_IBUF_RING_SIZE 1024U
+#define BGP_OBUF_RING_SIZE 1024U
+
+/* Upper limit for the -T / --io_threads option */
+#define BGP_IO_PTHREADS_MAX 64U
+
 #include "bgpd/bgpd.h"
 #include "frr_pthread.h"
 
+/*
+ * One of the pthreads doing peer socket I/O.
+ *
+ * Peers are handed to the pthread serving the fewest peers when the main
+ * pthread turns their reads or writes on, and stay with it until both are
+ * turned off again.
+ */
+struct bgp_io_pthread {
+	struct frr_pthread *fpt;
+
+	/* peers with reads or writes on; only touched by the main pthread */
+	unsigned int peers;
+
+	/* statistics, only written by this pthread */
+	_Atomic uint64_t reads;	      // successful read() calls
+	_Atomic uint64_t read_bytes;  // bytes read
+	_Atomic uint64_t packets_in;  // packets handed to the main pthread
+	_Atomic uint64_t writes;      // write passes getting packets out
+	_Atomic uint64_t packets_out; // packets written
+	_Atomic uint64_t stalls;      // times reading paused for a full ibuf
+
+	/* scratch space for bgp_read() and splitting up packets */
+	uint8_t ibw[BGP_MAX_PACKET_SIZE * BGP_READ_PACKET_MAX];
+	uint8_t pktbuf[BGP_MAX_PACKET_SIZE];
+};
+
+/**
+ * Creates the I/O pthreads.
+ *
+ * @param count - number of pthreads, between 1 and BGP_IO_PTHREADS_MAX
+ */
+extern void bgp_io_pthreads_init(unsigned int count);
+
+/**
+ * Starts the I/O pthreads, and waits for them to be up and running.
+ */
+extern void bgp_io_pthreads_run(void);
+extern void bgp_io_pthreads_wait_running(void);
+
+/**
+ * Releases the I/O pthread pool. The pthreads must have been stopped
+ * already.
+ */
+extern void bgp_io_pthreads_finish(void);
+
+/**
+ * Installs the "show bgp io" command.
+ */
+extern void bgp_io_vty_init(void);
+
 /**
  * Start function for write thread.
  *
@@ -52,6 +109,9 @@ extern int bgp_io_stop(void **result, struct frr_pthread *fpt);
  *
  * Additionally, it becomes unsafe to perform socket actions on peer->fd.
  *
+ * Outside the main pthread this only wakes up the peer's I/O pthread, and does
+ * nothing if reads and writes are both off.
+ *
  * @param peer - peer to register
  */
 extern void bgp_writes_on(struct peer *peer);
@@ -74,7 +134,7 @@ extern void bgp_writes_off(struct peer *peer);
  * Turns on packet reading for a peer.
  *
  * After this function is called, any packets received on peer->fd will be read
- * and copied into the FIFO queue peer->ibuf.
+ * and copied into the ring peer->ibuf.
  *
  * Additionally, it becomes unsafe to perform socket actions on peer->fd.
  *
@@ -100,4 +160,110 @@ extern void bgp_reads_on(struct peer *peer);
  */
 extern void bgp_reads_off(struct peer *peer);
 
+/**
+ * Resumes packet reading for a peer after the I/O thread paused it because
+ * peer->ibuf was full.
+ *
+ * Called from the main thread after it has taken packets off peer->ibuf and
+ * found peer->ibuf_stalled raised.
+ *
+ * @param peer - peer to resume reading from
+ */
+extern void bgp_reads_resume(struct peer *peer);
+
+/*
+ * A packet several peers send, written from here by each of their I/O
+ * pthreads instead of being copied onto every peer's output queue.  Read-only
+ * once shared; the last reference frees the stream.
+ */
+struct bgp_pktbuf {
+	_Atomic unsigned int refcnt;
+	struct stream *s;
+};
+
+/*
+ * One packet on peer->obuf.  Without shared, s is the whole packet.  With
+ * shared, the packet is shared->s from shared_off on, preceded by s holding
+ * this peer's own copy of the first shared_off bytes (if shared_off is not 0).
+ */
+struct bgp_opkt {
+	struct bgp_opkt *next; // for peer->obuf_spill
+	struct stream *s;
+	struct bgp_pktbuf *shared;
+	size_t shared_off;
+	size_t written; // bytes already sent, obuf consumer only
+};
+
+/* packets that did not fit onto peer->obuf, in order */
+struct bgp_opkt_fifo {
+	struct bgp_opkt *head;
+	struct bgp_opkt **tailp;
+	atomic_size_t count;
+};
+
+/**
+ * Wraps a packet for sharing; the stream is owned by the bgp_pktbuf
+ * afterwards, which starts out with one reference for the caller.
+ */
+extern struct bgp_pktbuf *bgp_pktbuf_new(struct stream *s);
+extern void bgp_pktbuf_unref(struct bgp_pktbuf *pb);
+
+/**
+ * Makes an output queue entry; see struct bgp_opkt.  Takes ownership of s
+ * and a new reference on shared.
+ */
+extern struct bgp_opkt *bgp_opkt_new(struct stream *s,
+				     struct bgp_pktbuf *shared,
+				     size_t shared_off);
+
+/**
+ * Allocates and frees peer->ibuf, peer->obuf and peer->obuf_spill.
+ */
+extern void bgp_io_bufs_new(struct peer *peer);
+extern void bgp_io_bufs_free(struct peer *peer);
+
+/**
+ * Drops all packets queued in either direction.
+ *
+ * Reads, writes and keepalives must be off, and the caller must hold
+ * peer->io_mtx.
+ *
+ * @param peer - peer whose buffers to clean
+ */
+extern void bgp_io_bufs_clean(struct peer *peer);
+
+/**
+ * Drops all packets waiting to be written.
+ *
+ * May be called from any thread holding peer->io_mtx.
+ *
+ * @param peer - peer whose output queue to clean
+ */
+extern void bgp_obuf_clean(struct peer *peer);
+
+/**
+ * Queues a packet for writing by the I/O thread.
+ *
+ * May be called from any thread; producers are serialized on peer->obuf_mtx.
+ * Packets that don't fit onto peer->obuf go to peer->obuf_spill, and so does
+ * everything after them until the I/O thread has caught up, to keep them in
+ * order.
+ *
+ * @param peer - peer to send to
+ * @param s - packet, owned by the I/O thread afterwards
+ */
+extern void bgp_obuf_push(struct peer *peer, struct stream *s);
+
+/**
+ * Same as bgp_obuf_push(), for packets made with bgp_opkt_new().
+ */
+extern void bgp_obuf_push_opkt(struct peer *peer, struct bgp_opkt *op);
+
+/**
+ * Number of packets waiting in peer->ibuf and peer->obuf respectively.
+ * Snapshots, for display purposes.
+ */
+extern size_t bgp_ibuf_count(struct peer *peer);
+extern size_t bgp_obuf_count(struct peer *peer);
+
 #endif /* _FRR_BGP_IO_H */
@@ -58,8 +58,10 @@
 #include "bgpd/bgp_zebra.h"
 #include "bgpd/bgp_packet.h"
 #include "bgpd/bgp_keepalives.h"
+#include "bgpd/bgp_io.h"
 #include "bgpd/bgp_network.h"
 #include "bgpd/bgp_errors.h"
+#include "bgpd/bgp_rmap_cache.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
@@ -75,6 +77,7 @@ static const struct option longopts[] = {
 	{"int_num", required_argument, NULL, 'I'},
 	{"no_zebra", no_argument, NULL, 'Z'},
 	{"socket_size", required_argument, NULL, 's'},
+	{"io_threads", required_argument, NULL, 'T'},
 	{0}};
 
 /* signal definitions */
@@ -200,6 +203,9 @@ static __attribute__((__noreturn__)) void bgp_exit(int status)
 	/* reverse bgp_route_init */
 	bgp_route_finish();
 
+	/* reverse bgp_rmap_cache_init */
+	bgp_rmap_cache_finish();
+
 	/* cleanup route maps */
 	bgp_route_map_terminate();
 
@@ -388,10 +394,11 @@ int main(int argc, char **argv)
 	int skip_runas = 0;
 	int instance = 0;
 	int buffer_size = BGP_SOCKET_SNDBUF_SIZE;
+	unsigned long io_pthreads = 1;
 
 	frr_preinit(&bgpd_di, argc, argv);
 	frr_opt_add(
-		"p:l:SnZe:I:s:" DEPRECATED_OPTIONS, longopts,
+		"p:l:SnZe:I:s:T:" DEPRECATED_OPTIONS, longopts,
 		"  -p, --bgp_port     Set BGP listen port number (0 means do not listen).\n"
 		"  -l, --listenon     Listen on specified address (implies -n)\n"
 		"  -n, --no_kernel    Do not install route to kernel.\n"
@@ -399,7 +406,8 @@ int main(int argc, char **argv)
 		"  -S, --skip_runas   Skip capabilities checks, and changing user and group IDs.\n"
 		"  -e, --ecmp         Specify ECMP to use.\n"
 		"  -I, --int_num      Set instance number (label-manager)\n"
-		"  -s, --socket_size  Set BGP peer socket send buffer size\n");
+		"  -s, --socket_size  Set BGP peer socket send buffer size\n"
+		"  -T, --io_threads   Number of pthreads for peer socket I/O\n");
 
 	/* Command line argument treatment. */
 	while (1) {
@@ -462,6 +470,16 @@ int main(int argc, char **argv)
 		case 's':
 			buffer_size = atoi(optarg);
 			break;
+		case 'T':
+			io_pthreads = strtoul(optarg, NULL, 10);
+			if (io_pthreads == 0
+			    || io_pthreads > BGP_IO_PTHREADS_MAX) {
+				fprintf(stderr,
+					"Number of I/O threads must be between 1 and %u\n",
+					BGP_IO_PTHREADS_MAX);
+				return 1;
+			}
+			break;
 		default:
 			frr_help_exit(1);
 			break;
@@ -476,6 +494,7 @@ int main(int argc, char **argv)
 	if (bgp_port == 0)
 		bgp_option_set(BGP_OPT_NO_LISTEN);
 	bm->address = bgp_address;
+	bm->io_pthreads = io_pthreads;
 	if (no_fib_flag || no_zebra_flag)
 		bgp_option_set(BGP_OPT_NO_FIB);
 	if (no_zebra_flag)
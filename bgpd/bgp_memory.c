@@ -50,7 +50,6 @@ DEFINE_MTYPE(BGPD, AS_STR, "BGP aspath str")
 
 DEFINE_MTYPE(BGPD, BGP_TABLE, "BGP table")
 DEFINE_MTYPE(BGPD, BGP_NODE, "BGP node")
-DEFINE_MTYPE(BGPD, BGP_ROUTE, "BGP route")
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA, "BGP ancillary route info")
 DEFINE_MTYPE(BGPD, BGP_CONN, "BGP connected")
 DEFINE_MTYPE(BGPD, BGP_STATIC, "BGP static")
@@ -58,7 +57,6 @@ DEFINE_MTYPE(BGPD, BGP_ADVERTISE_ATTR, "BGP adv attr")
 DEFINE_MTYPE(BGPD, BGP_ADVERTISE, "BGP adv")
 DEFINE_MTYPE(BGPD, BGP_SYNCHRONISE, "BGP synchronise")
 DEFINE_MTYPE(BGPD, BGP_ADJ_IN, "BGP adj in")
-DEFINE_MTYPE(BGPD, BGP_ADJ_OUT, "BGP adj out")
 DEFINE_MTYPE(BGPD, BGP_MPATH_INFO, "BGP multipath info")
 
 DEFINE_MTYPE(BGPD, AS_LIST, "BGP AS list")
@@ -119,14 +119,12 @@ int bgp_packet_set_size(struct stream *s)
 }
 
 /*
- * Push a packet onto the beginning of the peer's output queue.
- * This function acquires the peer's write mutex before proceeding.
+ * Push a packet onto the end of the peer's output queue.
+ * This function acquires the peer's output queue mutex before proceeding.
  */
 static void bgp_packet_add(struct peer *peer, struct stream *s)
 {
-	frr_with_mutex(&peer->io_mtx) {
-		stream_fifo_push(peer->obuf, s);
-	}
+	bgp_obuf_push(peer, s);
 }
 
 static struct stream *bgp_update_packet_eor(struct peer *peer, afi_t afi,
@@ -387,6 +385,8 @@ int bgp_generate_updgrp_packets(struct thread *thread)
 	struct peer *peer = THREAD_ARG(thread);
 
 	struct stream *s;
+	struct bgp_opkt *op;
+	bool queued;
 	struct peer_af *paf;
 	struct bpacket *next_pkt;
 	uint32_t wpq;
@@ -409,7 +409,7 @@ int bgp_generate_updgrp_packets(struct thread *thread)
 		return 0;
 
 	do {
-		s = NULL;
+		queued = false;
 		FOREACH_AFI_SAFI (afi, safi) {
 			paf = peer_af_find(peer, afi, safi);
 			if (!paf || !PAF_SUBGRP(paf))
@@ -467,6 +467,8 @@ int bgp_generate_updgrp_packets(struct thread *thread)
 							BGP_UPDATE_EOR_PKT(
 								peer, afi, safi,
 								s);
+							if (s)
+								queued = true;
 						}
 					}
 				}
@@ -479,11 +481,14 @@ int bgp_generate_updgrp_packets(struct thread *thread)
 			/* Found a packet template to send, overwrite
 			 * packet with appropriate attributes from peer
 			 * and advance peer */
-			s = bpacket_reformat_for_peer(next_pkt, paf);
-			bgp_packet_add(peer, s);
+			op = bpacket_reformat_for_peer(next_pkt, paf);
+			if (op) {
+				bgp_obuf_push_opkt(peer, op);
+				queued = true;
+			}
 			bpacket_queue_advance_peer(paf);
 		}
-	} while (s && (++generated < wpq));
+	} while (queued && (++generated < wpq));
 
 	if (generated)
 		bgp_writes_on(peer);
@@ -579,25 +584,17 @@ void bgp_open_send(struct peer *peer)
  * Writes NOTIFICATION message directly to a peer socket without waiting for
  * the I/O thread.
  *
- * There must be exactly one stream on the peer->obuf FIFO, and the data within
- * this stream must match the format of a BGP NOTIFICATION message.
- * Transmission is best-effort.
+ * The data within the stream must match the format of a BGP NOTIFICATION
+ * message. Transmission is best-effort.
  *
  * @requires peer->io_mtx
  * @param peer
- * @return 0
+ * @param s      the NOTIFICATION, freed by this function
  */
-static void bgp_write_notify(struct peer *peer)
+static void bgp_write_notify(struct peer *peer, struct stream *s)
 {
 	int ret, val;
 	uint8_t type;
-	struct stream *s;
-
-	/* There should be at least one packet. */
-	s = stream_fifo_pop(peer->obuf);
-
-	if (!s)
-		return;
 
 	assert(stream_get_endp(s) >= BGP_HEADER_SIZE);
 
@@ -652,14 +649,15 @@ static void bgp_write_notify(struct peer *peer)
 }
 
 /*
- * Creates a BGP Notify and appends it to the peer's output queue.
+ * Creates a BGP Notify and writes it to the peer.
  *
- * This function attempts to write the packet from the thread it is called
- * from, to ensure the packet gets out ASAP.
+ * This function writes the packet from the thread it is called from, to
+ * ensure the packet gets out ASAP; everything still queued on the peer's
+ * output queue is dropped.
  *
  * This function may be called from multiple threads. Since the function
- * modifies I/O buffer(s) in the peer, these are locked for the duration of the
- * call to prevent tampering from other threads.
+ * writes to the socket and drains the peer's output queue, it holds the I/O
+ * mutex for the duration of the call to keep the I/O thread out.
  *
  * Delivery of the NOTIFICATION is attempted once and is best-effort. After
  * return, the peer structure *must* be reset; no assumptions about session
@@ -676,7 +674,7 @@ void bgp_notify_send_with_data(struct peer *peer, uint8_t code,
 {
 	struct stream *s;
 
-	/* Lock I/O mutex to prevent other threads from pushing packets */
+	/* Lock I/O mutex to prevent the I/O thread from writing packets */
 	frr_mutex_lock_autounlock(&peer->io_mtx);
 	/* ============================================== */
 
@@ -698,7 +696,7 @@ void bgp_notify_send_with_data(struct peer *peer, uint8_t code,
 	bgp_packet_set_size(s);
 
 	/* wipe output buffer */
-	stream_fifo_clean(peer->obuf);
+	bgp_obuf_clean(peer);
 
 	/*
 	 * If possible, store last packet for debugging purposes. This check is
@@ -766,14 +764,11 @@ void bgp_notify_send_with_data(struct peer *peer, uint8_t code,
 	} else
 		peer->last_reset = PEER_DOWN_NOTIFY_SEND;
 
-	/* Add packet to peer's output queue */
-	stream_fifo_push(peer->obuf, s);
-
 	bgp_peer_gr_flags_update(peer);
 	BGP_GR_ROUTER_DETECT_AND_SEND_CAPABILITY_TO_ZEBRA(peer->bgp,
 							  peer->bgp->peer);
 
-	bgp_write_notify(peer);
+	bgp_write_notify(peer, s);
 }
 
 /*
@@ -2322,9 +2317,7 @@ int bgp_process_packet(struct thread *thread)
 		bgp_size_t size;
 		char notify_data_length[2];
 
-		frr_with_mutex(&peer->io_mtx) {
-			peer->curr = stream_fifo_pop(peer->ibuf);
-		}
+		peer->curr = spsc_ring_pop(peer->ibuf);
 
 		if (peer->curr == NULL) // no packets to process, hmm...
 			return 0;
@@ -2443,13 +2436,16 @@ int bgp_process_packet(struct thread *thread)
 
 	if (fsm_update_result != FSM_PEER_TRANSFERRED
 	    && fsm_update_result != FSM_PEER_STOPPED) {
-		frr_with_mutex(&peer->io_mtx) {
-			// more work to do, come back later
-			if (peer->ibuf->count > 0)
-				thread_add_timer_msec(
-					bm->master, bgp_process_packet, peer, 0,
-					&peer->t_process_packet);
-		}
+		// more work to do, come back later
+		if (spsc_ring_count(peer->ibuf) > 0)
+			thread_add_timer_msec(bm->master, bgp_process_packet,
+					      peer, 0, &peer->t_process_packet);
+
+		// the I/O thread waits for room on ibuf before reading on
+		if (processed
+		    && atomic_exchange_explicit(&peer->ibuf_stalled, false,
+						memory_order_seq_cst))
+			bgp_reads_resume(peer);
 	}
 
 	return 0;
@@ -25,6 +25,7 @@
 #include "memory.h"
 #include "queue.h"
 #include "filter.h"
+#include "jhash.h"
 
 #include "bgpd.h"
 #include "bgp_aspath.h"
@@ -87,3 +88,934 @@ void bgp_regex_free(regex_t *regex)
 	regfree(regex);
 	XFREE(MTYPE_BGP_REGEXP, regex);
 }
+
+/*
+ * AS path regular expressions
+ *
+ * as-path access-lists are evaluated against every received path, which
+ * made regexec() on the AS path string one of the most expensive parts of
+ * processing an UPDATE.  AS path expressions only use a small part of
+ * POSIX ERE (config_bgp_aspath_validate() limits the characters), so they
+ * are compiled into a Thompson NFA here and matched with a DFA built
+ * lazily from it: one table lookup per character of the path, no
+ * backtracking.  Expressions the parser isn't sure about are handed to
+ * regcomp() instead, so the results are always the same as before.
+ *
+ * On top of that, each compiled expression remembers its verdict for the
+ * last interned AS paths it saw; the same few paths are received over and
+ * over again.
+ */
+
+/* Limits on the size of the automata */
+#define BGP_RE_NFA_MAX 4096
+#define BGP_RE_SETS_MAX 64
+#define BGP_RE_DFA_MAX 256
+
+/* Verdicts remembered per expression, must be a power of 2 */
+#define BGP_RE_CACHE_SIZE 1024
+
+enum bgp_re_node_type {
+	BGP_RE_EMPTY,
+	BGP_RE_SET,
+	BGP_RE_BOL,
+	BGP_RE_EOL,
+	BGP_RE_CAT,
+	BGP_RE_ALT,
+	BGP_RE_REPEAT,
+};
+
+/* Parse tree */
+struct bgp_re_node {
+	enum bgp_re_node_type type;
+	struct bgp_re_node *left;
+	struct bgp_re_node *right;
+	/* BGP_RE_SET: index of the character set */
+	uint8_t set;
+	/* BGP_RE_REPEAT: max is -1 for no upper bound */
+	int min;
+	int max;
+};
+
+enum bgp_re_nfa_op {
+	BGP_RE_OP_CHAR,
+	BGP_RE_OP_SPLIT,
+	BGP_RE_OP_BOL,
+	BGP_RE_OP_EOL,
+	BGP_RE_OP_MATCH,
+};
+
+struct bgp_re_nfa_state {
+	uint8_t op;
+	uint8_t set;
+	uint16_t out;
+	uint16_t out1;
+};
+
+struct bgp_re_dfa_state {
+	/* NFA states this DFA state stands for, sorted */
+	uint16_t *nfa;
+	uint16_t nnfa;
+	uint32_t hash;
+
+	/* Reached the end of the expression / would at end of string */
+	bool match;
+	bool match_eol;
+
+	/* Next state for each character class, -1 if not built yet */
+	int16_t *next;
+};
+
+struct bgp_re_cache_entry {
+	const struct aspath *aspath;
+	uint32_t id;
+	bool match;
+};
+
+/* Expression compiled here, see bgp_re_compile() */
+struct bgp_re {
+	/* Character to character class */
+	uint8_t cls[256];
+	uint16_t ncls;
+	/* One representative character per class */
+	uint8_t cls_char[256];
+
+	uint32_t sets[BGP_RE_SETS_MAX][256 / 32];
+	uint8_t nsets;
+
+	struct bgp_re_nfa_state *nfa;
+	uint16_t nnfa;
+	uint16_t nfa_start;
+
+	/* Grown as states are built, up to BGP_RE_DFA_MAX */
+	struct bgp_re_dfa_state *dfa;
+	uint16_t ndfa;
+	uint16_t dfasize;
+
+	/* Scratch space for building state sets */
+	uint16_t *stack;
+	uint16_t *work;
+	uint32_t *mark;
+	uint32_t gen;
+
+	struct bgp_re_cache_entry cache[BGP_RE_CACHE_SIZE];
+};
+
+struct bgp_aspath_regex {
+	/* Exactly one of these is set; the DFA and its verdict cache are
+	 * only allocated for expressions that compiled here.
+	 */
+	struct bgp_re *dfa;
+	regex_t *posix;
+};
+
+struct bgp_re_parser {
+	struct bgp_re *re;
+	const char *p;
+	int depth;
+	bool error;
+
+	struct bgp_re_node *nodes;
+	int nnodes;
+	int maxnodes;
+};
+
+static inline void bgp_re_set_add(uint32_t *set, uint8_t c)
+{
+	set[c / 32] |= 1U << (c % 32);
+}
+
+static inline bool bgp_re_set_has(const uint32_t *set, uint8_t c)
+{
+	return set[c / 32] & (1U << (c % 32));
+}
+
+static struct bgp_re_node *bgp_re_node_new(struct bgp_re_parser *ps,
+					   enum bgp_re_node_type type,
+					   struct bgp_re_node *left,
+					   struct bgp_re_node *right)
+{
+	struct bgp_re_node *node;
+
+	if (ps->nnodes == ps->maxnodes) {
+		ps->error = true;
+		return NULL;
+	}
+
+	node = &ps->nodes[ps->nnodes++];
+	node->type = type;
+	node->left = left;
+	node->right = right;
+
+	return node;
+}
+
+static struct bgp_re_node *bgp_re_set_new(struct bgp_re_parser *ps,
+					  uint32_t **set)
+{
+	struct bgp_re_node *node;
+
+	if (ps->re->nsets == BGP_RE_SETS_MAX) {
+		ps->error = true;
+		return NULL;
+	}
+
+	node = bgp_re_node_new(ps, BGP_RE_SET, NULL, NULL);
+	if (!node)
+		return NULL;
+
+	node->set = ps->re->nsets++;
+	*set = ps->re->sets[node->set];
+	memset(*set, 0, sizeof(ps->re->sets[0]));
+
+	return node;
+}
+
+static struct bgp_re_node *bgp_re_char(struct bgp_re_parser *ps, uint8_t c)
+{
+	struct bgp_re_node *node;
+	uint32_t *set;
+
+	node = bgp_re_set_new(ps, &set);
+	if (node)
+		bgp_re_set_add(set, c);
+
+	return node;
+}
+
+/* Bracket expression, p is past the '[' */
+static struct bgp_re_node *bgp_re_bracket(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *node;
+	uint32_t *set;
+	bool negate = false;
+	bool first = true;
+	int c, end, i;
+
+	node = bgp_re_set_new(ps, &set);
+	if (!node)
+		return NULL;
+
+	if (*ps->p == '^') {
+		negate = true;
+		ps->p++;
+	}
+
+	while (*ps->p != ']' || first) {
+		c = (uint8_t)*ps->p;
+
+		/* No character classes, collating elements etc. */
+		if (c == '\0' || (c == '[' && strchr(":.=", ps->p[1]))) {
+			ps->error = true;
+			return NULL;
+		}
+		ps->p++;
+		first = false;
+
+		end = c;
+		if (ps->p[0] == '-' && ps->p[1] != ']' && ps->p[1] != '\0') {
+			end = (uint8_t)ps->p[1];
+			if (end < c || end == '[') {
+				ps->error = true;
+				return NULL;
+			}
+			ps->p += 2;
+		}
+
+		for (i = c; i <= end; i++)
+			bgp_re_set_add(set, i);
+	}
+	ps->p++;
+
+	if (negate)
+		for (i = 0; i < 256 / 32; i++)
+			set[i] = ~set[i];
+
+	return node;
+}
+
+static struct bgp_re_node *bgp_re_alt(struct bgp_re_parser *ps);
+
+/* '_' matches a delimiter, or the start or the end of the path */
+static struct bgp_re_node *bgp_re_underscore(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *delim;
+	uint32_t *set;
+	const char *c;
+
+	delim = bgp_re_set_new(ps, &set);
+	if (!delim)
+		return NULL;
+
+	for (c = ",{}() "; *c; c++)
+		bgp_re_set_add(set, *c);
+
+	return bgp_re_node_new(
+		ps, BGP_RE_ALT, bgp_re_node_new(ps, BGP_RE_BOL, NULL, NULL),
+		bgp_re_node_new(ps, BGP_RE_ALT, delim,
+				bgp_re_node_new(ps, BGP_RE_EOL, NULL, NULL)));
+}
+
+static struct bgp_re_node *bgp_re_atom(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *node;
+	uint32_t *set;
+	char c = *ps->p++;
+
+	switch (c) {
+	case '(':
+		ps->depth++;
+		node = bgp_re_alt(ps);
+		if (*ps->p != ')') {
+			ps->error = true;
+			return NULL;
+		}
+		ps->p++;
+		ps->depth--;
+		/* Keep "()" from being repeated as an empty node */
+		return node ? node
+			    : bgp_re_node_new(ps, BGP_RE_EMPTY, NULL, NULL);
+	case '[':
+		return bgp_re_bracket(ps);
+	case '.':
+		node = bgp_re_set_new(ps, &set);
+		if (node)
+			memset(set, 0xff, sizeof(ps->re->sets[0]));
+		return node;
+	case '^':
+		return bgp_re_node_new(ps, BGP_RE_BOL, NULL, NULL);
+	case '$':
+		return bgp_re_node_new(ps, BGP_RE_EOL, NULL, NULL);
+	case '_':
+		return bgp_re_underscore(ps);
+	case '\\':
+		c = *ps->p++;
+		/* Back-references are left to regcomp() */
+		if (c == '\0' || isdigit((unsigned char)c)) {
+			ps->error = true;
+			return NULL;
+		}
+		return bgp_re_char(ps, c);
+	case '*':
+	case '+':
+	case '?':
+	case '{':
+	case ')':
+	case '|':
+	case '\0':
+		ps->error = true;
+		return NULL;
+	default:
+		return bgp_re_char(ps, c);
+	}
+}
+
+/* Can node match without consuming a character? */
+static bool bgp_re_nullable(const struct bgp_re_node *node)
+{
+	switch (node->type) {
+	case BGP_RE_SET:
+		return false;
+	case BGP_RE_CAT:
+		return bgp_re_nullable(node->left)
+		       && bgp_re_nullable(node->right);
+	case BGP_RE_ALT:
+		return bgp_re_nullable(node->left)
+		       || bgp_re_nullable(node->right);
+	case BGP_RE_REPEAT:
+		return node->min == 0 || bgp_re_nullable(node->left);
+	default:
+		return true;
+	}
+}
+
+/* Bound after an atom, p is past the '{' */
+static bool bgp_re_bound(struct bgp_re_parser *ps, int *min, int *max)
+{
+	char *end;
+
+	*min = 0;
+	if (isdigit((unsigned char)*ps->p)) {
+		*min = strtol(ps->p, &end, 10);
+		ps->p = end;
+	} else if (*ps->p != ',')
+		return false;
+
+	*max = *min;
+	if (*ps->p == ',') {
+		ps->p++;
+		*max = -1;
+		if (isdigit((unsigned char)*ps->p)) {
+			*max = strtol(ps->p, &end, 10);
+			ps->p = end;
+		}
+	}
+
+	if (*ps->p != '}' || *min > RE_DUP_MAX || *max > RE_DUP_MAX
+	    || (*max != -1 && *max < *min))
+		return false;
+
+	ps->p++;
+	return true;
+}
+
+static struct bgp_re_node *bgp_re_repeat(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *node;
+	int min, max;
+
+	node = bgp_re_atom(ps);
+
+	while (!ps->error) {
+		switch (*ps->p) {
+		case '*':
+			min = 0;
+			max = -1;
+			break;
+		case '+':
+			min = 1;
+			max = -1;
+			break;
+		case '?':
+			min = 0;
+			max = 1;
+			break;
+		case '{':
+			ps->p++;
+			if (!bgp_re_bound(ps, &min, &max)) {
+				ps->error = true;
+				return NULL;
+			}
+			ps->p--;
+			break;
+		default:
+			return node;
+		}
+		ps->p++;
+
+		/* regexec() is inconsistent about repeating something that
+		 * can match the empty string, as in "_*", so leave those to
+		 * it.
+		 */
+		if (bgp_re_nullable(node)) {
+			ps->error = true;
+			return NULL;
+		}
+
+		node = bgp_re_node_new(ps, BGP_RE_REPEAT, node, NULL);
+		if (!node)
+			return NULL;
+		node->min = min;
+		node->max = max;
+	}
+
+	return NULL;
+}
+
+static struct bgp_re_node *bgp_re_cat(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *node = NULL, *next;
+
+	while (!ps->error && *ps->p != '\0' && *ps->p != '|'
+	       && !(*ps->p == ')' && ps->depth)) {
+		/* An unmatched ')' is a literal to regcomp(), but leave
+		 * such oddities to it.
+		 */
+		if (*ps->p == ')') {
+			ps->error = true;
+			return NULL;
+		}
+
+		next = bgp_re_repeat(ps);
+		if (!next)
+			return NULL;
+
+		node = node ? bgp_re_node_new(ps, BGP_RE_CAT, node, next)
+			    : next;
+	}
+
+	return node;
+}
+
+/* NULL without error means the empty expression */
+static struct bgp_re_node *bgp_re_alt(struct bgp_re_parser *ps)
+{
+	struct bgp_re_node *node, *next;
+
+	node = bgp_re_cat(ps);
+	while (!ps->error && *ps->p == '|') {
+		ps->p++;
+		next = bgp_re_cat(ps);
+
+		if (!node)
+			node = bgp_re_node_new(ps, BGP_RE_EMPTY, NULL, NULL);
+		if (!next)
+			next = bgp_re_node_new(ps, BGP_RE_EMPTY, NULL, NULL);
+
+		node = bgp_re_node_new(ps, BGP_RE_ALT, node, next);
+	}
+
+	return ps->error ? NULL : node;
+}
+
+static int bgp_re_nfa_new(struct bgp_re *re, uint8_t op, int out, int out1)
+{
+	struct bgp_re_nfa_state *st;
+
+	if (re->nnfa == BGP_RE_NFA_MAX)
+		return -1;
+
+	st = &re->nfa[re->nnfa];
+	st->op = op;
+	st->set = 0;
+	st->out = out;
+	st->out1 = out1;
+
+	return re->nnfa++;
+}
+
+/*
+ * Emit the NFA for node, continuing to state next; returns the entry
+ * state or -1 if the automaton gets too big.
+ */
+static int bgp_re_nfa_emit(struct bgp_re *re,
+			   const struct bgp_re_node *node, int next)
+{
+	int st, loop, i;
+
+	if (next < 0)
+		return -1;
+
+	switch (node->type) {
+	case BGP_RE_EMPTY:
+		return next;
+	case BGP_RE_SET:
+		st = bgp_re_nfa_new(re, BGP_RE_OP_CHAR, next, 0);
+		if (st >= 0)
+			re->nfa[st].set = node->set;
+		return st;
+	case BGP_RE_BOL:
+		return bgp_re_nfa_new(re, BGP_RE_OP_BOL, next, 0);
+	case BGP_RE_EOL:
+		return bgp_re_nfa_new(re, BGP_RE_OP_EOL, next, 0);
+	case BGP_RE_CAT:
+		return bgp_re_nfa_emit(re, node->left,
+				       bgp_re_nfa_emit(re, node->right, next));
+	case BGP_RE_ALT:
+		st = bgp_re_nfa_emit(re, node->left, next);
+		i = bgp_re_nfa_emit(re, node->right, next);
+		if (st < 0 || i < 0)
+			return -1;
+		return bgp_re_nfa_new(re, BGP_RE_OP_SPLIT, st, i);
+	case BGP_RE_REPEAT:
+		st = next;
+
+		if (node->max == -1) {
+			/* x* loops back through a split */
+			loop = bgp_re_nfa_new(re, BGP_RE_OP_SPLIT, 0, next);
+			if (loop < 0)
+				return -1;
+			i = bgp_re_nfa_emit(re, node->left, loop);
+			if (i < 0)
+				return -1;
+			re->nfa[loop].out = i;
+			st = loop;
+		} else {
+			/* Optional copies, each of which may skip to next */
+			for (i = node->min; i < node->max && st >= 0; i++) {
+				loop = bgp_re_nfa_emit(re, node->left, st);
+				st = loop < 0 ? -1
+					      : bgp_re_nfa_new(re,
+							       BGP_RE_OP_SPLIT,
+							       loop, next);
+			}
+		}
+
+		/* Mandatory copies */
+		for (i = 0; i < node->min && st >= 0; i++)
+			st = bgp_re_nfa_emit(re, node->left, st);
+
+		return st;
+	}
+
+	return -1;
+}
+
+/* Split the characters into classes that no set tells apart */
+static void bgp_re_classes(struct bgp_re *re)
+{
+	uint16_t map[256][2];
+	uint16_t ncls;
+	int c, s;
+
+	memset(re->cls, 0, sizeof(re->cls));
+	re->ncls = 1;
+
+	for (s = 0; s < re->nsets; s++) {
+		memset(map, 0xff, sizeof(map));
+		ncls = 0;
+
+		for (c = 0; c < 256; c++) {
+			uint16_t *m = &map[re->cls[c]]
+					  [bgp_re_set_has(re->sets[s], c)];
+
+			if (*m == 0xffff)
+				*m = ncls++;
+			re->cls[c] = *m;
+		}
+		re->ncls = ncls;
+	}
+
+	for (c = 255; c >= 0; c--)
+		re->cls_char[re->cls[c]] = c;
+}
+
+/*
+ * Add the closure of NFA state st to the set being built in re->work,
+ * following anchors only where they hold.
+ */
+static void bgp_re_closure(struct bgp_re *re, uint16_t *nwork,
+			   int st, bool bol, bool eol)
+{
+	const struct bgp_re_nfa_state *ns;
+	int sp = 0;
+
+	if (re->mark[st] == re->gen)
+		return;
+	re->mark[st] = re->gen;
+	re->stack[sp++] = st;
+
+	while (sp) {
+		st = re->stack[--sp];
+		ns = &re->nfa[st];
+
+		/* Anchors stay in the set so that the end of string check
+		 * can still follow them.
+		 */
+		re->work[(*nwork)++] = st;
+
+		switch (ns->op) {
+		case BGP_RE_OP_SPLIT:
+			if (re->mark[ns->out1] != re->gen) {
+				re->mark[ns->out1] = re->gen;
+				re->stack[sp++] = ns->out1;
+			}
+			/* fallthrough */
+		case BGP_RE_OP_BOL:
+		case BGP_RE_OP_EOL:
+			if ((ns->op == BGP_RE_OP_BOL && !bol)
+			    || (ns->op == BGP_RE_OP_EOL && !eol))
+				break;
+			if (re->mark[ns->out] != re->gen) {
+				re->mark[ns->out] = re->gen;
+				re->stack[sp++] = ns->out;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+static int bgp_re_u16_cmp(const void *a, const void *b)
+{
+	return *(const uint16_t *)a - *(const uint16_t *)b;
+}
+
+/* Would the set of states match if the string ended here? */
+static bool bgp_re_match_eol(struct bgp_re *re, const uint16_t *set,
+			     uint16_t nset, bool bol)
+{
+	uint16_t nwork = 0;
+	int i;
+
+	re->gen++;
+	for (i = 0; i < nset; i++)
+		bgp_re_closure(re, &nwork, set[i], bol, true);
+
+	for (i = 0; i < nwork; i++)
+		if (re->nfa[re->work[i]].op == BGP_RE_OP_MATCH)
+			return true;
+
+	return false;
+}
+
+/* Find or add the DFA state for the set in re->work */
+static int bgp_re_dfa_state(struct bgp_re *re, uint16_t nwork)
+{
+	struct bgp_re_dfa_state *ds;
+	uint32_t hash;
+	int i;
+
+	qsort(re->work, nwork, sizeof(*re->work), bgp_re_u16_cmp);
+	hash = jhash(re->work, nwork * sizeof(*re->work), 0);
+
+	/* State 0 is only ever the start of the string, where anchors
+	 * behave differently, so it is never reused.
+	 */
+	for (i = 1; i < re->ndfa; i++) {
+		ds = &re->dfa[i];
+		if (ds->hash == hash && ds->nnfa == nwork
+		    && !memcmp(ds->nfa, re->work, nwork * sizeof(*re->work)))
+			return i;
+	}
+
+	if (re->ndfa == BGP_RE_DFA_MAX)
+		return -1;
+
+	if (re->ndfa == re->dfasize) {
+		re->dfasize = MIN(MAX(2 * re->dfasize, 8), BGP_RE_DFA_MAX);
+		re->dfa = XREALLOC(MTYPE_BGP_REGEXP, re->dfa,
+				   re->dfasize * sizeof(*re->dfa));
+	}
+
+	ds = &re->dfa[re->ndfa];
+	ds->nnfa = nwork;
+	ds->hash = hash;
+	ds->nfa = XMALLOC(MTYPE_BGP_REGEXP, nwork * sizeof(*ds->nfa));
+	memcpy(ds->nfa, re->work, nwork * sizeof(*ds->nfa));
+	ds->next = XMALLOC(MTYPE_BGP_REGEXP, re->ncls * sizeof(*ds->next));
+	for (i = 0; i < re->ncls; i++)
+		ds->next[i] = -1;
+
+	ds->match = false;
+	for (i = 0; i < nwork; i++)
+		if (re->nfa[ds->nfa[i]].op == BGP_RE_OP_MATCH)
+			ds->match = true;
+
+	/* The start state is the only one at the start of the string */
+	ds->match_eol = ds->match
+			|| bgp_re_match_eol(re, ds->nfa, ds->nnfa,
+					    re->ndfa == 0);
+
+	return re->ndfa++;
+}
+
+/*
+ * Build the set reached from set on a character of class cls; the match
+ * can also start over at any position.
+ */
+static uint16_t bgp_re_step(struct bgp_re *re, const uint16_t *set,
+			    uint16_t nset, uint8_t cls, uint16_t *out)
+{
+	const struct bgp_re_nfa_state *ns;
+	uint8_t c = re->cls_char[cls];
+	uint16_t nwork = 0;
+	int i;
+
+	re->gen++;
+	for (i = 0; i < nset; i++) {
+		ns = &re->nfa[set[i]];
+		if (ns->op == BGP_RE_OP_CHAR
+		    && bgp_re_set_has(re->sets[ns->set], c))
+			bgp_re_closure(re, &nwork, ns->out, false, false);
+	}
+	bgp_re_closure(re, &nwork, re->nfa_start, false, false);
+
+	memcpy(out, re->work, nwork * sizeof(*out));
+	return nwork;
+}
+
+/* Plain NFA simulation, for when there would be too many DFA states */
+static bool bgp_re_nfa_match(struct bgp_re *re, const char *str)
+{
+	uint16_t *cur, *nxt, *tmp;
+	uint16_t ncur, i;
+	const char *s;
+	bool match = false;
+
+	cur = XMALLOC(MTYPE_TMP, re->nnfa * sizeof(*cur));
+	nxt = XMALLOC(MTYPE_TMP, re->nnfa * sizeof(*nxt));
+
+	re->gen++;
+	ncur = 0;
+	bgp_re_closure(re, &ncur, re->nfa_start, true, false);
+	memcpy(cur, re->work, ncur * sizeof(*cur));
+
+	for (s = str; !match; s++) {
+		for (i = 0; i < ncur; i++)
+			if (re->nfa[cur[i]].op == BGP_RE_OP_MATCH)
+				match = true;
+		if (match)
+			break;
+
+		if (*s == '\0') {
+			match = bgp_re_match_eol(re, cur, ncur, s == str);
+			break;
+		}
+
+		ncur = bgp_re_step(re, cur, ncur, re->cls[(uint8_t)*s], nxt);
+		tmp = cur;
+		cur = nxt;
+		nxt = tmp;
+	}
+
+	XFREE(MTYPE_TMP, cur);
+	XFREE(MTYPE_TMP, nxt);
+
+	return match;
+}
+
+static bool bgp_re_dfa_match(struct bgp_re *re, const char *str)
+{
+	struct bgp_re_dfa_state *ds;
+	const char *s;
+	uint16_t nwork;
+	uint8_t cls;
+	int st = 0, next;
+
+	/* An empty string can match on anchors at both ends */
+	if (*str == '\0')
+		return bgp_re_nfa_match(re, str);
+
+	for (s = str; *s; s++) {
+		ds = &re->dfa[st];
+		if (ds->match)
+			return true;
+
+		cls = re->cls[(uint8_t)*s];
+		next = ds->next[cls];
+		if (next < 0) {
+			nwork = bgp_re_step(re, ds->nfa, ds->nnfa, cls,
+					    re->work + re->nnfa);
+			memmove(re->work, re->work + re->nnfa,
+				nwork * sizeof(*re->work));
+			/* may move re->dfa */
+			next = bgp_re_dfa_state(re, nwork);
+			if (next < 0)
+				return bgp_re_nfa_match(re, str);
+			re->dfa[st].next[cls] = next;
+		}
+		st = next;
+	}
+
+	return re->dfa[st].match_eol;
+}
+
+static struct bgp_re *bgp_re_compile(const char *regstr)
+{
+	struct bgp_re *re;
+	struct bgp_re_parser ps = {};
+	struct bgp_re_node *root;
+	uint16_t nwork = 0;
+	int match, start;
+
+	re = XCALLOC(MTYPE_BGP_REGEXP, sizeof(*re));
+
+	ps.re = re;
+	ps.p = regstr;
+	/* '_' is the largest expansion, at 5 nodes per character */
+	ps.maxnodes = 5 * strlen(regstr) + 2;
+	ps.nodes = XCALLOC(MTYPE_TMP, ps.maxnodes * sizeof(*ps.nodes));
+
+	root = bgp_re_alt(&ps);
+	if (ps.error || *ps.p != '\0')
+		goto fail;
+
+	bgp_re_classes(re);
+
+	re->nfa = XCALLOC(MTYPE_BGP_REGEXP,
+			  BGP_RE_NFA_MAX * sizeof(*re->nfa));
+	match = bgp_re_nfa_new(re, BGP_RE_OP_MATCH, 0, 0);
+	start = root ? bgp_re_nfa_emit(re, root, match) : match;
+	if (start < 0)
+		goto fail;
+	re->nfa_start = start;
+
+	re->nfa = XREALLOC(MTYPE_BGP_REGEXP, re->nfa,
+			   re->nnfa * sizeof(*re->nfa));
+	re->stack = XCALLOC(MTYPE_BGP_REGEXP, re->nnfa * sizeof(*re->stack));
+	/* Room for two sets, see bgp_re_dfa_match() */
+	re->work = XCALLOC(MTYPE_BGP_REGEXP,
+			   2 * re->nnfa * sizeof(*re->work));
+	re->mark = XCALLOC(MTYPE_BGP_REGEXP, re->nnfa * sizeof(*re->mark));
+
+	/* DFA state 0 is the start of the string */
+	re->gen++;
+	bgp_re_closure(re, &nwork, re->nfa_start, true, false);
+	bgp_re_dfa_state(re, nwork);
+
+	XFREE(MTYPE_TMP, ps.nodes);
+	return re;
+
+fail:
+	XFREE(MTYPE_TMP, ps.nodes);
+	XFREE(MTYPE_BGP_REGEXP, re->nfa);
+	XFREE(MTYPE_BGP_REGEXP, re);
+	return NULL;
+}
+
+static void bgp_re_free(struct bgp_re *re)
+{
+	int i;
+
+	for (i = 0; i < re->ndfa; i++) {
+		XFREE(MTYPE_BGP_REGEXP, re->dfa[i].nfa);
+		XFREE(MTYPE_BGP_REGEXP, re->dfa[i].next);
+	}
+
+	XFREE(MTYPE_BGP_REGEXP, re->dfa);
+	XFREE(MTYPE_BGP_REGEXP, re->nfa);
+	XFREE(MTYPE_BGP_REGEXP, re->stack);
+	XFREE(MTYPE_BGP_REGEXP, re->work);
+	XFREE(MTYPE_BGP_REGEXP, re->mark);
+	XFREE(MTYPE_BGP_REGEXP, re);
+}
+
+struct bgp_aspath_regex *bgp_aspath_regcomp(const char *regstr)
+{
+	struct bgp_aspath_regex *reg;
+
+	reg = XCALLOC(MTYPE_BGP_REGEXP, sizeof(*reg));
+
+	reg->dfa = bgp_re_compile(regstr);
+	if (reg->dfa)
+		return reg;
+
+	/* Leave it to the system's regular expressions */
+	reg->posix = bgp_regcomp(regstr);
+	if (!reg->posix) {
+		XFREE(MTYPE_BGP_REGEXP, reg);
+		return NULL;
+	}
+
+	return reg;
+}
+
+/*
+ * Not thread safe: the DFA and the verdict cache are filled in as paths
+ * are matched.
+ */
+bool bgp_aspath_regexec(struct bgp_aspath_regex *reg,
+			const struct aspath *aspath)
+{
+	struct bgp_re *re = reg->dfa;
+	struct bgp_re_cache_entry *ce;
+
+	if (!re)
+		return regexec(reg->posix, aspath->str, 0, NULL, 0)
+		       != REG_NOMATCH;
+
+	/* Only interned paths have an id */
+	if (!aspath->id)
+		return bgp_re_dfa_match(re, aspath->str);
+
+	ce = &re->cache[aspath->id & (BGP_RE_CACHE_SIZE - 1)];
+	if (ce->aspath == aspath && ce->id == aspath->id)
+		return ce->match;
+
+	ce->aspath = aspath;
+	ce->id = aspath->id;
+	ce->match = bgp_re_dfa_match(re, aspath->str);
+
+	return ce->match;
+}
+
+void bgp_aspath_regex_free(struct bgp_aspath_regex *reg)
+{
+	if (reg->posix)
+		bgp_regex_free(reg->posix);
+	if (reg->dfa)
+		bgp_re_free(reg->dfa);
+
+	XFREE(MTYPE_BGP_REGEXP, reg);
+}
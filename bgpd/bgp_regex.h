@@ -33,4 +33,12 @@ extern void bgp_regex_free(regex_t *regex);
 extern regex_t *bgp_regcomp(const char *str);
 extern int bgp_regexec(regex_t *regex, struct aspath *aspath);
 
+/* Compiled AS path regular expression, see bgp_regex.c */
+struct bgp_aspath_regex;
+
+extern struct bgp_aspath_regex *bgp_aspath_regcomp(const char *regstr);
+extern bool bgp_aspath_regexec(struct bgp_aspath_regex *re,
+			       const struct aspath *aspath);
+extern void bgp_aspath_regex_free(struct bgp_aspath_regex *re);
+
 #endif /* _QUAGGA_BGP_REGEX_H */
@@ -0,0 +1,308 @@
+/* BGP route-map result cache.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2, or (at your option) any later
+ * version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * A full table peer sends hundreds of thousands of prefixes, but only a few
+ * thousand distinct sets of attributes, and typical neighbor route-maps only
+ * match on and modify those attributes.  Running the route-map once per set
+ * of attributes instead of once per prefix is enough.
+ *
+ * The cache is direct mapped.  Each slot keeps a copy of the attributes the
+ * route-map was applied to and of the result; both hold a reference on the
+ * aspath, communities etc. they point to, so comparing those pointers is
+ * meaningful.  Nothing is ever aged out: the whole cache is dropped when the
+ * configuration the results depend on changes.
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "jhash.h"
+#include "memory.h"
+#include "routemap.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_rmap_cache.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_RMAP_CACHE, "BGP route-map cache")
+
+struct bgp_rmap_cache_entry {
+	/* NULL if the slot is empty */
+	struct route_map *map;
+
+	/* never dereferenced, the cache is flushed when a peer goes away */
+	struct peer *peer;
+	uint16_t rmap_type;
+	uint8_t family;
+	route_map_result_t ret;
+
+	/* attributes before and after applying the route-map; out is only
+	 * valid for RMAP_PERMITMATCH */
+	struct attr in;
+	struct attr out;
+};
+
+static struct bgp_rmap_cache_entry *rmap_cache;
+/* power of 2, 0 if the cache is disabled */
+static unsigned int rmap_cache_size;
+static unsigned int rmap_cache_used;
+
+/* last route-map checked with bgp_route_map_cacheable() */
+static struct route_map *rmap_cache_checked;
+static bool rmap_cache_checked_ok;
+
+struct bgp_rmap_cache_stats bgp_rmap_cache_stats;
+
+/* the reference count is the only part of the attributes not to compare */
+#define ATTR_HEAD_LEN offsetof(struct attr, refcnt)
+#define ATTR_TAIL_OFF (ATTR_HEAD_LEN + sizeof(((struct attr *)0)->refcnt))
+#define ATTR_TAIL_LEN (sizeof(struct attr) - ATTR_TAIL_OFF)
+
+static bool bgp_rmap_cache_attr_same(const struct attr *a1,
+				     const struct attr *a2)
+{
+	return memcmp(a1, a2, ATTR_HEAD_LEN) == 0
+	       && memcmp((const uint8_t *)a1 + ATTR_TAIL_OFF,
+			 (const uint8_t *)a2 + ATTR_TAIL_OFF, ATTR_TAIL_LEN)
+			  == 0;
+}
+
+static uint32_t bgp_rmap_cache_key(struct route_map *map,
+				   const struct peer *peer, uint8_t family,
+				   const struct attr *attr)
+{
+	uint32_t key;
+
+	key = jhash(attr, ATTR_HEAD_LEN, 0);
+	key = jhash((const uint8_t *)attr + ATTR_TAIL_OFF, ATTR_TAIL_LEN, key);
+
+	return jhash_3words((uint32_t)(uintptr_t)map,
+			    (uint32_t)(uintptr_t)peer,
+			    ((uint32_t)peer->rmap_type << 8) | family, key);
+}
+
+static void bgp_rmap_cache_entry_clear(struct bgp_rmap_cache_entry *entry)
+{
+	if (!entry->map)
+		return;
+
+	bgp_attr_unintern_sub(&entry->in);
+	if (entry->ret == RMAP_PERMITMATCH)
+		bgp_attr_unintern_sub(&entry->out);
+
+	memset(entry, 0, sizeof(*entry));
+	rmap_cache_used--;
+}
+
+void bgp_rmap_cache_flush(void)
+{
+	unsigned int i;
+
+	rmap_cache_checked = NULL;
+
+	if (!rmap_cache_used)
+		return;
+
+	for (i = 0; i < rmap_cache_size && rmap_cache_used; i++)
+		bgp_rmap_cache_entry_clear(&rmap_cache[i]);
+
+	bgp_rmap_cache_stats.flushes++;
+}
+
+static bool bgp_rmap_cache_map_ok(struct route_map *map)
+{
+	if (map != rmap_cache_checked) {
+		rmap_cache_checked = map;
+		rmap_cache_checked_ok = bgp_route_map_cacheable(map);
+	}
+
+	return rmap_cache_checked_ok;
+}
+
+route_map_result_t bgp_rmap_cache_apply(struct route_map *map,
+					const struct prefix *p,
+					struct bgp_path_info *path)
+{
+	struct bgp_rmap_cache_entry *entry;
+	struct attr *attr = path->attr;
+	struct peer *peer = path->peer;
+	struct attr in;
+	route_map_result_t ret;
+	uint32_t key;
+
+	/* attributes pointing to structures that aren't interned yet are
+	 * rare, taking references on them would mean modifying the caller's
+	 * copy before the route-map gets to see it */
+	if (!rmap_cache_size || !map || !map->head
+	    || !bgp_attr_sub_interned(attr))
+		return route_map_apply(map, p, RMAP_BGP, path);
+
+	key = bgp_rmap_cache_key(map, peer, p->family, attr);
+	entry = &rmap_cache[key & (rmap_cache_size - 1)];
+
+	if (entry->map == map && entry->peer == peer
+	    && entry->rmap_type == peer->rmap_type
+	    && entry->family == p->family
+	    && bgp_rmap_cache_attr_same(&entry->in, attr)) {
+		bgp_rmap_cache_stats.hits++;
+		map->applied++;
+
+		if (entry->ret == RMAP_PERMITMATCH)
+			*attr = entry->out;
+		return entry->ret;
+	}
+
+	if (!bgp_rmap_cache_map_ok(map)) {
+		bgp_rmap_cache_stats.uncacheable++;
+		return route_map_apply(map, p, RMAP_BGP, path);
+	}
+
+	bgp_rmap_cache_stats.misses++;
+
+	in = *attr;
+	ret = route_map_apply(map, p, RMAP_BGP, path);
+
+	bgp_rmap_cache_entry_clear(entry);
+
+	entry->map = map;
+	entry->peer = peer;
+	entry->rmap_type = peer->rmap_type;
+	entry->family = p->family;
+	entry->ret = ret;
+
+	/* only takes references, everything in there is interned already */
+	entry->in = in;
+	bgp_attr_intern_sub(&entry->in);
+
+	/* the route-map may have made new communities etc., intern those in
+	 * the caller's copy as well, so that it points to the same structures
+	 * as the cached result */
+	if (ret == RMAP_PERMITMATCH) {
+		bgp_attr_intern_sub(attr);
+		entry->out = *attr;
+	}
+
+	rmap_cache_used++;
+
+	return ret;
+}
+
+void bgp_rmap_cache_set_size(unsigned int size)
+{
+	unsigned int rounded = 1;
+
+	size = MIN(size, BGP_RMAP_CACHE_SIZE_MAX);
+	while (size && rounded < size)
+		rounded <<= 1;
+	if (!size)
+		rounded = 0;
+
+	if (rounded == rmap_cache_size)
+		return;
+
+	bgp_rmap_cache_flush();
+	XFREE(MTYPE_BGP_RMAP_CACHE, rmap_cache);
+
+	rmap_cache_size = rounded;
+	if (rmap_cache_size)
+		rmap_cache = XCALLOC(MTYPE_BGP_RMAP_CACHE,
+				     sizeof(*rmap_cache) * rmap_cache_size);
+}
+
+void bgp_rmap_cache_config_write(struct vty *vty)
+{
+	if (!rmap_cache_size)
+		return;
+
+	if (rmap_cache_size == BGP_RMAP_CACHE_SIZE_DEFAULT)
+		vty_out(vty, "bgp route-map cache\n");
+	else
+		vty_out(vty, "bgp route-map cache %u\n", rmap_cache_size);
+}
+
+DEFUN (bgp_route_map_cache,
+       bgp_route_map_cache_cmd,
+       "bgp route-map cache [(256-262144)]",
+       BGP_STR
+       "BGP route-map\n"
+       "Remember route-map results for paths with the same attributes\n"
+       "Number of cache entries\n")
+{
+	int idx_number = 3;
+	unsigned int size = BGP_RMAP_CACHE_SIZE_DEFAULT;
+
+	if (argc > idx_number)
+		size = strtoul(argv[idx_number]->arg, NULL, 10);
+
+	bgp_rmap_cache_set_size(size);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_bgp_route_map_cache,
+       no_bgp_route_map_cache_cmd,
+       "no bgp route-map cache [(256-262144)]",
+       NO_STR
+       BGP_STR
+       "BGP route-map\n"
+       "Remember route-map results for paths with the same attributes\n"
+       "Number of cache entries\n")
+{
+	bgp_rmap_cache_set_size(0);
+	return CMD_SUCCESS;
+}
+
+DEFUN (show_bgp_route_map_cache,
+       show_bgp_route_map_cache_cmd,
+       "show bgp route-map cache",
+       SHOW_STR
+       BGP_STR
+       "BGP route-map\n"
+       "Route-map result cache statistics\n")
+{
+	struct bgp_rmap_cache_stats *stats = &bgp_rmap_cache_stats;
+
+	if (!rmap_cache_size) {
+		vty_out(vty, "Route-map cache is disabled\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Entries: %u used of %u\n", rmap_cache_used,
+		rmap_cache_size);
+	vty_out(vty, "Hits: %" PRIu64 ", misses: %" PRIu64 "\n", stats->hits,
+		stats->misses);
+	vty_out(vty, "Not cacheable: %" PRIu64 "\n", stats->uncacheable);
+	vty_out(vty, "Flushes: %" PRIu64 "\n", stats->flushes);
+
+	return CMD_SUCCESS;
+}
+
+void bgp_rmap_cache_init(void)
+{
+	install_element(CONFIG_NODE, &bgp_route_map_cache_cmd);
+	install_element(CONFIG_NODE, &no_bgp_route_map_cache_cmd);
+	install_element(VIEW_NODE, &show_bgp_route_map_cache_cmd);
+}
+
+void bgp_rmap_cache_finish(void)
+{
+	bgp_rmap_cache_set_size(0);
+}
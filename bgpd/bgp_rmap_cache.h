@@ -0,0 +1,76 @@
+/* BGP route-map result cache.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2, or (at your option) any later
+ * version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_BGP_RMAP_CACHE_H
+#define _FRR_BGP_RMAP_CACHE_H
+
+#include "routemap.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_route.h"
+
+#define BGP_RMAP_CACHE_SIZE_DEFAULT 4096
+#define BGP_RMAP_CACHE_SIZE_MAX 262144
+
+/* Only ever updated from the main pthread. */
+struct bgp_rmap_cache_stats {
+	uint64_t hits;
+	uint64_t misses;
+	/* applications of route-maps with prefix dependent rules */
+	uint64_t uncacheable;
+	uint64_t flushes;
+};
+
+extern struct bgp_rmap_cache_stats bgp_rmap_cache_stats;
+
+extern void bgp_rmap_cache_init(void);
+extern void bgp_rmap_cache_finish(void);
+
+/*
+ * Resize the cache, rounding up to a power of 2.  0 disables it; route-maps
+ * are then always applied with route_map_apply() as before.
+ */
+extern void bgp_rmap_cache_set_size(unsigned int size);
+
+/*
+ * Drop all cached results.  Called whenever a route-map, or a list one of
+ * them refers to, changes, and when a peer comes up or goes away.
+ */
+extern void bgp_rmap_cache_flush(void);
+
+/*
+ * Drop-in replacement for route_map_apply(map, p, RMAP_BGP, path), with
+ * peer->rmap_type set up by the caller as usual.
+ *
+ * If map only consists of rules that look at the attributes and the peer,
+ * the outcome is remembered for the (map, attributes, peer, direction)
+ * tuple, so that the other prefixes sharing those attributes get the
+ * verdict and the modified attributes without running the route-map again.
+ * On a permit, the structures referenced by path->attr are interned.
+ */
+extern route_map_result_t bgp_rmap_cache_apply(struct route_map *map,
+					       const struct prefix *p,
+					       struct bgp_path_info *path);
+
+/* Implemented in bgp_routemap.c, which knows about the individual rules. */
+extern bool bgp_route_map_cacheable(struct route_map *map);
+
+extern void bgp_rmap_cache_config_write(struct vty *vty);
+
+#endif /* _FRR_BGP_RMAP_CACHE_H */
@@ -39,6 +39,7 @@
 #include "queue.h"
 #include "memory.h"
 #include "srv6.h"
+#include "jhash.h"
 #include "lib/json.h"
 #include "lib_errors.h"
 #include "zclient.h"
@@ -70,6 +71,8 @@
 #include "bgpd/bgp_addpath.h"
 #include "bgpd/bgp_mac.h"
 #include "bgpd/bgp_network.h"
+#include "bgpd/bgp_select.h"
+#include "bgpd/bgp_rmap_cache.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
@@ -88,6 +91,8 @@
 #include "bgpd/bgp_route_clippy.c"
 #endif
 
+DEFINE_MTYPE_SLAB(BGPD, BGP_ROUTE, "BGP route", sizeof(struct bgp_path_info))
+
 /* Extern from bgp_dump.c */
 extern const char *bgp_origin_str[];
 extern const char *bgp_origin_long_str[];
@@ -1368,8 +1373,13 @@ static int bgp_input_modifier(struct peer *peer, const struct prefix *p,
 
 		SET_FLAG(peer->rmap_type, PEER_RMAP_TYPE_IN);
 
-		/* Apply BGP route map to the attribute. */
-		ret = route_map_apply(rmap, p, RMAP_BGP, &rmap_path);
+		/* Apply BGP route map to the attribute.  The show commands
+		 * bgp_attr_undup() the result, which can't cope with the
+		 * interned structures a cached result points to. */
+		if (rmap_name)
+			ret = route_map_apply(rmap, p, RMAP_BGP, &rmap_path);
+		else
+			ret = bgp_rmap_cache_apply(rmap, p, &rmap_path);
 
 		peer->rmap_type = 0;
 
@@ -1898,11 +1908,11 @@ bool subgroup_announce_check(struct bgp_node *rn, struct bgp_path_info *pi,
 		SET_FLAG(peer->rmap_type, PEER_RMAP_TYPE_OUT);
 
 		if (pi->extra && pi->extra->suppress)
-			ret = route_map_apply(UNSUPPRESS_MAP(filter), p,
-					      RMAP_BGP, &rmap_path);
+			ret = bgp_rmap_cache_apply(UNSUPPRESS_MAP(filter), p,
+						   &rmap_path);
 		else
-			ret = route_map_apply(ROUTE_MAP_OUT(filter), p,
-					      RMAP_BGP, &rmap_path);
+			ret = bgp_rmap_cache_apply(ROUTE_MAP_OUT(filter), p,
+						   &rmap_path);
 
 		peer->rmap_type = 0;
 
@@ -2099,16 +2109,175 @@ static int bgp_route_select_timer_expire(struct thread *thread)
 	return bgp_best_path_select_defer(bgp, afi, safi);
 }
 
+/*
+ * bgp deterministic-med: mark the best path received from each neighbouring
+ * AS with BGP_PATH_DMED_SELECTED.
+ *
+ * Only touches the DMED marker flags of rn's own paths, which do not affect
+ * prefix counts, so this is safe to run on a bestpath worker pthread.
+ */
+static void bgp_best_selection_dmed(struct bgp *bgp, struct bgp_node *rn,
+				    struct bgp_maxpaths_cfg *mpath_cfg,
+				    enum bgp_path_selection_reason *reason,
+				    int debug, char *pfx_buf, afi_t afi,
+				    safi_t safi)
+{
+	struct bgp_path_info *new_select;
+	struct bgp_path_info *pi1;
+	struct bgp_path_info *pi2;
+	int paths_eq;
+	char path_buf[PATH_ADDPATH_STR_BUFFER];
+
+	/* Clear BGP_PATH_DMED_SELECTED for all paths */
+	for (pi1 = bgp_node_get_bgp_path_info(rn); pi1; pi1 = pi1->next)
+		bgp_path_info_unset_flag(rn, pi1, BGP_PATH_DMED_SELECTED);
+
+	for (pi1 = bgp_node_get_bgp_path_info(rn); pi1; pi1 = pi1->next) {
+		if (CHECK_FLAG(pi1->flags, BGP_PATH_DMED_CHECK))
+			continue;
+		if (BGP_PATH_HOLDDOWN(pi1))
+			continue;
+		if (pi1->peer != bgp->peer_self)
+			if (pi1->peer->status != Established)
+				continue;
+
+		new_select = pi1;
+		if (pi1->next) {
+			for (pi2 = pi1->next; pi2; pi2 = pi2->next) {
+				if (CHECK_FLAG(pi2->flags, BGP_PATH_DMED_CHECK))
+					continue;
+				if (BGP_PATH_HOLDDOWN(pi2))
+					continue;
+				if (pi2->peer != bgp->peer_self
+				    && !CHECK_FLAG(pi2->peer->sflags,
+						   PEER_STATUS_NSF_WAIT))
+					if (pi2->peer->status != Established)
+						continue;
+
+				if (!aspath_cmp_left(pi1->attr->aspath,
+						     pi2->attr->aspath)
+				    && !aspath_cmp_left_confed(
+					       pi1->attr->aspath,
+					       pi2->attr->aspath))
+					continue;
+
+				if (bgp_path_info_cmp(bgp, pi2, new_select,
+						      &paths_eq, mpath_cfg,
+						      debug, pfx_buf, afi, safi,
+						      reason)) {
+					bgp_path_info_unset_flag(
+						rn, new_select,
+						BGP_PATH_DMED_SELECTED);
+					new_select = pi2;
+				}
+
+				bgp_path_info_set_flag(rn, pi2,
+						       BGP_PATH_DMED_CHECK);
+			}
+		}
+		bgp_path_info_set_flag(rn, new_select, BGP_PATH_DMED_CHECK);
+		bgp_path_info_set_flag(rn, new_select, BGP_PATH_DMED_SELECTED);
+
+		if (debug) {
+			bgp_path_info_path_with_addpath_rx_str(new_select,
+							       path_buf);
+			zlog_debug("%s: %s is the bestpath from AS %u",
+				   pfx_buf, path_buf,
+				   aspath_get_first_as(
+					   new_select->attr->aspath));
+		}
+	}
+}
+
+/*
+ * Summary of the inputs to best path selection for a node.  Used to detect
+ * that a node's paths changed between computing a bestpath hint on a worker
+ * pthread and consuming it on the main pthread.
+ */
+static uint32_t bgp_best_selection_fingerprint(struct bgp_node *rn)
+{
+	struct bgp_path_info *pi;
+	uint32_t key = 0;
+
+	for (pi = bgp_node_get_bgp_path_info(rn); pi; pi = pi->next) {
+		key = jhash(&pi, sizeof(pi), key);
+		key = jhash(&pi->attr, sizeof(pi->attr), key);
+		key = jhash_3words(pi->flags
+					   & ~(BGP_PATH_DMED_CHECK
+					       | BGP_PATH_DMED_SELECTED),
+				   pi->peer->status,
+				   pi->extra ? pi->extra->igpmetric : 0, key);
+	}
+
+	return key;
+}
+
+/*
+ * Compute the new best path for rn without modifying any shared state, for
+ * use as a hint by a later bgp_best_selection() on the main pthread.
+ *
+ * MT-Safe with respect to other nodes, provided the main pthread is not
+ * modifying the RIB at the same time.
+ */
+void bgp_best_selection_hint(struct bgp *bgp, struct bgp_node *rn,
+			     struct bgp_maxpaths_cfg *mpath_cfg, afi_t afi,
+			     safi_t safi, struct bgp_select_hint *hint)
+{
+	struct bgp_path_info *new_select = NULL;
+	struct bgp_path_info *pi;
+	enum bgp_path_selection_reason reason = bgp_path_selection_none;
+	enum bgp_path_selection_reason prev;
+	int paths_eq;
+	char pfx_buf[PREFIX2STR_BUFFER];
+
+	hint->valid = false;
+
+	/* EVPN comparisons may format strings into shared buffers */
+	if (safi == SAFI_EVPN)
+		return;
+
+	hint->fingerprint = bgp_best_selection_fingerprint(rn);
+
+	if (CHECK_FLAG(bgp->flags, BGP_FLAG_DETERMINISTIC_MED))
+		bgp_best_selection_dmed(bgp, rn, mpath_cfg, &reason, 0, pfx_buf,
+					afi, safi);
+
+	for (pi = bgp_node_get_bgp_path_info(rn); pi; pi = pi->next) {
+		if (BGP_PATH_HOLDDOWN(pi))
+			continue;
+
+		if (pi->peer && pi->peer != bgp->peer_self
+		    && !CHECK_FLAG(pi->peer->sflags, PEER_STATUS_NSF_WAIT))
+			if (pi->peer->status != Established)
+				continue;
+
+		if (CHECK_FLAG(bgp->flags, BGP_FLAG_DETERMINISTIC_MED)
+		    && (!CHECK_FLAG(pi->flags, BGP_PATH_DMED_SELECTED)))
+			continue;
+
+		prev = reason;
+		if (bgp_path_info_cmp(bgp, pi, new_select, &paths_eq, mpath_cfg,
+				      0, pfx_buf, afi, safi, &reason)) {
+			if (new_select == NULL
+			    && prev != bgp_path_selection_none)
+				reason = prev;
+			new_select = pi;
+		}
+	}
+
+	hint->new_select = new_select;
+	hint->reason = reason;
+	hint->valid = true;
+}
+
 void bgp_best_selection(struct bgp *bgp, struct bgp_node *rn,
 			struct bgp_maxpaths_cfg *mpath_cfg,
 			struct bgp_path_info_pair *result, afi_t afi,
-			safi_t safi)
+			safi_t safi, const struct bgp_select_hint *hint)
 {
 	struct bgp_path_info *new_select;
 	struct bgp_path_info *old_select;
 	struct bgp_path_info *pi;
-	struct bgp_path_info *pi1;
-	struct bgp_path_info *pi2;
 	struct bgp_path_info *nextpi = NULL;
 	int paths_eq, do_mpath, debug;
 	struct list mp_list;
@@ -2124,81 +2293,27 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_node *rn,
 	if (debug)
 		prefix2str(bgp_node_get_prefix(rn), pfx_buf, sizeof(pfx_buf));
 
-	rn->reason = bgp_path_selection_none;
-	/* bgp deterministic-med */
-	new_select = NULL;
-	if (CHECK_FLAG(bgp->flags, BGP_FLAG_DETERMINISTIC_MED)) {
-
-		/* Clear BGP_PATH_DMED_SELECTED for all paths */
-		for (pi1 = bgp_node_get_bgp_path_info(rn); pi1;
-		     pi1 = pi1->next)
-			bgp_path_info_unset_flag(rn, pi1,
-						 BGP_PATH_DMED_SELECTED);
-
-		for (pi1 = bgp_node_get_bgp_path_info(rn); pi1;
-		     pi1 = pi1->next) {
-			if (CHECK_FLAG(pi1->flags, BGP_PATH_DMED_CHECK))
-				continue;
-			if (BGP_PATH_HOLDDOWN(pi1))
-				continue;
-			if (pi1->peer != bgp->peer_self)
-				if (pi1->peer->status != Established)
-					continue;
-
-			new_select = pi1;
-			if (pi1->next) {
-				for (pi2 = pi1->next; pi2; pi2 = pi2->next) {
-					if (CHECK_FLAG(pi2->flags,
-						       BGP_PATH_DMED_CHECK))
-						continue;
-					if (BGP_PATH_HOLDDOWN(pi2))
-						continue;
-					if (pi2->peer != bgp->peer_self
-					    && !CHECK_FLAG(
-						    pi2->peer->sflags,
-						    PEER_STATUS_NSF_WAIT))
-						if (pi2->peer->status
-						    != Established)
-							continue;
-
-					if (!aspath_cmp_left(pi1->attr->aspath,
-							     pi2->attr->aspath)
-					    && !aspath_cmp_left_confed(
-						       pi1->attr->aspath,
-						       pi2->attr->aspath))
-						continue;
-
-					if (bgp_path_info_cmp(
-						    bgp, pi2, new_select,
-						    &paths_eq, mpath_cfg, debug,
-						    pfx_buf, afi, safi,
-						    &rn->reason)) {
-						bgp_path_info_unset_flag(
-							rn, new_select,
-							BGP_PATH_DMED_SELECTED);
-						new_select = pi2;
-					}
-
-					bgp_path_info_set_flag(
-						rn, pi2, BGP_PATH_DMED_CHECK);
-				}
-			}
-			bgp_path_info_set_flag(rn, new_select,
-					       BGP_PATH_DMED_CHECK);
-			bgp_path_info_set_flag(rn, new_select,
-					       BGP_PATH_DMED_SELECTED);
-
-			if (debug) {
-				bgp_path_info_path_with_addpath_rx_str(
-					new_select, path_buf);
-				zlog_debug("%s: %s is the bestpath from AS %u",
-					   pfx_buf, path_buf,
-					   aspath_get_first_as(
-						   new_select->attr->aspath));
-			}
+	/*
+	 * A precomputed hint is only usable if nothing relevant to the
+	 * selection changed since it was computed.  Debugging wants the full
+	 * decision trace, so do the work again in that case.
+	 */
+	if (hint) {
+		if (!debug && hint->valid
+		    && hint->fingerprint == bgp_best_selection_fingerprint(rn))
+			bgp_select_stats.hint_used++;
+		else {
+			bgp_select_stats.hint_stale++;
+			hint = NULL;
 		}
 	}
 
+	rn->reason = bgp_path_selection_none;
+	/* bgp deterministic-med */
+	if (!hint && CHECK_FLAG(bgp->flags, BGP_FLAG_DETERMINISTIC_MED))
+		bgp_best_selection_dmed(bgp, rn, mpath_cfg, &rn->reason, debug,
+					pfx_buf, afi, safi);
+
 	/* Check old selected route and new selected route. */
 	old_select = NULL;
 	new_select = NULL;
@@ -2246,6 +2361,10 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_node *rn,
 
 		bgp_path_info_unset_flag(rn, pi, BGP_PATH_DMED_CHECK);
 
+		/* already decided on a worker pthread */
+		if (hint)
+			continue;
+
 		reason = rn->reason;
 		if (bgp_path_info_cmp(bgp, pi, new_select, &paths_eq, mpath_cfg,
 				      debug, pfx_buf, afi, safi, &rn->reason)) {
@@ -2256,6 +2375,11 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_node *rn,
 		}
 	}
 
+	if (hint) {
+		new_select = hint->new_select;
+		rn->reason = hint->reason;
+	}
+
 	/* Now that we know which path is the bestpath see if any of the other
 	 * paths
 	 * qualify as multipaths
@@ -2512,7 +2636,8 @@ static void bgp_process_evpn_route_injection(struct bgp *bgp, afi_t afi,
  *     is being removed.
  */
 static void bgp_process_main_one(struct bgp *bgp, struct bgp_node *rn,
-				 afi_t afi, safi_t safi)
+				 afi_t afi, safi_t safi,
+				 const struct bgp_select_hint *hint)
 {
 	struct bgp_path_info *new_select;
 	struct bgp_path_info *old_select;
@@ -2562,7 +2687,7 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_node *rn,
 
 	/* Best path selection. */
 	bgp_best_selection(bgp, rn, &bgp->maxpaths[afi][safi], &old_and_new,
-			   afi, safi);
+			   afi, safi, hint);
 	old_select = old_and_new.old;
 	new_select = old_and_new.new;
 
@@ -2791,7 +2916,7 @@ int bgp_best_path_select_defer(struct bgp *bgp, afi_t afi, safi_t safi)
 
 		if (CHECK_FLAG(rn->flags, BGP_NODE_SELECT_DEFER)) {
 			UNSET_FLAG(rn->flags, BGP_NODE_SELECT_DEFER);
-			bgp_process_main_one(bgp, rn, afi, safi);
+			bgp_process_main_one(bgp, rn, afi, safi, NULL);
 			cnt++;
 			if (cnt >= BGP_MAX_BEST_ROUTE_SELECT)
 				break;
@@ -2829,27 +2954,42 @@ static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 	struct bgp *bgp = pqnode->bgp;
 	struct bgp_table *table;
 	struct bgp_node *rn;
+	struct bgp_select_batch *batch;
+	const struct bgp_select_hint *hint;
+	size_t idx = 0;
 
 	/* eoiu marker */
 	if (CHECK_FLAG(pqnode->flags, BGP_PROCESS_QUEUE_EOIU_MARKER)) {
-		bgp_process_main_one(bgp, NULL, 0, 0);
+		bgp_process_main_one(bgp, NULL, 0, 0, NULL);
 		/* should always have dedicated wq call */
 		assert(STAILQ_FIRST(&pqnode->pqueue) == NULL);
 		return WQ_SUCCESS;
 	}
 
+	/* run path comparisons for the whole item on the worker pool */
+	batch = bgp_select_batch_run(bgp, STAILQ_FIRST(&pqnode->pqueue),
+				     pqnode->queued);
+
 	while (!STAILQ_EMPTY(&pqnode->pqueue)) {
 		rn = STAILQ_FIRST(&pqnode->pqueue);
 		STAILQ_REMOVE_HEAD(&pqnode->pqueue, pq);
 		STAILQ_NEXT(rn, pq) = NULL; /* complete unlink */
 		table = bgp_node_table(rn);
+
+		hint = NULL;
+		if (batch && idx < batch->count && batch->nodes[idx] == rn)
+			hint = &batch->hints[idx];
+		idx++;
+
 		/* note, new RNs may be added as part of processing */
-		bgp_process_main_one(bgp, rn, table->afi, table->safi);
+		bgp_process_main_one(bgp, rn, table->afi, table->safi, hint);
 
 		bgp_unlock_node(rn);
 		bgp_table_unlock(table);
 	}
 
+	bgp_select_batch_free(&batch);
+
 	return WQ_SUCCESS;
 }
 
@@ -9581,10 +9721,10 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 					continue;
 			}
 			if (type == bgp_show_type_regexp) {
-				regex_t *regex = output_arg;
+				struct bgp_aspath_regex *regex = output_arg;
 
-				if (bgp_regexec(regex, pi->attr->aspath)
-				    == REG_NOMATCH)
+				if (!bgp_aspath_regexec(regex,
+							pi->attr->aspath))
 					continue;
 			}
 			if (type == bgp_show_type_prefix_list) {
@@ -11008,7 +11148,7 @@ static int bgp_show_regexp(struct vty *vty, struct bgp *bgp, const char *regstr,
 			   afi_t afi, safi_t safi, enum bgp_show_type type,
 			   bool use_json)
 {
-	regex_t *regex;
+	struct bgp_aspath_regex *regex;
 	int rc;
 
 	if (!config_bgp_aspath_validate(regstr)) {
@@ -11017,14 +11157,14 @@ static int bgp_show_regexp(struct vty *vty, struct bgp *bgp, const char *regstr,
 		return CMD_WARNING_CONFIG_FAILED;
 	}
 
-	regex = bgp_regcomp(regstr);
+	regex = bgp_aspath_regcomp(regstr);
 	if (!regex) {
 		vty_out(vty, "Can't compile regexp %s\n", regstr);
 		return CMD_WARNING;
 	}
 
 	rc = bgp_show(vty, bgp, afi, safi, type, regex, use_json);
-	bgp_regex_free(regex);
+	bgp_aspath_regex_free(regex);
 	return rc;
 }
 
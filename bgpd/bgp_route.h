@@ -31,6 +31,7 @@
 
 struct bgp_nexthop_cache;
 struct bgp_route_evpn;
+struct bgp_select_hint;
 
 enum bgp_show_type {
 	bgp_show_type_normal,
@@ -658,7 +659,11 @@ extern void bgp_attr_add_gshut_community(struct attr *attr);
 extern void bgp_best_selection(struct bgp *bgp, struct bgp_node *rn,
 			       struct bgp_maxpaths_cfg *mpath_cfg,
 			       struct bgp_path_info_pair *result, afi_t afi,
-			       safi_t safi);
+			       safi_t safi, const struct bgp_select_hint *hint);
+extern void bgp_best_selection_hint(struct bgp *bgp, struct bgp_node *rn,
+				    struct bgp_maxpaths_cfg *mpath_cfg,
+				    afi_t afi, safi_t safi,
+				    struct bgp_select_hint *hint);
 extern void bgp_zebra_clear_route_change_flags(struct bgp_node *rn);
 extern bool bgp_zebra_has_route_changed(struct bgp_node *rn,
 					struct bgp_path_info *selected);
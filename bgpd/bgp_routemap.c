@@ -64,6 +64,7 @@
 #include "bgpd/bgp_flowspec_util.h"
 #include "bgpd/bgp_encap_types.h"
 #include "bgpd/bgp_mpath.h"
+#include "bgpd/bgp_rmap_cache.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
@@ -3518,6 +3519,107 @@ static const struct route_map_rule_cmd route_set_originator_id_cmd = {
 	route_set_originator_id_free,
 };
 
+/*
+ * Rules whose outcome only depends on the path attributes, the peer, the
+ * direction the route-map is applied in and the address family, and which
+ * only modify the path attributes.  Route-maps made up of these alone can
+ * have their results memoized by bgp_rmap_cache_apply().
+ */
+static const struct route_map_rule_cmd *const route_map_cacheable_cmds[] = {
+	&route_match_peer_cmd,
+	&route_match_ip_next_hop_cmd,
+	&route_match_ip_route_source_cmd,
+	&route_match_local_pref_cmd,
+	&route_match_metric_cmd,
+	&route_match_aspath_cmd,
+	&route_match_community_cmd,
+	&route_match_lcommunity_cmd,
+	&route_match_ecommunity_cmd,
+	&route_match_origin_cmd,
+	&route_match_tag_cmd,
+	&route_match_ipv6_next_hop_cmd,
+	&route_match_ipv4_next_hop_cmd,
+	&route_set_ip_nexthop_cmd,
+	&route_set_local_pref_cmd,
+	&route_set_weight_cmd,
+	&route_set_distance_cmd,
+	&route_set_metric_cmd,
+	&route_set_table_id_cmd,
+	&route_set_aspath_prepend_cmd,
+	&route_set_aspath_exclude_cmd,
+	&route_set_community_cmd,
+	&route_set_lcommunity_cmd,
+	&route_set_lcommunity_delete_cmd,
+	&route_set_community_delete_cmd,
+	&route_set_ecommunity_rt_cmd,
+	&route_set_ecommunity_soo_cmd,
+	&route_set_origin_cmd,
+	&route_set_atomic_aggregate_cmd,
+	&route_set_aggregator_as_cmd,
+	&route_set_tag_cmd,
+	&route_set_label_index_cmd,
+	&route_set_ipv6_nexthop_global_cmd,
+	&route_set_ipv6_nexthop_prefer_global_cmd,
+	&route_set_ipv6_nexthop_local_cmd,
+	&route_set_ipv6_nexthop_peer_cmd,
+	&route_set_vpnv4_nexthop_cmd,
+	&route_set_vpnv6_nexthop_cmd,
+	&route_set_originator_id_cmd,
+};
+
+static bool route_map_rule_cacheable(struct route_map_rule *rule)
+{
+	struct rmap_value *rv;
+	size_t i;
+
+	/* the peer's round trip time changes behind our back */
+	if (rule->cmd == &route_set_metric_cmd
+	    || rule->cmd == &route_set_local_pref_cmd) {
+		rv = rule->value;
+		if (rv->variable)
+			return false;
+	}
+
+	for (i = 0; i < array_size(route_map_cacheable_cmds); i++)
+		if (rule->cmd == route_map_cacheable_cmds[i])
+			return true;
+
+	return false;
+}
+
+static bool route_map_cacheable_recurse(struct route_map *map, int depth)
+{
+	struct route_map_index *index;
+	struct route_map_rule *rule;
+	struct route_map *nextrm;
+
+	if (depth > RMAP_RECURSION_LIMIT)
+		return false;
+
+	for (index = map->head; index; index = index->next) {
+		for (rule = index->match_list.head; rule; rule = rule->next)
+			if (!route_map_rule_cacheable(rule))
+				return false;
+		for (rule = index->set_list.head; rule; rule = rule->next)
+			if (!route_map_rule_cacheable(rule))
+				return false;
+
+		if (index->nextrm) {
+			nextrm = route_map_lookup_by_name(index->nextrm);
+			if (nextrm
+			    && !route_map_cacheable_recurse(nextrm, depth + 1))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool bgp_route_map_cacheable(struct route_map *map)
+{
+	return route_map_cacheable_recurse(map, 0);
+}
+
 /* Add bgp route map rule. */
 static int bgp_route_match_add(struct vty *vty, const char *command,
 			       const char *arg, route_map_event_t type)
@@ -3943,6 +4045,10 @@ static void bgp_route_map_mark_update(const char *rmap_name)
 
 static void bgp_route_map_add(const char *rmap_name)
 {
+	/* not just when the delay timer fires, new routes see the change
+	 * right away */
+	bgp_rmap_cache_flush();
+
 	if (route_map_mark_updated(rmap_name) == 0)
 		bgp_route_map_mark_update(rmap_name);
 
@@ -3951,6 +4057,8 @@ static void bgp_route_map_add(const char *rmap_name)
 
 static void bgp_route_map_delete(const char *rmap_name)
 {
+	bgp_rmap_cache_flush();
+
 	if (route_map_mark_updated(rmap_name) == 0)
 		bgp_route_map_mark_update(rmap_name);
 
@@ -3959,6 +4067,8 @@ static void bgp_route_map_delete(const char *rmap_name)
 
 static void bgp_route_map_event(const char *rmap_name)
 {
+	bgp_rmap_cache_flush();
+
 	if (route_map_mark_updated(rmap_name) == 0)
 		bgp_route_map_mark_update(rmap_name);
 
@@ -0,0 +1,268 @@
+/* BGP best path selection worker pool.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2, or (at your option) any later
+ * version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * After a full table peer flaps, the process_main_queue holds hundreds of
+ * thousands of dirty nodes, and the bulk of the time spent on them goes into
+ * bgp_path_info_cmp().  Those comparisons only read the RIB, so they can be
+ * farmed out: for each work queue item, the nodes are split into slices and
+ * compared on a pool of frr_pthreads while the main pthread waits.  The
+ * results are then consumed in queue order by bgp_process_main_one(), which
+ * still does everything with side effects (flags, multipath, labels,
+ * update-groups, zebra) serially.
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "command.h"
+#include "memory.h"
+#include "monotime.h"
+#include "thread.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_select.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_SELECT_BATCH, "BGP bestpath batch")
+
+/* below this many nodes, handing out the work costs more than it saves */
+#define BGP_SELECT_MIN_BATCH 64
+
+struct bgp_select_job {
+	struct bgp *bgp;
+	struct bgp_select_batch *batch;
+	size_t start;
+	size_t end;
+};
+
+static struct frr_pthread *select_pth[BGP_SELECT_WORKERS_MAX];
+static unsigned int select_workers;
+
+/* number of jobs handed to workers that have not completed yet */
+static pthread_mutex_t select_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t select_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int select_pending;
+
+struct bgp_select_stats bgp_select_stats;
+
+static void bgp_select_job_run(struct bgp_select_job *job)
+{
+	struct bgp_table *table;
+	struct bgp_node *rn;
+	size_t i;
+
+	for (i = job->start; i < job->end; i++) {
+		rn = job->batch->nodes[i];
+		table = bgp_node_table(rn);
+
+		bgp_best_selection_hint(
+			job->bgp, rn,
+			&job->bgp->maxpaths[table->afi][table->safi],
+			table->afi, table->safi, &job->batch->hints[i]);
+	}
+}
+
+static int bgp_select_job_thread(struct thread *thread)
+{
+	struct bgp_select_job *job = THREAD_ARG(thread);
+
+	bgp_select_job_run(job);
+
+	frr_with_mutex(&select_mtx) {
+		if (--select_pending == 0)
+			pthread_cond_signal(&select_cond);
+	}
+
+	return 0;
+}
+
+struct bgp_select_batch *bgp_select_batch_run(struct bgp *bgp,
+					      struct bgp_node *first,
+					      size_t count)
+{
+	struct bgp_select_job jobs[BGP_SELECT_WORKERS_MAX + 1];
+	struct bgp_select_batch *batch;
+	struct bgp_node *rn;
+	struct timeval start;
+	unsigned int njobs, i;
+	size_t per_job;
+
+	if (!select_workers || count < BGP_SELECT_MIN_BATCH)
+		return NULL;
+
+	monotime(&start);
+
+	batch = XCALLOC(MTYPE_BGP_SELECT_BATCH, sizeof(*batch));
+	batch->nodes =
+		XCALLOC(MTYPE_BGP_SELECT_BATCH, sizeof(*batch->nodes) * count);
+	batch->hints =
+		XCALLOC(MTYPE_BGP_SELECT_BATCH, sizeof(*batch->hints) * count);
+
+	for (rn = first; rn && batch->count < count; rn = STAILQ_NEXT(rn, pq))
+		batch->nodes[batch->count++] = rn;
+
+	/* the main pthread does the first slice itself */
+	njobs = select_workers + 1;
+	per_job = (batch->count + njobs - 1) / njobs;
+
+	for (i = 0; i < njobs; i++) {
+		jobs[i].bgp = bgp;
+		jobs[i].batch = batch;
+		jobs[i].start = MIN(i * per_job, batch->count);
+		jobs[i].end = MIN((i + 1) * per_job, batch->count);
+	}
+
+	frr_with_mutex(&select_mtx) {
+		select_pending = njobs - 1;
+	}
+
+	for (i = 1; i < njobs; i++)
+		thread_add_event(select_pth[i - 1]->master,
+				 bgp_select_job_thread, &jobs[i], 0, NULL);
+
+	bgp_select_job_run(&jobs[0]);
+
+	frr_with_mutex(&select_mtx) {
+		while (select_pending)
+			pthread_cond_wait(&select_cond, &select_mtx);
+	}
+
+	bgp_select_stats.batches++;
+	bgp_select_stats.nodes += batch->count;
+	bgp_select_stats.usec += monotime_since(&start, NULL);
+
+	return batch;
+}
+
+void bgp_select_batch_free(struct bgp_select_batch **batch)
+{
+	if (!*batch)
+		return;
+
+	XFREE(MTYPE_BGP_SELECT_BATCH, (*batch)->nodes);
+	XFREE(MTYPE_BGP_SELECT_BATCH, (*batch)->hints);
+	XFREE(MTYPE_BGP_SELECT_BATCH, *batch);
+}
+
+void bgp_select_set_workers(unsigned int workers)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	struct frr_pthread *fpt;
+	char name[64];
+	char os_name[OS_THREAD_NAMELEN];
+
+	workers = MIN(workers, BGP_SELECT_WORKERS_MAX);
+
+	/* no batch can be in flight here, we're on the main pthread */
+	while (select_workers > workers) {
+		fpt = select_pth[--select_workers];
+		select_pth[select_workers] = NULL;
+
+		frr_pthread_stop(fpt, NULL);
+		frr_pthread_destroy(fpt);
+	}
+
+	while (select_workers < workers) {
+		snprintf(name, sizeof(name), "BGP bestpath worker %u",
+			 select_workers);
+		snprintf(os_name, sizeof(os_name), "bgpd_sel%u",
+			 select_workers);
+
+		fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(fpt, NULL);
+		frr_pthread_wait_running(fpt);
+
+		select_pth[select_workers++] = fpt;
+	}
+}
+
+unsigned int bgp_select_get_workers(void)
+{
+	return select_workers;
+}
+
+void bgp_select_config_write(struct vty *vty)
+{
+	if (select_workers)
+		vty_out(vty, "bgp bestpath-workers %u\n", select_workers);
+}
+
+DEFUN (bgp_bestpath_workers,
+       bgp_bestpath_workers_cmd,
+       "bgp bestpath-workers (1-64)",
+       BGP_STR
+       "Run best path comparisons on a pool of worker pthreads\n"
+       "Number of worker pthreads, in addition to the main pthread\n")
+{
+	int idx_number = 2;
+
+	bgp_select_set_workers(strtoul(argv[idx_number]->arg, NULL, 10));
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_bgp_bestpath_workers,
+       no_bgp_bestpath_workers_cmd,
+       "no bgp bestpath-workers [(1-64)]",
+       NO_STR
+       BGP_STR
+       "Run best path comparisons on a pool of worker pthreads\n"
+       "Number of worker pthreads, in addition to the main pthread\n")
+{
+	bgp_select_set_workers(0);
+	return CMD_SUCCESS;
+}
+
+DEFUN (show_bgp_bestpath_workers,
+       show_bgp_bestpath_workers_cmd,
+       "show bgp bestpath-workers",
+       SHOW_STR
+       BGP_STR
+       "Best path worker pool statistics\n")
+{
+	struct bgp_select_stats *stats = &bgp_select_stats;
+
+	vty_out(vty, "Worker pthreads: %u\n", select_workers);
+	vty_out(vty, "Batches: %" PRIu64 ", nodes: %" PRIu64 "\n",
+		stats->batches, stats->nodes);
+	vty_out(vty, "Hints used: %" PRIu64 ", stale: %" PRIu64 "\n",
+		stats->hint_used, stats->hint_stale);
+	if (stats->nodes)
+		vty_out(vty, "Average time per node: %" PRIu64 " nsec\n",
+			stats->usec * 1000 / stats->nodes);
+
+	return CMD_SUCCESS;
+}
+
+void bgp_select_init(void)
+{
+	install_element(CONFIG_NODE, &bgp_bestpath_workers_cmd);
+	install_element(CONFIG_NODE, &no_bgp_bestpath_workers_cmd);
+	install_element(VIEW_NODE, &show_bgp_bestpath_workers_cmd);
+}
+
+void bgp_select_finish(void)
+{
+	bgp_select_set_workers(0);
+}
@@ -0,0 +1,86 @@
+/* BGP best path selection worker pool.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2, or (at your option) any later
+ * version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_BGP_SELECT_H
+#define _FRR_BGP_SELECT_H
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+
+#define BGP_SELECT_WORKERS_MAX 64
+
+/*
+ * Outcome of the path comparisons for one node, computed ahead of time on a
+ * worker pthread.  bgp_best_selection() on the main pthread uses it in place
+ * of running bgp_path_info_cmp() again, provided the node's paths still match
+ * the fingerprint.
+ */
+struct bgp_select_hint {
+	struct bgp_path_info *new_select;
+	enum bgp_path_selection_reason reason;
+	uint32_t fingerprint;
+	bool valid;
+};
+
+/* Hints for the nodes of one process queue item, in queue order. */
+struct bgp_select_batch {
+	size_t count;
+	struct bgp_node **nodes;
+	struct bgp_select_hint *hints;
+};
+
+/* Only ever updated from the main pthread. */
+struct bgp_select_stats {
+	uint64_t batches;
+	uint64_t nodes;
+	uint64_t hint_used;
+	uint64_t hint_stale;
+	/* wall clock time spent computing batches, in microseconds */
+	uint64_t usec;
+};
+
+extern struct bgp_select_stats bgp_select_stats;
+
+extern void bgp_select_init(void);
+extern void bgp_select_finish(void);
+
+/*
+ * Resize the worker pool.  0 disables parallel selection; all path
+ * comparisons then run inline in bgp_best_selection() as before.
+ */
+extern void bgp_select_set_workers(unsigned int workers);
+extern unsigned int bgp_select_get_workers(void);
+
+/*
+ * Compute hints for up to count nodes, starting at first and following the
+ * process queue linkage.  The main pthread takes a share of the work and
+ * blocks until the workers are done, so the RIB is not modified while the
+ * workers read it.
+ *
+ * Returns NULL if the pool is disabled or the batch is too small to be worth
+ * splitting up.
+ */
+extern struct bgp_select_batch *bgp_select_batch_run(struct bgp *bgp,
+						     struct bgp_node *first,
+						     size_t count);
+extern void bgp_select_batch_free(struct bgp_select_batch **batch);
+
+extern void bgp_select_config_write(struct vty *vty);
+
+#endif /* _FRR_BGP_SELECT_H */
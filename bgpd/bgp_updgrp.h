@@ -101,6 +101,8 @@ struct bpacket {
 	LIST_HEAD(pkt_peer_list, peer_af) peers;
 
 	struct stream *buffer;
+	/* buffer, once handed to peers' output queues; owns buffer then */
+	struct bgp_pktbuf *shared;
 	bpacket_attr_vec_arr arr;
 
 	unsigned int ver;
@@ -413,8 +415,8 @@ extern void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty);
 bool subgroup_packets_to_build(struct update_subgroup *subgrp);
 extern struct bpacket *subgroup_update_packet(struct update_subgroup *s);
 extern struct bpacket *subgroup_withdraw_packet(struct update_subgroup *s);
-extern struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
-						struct peer_af *paf);
+extern struct bgp_opkt *bpacket_reformat_for_peer(struct bpacket *pkt,
+						  struct peer_af *paf);
 extern void bpacket_attr_vec_arr_reset(struct bpacket_attr_vec_arr *vecarr);
 extern void bpacket_attr_vec_arr_set_vec(struct bpacket_attr_vec_arr *vecarr,
 					 bpacket_attr_vec_type type,
@@ -51,6 +51,7 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_addpath.h"
 
+DEFINE_MTYPE_SLAB(BGPD, BGP_ADJ_OUT, "BGP adj out", sizeof(struct bgp_adj_out))
 
 /********************
  * PRIVATE FUNCTIONS
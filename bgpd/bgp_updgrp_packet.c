@@ -50,6 +50,7 @@
 #include "bgpd/bgp_fsm.h"
 #include "bgpd/bgp_route.h"
 #include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_io.h"
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_nexthop.h"
@@ -76,8 +77,11 @@ struct bpacket *bpacket_alloc(void)
 
 void bpacket_free(struct bpacket *pkt)
 {
-	if (pkt->buffer)
+	if (pkt->shared)
+		bgp_pktbuf_unref(pkt->shared);
+	else if (pkt->buffer)
 		stream_free(pkt->buffer);
+	pkt->shared = NULL;
 	pkt->buffer = NULL;
 	XFREE(MTYPE_BGP_PACKET, pkt);
 }
@@ -381,8 +385,14 @@ void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty)
 	return;
 }
 
-struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
-					 struct peer_af *paf)
+/*
+ * Returns the packet as it is to be sent to this peer.  All peers share the
+ * packet's buffer; a peer whose nexthop needs rewriting gets its own copy of
+ * the part of the packet up to and including the nexthop, with the rest,
+ * usually the bulk of it, still shared.
+ */
+struct bgp_opkt *bpacket_reformat_for_peer(struct bpacket *pkt,
+					   struct peer_af *paf)
 {
 	struct stream *s = NULL;
 	bpacket_attr_vec *vec;
@@ -390,20 +400,30 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 	char buf[BUFSIZ];
 	char buf2[BUFSIZ];
 	struct bgp_filter *filter;
+	size_t head_len;
+	bool modified = false;
+
+	if (!pkt->shared)
+		pkt->shared = bgp_pktbuf_new(pkt->buffer);
 
-	s = stream_dup(pkt->buffer);
 	peer = PAF_PEER(paf);
 
 	vec = &pkt->arr.entries[BGP_ATTR_VEC_NH];
 
 	if (!CHECK_FLAG(vec->flags, BPKT_ATTRVEC_FLAGS_UPDATED))
-		return s;
+		return bgp_opkt_new(NULL, pkt->shared, 0);
 
 	uint8_t nhlen;
 	afi_t nhafi;
 	int route_map_sets_nh;
 
-	nhlen = stream_getc_from(s, vec->offset);
+	nhlen = stream_getc_from(pkt->buffer, vec->offset);
+
+	/* the EVPN case below always looks at 4 bytes of nexthop */
+	head_len = MIN(vec->offset + 1 + MAX(nhlen, IPV4_MAX_BYTELEN),
+		       stream_get_endp(pkt->buffer));
+	s = stream_new(head_len);
+	stream_put(s, STREAM_DATA(pkt->buffer), head_len);
 	filter = &peer->filter[paf->afi][paf->safi];
 
 	if (peer_cap_enhe(peer, paf->afi, paf->safi))
@@ -486,6 +506,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 
 		if (nh_modified) /* allow for VPN RD */
 			stream_put_in_addr_at(s, offset_nh, mod_v4nh);
+		modified = nh_modified;
 
 		if (bgp_debug_update(peer, NULL, NULL, 0))
 			zlog_debug("u%" PRIu64 ":s%" PRIu64
@@ -588,6 +609,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 			stream_put_in6_addr_at(s, offset_nhglobal, mod_v6nhg);
 		if (lnh_modified)
 			stream_put_in6_addr_at(s, offset_nhlocal, mod_v6nhl);
+		modified = gnh_modified || lnh_modified;
 
 		if (bgp_debug_update(peer, NULL, NULL, 0)) {
 			if (nhlen == 32 || nhlen == 48)
@@ -625,6 +647,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 
 		if (nh_modified)
 			stream_put_in_addr_at(s, vec->offset + 1, mod_v4nh);
+		modified = nh_modified;
 
 		if (bgp_debug_update(peer, NULL, NULL, 0))
 			zlog_debug("u%" PRIu64 ":s%" PRIu64
@@ -634,7 +657,12 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 				   inet_ntoa(*mod_v4nh));
 	}
 
-	return s;
+	if (!modified) {
+		stream_free(s);
+		return bgp_opkt_new(NULL, pkt->shared, 0);
+	}
+
+	return bgp_opkt_new(s, pkt->shared, head_len);
 }
 
 /*
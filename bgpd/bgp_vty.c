@@ -68,6 +68,8 @@
 #include "bgpd/bgp_addpath.h"
 #include "bgpd/bgp_mac.h"
 #include "bgpd/bgp_flowspec.h"
+#include "bgpd/bgp_select.h"
+#include "bgpd/bgp_rmap_cache.h"
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
 #endif
@@ -9079,13 +9081,9 @@ static int bgp_show_summary(struct vty *vty, struct bgp *bgp, int afi, int safi,
 				json_object_int_add(json_peer, "msgSent",
 						    PEER_TOTAL_TX(peer));
 
-				atomic_size_t outq_count, inq_count;
-				outq_count = atomic_load_explicit(
-					&peer->obuf->count,
-					memory_order_relaxed);
-				inq_count = atomic_load_explicit(
-					&peer->ibuf->count,
-					memory_order_relaxed);
+				size_t outq_count, inq_count;
+				outq_count = bgp_obuf_count(peer);
+				inq_count = bgp_ibuf_count(peer);
 
 				json_object_int_add(json_peer, "tableVersion",
 						    peer->version[afi][safi]);
@@ -9167,13 +9165,9 @@ static int bgp_show_summary(struct vty *vty, struct bgp *bgp, int afi, int safi,
 					vty_out(vty, "%*s", max_neighbor_width - len,
 						" ");
 
-				atomic_size_t outq_count, inq_count;
-				outq_count = atomic_load_explicit(
-					&peer->obuf->count,
-					memory_order_relaxed);
-				inq_count = atomic_load_explicit(
-					&peer->ibuf->count,
-					memory_order_relaxed);
+				size_t outq_count, inq_count;
+				outq_count = bgp_obuf_count(peer);
+				inq_count = bgp_ibuf_count(peer);
 
 				vty_out(vty,
 					"4 %10u %9u %9u %8" PRIu64
@@ -11766,11 +11760,9 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 		json_stat = json_object_new_object();
 		/* Packet counts. */
 
-		atomic_size_t outq_count, inq_count;
-		outq_count = atomic_load_explicit(&p->obuf->count,
-						  memory_order_relaxed);
-		inq_count = atomic_load_explicit(&p->ibuf->count,
-						 memory_order_relaxed);
+		size_t outq_count, inq_count;
+		outq_count = bgp_obuf_count(p);
+		inq_count = bgp_ibuf_count(p);
 
 		json_object_int_add(json_stat, "depthInq",
 				    (unsigned long)inq_count);
@@ -11816,11 +11808,9 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 		json_object_int_add(json_stat, "totalRecv", PEER_TOTAL_RX(p));
 		json_object_object_add(json_neigh, "messageStats", json_stat);
 	} else {
-		atomic_size_t outq_count, inq_count;
-		outq_count = atomic_load_explicit(&p->obuf->count,
-						  memory_order_relaxed);
-		inq_count = atomic_load_explicit(&p->ibuf->count,
-						 memory_order_relaxed);
+		size_t outq_count, inq_count;
+		outq_count = bgp_obuf_count(p);
+		inq_count = bgp_ibuf_count(p);
 
 		/* Packet counts. */
 		vty_out(vty, "  Message statistics:\n");
@@ -15027,6 +15017,9 @@ int bgp_config_write(struct vty *vty)
 		vty_out(vty, "bgp route-map delay-timer %u\n",
 			bm->rmap_update_timer);
 
+	bgp_select_config_write(vty);
+	bgp_rmap_cache_config_write(vty);
+
 	/* BGP configuration. */
 	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
 
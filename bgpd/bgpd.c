@@ -88,6 +88,8 @@
 #include "bgpd/bgp_addpath.h"
 #include "bgpd/bgp_evpn_private.h"
 #include "bgpd/bgp_mac.h"
+#include "bgpd/bgp_select.h"
+#include "bgpd/bgp_rmap_cache.h"
 
 DEFINE_MTYPE_STATIC(BGPD, PEER_TX_SHUTDOWN_MSG, "Peer shutdown message (TX)");
 DEFINE_MTYPE_STATIC(BGPD, BGP_EVPN_INFO, "BGP EVPN instance information");
@@ -989,6 +991,7 @@ static void peer_free(struct peer *peer)
 	BGP_EVENT_FLUSH(peer);
 
 	pthread_mutex_destroy(&peer->io_mtx);
+	pthread_mutex_destroy(&peer->obuf_mtx);
 
 	/* Free connected nexthop, if present */
 	if (CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE)
@@ -1237,9 +1240,9 @@ struct peer *peer_new(struct bgp *bgp)
 	bgp_peer_gr_init(peer);
 
 	/* Create buffers.  */
-	peer->ibuf = stream_fifo_new();
-	peer->obuf = stream_fifo_new();
+	bgp_io_bufs_new(peer);
 	pthread_mutex_init(&peer->io_mtx, NULL);
+	pthread_mutex_init(&peer->obuf_mtx, NULL);
 
 	/* We use a larger buffer for peer->obuf_work in the event that:
 	 * - We RX a BGP_UPDATE where the attributes alone are just
@@ -2252,6 +2255,8 @@ int peer_delete(struct peer *peer)
 
 	SET_FLAG(peer->flags, PEER_FLAG_DELETE);
 
+	bgp_rmap_cache_flush();
+
 	bgp_bfd_deregister_peer(peer);
 
 	/* If this peer belongs to peer group, clear up the
@@ -2308,15 +2313,7 @@ int peer_delete(struct peer *peer)
 	}
 
 	/* Buffers.  */
-	if (peer->ibuf) {
-		stream_fifo_free(peer->ibuf);
-		peer->ibuf = NULL;
-	}
-
-	if (peer->obuf) {
-		stream_fifo_free(peer->obuf);
-		peer->obuf = NULL;
-	}
+	bgp_io_bufs_free(peer);
 
 	if (peer->ibuf_work) {
 		ringbuf_del(peer->ibuf_work);
@@ -5762,6 +5759,9 @@ static void peer_distribute_update(struct access_list *access)
 	struct peer_group *group;
 	struct bgp_filter *filter;
 
+	/* route-maps may match on next-hops with access-lists */
+	bgp_rmap_cache_flush();
+
 	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
 		if (access->name)
 			update_group_policy_update(bgp, BGP_POLICY_FILTER_LIST,
@@ -6905,6 +6905,7 @@ void bgp_master_init(struct thread_master *master, const int buffer_size)
 	bm->rmap_update_timer = RMAP_DEFAULT_UPDATE_TIMER;
 	bm->terminating = false;
 	bm->socket_buffer = buffer_size;
+	bm->io_pthreads = 1;
 
 	bgp_process_queue_init();
 
@@ -6990,39 +6991,35 @@ static const struct cmd_variable_handler bgp_viewvrf_var_handlers[] = {
 	{.completions = NULL},
 };
 
-struct frr_pthread *bgp_pth_io;
 struct frr_pthread *bgp_pth_ka;
 
 static void bgp_pthreads_init(void)
 {
-	assert(!bgp_pth_io);
 	assert(!bgp_pth_ka);
 
-	struct frr_pthread_attr io = {
-		.start = frr_pthread_attr_default.start,
-		.stop = frr_pthread_attr_default.stop,
-	};
 	struct frr_pthread_attr ka = {
 		.start = bgp_keepalives_start,
 		.stop = bgp_keepalives_stop,
 	};
-	bgp_pth_io = frr_pthread_new(&io, "BGP I/O thread", "bgpd_io");
+	bgp_io_pthreads_init(bm->io_pthreads);
 	bgp_pth_ka = frr_pthread_new(&ka, "BGP Keepalives thread", "bgpd_ka");
 }
 
 void bgp_pthreads_run(void)
 {
-	frr_pthread_run(bgp_pth_io, NULL);
+	bgp_io_pthreads_run();
 	frr_pthread_run(bgp_pth_ka, NULL);
 
 	/* Wait until threads are ready. */
-	frr_pthread_wait_running(bgp_pth_io);
+	bgp_io_pthreads_wait_running();
 	frr_pthread_wait_running(bgp_pth_ka);
 }
 
 void bgp_pthreads_finish(void)
 {
+	bgp_select_finish();
 	frr_pthread_stop_all();
+	bgp_io_pthreads_finish();
 }
 
 void bgp_init(unsigned short instance)
@@ -7049,6 +7046,9 @@ void bgp_init(unsigned short instance)
 	bgp_debug_init();
 	bgp_dump_init();
 	bgp_route_init();
+	bgp_io_vty_init();
+	bgp_select_init();
+	bgp_rmap_cache_init();
 	bgp_route_map_init();
 	bgp_scan_vty_init();
 	bgp_mplsvpn_init();
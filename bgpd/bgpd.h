@@ -39,6 +39,7 @@
 #include "defaults.h"
 #include "bgp_memory.h"
 #include "bitfield.h"
+#include "spsc_ring.h"
 #include "vxlan.h"
 #include "bgp_labelpool.h"
 #include "bgp_addpath_types.h"
@@ -51,6 +52,7 @@
 
 struct update_subgroup;
 struct bpacket;
+struct bgp_opkt_fifo;
 struct bgp_pbr_config;
 
 /*
@@ -110,7 +112,6 @@ enum bgp_af_index {
 #define FOREACH_SAFI(safi)                                            \
 	for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++)
 
-extern struct frr_pthread *bgp_pth_io;
 extern struct frr_pthread *bgp_pth_ka;
 
 /* BGP master for system wide configurations and variables.  */
@@ -165,6 +166,9 @@ struct bgp_master {
 	/* How big should we set the socket buffer size */
 	uint32_t socket_buffer;
 
+	/* Number of pthreads doing peer socket I/O */
+	unsigned int io_pthreads;
+
 	bool terminating;	/* global flag that sigint terminate seen */
 	QOBJ_FIELDS
 };
@@ -932,10 +936,25 @@ struct peer {
 	/* Local router ID. */
 	struct in_addr local_id;
 
-	/* Packet receive and send buffer. */
-	pthread_mutex_t io_mtx;   // guards ibuf, obuf
-	struct stream_fifo *ibuf; // packets waiting to be processed
-	struct stream_fifo *obuf; // packets waiting to be written
+	/*
+	 * Packet receive and send buffer.
+	 *
+	 * ibuf is filled by the I/O pthread and drained by the main pthread.
+	 * obuf has several producers (main and keepalives pthreads), which
+	 * take turns by holding obuf_mtx; its consumer is whoever holds
+	 * io_mtx, normally the I/O pthread writing to the socket.
+	 */
+	pthread_mutex_t io_mtx;	  // guards ibuf_work, obuf consumer, fd writes
+	pthread_mutex_t obuf_mtx; // guards obuf producer, obuf_spill
+	struct spsc_ring *ibuf;	  // packets waiting to be processed
+	struct spsc_ring *obuf;	  // packets waiting to be written
+	struct bgp_opkt_fifo *obuf_spill; // packets that did not fit onto obuf
+	_Atomic bool ibuf_stalled; // reads paused until ibuf has room again
+
+	/* I/O pthread serving this peer while reads or writes are on; only
+	 * changed by the main pthread, with io_mtx held
+	 */
+	struct bgp_io_pthread *io_pth;
 
 	struct ringbuf *ibuf_work; // WiP buffer used by bgp_read() only
 	struct stream *obuf_work;  // WiP buffer used to construct packets
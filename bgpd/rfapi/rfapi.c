@@ -45,6 +45,7 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_vnc_types.h"
 #include "bgpd/bgp_zebra.h"
+#include "bgpd/bgp_io.h"
 
 #include "bgpd/rfapi/rfapi_import.h"
 #include "bgpd/rfapi/rfapi_private.h"
@@ -1282,18 +1283,13 @@ static int rfapi_open_inner(struct rfapi_descriptor *rfd, struct bgp *bgp,
 	 */
 	frr_with_mutex(&rfd->peer->io_mtx) {
 		// we don't need any I/O related facilities
-		if (rfd->peer->ibuf)
-			stream_fifo_free(rfd->peer->ibuf);
-		if (rfd->peer->obuf)
-			stream_fifo_free(rfd->peer->obuf);
+		bgp_io_bufs_free(rfd->peer);
 
 		if (rfd->peer->ibuf_work)
 			ringbuf_del(rfd->peer->ibuf_work);
 		if (rfd->peer->obuf_work)
 			stream_free(rfd->peer->obuf_work);
 
-		rfd->peer->ibuf = NULL;
-		rfd->peer->obuf = NULL;
 		rfd->peer->obuf_work = NULL;
 		rfd->peer->ibuf_work = NULL;
 	}
@@ -39,6 +39,7 @@
 #include "bgpd/bgp_route.h"
 #include "bgpd/bgp_debug.h"
 #include "bgpd/bgp_advertise.h"
+#include "bgpd/bgp_io.h"
 
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
 #include "bgpd/rfapi/rfapi.h"
@@ -193,18 +194,13 @@ static void vnc_redistribute_add(struct prefix *p, uint32_t metric,
 			 */
 			frr_with_mutex(&vncHD1VR.peer->io_mtx) {
 				// we don't need any I/O related facilities
-				if (vncHD1VR.peer->ibuf)
-					stream_fifo_free(vncHD1VR.peer->ibuf);
-				if (vncHD1VR.peer->obuf)
-					stream_fifo_free(vncHD1VR.peer->obuf);
+				bgp_io_bufs_free(vncHD1VR.peer);
 
 				if (vncHD1VR.peer->ibuf_work)
 					ringbuf_del(vncHD1VR.peer->ibuf_work);
 				if (vncHD1VR.peer->obuf_work)
 					stream_free(vncHD1VR.peer->obuf_work);
 
-				vncHD1VR.peer->ibuf = NULL;
-				vncHD1VR.peer->obuf = NULL;
 				vncHD1VR.peer->obuf_work = NULL;
 				vncHD1VR.peer->ibuf_work = NULL;
 			}
@@ -104,6 +104,8 @@ struct isis_circuit *isis_circuit_new(void)
 		"/frr-interface:lib/interface/frr-isisd:isis/psnp-interval/level-1");
 	circuit->psnp_interval[1] = yang_get_default_uint16(
 		"/frr-interface:lib/interface/frr-isisd:isis/psnp-interval/level-2");
+	circuit->lsp_flood_rate = yang_get_default_uint32(
+		"/frr-interface:lib/interface/frr-isisd:isis/lsp-flood-rate");
 	circuit->priority[0] = yang_get_default_uint8(
 		"/frr-interface:lib/interface/frr-isisd:isis/priority/level-1");
 	circuit->priority[1] = yang_get_default_uint8(
@@ -933,6 +935,29 @@ void isis_circuit_print_vty(struct isis_circuit *circuit, struct vty *vty,
 				vty_out(vty, "\n");
 			}
 		}
+		if (circuit->tx_queue) {
+			struct isis_tx_queue_stats stats;
+
+			isis_tx_queue_get_stats(circuit->tx_queue, &stats);
+			vty_out(vty,
+				"    LSP flooding: %lu pending (max %lu), "
+				"%lu unacknowledged\n",
+				stats.pending, stats.pending_max,
+				stats.unacked);
+			vty_out(vty,
+				"      Sent: %" PRIu64 ", batches: %" PRIu64
+				", rate limited: %" PRIu64 "\n",
+				stats.sent, stats.batches, stats.rate_limited);
+			vty_out(vty,
+				"      Latency: average %" PRIu64
+				" usec, max %" PRIu64 " usec\n",
+				stats.sent ? stats.latency_total / stats.sent
+					   : 0,
+				stats.latency_max);
+			if (circuit->lsp_flood_rate)
+				vty_out(vty, "      Rate limit: %u LSPs/s\n",
+					circuit->lsp_flood_rate);
+		}
 		if (circuit->ip_addrs && listcount(circuit->ip_addrs) > 0) {
 			vty_out(vty, "    IP Prefix(es):\n");
 			for (ALL_LIST_ELEMENTS_RO(circuit->ip_addrs, node,
@@ -68,6 +68,7 @@ struct isis_p2p_info {
 };
 
 struct bfd_info;
+struct isis_tx_batch;
 
 struct isis_circuit_arg {
 	int level;
@@ -96,6 +97,11 @@ struct isis_circuit {
 	struct stream *rcv_stream; /* Stream for receiving */
 	int (*tx)(struct isis_circuit *circuit, int level);
 	struct stream *snd_stream; /* Stream for sending */
+	/* sends several PDUs at once, NULL if the platform can't */
+	void (*tx_multi)(struct isis_circuit *circuit,
+			 struct isis_tx_batch *batch);
+	/* set while the TX queue collects PDUs for tx_multi */
+	struct isis_tx_batch *tx_batch;
 	int idx;		   /* idx in S[RM|SN] flags */
 #define CIRCUIT_T_UNKNOWN    0
 #define CIRCUIT_T_BROADCAST  1
@@ -121,6 +127,7 @@ struct isis_circuit {
 	uint16_t hello_multiplier[2]; /* hello-multiplier */
 	uint16_t csnp_interval[2];    /* csnp-interval in seconds */
 	uint16_t psnp_interval[2];    /* psnp-interval in seconds */
+	uint32_t lsp_flood_rate;      /* LSPs per second, 0 is unlimited */
 	uint8_t metric[2];
 	uint32_t te_metric[2];
 	struct isis_ext_subtlvs *ext; /* Extended parameters (TE + Adj SID */
@@ -1754,6 +1754,44 @@ void cli_show_ip_isis_psnp_interval(struct vty *vty, struct lyd_node *dnode,
 	}
 }
 
+/*
+ * XPath: /frr-interface:lib/interface/frr-isisd:isis/lsp-flood-rate
+ */
+DEFPY(isis_lsp_flood_rate, isis_lsp_flood_rate_cmd,
+      "isis lsp-flood-rate (1-100000)$rate",
+      "IS-IS routing protocol\n"
+      "Limit the rate LSPs are flooded at on this interface\n"
+      "LSPs per second\n")
+{
+	nb_cli_enqueue_change(vty, "./frr-isisd:isis/lsp-flood-rate",
+			      NB_OP_MODIFY, rate_str);
+
+	return nb_cli_apply_changes(vty, NULL);
+}
+
+DEFPY(no_isis_lsp_flood_rate, no_isis_lsp_flood_rate_cmd,
+      "no isis lsp-flood-rate [(1-100000)]",
+      NO_STR
+      "IS-IS routing protocol\n"
+      "Limit the rate LSPs are flooded at on this interface\n"
+      "LSPs per second\n")
+{
+	nb_cli_enqueue_change(vty, "./frr-isisd:isis/lsp-flood-rate",
+			      NB_OP_MODIFY, NULL);
+
+	return nb_cli_apply_changes(vty, NULL);
+}
+
+void cli_show_ip_isis_lsp_flood_rate(struct vty *vty, struct lyd_node *dnode,
+				     bool show_defaults)
+{
+	if (yang_dnode_get_uint32(dnode, NULL) == 0)
+		return;
+
+	vty_out(vty, " isis lsp-flood-rate %s\n",
+		yang_dnode_get_string(dnode, NULL));
+}
+
 /*
  * XPath: /frr-interface:lib/interface/frr-isisd:isis/multi-topology
  */
@@ -2119,6 +2157,9 @@ void isis_cli_init(void)
 	install_element(INTERFACE_NODE, &psnp_interval_cmd);
 	install_element(INTERFACE_NODE, &no_psnp_interval_cmd);
 
+	install_element(INTERFACE_NODE, &isis_lsp_flood_rate_cmd);
+	install_element(INTERFACE_NODE, &no_isis_lsp_flood_rate_cmd);
+
 	install_element(INTERFACE_NODE, &circuit_topology_cmd);
 
 	install_element(INTERFACE_NODE, &isis_circuit_type_cmd);
@@ -467,6 +467,12 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	enum isis_spf_change change = ISIS_SPF_CHANGE_TOPOLOGY;
+
+	if (!confusion)
+		change = isis_spf_lsp_change(area, level, lsp, hdr, tlvs,
+					     stream);
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -493,8 +499,19 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 			lsp_link_fragment(lsp, lsp0);
 	}
 
-	if (lsp->hdr.seqno)
+	if (!lsp->hdr.seqno)
+		return;
+
+	switch (change) {
+	case ISIS_SPF_CHANGE_NONE:
+		break;
+	case ISIS_SPF_CHANGE_PREFIX:
+		isis_spf_schedule_prc(lsp->area, lsp->level);
+		break;
+	case ISIS_SPF_CHANGE_TOPOLOGY:
 		isis_spf_schedule(lsp->area, lsp->level);
+		break;
+	}
 }
 
 /* creation of LSP directly from what we received */
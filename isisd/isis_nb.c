@@ -531,6 +531,13 @@ const struct frr_yang_module_info frr_isisd_info = {
 				.modify = lib_interface_isis_psnp_interval_level_2_modify,
 			},
 		},
+		{
+			.xpath = "/frr-interface:lib/interface/frr-isisd:isis/lsp-flood-rate",
+			.cbs = {
+				.cli_show = cli_show_ip_isis_lsp_flood_rate,
+				.modify = lib_interface_isis_lsp_flood_rate_modify,
+			},
+		},
 		{
 			.xpath = "/frr-interface:lib/interface/frr-isisd:isis/hello/padding",
 			.cbs = {
@@ -279,6 +279,9 @@ int lib_interface_isis_psnp_interval_level_1_modify(
 int lib_interface_isis_psnp_interval_level_2_modify(
 	enum nb_event event, const struct lyd_node *dnode,
 	union nb_resource *resource);
+int lib_interface_isis_lsp_flood_rate_modify(enum nb_event event,
+					     const struct lyd_node *dnode,
+					     union nb_resource *resource);
 int lib_interface_isis_hello_padding_modify(enum nb_event event,
 					    const struct lyd_node *dnode,
 					    union nb_resource *resource);
@@ -479,6 +482,8 @@ void cli_show_ip_isis_csnp_interval(struct vty *vty, struct lyd_node *dnode,
 				    bool show_defaults);
 void cli_show_ip_isis_psnp_interval(struct vty *vty, struct lyd_node *dnode,
 				    bool show_defaults);
+void cli_show_ip_isis_lsp_flood_rate(struct vty *vty, struct lyd_node *dnode,
+				     bool show_defaults);
 void cli_show_ip_isis_mt_ipv4_unicast(struct vty *vty, struct lyd_node *dnode,
 				      bool show_defaults);
 void cli_show_ip_isis_mt_ipv4_multicast(struct vty *vty, struct lyd_node *dnode,
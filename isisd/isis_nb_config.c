@@ -1784,6 +1784,24 @@ int lib_interface_isis_psnp_interval_level_2_modify(
 	return NB_OK;
 }
 
+/*
+ * XPath: /frr-interface:lib/interface/frr-isisd:isis/lsp-flood-rate
+ */
+int lib_interface_isis_lsp_flood_rate_modify(enum nb_event event,
+					     const struct lyd_node *dnode,
+					     union nb_resource *resource)
+{
+	struct isis_circuit *circuit;
+
+	if (event != NB_EV_APPLY)
+		return NB_OK;
+
+	circuit = nb_running_get_entry(dnode, NULL, true);
+	circuit->lsp_flood_rate = yang_dnode_get_uint32(dnode, NULL);
+
+	return NB_OK;
+}
+
 /*
  * XPath: /frr-interface:lib/interface/frr-isisd:isis/hello/padding
  */
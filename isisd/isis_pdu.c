@@ -2458,7 +2458,10 @@ void send_lsp(struct isis_circuit *circuit, struct isis_lsp *lsp,
 
 	clear_srm = 0;
 	pdu_counter_count(circuit->area->pdu_tx_counters, pdu_type);
-	retval = circuit->tx(circuit, lsp->level);
+	if (circuit->tx_batch)
+		retval = isis_tx_batch_add(circuit, lsp->level);
+	else
+		retval = circuit->tx(circuit, lsp->level);
 	if (retval != ISIS_OK) {
 		flog_err(EC_ISIS_PACKET,
 			 "ISIS-Upd (%s): Send L%d LSP on %s failed %s",
@@ -41,6 +41,7 @@
 #include "isisd/isis_constants.h"
 #include "isisd/isis_circuit.h"
 #include "isisd/isis_network.h"
+#include "isisd/isis_tx_queue.h"
 
 #include "privs.h"
 
@@ -176,6 +177,13 @@ static int open_packet_socket(struct isis_circuit *circuit)
 	return retval;
 }
 
+#ifdef HAVE_SENDMMSG
+static void isis_send_pdu_batch_bcast(struct isis_circuit *circuit,
+				      struct isis_tx_batch *batch);
+static void isis_send_pdu_batch_p2p(struct isis_circuit *circuit,
+				    struct isis_tx_batch *batch);
+#endif
+
 /*
  * Create the socket and set the tx/rx funcs
  */
@@ -197,9 +205,15 @@ int isis_sock_init(struct isis_circuit *circuit)
 		if (if_is_broadcast(circuit->interface)) {
 			circuit->tx = isis_send_pdu_bcast;
 			circuit->rx = isis_recv_pdu_bcast;
+#ifdef HAVE_SENDMMSG
+			circuit->tx_multi = isis_send_pdu_batch_bcast;
+#endif
 		} else if (if_is_pointopoint(circuit->interface)) {
 			circuit->tx = isis_send_pdu_p2p;
 			circuit->rx = isis_recv_pdu_p2p;
+#ifdef HAVE_SENDMMSG
+			circuit->tx_multi = isis_send_pdu_batch_p2p;
+#endif
 		} else {
 			zlog_warn("isis_sock_init(): unknown circuit type");
 			retval = ISIS_WARNING;
@@ -419,4 +433,94 @@ int isis_send_pdu_p2p(struct isis_circuit *circuit, int level)
 	return ISIS_OK;
 }
 
+#ifdef HAVE_SENDMMSG
+/*
+ * Sends all PDUs of the batch with as few sendmmsg() calls as possible,
+ * addressed like isis_send_pdu_bcast() or isis_send_pdu_p2p() would.
+ */
+static void isis_send_pdu_batch(struct isis_circuit *circuit,
+				struct isis_tx_batch *batch, bool bcast)
+{
+	static const uint8_t llc[LLC_LEN] = {0xFE, 0xFE, 0x03};
+	struct mmsghdr msgs[ISIS_TX_BATCH_MAX];
+	struct iovec iov[ISIS_TX_BATCH_MAX][2];
+	struct sockaddr_ll sa[ISIS_TX_BATCH_MAX];
+	struct isis_tx_batch_pdu *pdu;
+	unsigned int i, sent = 0;
+	int rv;
+
+	memset(msgs, 0, sizeof(msgs[0]) * batch->count);
+	memset(sa, 0, sizeof(sa[0]) * batch->count);
+
+	for (i = 0; i < batch->count; i++) {
+		pdu = &batch->pdus[i];
+		size_t len = stream_get_endp(pdu->stream);
+
+		sa[i].sll_family = AF_PACKET;
+		sa[i].sll_ifindex = circuit->interface->ifindex;
+		sa[i].sll_halen = ETH_ALEN;
+
+		if (bcast) {
+			sa[i].sll_protocol =
+				htons(isis_ethertype(len + LLC_LEN));
+			/* RFC5309 section 4.1 recommends ALL_ISS */
+			if (circuit->circ_type == CIRCUIT_T_P2P)
+				memcpy(&sa[i].sll_addr, ALL_ISS, ETH_ALEN);
+			else if (pdu->level == 1)
+				memcpy(&sa[i].sll_addr, ALL_L1_ISS, ETH_ALEN);
+			else
+				memcpy(&sa[i].sll_addr, ALL_L2_ISS, ETH_ALEN);
+
+			iov[i][0].iov_base = (void *)llc;
+			iov[i][0].iov_len = LLC_LEN;
+			iov[i][1].iov_base = pdu->stream->data;
+			iov[i][1].iov_len = len;
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		} else {
+			sa[i].sll_protocol = htons(0x00FE);
+			if (pdu->level == 1)
+				memcpy(&sa[i].sll_addr, ALL_L1_ISS, ETH_ALEN);
+			else
+				memcpy(&sa[i].sll_addr, ALL_L2_ISS, ETH_ALEN);
+
+			iov[i][0].iov_base = pdu->stream->data;
+			iov[i][0].iov_len = len;
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		msgs[i].msg_hdr.msg_name = &sa[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+		msgs[i].msg_hdr.msg_iov = iov[i];
+		pdu->retval = ISIS_OK;
+	}
+
+	/* sendmmsg() stops at the first PDU it can't send */
+	while (sent < batch->count) {
+		rv = sendmmsg(circuit->fd, &msgs[sent], batch->count - sent,
+			      0);
+		if (rv > 0) {
+			sent += rv;
+			continue;
+		}
+
+		zlog_warn("IS-IS pfpacket: could not transmit packet on %s: %s",
+			  circuit->interface->name, safe_strerror(errno));
+		batch->pdus[sent++].retval =
+			ERRNO_IO_RETRY(errno) ? ISIS_WARNING : ISIS_ERROR;
+	}
+}
+
+static void isis_send_pdu_batch_bcast(struct isis_circuit *circuit,
+				      struct isis_tx_batch *batch)
+{
+	isis_send_pdu_batch(circuit, batch, true);
+}
+
+static void isis_send_pdu_batch_p2p(struct isis_circuit *circuit,
+				    struct isis_tx_batch *batch)
+{
+	isis_send_pdu_batch(circuit, batch, false);
+}
+#endif /* HAVE_SENDMMSG */
+
 #endif /* ISIS_METHOD == ISIS_METHOD_PFPACKET */
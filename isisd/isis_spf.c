@@ -35,6 +35,7 @@
 #include "table.h"
 #include "spf_backoff.h"
 #include "srcdest_table.h"
+#include "stream.h"
 
 #include "isis_constants.h"
 #include "isis_common.h"
@@ -241,6 +242,7 @@ static void isis_spftree_adj_del(struct isis_spftree *spftree,
 	assert(!isis_vertex_queue_count(&spftree->tents));
 	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, v))
 		isis_vertex_adj_del(v, adj);
+	spftree->spt_valid = false;
 	return;
 }
 
@@ -544,7 +546,7 @@ static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 static int isis_spf_process_lsp(struct isis_spftree *spftree,
 				struct isis_lsp *lsp, uint32_t cost,
 				uint16_t depth, uint8_t *root_sysid,
-				struct isis_vertex *parent)
+				struct isis_vertex *parent, bool prefixes_only)
 {
 	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
 	struct listnode *fragnode = NULL;
@@ -586,7 +588,7 @@ lspfragloop:
 		   print_sys_hostname(lsp->hdr.lsp_id));
 #endif /* EXTREME_DEBUG */
 
-	if (no_overload) {
+	if (no_overload && !prefixes_only) {
 		if (pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST) {
 			struct isis_oldstyle_reach *r;
 			for (r = (struct isis_oldstyle_reach *)
@@ -745,66 +747,85 @@ lspfragloop:
 	return ISIS_OK;
 }
 
+static bool isis_spf_circuit_usable(struct isis_spftree *spftree,
+				    struct isis_circuit *circuit)
+{
+	struct isis_circuit_mt_setting *circuit_mt;
+
+	circuit_mt = circuit_lookup_mt_setting(circuit, spftree->mtid);
+	if (circuit_mt && !circuit_mt->enabled)
+		return false;
+	if (circuit->state != C_STATE_UP)
+		return false;
+	if (!(circuit->is_type & spftree->level))
+		return false;
+	if (spftree->family == AF_INET && !circuit->ip_router)
+		return false;
+	if (spftree->family == AF_INET6 && !circuit->ipv6_router)
+		return false;
+
+	return true;
+}
+
+/*
+ * Add IP(v6) addresses of this circuit
+ */
+static void isis_spf_preload_prefixes(struct isis_spftree *spftree,
+				      struct isis_circuit *circuit,
+				      struct isis_vertex *parent)
+{
+	struct listnode *ipnode;
+	struct prefix_ipv4 *ipv4;
+	struct prefix_ipv6 *ipv6;
+	struct prefix_pair ip_info;
+
+	if (spftree->hopcount_metric)
+		return;
+
+	if (spftree->family == AF_INET) {
+		memset(&ip_info, 0, sizeof(ip_info));
+		ip_info.dest.family = AF_INET;
+		for (ALL_LIST_ELEMENTS_RO(circuit->ip_addrs, ipnode, ipv4)) {
+			ip_info.dest.u.prefix4 = ipv4->prefix;
+			ip_info.dest.prefixlen = ipv4->prefixlen;
+			apply_mask(&ip_info.dest);
+			isis_spf_add_local(spftree, VTYPE_IPREACH_INTERNAL,
+					   &ip_info, NULL, 0, parent);
+		}
+	}
+	if (spftree->family == AF_INET6) {
+		memset(&ip_info, 0, sizeof(ip_info));
+		ip_info.dest.family = AF_INET6;
+		for (ALL_LIST_ELEMENTS_RO(circuit->ipv6_non_link, ipnode,
+					  ipv6)) {
+			ip_info.dest.u.prefix6 = ipv6->prefix;
+			ip_info.dest.prefixlen = ipv6->prefixlen;
+			apply_mask(&ip_info.dest);
+			isis_spf_add_local(spftree, VTYPE_IP6REACH_INTERNAL,
+					   &ip_info, NULL, 0, parent);
+		}
+	}
+}
+
 static int isis_spf_preload_tent(struct isis_spftree *spftree,
 				 uint8_t *root_sysid,
 				 struct isis_vertex *parent)
 {
 	struct isis_circuit *circuit;
-	struct listnode *cnode, *anode, *ipnode;
+	struct listnode *cnode, *anode;
 	struct isis_adjacency *adj;
 	struct isis_lsp *lsp;
 	struct list *adj_list;
 	struct list *adjdb;
-	struct prefix_ipv4 *ipv4;
-	struct prefix_pair ip_info;
 	int retval = ISIS_OK;
 	uint8_t lsp_id[ISIS_SYS_ID_LEN + 2];
 	static uint8_t null_lsp_id[ISIS_SYS_ID_LEN + 2];
-	struct prefix_ipv6 *ipv6;
-	struct isis_circuit_mt_setting *circuit_mt;
 
 	for (ALL_LIST_ELEMENTS_RO(spftree->area->circuit_list, cnode,
 				  circuit)) {
-		circuit_mt = circuit_lookup_mt_setting(circuit, spftree->mtid);
-		if (circuit_mt && !circuit_mt->enabled)
-			continue;
-		if (circuit->state != C_STATE_UP)
-			continue;
-		if (!(circuit->is_type & spftree->level))
-			continue;
-		if (spftree->family == AF_INET && !circuit->ip_router)
-			continue;
-		if (spftree->family == AF_INET6 && !circuit->ipv6_router)
+		if (!isis_spf_circuit_usable(spftree, circuit))
 			continue;
-		/*
-		 * Add IP(v6) addresses of this circuit
-		 */
-		if (spftree->family == AF_INET && !spftree->hopcount_metric) {
-			memset(&ip_info, 0, sizeof(ip_info));
-			ip_info.dest.family = AF_INET;
-			for (ALL_LIST_ELEMENTS_RO(circuit->ip_addrs, ipnode,
-						  ipv4)) {
-				ip_info.dest.u.prefix4 = ipv4->prefix;
-				ip_info.dest.prefixlen = ipv4->prefixlen;
-				apply_mask(&ip_info.dest);
-				isis_spf_add_local(spftree,
-						   VTYPE_IPREACH_INTERNAL,
-						   &ip_info, NULL, 0, parent);
-			}
-		}
-		if (spftree->family == AF_INET6 && !spftree->hopcount_metric) {
-			memset(&ip_info, 0, sizeof(ip_info));
-			ip_info.dest.family = AF_INET6;
-			for (ALL_LIST_ELEMENTS_RO(circuit->ipv6_non_link,
-						  ipnode, ipv6)) {
-				ip_info.dest.u.prefix6 = ipv6->prefix;
-				ip_info.dest.prefixlen = ipv6->prefixlen;
-				apply_mask(&ip_info.dest);
-				isis_spf_add_local(spftree,
-						   VTYPE_IP6REACH_INTERNAL,
-						   &ip_info, NULL, 0, parent);
-			}
-		}
+		isis_spf_preload_prefixes(spftree, circuit, parent);
 		if (circuit->circ_type == CIRCUIT_T_BROADCAST) {
 			/*
 			 * Add the adjacencies
@@ -925,7 +946,7 @@ static int isis_spf_preload_tent(struct isis_spftree *spftree,
 			isis_spf_process_lsp(spftree, lsp,
 					     spftree->hopcount_metric ?
 					     1 : circuit->te_metric[spftree->level - 1],
-					     0, root_sysid, parent);
+					     0, root_sysid, parent, false);
 		} else if (circuit->circ_type == CIRCUIT_T_P2P) {
 			adj = circuit->u.p2p.neighbor;
 			if (!adj || adj->adj_state != ISIS_ADJ_UP)
@@ -1061,7 +1082,7 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 		}
 
 		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
-				     root_sysid, vertex);
+				     root_sysid, vertex, false);
 	}
 }
 
@@ -1151,6 +1172,7 @@ static int isis_run_spf(struct isis_area *area, int level,
 
 	isis_spf_loop(spftree, sysid);
 out:
+	spftree->spt_valid = (retval == ISIS_OK);
 	spftree->runcount++;
 	spftree->last_run_timestamp = time(NULL);
 	spftree->last_run_monotime = monotime(&time_now);
@@ -1161,6 +1183,90 @@ out:
 	return retval;
 }
 
+/*
+ * Partial route calculation: the IS vertices of the previous run still are
+ * the SPT of the current topology, only the prefixes hanging off them need to
+ * be attached again.
+ */
+static int isis_run_prc(struct isis_area *area, int level,
+			enum spf_tree_id tree_id, uint8_t *sysid,
+			struct timeval *nowtv)
+{
+	struct isis_spftree *spftree = area->spftree[tree_id][level - 1];
+	struct isis_vertex *root_vertex, *vertex;
+	struct isis_circuit *circuit;
+	struct listnode *node, *nnode;
+	struct isis_lsp *lsp;
+	struct timeval time_now;
+	unsigned long long start_time, end_time;
+
+	start_time = nowtv->tv_sec;
+	start_time = (start_time * 1000000) + nowtv->tv_usec;
+
+	assert(spftree && spftree->spt_valid);
+
+	isis_vertex_queue_clear(&spftree->tents);
+	for (ALL_LIST_ELEMENTS(spftree->paths.l.list, node, nnode, vertex)) {
+		if (!VTYPE_IP(vertex->type))
+			continue;
+		hash_release(spftree->paths.hash, vertex);
+		list_delete_node(spftree->paths.l.list, node);
+		isis_vertex_del(vertex);
+	}
+
+	root_vertex = listnode_head(spftree->paths.l.list);
+	assert(root_vertex);
+
+	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit))
+		if (isis_spf_circuit_usable(spftree, circuit))
+			isis_spf_preload_prefixes(spftree, circuit,
+						  root_vertex);
+
+	/* pseudonode LSPs don't carry prefixes */
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (vertex == root_vertex || !VTYPE_IS(vertex->type)
+		    || LSP_PSEUDO_ID(vertex->N.id))
+			continue;
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (!lsp)
+			continue;
+
+		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
+				     sysid, vertex, true);
+	}
+
+	while ((vertex = isis_vertex_queue_pop(&spftree->tents)))
+		add_to_paths(spftree, vertex);
+
+	spftree->prc_runcount++;
+	spftree->last_run_timestamp = time(NULL);
+	spftree->last_run_monotime = monotime(&time_now);
+	end_time = time_now.tv_sec;
+	end_time = (end_time * 1000000) + time_now.tv_usec;
+	spftree->last_prc_duration = end_time - start_time;
+
+	return ISIS_OK;
+}
+
+static bool isis_spf_tree_active(struct isis_area *area,
+				 enum spf_tree_id tree_id)
+{
+	switch (tree_id) {
+	case SPFTREE_IPV4:
+		return area->ip_circuits;
+	case SPFTREE_IPV6:
+		return area->ipv6_circuits;
+	case SPFTREE_DSTSRC:
+		return area->ipv6_circuits
+		       && isis_area_ipv6_dstsrc_enabled(area);
+	case SPFTREE_COUNT:
+		break;
+	}
+
+	return false;
+}
+
 void isis_spf_verify_routes(struct isis_area *area, struct isis_spftree **trees)
 {
 	if (area->is_type == IS_LEVEL_1) {
@@ -1184,10 +1290,15 @@ static int isis_run_spf_cb(struct thread *thread)
 	struct isis_area *area = run->area;
 	int level = run->level;
 	int retval = ISIS_OK;
+	struct isis_spftree *spftree;
+	bool full;
 
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 	area->spf_timer[level - 1] = NULL;
 
+	full = area->spf_full_pending[level - 1] || fabricd;
+	area->spf_full_pending[level - 1] = false;
+
 	if (!(area->is_type & level)) {
 		if (isis->debugs & DEBUG_SPF_EVENTS)
 			zlog_warn("ISIS-SPF (%s) area does not share level",
@@ -1198,19 +1309,26 @@ static int isis_run_spf_cb(struct thread *thread)
 	isis_area_invalidate_routes(area, level);
 
 	if (isis->debugs & DEBUG_SPF_EVENTS)
-		zlog_debug("ISIS-Spf (%s) L%d SPF needed, periodic SPF",
-			   area->area_tag, level);
-
-	if (area->ip_circuits)
-		retval = isis_run_spf(area, level, SPFTREE_IPV4, isis->sysid,
-				      &thread->real);
-	if (area->ipv6_circuits)
-		retval = isis_run_spf(area, level, SPFTREE_IPV6, isis->sysid,
-				      &thread->real);
-	if (area->ipv6_circuits
-	    && isis_area_ipv6_dstsrc_enabled(area))
-		retval = isis_run_spf(area, level, SPFTREE_DSTSRC, isis->sysid,
-				      &thread->real);
+		zlog_debug("ISIS-Spf (%s) L%d SPF needed, %s", area->area_tag,
+			   level,
+			   full ? "periodic SPF" : "partial route calculation");
+
+	for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
+		spftree = area->spftree[tree][level - 1];
+
+		/* not kept up to date, can't be the base for a PRC later on */
+		if (!isis_spf_tree_active(area, tree)) {
+			spftree->spt_valid = false;
+			continue;
+		}
+
+		if (!full && spftree->spt_valid)
+			retval = isis_run_prc(area, level, tree, isis->sysid,
+					      &thread->real);
+		else
+			retval = isis_run_spf(area, level, tree, isis->sysid,
+					      &thread->real);
+	}
 
 	isis_area_verify_routes(area);
 
@@ -1235,7 +1353,7 @@ static struct isis_spf_run *isis_run_spf_arg(struct isis_area *area, int level)
 	return run;
 }
 
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool full,
 		       const char *func, const char *file, int line)
 {
 	struct isis_spftree *spftree = area->spftree[SPFTREE_IPV4][level - 1];
@@ -1245,11 +1363,15 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	assert(diff >= 0);
 	assert(area->is_type & level);
 
+	if (full)
+		area->spf_full_pending[level - 1] = true;
+
 	if (isis->debugs & DEBUG_SPF_EVENTS) {
 		zlog_debug(
-			"ISIS-Spf (%s) L%d SPF schedule called, lastrun %d sec ago"
+			"ISIS-Spf (%s) L%d %s schedule called, lastrun %d sec ago"
 			" Caller: %s %s:%d",
-			area->area_tag, level, diff, func, file, line);
+			area->area_tag, level, full ? "SPF" : "PRC", diff,
+			func, file, line);
 	}
 
 	if (area->spf_delay_ietf[level - 1]) {
@@ -1290,6 +1412,345 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	return ISIS_OK;
 }
 
+/*
+ * Link of an LSP as the SPF for a given tree would see it; te tells the
+ * extended (wide metric) links from the old style ones, they lead to
+ * different vertices.
+ */
+struct isis_spf_link {
+	uint8_t id[ISIS_SYS_ID_LEN + 1];
+	uint32_t metric;
+	bool te;
+};
+
+/*
+ * Collects the links isis_spf_process_lsp() would follow for spftree; for
+ * fragments, zero_tlvs and zero_bits come from fragment zero, which decides
+ * whether any of the links are used at all.
+ */
+static unsigned int isis_spf_lsp_links(struct isis_spftree *spftree,
+				       struct isis_lsp_hdr *hdr,
+				       struct isis_tlvs *tlvs,
+				       struct isis_tlvs *zero_tlvs,
+				       uint8_t zero_bits,
+				       struct isis_spf_link **links)
+{
+	bool pseudo_lsp = LSP_PSEUDO_ID(hdr->lsp_id);
+	static const uint8_t null_sysid[ISIS_SYS_ID_LEN];
+	struct isis_mt_router_info *mt_router_info = NULL;
+	struct isis_item_list *oldstyle = NULL, *te_neighs;
+	struct isis_oldstyle_reach *r;
+	struct isis_extended_reach *er;
+	unsigned int count = 0;
+
+	*links = NULL;
+
+	if (spftree->mtid != ISIS_MT_IPV4_UNICAST)
+		mt_router_info = isis_tlvs_lookup_mt_router_info(
+			zero_tlvs, spftree->mtid);
+
+	if (!pseudo_lsp
+	    && (spftree->mtid == ISIS_MT_IPV4_UNICAST
+		&& !speaks(zero_tlvs->protocols_supported.protocols,
+			   zero_tlvs->protocols_supported.count,
+			   spftree->family))
+	    && !mt_router_info)
+		return 0;
+
+	if (!pseudo_lsp
+	    && ((spftree->mtid == ISIS_MT_IPV4_UNICAST
+		 && ISIS_MASK_LSP_OL_BIT(zero_bits))
+		|| (mt_router_info && mt_router_info->overload)))
+		return 0;
+
+	if (pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST) {
+		oldstyle = &tlvs->oldstyle_reach;
+		te_neighs = &tlvs->extended_reach;
+	} else {
+		te_neighs = isis_lookup_mt_items(&tlvs->mt_reach,
+						 spftree->mtid);
+	}
+
+	count = (oldstyle ? oldstyle->count : 0)
+		+ (te_neighs ? te_neighs->count : 0);
+	if (!count)
+		return 0;
+
+	*links = XCALLOC(MTYPE_ISIS_TMP, count * sizeof(**links));
+	count = 0;
+
+	for (r = oldstyle ? (struct isis_oldstyle_reach *)oldstyle->head
+			  : NULL;
+	     r; r = r->next) {
+		if (!memcmp(r->id, isis->sysid, ISIS_SYS_ID_LEN))
+			continue;
+		if (!pseudo_lsp && !memcmp(r->id, null_sysid, ISIS_SYS_ID_LEN))
+			continue;
+		memcpy((*links)[count].id, r->id, ISIS_SYS_ID_LEN + 1);
+		(*links)[count].metric = r->metric;
+		(*links)[count].te = false;
+		count++;
+	}
+
+	for (er = te_neighs ? (struct isis_extended_reach *)te_neighs->head
+			    : NULL;
+	     er; er = er->next) {
+		if (!memcmp(er->id, isis->sysid, ISIS_SYS_ID_LEN))
+			continue;
+		if (!pseudo_lsp
+		    && !memcmp(er->id, null_sysid, ISIS_SYS_ID_LEN))
+			continue;
+		memcpy((*links)[count].id, er->id, ISIS_SYS_ID_LEN + 1);
+		(*links)[count].metric = er->metric;
+		(*links)[count].te = true;
+		count++;
+	}
+
+	return count;
+}
+
+/* Lowest metric of the links to the same neighbor as link, if any. */
+static bool isis_spf_link_metric(struct isis_spf_link *links,
+				 unsigned int count,
+				 const struct isis_spf_link *link,
+				 uint32_t *metric)
+{
+	bool found = false;
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (links[i].te != link->te
+		    || memcmp(links[i].id, link->id, ISIS_SYS_ID_LEN + 1))
+			continue;
+		if (!found || links[i].metric < *metric)
+			*metric = links[i].metric;
+		found = true;
+	}
+
+	return found;
+}
+
+static bool isis_spf_vertex_has_parent(struct isis_vertex *vertex,
+				       const uint8_t *id)
+{
+	struct listnode *node;
+	struct isis_vertex *parent;
+
+	for (ALL_LIST_ELEMENTS_RO(vertex->parents, node, parent))
+		if (VTYPE_IS(parent->type)
+		    && !memcmp(parent->N.id, id, ISIS_SYS_ID_LEN + 1))
+			return true;
+
+	return false;
+}
+
+/*
+ * Checks whether the link changes between two versions of an LSP leave the
+ * SPT of spftree alone.  That is the case when the originating system isn't
+ * reachable, and for links which aren't part of the SPT and which don't
+ * become the shortest (or an equal cost) path to their neighbor; cheaper
+ * links and links on the SPT need a full run.
+ */
+static bool isis_spf_links_keep_spt(struct isis_spftree *spftree,
+				    const uint8_t *id,
+				    struct isis_spf_link *old_links,
+				    unsigned int old_count,
+				    struct isis_spf_link *new_links,
+				    unsigned int new_count)
+{
+	static const enum vertextype is_vtypes[] = {
+		VTYPE_PSEUDO_IS, VTYPE_PSEUDO_TE_IS, VTYPE_NONPSEUDO_IS,
+		VTYPE_NONPSEUDO_TE_IS};
+	struct isis_vertex *vertex, *neigh;
+	struct isis_spf_link *link;
+	uint32_t old_metric, new_metric;
+	bool has_old, has_new;
+	uint64_t dist = UINT64_MAX;
+	enum vertextype vtype;
+
+	for (unsigned int i = 0; i < array_size(is_vtypes); i++) {
+		vertex = isis_find_vertex(&spftree->paths, id, is_vtypes[i]);
+		if (vertex && vertex->d_N < dist)
+			dist = vertex->d_N;
+	}
+	if (dist == UINT64_MAX)
+		return true;
+
+	for (unsigned int i = 0; i < old_count + new_count; i++) {
+		link = i < old_count ? &old_links[i]
+				     : &new_links[i - old_count];
+
+		has_old = isis_spf_link_metric(old_links, old_count, link,
+					       &old_metric);
+		has_new = isis_spf_link_metric(new_links, new_count, link,
+					       &new_metric);
+		if (has_old == has_new
+		    && (!has_old || old_metric == new_metric))
+			continue;
+
+		if (link->te)
+			vtype = LSP_PSEUDO_ID(link->id) ? VTYPE_PSEUDO_TE_IS
+							: VTYPE_NONPSEUDO_TE_IS;
+		else
+			vtype = LSP_PSEUDO_ID(link->id) ? VTYPE_PSEUDO_IS
+							: VTYPE_NONPSEUDO_IS;
+
+		neigh = isis_find_vertex(&spftree->paths, link->id, vtype);
+		if (!neigh) {
+			if (has_new)
+				return false;
+			continue;
+		}
+
+		if (has_old && isis_spf_vertex_has_parent(neigh, id))
+			return false;
+		if (has_new && dist + new_metric <= neigh->d_N)
+			return false;
+	}
+
+	return true;
+}
+
+/* Whether lsp_id is the pseudonode of one of our own LANs. */
+static bool isis_spf_own_lan(struct isis_area *area, int level,
+			     const uint8_t *lsp_id)
+{
+	struct listnode *node;
+	struct isis_circuit *circuit;
+	const uint8_t *dis;
+
+	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit)) {
+		if (circuit->circ_type != CIRCUIT_T_BROADCAST)
+			continue;
+		dis = level == ISIS_LEVEL1 ? circuit->u.bc.l1_desig_is
+					   : circuit->u.bc.l2_desig_is;
+		if (!memcmp(dis, lsp_id, ISIS_SYS_ID_LEN + 1))
+			return true;
+	}
+
+	return false;
+}
+
+static bool isis_spf_mt_router_info_same(struct isis_item_list *a,
+					 struct isis_item_list *b)
+{
+	struct isis_mt_router_info *ia, *ib;
+
+	if (a->count != b->count)
+		return false;
+
+	for (ia = (struct isis_mt_router_info *)a->head,
+	    ib = (struct isis_mt_router_info *)b->head;
+	     ia && ib; ia = ia->next, ib = ib->next) {
+		if (ia->mtid != ib->mtid || ia->overload != ib->overload
+		    || ia->attached != ib->attached)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Classifies an update of a received LSP, before lsp is overwritten with the
+ * new header, TLVs and PDU.
+ *
+ * Besides prefix-only changes, this implements the cheap part of incremental
+ * SPF: link changes which can't alter the SPT of any tree the next run uses
+ * only need the routes recalculated.
+ */
+enum isis_spf_change isis_spf_lsp_change(struct isis_area *area, int level,
+					 struct isis_lsp *lsp,
+					 struct isis_lsp_hdr *hdr,
+					 struct isis_tlvs *tlvs,
+					 struct stream *stream)
+{
+	const size_t hdr_len = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN;
+	struct isis_spf_link *old_links, *new_links;
+	unsigned int old_count, new_count;
+	struct isis_spftree *spftree;
+	struct isis_lsp *lsp0 = lsp;
+	bool links_changed = false;
+	bool keep_spt = true;
+
+	if (fabricd || lsp->own_lsp || area->spf_full_pending[level - 1])
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+	if (!lsp->tlvs || !tlvs || !lsp->pdu || !lsp->hdr.seqno)
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+	if (!lsp->hdr.rem_lifetime || !hdr->rem_lifetime)
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+	if (LSP_FRAGMENT(lsp->hdr.lsp_id)) {
+		lsp0 = lsp->lspu.zero_lsp;
+		if (!lsp0 || !lsp0->tlvs)
+			return ISIS_SPF_CHANGE_TOPOLOGY;
+	}
+
+	if (stream_get_endp(lsp->pdu) == stream_get_endp(stream)
+	    && stream_get_endp(stream) >= hdr_len
+	    && !memcmp(STREAM_DATA(lsp->pdu) + hdr_len,
+		       STREAM_DATA(stream) + hdr_len,
+		       stream_get_endp(stream) - hdr_len)
+	    && lsp->hdr.lsp_bits == hdr->lsp_bits) {
+		area->spf_skipped_count[level - 1]++;
+		return ISIS_SPF_CHANGE_NONE;
+	}
+
+	if (lsp->hdr.lsp_bits != hdr->lsp_bits)
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+	if (lsp->tlvs->protocols_supported.count
+		    != tlvs->protocols_supported.count
+	    || (tlvs->protocols_supported.count
+		&& memcmp(lsp->tlvs->protocols_supported.protocols,
+			  tlvs->protocols_supported.protocols,
+			  tlvs->protocols_supported.count)))
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+	if (!isis_spf_mt_router_info_same(&lsp->tlvs->mt_router_info,
+					  &tlvs->mt_router_info))
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+
+	for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT && keep_spt;
+	     tree++) {
+		if (!isis_spf_tree_active(area, tree))
+			continue;
+
+		spftree = area->spftree[tree][level - 1];
+		if (!spftree->spt_valid)
+			return ISIS_SPF_CHANGE_TOPOLOGY;
+
+		/* fragment zero looks the same before and after, see above */
+		old_count = isis_spf_lsp_links(
+			spftree, &lsp->hdr, lsp->tlvs,
+			lsp0 == lsp ? lsp->tlvs : lsp0->tlvs,
+			lsp0->hdr.lsp_bits, &old_links);
+		new_count = isis_spf_lsp_links(
+			spftree, hdr, tlvs, lsp0 == lsp ? tlvs : lsp0->tlvs,
+			lsp0 == lsp ? hdr->lsp_bits : lsp0->hdr.lsp_bits,
+			&new_links);
+
+		if (old_count != new_count
+		    || memcmp(old_links, new_links,
+			      new_count * sizeof(*new_links))) {
+			links_changed = true;
+			if (LSP_PSEUDO_ID(hdr->lsp_id)
+			    && isis_spf_own_lan(area, level, hdr->lsp_id))
+				keep_spt = false;
+			else
+				keep_spt = isis_spf_links_keep_spt(
+					spftree, hdr->lsp_id, old_links,
+					old_count, new_links, new_count);
+		}
+
+		XFREE(MTYPE_ISIS_TMP, old_links);
+		XFREE(MTYPE_ISIS_TMP, new_links);
+	}
+
+	if (!keep_spt)
+		return ISIS_SPF_CHANGE_TOPOLOGY;
+
+	if (links_changed)
+		area->spf_ispf_count[level - 1]++;
+
+	return ISIS_SPF_CHANGE_PREFIX;
+}
+
 static void isis_print_paths(struct vty *vty, struct isis_vertex_queue *queue,
 			     uint8_t *root_sysid)
 {
@@ -1473,4 +1934,9 @@ void isis_spf_print(struct isis_spftree *spftree, struct vty *vty)
 		(uint32_t)spftree->last_run_duration);
 
 	vty_out(vty, "      run count         : %u\n", spftree->runcount);
+
+	vty_out(vty, "      last PRC duration : %u usec\n",
+		(uint32_t)spftree->last_prc_duration);
+
+	vty_out(vty, "      PRC run count     : %u\n", spftree->prc_runcount);
 }
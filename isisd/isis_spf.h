@@ -25,6 +25,20 @@
 #define _ZEBRA_ISIS_SPF_H
 
 struct isis_spftree;
+struct isis_lsp;
+struct isis_lsp_hdr;
+struct isis_tlvs;
+struct stream;
+
+/* What an LSP update means for the routes calculated from it */
+enum isis_spf_change {
+	/* nothing SPF looks at changed */
+	ISIS_SPF_CHANGE_NONE,
+	/* only prefixes changed, a partial route calculation will do */
+	ISIS_SPF_CHANGE_PREFIX,
+	/* the shortest path tree may have changed */
+	ISIS_SPF_CHANGE_TOPOLOGY,
+};
 
 struct isis_spftree *isis_spftree_new(struct isis_area *area);
 void isis_spf_invalidate_routes(struct isis_spftree *tree);
@@ -35,10 +49,18 @@ void spftree_area_init(struct isis_area *area);
 void spftree_area_del(struct isis_area *area);
 void spftree_area_adj_del(struct isis_area *area, struct isis_adjacency *adj);
 #define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+	_isis_spf_schedule((area), (level), true, __func__, \
+			   __FILE__, __LINE__)
+#define isis_spf_schedule_prc(area, level) \
+	_isis_spf_schedule((area), (level), false, __func__, \
 			   __FILE__, __LINE__)
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool full,
 		       const char *func, const char *file, int line);
+enum isis_spf_change isis_spf_lsp_change(struct isis_area *area, int level,
+					 struct isis_lsp *lsp,
+					 struct isis_lsp_hdr *hdr,
+					 struct isis_tlvs *tlvs,
+					 struct stream *stream);
 void isis_spf_cmds_init(void);
 void isis_spf_print(struct isis_spftree *spftree, struct vty *vty);
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
@@ -302,6 +302,9 @@ struct isis_spftree {
 	time_t last_run_timestamp; /* last run timestamp as wall time for display */
 	time_t last_run_monotime;  /* last run as monotime for scheduling */
 	time_t last_run_duration;  /* last run duration in msec */
+	unsigned int prc_runcount; /* number of partial route calculations */
+	time_t last_prc_duration;  /* last partial run duration in usec */
+	bool spt_valid;		   /* paths hold the SPT of the current LSDB */
 
 	uint16_t mtid;
 	int family;
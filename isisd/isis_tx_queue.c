@@ -23,6 +23,9 @@
 
 #include "hash.h"
 #include "jhash.h"
+#include "monotime.h"
+#include "stream.h"
+#include "typesafe.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_memory.h"
@@ -31,15 +34,40 @@
 #include "isisd/isis_lsp.h"
 #include "isisd/isis_misc.h"
 #include "isisd/isis_tx_queue.h"
+#include "isisd/isis_errors.h"
 
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE, "ISIS TX Queue")
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE_ENTRY, "ISIS TX Queue Entry")
+DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE_BATCH, "ISIS TX Queue Batch")
+
+/* LSPs sent per flush when there's no rate limit, to let other events in */
+#define TX_QUEUE_FLUSH_MAX (4 * ISIS_TX_BATCH_MAX)
+/* delay before flushing again after the socket refused PDUs */
+#define TX_QUEUE_BACKOFF_MSEC 10
+/* seconds until an LSP is sent again */
+#define TX_QUEUE_RETRY_INTERVAL 5
+/* rate limit credit for one LSP */
+#define TX_QUEUE_CREDIT 1000000ULL
+
+PREDECL_DLIST(tx_queue_pending)
 
 struct isis_tx_queue {
 	struct isis_circuit *circuit;
 	void (*send_event)(struct isis_circuit *circuit,
 			   struct isis_lsp *, enum isis_tx_type);
 	struct hash *hash;
+
+	/* entries due for transmission, oldest first */
+	struct tx_queue_pending_head pending;
+	struct thread *t_flush;
+	/* allocated on first use, for circuits with tx_multi */
+	struct isis_tx_batch *batch;
+
+	/* token bucket for circuit->lsp_flood_rate */
+	uint64_t credit;
+	struct timeval credit_time;
+
+	struct isis_tx_queue_stats stats;
 };
 
 struct isis_tx_queue_entry {
@@ -48,8 +76,14 @@ struct isis_tx_queue_entry {
 	bool is_retry;
 	struct thread *retry;
 	struct isis_tx_queue *queue;
+
+	bool pending;
+	struct timeval queued;
+	struct tx_queue_pending_item pitem;
 };
 
+DECLARE_DLIST(tx_queue_pending, struct isis_tx_queue_entry, pitem)
+
 static unsigned tx_queue_hash_key(const void *p)
 {
 	const struct isis_tx_queue_entry *e = p;
@@ -86,6 +120,7 @@ struct isis_tx_queue *isis_tx_queue_new(
 	rv->send_event = send_event;
 
 	rv->hash = hash_create(tx_queue_hash_key, tx_queue_hash_cmp, NULL);
+	tx_queue_pending_init(&rv->pending);
 	return rv;
 }
 
@@ -95,6 +130,8 @@ static void tx_queue_element_free(void *element)
 
 	if (e->retry)
 		thread_cancel(e->retry);
+	if (e->pending)
+		tx_queue_pending_del(&e->queue->pending, e);
 
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
 }
@@ -103,6 +140,16 @@ void isis_tx_queue_free(struct isis_tx_queue *queue)
 {
 	hash_clean(queue->hash, tx_queue_element_free);
 	hash_free(queue->hash);
+	tx_queue_pending_fini(&queue->pending);
+	THREAD_OFF(queue->t_flush);
+
+	if (queue->batch) {
+		for (unsigned int i = 0; i < ISIS_TX_BATCH_MAX; i++)
+			if (queue->batch->pdus[i].stream)
+				stream_free(queue->batch->pdus[i].stream);
+		XFREE(MTYPE_TX_QUEUE_BATCH, queue->batch);
+	}
+
 	XFREE(MTYPE_TX_QUEUE, queue);
 }
 
@@ -116,25 +163,261 @@ static struct isis_tx_queue_entry *tx_queue_find(struct isis_tx_queue *queue,
 	return hash_lookup(queue->hash, &e);
 }
 
-static int tx_queue_send_event(struct thread *thread)
+static struct isis_tx_queue_entry *tx_queue_get(struct isis_tx_queue *queue,
+						struct isis_lsp *lsp)
+{
+	struct isis_tx_queue_entry *e = tx_queue_find(queue, lsp);
+
+	if (!e) {
+		e = XCALLOC(MTYPE_TX_QUEUE_ENTRY, sizeof(*e));
+		e->lsp = lsp;
+		e->queue = queue;
+
+		struct isis_tx_queue_entry *inserted;
+		inserted = hash_get(queue->hash, e, hash_alloc_intern);
+		assert(inserted == e);
+	}
+
+	return e;
+}
+
+static int tx_queue_flush(struct thread *thread);
+
+static void tx_queue_schedule(struct isis_tx_queue *queue, long delay)
+{
+	if (queue->t_flush)
+		return;
+
+	if (delay)
+		thread_add_timer_msec(master, tx_queue_flush, queue, delay,
+				      &queue->t_flush);
+	else
+		thread_add_event(master, tx_queue_flush, queue, 0,
+				 &queue->t_flush);
+}
+
+static void tx_queue_make_pending(struct isis_tx_queue_entry *e)
 {
-	struct isis_tx_queue_entry *e = THREAD_ARG(thread);
 	struct isis_tx_queue *queue = e->queue;
+	unsigned long pending;
+
+	if (e->pending)
+		return;
+
+	e->pending = true;
+	monotime(&e->queued);
+	tx_queue_pending_add_tail(&queue->pending, e);
+
+	pending = tx_queue_pending_count(&queue->pending);
+	if (pending > queue->stats.pending_max)
+		queue->stats.pending_max = pending;
+
+	tx_queue_schedule(queue, 0);
+}
+
+static int tx_queue_retry_event(struct thread *thread)
+{
+	struct isis_tx_queue_entry *e = THREAD_ARG(thread);
 
 	e->retry = NULL;
-	thread_add_timer(master, tx_queue_send_event, e, 5, &e->retry);
+	tx_queue_make_pending(e);
+
+	return 0;
+}
+
+/*
+ * Number of LSPs the circuit's flood rate allows to send right now; if that
+ * is none, *delay is set to the msec until the next one.  The bucket holds
+ * up to a tenth of a second worth of LSPs, at least one.
+ */
+static unsigned int tx_queue_budget(struct isis_tx_queue *queue, long *delay)
+{
+	uint32_t rate = queue->circuit->lsp_flood_rate;
+	uint64_t burst, elapsed;
+
+	*delay = 0;
+	if (!rate)
+		return TX_QUEUE_FLUSH_MAX;
+
+	burst = MAX(rate / 10, 1) * TX_QUEUE_CREDIT;
+	elapsed = monotime_since(&queue->credit_time, NULL);
+	monotime(&queue->credit_time);
+
+	/* more than a second refills any bucket */
+	if (elapsed > 1000000)
+		queue->credit = burst;
+	else
+		queue->credit = MIN(queue->credit + elapsed * rate, burst);
+
+	if (queue->credit < TX_QUEUE_CREDIT) {
+		*delay = (TX_QUEUE_CREDIT - queue->credit) / rate / 1000 + 1;
+		return 0;
+	}
+
+	return MIN(queue->credit / TX_QUEUE_CREDIT, TX_QUEUE_FLUSH_MAX);
+}
+
+static void tx_queue_send(struct isis_tx_queue *queue,
+			  struct isis_tx_queue_entry *e)
+{
+	struct isis_tx_batch *batch = queue->circuit->tx_batch;
+	struct isis_lsp *lsp = e->lsp;
+	enum isis_tx_type type = e->type;
+	unsigned int count = batch ? batch->count : 0;
+	uint64_t latency;
+
+	latency = monotime_since(&e->queued, NULL);
+	queue->stats.latency_total += latency;
+	if (latency > queue->stats.latency_max)
+		queue->stats.latency_max = latency;
+	queue->stats.sent++;
+
+	THREAD_OFF(e->retry);
+	thread_add_timer(master, tx_queue_retry_event, e,
+			 TX_QUEUE_RETRY_INTERVAL, &e->retry);
 
 	if (e->is_retry)
 		queue->circuit->area->lsp_rxmt_count++;
 	else
 		e->is_retry = true;
 
-	queue->send_event(queue->circuit, e->lsp, e->type);
+	queue->send_event(queue->circuit, lsp, type);
 	/* Don't access e here anymore, send_event might have destroyed it */
 
+	if (batch && batch->count > count) {
+		batch->pdus[count].lsp = lsp;
+		batch->pdus[count].type = type;
+	}
+}
+
+/*
+ * Sends the collected PDUs.  On broadcast circuits send_event dropped the
+ * LSPs from the queue already, thinking they had been sent; the ones the
+ * socket didn't take are queued again for a retransmission, as if tx had
+ * failed right away.
+ *
+ * @return whether any PDU failed temporarily
+ */
+static bool tx_queue_batch_send(struct isis_tx_queue *queue)
+{
+	struct isis_circuit *circuit = queue->circuit;
+	struct isis_tx_batch *batch = queue->batch;
+	struct isis_tx_batch_pdu *pdu;
+	struct isis_tx_queue_entry *e;
+	bool again = false;
+
+	if (!batch->count)
+		return false;
+
+	circuit->tx_multi(circuit, batch);
+	if (batch->count > 1)
+		queue->stats.batches++;
+
+	for (unsigned int i = 0; i < batch->count; i++) {
+		pdu = &batch->pdus[i];
+		if (pdu->retval == ISIS_OK || !pdu->lsp)
+			continue;
+
+		flog_err(EC_ISIS_PACKET,
+			 "ISIS-Upd (%s): Send L%d LSP on %s failed %s",
+			 circuit->area->area_tag, pdu->level,
+			 circuit->interface->name,
+			 (pdu->retval == ISIS_WARNING) ? "temporarily"
+						       : "permanently");
+
+		if (pdu->retval != ISIS_WARNING) {
+			isis_tx_queue_del(queue, pdu->lsp);
+			continue;
+		}
+
+		again = true;
+		e = tx_queue_get(queue, pdu->lsp);
+		e->type = pdu->type;
+		e->is_retry = true;
+		if (!e->retry && !e->pending)
+			thread_add_timer(master, tx_queue_retry_event, e,
+					 TX_QUEUE_RETRY_INTERVAL, &e->retry);
+	}
+
+	batch->count = 0;
+	return again;
+}
+
+static int tx_queue_flush(struct thread *thread)
+{
+	struct isis_tx_queue *queue = THREAD_ARG(thread);
+	struct isis_circuit *circuit = queue->circuit;
+	struct isis_tx_queue_entry *e;
+	unsigned int budget, sent = 0;
+	bool again = false;
+	long delay;
+
+	queue->t_flush = NULL;
+
+	budget = tx_queue_budget(queue, &delay);
+	if (!budget) {
+		queue->stats.rate_limited++;
+		tx_queue_schedule(queue, delay);
+		return 0;
+	}
+
+	if (circuit->tx_multi) {
+		if (!queue->batch)
+			queue->batch = XCALLOC(MTYPE_TX_QUEUE_BATCH,
+					       sizeof(*queue->batch));
+		circuit->tx_batch = queue->batch;
+	}
+
+	while (sent < budget
+	       && (e = tx_queue_pending_pop(&queue->pending))) {
+		e->pending = false;
+
+		if (circuit->tx_batch
+		    && circuit->tx_batch->count == ISIS_TX_BATCH_MAX)
+			again |= tx_queue_batch_send(queue);
+
+		tx_queue_send(queue, e);
+		sent++;
+	}
+
+	if (circuit->tx_batch) {
+		again |= tx_queue_batch_send(queue);
+		circuit->tx_batch = NULL;
+	}
+
+	if (circuit->lsp_flood_rate)
+		queue->credit -= MIN(queue->credit, sent * TX_QUEUE_CREDIT);
+
+	if (tx_queue_pending_count(&queue->pending))
+		tx_queue_schedule(queue, again ? TX_QUEUE_BACKOFF_MSEC : 0);
+
 	return 0;
 }
 
+int isis_tx_batch_add(struct isis_circuit *circuit, int level)
+{
+	struct isis_tx_batch *batch = circuit->tx_batch;
+	struct isis_tx_batch_pdu *pdu;
+	size_t size = stream_get_size(circuit->snd_stream);
+
+	assert(batch->count < ISIS_TX_BATCH_MAX);
+	pdu = &batch->pdus[batch->count++];
+
+	if (pdu->stream && stream_get_size(pdu->stream) < size) {
+		stream_free(pdu->stream);
+		pdu->stream = NULL;
+	}
+	if (!pdu->stream)
+		pdu->stream = stream_new(size);
+
+	stream_copy(pdu->stream, circuit->snd_stream);
+	pdu->level = level;
+	pdu->retval = ISIS_OK;
+	pdu->lsp = NULL;
+
+	return ISIS_OK;
+}
+
 void _isis_tx_queue_add(struct isis_tx_queue *queue,
 			struct isis_lsp *lsp,
 			enum isis_tx_type type,
@@ -153,22 +436,12 @@ void _isis_tx_queue_add(struct isis_tx_queue *queue,
 			   func, file, line);
 	}
 
-	struct isis_tx_queue_entry *e = tx_queue_find(queue, lsp);
-	if (!e) {
-		e = XCALLOC(MTYPE_TX_QUEUE_ENTRY, sizeof(*e));
-		e->lsp = lsp;
-		e->queue = queue;
-
-		struct isis_tx_queue_entry *inserted;
-		inserted = hash_get(queue->hash, e, hash_alloc_intern);
-		assert(inserted == e);
-	}
+	struct isis_tx_queue_entry *e = tx_queue_get(queue, lsp);
 
 	e->type = type;
 
-	if (e->retry)
-		thread_cancel(e->retry);
-	thread_add_event(master, tx_queue_send_event, e, 0, &e->retry);
+	THREAD_OFF(e->retry);
+	tx_queue_make_pending(e);
 
 	e->is_retry = false;
 }
@@ -192,6 +465,8 @@ void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
 
 	if (e->retry)
 		thread_cancel(e->retry);
+	if (e->pending)
+		tx_queue_pending_del(&queue->pending, e);
 
 	hash_release(queue->hash, e);
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
@@ -209,3 +484,11 @@ void isis_tx_queue_clean(struct isis_tx_queue *queue)
 {
 	hash_clean(queue->hash, tx_queue_element_free);
 }
+
+void isis_tx_queue_get_stats(struct isis_tx_queue *queue,
+			     struct isis_tx_queue_stats *stats)
+{
+	*stats = queue->stats;
+	stats->pending = tx_queue_pending_count(&queue->pending);
+	stats->unacked = hashcount(queue->hash) - stats->pending;
+}
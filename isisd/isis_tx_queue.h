@@ -29,6 +29,40 @@ enum isis_tx_type {
 
 struct isis_tx_queue;
 
+/* PDUs sent with a single circuit->tx_multi() call */
+#define ISIS_TX_BATCH_MAX 32
+
+struct isis_tx_batch {
+	unsigned int count;
+	struct isis_tx_batch_pdu {
+		struct stream *stream;
+		int level;
+		/* set by tx_multi, ISIS_OK/ISIS_WARNING/ISIS_ERROR like tx */
+		int retval;
+
+		struct isis_lsp *lsp;
+		enum isis_tx_type type;
+	} pdus[ISIS_TX_BATCH_MAX];
+};
+
+struct isis_tx_queue_stats {
+	/* LSPs waiting to be sent, now and at most */
+	unsigned long pending;
+	unsigned long pending_max;
+	/* LSPs waiting for an acknowledgement or a retransmission */
+	unsigned long unacked;
+
+	uint64_t sent;
+	/* tx_multi() calls sending more than one PDU */
+	uint64_t batches;
+	/* flushes deferred by the circuit's LSP flood rate */
+	uint64_t rate_limited;
+
+	/* time between an LSP becoming due and it being sent, in usec */
+	uint64_t latency_total;
+	uint64_t latency_max;
+};
+
 struct isis_tx_queue *isis_tx_queue_new(
 		struct isis_circuit *circuit,
 		void(*send_event)(struct isis_circuit *circuit,
@@ -54,4 +88,14 @@ unsigned long isis_tx_queue_len(struct isis_tx_queue *queue);
 
 void isis_tx_queue_clean(struct isis_tx_queue *queue);
 
+void isis_tx_queue_get_stats(struct isis_tx_queue *queue,
+			     struct isis_tx_queue_stats *stats);
+
+/*
+ * Used by the send_event callback in place of circuit->tx() while the queue
+ * collects a batch, i.e. while circuit->tx_batch is set.  The PDU in
+ * circuit->snd_stream is sent later, failures are dealt with by the queue.
+ */
+int isis_tx_batch_add(struct isis_circuit *circuit, int level);
+
 #endif
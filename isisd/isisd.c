@@ -1212,9 +1212,19 @@ DEFUN (show_isis_spf_ietf,
 				vty_out(vty, "Pending, due in %lld msec\n",
 					(long long)remain.tv_sec * 1000
 						+ remain.tv_usec / 1000);
+				vty_out(vty, "    Pending calculation: %s\n",
+					area->spf_full_pending[level - 1]
+						? "full SPF"
+						: "partial route calculation");
 			} else {
 				vty_out(vty, "Not scheduled\n");
 			}
+			vty_out(vty,
+				"    LSP updates without route calculation: %u\n",
+				area->spf_skipped_count[level - 1]);
+			vty_out(vty,
+				"    LSP updates with link changes off the SPT: %u\n",
+				area->spf_ispf_count[level - 1]);
 
 			if (area->spf_delay_ietf[level - 1]) {
 				vty_out(vty,
@@ -178,6 +178,12 @@ struct isis_area {
 							    SPF algo
 							    parameters*/
 	struct thread *spf_timer[ISIS_LEVELS];
+	/* the scheduled run has to recompute the SPT, not just the routes */
+	bool spf_full_pending[ISIS_LEVELS];
+	/* LSP updates that didn't need any route calculation */
+	uint32_t spf_skipped_count[ISIS_LEVELS];
+	/* LSP updates with link changes that didn't affect the SPT */
+	uint32_t spf_ispf_count[ISIS_LEVELS];
 
 	struct lsp_refresh_arg lsp_refresh_arg[ISIS_LEVELS];
 
@@ -164,6 +164,12 @@ static struct log_ref ferr_lib_warn[] = {
 		.description = "The northbound subsystem failed to record a configuration transaction in the northbound database",
 		.suggestion = "Gather log data and open an Issue",
 	},
+	{
+		.code = EC_LIB_NB_CONFIG_DIFF_MISMATCH,
+		.title = "Configuration delta mismatch",
+		.description = "The configuration changes calculated from the candidate's edit journal don't match the ones calculated by diffing the whole configuration. The latter are used instead",
+		.suggestion = "Gather log data, including the differences logged right before this message, and open an Issue",
+	},
 	{
 		.code = END_FERR,
 	},
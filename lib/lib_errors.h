@@ -73,6 +73,7 @@ enum lib_log_refs {
 	EC_LIB_NB_OPERATIONAL_DATA,
 	EC_LIB_NB_TRANSACTION_CREATION_FAILED,
 	EC_LIB_NB_TRANSACTION_RECORD_FAILED,
+	EC_LIB_NB_CONFIG_DIFF_MISMATCH,
 	EC_LIB_LIBYANG,
 	EC_LIB_LIBYANG_PLUGIN_LOAD,
 	EC_LIB_CONFD_INIT,
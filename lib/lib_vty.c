@@ -121,6 +121,24 @@ static int qmem_walker(void *arg, struct memgroup *mg, struct memtype *mt)
 }
 
 
+static int qmem_slab_walker(void *arg, struct memgroup *mg,
+			    struct memtype *mt)
+{
+	struct vty *vty = arg;
+	struct memslab_stats stats;
+	size_t ops;
+
+	if (!mt || !mtype_slab_stats(mt, &stats) || !stats.reserved)
+		return 0;
+
+	ops = stats.hits + stats.misses;
+	vty_out(vty, "%-30s: %6zu %9zu %9zu %9zu %5.1f%% %5.1f%%\n", mt->name,
+		stats.objsize, stats.reserved, stats.in_use, stats.cached,
+		100.0 * (stats.reserved - stats.in_use) / stats.reserved,
+		ops ? 100.0 * stats.hits / ops : 0.0);
+	return 0;
+}
+
 DEFUN_NOSH (show_memory,
 	    show_memory_cmd,
 	    "show memory",
@@ -132,6 +150,11 @@ DEFUN_NOSH (show_memory,
 #endif /* HAVE_MALLINFO */
 
 	qmem_walk(qmem_walker, vty);
+
+	vty_out(vty, "--- slab caches ---\n");
+	vty_out(vty, "%-30s: %6s %9s %9s %9s %6s %6s\n", "Type", "  Size",
+		"Reserved", "InUse", "Cached", " Frag", "  Hit");
+	qmem_walk(qmem_slab_walker, vty);
 	return CMD_SUCCESS;
 }
 
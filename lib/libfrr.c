@@ -98,6 +98,8 @@ static void opt_extend(const struct optspec *os)
 #define OPTION_TCLI      1005
 #define OPTION_DB_FILE   1006
 #define OPTION_LOGGING   1007
+#define OPTION_NOEPOLL   1008
+#define OPTION_NOWHEEL   1009
 
 static const struct option lo_always[] = {
 	{"help", no_argument, NULL, 'h'},
@@ -111,6 +113,8 @@ static const struct option lo_always[] = {
 	{"log-level", required_argument, NULL, OPTION_LOGLEVEL},
 	{"tcli", no_argument, NULL, OPTION_TCLI},
 	{"command-log-always", no_argument, NULL, OPTION_LOGGING},
+	{"no-epoll", no_argument, NULL, OPTION_NOEPOLL},
+	{"no-timer-wheel", no_argument, NULL, OPTION_NOWHEEL},
 	{NULL}};
 static const struct optspec os_always = {
 	"hvdM:F:",
@@ -123,7 +127,9 @@ static const struct optspec os_always = {
 	"      --moduledir    Override modules directory\n"
 	"      --log          Set Logging to stdout, syslog, or file:<name>\n"
 	"      --log-level    Set Logging Level to use, debug, info, warn, etc\n"
-	"      --tcli         Use transaction-based CLI\n",
+	"      --tcli         Use transaction-based CLI\n"
+	"      --no-epoll     Use poll() instead of epoll() for I/O events\n"
+	"      --no-timer-wheel Keep timers in a heap instead of a timer wheel\n",
 	lo_always};
 
 
@@ -553,6 +559,12 @@ static int frr_opt(int opt)
 	case OPTION_LOGGING:
 		di->log_always = true;
 		break;
+	case OPTION_NOEPOLL:
+		thread_master_set_epoll(false);
+		break;
+	case OPTION_NOWHEEL:
+		thread_master_set_timer_wheel(false);
+		break;
 	default:
 		return 1;
 	}
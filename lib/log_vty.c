@@ -24,6 +24,7 @@
 #include "command.h"
 #include "lib/log.h"
 #include "lib/zlog_targets.h"
+#include "lib/zlog_binary.h"
 #include "lib/lib_errors.h"
 #include "lib/printfrr.h"
 
@@ -57,8 +58,13 @@ static struct zlog_cfg_filterfile zt_filterfile = {
 	},
 };
 
+static struct zlog_cfg_bin zt_bin;
+/* as configured, without the daemon name suffix */
+static char zt_bin_filename[MAXPATHLEN];
+
 static const char *zlog_progname;
 static const char *zlog_protoname;
+static unsigned short zlog_instance;
 
 static const struct facility_map {
 	int facility;
@@ -152,6 +158,8 @@ DEFUN (show_logging,
        SHOW_STR
        "Show current logging configuration\n")
 {
+	struct zlog_async_stats stats;
+
 	log_show_syslog(vty);
 
 	vty_out(vty, "Stdout logging: ");
@@ -176,6 +184,12 @@ DEFUN (show_logging,
 			zlog_priority[zt_filterfile.parent.prio_min],
 			zt_filterfile.parent.filename);
 
+	if (zt_bin.prio_min != ZLOG_DISABLED && zt_bin.filename)
+		vty_out(vty,
+			"Binary-file logging: level %s, filename %s, size %zuMiB\n",
+			zlog_priority[zt_bin.prio_min], zt_bin.filename,
+			zt_bin.size / (1024 * 1024));
+
 	if (log_cmdline_syslog_lvl != ZLOG_DISABLED)
 		vty_out(vty,
 			"From command line: \"--log syslog --log-level %s\"\n",
@@ -194,6 +208,17 @@ DEFUN (show_logging,
 	vty_out(vty, "Record priority: %s\n",
 		(zt_file.record_priority ? "enabled" : "disabled"));
 	vty_out(vty, "Timestamp precision: %d\n", zt_file.ts_subsec);
+
+	vty_out(vty, "Asynchronous writing: %s\n",
+		(zt_file.async ? "enabled" : "disabled"));
+	zlog_async_get_stats(&stats);
+	if (stats.queues)
+		vty_out(vty,
+			"  Writer %s, %zu queues, %" PRIu64 " batches queued, %" PRIu64 " written\n"
+			"  %" PRIu64 " messages dropped, %" PRIu64 " producer stalls\n",
+			(stats.running ? "running" : "stopped"), stats.queues,
+			stats.queued, stats.written, stats.dropped,
+			stats.stalls);
 	return CMD_SUCCESS;
 }
 
@@ -397,6 +422,73 @@ DEFUN (no_config_log_file,
 	return CMD_SUCCESS;
 }
 
+DEFPY (config_log_binfile,
+       config_log_binfile_cmd,
+       "log binary-file FILENAME [size (1-1024)$size] [<emergencies|alerts|critical|errors|warnings|notifications|informational|debugging>$levelarg]",
+       "Logging control\n"
+       "Logging to a binary ring buffer file\n"
+       "Logging filename, the daemon name is appended\n"
+       "Set the file size\n"
+       "File size in MiB\n"
+       LOG_LEVEL_DESC)
+{
+	int level = log_default_lvl;
+	char cwd[MAXPATHLEN + 1];
+	char fullpath[MAXPATHLEN + 64];
+
+	if (levelarg) {
+		level = log_level_match(levelarg);
+		if (level == ZLOG_DISABLED)
+			return CMD_ERR_NO_MATCH;
+	}
+
+	/* all daemons may be reading the same (integrated) config, each of
+	 * them needs its own file
+	 */
+	if (!IS_DIRECTORY_SEP(*filename)) {
+		if (getcwd(cwd, sizeof(cwd)) == NULL) {
+			flog_err_sys(EC_LIB_SYSTEM_CALL,
+				     "config_log_binfile: Unable to get cwd!");
+			return CMD_WARNING_CONFIG_FAILED;
+		}
+		snprintf(fullpath, sizeof(fullpath), "%s/%s.%s", cwd, filename,
+			 zlog_progname);
+	} else
+		snprintf(fullpath, sizeof(fullpath), "%s.%s", filename,
+			 zlog_progname);
+	if (zlog_instance)
+		snprintfrr(fullpath + strlen(fullpath),
+			   sizeof(fullpath) - strlen(fullpath), "-%u",
+			   zlog_instance);
+
+	strlcpy(zt_bin_filename, filename, sizeof(zt_bin_filename));
+
+	zt_bin.prio_min = level;
+	zt_bin.size = (size_str ? size : ZLOG_BIN_SIZE_DEFAULT / (1024 * 1024))
+		      * 1024 * 1024;
+	if (!zlog_bin_set_filename(&zt_bin, fullpath)) {
+		vty_out(vty, "can't open binary logfile %s\n", fullpath);
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_config_log_binfile,
+       no_config_log_binfile_cmd,
+       "no log binary-file [FILENAME [size (1-1024)] [LEVEL]]",
+       NO_STR
+       "Logging control\n"
+       "Cancel logging to a binary file\n"
+       "Logging file name\n"
+       "Set the file size\n"
+       "File size in MiB\n"
+       "Logging level\n")
+{
+	zt_bin.prio_min = ZLOG_DISABLED;
+	zlog_bin_set_other(&zt_bin);
+	return CMD_SUCCESS;
+}
+
 DEFPY (config_log_syslog,
        config_log_syslog_cmd,
        "log syslog [<emergencies|alerts|critical|errors|warnings|notifications|informational|debugging>$levelarg]",
@@ -491,6 +583,37 @@ DEFUN (no_config_log_record_priority,
 	return CMD_SUCCESS;
 }
 
+DEFUN (config_log_async,
+       config_log_async_cmd,
+       "log asynchronous",
+       "Logging control\n"
+       "Write log files and stdout from a separate pthread\n")
+{
+	zt_file.async = true;
+	zlog_file_set_other(&zt_file);
+	zt_stdout.async = true;
+	zlog_file_set_other(&zt_stdout);
+	zt_filterfile.parent.async = true;
+	zlog_file_set_other(&zt_filterfile.parent);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_config_log_async,
+       no_config_log_async_cmd,
+       "no log asynchronous",
+       NO_STR
+       "Logging control\n"
+       "Write log files and stdout from the pthread logging the message\n")
+{
+	zt_file.async = false;
+	zlog_file_set_other(&zt_file);
+	zt_stdout.async = false;
+	zlog_file_set_other(&zt_stdout);
+	zt_filterfile.parent.async = false;
+	zlog_file_set_other(&zt_filterfile.parent);
+	return CMD_SUCCESS;
+}
+
 DEFPY (config_log_timestamp_precision,
        config_log_timestamp_precision_cmd,
        "log timestamp precision (0-6)",
@@ -642,6 +765,16 @@ void log_config_write(struct vty *vty)
 		vty_out(vty, "\n");
 	}
 
+	if (zt_bin.prio_min != ZLOG_DISABLED && zt_bin.filename) {
+		vty_out(vty, "log binary-file %s", zt_bin_filename);
+
+		if (zt_bin.size != ZLOG_BIN_SIZE_DEFAULT)
+			vty_out(vty, " size %zu", zt_bin.size / (1024 * 1024));
+		if (zt_bin.prio_min != log_default_lvl)
+			vty_out(vty, " %s", zlog_priority[zt_bin.prio_min]);
+		vty_out(vty, "\n");
+	}
+
 	if (log_config_stdout_lvl != ZLOG_DISABLED) {
 		vty_out(vty, "log stdout");
 
@@ -693,6 +826,9 @@ void log_config_write(struct vty *vty)
 	if (zt_file.ts_subsec > 0)
 		vty_out(vty, "log timestamp precision %d\n",
 			zt_file.ts_subsec);
+
+	if (zt_file.async)
+		vty_out(vty, "log asynchronous\n");
 }
 
 static int log_vty_init(const char *progname, const char *protoname,
@@ -700,8 +836,10 @@ static int log_vty_init(const char *progname, const char *protoname,
 {
 	zlog_progname = progname;
 	zlog_protoname = protoname;
+	zlog_instance = instance;
 
 	zlog_filterfile_init(&zt_filterfile);
+	zlog_bin_init(&zt_bin);
 
 	zlog_file_set_fd(&zt_stdout, STDOUT_FILENO);
 	return 0;
@@ -723,6 +861,8 @@ void log_cmd_init(void)
 	install_element(CONFIG_NODE, &no_config_log_monitor_cmd);
 	install_element(CONFIG_NODE, &config_log_file_cmd);
 	install_element(CONFIG_NODE, &no_config_log_file_cmd);
+	install_element(CONFIG_NODE, &config_log_binfile_cmd);
+	install_element(CONFIG_NODE, &no_config_log_binfile_cmd);
 	install_element(CONFIG_NODE, &config_log_syslog_cmd);
 	install_element(CONFIG_NODE, &no_config_log_syslog_cmd);
 	install_element(CONFIG_NODE, &config_log_facility_cmd);
@@ -731,6 +871,8 @@ void log_cmd_init(void)
 	install_element(CONFIG_NODE, &no_config_log_record_priority_cmd);
 	install_element(CONFIG_NODE, &config_log_timestamp_precision_cmd);
 	install_element(CONFIG_NODE, &no_config_log_timestamp_precision_cmd);
+	install_element(CONFIG_NODE, &config_log_async_cmd);
+	install_element(CONFIG_NODE, &no_config_log_async_cmd);
 
 	install_element(VIEW_NODE, &show_log_filter_cmd);
 	install_element(CONFIG_NODE, &log_filter_cmd);
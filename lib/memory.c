@@ -36,6 +36,31 @@ struct memgroup **mg_insert = &mg_first;
 DEFINE_MGROUP(LIB, "libfrr")
 DEFINE_MTYPE(LIB, TMP, "Temporary memory")
 
+/* slab caches would hide use-after-free and overflows from ASan; OpenBSD has
+ * no thread local storage for the per-thread magazines */
+#if defined(__SANITIZE_ADDRESS__) || defined(__OpenBSD__)
+#define MEMSLAB_DISABLED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MEMSLAB_DISABLED
+#endif
+#endif
+
+#ifdef MEMSLAB_DISABLED
+#define MT_SLAB(mt) ((struct memslab *)NULL)
+#else
+#define MT_SLAB(mt) ((mt)->slab)
+#endif
+
+#ifdef HAVE_MALLOC_USABLE_SIZE
+static inline size_t mt_usable_size(struct memtype *mt, void *ptr)
+{
+	if (MT_SLAB(mt))
+		return MT_SLAB(mt)->objsize;
+	return malloc_usable_size(ptr);
+}
+#endif
+
 static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 {
 	size_t current;
@@ -61,7 +86,7 @@ static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 				      memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
+	size_t mallocsz = mt_usable_size(mt, ptr);
 
 	current = mallocsz + atomic_fetch_add_explicit(&mt->total, mallocsz,
 						       memory_order_relaxed);
@@ -81,7 +106,7 @@ static inline void mt_count_free(struct memtype *mt, void *ptr)
 	atomic_fetch_sub_explicit(&mt->n_alloc, 1, memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
+	size_t mallocsz = mt_usable_size(mt, ptr);
 
 	atomic_fetch_sub_explicit(&mt->total, mallocsz, memory_order_relaxed);
 #endif
@@ -100,18 +125,333 @@ static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 	return ptr;
 }
 
+/* slab caches
+ *
+ * Each thread has a "loaded" and a "previous" magazine per slab.  Allocations
+ * pop from the loaded magazine and frees push onto it; when it runs empty
+ * (full) and the previous one is full (empty), the two are swapped.  Only
+ * when both are empty (full) does the thread go to the depot to exchange a
+ * magazine, so a thread alternating between allocating and freeing around
+ * a magazine boundary doesn't hit the depot every time.
+ */
+#define MEMSLAB_MAG_SIZE 64
+/* slabs beyond this go through the depot on every call */
+#define MEMSLAB_MAX 64
+#define MEMSLAB_CHUNK (64 * 1024)
+#define MEMSLAB_CHUNK_MIN_OBJS 16
+
+struct memslab_mag {
+	struct memslab_mag *next;
+	unsigned int n;
+	void *objs[MEMSLAB_MAG_SIZE];
+};
+
+struct memslab_tcache {
+	struct memslab_mag *loaded, *prev;
+};
+
+#ifndef MEMSLAB_DISABLED
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+static struct memslab *memslabs[MEMSLAB_MAX];
+static atomic_uint memslab_count;
+
+static thread_local struct memslab_tcache memslab_tcache[MEMSLAB_MAX];
+static thread_local bool memslab_tcache_used;
+/* set by memslab_thread_fini(); later frees on the exiting thread (from other
+ * thread-specific data destructors) must not fill new magazines */
+static thread_local bool memslab_tcache_fini;
+
+static pthread_key_t memslab_key;
+static pthread_once_t memslab_key_once = PTHREAD_ONCE_INIT;
+
+static void memslab_mag_put(struct memslab *slab, struct memslab_mag *mag)
+{
+	if (!mag)
+		return;
+
+	if (mag->n) {
+		mag->next = slab->full;
+		slab->full = mag;
+	} else {
+		mag->next = slab->empty;
+		slab->empty = mag;
+	}
+}
+
+/* hands the magazines of an exiting thread back to the depots */
+static void memslab_thread_fini(void *arg)
+{
+	struct memslab_tcache *tc;
+	unsigned int i, count;
+
+	memslab_tcache_fini = true;
+
+	count = atomic_load_explicit(&memslab_count, memory_order_acquire);
+	for (i = 0; i < count && i < MEMSLAB_MAX; i++) {
+		tc = &memslab_tcache[i];
+		if (!memslabs[i] || (!tc->loaded && !tc->prev))
+			continue;
+
+		pthread_mutex_lock(&memslabs[i]->mtx);
+		memslab_mag_put(memslabs[i], tc->loaded);
+		memslab_mag_put(memslabs[i], tc->prev);
+		pthread_mutex_unlock(&memslabs[i]->mtx);
+
+		tc->loaded = tc->prev = NULL;
+	}
+}
+
+static void memslab_key_init(void)
+{
+	pthread_key_create(&memslab_key, memslab_thread_fini);
+}
+
+static struct memslab_tcache *memslab_tcache_get(struct memslab *slab)
+{
+	unsigned int idx;
+
+	idx = atomic_load_explicit(&slab->idx, memory_order_acquire);
+	if (__builtin_expect(idx == 0, 0)) {
+		pthread_mutex_lock(&slab->mtx);
+		idx = atomic_load_explicit(&slab->idx, memory_order_relaxed);
+		if (idx == 0) {
+			idx = 1 + atomic_fetch_add_explicit(
+					  &memslab_count, 1,
+					  memory_order_relaxed);
+			if (idx <= MEMSLAB_MAX)
+				memslabs[idx - 1] = slab;
+			atomic_store_explicit(&slab->idx, idx,
+					      memory_order_release);
+		}
+		pthread_mutex_unlock(&slab->mtx);
+	}
+
+	if (idx > MEMSLAB_MAX || memslab_tcache_fini)
+		return NULL;
+
+	if (__builtin_expect(!memslab_tcache_used, 0)) {
+		/* only used to get memslab_thread_fini() called */
+		pthread_once(&memslab_key_once, memslab_key_init);
+		pthread_setspecific(memslab_key, memslab_tcache);
+		memslab_tcache_used = true;
+	}
+	return &memslab_tcache[idx - 1];
+}
+
+/* call with slab->mtx held */
+static void *memslab_carve(struct memslab *slab, const char *name)
+{
+	size_t chunksize;
+	void *obj;
+
+	if (slab->loose) {
+		obj = slab->loose;
+		slab->loose = *(void **)obj;
+		return obj;
+	}
+
+	if (slab->carve_end - slab->carve < (ptrdiff_t)slab->objsize) {
+		chunksize = MAX(MEMSLAB_CHUNK,
+				slab->objsize * MEMSLAB_CHUNK_MIN_OBJS);
+		slab->carve = malloc(chunksize);
+		if (!slab->carve)
+			memory_oom(chunksize, name);
+		slab->carve_end = slab->carve + chunksize;
+
+		/* whatever was left of the previous chunk is lost for good */
+		atomic_fetch_add_explicit(&slab->reserved, chunksize,
+					  memory_order_relaxed);
+		atomic_store_explicit(&slab->uncarved, chunksize,
+				      memory_order_relaxed);
+	}
+
+	obj = slab->carve;
+	slab->carve += slab->objsize;
+	atomic_store_explicit(&slab->uncarved, slab->carve_end - slab->carve,
+			      memory_order_relaxed);
+	return obj;
+}
+
+static void *memslab_alloc(struct memtype *mt, struct memslab *slab)
+{
+	struct memslab_tcache *tc = memslab_tcache_get(slab);
+	struct memslab_mag *mag;
+	void *obj;
+
+	if (tc) {
+		if (tc->loaded && tc->loaded->n)
+			goto hit;
+		if (tc->prev && tc->prev->n) {
+			mag = tc->loaded;
+			tc->loaded = tc->prev;
+			tc->prev = mag;
+			goto hit;
+		}
+	}
+
+	atomic_fetch_add_explicit(&slab->misses, 1, memory_order_relaxed);
+
+	pthread_mutex_lock(&slab->mtx);
+	if (tc && slab->full) {
+		/* hand back the empty previous magazine, load a full one */
+		if (tc->prev) {
+			tc->prev->next = slab->empty;
+			slab->empty = tc->prev;
+		}
+		tc->prev = tc->loaded;
+		tc->loaded = slab->full;
+		slab->full = tc->loaded->next;
+		pthread_mutex_unlock(&slab->mtx);
+		return tc->loaded->objs[--tc->loaded->n];
+	}
+	if (!tc && slab->full) {
+		mag = slab->full;
+		obj = mag->objs[--mag->n];
+		if (!mag->n) {
+			slab->full = mag->next;
+			mag->next = slab->empty;
+			slab->empty = mag;
+		}
+		pthread_mutex_unlock(&slab->mtx);
+		return obj;
+	}
+	obj = memslab_carve(slab, mt->name);
+	pthread_mutex_unlock(&slab->mtx);
+	return obj;
+
+hit:
+	atomic_fetch_add_explicit(&slab->hits, 1, memory_order_relaxed);
+	return tc->loaded->objs[--tc->loaded->n];
+}
+
+static void memslab_free(struct memtype *mt, struct memslab *slab, void *obj)
+{
+	struct memslab_tcache *tc = memslab_tcache_get(slab);
+	struct memslab_mag *mag;
+
+	if (!tc) {
+		atomic_fetch_add_explicit(&slab->misses, 1,
+					  memory_order_relaxed);
+		pthread_mutex_lock(&slab->mtx);
+		*(void **)obj = slab->loose;
+		slab->loose = obj;
+		pthread_mutex_unlock(&slab->mtx);
+		return;
+	}
+
+	if (tc->loaded && tc->loaded->n < MEMSLAB_MAG_SIZE)
+		goto hit;
+	if (tc->prev && tc->prev->n < MEMSLAB_MAG_SIZE) {
+		mag = tc->loaded;
+		tc->loaded = tc->prev;
+		tc->prev = mag;
+		goto hit;
+	}
+
+	atomic_fetch_add_explicit(&slab->misses, 1, memory_order_relaxed);
+
+	/* hand back the full previous magazine, load an empty one */
+	pthread_mutex_lock(&slab->mtx);
+	if (tc->prev) {
+		tc->prev->next = slab->full;
+		slab->full = tc->prev;
+	}
+	mag = slab->empty;
+	if (mag)
+		slab->empty = mag->next;
+	pthread_mutex_unlock(&slab->mtx);
+
+	if (!mag) {
+		mag = malloc(sizeof(*mag));
+		if (!mag)
+			memory_oom(sizeof(*mag), mt->name);
+	}
+	mag->next = NULL;
+	mag->n = 0;
+	tc->prev = tc->loaded;
+	tc->loaded = mag;
+	tc->loaded->objs[tc->loaded->n++] = obj;
+	return;
+
+hit:
+	atomic_fetch_add_explicit(&slab->hits, 1, memory_order_relaxed);
+	tc->loaded->objs[tc->loaded->n++] = obj;
+}
+
+static void *memslab_checkalloc(struct memtype *mt, size_t size)
+{
+	struct memslab *slab = MT_SLAB(mt);
+
+	/* a programming error; the object couldn't be freed correctly */
+	assert(size <= slab->objsize);
+
+	return mt_checkalloc(mt, memslab_alloc(mt, slab), size);
+}
+#else /* MEMSLAB_DISABLED */
+static void *memslab_checkalloc(struct memtype *mt, size_t size)
+{
+	assert(0);
+	return NULL;
+}
+
+static void memslab_free(struct memtype *mt, struct memslab *slab, void *obj)
+{
+	assert(0);
+}
+#endif /* MEMSLAB_DISABLED */
+
+bool mtype_slab_stats(struct memtype *mt, struct memslab_stats *stats)
+{
+	struct memslab *slab = MT_SLAB(mt);
+
+	if (!slab)
+		return false;
+
+	stats->objsize = slab->objsize;
+	stats->reserved = atomic_load_explicit(&slab->reserved,
+					       memory_order_relaxed);
+	stats->in_use = atomic_load_explicit(&mt->n_alloc,
+					     memory_order_relaxed)
+			* slab->objsize;
+	stats->hits = atomic_load_explicit(&slab->hits, memory_order_relaxed);
+	stats->misses = atomic_load_explicit(&slab->misses,
+					     memory_order_relaxed);
+
+	/* free objects in magazines, whichever thread holds them, and on the
+	 * loose list */
+	stats->cached = stats->reserved - stats->in_use
+			- atomic_load_explicit(&slab->uncarved,
+					       memory_order_relaxed);
+	return true;
+}
+
 void *qmalloc(struct memtype *mt, size_t size)
 {
+	if (MT_SLAB(mt))
+		return memslab_checkalloc(mt, size);
 	return mt_checkalloc(mt, malloc(size), size);
 }
 
 void *qcalloc(struct memtype *mt, size_t size)
 {
+	if (MT_SLAB(mt))
+		return memset(memslab_checkalloc(mt, size), 0, size);
 	return mt_checkalloc(mt, calloc(size, 1), size);
 }
 
 void *qrealloc(struct memtype *mt, void *ptr, size_t size)
 {
+	if (MT_SLAB(mt)) {
+		if (!ptr)
+			return memslab_checkalloc(mt, size);
+		/* objects don't move, they're already as large as allowed */
+		assert(size <= MT_SLAB(mt)->objsize);
+		return ptr;
+	}
+
 	if (ptr)
 		mt_count_free(mt, ptr);
 	return mt_checkalloc(mt, ptr ? realloc(ptr, size) : malloc(size), size);
@@ -119,14 +459,27 @@ void *qrealloc(struct memtype *mt, void *ptr, size_t size)
 
 void *qstrdup(struct memtype *mt, const char *str)
 {
-	return str ? mt_checkalloc(mt, strdup(str), strlen(str) + 1) : NULL;
+	size_t len;
+
+	if (!str)
+		return NULL;
+	if (MT_SLAB(mt)) {
+		len = strlen(str) + 1;
+		return memcpy(memslab_checkalloc(mt, len), str, len);
+	}
+	return mt_checkalloc(mt, strdup(str), strlen(str) + 1);
 }
 
 void qfree(struct memtype *mt, void *ptr)
 {
-	if (ptr)
-		mt_count_free(mt, ptr);
-	free(ptr);
+	if (!ptr)
+		return;
+
+	mt_count_free(mt, ptr);
+	if (MT_SLAB(mt))
+		memslab_free(mt, MT_SLAB(mt), ptr);
+	else
+		free(ptr);
 }
 
 int qmem_walk(qmem_walk_fn *func, void *arg)
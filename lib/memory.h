@@ -20,6 +20,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 #include <frratomic.h>
 #include "compiler.h"
 
@@ -33,6 +34,8 @@ extern "C" {
 #endif
 
 #define SIZE_VAR ~0UL
+struct memslab;
+
 struct memtype {
 	struct memtype *next, **ref;
 	const char *name;
@@ -43,6 +46,51 @@ struct memtype {
 	atomic_size_t total;
 	atomic_size_t max_size;
 #endif
+	/* NULL unless defined with DEFINE_MTYPE_SLAB */
+	struct memslab *slab;
+};
+
+/* Fixed size object cache behind a DEFINE_MTYPE_SLAB memtype.
+ *
+ * Freed objects are kept in per-thread "magazines" (arrays of free objects)
+ * so most allocations and frees neither lock nor go to malloc.  Magazines
+ * that are full (or empty) go back to a depot shared by all threads; new
+ * objects are carved out of large chunks, which are never returned to the
+ * system.
+ */
+struct memslab_mag;
+
+struct memslab {
+	/* object size, rounded up for alignment */
+	size_t objsize;
+	/* slot in the per-thread magazine table, 0 until first used */
+	atomic_uint idx;
+
+	pthread_mutex_t mtx;
+	/* depot; magazines on "full" may in fact be partially filled */
+	struct memslab_mag *full, *empty;
+	/* objects freed by threads without a magazine slot, or by exiting
+	 * threads after their magazines went back to the depot */
+	void *loose;
+	/* unused rest of the last chunk */
+	char *carve, *carve_end;
+
+	/* bytes in chunks, and bytes of those not carved out yet */
+	atomic_size_t reserved;
+	atomic_size_t uncarved;
+	/* allocations and frees served from the calling thread's magazines,
+	 * and those that had to go to the depot */
+	atomic_size_t hits;
+	atomic_size_t misses;
+};
+
+struct memslab_stats {
+	size_t objsize;
+	size_t reserved;
+	size_t in_use;
+	size_t cached;
+	size_t hits;
+	size_t misses;
 };
 
 struct memgroup {
@@ -115,7 +163,7 @@ struct memgroup {
 	extern struct memtype MTYPE_##name[1];                                 \
 	/* end */
 
-#define DEFINE_MTYPE_ATTR(group, mname, attr, desc)                            \
+#define _DEFINE_MTYPE_ATTR(group, mname, attr, desc, ...)                      \
 	attr struct memtype MTYPE_##mname[1]                                   \
 		__attribute__((section(".data.mtypes"))) = { {                 \
 			.name = desc,                                          \
@@ -123,6 +171,7 @@ struct memgroup {
 			.n_alloc = 0,                                          \
 			.size = 0,                                             \
 			.ref = NULL,                                           \
+			__VA_ARGS__                                            \
 	} };                                                                   \
 	static void _mtinit_##mname(void) __attribute__((_CONSTRUCTOR(1001))); \
 	static void _mtinit_##mname(void)                                      \
@@ -142,6 +191,10 @@ struct memgroup {
 	}                                                                      \
 	/* end */
 
+#define DEFINE_MTYPE_ATTR(group, mname, attr, desc)                            \
+	_DEFINE_MTYPE_ATTR(group, mname, attr, desc, )                         \
+	/* end */
+
 #define DEFINE_MTYPE(group, name, desc)                                        \
 	DEFINE_MTYPE_ATTR(group, name, , desc)                                 \
 	/* end */
@@ -150,6 +203,31 @@ struct memgroup {
 	DEFINE_MTYPE_ATTR(group, name, static, desc)                           \
 	/* end */
 
+/* Same as DEFINE_MTYPE, but objects are served from a slab cache.  All
+ * allocations of this type must be for at most objsize bytes, and the memory
+ * is only ever reused for this type.  Meant for small, fixed size objects
+ * that are allocated and freed at high rates (paths, nexthops, ...).
+ */
+#define MEMSLAB_ALIGN 16
+#define MEMSLAB_INIT(size)                                                     \
+	{                                                                      \
+		.objsize = ((size) + MEMSLAB_ALIGN - 1) & ~(MEMSLAB_ALIGN - 1),\
+		.mtx = PTHREAD_MUTEX_INITIALIZER,                              \
+	}
+
+#define DEFINE_MTYPE_SLAB_ATTR(group, mname, attr, desc, objsize)              \
+	static struct memslab _ms_##mname = MEMSLAB_INIT(objsize);             \
+	_DEFINE_MTYPE_ATTR(group, mname, attr, desc, .slab = &_ms_##mname)     \
+	/* end */
+
+#define DEFINE_MTYPE_SLAB(group, name, desc, objsize)                          \
+	DEFINE_MTYPE_SLAB_ATTR(group, name, , desc, objsize)                   \
+	/* end */
+
+#define DEFINE_MTYPE_STATIC_SLAB(group, name, desc, objsize)                   \
+	DEFINE_MTYPE_SLAB_ATTR(group, name, static, desc, objsize)             \
+	/* end */
+
 DECLARE_MGROUP(LIB)
 DECLARE_MTYPE(TMP)
 
@@ -179,6 +257,9 @@ static inline size_t mtype_stats_alloc(struct memtype *mt)
 	return mt->n_alloc;
 }
 
+/* false if mt isn't a slab memtype (or slabs are disabled in this build) */
+extern bool mtype_slab_stats(struct memtype *mt, struct memslab_stats *stats);
+
 /* NB: calls are ordered by memgroup; and there is a call with mt == NULL for
  * each memgroup (so that a header can be printed, and empty memgroups show)
  *
@@ -34,7 +34,7 @@
 #include "vrf.h"
 #include "nexthop_group.h"
 
-DEFINE_MTYPE_STATIC(LIB, NEXTHOP, "Nexthop")
+DEFINE_MTYPE_STATIC_SLAB(LIB, NEXTHOP, "Nexthop", sizeof(struct nexthop))
 DEFINE_MTYPE_STATIC(LIB, NH_LABEL, "Nexthop label")
 
 static int _nexthop_labels_cmp(const struct nexthop *nh1,
@@ -23,6 +23,7 @@
 #include "log.h"
 #include "lib_errors.h"
 #include "hash.h"
+#include "jhash.h"
 #include "command.h"
 #include "debug.h"
 #include "db.h"
@@ -34,10 +35,17 @@
 DEFINE_MTYPE_STATIC(LIB, NB_NODE, "Northbound Node")
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG, "Northbound Configuration")
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_ENTRY, "Northbound Configuration Entry")
+DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_EDIT, "Northbound Configuration Edit")
 
 /* Running configuration - shouldn't be modified directly. */
 struct nb_config *running_config;
 
+/* Latency of the configuration transactions committed so far. */
+static struct nb_commit_latency_stats commit_latency_stats;
+
+/* Set when the "when" dependencies of the schema couldn't be resolved. */
+static bool nb_config_journal_disabled;
+
 /* Hash table of user pointers associated with configuration entries. */
 static struct hash *running_config_entries;
 
@@ -150,9 +158,160 @@ static int nb_node_del_cb(const struct lys_node *snode, void *arg)
 	return YANG_ITER_CONTINUE;
 }
 
+/* Return the "when" statement of a schema node, if it has one. */
+static const struct lys_when *nb_snode_when(const struct lys_node *snode)
+{
+	switch (snode->nodetype) {
+	case LYS_CONTAINER:
+		return ((const struct lys_node_container *)snode)->when;
+	case LYS_LEAF:
+		return ((const struct lys_node_leaf *)snode)->when;
+	case LYS_LEAFLIST:
+		return ((const struct lys_node_leaflist *)snode)->when;
+	case LYS_LIST:
+		return ((const struct lys_node_list *)snode)->when;
+	case LYS_CHOICE:
+		return ((const struct lys_node_choice *)snode)->when;
+	case LYS_CASE:
+		return ((const struct lys_node_case *)snode)->when;
+	case LYS_ANYXML:
+	case LYS_ANYDATA:
+		return ((const struct lys_node_anydata *)snode)->when;
+	case LYS_USES:
+		return ((const struct lys_node_uses *)snode)->when;
+	case LYS_AUGMENT:
+		return ((const struct lys_node_augment *)snode)->when;
+	default:
+		return NULL;
+	}
+}
+
+/* Closest ancestor of a schema node that is also a data node. */
+static const struct lys_node *nb_snode_data_parent(const struct lys_node *snode)
+{
+	while ((snode = lys_parent(snode))) {
+		if (CHECK_FLAG(snode->nodetype, LYS_CONTAINER | LYS_LIST))
+			return snode;
+	}
+
+	return NULL;
+}
+
+static bool nb_snode_is_ancestor(const struct lys_node *ancestor,
+				 const struct lys_node *snode)
+{
+	for (; snode; snode = lys_parent(snode)) {
+		if (snode == ancestor)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Mark the nodes referenced by a "when" condition affecting a data node.
+ * Returns false if the condition couldn't be resolved.
+ */
+static bool nb_node_when_mark(const struct lys_node *snode,
+			      const struct lys_node *ctx,
+			      const struct lys_when *when)
+{
+	struct ly_set *set;
+
+	if (ctx)
+		set = lys_xpath_atomize(ctx, LYXP_NODE_ELEM, when->cond,
+					LYXP_WHEN);
+	else
+		set = lys_xpath_atomize(snode, LYXP_NODE_ROOT_CONFIG,
+					when->cond, LYXP_WHEN);
+	if (!set)
+		return false;
+
+	for (unsigned int i = 0; i < set->number; i++) {
+		const struct lys_node *ref = set->set.s[i];
+		const struct lys_node *parent;
+
+		/*
+		 * Creating or deleting an ancestor or a descendant of the node
+		 * creates or deletes the node itself.
+		 */
+		if (nb_snode_is_ancestor(ref, snode)
+		    || nb_snode_is_ancestor(snode, ref))
+			continue;
+
+		/* Sibling leafs are compared whenever a leaf is edited. */
+		parent = nb_snode_data_parent(snode);
+		if (parent
+		    && CHECK_FLAG(snode->nodetype, LYS_LEAF | LYS_LEAFLIST)
+		    && CHECK_FLAG(ref->nodetype, LYS_LEAF | LYS_LEAFLIST)
+		    && nb_snode_data_parent(ref) == parent)
+			continue;
+
+		for (; ref; ref = lys_parent(ref)) {
+			struct nb_node *nb_node = ref->priv;
+
+			if (nb_node)
+				SET_FLAG(nb_node->flags,
+					 F_NB_NODE_WHEN_TARGET);
+		}
+	}
+	ly_set_free(set);
+
+	return true;
+}
+
+static int nb_node_when_cb(const struct lys_node *snode, void *arg)
+{
+	bool *unresolved = arg;
+	const struct lys_node *wnode, *ctx;
+	const struct lys_when *when;
+
+	if (!CHECK_FLAG(snode->nodetype, LYS_CONTAINER | LYS_LIST | LYS_LEAF
+						 | LYS_LEAFLIST | LYS_ANYDATA)
+	    || !CHECK_FLAG(snode->flags, LYS_CONFIG_W))
+		return YANG_ITER_CONTINUE;
+
+	/*
+	 * Besides its own, the node inherits the "when" statements of the
+	 * choices, cases, uses and augments between it and its data parent.
+	 * Those are evaluated in the context of the data parent.
+	 */
+	ctx = nb_snode_data_parent(snode);
+	for (wnode = snode; wnode;) {
+		if (wnode != snode
+		    && CHECK_FLAG(wnode->nodetype, LYS_CONTAINER | LYS_LIST))
+			break;
+
+		when = nb_snode_when(wnode);
+		if (when
+		    && !nb_node_when_mark(snode, wnode == snode ? snode : ctx,
+					  when))
+			*unresolved = true;
+
+		if (wnode->nodetype == LYS_AUGMENT)
+			wnode = ((const struct lys_node_augment *)wnode)
+					->target;
+		else
+			wnode = wnode->parent;
+	}
+
+	return YANG_ITER_CONTINUE;
+}
+
 void nb_nodes_create(void)
 {
+	bool unresolved = false;
+
 	yang_snodes_iterate_all(nb_node_new_cb, 0, NULL);
+
+	/* Find the nodes whose changes the journal can't keep track of. */
+	yang_snodes_iterate_all(nb_node_when_cb, 0, &unresolved);
+	if (unresolved) {
+		flog_warn(EC_LIB_LIBYANG,
+			  "%s: failed to resolve \"when\" dependencies, commits will always diff the whole configuration",
+			  __func__);
+		nb_config_journal_disabled = true;
+	}
 }
 
 void nb_nodes_delete(void)
@@ -271,6 +430,45 @@ static int nb_node_validate(const struct lys_node *snode, void *arg)
 	return YANG_ITER_CONTINUE;
 }
 
+static int nb_config_edit_cmp(const struct nb_config_edit *a,
+			      const struct nb_config_edit *b)
+{
+	return strcmp(a->xpath, b->xpath);
+}
+
+static uint32_t nb_config_edit_hash(const struct nb_config_edit *edit)
+{
+	return string_hash_make(edit->xpath);
+}
+
+DECLARE_DLIST(nb_config_edits, struct nb_config_edit, item)
+DECLARE_HASH(nb_config_edits_hash, struct nb_config_edit, hitem,
+	     nb_config_edit_cmp, nb_config_edit_hash)
+
+/* Empty the journal of a configuration and set its validity. */
+static void nb_config_journal_reset(struct nb_config *config, bool valid)
+{
+	struct nb_config_edit *edit;
+
+	while ((edit = nb_config_edits_pop(&config->journal))) {
+		nb_config_edits_hash_del(&config->journal_hash, edit);
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit->xpath);
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit);
+	}
+	config->journal_valid = valid;
+}
+
+static void nb_config_journal_copy(struct nb_config *config_dst,
+				   const struct nb_config *config_src)
+{
+	struct nb_config_edit *edit;
+
+	nb_config_journal_reset(config_dst, config_src->journal_valid);
+	frr_each (nb_config_edits,
+		  (struct nb_config_edits_head *)&config_src->journal, edit)
+		nb_config_journal_add(config_dst, edit->xpath);
+}
+
 struct nb_config *nb_config_new(struct lyd_node *dnode)
 {
 	struct nb_config *config;
@@ -281,6 +479,8 @@ struct nb_config *nb_config_new(struct lyd_node *dnode)
 	else
 		config->dnode = yang_dnode_new(ly_native_ctx, true);
 	config->version = 0;
+	nb_config_edits_init(&config->journal);
+	nb_config_edits_hash_init(&config->journal_hash);
 
 	return config;
 }
@@ -289,6 +489,9 @@ void nb_config_free(struct nb_config *config)
 {
 	if (config->dnode)
 		yang_dnode_free(config->dnode);
+	nb_config_journal_reset(config, false);
+	nb_config_edits_hash_fini(&config->journal_hash);
+	nb_config_edits_fini(&config->journal);
 	XFREE(MTYPE_NB_CONFIG, config);
 }
 
@@ -299,6 +502,9 @@ struct nb_config *nb_config_dup(const struct nb_config *config)
 	dup = XCALLOC(MTYPE_NB_CONFIG, sizeof(*dup));
 	dup->dnode = yang_dnode_dup(config->dnode);
 	dup->version = config->version;
+	nb_config_edits_init(&dup->journal);
+	nb_config_edits_hash_init(&dup->journal_hash);
+	nb_config_journal_copy(dup, config);
 
 	return dup;
 }
@@ -312,6 +518,9 @@ int nb_config_merge(struct nb_config *config_dst, struct nb_config *config_src,
 	if (ret != 0)
 		flog_warn(EC_LIB_LIBYANG, "%s: lyd_merge() failed", __func__);
 
+	/* The merged nodes weren't journaled. */
+	nb_config_journal_reset(config_dst, false);
+
 	if (!preserve_source)
 		nb_config_free(config_src);
 
@@ -325,6 +534,9 @@ void nb_config_replace(struct nb_config *config_dst,
 	if (config_src->version != 0)
 		config_dst->version = config_src->version;
 
+	/* Update journal. */
+	nb_config_journal_copy(config_dst, config_src);
+
 	/* Update dnode. */
 	if (config_dst->dnode)
 		yang_dnode_free(config_dst->dnode);
@@ -337,6 +549,28 @@ void nb_config_replace(struct nb_config *config_dst,
 	}
 }
 
+void nb_config_journal_add(struct nb_config *config, const char *xpath)
+{
+	struct nb_config_edit *edit, lookup;
+
+	if (!config->journal_valid)
+		return;
+
+	lookup.xpath = (char *)xpath;
+	if (nb_config_edits_hash_find(&config->journal_hash, &lookup))
+		return;
+
+	if (nb_config_edits_count(&config->journal) >= NB_CONFIG_JOURNAL_MAX) {
+		nb_config_journal_reset(config, false);
+		return;
+	}
+
+	edit = XCALLOC(MTYPE_NB_CONFIG_EDIT, sizeof(*edit));
+	edit->xpath = XSTRDUP(MTYPE_NB_CONFIG_EDIT, xpath);
+	nb_config_edits_add_tail(&config->journal, edit);
+	nb_config_edits_hash_add(&config->journal_hash, edit);
+}
+
 /* Generate the nb_config_cbs tree. */
 static inline int nb_config_cb_compare(const struct nb_config_cb *a,
 				       const struct nb_config_cb *b)
@@ -460,18 +694,36 @@ static void nb_config_diff_deleted(const struct lyd_node *dnode, uint32_t *seq,
 	}
 }
 
-/* Calculate the delta between two different configurations. */
-static void nb_config_diff(const struct nb_config *config1,
-			   const struct nb_config *config2,
-			   struct nb_config_cbs *changes)
+/*
+ * Set of data nodes already processed while calculating the delta from a
+ * configuration journal (several journaled paths can lead to the same node).
+ */
+static unsigned int nb_config_diff_seen_key(const void *arg)
 {
-	struct lyd_difflist *diff;
-	uint32_t seq = 0;
+	return jhash(&arg, sizeof(arg), 0);
+}
 
-	diff = lyd_diff(config1->dnode, config2->dnode,
-			LYD_DIFFOPT_WITHDEFAULTS);
-	assert(diff);
+static bool nb_config_diff_seen_cmp(const void *arg1, const void *arg2)
+{
+	return arg1 == arg2;
+}
+
+static bool nb_config_diff_seen(struct hash *seen, const struct lyd_node *dnode)
+{
+	if (!seen)
+		return false;
+	if (hash_lookup(seen, (void *)dnode))
+		return true;
 
+	(void)hash_get(seen, (void *)dnode, hash_alloc_intern);
+	return false;
+}
+
+/* Add the changes found by libyang to the nb_config_cbs tree. */
+static void nb_config_diff_process(struct lyd_difflist *diff, uint32_t *seq,
+				   struct nb_config_cbs *changes,
+				   struct hash *seen)
+{
 	for (int i = 0; diff->type[i] != LYD_DIFF_END; i++) {
 		LYD_DIFFTYPE type;
 		struct lyd_node *dnode;
@@ -481,16 +733,19 @@ static void nb_config_diff(const struct nb_config *config1,
 		switch (type) {
 		case LYD_DIFF_CREATED:
 			dnode = diff->second[i];
-			nb_config_diff_created(dnode, &seq, changes);
+			if (!nb_config_diff_seen(seen, dnode))
+				nb_config_diff_created(dnode, seq, changes);
 			break;
 		case LYD_DIFF_DELETED:
 			dnode = diff->first[i];
-			nb_config_diff_deleted(dnode, &seq, changes);
+			if (!nb_config_diff_seen(seen, dnode))
+				nb_config_diff_deleted(dnode, seq, changes);
 			break;
 		case LYD_DIFF_CHANGED:
 			dnode = diff->second[i];
-			nb_config_diff_add_change(changes, NB_OP_MODIFY, &seq,
-						  dnode);
+			if (!nb_config_diff_seen(seen, dnode))
+				nb_config_diff_add_change(changes, NB_OP_MODIFY,
+							  seq, dnode);
 			break;
 		case LYD_DIFF_MOVEDAFTER1:
 		case LYD_DIFF_MOVEDAFTER2:
@@ -498,10 +753,447 @@ static void nb_config_diff(const struct nb_config *config1,
 			continue;
 		}
 	}
+}
+
+/* Calculate the delta between two different configurations. */
+static void nb_config_diff_full(const struct nb_config *config1,
+				const struct nb_config *config2,
+				struct nb_config_cbs *changes)
+{
+	struct lyd_difflist *diff;
+	uint32_t seq = 0;
+
+	diff = lyd_diff(config1->dnode, config2->dnode,
+			LYD_DIFFOPT_WITHDEFAULTS);
+	assert(diff);
+
+	nb_config_diff_process(diff, &seq, changes, NULL);
+
+	lyd_free_diff(diff);
+}
+
+static const struct lyd_node *nb_config_diff_get(const struct nb_config *config,
+						 const char *xpath)
+{
+	if (!config->dnode)
+		return NULL;
+
+	return yang_dnode_get(config->dnode, "%s", xpath);
+}
+
+/*
+ * Strip the last node from an XPath, ignoring the slashes inside predicates.
+ * Returns false when there's no parent left.
+ */
+static bool nb_config_diff_xpath_parent(char *xpath)
+{
+	char *last = NULL;
+	char quote = 0;
+	int depth = 0;
+
+	for (char *p = xpath; *p; p++) {
+		if (quote) {
+			if (*p == quote)
+				quote = 0;
+			continue;
+		}
+
+		switch (*p) {
+		case '\'':
+		case '"':
+			quote = *p;
+			break;
+		case '[':
+			depth++;
+			break;
+		case ']':
+			depth--;
+			break;
+		case '/':
+			if (depth == 0)
+				last = p;
+			break;
+		}
+	}
+
+	if (!last || last == xpath)
+		return false;
+
+	*last = '\0';
+	return true;
+}
+
+/* Find the topmost ancestor-or-self of a data node missing from a config. */
+static const struct lyd_node *
+nb_config_diff_root(const struct lyd_node *dnode,
+		    const struct nb_config *config)
+{
+	char xpath[XPATH_MAXLEN];
+
+	while (dnode->parent) {
+		yang_dnode_get_path(dnode->parent, xpath, sizeof(xpath));
+		if (nb_config_diff_get(config, xpath))
+			break;
+		dnode = dnode->parent;
+	}
+
+	return dnode;
+}
+
+static bool nb_config_diff_leaf_equal(const struct lyd_node *dnode1,
+				      const struct lyd_node *dnode2)
+{
+	return strmatch(yang_dnode_get_string(dnode1, NULL),
+			yang_dnode_get_string(dnode2, NULL));
+}
+
+/*
+ * Compare the leafs and leaf-lists of a node present in both configurations.
+ * All of them are compared, not only the edited one, since that's where
+ * "when" statements and defaults usually have side effects.  Child containers
+ * and lists aren't descended into: any edit inside them has its own journal
+ * entry, and nodes auto-deleted there make the journal untrusted (see
+ * F_NB_NODE_WHEN_TARGET).
+ */
+static void nb_config_diff_leafs(const struct lyd_node *parent1,
+				 const struct lyd_node *parent2, uint32_t *seq,
+				 struct nb_config_cbs *changes,
+				 struct hash *seen)
+{
+	const struct lyd_node *first1, *first2, *child1, *child2;
+
+	if (nb_config_diff_seen(seen, parent2))
+		return;
+
+	first1 = parent1->child;
+	first2 = parent2->child;
+
+	/* Created or modified leafs. */
+	LY_TREE_FOR (first2, child2) {
+		bool found = false;
+
+		if (!CHECK_FLAG(child2->schema->nodetype,
+				LYS_LEAF | LYS_LEAFLIST))
+			continue;
+
+		LY_TREE_FOR (first1, child1) {
+			if (child1->schema != child2->schema)
+				continue;
+			if (child2->schema->nodetype == LYS_LEAFLIST
+			    && !nb_config_diff_leaf_equal(child1, child2))
+				continue;
+			found = true;
+			break;
+		}
+
+		if (nb_config_diff_seen(seen, child2))
+			continue;
+		if (!found)
+			nb_config_diff_created(child2, seq, changes);
+		else if (child2->schema->nodetype == LYS_LEAF
+			 && !nb_config_diff_leaf_equal(child1, child2))
+			nb_config_diff_add_change(changes, NB_OP_MODIFY, seq,
+						  child2);
+	}
+
+	/* Deleted leafs. */
+	LY_TREE_FOR (first1, child1) {
+		bool found = false;
+
+		if (!CHECK_FLAG(child1->schema->nodetype,
+				LYS_LEAF | LYS_LEAFLIST))
+			continue;
+
+		LY_TREE_FOR (first2, child2) {
+			if (child1->schema != child2->schema)
+				continue;
+			if (child1->schema->nodetype == LYS_LEAFLIST
+			    && !nb_config_diff_leaf_equal(child1, child2))
+				continue;
+			found = true;
+			break;
+		}
+
+		if (!found && !nb_config_diff_seen(seen, child1))
+			nb_config_diff_deleted(child1, seq, changes);
+	}
+}
+
+/* Whether changing this node can auto-delete nodes the journal won't see. */
+static bool nb_config_diff_when_target(const struct lyd_node *dnode)
+{
+	const struct nb_node *nb_node = dnode->schema->priv;
+
+	return CHECK_FLAG(nb_node->flags, F_NB_NODE_WHEN_TARGET);
+}
 
+/*
+ * Compare a leaf or leaf-list edited in the candidate (present in either
+ * configuration) along with its siblings.
+ */
+static void nb_config_diff_leaf(const struct nb_config *config1,
+				const struct nb_config *config2,
+				const struct lyd_node *dnode, uint32_t *seq,
+				struct nb_config_cbs *changes,
+				struct hash *seen)
+{
+	const struct lyd_node *parent1, *parent2;
+	char xpath[XPATH_MAXLEN];
+
+	yang_dnode_get_path(dnode->parent, xpath, sizeof(xpath));
+	parent1 = nb_config_diff_get(config1, xpath);
+	parent2 = nb_config_diff_get(config2, xpath);
+	assert(parent1 && parent2);
+
+	nb_config_diff_leafs(parent1, parent2, seq, changes, seen);
+}
+
+/*
+ * Compare a top-level leaf or leaf-list edited in the candidate.
+ */
+static void nb_config_diff_leaf_top(const struct lyd_node *dnode1,
+				    const struct lyd_node *dnode2,
+				    uint32_t *seq,
+				    struct nb_config_cbs *changes,
+				    struct hash *seen)
+{
+	struct lyd_difflist *diff;
+
+	diff = lyd_diff((struct lyd_node *)dnode1, (struct lyd_node *)dnode2,
+			LYD_DIFFOPT_WITHDEFAULTS | LYD_DIFFOPT_NOSIBLINGS);
+	assert(diff);
+	nb_config_diff_process(diff, seq, changes, seen);
 	lyd_free_diff(diff);
 }
 
+/*
+ * Calculate the delta between the running configuration (config1) and a
+ * candidate (config2) looking only at the paths journaled in the candidate.
+ *
+ * Returns false, leaving a partial delta behind, when an edit might have
+ * caused libyang to auto-delete nodes outside the parent of the edited node
+ * ("when" statements), since those wouldn't be caught from the journal.
+ */
+static bool nb_config_diff_journal(const struct nb_config *config1,
+				   const struct nb_config *config2,
+				   struct nb_config_cbs *changes)
+{
+	struct nb_config_edit *edit;
+	struct hash *seen;
+	uint32_t seq = 0;
+	bool trusted = true;
+
+	seen = hash_create(nb_config_diff_seen_key, nb_config_diff_seen_cmp,
+			   "Northbound configuration diff");
+
+	frr_each (nb_config_edits,
+		  (struct nb_config_edits_head *)&config2->journal, edit) {
+		const struct lyd_node *dnode1, *dnode2;
+		char xpath[XPATH_MAXLEN];
+		bool edited = true;
+
+		/*
+		 * The edited node might be gone from both configurations (e.g.
+		 * created and then deleted again), but not its ancestors.
+		 */
+		strlcpy(xpath, edit->xpath, sizeof(xpath));
+		while (true) {
+			dnode1 = nb_config_diff_get(config1, xpath);
+			dnode2 = nb_config_diff_get(config2, xpath);
+			if (dnode1 || dnode2)
+				break;
+			if (!nb_config_diff_xpath_parent(xpath))
+				break;
+			edited = false;
+		}
+
+		if (dnode2 && !dnode1) {
+			dnode2 = nb_config_diff_root(dnode2, config1);
+			if (nb_config_diff_when_target(dnode2)) {
+				trusted = false;
+				break;
+			}
+			/* Sibling leafs might have come or gone with it. */
+			if (dnode2->parent
+			    && CHECK_FLAG(dnode2->schema->nodetype,
+					  LYS_LEAF | LYS_LEAFLIST))
+				nb_config_diff_leaf(config1, config2, dnode2,
+						    &seq, changes, seen);
+			else if (!nb_config_diff_seen(seen, dnode2))
+				nb_config_diff_created(dnode2, &seq, changes);
+		} else if (dnode1 && !dnode2) {
+			dnode1 = nb_config_diff_root(dnode1, config2);
+			if (nb_config_diff_when_target(dnode1)) {
+				trusted = false;
+				break;
+			}
+			if (dnode1->parent
+			    && CHECK_FLAG(dnode1->schema->nodetype,
+					  LYS_LEAF | LYS_LEAFLIST))
+				nb_config_diff_leaf(config1, config2, dnode1,
+						    &seq, changes, seen);
+			else if (!nb_config_diff_seen(seen, dnode1))
+				nb_config_diff_deleted(dnode1, &seq, changes);
+		} else if (dnode1 && dnode2 && edited
+			   && CHECK_FLAG(dnode2->schema->nodetype,
+					 LYS_LEAF | LYS_LEAFLIST)) {
+			if (nb_config_diff_when_target(dnode2)) {
+				trusted = false;
+				break;
+			}
+			if (dnode2->parent)
+				nb_config_diff_leaf(config1, config2, dnode2,
+						    &seq, changes, seen);
+			else
+				nb_config_diff_leaf_top(dnode1, dnode2, &seq,
+							changes, seen);
+		}
+	}
+
+	hash_clean(seen, NULL);
+	hash_free(seen);
+
+	return trusted;
+}
+
+static int nb_config_diff_strcmp(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/* Format a delta as sorted "operation xpath" strings, for comparisons. */
+static char **nb_config_diff_strings(struct nb_config_cbs *changes,
+				     size_t *count)
+{
+	struct nb_config_cb *cb;
+	char **strings;
+	size_t i = 0;
+
+	*count = 0;
+	RB_FOREACH (cb, nb_config_cbs, changes)
+		(*count)++;
+
+	strings = XCALLOC(MTYPE_TMP, (*count + 1) * sizeof(*strings));
+	RB_FOREACH (cb, nb_config_cbs, changes) {
+		char xpath[XPATH_MAXLEN];
+		char buf[XPATH_MAXLEN + 32];
+
+		yang_dnode_get_path(cb->dnode, xpath, sizeof(xpath));
+		snprintf(buf, sizeof(buf), "%s %s",
+			 nb_operation_name(cb->operation), xpath);
+		strings[i++] = XSTRDUP(MTYPE_TMP, buf);
+	}
+	qsort(strings, *count, sizeof(*strings), nb_config_diff_strcmp);
+
+	return strings;
+}
+
+/*
+ * Check the delta calculated from the journal against a full diff.  Returns
+ * false (and logs the differences) when they don't match.
+ */
+static bool nb_config_diff_verify(struct nb_config_cbs *journal,
+				  struct nb_config_cbs *full)
+{
+	char **strings1, **strings2;
+	size_t count1, count2, i = 0, j = 0;
+	bool match = true;
+
+	strings1 = nb_config_diff_strings(journal, &count1);
+	strings2 = nb_config_diff_strings(full, &count2);
+
+	while (i < count1 || j < count2) {
+		int cmp;
+
+		if (i == count1)
+			cmp = 1;
+		else if (j == count2)
+			cmp = -1;
+		else
+			cmp = strcmp(strings1[i], strings2[j]);
+
+		if (cmp < 0)
+			zlog_warn("%s: only in journal delta: %s", __func__,
+				  strings1[i++]);
+		else if (cmp > 0)
+			zlog_warn("%s: only in full delta: %s", __func__,
+				  strings2[j++]);
+		else {
+			i++;
+			j++;
+			continue;
+		}
+		match = false;
+	}
+
+	for (i = 0; i < count1; i++)
+		XFREE(MTYPE_TMP, strings1[i]);
+	for (j = 0; j < count2; j++)
+		XFREE(MTYPE_TMP, strings2[j]);
+	XFREE(MTYPE_TMP, strings1);
+	XFREE(MTYPE_TMP, strings2);
+
+	return match;
+}
+
+/*
+ * Calculate the delta between the running configuration (config1) and a
+ * candidate (config2), from the candidate's journal if it can be trusted.
+ * Returns whether the journal was used.
+ */
+static bool nb_config_diff(const struct nb_config *config1,
+			   const struct nb_config *config2,
+			   struct nb_config_cbs *changes)
+{
+	struct nb_config_cbs full;
+
+	if (nb_config_journal_disabled || !config2->journal_valid
+	    || config2->version != config1->version) {
+		nb_config_diff_full(config1, config2, changes);
+		return false;
+	}
+
+	if (!nb_config_diff_journal(config1, config2, changes)) {
+		nb_config_diff_del_changes(changes);
+		nb_config_diff_full(config1, config2, changes);
+		return false;
+	}
+	if (!DEBUG_MODE_CHECK(&nb_dbg_config_diff, DEBUG_MODE_ALL))
+		return true;
+
+	/* Verification mode: compare against a full diff. */
+	RB_INIT(nb_config_cbs, &full);
+	nb_config_diff_full(config1, config2, &full);
+	if (nb_config_diff_verify(changes, &full)) {
+		nb_config_diff_del_changes(&full);
+		return true;
+	}
+
+	flog_warn(EC_LIB_NB_CONFIG_DIFF_MISMATCH,
+		  "%s: configuration delta calculated from the journal doesn't match the full diff",
+		  __func__);
+	nb_config_diff_del_changes(changes);
+	*changes = full;
+	return false;
+}
+
+bool nb_config_diff_check(const struct nb_config *config1,
+			  const struct nb_config *config2, bool *journal)
+{
+	struct nb_config_cbs changes, full;
+	bool match;
+
+	RB_INIT(nb_config_cbs, &changes);
+	RB_INIT(nb_config_cbs, &full);
+	*journal = nb_config_diff(config1, config2, &changes);
+	nb_config_diff_full(config1, config2, &full);
+	match = nb_config_diff_verify(&changes, &full);
+	nb_config_diff_del_changes(&changes);
+	nb_config_diff_del_changes(&full);
+
+	return match;
+}
+
 int nb_candidate_edit(struct nb_config *candidate,
 		      const struct nb_node *nb_node,
 		      enum nb_operation operation, const char *xpath,
@@ -543,7 +1235,7 @@ int nb_candidate_edit(struct nb_config *candidate,
 		break;
 	case NB_OP_MOVE:
 		/* TODO: update configuration. */
-		break;
+		return NB_OK;
 	default:
 		flog_warn(EC_LIB_DEVELOPMENT,
 			  "%s: unknown operation (%u) [xpath %s]", __func__,
@@ -551,6 +1243,8 @@ int nb_candidate_edit(struct nb_config *candidate,
 		return NB_ERR;
 	}
 
+	nb_config_journal_add(candidate, xpath_edit);
+
 	return NB_OK;
 }
 
@@ -663,19 +1357,30 @@ int nb_candidate_commit_prepare(struct nb_config *candidate,
 				struct nb_transaction **transaction)
 {
 	struct nb_config_cbs changes;
+	struct nb_commit_latency latency = {};
+	struct nb_config_cb *cb;
+	struct timeval start;
+	int ret;
 
+	monotime(&start);
 	if (nb_candidate_validate_yang(candidate) != NB_OK) {
 		flog_warn(EC_LIB_NB_CANDIDATE_INVALID,
 			  "%s: failed to validate candidate configuration",
 			  __func__);
 		return NB_ERR_VALIDATION;
 	}
+	latency.validate_yang = monotime_since(&start, NULL);
 
+	monotime(&start);
 	RB_INIT(nb_config_cbs, &changes);
-	nb_config_diff(running_config, candidate, &changes);
+	latency.journal = nb_config_diff(running_config, candidate, &changes);
+	latency.diff = monotime_since(&start, NULL);
 	if (RB_EMPTY(nb_config_cbs, &changes))
 		return NB_ERR_NO_CHANGES;
+	RB_FOREACH (cb, nb_config_cbs, &changes)
+		latency.changes++;
 
+	monotime(&start);
 	if (nb_candidate_validate_code(candidate, &changes) != NB_OK) {
 		flog_warn(EC_LIB_NB_CANDIDATE_INVALID,
 			  "%s: failed to validate candidate configuration",
@@ -692,8 +1397,45 @@ int nb_candidate_commit_prepare(struct nb_config *candidate,
 		nb_config_diff_del_changes(&changes);
 		return NB_ERR_LOCKED;
 	}
+	latency.validate_code = monotime_since(&start, NULL);
 
-	return nb_transaction_process(NB_EV_PREPARE, *transaction);
+	monotime(&start);
+	ret = nb_transaction_process(NB_EV_PREPARE, *transaction);
+	latency.prepare = monotime_since(&start, NULL);
+	(*transaction)->latency = latency;
+
+	return ret;
+}
+
+#define NB_COMMIT_LATENCY_ADD(stats, latency, field)                           \
+	do {                                                                   \
+		(stats)->total.field += (latency)->field;                      \
+		if ((latency)->field > (stats)->max.field)                     \
+			(stats)->max.field = (latency)->field;                 \
+	} while (0)
+
+static void nb_commit_latency_update(const struct nb_commit_latency *latency)
+{
+	struct nb_commit_latency_stats *stats = &commit_latency_stats;
+
+	stats->commits++;
+	if (latency->journal)
+		stats->journal_commits++;
+	stats->last = *latency;
+	NB_COMMIT_LATENCY_ADD(stats, latency, changes);
+	NB_COMMIT_LATENCY_ADD(stats, latency, validate_yang);
+	NB_COMMIT_LATENCY_ADD(stats, latency, diff);
+	NB_COMMIT_LATENCY_ADD(stats, latency, validate_code);
+	NB_COMMIT_LATENCY_ADD(stats, latency, prepare);
+	NB_COMMIT_LATENCY_ADD(stats, latency, apply);
+
+	DEBUGD(&nb_dbg_events,
+	       "northbound commit: %u changes (%s): validate-yang %" PRIu64
+	       "us, diff %" PRIu64 "us, validate-code %" PRIu64
+	       "us, prepare %" PRIu64 "us, apply %" PRIu64 "us",
+	       latency->changes, latency->journal ? "journal" : "full diff",
+	       latency->validate_yang, latency->diff, latency->validate_code,
+	       latency->prepare, latency->apply);
 }
 
 void nb_candidate_commit_abort(struct nb_transaction *transaction)
@@ -705,6 +1447,9 @@ void nb_candidate_commit_abort(struct nb_transaction *transaction)
 void nb_candidate_commit_apply(struct nb_transaction *transaction,
 			       bool save_transaction, uint32_t *transaction_id)
 {
+	struct timeval start;
+
+	monotime(&start);
 	(void)nb_transaction_process(NB_EV_APPLY, transaction);
 	nb_transaction_apply_finish(transaction);
 
@@ -712,6 +1457,13 @@ void nb_candidate_commit_apply(struct nb_transaction *transaction,
 	transaction->config->version++;
 	nb_config_replace(running_config, transaction->config, true);
 
+	/* Both are identical now, start journaling anew. */
+	nb_config_journal_reset(running_config, true);
+	nb_config_journal_reset(transaction->config, true);
+
+	transaction->latency.apply = monotime_since(&start, NULL);
+	nb_commit_latency_update(&transaction->latency);
+
 	/* Record transaction. */
 	if (save_transaction
 	    && nb_db_transaction_save(transaction, transaction_id) != NB_OK)
@@ -721,6 +1473,11 @@ void nb_candidate_commit_apply(struct nb_transaction *transaction,
 	nb_transaction_free(transaction);
 }
 
+const struct nb_commit_latency_stats *nb_commit_latency_stats(void)
+{
+	return &commit_latency_stats;
+}
+
 int nb_candidate_commit(struct nb_config *candidate, enum nb_client client,
 			const void *user, bool save_transaction,
 			const char *comment, uint32_t *transaction_id)
@@ -1917,6 +2674,7 @@ void nb_init(struct thread_master *tm,
 
 	/* Create an empty running configuration. */
 	running_config = nb_config_new(NULL);
+	nb_config_journal_reset(running_config, true);
 	running_config_entries = hash_create(running_config_entry_key_make,
 					     running_config_entry_cmp,
 					     "Running Configuration Entries");
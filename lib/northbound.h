@@ -24,6 +24,7 @@
 #include "hook.h"
 #include "linklist.h"
 #include "openbsd-tree.h"
+#include "typesafe.h"
 #include "yang.h"
 #include "yang_translator.h"
 
@@ -402,6 +403,11 @@ struct nb_node {
 #define F_NB_NODE_CONFIG_ONLY 0x01
 /* The YANG list doesn't contain key leafs. */
 #define F_NB_NODE_KEYLESS_LIST 0x02
+/*
+ * Changing this node (or a node below it) can make libyang auto-delete nodes
+ * elsewhere, through their "when" statements.
+ */
+#define F_NB_NODE_WHEN_TARGET 0x04
 
 /*
  * HACK: old gcc versions (< 5.x) have a bug that prevents C99 flexible arrays
@@ -458,10 +464,36 @@ enum nb_client {
 	NB_CLIENT_GRPC,
 };
 
+PREDECL_DLIST(nb_config_edits)
+PREDECL_HASH(nb_config_edits_hash)
+
+/* Configuration path edited through nb_candidate_edit(). */
+struct nb_config_edit {
+	struct nb_config_edits_item item;
+	struct nb_config_edits_hash_item hitem;
+	char *xpath;
+};
+
+/*
+ * Journals longer than this aren't worth it: the commit falls back to
+ * diffing the whole configuration.
+ */
+#define NB_CONFIG_JOURNAL_MAX 1024
+
 /* Northbound configuration. */
 struct nb_config {
 	struct lyd_node *dnode;
 	uint32_t version;
+
+	/*
+	 * Paths edited since this configuration was identical to the running
+	 * configuration with the same version.  When valid, the changes to
+	 * commit are computed from these paths only instead of diffing the
+	 * whole configuration.  Merges, loads and the like invalidate it.
+	 */
+	bool journal_valid;
+	struct nb_config_edits_head journal;
+	struct nb_config_edits_hash_head journal_hash;
 };
 
 /* Northbound configuration callback. */
@@ -482,12 +514,40 @@ struct nb_config_change {
 	bool prepare_ok;
 };
 
+/* Commit latency of a configuration transaction, in microseconds. */
+struct nb_commit_latency {
+	/* Whether the changes were computed from the candidate's journal. */
+	bool journal;
+	uint32_t changes;
+
+	/* YANG validation of the candidate. */
+	uint64_t validate_yang;
+	/* Computation of the changes. */
+	uint64_t diff;
+	/* Validation of the changes by the northbound callbacks. */
+	uint64_t validate_code;
+	/* NB_EV_PREPARE phase. */
+	uint64_t prepare;
+	/* NB_EV_APPLY phase, including the update of the running config. */
+	uint64_t apply;
+};
+
+/* Commit latency statistics, see nb_commit_latency_stats(). */
+struct nb_commit_latency_stats {
+	uint64_t commits;
+	uint64_t journal_commits;
+	struct nb_commit_latency last;
+	struct nb_commit_latency max;
+	struct nb_commit_latency total;
+};
+
 /* Northbound configuration transaction. */
 struct nb_transaction {
 	enum nb_client client;
 	char comment[80];
 	struct nb_config *config;
 	struct nb_config_cbs changes;
+	struct nb_commit_latency latency;
 };
 
 /* Callback function used by nb_oper_data_iterate(). */
@@ -510,6 +570,7 @@ extern struct debug nb_dbg_cbs_state;
 extern struct debug nb_dbg_cbs_rpc;
 extern struct debug nb_dbg_notif;
 extern struct debug nb_dbg_events;
+extern struct debug nb_dbg_config_diff;
 
 /* Global running configuration. */
 extern struct nb_config *running_config;
@@ -618,6 +679,38 @@ extern void nb_config_replace(struct nb_config *config_dst,
 			      struct nb_config *config_src,
 			      bool preserve_source);
 
+/*
+ * Record a path edited in a configuration, for configurations edited by
+ * other means than nb_candidate_edit() (which records its edits itself).
+ *
+ * config
+ *    Configuration that was edited.
+ *
+ * xpath
+ *    XPath of the created, modified or deleted configuration node.
+ */
+extern void nb_config_journal_add(struct nb_config *config, const char *xpath);
+
+/*
+ * Calculate the delta between two configurations the same way commits do and
+ * check it against a full diff.  Meant for unit tests.
+ *
+ * config1
+ *    Running configuration.
+ *
+ * config2
+ *    Validated candidate configuration.
+ *
+ * journal
+ *    Set to whether the delta was calculated from the candidate's journal.
+ *
+ * Returns:
+ *    true if both deltas are identical, false otherwise.
+ */
+extern bool nb_config_diff_check(const struct nb_config *config1,
+				 const struct nb_config *config2,
+				 bool *journal);
+
 /*
  * Edit a candidate configuration.
  *
@@ -797,6 +890,15 @@ extern int nb_candidate_commit(struct nb_config *candidate,
 			       bool save_transaction, const char *comment,
 			       uint32_t *transaction_id);
 
+/*
+ * Get the commit latency statistics of the configuration transactions
+ * committed so far.
+ *
+ * Returns:
+ *    Pointer to the statistics.
+ */
+extern const struct nb_commit_latency_stats *nb_commit_latency_stats(void);
+
 /*
  * Lock the running configuration.
  *
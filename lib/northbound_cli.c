@@ -42,6 +42,7 @@ struct debug nb_dbg_cbs_rpc = {0, "Northbound callbacks: RPCs"};
 struct debug nb_dbg_notif = {0, "Northbound notifications"};
 struct debug nb_dbg_events = {0, "Northbound events"};
 struct debug nb_dbg_libyang = {0, "libyang debugging"};
+struct debug nb_dbg_config_diff = {0, "Northbound configuration diff"};
 
 struct nb_config *vty_shared_candidate_config;
 static struct thread_master *master;
@@ -1289,6 +1290,51 @@ error:
 	return NB_ERR;
 }
 
+DEFPY (show_config_commit_latency,
+       show_config_commit_latency_cmd,
+       "show configuration commit-latency",
+       SHOW_STR
+       "Configuration information\n"
+       "Latency of the committed configuration transactions\n")
+{
+	const struct nb_commit_latency_stats *stats;
+	const struct nb_commit_latency *last, *max, *total;
+
+	stats = nb_commit_latency_stats();
+	if (stats->commits == 0) {
+		vty_out(vty, "No configuration transaction committed yet.\n");
+		return CMD_SUCCESS;
+	}
+	last = &stats->last;
+	max = &stats->max;
+	total = &stats->total;
+
+	vty_out(vty, "Transactions: %" PRIu64 " (%" PRIu64
+		     " calculated from the edit journal)\n",
+		stats->commits, stats->journal_commits);
+	vty_out(vty, "Last transaction: %u change(s), %s\n\n", last->changes,
+		last->journal ? "edit journal" : "full diff");
+
+	vty_out(vty, "%-16s %12s %12s %12s\n", "Phase (usecs)", "Last",
+		"Average", "Max");
+	vty_out(vty, "%-16s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		"validate-yang", last->validate_yang,
+		total->validate_yang / stats->commits, max->validate_yang);
+	vty_out(vty, "%-16s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		"diff", last->diff, total->diff / stats->commits, max->diff);
+	vty_out(vty, "%-16s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		"validate-code", last->validate_code,
+		total->validate_code / stats->commits, max->validate_code);
+	vty_out(vty, "%-16s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		"prepare", last->prepare, total->prepare / stats->commits,
+		max->prepare);
+	vty_out(vty, "%-16s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		"apply", last->apply, total->apply / stats->commits,
+		max->apply);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY (show_yang_operational_data,
        show_yang_operational_data_cmd,
        "show yang operational-data XPATH$xpath\
@@ -1584,6 +1630,7 @@ DEFPY (rollback_config,
 static struct debug *nb_debugs[] = {
 	&nb_dbg_cbs_config, &nb_dbg_cbs_state, &nb_dbg_cbs_rpc,
 	&nb_dbg_notif,      &nb_dbg_events,    &nb_dbg_libyang,
+	&nb_dbg_config_diff,
 };
 
 static const char *const nb_debugs_conflines[] = {
@@ -1593,6 +1640,7 @@ static const char *const nb_debugs_conflines[] = {
 	"debug northbound notifications",
 	"debug northbound events",
 	"debug northbound libyang",
+	"debug northbound config-diff",
 };
 
 DEFINE_HOOK(nb_client_debug_set_all, (uint32_t flags, bool set), (flags, set));
@@ -1618,6 +1666,7 @@ DEFPY (debug_nb,
 	    |notifications$notifications\
 	    |events$events\
 	    |libyang$libyang\
+	    |config-diff$config_diff\
           >]",
        NO_STR
        DEBUG_STR
@@ -1628,7 +1677,8 @@ DEFPY (debug_nb,
        "RPC\n"
        "Notifications\n"
        "Events\n"
-       "libyang debugging\n")
+       "libyang debugging\n"
+       "Verify the configuration changes calculated from the edit journal\n")
 {
 	uint32_t mode = DEBUG_NODE2MODE(vty->node);
 
@@ -1650,6 +1700,8 @@ DEFPY (debug_nb,
 		DEBUG_MODE_SET(&nb_dbg_libyang, mode, !no);
 		yang_debugging_set(!no);
 	}
+	if (config_diff)
+		DEBUG_MODE_SET(&nb_dbg_config_diff, mode, !no);
 
 	/* no specific debug --> act on all of them */
 	if (strmatch(argv[argc - 1]->text, "northbound")) {
@@ -1761,6 +1813,7 @@ void nb_cli_init(struct thread_master *tm)
 	/* Other commands. */
 	install_element(CONFIG_NODE, &yang_module_translator_load_cmd);
 	install_element(CONFIG_NODE, &yang_module_translator_unload_cmd);
+	install_element(ENABLE_NODE, &show_config_commit_latency_cmd);
 	install_element(ENABLE_NODE, &show_yang_operational_data_cmd);
 	install_element(ENABLE_NODE, &show_yang_module_cmd);
 	install_element(ENABLE_NODE, &show_yang_module_detail_cmd);
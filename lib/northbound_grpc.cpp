@@ -254,6 +254,8 @@ class NorthboundImpl final : public frr::Northbound::Service
 					"Failed to update \"" + pv.path()
 						+ "\"");
 			}
+			nb_config_journal_add(candidate_tmp,
+					      pv.path().c_str());
 		}
 
 		pvs = request->delete_();
@@ -266,6 +268,8 @@ class NorthboundImpl final : public frr::Northbound::Service
 					"Failed to remove \"" + pv.path()
 						+ "\"");
 			}
+			nb_config_journal_add(candidate_tmp,
+					      pv.path().c_str());
 		}
 
 		// No errors, accept all changes.
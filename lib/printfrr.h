@@ -131,6 +131,17 @@ struct printfrr_ext {
  */
 void printfrr_ext_reg(const struct printfrr_ext *);
 
+/* render one extended specifier, fmt pointing after the "%p" / "%d";  for
+ * code that walks format strings itself.
+ *
+ * return value: number of bytes consumed for the extended specifier, 0 if
+ * there is none.
+ */
+ssize_t printfrr_extp(char *buf, size_t sz, const char *fmt, int prec,
+		      const void *ptr);
+ssize_t printfrr_exti(char *buf, size_t sz, const char *fmt, int prec,
+		      uintmax_t num);
+
 #define printfrr_ext_autoreg_p(matchs, print_fn)                               \
 	static ssize_t print_fn(char *, size_t, const char *, int,             \
 				const void *);                                 \
@@ -249,6 +249,19 @@ static int lib_route_map_entry_description_destroy(enum nb_event event,
 	return NB_OK;
 }
 
+/*
+ * Tell the daemons that an entry's action or flow changed, the way the
+ * route map code does when rules are added or removed.
+ */
+static void lib_route_map_entry_notify(struct route_map_index *rmi)
+{
+	if (route_map_master.event_hook) {
+		(*route_map_master.event_hook)(rmi->map->name);
+		route_map_notify_dependencies(rmi->map->name,
+					      RMAP_EVENT_CALL_ADDED);
+	}
+}
+
 /*
  * XPath: /frr-route-map:lib/route-map/entry/action
  */
@@ -267,7 +280,7 @@ static int lib_route_map_entry_action_modify(enum nb_event event,
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(dnode, NULL, true);
 		rmi->type = yang_dnode_get_enum(dnode, NULL);
-		/* TODO: notify? */
+		lib_route_map_entry_notify(rmi);
 		break;
 	}
 
@@ -389,6 +402,7 @@ static int lib_route_map_entry_exit_policy_modify(enum nb_event event,
 			rmi->exitpolicy = RMAP_GOTO;
 			break;
 		}
+		lib_route_map_entry_notify(rmi);
 		break;
 	}
 
@@ -422,6 +436,7 @@ static int lib_route_map_entry_goto_value_modify(enum nb_event event,
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(dnode, NULL, true);
 		rmi->nextpref = yang_dnode_get_uint16(dnode, NULL);
+		lib_route_map_entry_notify(rmi);
 		break;
 	}
 
@@ -442,6 +457,7 @@ static int lib_route_map_entry_goto_value_destroy(enum nb_event event,
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(dnode, NULL, true);
 		rmi->nextpref = 0;
+		lib_route_map_entry_notify(rmi);
 		break;
 	}
 
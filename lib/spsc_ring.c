@@ -0,0 +1,53 @@
+/*
+ * Lock-free single producer, single consumer ring of pointers.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <zebra.h>
+
+#include "spsc_ring.h"
+#include "memory.h"
+
+DEFINE_MTYPE_STATIC(LIB, SPSC_RING, "SPSC ring")
+
+struct spsc_ring *spsc_ring_new(size_t size)
+{
+	struct spsc_ring *ring;
+	size_t slots = 1;
+
+	while (slots < size)
+		slots <<= 1;
+
+	ring = XCALLOC(MTYPE_SPSC_RING,
+		       sizeof(*ring) + slots * sizeof(ring->slots[0]));
+	ring->mask = slots - 1;
+
+	return ring;
+}
+
+void spsc_ring_clean(struct spsc_ring *ring, void (*del)(void *))
+{
+	void *item;
+
+	while ((item = spsc_ring_pop(ring)))
+		if (del)
+			del(item);
+}
+
+void spsc_ring_del(struct spsc_ring *ring, void (*del)(void *))
+{
+	spsc_ring_clean(ring, del);
+	XFREE(MTYPE_SPSC_RING, ring);
+}
@@ -0,0 +1,187 @@
+/*
+ * Lock-free single producer, single consumer ring of pointers.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifndef _FRR_SPSC_RING_H_
+#define _FRR_SPSC_RING_H_
+
+#include <zebra.h>
+#include <stdint.h>
+
+#include "frratomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bounded queue handing pointers from exactly one producer thread to exactly
+ * one consumer thread, without locks.
+ *
+ * head and tail are free running counters, only ever written by the consumer
+ * and the producer respectively; each side additionally keeps a possibly
+ * stale copy of the other side's counter so that it only needs to touch the
+ * other side's cache line when the ring looks full (or empty).
+ *
+ * "One producer" and "one consumer" are roles, not fixed threads: several
+ * threads can take turns in either role as long as something else (usually
+ * a mutex) makes sure they never do so at the same time.
+ */
+#define SPSC_RING_CACHELINE 64
+
+struct spsc_ring {
+	/* number of slots - 1; the number of slots is a power of 2 */
+	size_t mask;
+
+	/* consumer side */
+	_Atomic size_t head __attribute__((aligned(SPSC_RING_CACHELINE)));
+	size_t tail_cache;
+
+	/* producer side */
+	_Atomic size_t tail __attribute__((aligned(SPSC_RING_CACHELINE)));
+	size_t head_cache;
+
+	void *slots[] __attribute__((aligned(SPSC_RING_CACHELINE)));
+};
+
+/*
+ * Creates a new ring.
+ *
+ * @param size	minimum number of items the ring must hold; rounded up to a
+ *		power of 2
+ * @return the newly created ring
+ */
+extern struct spsc_ring *spsc_ring_new(size_t size);
+
+/*
+ * Deletes a ring.  Items still on the ring are passed to del, if not NULL.
+ * Neither side may be using the ring anymore.
+ */
+extern void spsc_ring_del(struct spsc_ring *ring, void (*del)(void *));
+
+/*
+ * Pops all items off the ring, passing them to del if not NULL.  This is a
+ * consumer side operation.
+ */
+extern void spsc_ring_clean(struct spsc_ring *ring, void (*del)(void *));
+
+/* Maximum number of items on the ring. */
+static inline size_t spsc_ring_size(const struct spsc_ring *ring)
+{
+	return ring->mask + 1;
+}
+
+/*
+ * Number of items on the ring.  Safe to call from any thread, but unless the
+ * caller holds one of the two roles, the result is just a snapshot.
+ */
+static inline size_t spsc_ring_count(struct spsc_ring *ring)
+{
+	size_t head, tail;
+
+	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	return tail - head;
+}
+
+/* Producer: whether the next spsc_ring_push() would fail. */
+static inline bool spsc_ring_full(struct spsc_ring *ring)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (tail - ring->head_cache <= ring->mask)
+		return false;
+
+	ring->head_cache =
+		atomic_load_explicit(&ring->head, memory_order_acquire);
+	return tail - ring->head_cache > ring->mask;
+}
+
+/*
+ * Producer: appends an item, which must not be NULL.
+ *
+ * @return false if the ring is full; the item is not queued then
+ */
+static inline bool spsc_ring_push(struct spsc_ring *ring, void *item)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (spsc_ring_full(ring))
+		return false;
+
+	ring->slots[tail & ring->mask] = item;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+/*
+ * Consumer: returns the n-th item from the front of the ring without removing
+ * it, NULL if there are no more than n items.
+ */
+static inline void *spsc_ring_peek(struct spsc_ring *ring, size_t n)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (ring->tail_cache - head <= n) {
+		ring->tail_cache =
+			atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (ring->tail_cache - head <= n)
+			return NULL;
+	}
+
+	return ring->slots[(head + n) & ring->mask];
+}
+
+/*
+ * Walks the items on the ring from a thread other than the consumer, without
+ * touching the consumer's state.  *pos starts out as 0 and is advanced past
+ * each item returned; items the consumer pops meanwhile are skipped.
+ *
+ * The consumer may still pop (and free) the item returned;  the caller has to
+ * sort that out with it.
+ */
+static inline void *spsc_ring_walk(struct spsc_ring *ring, size_t *pos)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_seq_cst);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	if ((ssize_t)(*pos - head) < 0)
+		*pos = head;
+	if (*pos == tail)
+		return NULL;
+
+	return ring->slots[(*pos)++ & ring->mask];
+}
+
+/* Consumer: removes and returns the first item, NULL if the ring is empty. */
+static inline void *spsc_ring_pop(struct spsc_ring *ring)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	void *item;
+
+	item = spsc_ring_peek(ring, 0);
+	if (item)
+		atomic_store_explicit(&ring->head, head + 1,
+				      memory_order_release);
+	return item;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SPSC_RING_H_ */
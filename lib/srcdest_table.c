@@ -30,7 +30,8 @@
 #include "table.h"
 #include "printfrr.h"
 
-DEFINE_MTYPE_STATIC(LIB, ROUTE_SRC_NODE, "Route source node")
+DEFINE_MTYPE_STATIC_SLAB(LIB, ROUTE_SRC_NODE, "Route source node",
+			 sizeof(struct route_node))
 
 /* ----- functions to manage rnodes _with_ srcdest table ----- */
 struct srcdest_rnode {
@@ -40,6 +41,10 @@ struct srcdest_rnode {
 	struct route_table *src_table;
 };
 
+/* larger than the route nodes MTYPE_ROUTE_NODE is sized for */
+DEFINE_MTYPE_STATIC_SLAB(LIB, ROUTE_DST_NODE, "Route destination node",
+			 sizeof(struct srcdest_rnode))
+
 static struct srcdest_rnode *srcdest_rnode_from_rnode(struct route_node *rn)
 {
 	assert(rnode_is_dstnode(rn));
@@ -55,7 +60,7 @@ static struct route_node *srcdest_rnode_create(route_table_delegate_t *delegate,
 					       struct route_table *table)
 {
 	struct srcdest_rnode *srn;
-	srn = XCALLOC(MTYPE_ROUTE_NODE, sizeof(struct srcdest_rnode));
+	srn = XCALLOC(MTYPE_ROUTE_DST_NODE, sizeof(struct srcdest_rnode));
 	return srcdest_rnode_to_rnode(srn);
 }
 
@@ -75,7 +80,7 @@ static void srcdest_rnode_destroy(route_table_delegate_t *delegate,
 	src_table = srn->src_table;
 	srn->src_table = NULL;
 	route_table_finish(src_table);
-	XFREE(MTYPE_ROUTE_NODE, rn);
+	XFREE(MTYPE_ROUTE_DST_NODE, rn);
 }
 
 route_table_delegate_t _srcdest_dstnode_delegate = {
@@ -29,7 +29,8 @@
 #include "sockunion.h"
 
 DEFINE_MTYPE_STATIC(LIB, ROUTE_TABLE, "Route table")
-DEFINE_MTYPE(LIB, ROUTE_NODE, "Route node")
+DEFINE_MTYPE_SLAB(LIB, ROUTE_NODE, "Route node", sizeof(struct route_node))
+DEFINE_MTYPE_STATIC(LIB, ROUTE_TABLE_INDEX, "Route table index")
 
 static void route_table_free(struct route_table *);
 
@@ -135,6 +136,7 @@ static void route_table_free(struct route_table *rt)
 
 	assert(rt->count == 0);
 
+	XFREE(MTYPE_ROUTE_TABLE_INDEX, rt->index);
 	rn_hash_node_fini(&rt->hash);
 	XFREE(MTYPE_ROUTE_TABLE, rt);
 	return;
@@ -190,17 +192,161 @@ static void set_link(struct route_node *node, struct route_node *new)
 	new->parent = node;
 }
 
+/*
+ * Level-compressed first stride.
+ *
+ * Longest prefix matches on a full table spend most of their time walking
+ * down the first levels of the tree, which are the same for every lookup
+ * and rarely hot in the cache.  Once a table is large, a flat array indexed
+ * by the first ROUTE_TABLE_INDEX_BITS bits of the address lets
+ * route_node_match() start right at the node those levels lead to.
+ *
+ * slot[i] is the deepest node - with or without a route - whose prefix is
+ * at most ROUTE_TABLE_INDEX_BITS long and covers the addresses starting
+ * with i, NULL if there is none.  The tree itself is left as it is, so
+ * nothing changes for the code walking it.
+ */
+#define RT_INDEX_SIZE (1U << ROUTE_TABLE_INDEX_BITS)
+
+struct route_table_index {
+	uint8_t family;
+	struct route_node *slot[RT_INDEX_SIZE];
+};
+
+static unsigned long route_table_index_threshold = ROUTE_TABLE_INDEX_THRESHOLD;
+
+void route_table_set_index_threshold(unsigned long count)
+{
+	route_table_index_threshold = count;
+}
+
+bool route_table_indexed(const struct route_table *table)
+{
+	return table->index != NULL;
+}
+
+static inline uint32_t route_index_key(const struct prefix *p)
+{
+	const uint8_t *b = &p->u.prefix;
+	uint32_t addr;
+
+	addr = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16)
+	       | ((uint32_t)b[2] << 8) | b[3];
+	return addr >> (32 - ROUTE_TABLE_INDEX_BITS);
+}
+
+/* Points the slots covered by node to it, unless they already point to a
+ * longer prefix. */
+static void route_table_index_add(struct route_table *table,
+				  struct route_node *node)
+{
+	struct route_table_index *index = table->index;
+	uint32_t i, first, span;
+
+	if (!index || node->p.family != index->family
+	    || node->p.prefixlen > ROUTE_TABLE_INDEX_BITS)
+		return;
+
+	span = 1U << (ROUTE_TABLE_INDEX_BITS - node->p.prefixlen);
+	first = route_index_key(&node->p) & ~(span - 1);
+
+	for (i = first; i < first + span; i++)
+		if (!index->slot[i]
+		    || index->slot[i]->p.prefixlen < node->p.prefixlen)
+			index->slot[i] = node;
+}
+
+/* node is about to be unlinked; the slots pointing to it fall back to its
+ * parent, which is the next longest prefix covering them. */
+static void route_table_index_del(struct route_table *table,
+				  struct route_node *node)
+{
+	struct route_table_index *index = table->index;
+	uint32_t i, first, span;
+
+	if (!route_table_index_threshold
+	    || table->count < route_table_index_threshold / 2) {
+		XFREE(MTYPE_ROUTE_TABLE_INDEX, table->index);
+		return;
+	}
+
+	if (node->p.family != index->family
+	    || node->p.prefixlen > ROUTE_TABLE_INDEX_BITS)
+		return;
+
+	span = 1U << (ROUTE_TABLE_INDEX_BITS - node->p.prefixlen);
+	first = route_index_key(&node->p) & ~(span - 1);
+
+	for (i = first; i < first + span; i++)
+		if (index->slot[i] == node)
+			index->slot[i] = node->parent;
+}
+
+static void route_table_index_build(struct route_table *table)
+{
+	struct route_node *node = table->top;
+
+	if (!node || (node->p.family != AF_INET && node->p.family != AF_INET6))
+		return;
+
+	table->index = XCALLOC(MTYPE_ROUTE_TABLE_INDEX,
+			       sizeof(struct route_table_index));
+	table->index->family = node->p.family;
+
+	/* Pre-order walk, without locking, that doesn't descend below
+	 * the nodes the index can point to. */
+	while (node) {
+		route_table_index_add(table, node);
+
+		if (node->p.prefixlen < ROUTE_TABLE_INDEX_BITS) {
+			if (node->l_left) {
+				node = node->l_left;
+				continue;
+			}
+			if (node->l_right) {
+				node = node->l_right;
+				continue;
+			}
+		}
+
+		while (node->parent) {
+			if (node->parent->l_left == node
+			    && node->parent->l_right) {
+				node = node->parent->l_right;
+				break;
+			}
+			node = node->parent;
+		}
+		if (!node->parent)
+			break;
+	}
+}
+
 /* Find matched prefix. */
 struct route_node *route_node_match(struct route_table *table,
 				    union prefixconstptr pu)
 {
 	const struct prefix *p = pu.p;
+	struct route_table_index *index = table->index;
 	struct route_node *node;
 	struct route_node *matched;
+	struct route_node *start = NULL;
 
 	matched = NULL;
 	node = table->top;
 
+	/* Skip the first levels if the table is indexed.  With no node of
+	 * ROUTE_TABLE_INDEX_BITS or less covering p, only a tree whose top is
+	 * longer than that can still hold a match. */
+	if (index && p->family == index->family
+	    && p->prefixlen >= ROUTE_TABLE_INDEX_BITS) {
+		start = index->slot[route_index_key(p)];
+		if (start)
+			node = start;
+		else if (node && node->p.prefixlen <= ROUTE_TABLE_INDEX_BITS)
+			node = NULL;
+	}
+
 	/* Walk down tree.  If there is matched route then store it to
 	   matched. */
 	while (node && node->p.prefixlen <= p->prefixlen
@@ -214,6 +360,15 @@ struct route_node *route_node_match(struct route_table *table,
 		node = node->link[prefix_bit(&p->u.prefix, node->p.prefixlen)];
 	}
 
+	/* Nothing below the node the index led to, the longest match is then
+	 * the closest of the skipped nodes holding a route. */
+	if (!matched && start)
+		for (node = start->parent; node; node = node->parent)
+			if (node->info) {
+				matched = node;
+				break;
+			}
+
 	/* If matched route found, return it. */
 	if (matched)
 		return route_lock_node(matched);
@@ -308,6 +463,7 @@ struct route_node *route_node_get(struct route_table *table,
 			set_link(match, new);
 		else
 			table->top = new;
+		route_table_index_add(table, new);
 	} else {
 		new = route_node_new(table);
 		route_common(&node->p, p, &new->p);
@@ -320,17 +476,23 @@ struct route_node *route_node_get(struct route_table *table,
 			set_link(match, new);
 		else
 			table->top = new;
+		route_table_index_add(table, new);
 
 		if (new->p.prefixlen != p->prefixlen) {
 			match = new;
 			new = route_node_set(table, p);
 			set_link(match, new);
+			route_table_index_add(table, new);
 			table->count++;
 		}
 	}
 	table->count++;
 	route_lock_node(new);
 
+	if (!table->index && route_table_index_threshold
+	    && table->count >= route_table_index_threshold)
+		route_table_index_build(table);
+
 	return new;
 }
 
@@ -368,6 +530,9 @@ void route_node_delete(struct route_node *node)
 
 	rn_hash_node_del(&node->table->hash, node);
 
+	if (node->table->index)
+		route_table_index_del(node->table, node);
+
 	/* WARNING: FRAGILE CODE!
 	 * route_node_free may have the side effect of free'ing the entire
 	 * table.
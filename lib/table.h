@@ -38,6 +38,7 @@ DECLARE_MTYPE(ROUTE_NODE)
  */
 struct route_node;
 struct route_table;
+struct route_table_index;
 
 /*
  * route_table_delegate_t
@@ -74,6 +75,12 @@ struct route_table {
 
 	unsigned long count;
 
+	/*
+	 * Level-compressed first stride over the tree, only present while
+	 * the table is large; see route_node_match().
+	 */
+	struct route_table_index *index;
+
 	/*
 	 * User data.
 	 */
@@ -221,6 +228,17 @@ ext_pure struct route_node *route_node_match_ipv6(struct route_table *table,
 
 ext_pure unsigned long route_table_count(struct route_table *table);
 
+/*
+ * Longest prefix matches on tables with at least this many nodes skip the
+ * first ROUTE_TABLE_INDEX_BITS levels of the tree through a flat array
+ * (2^ROUTE_TABLE_INDEX_BITS pointers per table).  0 disables the index.
+ */
+#define ROUTE_TABLE_INDEX_BITS 16
+#define ROUTE_TABLE_INDEX_THRESHOLD 16384
+
+extern void route_table_set_index_threshold(unsigned long count);
+ext_pure bool route_table_indexed(const struct route_table *table);
+
 extern struct route_node *route_node_create(route_table_delegate_t *delegate,
 					    struct route_table *table);
 extern void route_node_delete(struct route_node *node);
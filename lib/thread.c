@@ -77,8 +77,232 @@ pthread_key_t thread_current;
 static pthread_mutex_t masters_mtx = PTHREAD_MUTEX_INITIALIZER;
 static struct list *masters;
 
+#ifdef HAVE_EPOLL
+/* epoll_wait() result buffer size; level-triggered, so anything beyond this
+ * is simply picked up on the next iteration */
+#define THREAD_EPOLL_EVENTS 1024
+
+static bool thread_use_epoll = true;
+
+static inline bool thread_master_epoll(const struct thread_master *m)
+{
+	return m->handler.epoll_fd >= 0;
+}
+#endif
+
 static void thread_free(struct thread_master *master, struct thread *thread);
 
+/*
+ * Hierarchical timer wheel.
+ *
+ * Timers are hashed by their expiry (in msec, rounded up) into one of
+ * WHEEL_LEVELS wheels of WHEEL_SLOTS slots each; level n covers timers
+ * expiring within WHEEL_SLOTS^(n+1) msec.  Adding and cancelling a timer is
+ * O(1).  Whenever the lowest level wraps around, the next slot of the level
+ * above is "cascaded", i.e. its timers are redistributed to lower levels.
+ * A bitmap of non-empty slots per level lets us skip idle stretches and
+ * find the next expiry without looking at individual timers.
+ */
+DECLARE_DLIST(thread_wheel_list, struct thread, wheelitem)
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1U << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 6
+/* about 2 years; timers beyond this are parked at the far end and re-added
+ * when they get there */
+#define WHEEL_RANGE ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+struct thread_timer_wheel {
+	/* next tick (msec on the monotonic clock) to be processed */
+	uint64_t now;
+	/* number of timers on the wheel */
+	size_t count;
+	/* bit n is set if slots[level][n] is not empty */
+	uint64_t pending[WHEEL_LEVELS];
+	struct thread_wheel_list_head slots[WHEEL_LEVELS][WHEEL_SLOTS];
+};
+
+static bool thread_use_timer_wheel = true;
+
+static void thread_wheel_add(struct thread_timer_wheel *w,
+			     struct thread *thread)
+{
+	uint64_t tick = MAX(thread->wheel_tick, w->now);
+	uint64_t delta = tick - w->now;
+	unsigned int level, slot;
+
+	if (delta >= WHEEL_RANGE) {
+		delta = WHEEL_RANGE - 1;
+		tick = w->now + delta;
+	}
+
+	for (level = 0; level < WHEEL_LEVELS - 1; level++)
+		if (delta < ((uint64_t)1 << (WHEEL_BITS * (level + 1))))
+			break;
+
+	slot = (tick >> (WHEEL_BITS * level)) & WHEEL_MASK;
+	thread->wheel_slot = level * WHEEL_SLOTS + slot;
+	thread_wheel_list_add_tail(&w->slots[level][slot], thread);
+	w->pending[level] |= (uint64_t)1 << slot;
+	w->count++;
+}
+
+static void thread_wheel_del(struct thread_timer_wheel *w,
+			     struct thread *thread)
+{
+	unsigned int level = thread->wheel_slot / WHEEL_SLOTS;
+	unsigned int slot = thread->wheel_slot % WHEEL_SLOTS;
+
+	thread_wheel_list_del(&w->slots[level][slot], thread);
+	if (!thread_wheel_list_count(&w->slots[level][slot]))
+		w->pending[level] &= ~((uint64_t)1 << slot);
+	w->count--;
+}
+
+static void thread_wheel_cascade(struct thread_timer_wheel *w)
+{
+	struct thread_wheel_list_head *head;
+	struct thread *thread;
+	unsigned int level, slot;
+
+	for (level = 1; level < WHEEL_LEVELS; level++) {
+		slot = (w->now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+		head = &w->slots[level][slot];
+
+		while ((thread = thread_wheel_list_pop(head))) {
+			w->count--;
+			thread_wheel_add(w, thread);
+		}
+		w->pending[level] &= ~((uint64_t)1 << slot);
+
+		/* the level above only moves when this one wraps around */
+		if (slot)
+			break;
+	}
+}
+
+/* Earliest tick at which something may be due; false if the wheel is empty */
+static bool thread_wheel_next(struct thread_timer_wheel *w, uint64_t *next)
+{
+	uint64_t best = UINT64_MAX, base, rot;
+	unsigned int level, shift, idx;
+
+	if (!w->count)
+		return false;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		if (!w->pending[level])
+			continue;
+
+		/* on upper levels, the current slot only holds timers for the
+		 * next time around - unless we stopped right on the boundary
+		 * and it is yet to be cascaded */
+		shift = WHEEL_BITS * level;
+		base = w->now >> shift;
+		if (w->now & (((uint64_t)1 << shift) - 1))
+			base++;
+		idx = base & WHEEL_MASK;
+		rot = w->pending[level] >> idx;
+		if (idx)
+			rot |= w->pending[level] << (WHEEL_SLOTS - idx);
+
+		best = MIN(best, (base + __builtin_ctzll(rot)) << shift);
+	}
+
+	*next = best;
+	return true;
+}
+
+/* Move all timers due by timenow to the ready list. */
+static unsigned int thread_wheel_process(struct thread_master *m,
+					 const struct timeval *timenow)
+{
+	struct thread_timer_wheel *w = m->wheel;
+	struct thread_wheel_list_head *head;
+	struct thread *thread;
+	uint64_t target, later;
+	unsigned int slot, ready = 0;
+
+	target = (uint64_t)timenow->tv_sec * 1000 + timenow->tv_usec / 1000;
+
+	while (w->now <= target) {
+		if (!w->count) {
+			w->now = target + 1;
+			break;
+		}
+
+		slot = w->now & WHEEL_MASK;
+		if (!slot)
+			thread_wheel_cascade(w);
+
+		head = &w->slots[0][slot];
+		while ((thread = thread_wheel_list_pop(head))) {
+			w->count--;
+			if (thread->wheel_tick > w->now) {
+				/* parked beyond WHEEL_RANGE */
+				thread_wheel_add(w, thread);
+				continue;
+			}
+			/* the heap is otherwise unused with a wheel; borrow it
+			 * to run timers in the same slot by their exact sands */
+			thread_timer_list_add(&m->timer, thread);
+		}
+		w->pending[0] &= ~((uint64_t)1 << slot);
+
+		/* skip ahead to the next busy slot or the end of this round,
+		 * but never past the current time */
+		later = w->pending[0] & ~(((uint64_t)2 << slot) - 1);
+		if (later)
+			w->now += __builtin_ctzll(later) - slot;
+		else
+			w->now += WHEEL_SLOTS - slot;
+		w->now = MIN(w->now, target + 1);
+	}
+
+	while ((thread = thread_timer_list_pop(&m->timer))) {
+		thread->type = THREAD_READY;
+		thread_list_add_tail(&m->ready, thread);
+		ready++;
+	}
+
+	return ready;
+}
+
+static void thread_timer_add(struct thread_master *m, struct thread *thread)
+{
+	if (m->wheel) {
+		/* round up, a timer must never fire early */
+		thread->wheel_tick = (uint64_t)thread->u.sands.tv_sec * 1000
+				     + (thread->u.sands.tv_usec + 999) / 1000;
+		thread_wheel_add(m->wheel, thread);
+	} else
+		thread_timer_list_add(&m->timer, thread);
+}
+
+static void thread_timer_del(struct thread_master *m, struct thread *thread)
+{
+	if (m->wheel)
+		thread_wheel_del(m->wheel, thread);
+	else
+		thread_timer_list_del(&m->timer, thread);
+}
+
+static void thread_wheel_free(struct thread_master *m)
+{
+	struct thread *thread;
+	unsigned int level, slot;
+
+	for (level = 0; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			while ((thread = thread_wheel_list_pop(
+					&m->wheel->slots[level][slot])))
+				thread_free(m, thread);
+
+	XFREE(MTYPE_THREAD_MASTER, m->wheel);
+}
+
+
 /* CLI start ---------------------------------------------------------------- */
 static unsigned int cpu_record_hash_key(const struct cpu_thread_history *a)
 {
@@ -317,11 +541,40 @@ DEFUN (show_thread_cpu,
 }
 #endif
 
+static void show_thread_poll_fd(struct vty *vty, struct thread_master *m,
+				uint32_t i, int fd, short events,
+				short revents)
+{
+	struct thread *thread;
+
+	vty_out(vty, "\t%6d fd:%6d events:%2d revents:%2d\t\t", i, fd, events,
+		revents);
+
+	if (events & POLLIN) {
+		thread = m->read[fd];
+
+		if (!thread)
+			vty_out(vty, "ERROR ");
+		else
+			vty_out(vty, "%s ", thread->funcname);
+	} else
+		vty_out(vty, " ");
+
+	if (events & POLLOUT) {
+		thread = m->write[fd];
+
+		if (!thread)
+			vty_out(vty, "ERROR\n");
+		else
+			vty_out(vty, "%s\n", thread->funcname);
+	} else
+		vty_out(vty, "\n");
+}
+
 static void show_thread_poll_helper(struct vty *vty, struct thread_master *m)
 {
 	const char *name = m->name ? m->name : "main";
 	char underline[strlen(name) + 1];
-	struct thread *thread;
 	uint32_t i;
 
 	memset(underline, '-', sizeof(underline));
@@ -329,33 +582,36 @@ static void show_thread_poll_helper(struct vty *vty, struct thread_master *m)
 
 	vty_out(vty, "\nShowing poll FD's for %s\n", name);
 	vty_out(vty, "----------------------%s\n", underline);
-	vty_out(vty, "Count: %u/%d\n", (uint32_t)m->handler.pfdcount,
-		m->fd_limit);
-	for (i = 0; i < m->handler.pfdcount; i++) {
-		vty_out(vty, "\t%6d fd:%6d events:%2d revents:%2d\t\t", i,
-			m->handler.pfds[i].fd, m->handler.pfds[i].events,
-			m->handler.pfds[i].revents);
-
-		if (m->handler.pfds[i].events & POLLIN) {
-			thread = m->read[m->handler.pfds[i].fd];
 
-			if (!thread)
-				vty_out(vty, "ERROR ");
-			else
-				vty_out(vty, "%s ", thread->funcname);
-		} else
-			vty_out(vty, " ");
+#ifdef HAVE_EPOLL
+	if (thread_master_epoll(m)) {
+		uint32_t mask;
+		int fd;
 
-		if (m->handler.pfds[i].events & POLLOUT) {
-			thread = m->write[m->handler.pfds[i].fd];
+		vty_out(vty, "Count: %u/%d (epoll)\n",
+			(uint32_t)m->handler.pfdcount, m->fd_limit);
+		for (i = 0, fd = 0; fd < m->fd_limit; fd++) {
+			mask = m->handler.epoll_mask[fd];
+			if (!mask)
+				continue;
 
-			if (!thread)
-				vty_out(vty, "ERROR\n");
-			else
-				vty_out(vty, "%s\n", thread->funcname);
-		} else
-			vty_out(vty, "\n");
+			show_thread_poll_fd(vty, m, i++, fd,
+					    ((mask & EPOLLIN) ? POLLIN : 0)
+						    | ((mask & EPOLLOUT)
+							       ? POLLOUT
+							       : 0),
+					    0);
+		}
+		return;
 	}
+#endif
+
+	vty_out(vty, "Count: %u/%d\n", (uint32_t)m->handler.pfdcount,
+		m->fd_limit);
+	for (i = 0; i < m->handler.pfdcount; i++)
+		show_thread_poll_fd(vty, m, i, m->handler.pfds[i].fd,
+				    m->handler.pfds[i].events,
+				    m->handler.pfds[i].revents);
 }
 
 DEFUN (show_thread_poll,
@@ -426,6 +682,143 @@ static void initializer(void)
 	pthread_key_create(&thread_current, NULL);
 }
 
+void thread_master_set_epoll(bool enable)
+{
+#ifdef HAVE_EPOLL
+	thread_use_epoll = enable;
+#endif
+}
+
+void thread_master_set_timer_wheel(bool enable)
+{
+	thread_use_timer_wheel = enable;
+}
+
+#ifdef HAVE_EPOLL
+static void thread_master_epoll_init(struct thread_master *m)
+{
+	struct epoll_event ev = {};
+
+	m->handler.epoll_fd = -1;
+
+	if (!thread_use_epoll)
+		return;
+
+	m->handler.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (m->handler.epoll_fd < 0) {
+		flog_err(EC_LIB_SYSTEM_CALL,
+			 "epoll_create1() failed, falling back to poll(): %s",
+			 safe_strerror(errno));
+		return;
+	}
+
+	/* the pipe poker stays registered for the lifetime of the master */
+	ev.events = EPOLLIN;
+	ev.data.fd = m->io_pipe[0];
+	if (epoll_ctl(m->handler.epoll_fd, EPOLL_CTL_ADD, m->io_pipe[0], &ev)
+	    < 0) {
+		flog_err(EC_LIB_SYSTEM_CALL,
+			 "epoll_ctl() failed, falling back to poll(): %s",
+			 safe_strerror(errno));
+		close(m->handler.epoll_fd);
+		m->handler.epoll_fd = -1;
+		return;
+	}
+
+	m->handler.epoll_mask =
+		XCALLOC(MTYPE_THREAD_POLL, sizeof(uint32_t) * m->fd_limit);
+	m->handler.epoll_registered =
+		XCALLOC(MTYPE_THREAD_POLL, sizeof(bool) * m->fd_limit);
+	m->handler.epoll_eventsize = MIN(m->fd_limit, THREAD_EPOLL_EVENTS);
+	m->handler.epoll_events =
+		XCALLOC(MTYPE_THREAD_POLL, sizeof(struct epoll_event)
+						   * m->handler.epoll_eventsize);
+}
+
+/**
+ * Bring the kernel's epoll registration for an fd in line with the read and
+ * write tasks scheduled on it.
+ *
+ * fds are registered EPOLLONESHOT and stay in the epoll set once added;
+ * re-arming after an event has fired is a single EPOLL_CTL_MOD.  Only
+ * close() removes an fd from the set.
+ *
+ * The cached registration state is only updated once the kernel has
+ * accepted the change, so a failed call leaves it describing what the
+ * kernel still has armed.  Failures other than EPERM (fds that epoll does
+ * not support) are logged here.
+ *
+ * @REQUIRE m->mtx
+ * @return 0 on success, -1 with errno set if the fd could not be registered
+ */
+static int thread_epoll_sync(struct thread_master *m, int fd)
+{
+	struct epoll_event ev = {};
+	uint32_t old = m->handler.epoll_mask[fd];
+	uint32_t events = 0;
+	int op, ret, err;
+
+	if (m->read[fd])
+		events |= EPOLLIN;
+	if (m->write[fd])
+		events |= EPOLLOUT;
+
+	if (events == old)
+		return 0;
+
+	/*
+	 * Disarming still needs EPOLLONESHOT, errors and hangups are always
+	 * reported and would otherwise fire on every epoll_wait().
+	 */
+	ev.events = events | EPOLLONESHOT;
+	ev.data.fd = fd;
+
+	op = m->handler.epoll_registered[fd] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	ret = epoll_ctl(m->handler.epoll_fd, op, fd, &ev);
+
+	/*
+	 * Closing an fd silently drops it from the epoll set, so our view
+	 * can be stale if the fd was closed (and possibly reused) while it
+	 * was registered, or if it was registered behind our back.  Retry
+	 * with the other operation; disarming an fd that is already gone is
+	 * fine.
+	 */
+	if (ret < 0 && op == EPOLL_CTL_ADD && errno == EEXIST) {
+		op = EPOLL_CTL_MOD;
+		ret = epoll_ctl(m->handler.epoll_fd, op, fd, &ev);
+	} else if (ret < 0 && op == EPOLL_CTL_MOD && errno == ENOENT) {
+		m->handler.epoll_registered[fd] = false;
+		if (events) {
+			op = EPOLL_CTL_ADD;
+			ret = epoll_ctl(m->handler.epoll_fd, op, fd, &ev);
+		} else
+			ret = 0;
+	}
+
+	if (ret < 0) {
+		err = errno;
+		if (err != EPERM)
+			flog_err(EC_LIB_SYSTEM_CALL,
+				 "epoll_ctl(%s) failed for fd %d: %s",
+				 op == EPOLL_CTL_ADD ? "ADD" : "MOD", fd,
+				 safe_strerror(err));
+		errno = err;
+		return -1;
+	}
+
+	if (events)
+		m->handler.epoll_registered[fd] = true;
+
+	if (!old && events)
+		m->handler.pfdcount++;
+	else if (old && !events)
+		m->handler.pfdcount--;
+	m->handler.epoll_mask[fd] = events;
+
+	return ret;
+}
+#endif
+
 struct thread_master *thread_master_create(const char *name)
 {
 	struct thread_master *rv;
@@ -460,6 +853,20 @@ struct thread_master *thread_master_create(const char *name)
 	thread_list_init(&rv->ready);
 	thread_list_init(&rv->unuse);
 	thread_timer_list_init(&rv->timer);
+	if (thread_use_timer_wheel) {
+		struct timeval now;
+		unsigned int level, slot;
+
+		rv->wheel = XCALLOC(MTYPE_THREAD_MASTER, sizeof(*rv->wheel));
+		for (level = 0; level < WHEEL_LEVELS; level++)
+			for (slot = 0; slot < WHEEL_SLOTS; slot++)
+				thread_wheel_list_init(
+					&rv->wheel->slots[level][slot]);
+
+		monotime(&now);
+		rv->wheel->now = (uint64_t)now.tv_sec * 1000
+				 + now.tv_usec / 1000;
+	}
 
 	/* Initialize thread_fetch() settings */
 	rv->spin = true;
@@ -484,6 +891,10 @@ struct thread_master *thread_master_create(const char *name)
 	rv->handler.copy = XCALLOC(MTYPE_THREAD_MASTER,
 				   sizeof(struct pollfd) * rv->handler.pfdsize);
 
+#ifdef HAVE_EPOLL
+	thread_master_epoll_init(rv);
+#endif
+
 	/* add to list of threadmasters */
 	frr_with_mutex(&masters_mtx) {
 		if (!masters)
@@ -586,6 +997,8 @@ void thread_master_free(struct thread_master *m)
 	thread_array_free(m, m->write);
 	while ((t = thread_timer_list_pop(&m->timer)))
 		thread_free(m, t);
+	if (m->wheel)
+		thread_wheel_free(m);
 	thread_list_free(m, &m->event);
 	thread_list_free(m, &m->ready);
 	thread_list_free(m, &m->unuse);
@@ -593,6 +1006,13 @@ void thread_master_free(struct thread_master *m)
 	pthread_cond_destroy(&m->cancel_cond);
 	close(m->io_pipe[0]);
 	close(m->io_pipe[1]);
+#ifdef HAVE_EPOLL
+	if (thread_master_epoll(m))
+		close(m->handler.epoll_fd);
+	XFREE(MTYPE_THREAD_POLL, m->handler.epoll_mask);
+	XFREE(MTYPE_THREAD_POLL, m->handler.epoll_registered);
+	XFREE(MTYPE_THREAD_POLL, m->handler.epoll_events);
+#endif
 	list_delete(&m->cancel_req);
 	m->cancel_req = NULL;
 
@@ -695,8 +1115,8 @@ static void thread_free(struct thread_master *master, struct thread *thread)
 	XFREE(MTYPE_THREAD, thread);
 }
 
-static int fd_poll(struct thread_master *m, struct pollfd *pfds, nfds_t pfdsize,
-		   nfds_t count, const struct timeval *timer_wait)
+static int fd_poll_timeout(struct thread_master *m,
+			   const struct timeval *timer_wait)
 {
 	/* If timer_wait is null here, that means poll() should block
 	 * indefinitely,
@@ -711,9 +1131,6 @@ static int fd_poll(struct thread_master *m, struct pollfd *pfds, nfds_t pfdsize,
 	 * zero, the behavior is default. */
 	int timeout = -1;
 
-	/* number of file descriptors with events */
-	int num;
-
 	if (timer_wait != NULL
 	    && m->selectpoll_timeout == 0) // use the default value
 		timeout = (timer_wait->tv_sec * 1000)
@@ -724,6 +1141,17 @@ static int fd_poll(struct thread_master *m, struct pollfd *pfds, nfds_t pfdsize,
 		 < 0) // effect a poll (return immediately)
 		timeout = 0;
 
+	return timeout;
+}
+
+static int fd_poll(struct thread_master *m, struct pollfd *pfds, nfds_t pfdsize,
+		   nfds_t count, const struct timeval *timer_wait)
+{
+	int timeout = fd_poll_timeout(m, timer_wait);
+
+	/* number of file descriptors with events */
+	int num;
+
 	zlog_tls_buffer_flush();
 	rcu_read_unlock();
 	rcu_assert_read_unlocked();
@@ -746,6 +1174,25 @@ static int fd_poll(struct thread_master *m, struct pollfd *pfds, nfds_t pfdsize,
 	return num;
 }
 
+#ifdef HAVE_EPOLL
+static int fd_epoll(struct thread_master *m, const struct timeval *timer_wait)
+{
+	int timeout = fd_poll_timeout(m, timer_wait);
+	int num;
+
+	zlog_tls_buffer_flush();
+	rcu_read_unlock();
+	rcu_assert_read_unlocked();
+
+	num = epoll_wait(m->handler.epoll_fd, m->handler.epoll_events,
+			 m->handler.epoll_eventsize, timeout);
+
+	rcu_read_lock();
+
+	return num;
+}
+#endif
+
 /* Add new read thread. */
 struct thread *funcname_thread_add_read_write(int dir, struct thread_master *m,
 					      int (*func)(struct thread *),
@@ -762,6 +1209,42 @@ struct thread *funcname_thread_add_read_write(int dir, struct thread_master *m,
 			// thread is already scheduled; don't reschedule
 			break;
 
+#ifdef HAVE_EPOLL
+		if (thread_master_epoll(m)) {
+			thread_array = (dir == THREAD_READ) ? m->read : m->write;
+
+#ifdef DEV_BUILD
+			if (thread_array[fd])
+				assert(!"Thread already scheduled for file descriptor");
+#endif
+			thread = thread_get(m, dir, func, arg, debugargpass);
+
+			frr_with_mutex(&thread->mtx) {
+				thread->u.fd = fd;
+				thread_array[fd] = thread;
+			}
+
+			/*
+			 * epoll refuses fds that poll() considers always
+			 * ready (regular files, /dev/null & co.), so treat
+			 * them the way poll() would.
+			 */
+			if (thread_epoll_sync(m, fd) < 0) {
+				thread_array[fd] = NULL;
+				thread->type = THREAD_READY;
+				thread_list_add_tail(&m->ready, thread);
+			}
+
+			if (t_ptr) {
+				*t_ptr = thread;
+				thread->ref = t_ptr;
+			}
+
+			AWAKEN(m);
+			break;
+		}
+#endif
+
 		/* default to a new pollfd */
 		nfds_t queuepos = m->handler.pfdcount;
 
@@ -841,7 +1324,7 @@ funcname_thread_add_timer_timeval(struct thread_master *m,
 			monotime(&thread->u.sands);
 			timeradd(&thread->u.sands, time_relative,
 				 &thread->u.sands);
-			thread_timer_list_add(&m->timer, thread);
+			thread_timer_add(m, thread);
 			if (t_ptr) {
 				*t_ptr = thread;
 				thread->ref = t_ptr;
@@ -952,6 +1435,17 @@ static void thread_cancel_rw(struct thread_master *master, int fd, short state)
 {
 	bool found = false;
 
+#ifdef HAVE_EPOLL
+	if (thread_master_epoll(master)) {
+		if (state & POLLIN)
+			master->read[fd] = NULL;
+		if (state & POLLOUT)
+			master->write[fd] = NULL;
+		thread_epoll_sync(master, fd);
+		return;
+	}
+#endif
+
 	/* Cancel POLLHUP too just in case some bozo set it */
 	state |= POLLHUP;
 
@@ -1068,7 +1562,7 @@ static void do_thread_cancel(struct thread_master *master)
 			thread_array = master->write;
 			break;
 		case THREAD_TIMER:
-			thread_timer_list_del(&master->timer, thread);
+			thread_timer_del(master, thread);
 			break;
 		case THREAD_EVENT:
 			list = &master->event;
@@ -1196,13 +1690,26 @@ void thread_cancel_async(struct thread_master *master, struct thread **thread,
 }
 /* ------------------------------------------------------------------------- */
 
-static struct timeval *thread_timer_wait(struct thread_timer_list_head *timers,
+static struct timeval *thread_timer_wait(struct thread_master *m,
 					 struct timeval *timer_val)
 {
-	if (!thread_timer_list_count(timers))
+	if (m->wheel) {
+		struct timeval next;
+		uint64_t tick;
+
+		if (!thread_wheel_next(m->wheel, &tick))
+			return NULL;
+
+		next.tv_sec = tick / 1000;
+		next.tv_usec = (tick % 1000) * 1000;
+		monotime_until(&next, timer_val);
+		return timer_val;
+	}
+
+	if (!thread_timer_list_count(&m->timer))
 		return NULL;
 
-	struct thread *next_timer = thread_timer_list_first(timers);
+	struct thread *next_timer = thread_timer_list_first(&m->timer);
 	monotime_until(&next_timer->u.sands, timer_val);
 	return timer_val;
 }
@@ -1237,7 +1744,7 @@ static int thread_process_io_helper(struct thread_master *m,
 	if (!thread) {
 		if ((actual_state & (POLLHUP|POLLIN)) != POLLHUP)
 			flog_err(EC_LIB_NO_THREAD,
-				 "Attempting to process an I/O event but for fd: %d(%d) no thread to handle this!\n",
+				 "Attempting to process an I/O event but for fd: %d(%d) no thread to handle this!",
 				 m->handler.pfds[pos].fd, actual_state);
 		return 0;
 	}
@@ -1317,17 +1824,89 @@ static void thread_process_io(struct thread_master *m, unsigned int num)
 	}
 }
 
+#ifdef HAVE_EPOLL
+/**
+ * Process I/O events returned by epoll_wait().
+ *
+ * Tasks that fired are moved to the ready queue, matching the one-shot
+ * semantics of the poll() backend.  The kernel has already disarmed the fd
+ * (EPOLLONESHOT); it is only re-armed if another task is still waiting on it.
+ *
+ * @param m the thread master
+ * @param num the number of events (return value of epoll_wait())
+ */
+static void thread_process_io_epoll(struct thread_master *m, int num)
+{
+	struct epoll_event *ev;
+	struct thread *thread;
+	bool handled;
+	int i, fd;
+
+	for (i = 0; i < num; i++) {
+		ev = &m->handler.epoll_events[i];
+		fd = ev->data.fd;
+		handled = false;
+
+		if (fd == m->io_pipe[0]) {
+			unsigned char trash[64];
+
+			while (read(m->io_pipe[0], &trash, sizeof(trash)) > 0)
+				;
+			continue;
+		}
+
+		if (m->handler.epoll_mask[fd]) {
+			m->handler.epoll_mask[fd] = 0;
+			m->handler.pfdcount--;
+		}
+
+		/*
+		 * Errors and hangups can't be masked out of the epoll set,
+		 * so wake up whoever is waiting on the fd to deal with them.
+		 */
+		if (ev->events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+			thread = m->read[fd];
+			if (thread) {
+				m->read[fd] = NULL;
+				thread_list_add_tail(&m->ready, thread);
+				thread->type = THREAD_READY;
+				handled = true;
+			}
+		}
+		if (ev->events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+			thread = m->write[fd];
+			if (thread) {
+				m->write[fd] = NULL;
+				thread_list_add_tail(&m->ready, thread);
+				thread->type = THREAD_READY;
+				handled = true;
+			}
+		}
+
+		if (!handled && (ev->events & (EPOLLIN | EPOLLOUT)))
+			flog_err(EC_LIB_NO_THREAD,
+				 "Attempting to process an I/O event but for fd: %d(%u) no thread to handle this!",
+				 fd, ev->events);
+
+		thread_epoll_sync(m, fd);
+	}
+}
+#endif
+
 /* Add all timers that have popped to the ready list. */
-static unsigned int thread_process_timers(struct thread_timer_list_head *timers,
+static unsigned int thread_process_timers(struct thread_master *m,
 					  struct timeval *timenow)
 {
 	struct thread *thread;
 	unsigned int ready = 0;
 
-	while ((thread = thread_timer_list_first(timers))) {
+	if (m->wheel)
+		return thread_wheel_process(m, timenow);
+
+	while ((thread = thread_timer_list_first(&m->timer))) {
 		if (timercmp(timenow, &thread->u.sands, <))
 			return ready;
-		thread_timer_list_pop(timers);
+		thread_timer_list_pop(&m->timer);
 		thread->type = THREAD_READY;
 		thread_list_add_tail(&thread->master->ready, thread);
 		ready++;
@@ -1409,7 +1988,7 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 		 * once per loop to avoid starvation by events
 		 */
 		if (!thread_list_count(&m->ready))
-			tw = thread_timer_wait(&m->timer, &tv);
+			tw = thread_timer_wait(m, &tv);
 
 		if (thread_list_count(&m->ready) ||
 				(tw && !timercmp(tw, &zerotime, >)))
@@ -1421,20 +2000,27 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 			break;
 		}
 
-		/*
-		 * Copy pollfd array + # active pollfds in it. Not necessary to
-		 * copy the array size as this is fixed.
-		 */
-		m->handler.copycount = m->handler.pfdcount;
-		memcpy(m->handler.copy, m->handler.pfds,
-		       m->handler.copycount * sizeof(struct pollfd));
-
-		pthread_mutex_unlock(&m->mtx);
+#ifdef HAVE_EPOLL
+		if (thread_master_epoll(m)) {
+			pthread_mutex_unlock(&m->mtx);
+			num = fd_epoll(m, tw);
+			pthread_mutex_lock(&m->mtx);
+		} else
+#endif
 		{
+			/*
+			 * Copy pollfd array + # active pollfds in it. Not
+			 * necessary to copy the array size as this is fixed.
+			 */
+			m->handler.copycount = m->handler.pfdcount;
+			memcpy(m->handler.copy, m->handler.pfds,
+			       m->handler.copycount * sizeof(struct pollfd));
+
+			pthread_mutex_unlock(&m->mtx);
 			num = fd_poll(m, m->handler.copy, m->handler.pfdsize,
 				      m->handler.copycount, tw);
+			pthread_mutex_lock(&m->mtx);
 		}
-		pthread_mutex_lock(&m->mtx);
 
 		/* Handle any errors received in poll() */
 		if (num < 0) {
@@ -1454,9 +2040,14 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 
 		/* Post timers to ready queue. */
 		monotime(&now);
-		thread_process_timers(&m->timer, &now);
+		thread_process_timers(m, &now);
 
 		/* Post I/O to ready queue. */
+#ifdef HAVE_EPOLL
+		if (num > 0 && thread_master_epoll(m))
+			thread_process_io_epoll(m, num);
+		else
+#endif
 		if (num > 0)
 			thread_process_io(m, num);
 
@@ -24,6 +24,9 @@
 #include <zebra.h>
 #include <pthread.h>
 #include <poll.h>
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
 #include "monotime.h"
 #include "frratomic.h"
 #include "typesafe.h"
@@ -42,6 +45,9 @@ struct rusage_t {
 
 PREDECL_LIST(thread_list)
 PREDECL_HEAP(thread_timer_list)
+PREDECL_DLIST(thread_wheel_list)
+
+struct thread_timer_wheel;
 
 struct fd_handler {
 	/* number of pfd that fit in the allocated space of pfds. This is a
@@ -58,6 +64,21 @@ struct fd_handler {
 	struct pollfd *copy;
 	/* number of pollfds stored in copy */
 	nfds_t copycount;
+
+#ifdef HAVE_EPOLL
+	/* epoll instance; -1 if this thread_master uses poll() instead.
+	 * In epoll mode, pfdcount is the number of fds registered with the
+	 * kernel and pfds/copy are not used. */
+	int epoll_fd;
+	/* events currently armed in the kernel, indexed by fd; fds are
+	 * registered EPOLLONESHOT, so this drops to 0 when an event fires */
+	uint32_t *epoll_mask;
+	/* fd is in the epoll set (possibly disarmed), re-arm with MOD */
+	bool *epoll_registered;
+	/* buffer for epoll_wait() results */
+	struct epoll_event *epoll_events;
+	int epoll_eventsize;
+#endif
 };
 
 struct cancel_req {
@@ -73,6 +94,8 @@ struct thread_master {
 	struct thread **read;
 	struct thread **write;
 	struct thread_timer_list_head timer;
+	/* if non-NULL, timers are kept here instead of in the heap above */
+	struct thread_timer_wheel *wheel;
 	struct thread_list_head event, ready, unuse;
 	struct list *cancel_req;
 	bool canceled;
@@ -95,6 +118,9 @@ struct thread {
 	uint8_t add_type;	  /* thread type */
 	struct thread_list_item threaditem;
 	struct thread_timer_list_item timeritem;
+	struct thread_wheel_list_item wheelitem;
+	uint64_t wheel_tick;  /* expiry in msec, if on a timer wheel */
+	uint16_t wheel_slot;  /* level and slot on the timer wheel */
 	struct thread **ref;	  /* external reference (if given) */
 	struct thread_master *master; /* pointer to the struct thread_master */
 	int (*func)(struct thread *); /* event function */
@@ -171,6 +197,12 @@ struct cpu_thread_history {
 
 /* Prototypes. */
 extern struct thread_master *thread_master_create(const char *);
+/* select epoll() (default, if available) or poll() for I/O on thread_masters
+ * created after this call */
+extern void thread_master_set_epoll(bool enable);
+/* select the timer wheel (default) or the heap for timers on thread_masters
+ * created after this call */
+extern void thread_master_set_timer_wheel(bool enable);
 void thread_master_set_name(struct thread_master *master, const char *name);
 extern void thread_master_free(struct thread_master *);
 extern void thread_master_free_unused(struct thread_master *);
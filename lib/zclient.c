@@ -958,12 +958,10 @@ done:
 	return ret;
 }
 
-int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
+/* Encodes the part of a zapi_route before the prefix. */
+static int zapi_route_encode_head(uint8_t cmd, struct stream *s,
+				  struct zapi_route *api)
 {
-	struct zapi_nexthop *api_nh;
-	int i;
-	int psize;
-
 	stream_reset(s);
 	zclient_create_header(s, cmd, api->vrf_id);
 
@@ -987,17 +985,15 @@ int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
 	}
 	stream_putc(s, api->safi);
 
-	/* Put prefix information. */
-	stream_putc(s, api->prefix.family);
-	psize = PSIZE(api->prefix.prefixlen);
-	stream_putc(s, api->prefix.prefixlen);
-	stream_write(s, &api->prefix.u.prefix, psize);
+	return 0;
+}
 
-	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
-		psize = PSIZE(api->src_prefix.prefixlen);
-		stream_putc(s, api->src_prefix.prefixlen);
-		stream_write(s, (uint8_t *)&api->src_prefix.prefix, psize);
-	}
+/* Encodes the nexthops and attributes of a zapi_route. */
+static int zapi_route_encode_nexthops(struct stream *s,
+				      struct zapi_route *api)
+{
+	struct zapi_nexthop *api_nh;
+	int i;
 
 	/* Nexthops.  */
 	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP)) {
@@ -1099,9 +1095,122 @@ int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
 	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_TABLEID))
 		stream_putl(s, api->tableid);
 
+	return 0;
+}
+
+int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
+{
+	int psize;
+
+	if (zapi_route_encode_head(cmd, s, api) < 0)
+		return -1;
+
+	/* Put prefix information. */
+	stream_putc(s, api->prefix.family);
+	psize = PSIZE(api->prefix.prefixlen);
+	stream_putc(s, api->prefix.prefixlen);
+	stream_write(s, &api->prefix.u.prefix, psize);
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		psize = PSIZE(api->src_prefix.prefixlen);
+		stream_putc(s, api->src_prefix.prefixlen);
+		stream_write(s, (uint8_t *)&api->src_prefix.prefix, psize);
+	}
+
+	if (zapi_route_encode_nexthops(s, api) < 0)
+		return -1;
+
+	/* Put length at the first point of the stream. */
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	return 0;
+}
+
+/*
+ * Encodes routes which differ in nothing but their prefix: the route type,
+ * flags, nexthops and attributes are encoded once, followed by the list of
+ * prefixes, as many as fit into the stream.
+ *
+ *  0 1 2 3 4 5 6 7 8 9 A B C D E F 0 1 2 3 4 5 6 7 8 9 A B C D E F
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | Header up to SAFI, nexthops and attributes as zapi_route_encode() |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |       Prefix count (2)        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |    Family     | Prefix length | Prefix ...                    |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ * Source prefixes and EVPN routes can't be batched.
+ *
+ * Returns the number of prefixes encoded, or -1 on error.
+ */
+int zapi_route_batch_encode(uint8_t cmd, struct stream *s,
+			    struct zapi_route *api,
+			    const struct prefix *prefixes, uint16_t count)
+{
+	size_t countp;
+	uint16_t i;
+	int psize;
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: source prefixes can't be batched", __func__);
+		return -1;
+	}
+
+	if (CHECK_FLAG(api->flags, ZEBRA_FLAG_EVPN_ROUTE)) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: EVPN routes can't be batched", __func__);
+		return -1;
+	}
+
+	if (zapi_route_encode_head(cmd, s, api) < 0
+	    || zapi_route_encode_nexthops(s, api) < 0)
+		return -1;
+
+	countp = stream_get_endp(s);
+	stream_putw(s, 0);
+
+	for (i = 0; i < count; i++) {
+		psize = PSIZE(prefixes[i].prefixlen);
+		if (STREAM_WRITEABLE(s) < (size_t)psize + 2)
+			break;
+
+		stream_putc(s, prefixes[i].family);
+		stream_putc(s, prefixes[i].prefixlen);
+		stream_write(s, &prefixes[i].u.prefix, psize);
+	}
+
+	stream_putw_at(s, countp, i);
+
 	/* Put length at the first point of the stream. */
 	stream_putw_at(s, 0, stream_get_endp(s));
 
+	return i;
+}
+
+/*
+ * Sends routes which differ in nothing but their prefix, in as few messages
+ * as possible.
+ */
+int zclient_route_batch_send(uint8_t cmd, struct zclient *zclient,
+			     struct zapi_route *api,
+			     const struct prefix *prefixes, uint32_t count)
+{
+	uint32_t done = 0;
+	int n;
+
+	while (done < count) {
+		n = zapi_route_batch_encode(cmd, zclient->obuf, api,
+					    prefixes + done,
+					    MIN(count - done, UINT16_MAX));
+		if (n <= 0)
+			return -1;
+		if (zclient_send_message(zclient) < 0)
+			return -1;
+		done += n;
+	}
+
 	return 0;
 }
 
@@ -1174,11 +1283,9 @@ stream_failure:
 	return ret;
 }
 
-int zapi_route_decode(struct stream *s, struct zapi_route *api)
+/* Decodes the part of a zapi_route before the prefix. */
+static int zapi_route_decode_head(struct stream *s, struct zapi_route *api)
 {
-	struct zapi_nexthop *api_nh;
-	int i;
-
 	memset(api, 0, sizeof(*api));
 
 	/* Type, flags, message. */
@@ -1201,58 +1308,53 @@ int zapi_route_decode(struct stream *s, struct zapi_route *api)
 		return -1;
 	}
 
-	/* Prefix. */
-	STREAM_GETC(s, api->prefix.family);
-	STREAM_GETC(s, api->prefix.prefixlen);
-	switch (api->prefix.family) {
+	return 0;
+stream_failure:
+	return -1;
+}
+
+static int zapi_route_decode_prefix(struct stream *s, struct prefix *p)
+{
+	STREAM_GETC(s, p->family);
+	STREAM_GETC(s, p->prefixlen);
+	switch (p->family) {
 	case AF_INET:
-		if (api->prefix.prefixlen > IPV4_MAX_PREFIXLEN) {
+		if (p->prefixlen > IPV4_MAX_PREFIXLEN) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: V4 prefixlen is %d which should not be more than 32",
-				__func__, api->prefix.prefixlen);
+				__func__, p->prefixlen);
 			return -1;
 		}
 		break;
 	case AF_INET6:
-		if (api->prefix.prefixlen > IPV6_MAX_PREFIXLEN) {
+		if (p->prefixlen > IPV6_MAX_PREFIXLEN) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: v6 prefixlen is %d which should not be more than 128",
-				__func__, api->prefix.prefixlen);
+				__func__, p->prefixlen);
 			return -1;
 		}
 		break;
 	default:
 		flog_err(EC_LIB_ZAPI_ENCODE,
 			 "%s: Specified family %d is not v4 or v6", __func__,
-			 api->prefix.family);
+			 p->family);
 		return -1;
 	}
-	STREAM_GET(&api->prefix.u.prefix, s, PSIZE(api->prefix.prefixlen));
+	STREAM_GET(&p->u.prefix, s, PSIZE(p->prefixlen));
 
-	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
-		api->src_prefix.family = AF_INET6;
-		STREAM_GETC(s, api->src_prefix.prefixlen);
-		if (api->src_prefix.prefixlen > IPV6_MAX_PREFIXLEN) {
-			flog_err(
-				EC_LIB_ZAPI_ENCODE,
-				"%s: SRC Prefix prefixlen received: %d is too large",
-				__func__, api->src_prefix.prefixlen);
-			return -1;
-		}
-		STREAM_GET(&api->src_prefix.prefix, s,
-			   PSIZE(api->src_prefix.prefixlen));
+	return 0;
+stream_failure:
+	return -1;
+}
 
-		if (api->prefix.family != AF_INET6
-		    || api->src_prefix.prefixlen == 0) {
-			flog_err(
-				EC_LIB_ZAPI_ENCODE,
-				"%s: SRC prefix specified in some manner that makes no sense",
-				__func__);
-			return -1;
-		}
-	}
+/* Decodes the nexthops and attributes of a zapi_route. */
+static int zapi_route_decode_nexthops(struct stream *s,
+				      struct zapi_route *api)
+{
+	struct zapi_nexthop *api_nh;
+	int i;
 
 	/* Nexthops. */
 	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP)) {
@@ -1307,6 +1409,75 @@ stream_failure:
 	return -1;
 }
 
+int zapi_route_decode(struct stream *s, struct zapi_route *api)
+{
+	if (zapi_route_decode_head(s, api) < 0)
+		return -1;
+
+	/* Prefix. */
+	if (zapi_route_decode_prefix(s, &api->prefix) < 0)
+		return -1;
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		api->src_prefix.family = AF_INET6;
+		STREAM_GETC(s, api->src_prefix.prefixlen);
+		if (api->src_prefix.prefixlen > IPV6_MAX_PREFIXLEN) {
+			flog_err(
+				EC_LIB_ZAPI_ENCODE,
+				"%s: SRC Prefix prefixlen received: %d is too large",
+				__func__, api->src_prefix.prefixlen);
+			return -1;
+		}
+		STREAM_GET(&api->src_prefix.prefix, s,
+			   PSIZE(api->src_prefix.prefixlen));
+
+		if (api->prefix.family != AF_INET6
+		    || api->src_prefix.prefixlen == 0) {
+			flog_err(
+				EC_LIB_ZAPI_ENCODE,
+				"%s: SRC prefix specified in some manner that makes no sense",
+				__func__);
+			return -1;
+		}
+	}
+
+	return zapi_route_decode_nexthops(s, api);
+stream_failure:
+	return -1;
+}
+
+/*
+ * Decodes what zapi_route_batch_encode() put before the prefixes, which are
+ * then read one by one with zapi_route_batch_decode_prefix().
+ */
+int zapi_route_batch_decode(struct stream *s, struct zapi_route *api,
+			    uint16_t *count)
+{
+	if (zapi_route_decode_head(s, api) < 0)
+		return -1;
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: source prefixes can't be batched", __func__);
+		return -1;
+	}
+
+	if (zapi_route_decode_nexthops(s, api) < 0)
+		return -1;
+
+	STREAM_GETW(s, *count);
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
+int zapi_route_batch_decode_prefix(struct stream *s, struct zapi_route *api)
+{
+	memset(&api->prefix, 0, sizeof(api->prefix));
+	return zapi_route_decode_prefix(s, &api->prefix);
+}
+
 static void zapi_encode_prefix(struct stream *s, struct prefix *p,
 			       uint8_t family)
 {
@@ -196,7 +196,9 @@ typedef enum {
 	ZEBRA_MLAG_CLIENT_UNREGISTER,
 	ZEBRA_MLAG_FORWARD_MSG,
 	ZEBRA_ERROR,
-	ZEBRA_CLIENT_CAPABILITIES
+	ZEBRA_CLIENT_CAPABILITIES,
+	ZEBRA_ROUTE_ADD_BATCH,
+	ZEBRA_ROUTE_DELETE_BATCH
 } zebra_message_types_t;
 
 enum zebra_error_types {
@@ -766,6 +768,23 @@ int zapi_nexthop_encode(struct stream *s, const struct zapi_nexthop *api_nh,
 			uint32_t api_flags);
 extern int zapi_route_encode(uint8_t, struct stream *, struct zapi_route *);
 extern int zapi_route_decode(struct stream *, struct zapi_route *);
+
+/*
+ * ZEBRA_ROUTE_ADD_BATCH and ZEBRA_ROUTE_DELETE_BATCH: routes which only
+ * differ in their prefix, sharing the rest of one zapi_route.
+ */
+extern int zclient_route_batch_send(uint8_t cmd, struct zclient *zclient,
+				    struct zapi_route *api,
+				    const struct prefix *prefixes,
+				    uint32_t count);
+extern int zapi_route_batch_encode(uint8_t cmd, struct stream *s,
+				   struct zapi_route *api,
+				   const struct prefix *prefixes,
+				   uint16_t count);
+extern int zapi_route_batch_decode(struct stream *s, struct zapi_route *api,
+				   uint16_t *count);
+extern int zapi_route_batch_decode_prefix(struct stream *s,
+					  struct zapi_route *api);
 bool zapi_route_notify_decode(struct stream *s, struct prefix *p,
 			      uint32_t *tableid,
 			      enum zapi_route_notify_owner *note);
@@ -349,7 +349,10 @@ void zlog_tls_buffer_flush(void)
 }
 
 
-static void vzlog_notls(int prio, const char *fmt, va_list ap)
+/* fmt_only: only for logfn_fmt targets, the others are handled by the TLS
+ * buffer code
+ */
+static void vzlog_notls(int prio, const char *fmt, va_list ap, bool fmt_only)
 {
 	struct zlog_target *zt;
 	struct zlog_msg stackmsg = {
@@ -367,7 +370,11 @@ static void vzlog_notls(int prio, const char *fmt, va_list ap)
 	frr_each (zlog_targets, &zlog_targets, zt) {
 		if (prio > zt->prio_min)
 			continue;
-		if (!zt->logfn)
+		if (zt->logfn_fmt) {
+			zt->logfn_fmt(zt, msg);
+			continue;
+		}
+		if (!zt->logfn || fmt_only)
 			continue;
 
 		zt->logfn(zt, &msg, 1);
@@ -385,7 +392,7 @@ static void vzlog_tls(struct zlog_tls *zlog_tls, int prio,
 	struct zlog_target *zt;
 	struct zlog_msg *msg;
 	char *buf;
-	bool ignoremsg = true;
+	bool ignoremsg = true, fmtmsg = false;
 	bool immediate = false;
 
 	/* avoid further processing cost if no target wants this message */
@@ -393,11 +400,17 @@ static void vzlog_tls(struct zlog_tls *zlog_tls, int prio,
 	frr_each (zlog_targets, &zlog_targets, zt) {
 		if (prio > zt->prio_min)
 			continue;
-		ignoremsg = false;
-		break;
+		if (zt->logfn_fmt)
+			fmtmsg = true;
+		else
+			ignoremsg = false;
 	}
 	rcu_read_unlock();
 
+	/* these can't be buffered, the arguments are gone by then */
+	if (fmtmsg)
+		vzlog_notls(prio, fmt, ap, true);
+
 	if (ignoremsg)
 		return;
 
@@ -454,7 +467,7 @@ void vzlog(int prio, const char *fmt, va_list ap)
 	if (zlog_tls)
 		vzlog_tls(zlog_tls, prio, fmt, ap);
 	else
-		vzlog_notls(prio, fmt, ap);
+		vzlog_notls(prio, fmt, ap, false);
 }
 
 void zlog_sigsafe(const char *text, size_t len)
@@ -504,6 +517,17 @@ const char *zlog_msg_text(struct zlog_msg *msg, size_t *textlen)
 	return msg->text;
 }
 
+const char *zlog_msg_fmt(struct zlog_msg *msg, va_list *args)
+{
+	va_copy(*args, msg->args);
+	return msg->fmt;
+}
+
+void zlog_msg_tsraw(struct zlog_msg *msg, struct timespec *ts)
+{
+	*ts = msg->ts;
+}
+
 #define ZLOG_TS_FORMAT		(ZLOG_TS_ISO8601 | ZLOG_TS_LEGACY)
 #define ZLOG_TS_FLAGS		~ZLOG_TS_PREC
 
@@ -592,6 +616,7 @@ struct zlog_target *zlog_target_clone(struct memtype *mt,
 	if (oldzt) {
 		newzt->prio_min = oldzt->prio_min;
 		newzt->logfn = oldzt->logfn;
+		newzt->logfn_fmt = oldzt->logfn_fmt;
 		newzt->logfn_sigsafe = oldzt->logfn_sigsafe;
 	}
 
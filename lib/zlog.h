@@ -101,6 +101,13 @@ extern const char *zlog_msg_text(struct zlog_msg *msg, size_t *textlen);
 extern size_t zlog_msg_ts(struct zlog_msg *msg, char *out, size_t outsz,
 			  uint32_t flags);
 
+/* for targets that don't need the message as text;  these are only valid in
+ * a logfn_fmt call (cf. below).  args is set up with va_copy(), the caller
+ * needs to va_end() it.
+ */
+extern const char *zlog_msg_fmt(struct zlog_msg *msg, va_list *args);
+extern void zlog_msg_tsraw(struct zlog_msg *msg, struct timespec *ts);
+
 /* This list & struct implements the actual logging targets.  It is accessed
  * lock-free from all threads, and thus MUST only be changed atomically, i.e.
  * RCU.
@@ -130,6 +137,13 @@ struct zlog_target {
 	void (*logfn)(struct zlog_target *zt, struct zlog_msg *msg[],
 		      size_t nmsgs);
 
+	/* alternative to logfn, for targets that store the format string &
+	 * arguments rather than text.  Called right from the zlog() call
+	 * (while the arguments are still around), without the message
+	 * being formatted unless some other target needs it.
+	 */
+	void (*logfn_fmt)(struct zlog_target *zt, struct zlog_msg *msg);
+
 	/* for crash handlers, set to NULL if log target can't write crash logs
 	 * without possibly deadlocking (AS-Safe)
 	 *
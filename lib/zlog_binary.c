@@ -0,0 +1,984 @@
+/*
+ * Binary logging - ring buffer file of format string IDs & arguments
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "zebra.h"
+
+#include <sys/mman.h>
+
+#include "memory.h"
+#include "frrcu.h"
+#include "frratomic.h"
+#include "frr_pthread.h"
+#include "jhash.h"
+#include "printfrr.h"
+#include "typesafe.h"
+#include "zlog.h"
+#include "zlog_binary.h"
+
+DECLARE_MGROUP(LOG)
+
+DEFINE_MTYPE_STATIC(LOG, LOG_BIN,      "binary log target")
+DEFINE_MTYPE_STATIC(LOG, LOG_BIN_NAME, "binary log file name")
+DEFINE_MTYPE_STATIC(LOG, LOG_BIN_FMT,  "binary log format string")
+
+#define ZLOG_BIN_ALIGN(len)	(((len) + 7) & ~(size_t)7)
+
+/* max. size of a message's arguments, anything larger is logged as text */
+#define ZLOG_BIN_MAXARGS	2048
+/* max. size of a message logged as text */
+#define ZLOG_BIN_MAXTEXT	16384
+/* same as printfrr's, "relatively small" */
+#define ZLOG_BIN_EXTBUF		256
+
+PREDECL_HASH(zlog_bin_fmts)
+
+struct zlog_bin_fmtref {
+	struct zlog_bin_fmts_item itm;
+
+	/* the format string as passed to zlog() ... */
+	const char *fmt;
+	/* ... and its copy in the file */
+	const char *text;
+	uint32_t id;
+};
+
+static int zlog_bin_fmt_cmp(const struct zlog_bin_fmtref *a,
+			    const struct zlog_bin_fmtref *b)
+{
+	if ((uintptr_t)a->fmt < (uintptr_t)b->fmt)
+		return -1;
+	return (uintptr_t)a->fmt > (uintptr_t)b->fmt;
+}
+
+static uint32_t zlog_bin_fmt_hash(const struct zlog_bin_fmtref *a)
+{
+	return jhash(&a->fmt, sizeof(a->fmt), 0x1e2f3a4b);
+}
+
+DECLARE_HASH(zlog_bin_fmts, struct zlog_bin_fmtref, itm, zlog_bin_fmt_cmp,
+	     zlog_bin_fmt_hash)
+
+struct zlt_bin {
+	struct zlog_target zt;
+
+	pthread_mutex_t mtx;
+
+	struct zlog_bin_header *hdr;
+	size_t size;
+	char *fmtbase;
+	char *ring;
+
+	/* as configured when the file was created */
+	char *filename;
+
+	/* format strings already in the file, by pointer */
+	struct zlog_bin_fmts_head fmts;
+};
+
+/*
+ * format string parsing, common to encoding & decoding
+ */
+
+enum zlog_bin_lenmod {
+	LM_NONE = 0,
+	LM_HH,
+	LM_H,
+	LM_L,
+	LM_LL,
+	LM_J,
+	LM_Z,
+	LM_T,
+	LM_LD,
+};
+
+struct zlog_bin_spec {
+	/* after the conversion character */
+	const char *end;
+
+	bool width_arg, prec_arg;
+	/* -1 if not given (or given as argument) */
+	int prec;
+	enum zlog_bin_lenmod lenmod;
+	char conv;
+};
+
+/* parses the conversion specification at fmt (the '%', not "%%").  Returns
+ * false for anything that isn't handled here, e.g. positional arguments or
+ * wide characters;  those messages are stored as text.
+ */
+static bool zlog_bin_spec(const char *fmt, struct zlog_bin_spec *spec)
+{
+	const char *p = fmt + 1;
+
+	memset(spec, 0, sizeof(*spec));
+	spec->prec = -1;
+
+	while (*p && strchr("-+ #0'", *p))
+		p++;
+
+	if (*p == '*') {
+		spec->width_arg = true;
+		p++;
+	} else {
+		while (isdigit((unsigned char)*p))
+			p++;
+		if (*p == '$')
+			return false;
+	}
+
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->prec_arg = true;
+			p++;
+		} else {
+			spec->prec = 0;
+			while (isdigit((unsigned char)*p))
+				spec->prec = spec->prec * 10 + (*p++ - '0');
+		}
+	}
+
+	switch (*p) {
+	case 'h':
+		spec->lenmod = (p[1] == 'h') ? LM_HH : LM_H;
+		p += (p[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		spec->lenmod = (p[1] == 'l') ? LM_LL : LM_L;
+		p += (p[1] == 'l') ? 2 : 1;
+		break;
+	case 'q':
+		spec->lenmod = LM_LL;
+		p++;
+		break;
+	case 'j':
+		spec->lenmod = LM_J;
+		p++;
+		break;
+	case 'z':
+		spec->lenmod = LM_Z;
+		p++;
+		break;
+	case 't':
+		spec->lenmod = LM_T;
+		p++;
+		break;
+	case 'L':
+		spec->lenmod = LM_LD;
+		p++;
+		break;
+	}
+
+	if (!*p || !strchr("diouxXceEfFgGaAsp", *p))
+		return false;
+	if ((*p == 's' || *p == 'c') && spec->lenmod != LM_NONE)
+		return false;
+
+	spec->conv = *p;
+	spec->end = p + 1;
+	return true;
+}
+
+/*
+ * encoding
+ */
+
+struct zlog_bin_buf {
+	uint8_t *pos, *end;
+};
+
+static bool zlog_bin_put(struct zlog_bin_buf *buf, const void *data,
+			 size_t len)
+{
+	if ((size_t)(buf->end - buf->pos) < len)
+		return false;
+
+	memcpy(buf->pos, data, len);
+	buf->pos += len;
+	return true;
+}
+
+static bool zlog_bin_put_int(struct zlog_bin_buf *buf, int64_t val)
+{
+	uint8_t type = ZLOG_BIN_ARG_INT;
+
+	return zlog_bin_put(buf, &type, 1) && zlog_bin_put(buf, &val, 8);
+}
+
+static bool zlog_bin_put_dbl(struct zlog_bin_buf *buf, double val)
+{
+	uint8_t type = ZLOG_BIN_ARG_DBL;
+
+	return zlog_bin_put(buf, &type, 1) && zlog_bin_put(buf, &val, 8);
+}
+
+static bool zlog_bin_put_str(struct zlog_bin_buf *buf, uint8_t type,
+			     uint8_t consumed, const char *str, size_t len)
+{
+	uint16_t len16 = len;
+
+	if (len > UINT16_MAX)
+		return false;
+	if (!zlog_bin_put(buf, &type, 1))
+		return false;
+	if (type == ZLOG_BIN_ARG_EXT && !zlog_bin_put(buf, &consumed, 1))
+		return false;
+
+	return zlog_bin_put(buf, &len16, 2) && zlog_bin_put(buf, str, len)
+	       && zlog_bin_put(buf, "", 1);
+}
+
+static int64_t zlog_bin_get_int(enum zlog_bin_lenmod lenmod, bool is_signed,
+				va_list *ap)
+{
+	switch (lenmod) {
+	case LM_L:
+		return is_signed ? va_arg(*ap, long)
+				 : (int64_t)va_arg(*ap, unsigned long);
+	case LM_LL:
+		return is_signed ? va_arg(*ap, long long)
+				 : (int64_t)va_arg(*ap, unsigned long long);
+	case LM_J:
+		return is_signed ? va_arg(*ap, intmax_t)
+				 : (int64_t)va_arg(*ap, uintmax_t);
+	case LM_Z:
+		return is_signed ? va_arg(*ap, ssize_t)
+				 : (int64_t)va_arg(*ap, size_t);
+	case LM_T:
+		return va_arg(*ap, ptrdiff_t);
+	case LM_HH:
+		return is_signed ? (signed char)va_arg(*ap, int)
+				 : (unsigned char)va_arg(*ap, unsigned int);
+	case LM_H:
+		return is_signed ? (short)va_arg(*ap, int)
+				 : (unsigned short)va_arg(*ap, unsigned int);
+	default:
+		return is_signed ? va_arg(*ap, int)
+				 : va_arg(*ap, unsigned int);
+	}
+}
+
+/* returns the length of the encoded arguments, -1 if this message can't be
+ * encoded (and needs to be stored as text)
+ */
+static ssize_t zlog_bin_encode(uint8_t *out, size_t outsz, const char *fmt,
+			       va_list *ap)
+{
+	struct zlog_bin_buf buf = { .pos = out, .end = out + outsz };
+	struct zlog_bin_spec spec;
+	char extbuf[ZLOG_BIN_EXTBUF];
+	const char *str;
+	int64_t ival;
+	void *ptr;
+	ssize_t n;
+	bool ok;
+
+	while ((fmt = strchr(fmt, '%'))) {
+		if (fmt[1] == '%') {
+			fmt += 2;
+			continue;
+		}
+		if (!zlog_bin_spec(fmt, &spec))
+			return -1;
+		fmt = spec.end;
+
+		if (spec.width_arg
+		    && !zlog_bin_put_int(&buf, va_arg(*ap, int)))
+			return -1;
+		if (spec.prec_arg) {
+			spec.prec = va_arg(*ap, int);
+			if (!zlog_bin_put_int(&buf, spec.prec))
+				return -1;
+			if (spec.prec < 0)
+				spec.prec = -1;
+		}
+
+		switch (spec.conv) {
+		case 'd':
+		case 'i':
+			ival = zlog_bin_get_int(spec.lenmod, true, ap);
+
+			n = 0;
+			if (printfrr_ext_char(fmt[0]))
+				n = printfrr_exti(extbuf, sizeof(extbuf), fmt,
+						  spec.prec, (uintmax_t)ival);
+			if (n > 0) {
+				ok = zlog_bin_put_str(&buf, ZLOG_BIN_ARG_EXT,
+						      n, extbuf,
+						      strlen(extbuf));
+				fmt += n;
+			} else
+				ok = zlog_bin_put_int(&buf, ival);
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			ival = zlog_bin_get_int(spec.lenmod, false, ap);
+			ok = zlog_bin_put_int(&buf, ival);
+			break;
+		case 'c':
+			ok = zlog_bin_put_int(&buf, va_arg(*ap, int));
+			break;
+		case 's':
+			str = va_arg(*ap, const char *);
+			if (!str)
+				str = "(null)";
+			ok = zlog_bin_put_str(&buf, ZLOG_BIN_ARG_STR, 0, str,
+					      spec.prec >= 0
+						      ? strnlen(str, spec.prec)
+						      : strlen(str));
+			break;
+		case 'p':
+			ptr = va_arg(*ap, void *);
+
+			n = 0;
+			if (printfrr_ext_char(fmt[0]))
+				n = printfrr_extp(extbuf, sizeof(extbuf), fmt,
+						  spec.prec, ptr);
+			if (n > 0) {
+				ok = zlog_bin_put_str(&buf, ZLOG_BIN_ARG_EXT,
+						      n, extbuf,
+						      strlen(extbuf));
+				fmt += n;
+			} else
+				ok = zlog_bin_put_int(&buf, (uintptr_t)ptr);
+			break;
+		default:
+			/* floating point;  long double would lose precision
+			 * as a double, store those messages as text
+			 */
+			if (spec.lenmod == LM_LD)
+				return -1;
+			ok = zlog_bin_put_dbl(&buf, va_arg(*ap, double));
+			break;
+		}
+
+		if (!ok)
+			return -1;
+	}
+
+	return buf.pos - out;
+}
+
+/*
+ * ring buffer file
+ *
+ * all of these are called with zlt->mtx held, except from the crash handler
+ */
+
+/* makes room for len bytes at head, dropping the oldest records */
+static void zlog_bin_reserve(struct zlt_bin *zlt, size_t len)
+{
+	struct zlog_bin_header *hdr = zlt->hdr;
+	struct zlog_bin_rec *rec;
+	uint64_t tail = hdr->tail;
+
+	while (hdr->head + len - tail > hdr->ring_size) {
+		rec = (struct zlog_bin_rec *)(zlt->ring
+					      + tail % hdr->ring_size);
+		tail += rec->len;
+	}
+	hdr->tail = tail;
+}
+
+/* returns the position to write a record of len bytes at */
+static char *zlog_bin_alloc(struct zlt_bin *zlt, size_t len)
+{
+	struct zlog_bin_header *hdr = zlt->hdr;
+	struct zlog_bin_rec *rec;
+	size_t pos = hdr->head % hdr->ring_size;
+	size_t room = hdr->ring_size - pos;
+
+	if (room < len) {
+		zlog_bin_reserve(zlt, room);
+
+		rec = (struct zlog_bin_rec *)(zlt->ring + pos);
+		rec->len = room;
+		rec->fmt_id = ZLOG_BIN_FMT_PAD;
+		hdr->head += room;
+		pos = 0;
+	}
+
+	zlog_bin_reserve(zlt, len);
+	return zlt->ring + pos;
+}
+
+static void zlog_bin_write(struct zlt_bin *zlt, uint32_t fmt_id, int prio,
+			   const struct timespec *ts, const void *args,
+			   size_t argslen)
+{
+	struct zlog_bin_rec *rec;
+	size_t len = ZLOG_BIN_ALIGN(sizeof(*rec) + argslen);
+
+	rec = (struct zlog_bin_rec *)zlog_bin_alloc(zlt, len);
+	rec->len = len;
+	rec->fmt_id = fmt_id;
+	rec->ts_sec = ts->tv_sec;
+	rec->ts_nsec = ts->tv_nsec;
+	rec->prio = prio;
+	memset(rec->pad, 0, sizeof(rec->pad));
+	memcpy(rec->args, args, argslen);
+
+	/* record is complete, make it visible */
+	atomic_thread_fence(memory_order_release);
+	zlt->hdr->head += len;
+}
+
+static void zlog_bin_write_text(struct zlt_bin *zlt, int prio,
+				const struct timespec *ts, const char *text,
+				size_t textlen)
+{
+	struct zlog_bin_rec *rec;
+	uint16_t len16;
+	uint8_t *pos;
+	size_t len;
+
+	textlen = MIN(textlen, ZLOG_BIN_MAXTEXT);
+	len16 = textlen;
+	len = ZLOG_BIN_ALIGN(sizeof(*rec) + 1 + 2 + textlen + 1);
+
+	rec = (struct zlog_bin_rec *)zlog_bin_alloc(zlt, len);
+	rec->len = len;
+	rec->fmt_id = ZLOG_BIN_FMT_TEXT;
+	rec->ts_sec = ts->tv_sec;
+	rec->ts_nsec = ts->tv_nsec;
+	rec->prio = prio;
+	memset(rec->pad, 0, sizeof(rec->pad));
+
+	pos = rec->args;
+	*pos++ = ZLOG_BIN_ARG_STR;
+	memcpy(pos, &len16, 2);
+	pos += 2;
+	memcpy(pos, text, textlen);
+	pos[textlen] = '\0';
+
+	atomic_thread_fence(memory_order_release);
+	zlt->hdr->head += len;
+}
+
+/* returns ZLOG_BIN_FMT_TEXT if the format string can't be added */
+static uint32_t zlog_bin_fmt_id(struct zlt_bin *zlt, const char *fmt)
+{
+	struct zlog_bin_header *hdr = zlt->hdr;
+	struct zlog_bin_fmtref ref = { .fmt = fmt }, *fr;
+	struct zlog_bin_fmt *entry;
+	size_t fmtlen, len;
+
+	fr = zlog_bin_fmts_find(&zlt->fmts, &ref);
+	if (fr) {
+		/* not a string constant, and changed since */
+		if (strcmp(fr->text, fmt))
+			return ZLOG_BIN_FMT_TEXT;
+		return fr->id;
+	}
+
+	fmtlen = strlen(fmt);
+	len = ZLOG_BIN_ALIGN(sizeof(*entry) + fmtlen + 1);
+	if (hdr->fmt_used + len > hdr->fmt_size)
+		return ZLOG_BIN_FMT_TEXT;
+
+	entry = (struct zlog_bin_fmt *)(zlt->fmtbase + hdr->fmt_used);
+	entry->len = len;
+	memcpy(entry->text, fmt, fmtlen + 1);
+
+	fr = XCALLOC(MTYPE_LOG_BIN_FMT, sizeof(*fr));
+	fr->fmt = fmt;
+	fr->text = entry->text;
+	fr->id = hdr->fmt_count;
+	zlog_bin_fmts_add(&zlt->fmts, fr);
+
+	hdr->fmt_used += len;
+	hdr->fmt_count++;
+	return fr->id;
+}
+
+/*
+ * zlog_target
+ */
+
+static void zlog_bin(struct zlog_target *zt, struct zlog_msg *msg)
+{
+	struct zlt_bin *zlt = container_of(zt, struct zlt_bin, zt);
+	uint8_t args[ZLOG_BIN_MAXARGS];
+	int prio = zlog_msg_prio(msg);
+	struct timespec ts;
+	const char *fmt, *text;
+	ssize_t argslen;
+	size_t textlen;
+	uint32_t fmt_id;
+	va_list ap;
+
+	zlog_msg_tsraw(msg, &ts);
+
+	fmt = zlog_msg_fmt(msg, &ap);
+	argslen = zlog_bin_encode(args, sizeof(args), fmt, &ap);
+	va_end(ap);
+
+	if (argslen >= 0) {
+		frr_with_mutex(&zlt->mtx) {
+			fmt_id = zlog_bin_fmt_id(zlt, fmt);
+			if (fmt_id != ZLOG_BIN_FMT_TEXT) {
+				zlog_bin_write(zlt, fmt_id, prio, &ts, args,
+					       argslen);
+				return;
+			}
+		}
+	}
+
+	text = zlog_msg_text(msg, &textlen);
+
+	frr_with_mutex(&zlt->mtx) {
+		zlog_bin_write_text(zlt, prio, &ts, text, textlen);
+	}
+}
+
+/* AS-Safe;  no locking, this may collide with a message being written by
+ * another thread.
+ */
+static void zlog_bin_sigsafe(struct zlog_target *zt, const char *text,
+			     size_t len)
+{
+	struct zlt_bin *zlt = container_of(zt, struct zlt_bin, zt);
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	zlog_bin_write_text(zlt, LOG_CRIT, &ts, text, len);
+}
+
+static size_t zlog_bin_size(struct zlog_cfg_bin *zcb)
+{
+	return MAX(zcb->size, (size_t)1024 * 1024) & ~(size_t)4095;
+}
+
+/* A file left behind by an earlier run (which may have crashed) is moved out
+ * of the way to FILENAME.prev rather than overwritten.  This also means a
+ * file that is still mapped by a target waiting for rcu_call() is never
+ * truncated, since it's renamed, not reused.
+ */
+static struct zlt_bin *zlog_bin_open(struct zlog_cfg_bin *zcb)
+{
+	struct zlog_bin_header *hdr;
+	struct zlt_bin *zlt;
+	char prev[MAXPATHLEN];
+	size_t size, fmt_size;
+	void *map;
+	int fd;
+
+	size = zlog_bin_size(zcb);
+	/* format strings are ~100 bytes, a few thousand of them */
+	fmt_size = MIN(size / 8, (size_t)1024 * 1024);
+
+	if ((size_t)snprintf(prev, sizeof(prev), "%s.prev", zcb->filename)
+	    >= sizeof(prev))
+		return NULL;
+	if (rename(zcb->filename, prev) && errno != ENOENT)
+		return NULL;
+
+	fd = open(zcb->filename, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC
+				| O_NOCTTY, LOGFILE_MASK);
+	if (fd < 0)
+		return NULL;
+
+	if (ftruncate(fd, size) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	hdr = map;
+	memcpy(hdr->magic, ZLOG_BIN_MAGIC, sizeof(hdr->magic));
+	hdr->version = ZLOG_BIN_VERSION;
+	hdr->byteorder = ZLOG_BIN_BYTEORDER;
+	hdr->fmt_offset = ZLOG_BIN_HDRSIZE;
+	hdr->fmt_size = fmt_size;
+	hdr->ring_offset = ZLOG_BIN_HDRSIZE + fmt_size;
+	hdr->ring_size = size - hdr->ring_offset;
+	hdr->pid = getpid();
+	strlcpy(hdr->prefix, zlog_prefix, sizeof(hdr->prefix));
+
+	zlt = (struct zlt_bin *)zlog_target_clone(MTYPE_LOG_BIN, NULL,
+						  sizeof(*zlt));
+	pthread_mutex_init(&zlt->mtx, NULL);
+	zlog_bin_fmts_init(&zlt->fmts);
+	zlt->hdr = hdr;
+	zlt->size = size;
+	zlt->fmtbase = (char *)map + hdr->fmt_offset;
+	zlt->ring = (char *)map + hdr->ring_offset;
+	zlt->filename = XSTRDUP(MTYPE_LOG_BIN_NAME, zcb->filename);
+
+	zlt->zt.prio_min = zcb->prio_min;
+	zlt->zt.logfn = NULL;
+	zlt->zt.logfn_fmt = zlog_bin;
+	zlt->zt.logfn_sigsafe = zlog_bin_sigsafe;
+	return zlt;
+}
+
+/* rcu_call target, nothing is logging to zlt anymore */
+static void zlog_bin_target_free(struct zlt_bin *zlt)
+{
+	struct zlog_bin_fmtref *fr;
+
+	while ((fr = zlog_bin_fmts_pop(&zlt->fmts)))
+		XFREE(MTYPE_LOG_BIN_FMT, fr);
+	zlog_bin_fmts_fini(&zlt->fmts);
+
+	munmap(zlt->hdr, zlt->size);
+	pthread_mutex_destroy(&zlt->mtx);
+	XFREE(MTYPE_LOG_BIN_NAME, zlt->filename);
+	XFREE(MTYPE_LOG_BIN, zlt);
+}
+
+/*
+ * (re-)configuration
+ */
+
+void zlog_bin_init(struct zlog_cfg_bin *zcb)
+{
+	memset(zcb, 0, sizeof(*zcb));
+	zcb->prio_min = ZLOG_DISABLED;
+	zcb->size = ZLOG_BIN_SIZE_DEFAULT;
+	pthread_mutex_init(&zcb->cfg_mtx, NULL);
+}
+
+static bool zlog_bin_cycle(struct zlog_cfg_bin *zcb)
+{
+	struct zlt_bin *zlt = zcb->active;
+	bool enable;
+
+	enable = zcb->prio_min != ZLOG_DISABLED && zcb->filename;
+
+	/* same file, keep logging into it;  zlog() reads prio_min unlocked */
+	if (enable && zlt && !strcmp(zlt->filename, zcb->filename)
+	    && zlt->size == zlog_bin_size(zcb)) {
+		zlt->zt.prio_min = zcb->prio_min;
+		return true;
+	}
+
+	/* done with the old file before a new one takes its place */
+	if (zlt) {
+		zlog_target_replace(&zlt->zt, NULL);
+		zcb->active = NULL;
+		rcu_call(zlog_bin_target_free, zlt, zt.rcu_head);
+	}
+
+	if (!enable)
+		return true;
+
+	zlt = zlog_bin_open(zcb);
+	if (!zlt)
+		return false;
+
+	zlog_target_replace(NULL, &zlt->zt);
+	zcb->active = zlt;
+	return true;
+}
+
+void zlog_bin_fini(struct zlog_cfg_bin *zcb)
+{
+	frr_with_mutex(&zcb->cfg_mtx) {
+		zcb->prio_min = ZLOG_DISABLED;
+		zlog_bin_cycle(zcb);
+	}
+	XFREE(MTYPE_LOG_BIN_NAME, zcb->filename);
+	pthread_mutex_destroy(&zcb->cfg_mtx);
+}
+
+bool zlog_bin_set_other(struct zlog_cfg_bin *zcb)
+{
+	frr_with_mutex(&zcb->cfg_mtx) {
+		return zlog_bin_cycle(zcb);
+	}
+	assert(0);
+}
+
+bool zlog_bin_set_filename(struct zlog_cfg_bin *zcb, const char *filename)
+{
+	frr_with_mutex(&zcb->cfg_mtx) {
+		XFREE(MTYPE_LOG_BIN_NAME, zcb->filename);
+		zcb->filename = XSTRDUP(MTYPE_LOG_BIN_NAME, filename);
+
+		return zlog_bin_cycle(zcb);
+	}
+	assert(0);
+}
+
+/*
+ * decoding
+ */
+
+struct zlog_bin_args {
+	const uint8_t *pos, *end;
+};
+
+static bool zlog_bin_get(struct zlog_bin_args *args, void *data, size_t len)
+{
+	if ((size_t)(args->end - args->pos) < len)
+		return false;
+
+	memcpy(data, args->pos, len);
+	args->pos += len;
+	return true;
+}
+
+/* returns the argument's type, 0 if there is none (left) */
+static uint8_t zlog_bin_get_arg(struct zlog_bin_args *args, int64_t *ival,
+				double *dval, const char **str,
+				uint8_t *consumed)
+{
+	uint8_t type;
+	uint16_t len;
+
+	if (!zlog_bin_get(args, &type, 1))
+		return 0;
+
+	switch (type) {
+	case ZLOG_BIN_ARG_INT:
+		return zlog_bin_get(args, ival, 8) ? type : 0;
+	case ZLOG_BIN_ARG_DBL:
+		return zlog_bin_get(args, dval, 8) ? type : 0;
+	case ZLOG_BIN_ARG_EXT:
+		if (!zlog_bin_get(args, consumed, 1))
+			return 0;
+		/* fallthrough */
+	case ZLOG_BIN_ARG_STR:
+		if (!zlog_bin_get(args, &len, 2)
+		    || (size_t)(args->end - args->pos) < len + 1u
+		    || args->pos[len] != '\0')
+			return 0;
+		*str = (const char *)args->pos;
+		args->pos += len + 1;
+		return type;
+	}
+	return 0;
+}
+
+static void zlog_bin_render_int(struct fbuf *out, const char *spec,
+				const struct zlog_bin_spec *sp, int64_t val)
+{
+	if (sp->conv == 'p') {
+		bprintfrr(out, spec, (void *)(uintptr_t)val);
+		return;
+	}
+
+	switch (sp->lenmod) {
+	case LM_L:
+		bprintfrr(out, spec, (long)val);
+		break;
+	case LM_LL:
+		bprintfrr(out, spec, (long long)val);
+		break;
+	case LM_J:
+		bprintfrr(out, spec, (intmax_t)val);
+		break;
+	case LM_Z:
+		bprintfrr(out, spec, (ssize_t)val);
+		break;
+	case LM_T:
+		bprintfrr(out, spec, (ptrdiff_t)val);
+		break;
+	default:
+		bprintfrr(out, spec, (int)val);
+		break;
+	}
+}
+
+/* renders one record's arguments according to its format string */
+static bool zlog_bin_render(struct fbuf *out, const char *fmt,
+			    struct zlog_bin_args *args)
+{
+	struct zlog_bin_spec sp;
+	const char *pct, *p, *str = NULL;
+	char spec[64], *sppos;
+	int64_t ival = 0;
+	double dval = 0;
+	uint8_t type, consumed = 0;
+
+	while ((pct = strchr(fmt, '%'))) {
+		bprintfrr(out, "%.*s", (int)(pct - fmt), fmt);
+
+		if (pct[1] == '%') {
+			bprintfrr(out, "%%");
+			fmt = pct + 2;
+			continue;
+		}
+		if (!zlog_bin_spec(pct, &sp))
+			return false;
+		fmt = sp.end;
+
+		/* rebuild the specification with '*' filled in */
+		sppos = spec;
+		for (p = pct; p < sp.end; p++) {
+			if (sppos >= spec + sizeof(spec) - 24)
+				return false;
+			if (*p != '*') {
+				*sppos++ = *p;
+				continue;
+			}
+			if (zlog_bin_get_arg(args, &ival, &dval, &str,
+					     &consumed) != ZLOG_BIN_ARG_INT)
+				return false;
+			sppos += snprintf(sppos, spec + sizeof(spec) - sppos,
+					  "%d", (int)ival);
+		}
+		*sppos = '\0';
+
+		type = zlog_bin_get_arg(args, &ival, &dval, &str, &consumed);
+		switch (type) {
+		case ZLOG_BIN_ARG_INT:
+			if (strchr("eEfFgGaAs", sp.conv))
+				return false;
+			zlog_bin_render_int(out, spec, &sp, ival);
+			break;
+		case ZLOG_BIN_ARG_DBL:
+			/* long double is never encoded */
+			if (!strchr("eEfFgGaA", sp.conv)
+			    || sp.lenmod == LM_LD)
+				return false;
+			bprintfrr(out, spec, dval);
+			break;
+		case ZLOG_BIN_ARG_STR:
+			if (sp.conv != 's')
+				return false;
+			bprintfrr(out, spec, str);
+			break;
+		case ZLOG_BIN_ARG_EXT:
+			if (consumed > strlen(fmt))
+				return false;
+			fmt += consumed;
+
+			/* flags & width apply, precision went to the
+			 * extension
+			 */
+			sppos = spec + strspn(spec + 1, "-+ #0'123456789") + 1;
+			strlcpy(sppos, "s", spec + sizeof(spec) - sppos);
+			bprintfrr(out, spec, str);
+			break;
+		default:
+			return false;
+		}
+	}
+
+	bprintfrr(out, "%s", fmt);
+	return true;
+}
+
+ssize_t zlog_bin_decode(const void *buf, size_t len,
+			void (*cb)(void *arg, const struct zlog_bin_msg *msg),
+			void *arg)
+{
+	const struct zlog_bin_header *hdr = buf;
+	const struct zlog_bin_rec *rec;
+	const struct zlog_bin_fmt *entry;
+	const char **fmts, *ring, *fmtpos;
+	struct zlog_bin_args args;
+	struct zlog_bin_msg msg;
+	char prefix[sizeof(hdr->prefix) + 1];
+	char text[ZLOG_BIN_MAXTEXT + 256];
+	struct fbuf fb;
+	uint64_t tail, head;
+	size_t i, pos;
+	ssize_t count = 0;
+
+	if (len < ZLOG_BIN_HDRSIZE
+	    || memcmp(hdr->magic, ZLOG_BIN_MAGIC, sizeof(hdr->magic))
+	    || hdr->version != ZLOG_BIN_VERSION
+	    || hdr->byteorder != ZLOG_BIN_BYTEORDER
+	    || hdr->fmt_offset + hdr->fmt_size > len
+	    || hdr->ring_offset + hdr->ring_size > len
+	    || hdr->fmt_used > hdr->fmt_size
+	    || hdr->head - hdr->tail > hdr->ring_size)
+		return -1;
+
+	memcpy(prefix, hdr->prefix, sizeof(hdr->prefix));
+	prefix[sizeof(hdr->prefix)] = '\0';
+
+	/* format table */
+	fmts = XCALLOC(MTYPE_TMP, sizeof(fmts[0]) * (hdr->fmt_count + 1));
+	fmtpos = (const char *)buf + hdr->fmt_offset;
+	for (i = 0, pos = 0; i < hdr->fmt_count; i++) {
+		entry = (const struct zlog_bin_fmt *)(fmtpos + pos);
+		if (pos + sizeof(*entry) > hdr->fmt_used
+		    || entry->len < sizeof(*entry)
+		    || entry->len > hdr->fmt_used - pos
+		    || !memchr(entry->text, '\0', entry->len - sizeof(*entry)))
+			break;
+		fmts[i] = entry->text;
+		pos += entry->len;
+	}
+
+	ring = (const char *)buf + hdr->ring_offset;
+	head = hdr->head;
+
+	for (tail = hdr->tail; tail < head; tail += rec->len) {
+		pos = tail % hdr->ring_size;
+		rec = (const struct zlog_bin_rec *)(ring + pos);
+
+		if (hdr->ring_size - pos < 8 || rec->len < 8 || rec->len % 8
+		    || rec->len > hdr->ring_size - pos)
+			break;
+		if (rec->fmt_id == ZLOG_BIN_FMT_PAD)
+			continue;
+		if (rec->len < sizeof(*rec))
+			break;
+
+		args.pos = rec->args;
+		args.end = (const uint8_t *)rec + rec->len;
+
+		fb.buf = fb.pos = text;
+		fb.len = sizeof(text) - 1;
+
+		if (rec->fmt_id == ZLOG_BIN_FMT_TEXT) {
+			const char *str = NULL;
+			uint8_t consumed;
+			int64_t ival;
+			double dval;
+
+			if (zlog_bin_get_arg(&args, &ival, &dval, &str,
+					     &consumed) == ZLOG_BIN_ARG_STR)
+				bprintfrr(&fb, "%s", str);
+			else
+				bprintfrr(&fb, "[undecodable message]");
+		} else if (rec->fmt_id >= hdr->fmt_count
+			   || !fmts[rec->fmt_id]) {
+			bprintfrr(&fb, "[unknown format string %u]",
+				  rec->fmt_id);
+		} else if (!zlog_bin_render(&fb, fmts[rec->fmt_id], &args)) {
+			fb.pos = fb.buf;
+			bprintfrr(&fb, "[undecodable message: \"%s\"]",
+				  fmts[rec->fmt_id]);
+		}
+		*fb.pos = '\0';
+
+		msg.prefix = prefix;
+		msg.ts.tv_sec = rec->ts_sec;
+		msg.ts.tv_nsec = rec->ts_nsec;
+		msg.prio = rec->prio;
+		msg.text = text;
+		msg.textlen = fb.pos - text;
+		cb(arg, &msg);
+		count++;
+	}
+
+	XFREE(MTYPE_TMP, fmts);
+	return count;
+}
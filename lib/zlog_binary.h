@@ -0,0 +1,161 @@
+/*
+ * Binary logging - ring buffer file of format string IDs & arguments
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_ZLOG_BINARY_H
+#define _FRR_ZLOG_BINARY_H
+
+#include <pthread.h>
+
+#include "zlog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The binary log target doesn't format messages;  it stores the format
+ * string (once, in a table at the beginning of the file) and the raw
+ * arguments of each message in a fixed size, mmap'd ring buffer file.
+ * Arguments that can't be stored as-is (printfrr extensions, e.g. %pI4)
+ * are rendered to text when logging;  messages with arguments that can't
+ * be stored at all (positional arguments, long double) are stored as text
+ * entirely.  Messages are turned into text offline, by tools/frr-logdecode.
+ *
+ * File layout, all in the byte order of the system writing it:
+ *   header (ZLOG_BIN_HDRSIZE bytes)
+ *   format table: struct zlog_bin_fmt entries, 8-byte aligned;  IDs are
+ *     assigned in order, starting at 0
+ *   ring: struct zlog_bin_rec entries, 8-byte aligned;  when a record
+ *     doesn't fit before the end of the ring, the rest of the ring is
+ *     skipped with a ZLOG_BIN_FMT_PAD record.
+ */
+
+#define ZLOG_BIN_MAGIC		"FRRZLOGB"
+#define ZLOG_BIN_VERSION	1
+#define ZLOG_BIN_BYTEORDER	0x01020304U
+#define ZLOG_BIN_HDRSIZE	4096
+
+struct zlog_bin_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteorder;
+
+	uint64_t fmt_offset, fmt_size;
+	uint64_t ring_offset, ring_size;
+
+	/* updated after the data they cover has been written, so that the
+	 * file is consistent when the daemon crashes
+	 */
+	uint64_t fmt_used;
+	uint32_t fmt_count;
+	uint32_t pad;
+	/* free running byte counters;  the ring holds [tail, head) */
+	uint64_t head, tail;
+
+	int64_t pid;
+	char prefix[128];
+};
+
+struct zlog_bin_fmt {
+	/* including the terminating \0 & padding */
+	uint32_t len;
+	char text[];
+};
+
+/* special format IDs */
+#define ZLOG_BIN_FMT_TEXT	0xffffffffU	/* one STR, formatted already */
+#define ZLOG_BIN_FMT_PAD	0xfffffffeU	/* skip to start of ring */
+
+struct zlog_bin_rec {
+	/* whole record, multiple of 8 */
+	uint32_t len;
+	uint32_t fmt_id;
+
+	/* fields below are not present in ZLOG_BIN_FMT_PAD records */
+	int64_t ts_sec;
+	uint32_t ts_nsec;
+	uint8_t prio;
+	uint8_t pad[3];
+
+	/* one entry per conversion (and '*' width/precision), each starting
+	 * with one of the ZLOG_BIN_ARG_* types
+	 */
+	uint8_t args[];
+};
+
+/* int64_t, sign or zero extended as appropriate */
+#define ZLOG_BIN_ARG_INT	1
+/* double */
+#define ZLOG_BIN_ARG_DBL	2
+/* uint16_t length, then the string, \0 terminated (not in length) */
+#define ZLOG_BIN_ARG_STR	3
+/* uint8_t format string characters consumed by the printfrr extension,
+ * then the extension's output like ZLOG_BIN_ARG_STR
+ */
+#define ZLOG_BIN_ARG_EXT	4
+
+/* configuration */
+
+struct zlt_bin;
+
+struct zlog_cfg_bin {
+	struct zlt_bin *active;
+
+	pthread_mutex_t cfg_mtx;
+
+	/* call zlog_bin_set_other() to apply these */
+	int prio_min;
+	/* file size in bytes */
+	size_t size;
+
+	/* call zlog_bin_set_filename() to change this */
+	char *filename;
+};
+
+#define ZLOG_BIN_SIZE_DEFAULT	(16 * 1024 * 1024)
+
+extern void zlog_bin_init(struct zlog_cfg_bin *zcb);
+extern void zlog_bin_fini(struct zlog_cfg_bin *zcb);
+
+extern bool zlog_bin_set_other(struct zlog_cfg_bin *zcb);
+extern bool zlog_bin_set_filename(struct zlog_cfg_bin *zcb,
+				  const char *filename);
+
+/* decoding */
+
+struct zlog_bin_msg {
+	const char *prefix;
+	struct timespec ts;
+	int prio;
+
+	const char *text;
+	size_t textlen;
+};
+
+/* calls cb for each message in the file contents in buf, oldest first.
+ * Returns the number of messages, -1 if buf isn't a (valid) binary log.
+ */
+extern ssize_t zlog_bin_decode(const void *buf, size_t len,
+			       void (*cb)(void *arg,
+					  const struct zlog_bin_msg *msg),
+			       void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_ZLOG_BINARY_H */
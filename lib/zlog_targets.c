@@ -18,11 +18,13 @@
 
 #include <sys/un.h>
 #include <syslog.h>
+#include <sched.h>
 
 #include "memory.h"
 #include "frrcu.h"
 #include "frr_pthread.h"
 #include "printfrr.h"
+#include "spsc_ring.h"
 #include "zlog.h"
 #include "zlog_targets.h"
 
@@ -38,6 +40,8 @@ DEFINE_MTYPE_STATIC(LOG, LOG_FD,        "log file target")
 DEFINE_MTYPE_STATIC(LOG, LOG_FD_NAME,   "log file name")
 DEFINE_MTYPE_STATIC(LOG, LOG_FD_ROTATE, "log file rotate helper")
 DEFINE_MTYPE_STATIC(LOG, LOG_SYSL,      "syslog target")
+DEFINE_MTYPE_STATIC(LOG, LOG_ASYNC,     "queued log messages")
+DEFINE_MTYPE_STATIC(LOG, LOG_ASYNC_Q,   "log writer queue")
 
 struct zlt_fd {
 	struct zlog_target zt;
@@ -46,8 +50,12 @@ struct zlt_fd {
 
 	char ts_subsec;
 	bool record_priority;
+	bool async;
 
 	struct rcu_head_close head_close;
+
+	/* async target waiting for the writer to flush it */
+	struct zlt_fd *release_next;
 };
 
 static const char * const prionames[] = {
@@ -61,6 +69,456 @@ static const char * const prionames[] = {
 	[LOG_DEBUG] =	"debugging: ",
 };
 
+/* "\nYYYY-MM-DD HH:MM:SS.NNNNNNNNN+ZZ:ZZ " = 37 chars */
+#define TS_LEN 40
+
+/* asynchronous writing
+ *
+ * Async file targets don't write from the thread that is logging.  Instead,
+ * zlog_fd() formats the messages and puts the text on a SPSC ring private to
+ * the logging thread.  A single writer pthread collects the text from all
+ * these rings and writes it out, batching up consecutive messages for the
+ * same target into one writev().
+ *
+ * When a thread's ring is full, debug & informational messages are dropped;
+ * anything more important waits for the writer to catch up.  On a crash,
+ * whatever is still queued is written by zlog_fd_sigsafe() before the crash
+ * message itself.  The writer takes the messages it is about to write off the
+ * ring before writing them, and doesn't free them anymore once it sees the
+ * crash, so zlog_fd_sigsafe() never looks at a message that is gone.
+ *
+ * The writer is started on first use, i.e. after daemonizing.
+ */
+
+#define ZLOG_ASYNC_RING_SIZE	1024
+#define ZLOG_ASYNC_IOV		64
+/* the writer also wakes up on its own, cf. zlog_async_wake() */
+#define ZLOG_ASYNC_WAIT_MS	100
+
+struct zlog_async_rec {
+	struct zlt_fd *zte;
+	size_t len;
+	char text[];
+};
+
+PREDECL_ATOMLIST(zlog_async_queues)
+
+struct zlog_async_queue {
+	struct zlog_async_queues_item itm;
+
+	struct spsc_ring *ring;
+};
+
+DECLARE_ATOMLIST(zlog_async_queues, struct zlog_async_queue, itm);
+
+static struct zlog_async {
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	pthread_t thread;
+
+	atomic_bool running;
+	atomic_bool sleeping;
+	atomic_bool crashed;
+
+	/* protected by mtx;  writer is cleared once the pthread is joined */
+	bool writer;
+	bool stop;
+	struct zlt_fd *release;
+
+	/* queues are never freed, there's just one per pthread */
+	struct zlog_async_queues_head queues;
+
+	_Atomic uint64_t queued, written, dropped, stalls;
+} za = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+static thread_local struct zlog_async_queue *zlog_async_queue;
+
+static void zlog_async_wake(void)
+{
+	/* only one producer needs to signal a sleeping writer.  The flag can
+	 * race with the writer going to sleep;  that only delays the messages
+	 * until the writer's timeout.
+	 */
+	if (!atomic_exchange_explicit(&za.sleeping, false,
+				      memory_order_seq_cst))
+		return;
+
+	frr_with_mutex(&za.mtx) {
+		pthread_cond_signal(&za.cond);
+	}
+}
+
+/* writes out everything queued;  returns the number of batches written */
+static size_t zlog_async_flush(void)
+{
+	struct zlog_async_queue *zaq;
+	struct zlog_async_rec *first, *rec;
+	struct zlog_async_rec *recs[ZLOG_ASYNC_IOV];
+	struct iovec iov[ZLOG_ASYNC_IOV];
+	size_t i, n, total = 0;
+	bool crashed;
+	int fd;
+
+	frr_each (zlog_async_queues, &za.queues, zaq) {
+		while ((first = spsc_ring_peek(zaq->ring, 0))) {
+			/* leave the rest to zlog_async_sigsafe() */
+			if (atomic_load_explicit(&za.crashed,
+						 memory_order_relaxed))
+				return total;
+
+			for (n = 0; n < array_size(iov); n++) {
+				rec = spsc_ring_peek(zaq->ring, n);
+				if (!rec || rec->zte != first->zte)
+					break;
+
+				iov[n].iov_base = rec->text;
+				iov[n].iov_len = rec->len;
+			}
+
+			/* claim them, zlog_async_sigsafe() skips them now */
+			for (i = 0; i < n; i++)
+				recs[i] = spsc_ring_pop(zaq->ring);
+			atomic_thread_fence(memory_order_seq_cst);
+
+			/* keeps the fd open across zlog_file_rotate() */
+			rcu_read_lock();
+			fd = atomic_load_explicit(&first->zte->fd,
+						  memory_order_relaxed);
+			writev(fd, iov, n);
+			rcu_read_unlock();
+
+			/* zlog_async_sigsafe() may have picked them up before
+			 * they were claimed, leave them be in that case
+			 */
+			crashed = atomic_load_explicit(&za.crashed,
+						       memory_order_seq_cst);
+			for (i = 0; i < n && !crashed; i++)
+				XFREE(MTYPE_LOG_ASYNC, recs[i]);
+
+			atomic_fetch_add_explicit(&za.written, n,
+						  memory_order_relaxed);
+			total += n;
+		}
+	}
+
+	return total;
+}
+
+/* the targets' last messages were queued before the release was requested,
+ * so they're written by the time this is called after a flush.
+ */
+static void zlog_async_release(struct zlt_fd *zte)
+{
+	struct zlt_fd *next;
+
+	for (; zte; zte = next) {
+		next = zte->release_next;
+
+		close(zte->fd);
+		XFREE(MTYPE_LOG_FD, zte);
+	}
+}
+
+static void *zlog_async_run(void *arg)
+{
+	struct rcu_thread *rcu_thread = arg;
+	struct zlt_fd *release;
+	struct timespec deadline;
+	bool stop;
+
+	rcu_thread_start(rcu_thread);
+	/* only held while writing */
+	rcu_read_unlock();
+
+	while (true) {
+		frr_with_mutex(&za.mtx) {
+			stop = za.stop;
+			release = za.release;
+			za.release = NULL;
+		}
+
+		if (zlog_async_flush() || release) {
+			zlog_async_release(release);
+			continue;
+		}
+		if (stop)
+			break;
+
+		atomic_store_explicit(&za.sleeping, true,
+				      memory_order_seq_cst);
+		if (zlog_async_flush()) {
+			atomic_store_explicit(&za.sleeping, false,
+					      memory_order_relaxed);
+			continue;
+		}
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += ZLOG_ASYNC_WAIT_MS * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		frr_with_mutex(&za.mtx) {
+			if (!za.stop && !za.release)
+				pthread_cond_timedwait(&za.cond, &za.mtx,
+						       &deadline);
+		}
+		atomic_store_explicit(&za.sleeping, false,
+				      memory_order_relaxed);
+	}
+
+	return NULL;
+}
+
+/* the writer pthread doesn't survive daemonizing, start a new one on demand */
+static void zlog_async_atfork_child(void)
+{
+	pthread_mutex_init(&za.mtx, NULL);
+	pthread_cond_init(&za.cond, NULL);
+	za.writer = false;
+	za.stop = false;
+	za.release = NULL;
+	atomic_store_explicit(&za.running, false, memory_order_relaxed);
+}
+
+static bool zlog_async_start(void)
+{
+	static bool atfork_registered;
+	struct rcu_thread *rcu_thread;
+	sigset_t oldsigs, blocksigs;
+	bool running;
+
+	frr_with_mutex(&za.mtx) {
+		running = atomic_load_explicit(&za.running,
+					       memory_order_relaxed);
+		if (running || za.stop)
+			return running;
+
+		if (!atfork_registered) {
+			pthread_atfork(NULL, NULL, zlog_async_atfork_child);
+			atfork_registered = true;
+		}
+
+		/* never handle signals on the writer (cf. rcu_start()) */
+		sigfillset(&blocksigs);
+		pthread_sigmask(SIG_BLOCK, &blocksigs, &oldsigs);
+
+		rcu_thread = rcu_thread_prepare();
+		if (pthread_create(&za.thread, NULL, zlog_async_run,
+				   rcu_thread)) {
+			rcu_thread_unprepare(rcu_thread);
+		} else {
+			running = za.writer = true;
+			atomic_store_explicit(&za.running, true,
+					      memory_order_release);
+		}
+
+		pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+	}
+
+#ifdef HAVE_PTHREAD_SETNAME_NP
+	if (running) {
+# ifdef GNU_LINUX
+		pthread_setname_np(za.thread, "log writer");
+# elif defined(__NetBSD__)
+		pthread_setname_np(za.thread, "log writer", NULL);
+# endif
+	}
+#elif defined(HAVE_PTHREAD_SET_NAME_NP)
+	if (running)
+		pthread_set_name_np(za.thread, "log writer");
+#endif
+
+	return running;
+}
+
+static void zlog_async_stop(void)
+{
+	struct zlt_fd *release;
+
+	frr_with_mutex(&za.mtx) {
+		if (!atomic_load_explicit(&za.running, memory_order_relaxed))
+			return;
+
+		/* anything logged from here on is written directly */
+		atomic_store_explicit(&za.running, false,
+				      memory_order_relaxed);
+		za.stop = true;
+		pthread_cond_signal(&za.cond);
+	}
+
+	pthread_join(za.thread, NULL);
+
+	/* the writer is gone, this pthread can take over its role */
+	zlog_async_flush();
+
+	frr_with_mutex(&za.mtx) {
+		release = za.release;
+		za.release = NULL;
+		za.writer = false;
+	}
+	zlog_async_release(release);
+}
+
+/* rcu_call target, i.e. no more messages are going to be queued for zte */
+static void zlog_fd_async_free(struct zlt_fd *zte)
+{
+	frr_with_mutex(&za.mtx) {
+		if (za.writer) {
+			zte->release_next = za.release;
+			za.release = zte;
+			pthread_cond_signal(&za.cond);
+			return;
+		}
+	}
+
+	zlog_async_release(zte);
+}
+
+/* returns false if the messages need to be written synchronously */
+static bool zlog_fd_async(struct zlt_fd *zte, struct zlog_msg *msgs[],
+			  size_t nmsgs)
+{
+	struct zlog_async_queue *zaq = zlog_async_queue;
+	struct zlog_async_rec *rec;
+	size_t i, textlen, size = 0, count = 0;
+	int prio, prio_top = LOG_DEBUG;
+	bool stalled = false;
+	const char *text;
+	char *pos;
+
+	if (atomic_load_explicit(&za.crashed, memory_order_relaxed))
+		return false;
+	if (!atomic_load_explicit(&za.running, memory_order_acquire)
+	    && !zlog_async_start())
+		return false;
+
+	if (!zaq) {
+		zaq = XCALLOC(MTYPE_LOG_ASYNC_Q, sizeof(*zaq));
+		zaq->ring = spsc_ring_new(ZLOG_ASYNC_RING_SIZE);
+		zlog_async_queues_add_tail(&za.queues, zaq);
+		zlog_async_queue = zaq;
+	}
+
+	for (i = 0; i < nmsgs; i++) {
+		prio = zlog_msg_prio(msgs[i]);
+		if (prio > zte->zt.prio_min)
+			continue;
+
+		zlog_msg_text(msgs[i], &textlen);
+		size += TS_LEN + strlen(prionames[prio]) + zlog_prefixsz
+			+ textlen + 1;
+		prio_top = MIN(prio_top, prio);
+		count++;
+	}
+
+	if (!count)
+		return true;
+
+	if (prio_top >= LOG_INFO && spsc_ring_full(zaq->ring)) {
+		atomic_fetch_add_explicit(&za.dropped, count,
+					  memory_order_relaxed);
+		return true;
+	}
+
+	rec = XMALLOC(MTYPE_LOG_ASYNC, sizeof(*rec) + size);
+	rec->zte = zte;
+	pos = rec->text;
+
+	for (i = 0; i < nmsgs; i++) {
+		prio = zlog_msg_prio(msgs[i]);
+		if (prio > zte->zt.prio_min)
+			continue;
+
+		pos += zlog_msg_ts(msgs[i], pos, TS_LEN,
+				   ZLOG_TS_LEGACY | zte->ts_subsec);
+		*pos++ = ' ';
+
+		if (zte->record_priority) {
+			textlen = strlen(prionames[prio]);
+			memcpy(pos, prionames[prio], textlen);
+			pos += textlen;
+		}
+
+		memcpy(pos, zlog_prefix, zlog_prefixsz);
+		pos += zlog_prefixsz;
+
+		text = zlog_msg_text(msgs[i], &textlen);
+		memcpy(pos, text, textlen);
+		pos += textlen;
+
+		*pos++ = '\n';
+	}
+	rec->len = pos - rec->text;
+
+	while (!spsc_ring_push(zaq->ring, rec)) {
+		if (!atomic_load_explicit(&za.running, memory_order_acquire)) {
+			XFREE(MTYPE_LOG_ASYNC, rec);
+			return false;
+		}
+		if (!stalled) {
+			atomic_fetch_add_explicit(&za.stalls, 1,
+						  memory_order_relaxed);
+			stalled = true;
+		}
+		zlog_async_wake();
+		sched_yield();
+	}
+
+	atomic_fetch_add_explicit(&za.queued, 1, memory_order_relaxed);
+	zlog_async_wake();
+	return true;
+}
+
+/* AS-Safe, best effort: messages the writer has claimed are left to it.  If
+ * it claims some while they're being written here, they show up twice.
+ *
+ * Once za.crashed is set, the writer no longer frees what it claims;  before
+ * that, it only frees messages claimed before we start looking.
+ */
+static void zlog_async_sigsafe(void)
+{
+	struct zlog_async_queue *zaq;
+	struct zlog_async_rec *rec;
+	size_t pos;
+
+	if (atomic_exchange_explicit(&za.crashed, true, memory_order_seq_cst))
+		return;
+
+	frr_each (zlog_async_queues, &za.queues, zaq) {
+		pos = 0;
+		while ((rec = spsc_ring_walk(zaq->ring, &pos)))
+			write(rec->zte->fd, rec->text, rec->len);
+	}
+}
+
+void zlog_async_get_stats(struct zlog_async_stats *stats)
+{
+	struct zlog_async_queue *zaq;
+
+	memset(stats, 0, sizeof(*stats));
+
+	stats->running = atomic_load_explicit(&za.running,
+					      memory_order_relaxed);
+	frr_each (zlog_async_queues, &za.queues, zaq)
+		stats->queues++;
+
+	stats->queued = atomic_load_explicit(&za.queued, memory_order_relaxed);
+	stats->written = atomic_load_explicit(&za.written,
+					      memory_order_relaxed);
+	stats->dropped = atomic_load_explicit(&za.dropped,
+					      memory_order_relaxed);
+	stats->stalls = atomic_load_explicit(&za.stalls, memory_order_relaxed);
+}
+
 void zlog_fd(struct zlog_target *zt, struct zlog_msg *msgs[], size_t nmsgs)
 {
 	struct zlt_fd *zte = container_of(zt, struct zlt_fd, zt);
@@ -68,10 +526,11 @@ void zlog_fd(struct zlog_target *zt, struct zlog_msg *msgs[], size_t nmsgs)
 	size_t i, textlen, iovpos = 0;
 	size_t niov = MIN(4 * nmsgs + 1, IOV_MAX);
 	struct iovec iov[niov];
-	/* "\nYYYY-MM-DD HH:MM:SS.NNNNNNNNN+ZZ:ZZ " = 37 chars */
-#define TS_LEN 40
 	char ts_buf[TS_LEN * nmsgs], *ts_pos = ts_buf;
 
+	if (zte->async && zlog_fd_async(zte, msgs, nmsgs))
+		return;
+
 	fd = atomic_load_explicit(&zte->fd, memory_order_relaxed);
 
 	for (i = 0; i < nmsgs; i++) {
@@ -134,6 +593,9 @@ static void zlog_fd_sigsafe(struct zlog_target *zt, const char *text,
 	struct iovec iov[4];
 	int fd;
 
+	if (zte->async)
+		zlog_async_sigsafe();
+
 	iov[0].iov_base = (char *)prionames[LOG_CRIT];
 	iov[0].iov_len = zte->record_priority ? strlen(iov[0].iov_base) : 0;
 
@@ -168,6 +630,11 @@ static void zlog_file_target_free(struct zlt_fd *zlt)
 	if (!zlt)
 		return;
 
+	if (zlt->async) {
+		rcu_call(zlog_fd_async_free, zlt, zt.rcu_head);
+		return;
+	}
+
 	rcu_close(&zlt->head_close, zlt->fd);
 	rcu_free(MTYPE_LOG_FD, zlt, zt.rcu_head);
 }
@@ -219,6 +686,7 @@ static bool zlog_file_cycle(struct zlog_cfg_file *zcf)
 		zlt->fd = fd;
 		zlt->record_priority = zcf->record_priority;
 		zlt->ts_subsec = zcf->ts_subsec;
+		zlt->async = zcf->async;
 
 		zlt->zt.prio_min = zcf->prio_min;
 		zlt->zt.logfn = zcf->zlog_wrap ? zcf->zlog_wrap : zlog_fd;
@@ -378,6 +846,7 @@ static int zlt_init(const char *progname, const char *protoname,
 
 static int zlt_fini(void)
 {
+	zlog_async_stop();
 	closelog();
 	return 0;
 }
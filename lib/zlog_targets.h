@@ -34,6 +34,8 @@ struct zlog_cfg_file {
 	int prio_min;
 	char ts_subsec;
 	bool record_priority;
+	/* hand messages to the log writer pthread instead of writing them */
+	bool async;
 
 	/* call zlog_file_set_filename/fd() to change this */
 	char *filename;
@@ -54,6 +56,24 @@ extern bool zlog_file_rotate(struct zlog_cfg_file *zcf);
 extern void zlog_fd(struct zlog_target *zt, struct zlog_msg *msgs[],
 		    size_t nmsgs);
 
+/* asynchronous file targets share one writer pthread */
+
+struct zlog_async_stats {
+	bool running;
+	/* producer threads, each with its own queue */
+	size_t queues;
+
+	/* batches of messages queued & written */
+	uint64_t queued;
+	uint64_t written;
+	/* debug/informational messages dropped on a full queue */
+	uint64_t dropped;
+	/* more important messages had to wait for the writer */
+	uint64_t stalls;
+};
+
+extern void zlog_async_get_stats(struct zlog_async_stats *stats);
+
 /* syslog is always limited to one target */
 
 extern void zlog_syslog_set_facility(int facility);
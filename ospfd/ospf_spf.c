@@ -29,6 +29,7 @@
 #include "if.h"
 #include "table.h"
 #include "log.h"
+#include "frr_pthread.h"
 #include "sockunion.h" /* for inet_ntop () */
 
 #include "ospfd/ospfd.h"
@@ -52,6 +53,8 @@
 
 static unsigned int spf_reason_flags = 0;
 
+DEFINE_MTYPE_STATIC(OSPFD, OSPF_SPF_JOB, "OSPF SPF job")
+
 /* dummy vertex to flag "in spftree" */
 static const struct vertex vertex_in_spftree = {};
 #define LSA_SPF_IN_SPFTREE	(struct vertex *)&vertex_in_spftree
@@ -68,11 +71,6 @@ static void ospf_spf_set_reason(ospf_spf_reason_t reason)
 }
 
 static void ospf_vertex_free(void *);
-/* List of allocated vertices, to simplify cleanup of SPF.
- * Not thread-safe obviously. If it ever needs to be, it'd have to be
- * dynamically allocated at begin of ospf_spf_calculate
- */
-static struct list vertex_list = {.del = ospf_vertex_free};
 
 /* Heap related functions, for the managment of the candidates, to
  * be used with pqueue. */
@@ -177,7 +175,8 @@ static int vertex_parent_cmp(void *aa, void *bb)
 	return IPV4_ADDR_CMP(&a->nexthop->router, &b->nexthop->router);
 }
 
-static struct vertex *ospf_vertex_new(struct ospf_lsa *lsa)
+static struct vertex *ospf_vertex_new(struct ospf_lsa *lsa,
+				      struct list *vertex_list)
 {
 	struct vertex *new;
 
@@ -195,7 +194,7 @@ static struct vertex *ospf_vertex_new(struct ospf_lsa *lsa)
 
 	lsa->stat = new;
 
-	listnode_add(&vertex_list, new);
+	listnode_add(vertex_list, new);
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s: Created %s vertex %s", __func__,
@@ -291,12 +290,12 @@ static void ospf_vertex_add_parent(struct vertex *v)
 	}
 }
 
-static void ospf_spf_init(struct ospf_area *area)
+static void ospf_spf_init(struct ospf_area *area, struct list *vertex_list)
 {
 	struct vertex *v;
 
 	/* Create root node. */
-	v = ospf_vertex_new(area->router_lsa_self);
+	v = ospf_vertex_new(area->router_lsa_self, vertex_list);
 
 	area->spf = v;
 
@@ -794,7 +793,8 @@ static unsigned int ospf_nexthop_calculation(struct ospf_area *area,
  */
 static void ospf_spf_next(struct vertex *v, struct ospf *ospf,
 			  struct ospf_area *area,
-			  struct vertex_pqueue_head *candidate)
+			  struct vertex_pqueue_head *candidate,
+			  struct list *vertex_list)
 {
 	struct ospf_lsa *w_lsa = NULL;
 	uint8_t *p;
@@ -940,7 +940,7 @@ static void ospf_spf_next(struct vertex *v, struct ospf *ospf,
 		/* Is there already vertex W in candidate list? */
 		if (w_lsa->stat == LSA_SPF_NOT_EXPLORED) {
 			/* prepare vertex W. */
-			w = ospf_vertex_new(w_lsa);
+			w = ospf_vertex_new(w_lsa, vertex_list);
 
 			/* Calculate nexthop to W. */
 			if (ospf_nexthop_calculation(area, v, w, l, distance,
@@ -1164,12 +1164,25 @@ ospf_rtrs_print (struct route_table *rtrs)
 }
 #endif
 
-/* Calculating the shortest-path tree for an area. */
-static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
+/* Calculating the shortest-path tree for an area.
+ *
+ * Only touches the area, its LSDB and the tables passed in, besides
+ * reading interface state; areas without virtual links can therefore be
+ * calculated on the SPF worker pthreads, see ospf_spf_calculate_areas().
+ * Transit network routes go to new_table and stub network routes to
+ * new_stubs, which may be the same table.
+ *
+ * Returns false if the area was skipped.
+ */
+static bool ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 			       struct route_table *new_table,
+			       struct route_table *new_stubs,
 			       struct route_table *new_rtrs)
 {
+	/* List of allocated vertices, to simplify cleanup of SPF. */
+	struct list vertex_list = {.del = ospf_vertex_free};
 	struct vertex_pqueue_head candidate;
+	struct timeval start_time;
 	struct vertex *v;
 
 	if (IS_DEBUG_OSPF_EVENT) {
@@ -1186,9 +1199,11 @@ static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 				"ospf_spf_calculate: "
 				"Skip area %s's calculation due to empty router_lsa_self",
 				inet_ntoa(area->area_id));
-		return;
+		return false;
 	}
 
+	monotime(&start_time);
+
 	/* RFC2328 16.1. (1). */
 	/* Initialize the algorithm's data structures. */
 
@@ -1200,7 +1215,7 @@ static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 
 	/* Initialize the shortest-path tree to only the root (which is the
 	   router doing the calculation). */
-	ospf_spf_init(area);
+	ospf_spf_init(area, &vertex_list);
 	v = area->spf;
 	/* Set LSA position to LSA_SPF_IN_SPFTREE. This vertex is the root of
 	 * the
@@ -1213,7 +1228,7 @@ static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 
 	for (;;) {
 		/* RFC2328 16.1. (2). */
-		ospf_spf_next(v, ospf, area, &candidate);
+		ospf_spf_next(v, ospf, area, &candidate, &vertex_list);
 
 		/* RFC2328 16.1. (3). */
 		/* If at this step the candidate list is empty, the shortest-
@@ -1249,7 +1264,7 @@ static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 	}
 
 	/* Second stage of SPF calculation procedure's  */
-	ospf_spf_process_stubs(area, area->spf, new_table, 0);
+	ospf_spf_process_stubs(area, area->spf, new_stubs, 0);
 
 	/* Free candidate queue. */
 	//vertex_pqueue_fini(&candidate);
@@ -1264,17 +1279,286 @@ static void ospf_spf_calculate(struct ospf *ospf, struct ospf_area *area,
 	/* Increment SPF Calculation Counter. */
 	area->spf_calculation++;
 
-	monotime(&area->ospf->ts_spf);
-	area->ts_spf = area->ospf->ts_spf;
-
 	if (IS_DEBUG_OSPF_EVENT)
-		zlog_debug("ospf_spf_calculate: Stop. %zd vertices",
-			   mtype_stats_alloc(MTYPE_OSPF_VERTEX));
+		zlog_debug("ospf_spf_calculate: Stop. %u vertices",
+			   listcount(&vertex_list));
 
 	/* Free SPF vertices, but not the list. List has ospf_vertex_free
 	 * as deconstructor.
 	 */
 	list_delete_all_node(&vertex_list);
+
+	monotime_since(&start_time, &area->ts_spf_duration);
+	monotime(&area->ts_spf);
+	return true;
+}
+
+/*
+ * SPF worker pool.  Each area's SPF is calculated into tables of its own,
+ * which are then merged into the new routing tables in the order the areas
+ * would have been calculated in one after the other.  Transit and stub
+ * network routes are kept apart, as they are added by different rules.
+ */
+struct ospf_spf_job {
+	struct ospf *ospf;
+	struct ospf_area *area;
+	struct route_table *new_table;
+	struct route_table *new_stubs;
+	struct route_table *new_rtrs;
+	/* false to calculate on the main pthread */
+	bool parallel;
+	bool calculated;
+};
+
+static struct frr_pthread *spf_workers[OSPF_SPF_THREADS_MAX];
+static unsigned int spf_workers_count;
+
+static pthread_mutex_t spf_jobs_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t spf_jobs_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int spf_jobs_pending;
+
+static void ospf_spf_workers_start(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	struct frr_pthread *fpt;
+	char os_name[OS_THREAD_NAMELEN];
+
+	while (spf_workers_count < count) {
+		snprintf(os_name, sizeof(os_name), "ospfd_spf%u",
+			 spf_workers_count);
+		fpt = frr_pthread_new(&attr, "OSPF SPF worker", os_name);
+		frr_pthread_run(fpt, NULL);
+		frr_pthread_wait_running(fpt);
+		spf_workers[spf_workers_count++] = fpt;
+	}
+}
+
+void ospf_spf_workers_finish(void)
+{
+	while (spf_workers_count) {
+		struct frr_pthread *fpt = spf_workers[--spf_workers_count];
+
+		frr_pthread_stop(fpt, NULL);
+		frr_pthread_destroy(fpt);
+	}
+}
+
+static int ospf_spf_job_run(struct thread *thread)
+{
+	struct ospf_spf_job *job = THREAD_ARG(thread);
+
+	job->calculated =
+		ospf_spf_calculate(job->ospf, job->area, job->new_table,
+				   job->new_stubs, job->new_rtrs);
+
+	pthread_mutex_lock(&spf_jobs_mtx);
+	if (--spf_jobs_pending == 0)
+		pthread_cond_signal(&spf_jobs_cond);
+	pthread_mutex_unlock(&spf_jobs_mtx);
+	return 0;
+}
+
+/* Merges a transit network route calculated for another area into the
+ * route already in the table, by the rule ospf_intra_add_transit() applies
+ * when the areas are calculated one after the other: replace the route
+ * unless it is more expensive or the current one has the larger Link State
+ * Origin.  Takes ownership of or. */
+static void ospf_spf_merge_transit(struct route_node *dst,
+				   struct ospf_route *or)
+{
+	struct ospf_route *cur_or = dst->info;
+
+	if (or->cost > cur_or->cost
+	    || IPV4_ADDR_CMP(&cur_or->u.std.origin->id, &or->u.std.origin->id)
+		       > 0) {
+		ospf_route_free(or);
+		return;
+	}
+
+	ospf_route_free(cur_or);
+	dst->info = or;
+}
+
+/* Same for a stub network route, by the rule of ospf_intra_add_stub():
+ * update cost, next hops and Link State Origin of the current route, which
+ * keeps its area. */
+static void ospf_spf_merge_stub(struct route_node *dst, struct ospf_route *or)
+{
+	struct ospf_route *cur_or = dst->info;
+
+	if (or->cost == cur_or->cost) {
+		ospf_route_copy_nexthops(cur_or, or->paths);
+
+		if (IPV4_ADDR_CMP(&cur_or->u.std.origin->id,
+				  &or->u.std.origin->id)
+		    < 0)
+			cur_or->u.std.origin = or->u.std.origin;
+	} else if (or->cost < cur_or->cost) {
+		cur_or->cost = or->cost;
+
+		list_delete_all_node(cur_or->paths);
+		ospf_route_copy_nexthops(cur_or, or->paths);
+
+		cur_or->u.std.origin = or->u.std.origin;
+	}
+
+	ospf_route_free(or);
+}
+
+/* Moves an area's network routes into the new routing table, merging them
+ * with routes to the same network from areas already moved. */
+static void ospf_spf_merge_routes(struct route_table *rt,
+				  struct route_table *area_rt, bool transit)
+{
+	struct route_node *rn, *dst;
+	struct ospf_route *or;
+
+	for (rn = route_top(area_rt); rn; rn = route_next(rn)) {
+		if (!(or = rn->info))
+			continue;
+		rn->info = NULL;
+		route_unlock_node(rn);
+
+		dst = route_node_get(rt, &rn->p);
+		if (!dst->info) {
+			dst->info = or;
+			continue;
+		}
+		route_unlock_node(dst);
+
+		if (transit)
+			ospf_spf_merge_transit(dst, or);
+		else
+			ospf_spf_merge_stub(dst, or);
+	}
+	route_table_finish(area_rt);
+}
+
+/* Moves an area's ABR/ASBR routes into the new router table; all of them
+ * are kept, not only the best. */
+static void ospf_spf_merge_rtrs(struct route_table *rtrs,
+				struct route_table *area_rtrs)
+{
+	struct route_node *rn, *dst;
+	struct list *or_list;
+	struct listnode *node;
+	struct ospf_route *or;
+
+	for (rn = route_top(area_rtrs); rn; rn = route_next(rn)) {
+		if (!(or_list = rn->info))
+			continue;
+		rn->info = NULL;
+		route_unlock_node(rn);
+
+		dst = route_node_get(rtrs, &rn->p);
+		if (!dst->info) {
+			dst->info = or_list;
+			continue;
+		}
+		route_unlock_node(dst);
+
+		for (ALL_LIST_ELEMENTS_RO(or_list, node, or))
+			listnode_add(dst->info, or);
+		list_delete(&or_list);
+	}
+	route_table_finish(area_rtrs);
+}
+
+/* Calculates SPF for every area, returns the number of areas calculated. */
+int ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
+			     struct route_table *new_rtrs)
+{
+	struct ospf_spf_job *jobs, *job;
+	struct ospf_area *area;
+	struct listnode *node;
+	unsigned int i, njobs = 0, nparallel = 0, nworkers;
+	int areas_processed = 0;
+
+	if (ospf->spf_threads <= 1 || listcount(ospf->areas) < 2) {
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+			/* Do backbone last, so as to first discover intra-area
+			 * paths for any back-bone virtual-links
+			 */
+			if (ospf->backbone && ospf->backbone == area)
+				continue;
+
+			if (ospf_spf_calculate(ospf, area, new_table,
+					       new_table, new_rtrs))
+				areas_processed++;
+		}
+		goto backbone;
+	}
+
+	ospf_spf_workers_start(ospf->spf_threads);
+
+	jobs = XCALLOC(MTYPE_OSPF_SPF_JOB,
+		       listcount(ospf->areas) * sizeof(*jobs));
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (ospf->backbone && ospf->backbone == area)
+			continue;
+
+		job = &jobs[njobs++];
+		job->ospf = ospf;
+		job->area = area;
+		job->new_table = route_table_init();
+		job->new_stubs = route_table_init();
+		job->new_rtrs = route_table_init();
+
+		/* virtual links are brought up right from the SPF run of
+		 * their transit area, that has to happen here */
+		job->parallel = !ospf_vls_in_area(area);
+		if (job->parallel)
+			nparallel++;
+	}
+
+	pthread_mutex_lock(&spf_jobs_mtx);
+	spf_jobs_pending = nparallel;
+	pthread_mutex_unlock(&spf_jobs_mtx);
+
+	/* the pool isn't shrunk when "spf threads" is lowered */
+	nworkers = MIN(ospf->spf_threads, spf_workers_count);
+	for (i = 0, job = jobs; job < jobs + njobs; job++) {
+		if (!job->parallel)
+			continue;
+		thread_add_event(spf_workers[i++ % nworkers]->master,
+				 ospf_spf_job_run, job, 0, NULL);
+	}
+
+	pthread_mutex_lock(&spf_jobs_mtx);
+	while (spf_jobs_pending)
+		pthread_cond_wait(&spf_jobs_cond, &spf_jobs_mtx);
+	pthread_mutex_unlock(&spf_jobs_mtx);
+
+	for (job = jobs; job < jobs + njobs; job++) {
+		if (!job->parallel)
+			job->calculated = ospf_spf_calculate(
+				ospf, job->area, job->new_table,
+				job->new_stubs, job->new_rtrs);
+		if (job->calculated)
+			areas_processed++;
+
+		/* transit networks first, as they are added in the first
+		 * stage of the calculation */
+		ospf_spf_merge_routes(new_table, job->new_table, true);
+		ospf_spf_merge_routes(new_table, job->new_stubs, false);
+		ospf_spf_merge_rtrs(new_rtrs, job->new_rtrs);
+	}
+	XFREE(MTYPE_OSPF_SPF_JOB, jobs);
+
+backbone:
+	/* SPF for backbone, if required */
+	if (ospf->backbone
+	    && ospf_spf_calculate(ospf, ospf->backbone, new_table, new_table,
+				  new_rtrs))
+		areas_processed++;
+
+	if (areas_processed)
+		monotime(&ospf->ts_spf);
+
+	return areas_processed;
 }
 
 /* Timer for SPF calculation. */
@@ -1282,8 +1566,6 @@ static int ospf_spf_calculate_timer(struct thread *thread)
 {
 	struct ospf *ospf = THREAD_ARG(thread);
 	struct route_table *new_table, *new_rtrs;
-	struct ospf_area *area;
-	struct listnode *node, *nnode;
 	struct timeval start_time, spf_start_time;
 	int areas_processed = 0;
 	unsigned long ia_time, prune_time, rt_time;
@@ -1303,22 +1585,7 @@ static int ospf_spf_calculate_timer(struct thread *thread)
 	ospf_vl_unapprove(ospf);
 
 	/* Calculate SPF for each area. */
-	for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
-		/* Do backbone last, so as to first discover intra-area paths
-		 * for any back-bone virtual-links
-		 */
-		if (ospf->backbone && ospf->backbone == area)
-			continue;
-
-		ospf_spf_calculate(ospf, area, new_table, new_rtrs);
-		areas_processed++;
-	}
-
-	/* SPF for backbone, if required */
-	if (ospf->backbone) {
-		ospf_spf_calculate(ospf, ospf->backbone, new_table, new_rtrs);
-		areas_processed++;
-	}
+	areas_processed = ospf_spf_calculate_areas(ospf, new_table, new_rtrs);
 
 	spf_time = monotime_since(&spf_start_time, NULL);
 
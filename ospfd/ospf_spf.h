@@ -72,8 +72,16 @@ typedef enum {
 	SPF_FLAG_CONFIG_CHANGE,
 } ospf_spf_reason_t;
 
+/* pthreads calculating per-area SPF; 1 calculates on the main pthread */
+#define OSPF_SPF_THREADS_DEFAULT 1
+#define OSPF_SPF_THREADS_MAX 64
+
 extern void ospf_spf_calculate_schedule(struct ospf *, ospf_spf_reason_t);
+extern int ospf_spf_calculate_areas(struct ospf *ospf,
+				    struct route_table *new_table,
+				    struct route_table *new_rtrs);
 extern void ospf_rtrs_free(struct route_table *);
+extern void ospf_spf_workers_finish(void);
 
 /* void ospf_spf_calculate_timer_add (); */
 #endif /* _QUAGGA_OSPF_SPF_H */
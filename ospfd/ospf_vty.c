@@ -2315,6 +2315,32 @@ DEFUN (no_ospf_timers_throttle_spf,
 				   OSPF_SPF_MAX_HOLDTIME_DEFAULT);
 }
 
+DEFPY (ospf_spf_threads,
+       ospf_spf_threads_cmd,
+       "spf threads (1-64)$threads",
+       "SPF calculation\n"
+       "Calculate areas in parallel\n"
+       "Number of pthreads\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	ospf->spf_threads = threads;
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_ospf_spf_threads,
+       no_ospf_spf_threads_cmd,
+       "no spf threads [(1-64)]",
+       NO_STR
+       "SPF calculation\n"
+       "Calculate areas in parallel\n"
+       "Number of pthreads\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	ospf->spf_threads = OSPF_SPF_THREADS_DEFAULT;
+	return CMD_SUCCESS;
+}
 
 DEFUN (ospf_timers_lsa_min_arrival,
        ospf_timers_lsa_min_arrival_cmd,
@@ -2836,6 +2862,11 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		/* Show SPF calculation times. */
 		json_object_int_add(json_area, "spfExecutedCounter",
 				    area->spf_calculation);
+		if (area->ts_spf.tv_sec || area->ts_spf.tv_usec)
+			json_object_int_add(
+				json_area, "spfLastDurationUsecs",
+				(1000000LL * area->ts_spf_duration.tv_sec)
+					+ area->ts_spf_duration.tv_usec);
 		json_object_int_add(json_area, "lsaNumber", area->lsdb->total);
 		json_object_int_add(
 			json_area, "lsaRouterNumber",
@@ -2892,6 +2923,13 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		/* Show SPF calculation times. */
 		vty_out(vty, "   SPF algorithm executed %d times\n",
 			area->spf_calculation);
+		if (area->ts_spf.tv_sec || area->ts_spf.tv_usec) {
+			char timebuf[OSPF_TIME_DUMP_SIZE];
+
+			vty_out(vty, "   Last SPF duration %s\n",
+				ospf_timeval_dump(&area->ts_spf_duration,
+						  timebuf, sizeof(timebuf)));
+		}
 
 		/* Show number of LSA. */
 		vty_out(vty, "   Number of LSA %ld\n", area->lsdb->total);
@@ -3075,6 +3113,7 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 				    ospf->spf_max_holdtime);
 		json_object_int_add(json_vrf, "holdtimeMultplier",
 				    ospf->spf_hold_multiplier);
+		json_object_int_add(json_vrf, "spfThreads", ospf->spf_threads);
 	} else {
 		vty_out(vty,
 			" Initial SPF scheduling delay %d millisec(s)\n"
@@ -3083,6 +3122,9 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 			" Hold time multiplier is currently %d\n",
 			ospf->spf_delay, ospf->spf_holdtime,
 			ospf->spf_max_holdtime, ospf->spf_hold_multiplier);
+		if (ospf->spf_threads > 1)
+			vty_out(vty, " SPF calculated on %u pthreads\n",
+				ospf->spf_threads);
 	}
 
 	if (json) {
@@ -10397,6 +10439,9 @@ static int ospf_config_write_one(struct vty *vty, struct ospf *ospf)
 		vty_out(vty, " timers throttle spf %d %d %d\n", ospf->spf_delay,
 			ospf->spf_holdtime, ospf->spf_max_holdtime);
 
+	if (ospf->spf_threads != OSPF_SPF_THREADS_DEFAULT)
+		vty_out(vty, " spf threads %u\n", ospf->spf_threads);
+
 	/* LSA timers print. */
 	if (ospf->min_ls_interval != OSPF_MIN_LS_INTERVAL)
 		vty_out(vty, " timers throttle lsa all %d\n",
@@ -10831,6 +10876,8 @@ void ospf_vty_init(void)
 	/* SPF timer commands */
 	install_element(OSPF_NODE, &ospf_timers_throttle_spf_cmd);
 	install_element(OSPF_NODE, &no_ospf_timers_throttle_spf_cmd);
+	install_element(OSPF_NODE, &ospf_spf_threads_cmd);
+	install_element(OSPF_NODE, &no_ospf_spf_threads_cmd);
 
 	/* LSA timers commands */
 	install_element(OSPF_NODE, &ospf_timers_min_ls_interval_cmd);
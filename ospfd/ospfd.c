@@ -269,6 +269,7 @@ static struct ospf *ospf_new(unsigned short instance, const char *name)
 	new->spf_holdtime = OSPF_SPF_HOLDTIME_DEFAULT;
 	new->spf_max_holdtime = OSPF_SPF_MAX_HOLDTIME_DEFAULT;
 	new->spf_hold_multiplier = 1;
+	new->spf_threads = OSPF_SPF_THREADS_DEFAULT;
 
 	/* MaxAge init. */
 	new->maxage_delay = OSPF_LSA_MAXAGE_REMOVE_DELAY_DEFAULT;
@@ -543,6 +544,8 @@ void ospf_terminate(void)
 	zclient_stop(zclient);
 	zclient_free(zclient);
 
+	ospf_spf_workers_finish();
+
 	frr_fini();
 }
 
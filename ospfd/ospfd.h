@@ -187,6 +187,7 @@ struct ospf {
 	unsigned int spf_max_holdtime; /* SPF maximum-holdtime */
 	unsigned int
 		spf_hold_multiplier; /* Adaptive multiplier for hold time */
+	unsigned int spf_threads;      /* SPF worker pthreads. */
 
 	int default_originate;	/* Default information originate. */
 #define DEFAULT_ORIGINATE_NONE		0
@@ -418,6 +419,7 @@ struct ospf_area {
 
 	/* Time stamps. */
 	struct timeval ts_spf; /* SPF calculation time stamp. */
+	struct timeval ts_spf_duration; /* Execution time of last SPF. */
 
 	/* Router count. */
 	uint32_t abr_count;  /* ABR router in this area. */
@@ -153,6 +153,8 @@ void pim_ifchannel_delete(struct pim_ifchannel *ch)
 
 	if (ch->upstream->channel_oil) {
 		uint32_t mask = PIM_OIF_FLAG_PROTO_PIM;
+		struct pim_upstream *child;
+
 		if (ch->upstream->flags & PIM_UPSTREAM_FLAG_MASK_SRC_IGMP)
 			mask |= PIM_OIF_FLAG_PROTO_IGMP;
 
@@ -177,17 +179,10 @@ void pim_ifchannel_delete(struct pim_ifchannel *ch)
 		 * Do we have any S,G's that are inheriting?
 		 * Nuke from on high too.
 		 */
-		if (ch->upstream->sources) {
-			struct pim_upstream *child;
-			struct listnode *up_node;
-
-			for (ALL_LIST_ELEMENTS_RO(ch->upstream->sources,
-						  up_node, child))
-				pim_channel_del_inherited_oif(
-						child->channel_oil,
-						ch->interface,
-						__func__);
-		}
+		frr_each (rb_pim_upstream_sources, &ch->upstream->sources,
+			  child)
+			pim_channel_del_inherited_oif(child->channel_oil,
+						      ch->interface, __func__);
 	}
 
 	/*
@@ -298,12 +293,11 @@ void pim_ifchannel_ifjoin_switch(const char *caller, struct pim_ifchannel *ch,
 	if (ch->sg.src.s_addr == INADDR_ANY) {
 		struct pim_upstream *up = ch->upstream;
 		struct pim_upstream *child;
-		struct listnode *up_node;
 
 		if (up) {
 			if (ch->ifjoin_state == PIM_IFJOIN_NOINFO) {
-				for (ALL_LIST_ELEMENTS_RO(up->sources, up_node,
-							  child)) {
+				frr_each (rb_pim_upstream_sources,
+					  &up->sources, child) {
 					struct channel_oil *c_oil =
 						child->channel_oil;
 
@@ -331,8 +325,8 @@ void pim_ifchannel_ifjoin_switch(const char *caller, struct pim_ifchannel *ch,
 				}
 			}
 			if (ch->ifjoin_state == PIM_IFJOIN_JOIN) {
-				for (ALL_LIST_ELEMENTS_RO(up->sources, up_node,
-							  child)) {
+				frr_each (rb_pim_upstream_sources,
+					  &up->sources, child) {
 					if (PIM_DEBUG_PIM_TRACE)
 						zlog_debug(
 							"%s %s: Join(S,G)=%s from %s",
@@ -1133,11 +1127,10 @@ int pim_ifchannel_local_membership_add(struct interface *ifp,
 	if (sg->src.s_addr == INADDR_ANY) {
 		struct pim_upstream *up = pim_upstream_find(pim, sg);
 		struct pim_upstream *child;
-		struct listnode *up_node;
 
 		starch = ch;
 
-		for (ALL_LIST_ELEMENTS_RO(up->sources, up_node, child)) {
+		frr_each (rb_pim_upstream_sources, &up->sources, child) {
 			if (PIM_DEBUG_EVENTS)
 				zlog_debug("%s %s: IGMP (S,G)=%s(%s) from %s",
 					   __FILE__, __func__, child->sg_str,
@@ -1200,11 +1193,10 @@ void pim_ifchannel_local_membership_del(struct interface *ifp,
 	if (sg->src.s_addr == INADDR_ANY) {
 		struct pim_upstream *up = pim_upstream_find(pim_ifp->pim, sg);
 		struct pim_upstream *child;
-		struct listnode *up_node, *up_nnode;
 
 		starch = ch;
 
-		for (ALL_LIST_ELEMENTS(up->sources, up_node, up_nnode, child)) {
+		frr_each_safe (rb_pim_upstream_sources, &up->sources, child) {
 			struct channel_oil *c_oil = child->channel_oil;
 			struct pim_ifchannel *chchannel =
 				pim_ifchannel_find(ifp, &child->sg);
@@ -152,6 +152,10 @@ struct pim_instance {
 	int64_t mroute_del_events;
 	int64_t mroute_del_last;
 
+	/* Bulk collection of the kernel's mroute counters */
+	uint32_t mroute_stats_gen;
+	struct timeval mroute_stats_time;
+
 	struct interface *regiface;
 
 	// List of static routes;
@@ -89,10 +89,9 @@ static void pim_mlag_calculate_df_for_ifchannels(struct pim_upstream *up,
 
 static void pim_mlag_inherit_mlag_flags(struct pim_upstream *up, bool is_df)
 {
-	struct listnode *listnode;
 	struct pim_upstream *child;
 
-	for (ALL_LIST_ELEMENTS_RO(up->sources, listnode, child)) {
+	frr_each (rb_pim_upstream_sources, &up->sources, child) {
 		PIM_UPSTREAM_FLAG_SET_MLAG_PEER(child->flags);
 		if (is_df)
 			PIM_UPSTREAM_FLAG_UNSET_MLAG_NON_DF(child->flags);
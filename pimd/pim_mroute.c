@@ -26,6 +26,7 @@
 #include "plist.h"
 #include "sockopt.h"
 #include "lib_errors.h"
+#include "monotime.h"
 
 #include "pimd.h"
 #include "pim_rpf.h"
@@ -1086,11 +1087,9 @@ static int pim_upstream_mroute_update(struct channel_oil *c_oil,
  */
 static void pim_upstream_all_sources_iif_update(struct pim_upstream *up)
 {
-	struct listnode *listnode;
 	struct pim_upstream *child;
 
-	for (ALL_LIST_ELEMENTS_RO(up->sources, listnode,
-				child)) {
+	frr_each (rb_pim_upstream_sources, &up->sources, child) {
 		if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
 			pim_upstream_mroute_iif_update(child->channel_oil,
 					__func__);
@@ -1209,6 +1208,184 @@ int pim_mroute_del(struct channel_oil *c_oil, const char *name)
 	return 0;
 }
 
+#ifdef HAVE_NETLINK
+/* Netlink socket dumping the kernel's multicast routing tables. */
+static int mroute_stats_sock = -1;
+static uint32_t mroute_stats_seq;
+
+static int pim_mroute_stats_socket(void)
+{
+	struct sockaddr_nl snl;
+	struct timeval timeout = {.tv_sec = 1};
+	int fd;
+
+	if (mroute_stats_sock >= 0)
+		return mroute_stats_sock;
+
+	fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (fd < 0) {
+		zlog_warn("Could not create mroute stats netlink socket: errno=%d: %s",
+			  errno, safe_strerror(errno));
+		return -1;
+	}
+
+	memset(&snl, 0, sizeof(snl));
+	snl.nl_family = AF_NETLINK;
+	if (bind(fd, (struct sockaddr *)&snl, sizeof(snl)) < 0) {
+		zlog_warn("Could not bind mroute stats netlink socket: errno=%d: %s",
+			  errno, safe_strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	/* Never block the main thread on a lost dump */
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	mroute_stats_sock = fd;
+	return fd;
+}
+
+static void pim_mroute_stats_parse(struct pim_instance *pim, uint32_t table,
+				   struct nlmsghdr *h)
+{
+	struct rtmsg *rtm = NLMSG_DATA(h);
+	struct rtattr *rta;
+	struct rta_mfc_stats mfcs;
+	struct channel_oil *c_oil;
+	struct prefix_sg sg;
+	uint64_t lastused = 0;
+	uint32_t rtm_table = rtm->rtm_table;
+	bool stats = false;
+	int len;
+
+	if (rtm->rtm_family != RTNL_FAMILY_IPMR)
+		return;
+
+	memset(&sg, 0, sizeof(sg));
+	len = RTM_PAYLOAD(h);
+	for (rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+		switch (rta->rta_type) {
+		case RTA_TABLE:
+			memcpy(&rtm_table, RTA_DATA(rta), sizeof(rtm_table));
+			break;
+		case RTA_SRC:
+			memcpy(&sg.src, RTA_DATA(rta), sizeof(sg.src));
+			break;
+		case RTA_DST:
+			memcpy(&sg.grp, RTA_DATA(rta), sizeof(sg.grp));
+			break;
+		case RTA_EXPIRES:
+			memcpy(&lastused, RTA_DATA(rta), sizeof(lastused));
+			break;
+		case RTA_MFC_STATS:
+			memcpy(&mfcs, RTA_DATA(rta), sizeof(mfcs));
+			stats = true;
+			break;
+		}
+	}
+
+	if (rtm_table != table || !stats)
+		return;
+
+	c_oil = pim_find_channel_oil(pim, &sg);
+	if (!c_oil || !c_oil->installed)
+		return;
+
+	c_oil->cc_bulk.gen = pim->mroute_stats_gen;
+	c_oil->cc_bulk.lastused = lastused;
+	c_oil->cc_bulk.pktcnt = mfcs.mfcs_packets;
+	c_oil->cc_bulk.bytecnt = mfcs.mfcs_bytes;
+	c_oil->cc_bulk.wrong_if = mfcs.mfcs_wrong_if;
+}
+
+/* Read the counters of all the mroutes of an instance in one dump. */
+static int pim_mroute_stats_dump(struct pim_instance *pim)
+{
+	static char buf[32768];
+	struct {
+		struct nlmsghdr n;
+		struct rtmsg rtm;
+	} req;
+	uint32_t table;
+	int fd;
+
+	fd = pim_mroute_stats_socket();
+	if (fd < 0)
+		return -1;
+
+	/* ipmr puts the default VRF's mroutes in RT_TABLE_DEFAULT */
+	if (pim->vrf_id == VRF_DEFAULT)
+		table = RT_TABLE_DEFAULT;
+	else
+		table = pim->vrf->data.l.table_id;
+
+	memset(&req, 0, sizeof(req));
+	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+	req.n.nlmsg_type = RTM_GETROUTE;
+	req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.n.nlmsg_seq = ++mroute_stats_seq;
+	req.rtm.rtm_family = RTNL_FAMILY_IPMR;
+
+	if (send(fd, &req, req.n.nlmsg_len, 0) < 0) {
+		zlog_warn("%s: send() failure: errno=%d: %s", __func__, errno,
+			  safe_strerror(errno));
+		return -1;
+	}
+
+	while (true) {
+		struct nlmsghdr *h;
+		int len;
+
+		len = recv(fd, buf, sizeof(buf), 0);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0) {
+			zlog_warn("%s: recv() failure: errno=%d: %s", __func__,
+				  errno, safe_strerror(errno));
+			return -1;
+		}
+
+		for (h = (struct nlmsghdr *)buf; NLMSG_OK(h, len);
+		     h = NLMSG_NEXT(h, len)) {
+			/* leftovers of an earlier, aborted dump */
+			if (h->nlmsg_seq != mroute_stats_seq)
+				continue;
+
+			switch (h->nlmsg_type) {
+			case NLMSG_DONE:
+				return 0;
+			case NLMSG_ERROR:
+				zlog_warn("%s: mroute dump failed", __func__);
+				return -1;
+			case RTM_NEWROUTE:
+				pim_mroute_stats_parse(pim, table, h);
+				break;
+			}
+		}
+	}
+}
+#endif /* HAVE_NETLINK */
+
+/*
+ * Refresh the bulk collected counters of an instance if they're older than
+ * PIM_MROUTE_STATS_INTERVAL.
+ */
+static void pim_mroute_stats_refresh(struct pim_instance *pim)
+{
+#ifdef HAVE_NETLINK
+	if (pim->mroute_stats_gen
+	    && monotime_since(&pim->mroute_stats_time, NULL)
+		       < PIM_MROUTE_STATS_INTERVAL * 1000000LL)
+		return;
+
+	monotime(&pim->mroute_stats_time);
+	pim->mroute_stats_gen++;
+	if (pim_mroute_stats_dump(pim) == 0 && PIM_DEBUG_MROUTE)
+		zlog_debug("%s: collected mroute counters of vrf %s",
+			   __func__, pim->vrf->name);
+#endif /* HAVE_NETLINK */
+}
+
 void pim_mroute_update_counters(struct channel_oil *c_oil)
 {
 	struct pim_instance *pim = c_oil->pim;
@@ -1233,6 +1410,22 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 		return;
 	}
 
+	/*
+	 * Use the last bulk collection, unless this channel was already
+	 * updated from it: counters are compared against their previous
+	 * values, which have to be from an older read.
+	 */
+	pim_mroute_stats_refresh(pim);
+	if (c_oil->cc_bulk.gen == pim->mroute_stats_gen
+	    && c_oil->cc_bulk.used_gen != c_oil->cc_bulk.gen) {
+		c_oil->cc_bulk.used_gen = c_oil->cc_bulk.gen;
+		c_oil->cc.lastused = c_oil->cc_bulk.lastused;
+		c_oil->cc.pktcnt = c_oil->cc_bulk.pktcnt;
+		c_oil->cc.bytecnt = c_oil->cc_bulk.bytecnt;
+		c_oil->cc.wrong_if = c_oil->cc_bulk.wrong_if;
+		return;
+	}
+
 	memset(&sgreq, 0, sizeof(sgreq));
 	sgreq.src = c_oil->oil.mfcc_origin;
 	sgreq.grp = c_oil->oil.mfcc_mcastgrp;
@@ -182,6 +182,12 @@ void pim_static_mroute_iif_update(struct channel_oil *c_oil,
 				const char *name);
 int pim_mroute_del(struct channel_oil *c_oil, const char *name);
 
+/*
+ * The kernel's counters of all the mroutes of an instance are read in one
+ * netlink dump at most this often, instead of one SIOCGETSGCNT per mroute.
+ */
+#define PIM_MROUTE_STATS_INTERVAL 5 /* seconds */
+
 void pim_mroute_update_counters(struct channel_oil *c_oil);
 bool pim_mroute_allow_iif_in_oil(struct channel_oil *c_oil,
 		int oif_index);
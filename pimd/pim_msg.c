@@ -117,7 +117,6 @@ size_t pim_msg_get_jp_group_size(struct list *sources)
 	js = listgetdata(listhead(sources));
 	if (js && js->up->sg.src.s_addr == INADDR_ANY && js->is_join) {
 		struct pim_upstream *child, *up;
-		struct listnode *up_node;
 
 		up = js->up;
 		if (PIM_DEBUG_PIM_PACKETS)
@@ -125,7 +124,7 @@ size_t pim_msg_get_jp_group_size(struct list *sources)
 				"%s: Considering (%s) children for (S,G,rpt) prune",
 				__func__, up->sg_str);
 
-		for (ALL_LIST_ELEMENTS_RO(up->sources, up_node, child)) {
+		frr_each (rb_pim_upstream_sources, &up->sources, child) {
 			if (!PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags)) {
 				/* If we are using SPT and the SPT and RPT IIFs
 				 * are different we can prune the source off
@@ -215,7 +214,7 @@ size_t pim_msg_build_jp_groups(struct pim_jp_groups *grp,
 	if (up) {
 		struct pim_upstream *child;
 
-		for (ALL_LIST_ELEMENTS(up->sources, node, nnode, child)) {
+		frr_each_safe (rb_pim_upstream_sources, &up->sources, child) {
 			if (PIM_UPSTREAM_FLAG_TEST_SEND_SG_RPT_PRUNE(
 				    child->flags)) {
 				pim_msg_addr_encode_ipv4_source(
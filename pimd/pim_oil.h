@@ -65,6 +65,18 @@ struct channel_counts {
 	unsigned long oldwrong_if;
 };
 
+/* Kernel counters of a channel read by a bulk collection. */
+struct channel_counts_bulk {
+	/* Collection these were read in, see pim->mroute_stats_gen */
+	uint32_t gen;
+	/* Last collection copied over to the channel_counts */
+	uint32_t used_gen;
+	unsigned long long lastused;
+	unsigned long pktcnt;
+	unsigned long bytecnt;
+	unsigned long wrong_if;
+};
+
 /*
   qpim_channel_oil_list holds a list of struct channel_oil.
 
@@ -105,6 +117,7 @@ struct channel_oil {
 	time_t oif_creation[MAXVIFS];
 	uint32_t oif_flags[MAXVIFS];
 	struct channel_counts cc;
+	struct channel_counts_bulk cc_bulk;
 	struct pim_upstream *up;
 	time_t mroute_creation;
 };
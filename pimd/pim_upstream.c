@@ -69,25 +69,16 @@ static void pim_upstream_remove_children(struct pim_instance *pim,
 {
 	struct pim_upstream *child;
 
-	if (!up->sources)
-		return;
-
-	while (!list_isempty(up->sources)) {
-		child = listnode_head(up->sources);
-		listnode_delete(up->sources, child);
+	while ((child = rb_pim_upstream_sources_pop(&up->sources))) {
+		child->parent = NULL;
 		if (PIM_UPSTREAM_FLAG_TEST_SRC_LHR(child->flags)) {
 			PIM_UPSTREAM_FLAG_UNSET_SRC_LHR(child->flags);
 			child = pim_upstream_del(pim, child, __func__);
 		}
-		if (child) {
-			child->parent = NULL;
-			if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
-				pim_upstream_mroute_iif_update(
-						child->channel_oil,
-						__func__);
-		}
+		if (child && PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
+			pim_upstream_mroute_iif_update(child->channel_oil,
+						       __func__);
 	}
-	list_delete(&up->sources);
 }
 
 /*
@@ -98,27 +89,32 @@ static void pim_upstream_remove_children(struct pim_instance *pim,
 static void pim_upstream_find_new_children(struct pim_instance *pim,
 					   struct pim_upstream *up)
 {
-	struct pim_upstream *child;
+	struct pim_upstream *child, *next, lookup;
 
+	/* Only a (*,G) has children */
 	if ((up->sg.src.s_addr != INADDR_ANY)
-	    && (up->sg.grp.s_addr != INADDR_ANY))
+	    || (up->sg.grp.s_addr == INADDR_ANY))
 		return;
 
-	if ((up->sg.src.s_addr == INADDR_ANY)
-	    && (up->sg.grp.s_addr == INADDR_ANY))
-		return;
+	/*
+	 * upstream_head is sorted by group first, so the (S,G)s of the
+	 * group are the entries right after the (*,G) itself
+	 */
+	lookup.sg.grp = up->sg.grp;
+	lookup.sg.src.s_addr = INADDR_ANY;
+	next = rb_pim_upstream_find_gteq(&pim->upstream_head, &lookup);
+
+	frr_each_from (rb_pim_upstream, &pim->upstream_head, child, next) {
+		if (child->sg.grp.s_addr != up->sg.grp.s_addr)
+			break;
+		if (child == up)
+			continue;
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, child) {
-		if ((up->sg.grp.s_addr != INADDR_ANY)
-		    && (child->sg.grp.s_addr == up->sg.grp.s_addr)
-		    && (child != up)) {
-			child->parent = up;
-			listnode_add_sort(up->sources, child);
-			if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
-				pim_upstream_mroute_iif_update(
-						child->channel_oil,
-						__func__);
-		}
+		child->parent = up;
+		rb_pim_upstream_sources_add(&up->sources, child);
+		if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
+			pim_upstream_mroute_iif_update(child->channel_oil,
+						       __func__);
 	}
 }
 
@@ -140,7 +136,7 @@ static struct pim_upstream *pim_upstream_find_parent(struct pim_instance *pim,
 		up = pim_upstream_find(pim, &any);
 
 		if (up)
-			listnode_add(up->sources, child);
+			rb_pim_upstream_sources_add(&up->sources, child);
 
 		/*
 		 * In case parent is MLAG entry copy the data to child
@@ -242,11 +238,10 @@ struct pim_upstream *pim_upstream_del(struct pim_instance *pim,
 	list_delete(&up->ifchannels);
 
 	pim_upstream_remove_children(pim, up);
-	if (up->sources)
-		list_delete(&up->sources);
+	rb_pim_upstream_sources_fini(&up->sources);
 
-	if (up->parent && up->parent->sources)
-		listnode_delete(up->parent->sources, up);
+	if (up->parent)
+		rb_pim_upstream_sources_del(&up->parent->sources, up);
 	up->parent = NULL;
 
 	rb_pim_upstream_del(&pim->upstream_head, up);
@@ -847,14 +842,8 @@ static struct pim_upstream *pim_upstream_new(struct pim_instance *pim,
 				   __func__);
 	}
 
+	rb_pim_upstream_sources_init(&up->sources);
 	up->parent = pim_upstream_find_parent(pim, up);
-	if (up->sg.src.s_addr == INADDR_ANY) {
-		up->sources = list_new();
-		up->sources->cmp =
-			(int (*)(void *, void *))pim_upstream_compare;
-	} else
-		up->sources = NULL;
-
 	pim_upstream_find_new_children(pim, up);
 	up->flags = flags;
 	up->ref_count = 1;
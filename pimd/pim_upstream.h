@@ -198,6 +198,7 @@ struct pim_up_mlag {
 };
 
 PREDECL_RBTREE_UNIQ(rb_pim_upstream);
+PREDECL_RBTREE_UNIQ(rb_pim_upstream_sources);
 /*
   Upstream (S,G) channel in Joined state
   (S,G) in the "Not Joined" state is not represented
@@ -229,13 +230,16 @@ struct pim_upstream {
 	struct pim_instance *pim;
 	struct rb_pim_upstream_item upstream_rb;
 	struct pim_upstream *parent;
+	/* Entry in the parent's sources */
+	struct rb_pim_upstream_sources_item sources_rb;
 	struct in_addr upstream_addr;     /* Who we are talking to */
 	struct in_addr upstream_register; /*Who we received a register from*/
 	struct prefix_sg sg;		  /* (S,G) group key */
 	char sg_str[PIM_SG_LEN];
 	uint32_t flags;
 	struct channel_oil *channel_oil;
-	struct list *sources;
+	/* (S,G) children of a (*,G) */
+	struct rb_pim_upstream_sources_head sources;
 	struct list *ifchannels;
 	/* Counter for Dual active ifchannels*/
 	uint32_t dualactive_ifchannel_count;
@@ -373,6 +377,8 @@ int pim_upstream_compare(const struct pim_upstream *up1,
 			 const struct pim_upstream *up2);
 DECLARE_RBTREE_UNIQ(rb_pim_upstream, struct pim_upstream, upstream_rb,
 		    pim_upstream_compare)
+DECLARE_RBTREE_UNIQ(rb_pim_upstream_sources, struct pim_upstream, sources_rb,
+		    pim_upstream_compare)
 
 void pim_upstream_register_reevaluate(struct pim_instance *pim);
 
@@ -608,11 +608,9 @@ static void pim_vxlan_update_sg_entry_mlag(struct pim_instance *pim,
 void pim_vxlan_inherit_mlag_flags(struct pim_instance *pim,
 		struct pim_upstream *up, bool inherit)
 {
-	struct listnode *listnode;
 	struct pim_upstream *child;
 
-	for (ALL_LIST_ELEMENTS_RO(up->sources, listnode,
-				child)) {
+	frr_each (rb_pim_upstream_sources, &up->sources, child) {
 		pim_vxlan_update_sg_entry_mlag(pim,
 				child, true /* inherit */);
 	}
@@ -955,7 +953,6 @@ static void pim_vxlan_term_mr_cost_update(struct hash_bucket *backet, void *arg)
 	struct interface *old_peerlink_rif = (struct interface *)arg;
 	struct pim_vxlan_sg *vxlan_sg = (struct pim_vxlan_sg *)backet->data;
 	struct pim_upstream *up;
-	struct listnode *listnode;
 	struct pim_upstream *child;
 
 	if (pim_vxlan_is_orig_mroute(vxlan_sg))
@@ -969,8 +966,7 @@ static void pim_vxlan_term_mr_cost_update(struct hash_bucket *backet, void *arg)
 	pim_vxlan_up_cost_update(vxlan_sg->pim, up,
 			old_peerlink_rif);
 
-	for (ALL_LIST_ELEMENTS_RO(up->sources, listnode,
-				child))
+	frr_each (rb_pim_upstream_sources, &up->sources, child)
 		pim_vxlan_up_cost_update(vxlan_sg->pim, child,
 				old_peerlink_rif);
 }
@@ -42,6 +42,9 @@ struct sharp_routes {
 	uint8_t inst;
 	vrf_id_t vrf_id;
 
+	/* send many routes per ZAPI message */
+	bool batch;
+
 	struct timeval t_start;
 	struct timeval t_end;
 };
@@ -167,7 +167,7 @@ DEFPY (install_routes,
 	  <nexthop <A.B.C.D$nexthop4|X:X::X:X$nexthop6>|\
 	   nexthop-group NHGNAME$nexthop_group>\
 	  [backup$backup <A.B.C.D$backup_nexthop4|X:X::X:X$backup_nexthop6>] \
-	  (1-1000000)$routes [instance (0-255)$instance] [repeat (2-1000)$rpt]",
+	  (1-1000000)$routes [instance (0-255)$instance] [repeat (2-1000)$rpt] [batch$batch]",
        "Sharp routing Protocol\n"
        "install some routes\n"
        "Routes to install\n"
@@ -187,7 +187,8 @@ DEFPY (install_routes,
        "Instance to use\n"
        "Instance\n"
        "Should we repeat this command\n"
-       "How many times to repeat this command\n")
+       "How many times to repeat this command\n"
+       "Send many routes per message to zebra\n")
 {
 	struct vrf *vrf;
 	struct prefix prefix;
@@ -195,6 +196,7 @@ DEFPY (install_routes,
 
 	sg.r.total_routes = routes;
 	sg.r.installed_routes = 0;
+	sg.r.batch = !!batch;
 
 	if (rpt >= 2)
 		sg.r.repeat = rpt * 2;
@@ -334,7 +336,7 @@ DEFPY(vrf_label, vrf_label_cmd,
 
 DEFPY (remove_routes,
        remove_routes_cmd,
-       "sharp remove routes [vrf NAME$vrf_name] <A.B.C.D$start4|X:X::X:X$start6> (1-1000000)$routes [instance (0-255)$instance]",
+       "sharp remove routes [vrf NAME$vrf_name] <A.B.C.D$start4|X:X::X:X$start6> (1-1000000)$routes [instance (0-255)$instance] [batch$batch]",
        "Sharp Routing Protocol\n"
        "Remove some routes\n"
        "Routes to remove\n"
@@ -344,13 +346,15 @@ DEFPY (remove_routes,
        "v6 Starting spot\n"
        "Routes to uninstall\n"
        "instance to use\n"
-       "Value of instance\n")
+       "Value of instance\n"
+       "Send many routes per message to zebra\n")
 {
 	struct vrf *vrf;
 	struct prefix prefix;
 
 	sg.r.total_routes = routes;
 	sg.r.removed_routes = 0;
+	sg.r.batch = !!batch;
 	uint32_t rts;
 
 	memset(&prefix, 0, sizeof(prefix));
@@ -142,13 +142,17 @@ int sharp_install_lsps_helper(bool install_p, const struct prefix *p,
 	return ret;
 }
 
+/* prefixes handed to zclient_route_batch_send() at once */
+#define SHARP_BATCH_SIZE 1024
+static struct prefix batch[SHARP_BATCH_SIZE];
+
 void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 				 uint8_t instance,
 				 const struct nexthop_group *nhg,
 				 const struct nexthop_group *backup_nhg,
 				 uint32_t routes)
 {
-	uint32_t temp, i;
+	uint32_t temp, i, n = 0;
 	bool v4 = false;
 
 	zlog_debug("Inserting %u routes", routes);
@@ -165,7 +169,18 @@ void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 
 	monotime(&sg.r.t_start);
 	for (i = 0; i < routes; i++) {
-		route_add(p, vrf_id, (uint8_t)instance, nhg, backup_nhg);
+		if (!sg.r.batch)
+			route_add(p, vrf_id, (uint8_t)instance, nhg,
+				  backup_nhg);
+		else {
+			batch[n++] = *p;
+			if (n == SHARP_BATCH_SIZE || i == routes - 1) {
+				route_add_batch(batch, n, vrf_id,
+						(uint8_t)instance, nhg,
+						backup_nhg);
+				n = 0;
+			}
+		}
 		if (v4)
 			p->u.prefix4.s_addr = htonl(++temp);
 		else
@@ -176,7 +191,7 @@ void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 void sharp_remove_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 				uint8_t instance, uint32_t routes)
 {
-	uint32_t temp, i;
+	uint32_t temp, i, n = 0;
 	bool v4 = false;
 
 	zlog_debug("Removing %u routes", routes);
@@ -189,7 +204,16 @@ void sharp_remove_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 
 	monotime(&sg.r.t_start);
 	for (i = 0; i < routes; i++) {
-		route_delete(p, vrf_id, (uint8_t)instance);
+		if (!sg.r.batch)
+			route_delete(p, vrf_id, (uint8_t)instance);
+		else {
+			batch[n++] = *p;
+			if (n == SHARP_BATCH_SIZE || i == routes - 1) {
+				route_delete_batch(batch, n, vrf_id,
+						   (uint8_t)instance);
+				n = 0;
+			}
+		}
 		if (v4)
 			p->u.prefix4.s_addr = htonl(++temp);
 		else
@@ -283,53 +307,74 @@ void vrf_label_add(vrf_id_t vrf_id, afi_t afi, mpls_label_t label)
 	zclient_send_vrf_label(zclient, vrf_id, afi, label, ZEBRA_LSP_SHARP);
 }
 
-void route_add(const struct prefix *p, vrf_id_t vrf_id,
-	       uint8_t instance, const struct nexthop_group *nhg,
-	       const struct nexthop_group *backup_nhg)
+static void route_add_api(struct zapi_route *api, vrf_id_t vrf_id,
+			  uint8_t instance, const struct nexthop_group *nhg,
+			  const struct nexthop_group *backup_nhg)
 {
-	struct zapi_route api;
 	struct zapi_nexthop *api_nh;
 	struct nexthop *nh;
 	int i = 0;
 
-	memset(&api, 0, sizeof(api));
-	api.vrf_id = vrf_id;
-	api.type = ZEBRA_ROUTE_SHARP;
-	api.instance = instance;
-	api.safi = SAFI_UNICAST;
-	memcpy(&api.prefix, p, sizeof(*p));
+	memset(api, 0, sizeof(*api));
+	api->vrf_id = vrf_id;
+	api->type = ZEBRA_ROUTE_SHARP;
+	api->instance = instance;
+	api->safi = SAFI_UNICAST;
 
-	SET_FLAG(api.flags, ZEBRA_FLAG_ALLOW_RECURSION);
-	SET_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP);
+	SET_FLAG(api->flags, ZEBRA_FLAG_ALLOW_RECURSION);
+	SET_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP);
 
 	for (ALL_NEXTHOPS_PTR(nhg, nh)) {
-		api_nh = &api.nexthops[i];
+		api_nh = &api->nexthops[i];
 
 		zapi_nexthop_from_nexthop(api_nh, nh);
 
 		i++;
 	}
-	api.nexthop_num = i;
+	api->nexthop_num = i;
 
 	/* Include backup nexthops, if present */
 	if (backup_nhg && backup_nhg->nexthop) {
-		SET_FLAG(api.message, ZAPI_MESSAGE_BACKUP_NEXTHOPS);
+		SET_FLAG(api->message, ZAPI_MESSAGE_BACKUP_NEXTHOPS);
 
 		i = 0;
 		for (ALL_NEXTHOPS_PTR(backup_nhg, nh)) {
-			api_nh = &api.backup_nexthops[i];
+			api_nh = &api->backup_nexthops[i];
 
 			zapi_backup_nexthop_from_nexthop(api_nh, nh);
 
 			i++;
 		}
 
-		api.backup_nexthop_num = i;
+		api->backup_nexthop_num = i;
 	}
+}
+
+void route_add(const struct prefix *p, vrf_id_t vrf_id,
+	       uint8_t instance, const struct nexthop_group *nhg,
+	       const struct nexthop_group *backup_nhg)
+{
+	struct zapi_route api;
+
+	route_add_api(&api, vrf_id, instance, nhg, backup_nhg);
+	memcpy(&api.prefix, p, sizeof(*p));
 
 	zclient_route_send(ZEBRA_ROUTE_ADD, zclient, &api);
 }
 
+void route_add_batch(const struct prefix *prefixes, uint32_t count,
+		     vrf_id_t vrf_id, uint8_t instance,
+		     const struct nexthop_group *nhg,
+		     const struct nexthop_group *backup_nhg)
+{
+	struct zapi_route api;
+
+	route_add_api(&api, vrf_id, instance, nhg, backup_nhg);
+
+	zclient_route_batch_send(ZEBRA_ROUTE_ADD_BATCH, zclient, &api,
+				 prefixes, count);
+}
+
 void route_delete(struct prefix *p, vrf_id_t vrf_id, uint8_t instance)
 {
 	struct zapi_route api;
@@ -345,6 +390,20 @@ void route_delete(struct prefix *p, vrf_id_t vrf_id, uint8_t instance)
 	return;
 }
 
+void route_delete_batch(const struct prefix *prefixes, uint32_t count,
+			vrf_id_t vrf_id, uint8_t instance)
+{
+	struct zapi_route api;
+
+	memset(&api, 0, sizeof(api));
+	api.vrf_id = vrf_id;
+	api.type = ZEBRA_ROUTE_SHARP;
+	api.safi = SAFI_UNICAST;
+	api.instance = instance;
+	zclient_route_batch_send(ZEBRA_ROUTE_DELETE_BATCH, zclient, &api,
+				 prefixes, count);
+}
+
 void sharp_zebra_nexthop_watch(struct prefix *p, vrf_id_t vrf_id, bool import,
 			       bool watch, bool connected)
 {
@@ -29,6 +29,12 @@ extern void route_add(const struct prefix *p, vrf_id_t, uint8_t instance,
 		      const struct nexthop_group *nhg,
 		      const struct nexthop_group *backup_nhg);
 extern void route_delete(struct prefix *p, vrf_id_t vrf_id, uint8_t instance);
+extern void route_add_batch(const struct prefix *prefixes, uint32_t count,
+			    vrf_id_t vrf_id, uint8_t instance,
+			    const struct nexthop_group *nhg,
+			    const struct nexthop_group *backup_nhg);
+extern void route_delete_batch(const struct prefix *prefixes, uint32_t count,
+			       vrf_id_t vrf_id, uint8_t instance);
 extern void sharp_zebra_nexthop_watch(struct prefix *p, vrf_id_t vrf_id,
 				      bool import, bool watch, bool connected);
 
@@ -0,0 +1,179 @@
+/*
+ * Tears down VRF sockets and shuts down while the BFD fast path is busy
+ * reading packets, the way bfd_vrf_disable() and bfdd's SIGTERM handler
+ * do.  Best run with the address sanitizer enabled.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "memory.h"
+#include "privs.h"
+#include "vrf.h"
+
+#include "bfdd/bfd.h"
+
+/* need these to link in libbfd */
+DEFINE_MGROUP(BFDD, "Bidirectional Forwarding Detection Daemon")
+DEFINE_MTYPE(BFDD, BFDD_CONTROL, "long-lived control socket memory")
+DEFINE_MTYPE(BFDD, BFDD_NOTIFICATION, "short-lived control notification data")
+
+struct thread_master *master;
+struct bfd_global bglobal;
+
+const struct bfd_diag_str_list diag_list[] = {
+	{.str = NULL},
+};
+
+const struct bfd_state_str_list state_list[] = {
+	{.str = NULL},
+};
+
+void socket_close(int *s)
+{
+	if (*s <= 0)
+		return;
+
+	close(*s);
+	*s = -1;
+}
+
+/* how long to let the fast path read before tearing down, in usec */
+#define READ_TIME 100000
+
+static int sv[2] = {-1, -1};
+static pthread_t writer;
+static _Atomic bool writing;
+
+static void *test_writer(void *arg)
+{
+	char pkt[BFD_PKT_LEN] = {};
+
+	while (atomic_load_explicit(&writing, memory_order_relaxed))
+		send(sv[1], pkt, sizeof(pkt), MSG_DONTWAIT);
+
+	return NULL;
+}
+
+/* Sets up a VRF with one socket the fast path reads a packet flood from. */
+static struct bfd_vrf_global *test_vrf_start(struct vrf *vrf)
+{
+	struct bfd_vrf_global *bvrf;
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) != 0) {
+		printf("socketpair: %s\n", safe_strerror(errno));
+		exit(1);
+	}
+
+	bvrf = XCALLOC(MTYPE_TMP, sizeof(*bvrf));
+	bvrf->vrf = vrf;
+	bvrf->bg_shop = sv[0];
+	bvrf->bg_mhop = -1;
+	bvrf->bg_shop6 = -1;
+	bvrf->bg_mhop6 = -1;
+	bvrf->bg_echo = -1;
+	bvrf->bg_echov6 = -1;
+	vrf->info = bvrf;
+
+	thread_add_read(bfd_fastpath_master(), bfd_recv_cb, bvrf,
+			bvrf->bg_shop, &bvrf->bg_ev[0]);
+
+	atomic_store_explicit(&writing, true, memory_order_relaxed);
+	pthread_create(&writer, NULL, test_writer, NULL);
+
+	usleep(READ_TIME);
+
+	return bvrf;
+}
+
+/* Closes and frees the VRF's socket and state, as bfd_vrf_disable() does. */
+static void test_vrf_stop(struct vrf *vrf, struct bfd_vrf_global *bvrf)
+{
+	size_t i;
+
+	for (i = 0; i < array_size(bvrf->bg_ev); i++)
+		assert(bvrf->bg_ev[i] == NULL);
+
+	atomic_store_explicit(&writing, false, memory_order_relaxed);
+	pthread_join(writer, NULL);
+
+	socket_close(&bvrf->bg_shop);
+	close(sv[1]);
+
+	XFREE(MTYPE_TMP, bvrf);
+	vrf->info = NULL;
+}
+
+static void test_on_fastpath(void *arg)
+{
+	bool *ran = arg;
+
+	*ran = bfd_fastpath_self();
+}
+
+static void test_stop_reads(void *arg)
+{
+	bfd_vrfs_stop_reads();
+}
+
+int main(int argc, char **argv)
+{
+	struct bfd_vrf_global *bvrf;
+	struct vrf *vrf;
+	bool ran = false;
+
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	zprivs_preinit(&bglobal.bfdd_privs);
+
+	master = thread_master_create(NULL);
+	frr_pthread_init();
+	vrf_init(NULL, NULL, NULL, NULL, NULL);
+	vrf = vrf_lookup_by_id(VRF_DEFAULT);
+
+	bfd_initialize();
+	bfd_fastpath_init();
+	bfd_fastpath_run();
+
+	bfd_fastpath_call(test_on_fastpath, &ran);
+	assert(ran);
+
+	/* VRF disabled while packets come in. */
+	bvrf = test_vrf_start(vrf);
+	bfd_fastpath_call(test_stop_reads, NULL);
+	test_vrf_stop(vrf, bvrf);
+
+	/* The fast path carries on without it. */
+	ran = false;
+	bfd_fastpath_call(test_on_fastpath, &ran);
+	assert(ran);
+
+	/* Shutdown while packets come in, in SIGTERM handler order. */
+	bvrf = test_vrf_start(vrf);
+	bfd_fastpath_stop();
+	test_vrf_stop(vrf, bvrf);
+	bfd_shutdown();
+	vrf_terminate();
+	bfd_fastpath_fini();
+
+	frr_pthread_finish();
+	thread_master_free(master);
+
+	printf("BFD fast path test successful.\n");
+	return 0;
+}
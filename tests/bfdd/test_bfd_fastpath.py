@@ -0,0 +1,6 @@
+import frrtest
+
+class TestBfdFastpath(frrtest.TestMultiOut):
+    program = './test_bfd_fastpath'
+
+TestBfdFastpath.onesimple('BFD fast path test successful.')
@@ -1305,7 +1305,7 @@ static int handle_attr_test(struct aspath_tests *t)
 	asp = make_aspath(t->segment->asdata, t->segment->len, 0);
 
 	peer.curr = stream_new(BGP_MAX_PACKET_SIZE);
-	peer.obuf = stream_fifo_new();
+	bgp_io_bufs_new(&peer);
 	peer.bgp = &bgp;
 	peer.host = (char *)"none";
 	peer.fd = -1;
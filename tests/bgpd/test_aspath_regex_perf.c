@@ -0,0 +1,250 @@
+/*
+ * Test program which compares the compiled AS path regular expressions
+ * against POSIX regexec() on the AS path string, for a set of typical
+ * as-path access-list entries applied to received paths.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "privs.h"
+#include "memory.h"
+#include "monotime.h"
+#include "zclient.h"
+#include "frr_pthread.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_regex.h"
+
+/* number of distinct paths, small enough for make check; pass a larger
+ * count on the command line for meaningful timings */
+#define REGEX_PATHS 2000
+/* prefixes per UPDATE, each of which gets the filters applied */
+#define REGEX_PREFIXES_PER_PATH 8
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+extern struct zclient *zclient;
+struct zebra_privs_t bgpd_privs = {
+	.user = NULL,
+	.group = NULL,
+	.vty_group = NULL,
+};
+
+/* as-path access-list entries as seen in the wild; the %u are filled in
+ * with different ASNs to make up 50+ filters */
+static const char *const templates[] = {
+	"_%u_",
+	"^%u_",
+	"_%u$",
+	"^%u$",
+	"^%u_[0-9]+$",
+	"_%u_.*_174_",
+	"^(%u|3356|1299)_",
+	"_(64512|6451[3-9]|%u)_",
+	"^%u(_%u)*$",
+	"_%u[0-9]_",
+	"^[0-9]+_%u_",
+	"^$",
+	"_{%u",
+};
+
+static const as_t asns[] = {174,   209,   701,   1239,  1299,  2914,
+			    3257,  3320,  3356,  3491,  5511,  6453,
+			    6461,  6762,  6830,  6939,  7018,  12956,
+			    13335, 15169, 16509, 20940, 32934, 65001};
+
+static char *filter_str[array_size(templates) * 4];
+static struct bgp_aspath_regex *filters[array_size(filter_str)];
+static regex_t *posix[array_size(filter_str)];
+
+static void setup_filters(void)
+{
+	char buf[64];
+	unsigned int i, as;
+
+	for (i = 0; i < array_size(filter_str); i++) {
+		as = asns[(i * 7) % array_size(asns)];
+		snprintf(buf, sizeof(buf), templates[i % array_size(templates)],
+			 as, as);
+		filter_str[i] = strdup(buf);
+		filters[i] = bgp_aspath_regcomp(buf);
+		posix[i] = bgp_regcomp(buf);
+		assert(filters[i] && posix[i]);
+	}
+}
+
+static struct aspath *make_path(unsigned int n)
+{
+	char buf[256];
+	unsigned int len, i, prepend;
+	int off;
+
+	len = 1 + n % 7;
+	prepend = n % 5 == 0 ? 3 : 1;
+	off = 0;
+
+	/* peer AS, possibly prepended, then the rest of the path */
+	for (i = 0; i < prepend; i++)
+		off += snprintf(buf + off, sizeof(buf) - off, "%s%u",
+				i ? " " : "", asns[n % array_size(asns)]);
+	for (i = 1; i < len; i++)
+		off += snprintf(buf + off, sizeof(buf) - off, " %u",
+				asns[(n / (i + 1) + i * 5) % array_size(asns)]
+					+ (i == len - 1 ? n % 4096 : 0));
+	if (n % 97 == 0)
+		snprintf(buf + off, sizeof(buf) - off, " {%u,%u}",
+			 asns[n % array_size(asns)], 64512 + n % 100);
+
+	return aspath_str2aspath(buf);
+}
+
+static unsigned long run_posix(struct aspath **paths, size_t count,
+			       uint8_t *verdicts)
+{
+	struct timeval start;
+	size_t i, f;
+	int p;
+
+	monotime(&start);
+
+	for (i = 0; i < count; i++)
+		for (p = 0; p < REGEX_PREFIXES_PER_PATH; p++)
+			for (f = 0; f < array_size(filters); f++)
+				verdicts[i * array_size(filters) + f] =
+					regexec(posix[f], paths[i]->str, 0,
+						NULL, 0)
+					!= REG_NOMATCH;
+
+	return monotime_since(&start, NULL) / 1000;
+}
+
+static unsigned long run_compiled(struct aspath **paths, size_t count,
+				  const uint8_t *verdicts, size_t *mismatch)
+{
+	struct timeval start;
+	unsigned long elapsed;
+	size_t i, f;
+	int p;
+	bool match;
+
+	monotime(&start);
+
+	for (i = 0; i < count; i++)
+		for (p = 0; p < REGEX_PREFIXES_PER_PATH; p++)
+			for (f = 0; f < array_size(filters); f++) {
+				match = bgp_aspath_regexec(filters[f],
+							   paths[i]);
+				if (match
+				    != verdicts[i * array_size(filters) + f])
+					(*mismatch)++;
+			}
+
+	elapsed = monotime_since(&start, NULL) / 1000;
+
+	return elapsed;
+}
+
+static void report(const char *what, unsigned long msec, unsigned long base,
+		   size_t mismatch)
+{
+	printf("%-34s %lu.%03lu seconds", what, msec / 1000, msec % 1000);
+	if (base)
+		printf(", speedup %.2fx",
+		       msec ? (double)base / msec : 0.0);
+	if (mismatch)
+		printf(", %zu verdicts differ from regexec()", mismatch);
+	printf("\n");
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	struct aspath **interned, **plain;
+	uint8_t *verdicts;
+	size_t count = REGEX_PATHS;
+	size_t mismatch, total = 0;
+	unsigned long t_posix, t;
+	size_t i;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	qobj_init();
+	frr_pthread_init();
+	master = thread_master_create(NULL);
+	zclient = zclient_new(master, &zclient_options_default);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+
+	setup_filters();
+
+	interned = calloc(count, sizeof(*interned));
+	plain = calloc(count, sizeof(*plain));
+	verdicts = calloc(count, array_size(filters));
+
+	for (i = 0; i < count; i++) {
+		plain[i] = make_path(i);
+		interned[i] = aspath_intern(aspath_dup(plain[i]));
+	}
+
+	printf("%zu paths, %zu filters, %d prefixes per path\n", count,
+	       array_size(filters), REGEX_PREFIXES_PER_PATH);
+
+	t_posix = run_posix(plain, count, verdicts);
+	report("regexec() on the path string:", t_posix, 0, 0);
+
+	mismatch = 0;
+	t = run_compiled(plain, count, verdicts, &mismatch);
+	report("compiled, not interned:", t, t_posix, mismatch);
+	total += mismatch;
+
+	mismatch = 0;
+	t = run_compiled(interned, count, verdicts, &mismatch);
+	report("compiled, interned (verdict cache):", t, t_posix, mismatch);
+	total += mismatch;
+
+	for (i = 0; i < array_size(filters); i++) {
+		bgp_aspath_regex_free(filters[i]);
+		bgp_regex_free(posix[i]);
+		free(filter_str[i]);
+	}
+	for (i = 0; i < count; i++) {
+		aspath_free(plain[i]);
+		aspath_unintern(&interned[i]);
+	}
+	free(plain);
+	free(interned);
+	free(verdicts);
+
+	frr_pthread_finish();
+
+	if (total)
+		return 1;
+
+	printf("AS path regex test successful.\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+import frrtest
+
+class TestAspathRegexPerf(frrtest.TestMultiOut):
+    program = './test_aspath_regex_perf'
+
+TestAspathRegexPerf.onesimple('AS path regex test successful.')
@@ -0,0 +1,240 @@
+/*
+ * Checks that the BGP route-map result cache never returns a verdict the
+ * route-map doesn't give any more, when entries' actions and exit policies
+ * are changed through the northbound.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "command.h"
+#include "privs.h"
+#include "memory.h"
+#include "northbound.h"
+#include "routemap.h"
+#include "zclient.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_rmap_cache.h"
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+extern struct zclient *zclient;
+struct zebra_privs_t bgpd_privs = {
+	.user = NULL,
+	.group = NULL,
+	.vty_group = NULL,
+};
+
+static const struct frr_yang_module_info *const modules[] = {
+	&frr_route_map_info,
+};
+
+#define XPATH_MAP "/frr-route-map:lib/route-map[name='test']"
+#define XPATH_ENTRY(seq) XPATH_MAP "/entry[sequence='" seq "']"
+
+struct test_edit {
+	enum nb_operation operation;
+	const char *xpath;
+	const char *value;
+};
+
+struct test_step {
+	const char *desc;
+	struct test_edit edits[6];
+	route_map_result_t result;
+};
+
+/* clang-format off */
+static const struct test_step steps[] = {
+	{
+		.desc = "permit",
+		.edits = {
+			{NB_OP_CREATE, XPATH_MAP, NULL},
+			{NB_OP_CREATE, XPATH_ENTRY("10"), NULL},
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/action", "permit"},
+		},
+		.result = RMAP_PERMITMATCH,
+	},
+	{
+		.desc = "permit changed to deny",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/action", "deny"},
+		},
+		.result = RMAP_DENYMATCH,
+	},
+	{
+		.desc = "deny changed back to permit, deny entry added after it",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/action", "permit"},
+			{NB_OP_CREATE, XPATH_ENTRY("20"), NULL},
+			{NB_OP_MODIFY, XPATH_ENTRY("20") "/action", "deny"},
+			{NB_OP_CREATE, XPATH_ENTRY("30"), NULL},
+			{NB_OP_MODIFY, XPATH_ENTRY("30") "/action", "permit"},
+		},
+		.result = RMAP_PERMITMATCH,
+	},
+	{
+		.desc = "on-match next",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/exit-policy", "next"},
+		},
+		.result = RMAP_DENYMATCH,
+	},
+	{
+		.desc = "on-match goto 30",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/exit-policy", "goto"},
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/goto-value", "30"},
+		},
+		.result = RMAP_PERMITMATCH,
+	},
+	{
+		.desc = "on-match goto 20",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/goto-value", "20"},
+		},
+		.result = RMAP_DENYMATCH,
+	},
+	{
+		.desc = "on-match removed",
+		.edits = {
+			{NB_OP_DESTROY, XPATH_ENTRY("10") "/goto-value", NULL},
+			{NB_OP_MODIFY, XPATH_ENTRY("10") "/exit-policy",
+			 "permit-or-deny"},
+		},
+		.result = RMAP_PERMITMATCH,
+	},
+};
+/* clang-format on */
+
+static struct peer peer;
+static unsigned long errors;
+
+static void test_commit(const struct test_step *step)
+{
+	struct nb_config *candidate;
+	int ret;
+
+	candidate = nb_config_dup(running_config);
+
+	for (size_t i = 0; i < array_size(step->edits); i++) {
+		const struct test_edit *edit = &step->edits[i];
+		struct nb_node *nb_node;
+		struct yang_data *data;
+
+		if (!edit->xpath)
+			break;
+
+		nb_node = nb_node_find(edit->xpath);
+		assert(nb_node);
+		data = yang_data_new(edit->xpath, edit->value);
+		ret = nb_candidate_edit(candidate, nb_node, edit->operation,
+					edit->xpath, NULL, data);
+		yang_data_free(data);
+		assert(ret == NB_OK);
+	}
+
+	ret = nb_candidate_commit(candidate, NB_CLIENT_NONE, NULL, false, NULL,
+				  NULL);
+	assert(ret == NB_OK);
+
+	nb_config_free(candidate);
+}
+
+static route_map_result_t test_apply(struct route_map *map)
+{
+	struct bgp_path_info path = {};
+	struct attr attr = {};
+	struct prefix p;
+	route_map_result_t ret;
+
+	str2prefix("192.0.2.0/24", &p);
+	path.peer = &peer;
+	path.attr = &attr;
+
+	ret = bgp_rmap_cache_apply(map, &p, &path);
+	if (ret == RMAP_PERMITMATCH)
+		bgp_attr_unintern_sub(&attr);
+
+	return ret;
+}
+
+static void test_run_step(const struct test_step *step)
+{
+	struct route_map *map;
+	uint64_t hits;
+
+	printf("%s\n", step->desc);
+
+	test_commit(step);
+
+	map = route_map_lookup_by_name("test");
+	assert(map);
+
+	/* Once to fill the cache, once from the cache. */
+	if (test_apply(map) != step->result) {
+		printf("  wrong result from the route-map\n");
+		errors++;
+	}
+
+	hits = bgp_rmap_cache_stats.hits;
+	if (test_apply(map) != step->result) {
+		printf("  wrong result from the cache\n");
+		errors++;
+	}
+	if (bgp_rmap_cache_stats.hits != hits + 1) {
+		printf("  result not cached\n");
+		errors++;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	qobj_init();
+	cmd_init(1);
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	master = thread_master_create(NULL);
+	yang_init(true);
+	nb_init(master, modules, array_size(modules));
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE);
+	vrf_init(NULL, NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+	bgp_route_map_init();
+	bgp_rmap_cache_set_size(BGP_RMAP_CACHE_SIZE_DEFAULT);
+
+	peer.rmap_type = PEER_RMAP_TYPE_IN;
+
+	for (size_t i = 0; i < array_size(steps); i++)
+		test_run_step(&steps[i]);
+
+	bgp_rmap_cache_finish();
+
+	if (errors) {
+		printf("%lu errors\n", errors);
+		return 1;
+	}
+
+	printf("Route-map cache test successful.\n");
+	return 0;
+}
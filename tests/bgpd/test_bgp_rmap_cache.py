@@ -0,0 +1,6 @@
+import frrtest
+
+class TestBgpRmapCache(frrtest.TestMultiOut):
+    program = './test_bgp_rmap_cache'
+
+TestBgpRmapCache.onesimple('Route-map cache test successful.')
@@ -0,0 +1,256 @@
+/*
+ * Test program which measures how best path selection for a large table
+ * scales with the number of bestpath worker pthreads.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "privs.h"
+#include "memory.h"
+#include "monotime.h"
+#include "zclient.h"
+#include "frr_pthread.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_select.h"
+
+/* size of the replayed table, small enough for make check; pass a full
+ * table size on the command line for meaningful timings */
+#define SELECT_PREFIXES 20000
+/* nodes per process queue item, as after a full table peer flap */
+#define SELECT_BATCH 10000
+#define SELECT_PEERS 4
+#define SELECT_ATTRS 16
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+extern struct zclient *zclient;
+struct zebra_privs_t bgpd_privs = {
+	.user = NULL,
+	.group = NULL,
+	.vty_group = NULL,
+};
+
+static const unsigned int worker_counts[] = {1, 2, 4, 8};
+
+static struct peer peers[SELECT_PEERS];
+static struct attr attrs[SELECT_ATTRS];
+
+static struct bgp *bgp_create_fake(void)
+{
+	struct bgp *bgp;
+
+	bgp = XCALLOC(MTYPE_BGP, sizeof(struct bgp));
+	bgp_lock(bgp);
+	bgp->peer = list_new();
+	bgp->group = list_new();
+	bgp->as = 65000;
+	bgp->default_local_pref = BGP_DEFAULT_LOCAL_PREF;
+	bgp->rib[AFI_IP][SAFI_UNICAST] =
+		bgp_table_init(bgp, AFI_IP, SAFI_UNICAST);
+	bgp->maxpaths[AFI_IP][SAFI_UNICAST].maxpaths_ebgp = 1;
+	bgp->maxpaths[AFI_IP][SAFI_UNICAST].maxpaths_ibgp = 1;
+
+	return bgp;
+}
+
+static void setup_peers_attrs(struct bgp *bgp)
+{
+	char buf[64];
+	int i;
+
+	for (i = 0; i < SELECT_PEERS; i++) {
+		snprintf(buf, sizeof(buf), "192.0.2.%d", i + 1);
+		peers[i].bgp = bgp;
+		peers[i].as = 65001 + i;
+		peers[i].local_as = bgp->as;
+		peers[i].sort = BGP_PEER_EBGP;
+		peers[i].status = Established;
+		peers[i].su_remote = sockunion_str2su(buf);
+		inet_pton(AF_INET, buf, &peers[i].remote_id);
+	}
+
+	/* vary AS path length, local preference and MED so that all of the
+	 * early decision steps get exercised */
+	for (i = 0; i < SELECT_ATTRS; i++) {
+		snprintf(buf, sizeof(buf), "%d %d%s%s", 65001 + i % SELECT_PEERS,
+			 64512 + i, i % 3 ? " 64600" : "",
+			 i % 5 ? "" : " 64601 64602");
+		attrs[i].aspath = aspath_str2aspath(buf);
+		attrs[i].flag = ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)
+				| ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC);
+		attrs[i].local_pref = BGP_DEFAULT_LOCAL_PREF + (i % 2) * 10;
+		attrs[i].med = i * 7 % 11;
+		attrs[i].nexthop.s_addr = htonl(0xc0000201 + i % SELECT_PEERS);
+	}
+}
+
+static struct bgp_node **setup_table(struct bgp *bgp, size_t count)
+{
+	struct bgp_table *table = bgp->rib[AFI_IP][SAFI_UNICAST];
+	struct bgp_node **nodes;
+	struct bgp_path_info *pi;
+	struct prefix p = {.family = AF_INET, .prefixlen = 24};
+	size_t i;
+	int j;
+
+	nodes = calloc(count, sizeof(*nodes));
+
+	for (i = 0; i < count; i++) {
+		p.u.prefix4.s_addr = htonl(0x01000000 + (i << 8));
+		nodes[i] = bgp_node_get(table, &p);
+
+		for (j = 0; j < SELECT_PEERS; j++) {
+			pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0,
+				       &peers[j],
+				       &attrs[(i * 5 + j * 3) % SELECT_ATTRS],
+				       nodes[i]);
+			SET_FLAG(pi->flags, BGP_PATH_VALID);
+			bgp_path_info_add(nodes[i], pi);
+		}
+
+		/* link up the nodes as if they were on the process queue */
+		if (i)
+			STAILQ_NEXT(nodes[i - 1], pq) = nodes[i];
+	}
+
+	return nodes;
+}
+
+static unsigned long run_serial(struct bgp *bgp, struct bgp_node **nodes,
+				size_t count, struct bgp_select_hint *hints)
+{
+	struct timeval start;
+	size_t i;
+
+	monotime(&start);
+
+	for (i = 0; i < count; i++)
+		bgp_best_selection_hint(bgp, nodes[i],
+					&bgp->maxpaths[AFI_IP][SAFI_UNICAST],
+					AFI_IP, SAFI_UNICAST, &hints[i]);
+
+	return monotime_since(&start, NULL) / 1000;
+}
+
+static unsigned long run_parallel(struct bgp *bgp, struct bgp_node **nodes,
+				  size_t count, struct bgp_select_hint *hints,
+				  size_t *mismatch)
+{
+	struct bgp_select_batch *batch;
+	struct timeval start;
+	unsigned long elapsed = 0;
+	size_t i, j, n;
+
+	for (i = 0; i < count; i += SELECT_BATCH) {
+		n = MIN(SELECT_BATCH, count - i);
+
+		monotime(&start);
+		batch = bgp_select_batch_run(bgp, nodes[i], n);
+		elapsed += monotime_since(&start, NULL);
+
+		/* too small to be handed out, would be done inline */
+		if (!batch)
+			continue;
+
+		for (j = 0; j < batch->count; j++)
+			if (batch->nodes[j] != nodes[i + j]
+			    || !batch->hints[j].valid
+			    || batch->hints[j].new_select
+				       != hints[i + j].new_select
+			    || batch->hints[j].reason != hints[i + j].reason)
+				(*mismatch)++;
+
+		bgp_select_batch_free(&batch);
+	}
+
+	return elapsed / 1000;
+}
+
+int main(int argc, char **argv)
+{
+	struct bgp *bgp;
+	struct bgp_node **nodes;
+	struct bgp_select_hint *hints;
+	size_t count = SELECT_PREFIXES;
+	size_t mismatch;
+	unsigned long t_serial, t_parallel;
+	unsigned int i;
+	int ret = 0;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	qobj_init();
+	frr_pthread_init();
+	master = thread_master_create(NULL);
+	zclient = zclient_new(master, &zclient_options_default);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE);
+	vrf_init(NULL, NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+
+	bgp = bgp_create_fake();
+	setup_peers_attrs(bgp);
+	nodes = setup_table(bgp, count);
+	hints = calloc(count, sizeof(*hints));
+
+	t_serial = run_serial(bgp, nodes, count, hints);
+	printf("Inline selection for %zu prefixes took %lu.%03lu seconds.\n",
+	       count, t_serial / 1000, t_serial % 1000);
+
+	for (i = 0; i < array_size(worker_counts); i++) {
+		bgp_select_set_workers(worker_counts[i]);
+
+		mismatch = 0;
+		t_parallel = run_parallel(bgp, nodes, count, hints, &mismatch);
+
+		printf("%u worker(s): %lu.%03lu seconds, speedup %.2fx",
+		       worker_counts[i], t_parallel / 1000, t_parallel % 1000,
+		       t_parallel ? (double)t_serial / t_parallel : 0.0);
+		if (mismatch) {
+			printf(", %zu results differ from inline selection",
+			       mismatch);
+			ret = 1;
+		}
+		printf("\n");
+		fflush(stdout);
+	}
+
+	bgp_select_set_workers(0);
+
+	free(hints);
+	free(nodes);
+	frr_pthread_finish();
+
+	if (ret)
+		return ret;
+
+	printf("BGP selection test successful.\n");
+	return 0;
+}
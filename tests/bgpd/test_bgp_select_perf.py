@@ -0,0 +1,6 @@
+import frrtest
+
+class TestBgpSelectPerf(frrtest.TestMultiOut):
+    program = './test_bgp_select_perf'
+
+TestBgpSelectPerf.onesimple('BGP selection test successful.')
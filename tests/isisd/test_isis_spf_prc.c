@@ -0,0 +1,391 @@
+#include <zebra.h>
+
+#include "zclient.h"
+
+#include "isisd/isis_spf.c"
+#include "isisd/isis_zebra.h"
+
+struct thread_master *master;
+int isis_sock_init(struct isis_circuit *circuit);
+int isis_sock_init(struct isis_circuit *circuit)
+{
+	return 0;
+}
+
+struct zebra_privs_t isisd_privs;
+
+/*
+ * Receives LSP updates the way isis_pdu.c hands them to lsp_update() and
+ * checks which of them run a partial route calculation instead of a full
+ * SPF, and that the routes are the same as a full SPF would calculate.
+ *
+ * This system, 0000.0000.0001, has a point-to-point adjacency to 2, which
+ * has links to 3 and 4; 3 and 4 are linked as well.  The SPT is
+ * 1 -> 2 -> 3 -> 4, the link from 4 back to 2 isn't on it.
+ */
+#define TEST_NEIGHS 3
+#define TEST_PREFIXES 3
+
+struct test_lsp {
+	uint8_t id;
+	struct {
+		uint8_t id;
+		uint32_t metric;
+	} neighs[TEST_NEIGHS];
+	struct {
+		const char *prefix;
+		uint32_t metric;
+	} prefixes[TEST_PREFIXES];
+};
+
+struct test_step {
+	const char *desc;
+	struct test_lsp lsp;
+	enum isis_spf_change change;
+};
+
+/* clang-format off */
+static const struct test_lsp initial[] = {
+	{
+		.id = 2,
+		.neighs = {{1, 10}, {3, 10}, {4, 30}},
+		.prefixes = {{"10.0.0.0/30", 10}, {"192.168.2.0/24", 10}},
+	},
+	{
+		.id = 3,
+		.neighs = {{2, 10}, {4, 10}},
+		.prefixes = {{"192.168.3.0/24", 10}, {"172.16.0.0/24", 5}},
+	},
+	{
+		.id = 4,
+		.neighs = {{2, 30}, {3, 10}},
+		.prefixes = {{"192.168.4.0/24", 10}, {"172.16.0.0/24", 15}},
+	},
+};
+
+static const struct test_step steps[] = {
+	{
+		.desc = "LSP refreshed",
+		.lsp = {
+			.id = 3,
+			.neighs = {{2, 10}, {4, 10}},
+			.prefixes = {{"192.168.3.0/24", 10}, {"172.16.0.0/24", 5}},
+		},
+		.change = ISIS_SPF_CHANGE_NONE,
+	},
+	{
+		.desc = "prefix withdrawn and prefix added",
+		.lsp = {
+			.id = 3,
+			.neighs = {{2, 10}, {4, 10}},
+			.prefixes = {{"192.168.3.0/24", 10}, {"192.168.30.0/24", 10}},
+		},
+		.change = ISIS_SPF_CHANGE_PREFIX,
+	},
+	{
+		.desc = "prefix metric changed",
+		.lsp = {
+			.id = 4,
+			.neighs = {{2, 30}, {3, 10}},
+			.prefixes = {{"192.168.4.0/24", 20}, {"172.16.0.0/24", 15}},
+		},
+		.change = ISIS_SPF_CHANGE_PREFIX,
+	},
+	{
+		.desc = "link off the SPT changed",
+		.lsp = {
+			.id = 4,
+			.neighs = {{2, 40}, {3, 10}},
+			.prefixes = {{"192.168.4.0/24", 20}, {"172.16.0.0/24", 15}},
+		},
+		.change = ISIS_SPF_CHANGE_PREFIX,
+	},
+	{
+		.desc = "link on the SPT changed",
+		.lsp = {
+			.id = 3,
+			.neighs = {{2, 10}, {4, 50}},
+			.prefixes = {{"192.168.3.0/24", 10}, {"192.168.30.0/24", 10}},
+		},
+		.change = ISIS_SPF_CHANGE_TOPOLOGY,
+	},
+	{
+		.desc = "prefix added after the topology change",
+		.lsp = {
+			.id = 2,
+			.neighs = {{1, 10}, {3, 10}, {4, 30}},
+			.prefixes = {{"10.0.0.0/30", 10}, {"192.168.2.0/24", 10},
+				     {"192.168.20.0/24", 10}},
+		},
+		.change = ISIS_SPF_CHANGE_PREFIX,
+	},
+};
+/* clang-format on */
+
+static struct isis_area *area;
+static uint32_t seqno;
+static unsigned int errors;
+
+#define test_check(cond)                                                       \
+	do {                                                                   \
+		if (!(cond)) {                                                 \
+			printf("  %s:%d: %s failed\n", __func__, __LINE__,     \
+			       #cond);                                         \
+			errors++;                                              \
+		}                                                              \
+	} while (0)
+
+static void test_sysid(uint8_t *sysid, uint8_t id)
+{
+	memset(sysid, 0, ISIS_SYS_ID_LEN);
+	sysid[ISIS_SYS_ID_LEN - 1] = id;
+}
+
+static struct isis_tlvs *test_tlvs(const struct test_lsp *desc)
+{
+	struct nlpids nlpids = {.count = 1, .nlpids = {NLPID_IP}};
+	struct isis_tlvs *tlvs = isis_alloc_tlvs();
+	uint8_t id[ISIS_SYS_ID_LEN + 1] = {};
+	struct prefix_ipv4 p;
+
+	isis_tlvs_set_protocols_supported(tlvs, &nlpids);
+
+	for (int i = 0; i < TEST_NEIGHS && desc->neighs[i].id; i++) {
+		test_sysid(id, desc->neighs[i].id);
+		isis_tlvs_add_extended_reach(tlvs, ISIS_MT_IPV4_UNICAST, id,
+					     desc->neighs[i].metric, NULL);
+	}
+
+	for (int i = 0; i < TEST_PREFIXES && desc->prefixes[i].prefix; i++) {
+		str2prefix_ipv4(desc->prefixes[i].prefix, &p);
+		isis_tlvs_add_extended_ip_reach(tlvs, &p,
+						desc->prefixes[i].metric);
+	}
+
+	return tlvs;
+}
+
+/* As received: the PDU holds the header and the packed TLVs. */
+static void test_lsp_receive(const struct test_lsp *desc)
+{
+	struct isis_lsp_hdr hdr = {};
+	struct isis_tlvs *tlvs;
+	struct isis_lsp *lsp;
+	struct stream *s;
+
+	test_sysid(hdr.lsp_id, desc->id);
+	hdr.rem_lifetime = 1200;
+	hdr.seqno = ++seqno;
+	hdr.lsp_bits = IS_LEVEL_1;
+
+	tlvs = test_tlvs(desc);
+	s = stream_new(LLC_LEN + area->lsp_mtu);
+	stream_put(s, NULL, ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN);
+	isis_pack_tlvs(tlvs, s, (size_t)-1, false, true);
+	hdr.pdu_len = stream_get_endp(s);
+
+	lsp = lsp_search(&area->lspdb[0], hdr.lsp_id);
+	if (lsp) {
+		lsp_update(lsp, &hdr, tlvs, s, area, ISIS_LEVEL1, false);
+	} else {
+		lsp = lsp_new_from_recv(&hdr, tlvs, s, NULL, area, ISIS_LEVEL1);
+		lsp_insert(&area->lspdb[0], lsp);
+	}
+
+	stream_free(s);
+}
+
+static void test_spf_run(void)
+{
+	struct thread thread;
+
+	while (area->spf_timer[0] && thread_fetch(master, &thread))
+		thread_call(&thread);
+}
+
+static void test_area_init(void)
+{
+	static struct interface ifp = {.name = "eth0", .ifindex = 1};
+	static char area_tag[] = "test";
+	static struct in_addr neigh_addr;
+	static uint16_t mt_set[] = {ISIS_MT_IPV4_UNICAST};
+	struct isis_circuit *circuit;
+	struct isis_adjacency *adj;
+	struct prefix_ipv4 *addr;
+
+	area = calloc(sizeof(*area), 1);
+	area->area_tag = area_tag;
+	area->is_type = IS_LEVEL_1;
+	area->newmetric = 1;
+	area->lsp_mtu = 1497;
+	area->ip_circuits = 1;
+	area->circuit_list = list_new();
+	lsp_db_init(&area->lspdb[0]);
+	spftree_area_init(area);
+
+	circuit = calloc(sizeof(*circuit), 1);
+	circuit->area = area;
+	circuit->interface = &ifp;
+	circuit->state = C_STATE_UP;
+	circuit->is_type = IS_LEVEL_1;
+	circuit->circ_type = CIRCUIT_T_P2P;
+	circuit->ip_router = 1;
+	circuit->te_metric[0] = 10;
+	circuit->mt_settings = list_new();
+	circuit->ip_addrs = list_new();
+	addr = calloc(sizeof(*addr), 1);
+	str2prefix_ipv4("10.0.0.1/30", addr);
+	listnode_add(circuit->ip_addrs, addr);
+
+	adj = calloc(sizeof(*adj), 1);
+	test_sysid(adj->sysid, 2);
+	adj->adj_state = ISIS_ADJ_UP;
+	adj->sys_type = ISIS_SYSTYPE_L1_IS;
+	adj->level = IS_LEVEL_1;
+	adj->circuit = circuit;
+	adj->nlpids.count = 1;
+	adj->nlpids.nlpids[0] = NLPID_IP;
+	inet_pton(AF_INET, "10.0.0.2", &neigh_addr);
+	adj->ipv4_addresses = &neigh_addr;
+	adj->ipv4_address_count = 1;
+	adj->mt_set = mt_set;
+	adj->mt_count = array_size(mt_set);
+
+	circuit->u.p2p.neighbor = adj;
+	listnode_add(area->circuit_list, circuit);
+}
+
+/* Full SPF on a tree of its own, the area's tree is left alone. */
+static struct isis_spftree *test_full_spf(void)
+{
+	struct isis_spftree *spftree = area->spftree[SPFTREE_IPV4][0];
+	struct isis_spftree *ref = isis_spftree_new(area);
+	struct timeval now;
+
+	area->spftree[SPFTREE_IPV4][0] = ref;
+	monotime(&now);
+	isis_run_spf(area, ISIS_LEVEL1, SPFTREE_IPV4, isis->sysid, &now);
+	area->spftree[SPFTREE_IPV4][0] = spftree;
+
+	return ref;
+}
+
+static unsigned int test_table_count(struct route_table *table)
+{
+	struct route_node *rn;
+	unsigned int count = 0;
+
+	for (rn = route_top(table); rn; rn = srcdest_route_next(rn))
+		if (rn->info)
+			count++;
+
+	return count;
+}
+
+static void test_routes_check(void)
+{
+	struct isis_spftree *spftree = area->spftree[SPFTREE_IPV4][0];
+	struct isis_spftree *ref = test_full_spf();
+	struct isis_route_info *rinfo, *ref_rinfo;
+	struct route_node *rn, *rn2;
+	char buf[PREFIX_STRLEN];
+
+	test_check(test_table_count(spftree->route_table)
+		   == test_table_count(ref->route_table));
+
+	for (rn = route_top(ref->route_table); rn;
+	     rn = srcdest_route_next(rn)) {
+		ref_rinfo = rn->info;
+		if (!ref_rinfo)
+			continue;
+
+		rn2 = srcdest_rnode_lookup(spftree->route_table, &rn->p, NULL);
+		rinfo = rn2 ? rn2->info : NULL;
+		if (!rinfo || !CHECK_FLAG(rinfo->flag, ISIS_ROUTE_FLAG_ACTIVE)
+		    || rinfo->cost != ref_rinfo->cost
+		    || rinfo->depth != ref_rinfo->depth
+		    || listcount(rinfo->nexthops)
+			       != listcount(ref_rinfo->nexthops)) {
+			printf("  route to %s differs\n",
+			       prefix2str(&rn->p, buf, sizeof(buf)));
+			errors++;
+		}
+		if (rn2)
+			route_unlock_node(rn2);
+	}
+
+	isis_spf_invalidate_routes(ref);
+	isis_route_verify_table(area, ref->route_table);
+	isis_spftree_del(ref);
+}
+
+static void test_run_step(const struct test_step *step)
+{
+	struct isis_spftree *spftree = area->spftree[SPFTREE_IPV4][0];
+	unsigned int runcount = spftree->runcount;
+	unsigned int prc_runcount = spftree->prc_runcount;
+	unsigned int skipped = area->spf_skipped_count[0];
+
+	printf("%s\n", step->desc);
+
+	test_lsp_receive(&step->lsp);
+
+	switch (step->change) {
+	case ISIS_SPF_CHANGE_NONE:
+		test_check(!area->spf_timer[0]);
+		test_check(area->spf_skipped_count[0] == skipped + 1);
+		break;
+	case ISIS_SPF_CHANGE_PREFIX:
+		test_check(area->spf_timer[0]);
+		test_check(!area->spf_full_pending[0]);
+		break;
+	case ISIS_SPF_CHANGE_TOPOLOGY:
+		test_check(area->spf_timer[0]);
+		test_check(area->spf_full_pending[0]);
+		break;
+	}
+
+	test_spf_run();
+
+	test_check(spftree->spt_valid);
+	test_check(spftree->runcount
+		   == runcount + (step->change == ISIS_SPF_CHANGE_TOPOLOGY));
+	test_check(spftree->prc_runcount
+		   == prc_runcount + (step->change == ISIS_SPF_CHANGE_PREFIX));
+
+	test_routes_check();
+}
+
+int main(int argc, char **argv)
+{
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	master = thread_master_create(NULL);
+
+	/* routes aren't sent anywhere */
+	zclient = zclient_new(master, &zclient_options_default);
+	zclient->sock = -1;
+
+	isis = calloc(sizeof(*isis), 1);
+	test_sysid(isis->sysid, 1);
+	isis->nexthops = list_new();
+
+	test_area_init();
+
+	printf("initial SPF\n");
+	for (size_t i = 0; i < array_size(initial); i++)
+		test_lsp_receive(&initial[i]);
+	test_spf_run();
+	test_check(area->spftree[SPFTREE_IPV4][0]->runcount == 1);
+	test_routes_check();
+
+	for (size_t i = 0; i < array_size(steps); i++)
+		test_run_step(&steps[i]);
+
+	if (errors) {
+		printf("%u errors\n", errors);
+		return 1;
+	}
+
+	printf("IS-IS PRC test successful.\n");
+	return 0;
+}
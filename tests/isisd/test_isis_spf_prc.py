@@ -0,0 +1,6 @@
+import frrtest
+
+class TestIsisSPFPRC(frrtest.TestMultiOut):
+    program = './test_isis_spf_prc'
+
+TestIsisSPFPRC.onesimple('IS-IS PRC test successful.')
@@ -0,0 +1,186 @@
+#include <zebra.h>
+
+#include "monotime.h"
+#include "stream.h"
+#include "thread.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_circuit.h"
+#include "isisd/isis_lsp.h"
+#include "isisd/isis_tx_queue.h"
+
+struct thread_master *master;
+int isis_sock_init(struct isis_circuit *circuit);
+int isis_sock_init(struct isis_circuit *circuit)
+{
+	return 0;
+}
+
+struct zebra_privs_t isisd_privs;
+
+/*
+ * Floods LSPs through a circuit's TX queue the way isisd does, with and
+ * without an LSP flood rate, and checks how many PDUs go out per
+ * tx_multi() call and per interval.
+ */
+#define TEST_LSPS 100
+#define TEST_RATE 100	/* LSPs per second */
+#define TEST_RATE_LSPS 30
+/* the queue's token bucket holds a tenth of a second worth of LSPs */
+#define TEST_BURST (TEST_RATE / 10)
+
+static struct isis_lsp lsps[TEST_LSPS];
+static struct timeval sent_time[TEST_LSPS];
+static unsigned int sent;
+static unsigned int tx_multi_calls, tx_multi_max;
+static unsigned int errors;
+
+#define test_check(cond)                                                       \
+	do {                                                                   \
+		if (!(cond)) {                                                 \
+			printf("  %s:%d: %s failed\n", __func__, __LINE__,     \
+			       #cond);                                         \
+			errors++;                                              \
+		}                                                              \
+	} while (0)
+
+/* Like send_lsp(), which queues the PDU instead of sending it in a batch. */
+static void test_send_event(struct isis_circuit *circuit, struct isis_lsp *lsp,
+			    enum isis_tx_type tx_type)
+{
+	if (sent < TEST_LSPS)
+		monotime(&sent_time[sent]);
+	sent++;
+
+	stream_reset(circuit->snd_stream);
+	stream_put(circuit->snd_stream, lsp->hdr.lsp_id,
+		   sizeof(lsp->hdr.lsp_id));
+
+	if (circuit->tx_batch)
+		isis_tx_batch_add(circuit, lsp->level);
+}
+
+static void test_tx_multi(struct isis_circuit *circuit,
+			  struct isis_tx_batch *batch)
+{
+	tx_multi_calls++;
+	if (batch->count > tx_multi_max)
+		tx_multi_max = batch->count;
+
+	for (unsigned int i = 0; i < batch->count; i++)
+		batch->pdus[i].retval = ISIS_OK;
+}
+
+static void test_flood(struct isis_circuit *circuit, unsigned int count)
+{
+	struct thread thread;
+
+	sent = 0;
+	tx_multi_calls = 0;
+	tx_multi_max = 0;
+
+	circuit->tx_queue = isis_tx_queue_new(circuit, test_send_event);
+	for (unsigned int i = 0; i < count; i++)
+		isis_tx_queue_add(circuit->tx_queue, &lsps[i], TX_LSP_NORMAL);
+
+	while (sent < count && thread_fetch(master, &thread))
+		thread_call(&thread);
+}
+
+static void test_unlimited(struct isis_circuit *circuit)
+{
+	struct isis_tx_queue_stats stats;
+
+	printf("no flood rate\n");
+
+	circuit->lsp_flood_rate = 0;
+	test_flood(circuit, TEST_LSPS);
+	isis_tx_queue_get_stats(circuit->tx_queue, &stats);
+
+	test_check(sent == TEST_LSPS);
+	test_check(stats.sent == TEST_LSPS);
+	test_check(stats.pending == 0);
+	test_check(stats.pending_max == TEST_LSPS);
+	test_check(stats.unacked == TEST_LSPS);
+	test_check(stats.rate_limited == 0);
+	/* all of them in one flush, in as few calls as possible */
+	test_check(tx_multi_max == ISIS_TX_BATCH_MAX);
+	test_check(tx_multi_calls
+		   == (TEST_LSPS + ISIS_TX_BATCH_MAX - 1) / ISIS_TX_BATCH_MAX);
+
+	isis_tx_queue_free(circuit->tx_queue);
+	circuit->tx_queue = NULL;
+}
+
+static void test_rate(struct isis_circuit *circuit)
+{
+	struct isis_tx_queue_stats stats;
+	struct timeval tv;
+	int64_t elapsed, min_elapsed;
+
+	printf("flood rate %u LSPs/s\n", TEST_RATE);
+
+	circuit->lsp_flood_rate = TEST_RATE;
+	test_flood(circuit, TEST_RATE_LSPS);
+	isis_tx_queue_get_stats(circuit->tx_queue, &stats);
+
+	test_check(sent == TEST_RATE_LSPS);
+	test_check(stats.sent == TEST_RATE_LSPS);
+	test_check(stats.rate_limited > 0);
+	test_check(tx_multi_max <= TEST_BURST);
+
+	/*
+	 * A full bucket goes out at once, after that no LSP is sent before
+	 * the rate allows; 1 msec of slack for the bucket's rounding.
+	 */
+	for (unsigned int i = TEST_BURST; i < TEST_RATE_LSPS; i++) {
+		timersub(&sent_time[i], &sent_time[0], &tv);
+		elapsed = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+		min_elapsed = (int64_t)(i - TEST_BURST + 1) * 1000000
+			      / TEST_RATE;
+		if (elapsed < min_elapsed - 1000) {
+			printf("  LSP %u sent after %lld usec, expected %lld\n",
+			       i, (long long)elapsed, (long long)min_elapsed);
+			errors++;
+		}
+	}
+
+	isis_tx_queue_free(circuit->tx_queue);
+	circuit->tx_queue = NULL;
+}
+
+int main(int argc, char **argv)
+{
+	static struct interface ifp = {.name = "eth0"};
+	static char area_tag[] = "test";
+	struct isis_area area = {.area_tag = area_tag};
+	struct isis_circuit circuit = {};
+
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	master = thread_master_create(NULL);
+	isis = calloc(sizeof(*isis), 1);
+
+	for (unsigned int i = 0; i < TEST_LSPS; i++) {
+		lsps[i].hdr.lsp_id[ISIS_SYS_ID_LEN - 1] = i + 1;
+		lsps[i].level = ISIS_LEVEL2;
+	}
+
+	circuit.area = &area;
+	circuit.interface = &ifp;
+	circuit.snd_stream = stream_new(1500);
+	circuit.tx_multi = test_tx_multi;
+
+	test_unlimited(&circuit);
+	test_rate(&circuit);
+
+	stream_free(circuit.snd_stream);
+	thread_master_free(master);
+
+	if (errors) {
+		printf("%u errors\n", errors);
+		return 1;
+	}
+
+	printf("IS-IS TX queue test successful.\n");
+	return 0;
+}
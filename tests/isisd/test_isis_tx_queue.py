@@ -0,0 +1,6 @@
+import frrtest
+
+class TestIsisTXQueue(frrtest.TestMultiOut):
+    program = './test_isis_tx_queue'
+
+TestIsisTXQueue.onesimple('IS-IS TX queue test successful.')
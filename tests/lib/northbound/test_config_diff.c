@@ -0,0 +1,230 @@
+/*
+ * Configuration delta calculation test.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Commits a series of edits and checks that the delta calculated from the
+ * candidate's journal always matches a full diff of the configurations,
+ * including when "when" statements make libyang auto-delete nodes.
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "vty.h"
+#include "command.h"
+#include "memory.h"
+#include "lib_vty.h"
+#include "log.h"
+#include "northbound.h"
+
+static struct thread_master *master;
+
+static int test_create(enum nb_event event, const struct lyd_node *dnode,
+		       union nb_resource *resource)
+{
+	return NB_OK;
+}
+
+static int test_modify(enum nb_event event, const struct lyd_node *dnode,
+		       union nb_resource *resource)
+{
+	return NB_OK;
+}
+
+static int test_destroy(enum nb_event event, const struct lyd_node *dnode)
+{
+	return NB_OK;
+}
+
+/* clang-format off */
+static const struct frr_yang_module_info frr_test_config_info = {
+	.name = "frr-test-config",
+	.nodes = {
+		{
+			.xpath = "/frr-test-config:frr-test-config/mode",
+			.cbs.modify = test_modify,
+		},
+		{
+			.xpath = "/frr-test-config:frr-test-config/port",
+			.cbs.modify = test_modify,
+			.cbs.destroy = test_destroy,
+		},
+		{
+			.xpath = "/frr-test-config:frr-test-config/options/enabled",
+			.cbs.modify = test_modify,
+		},
+		{
+			.xpath = "/frr-test-config:frr-test-config/extra/value",
+			.cbs.modify = test_modify,
+			.cbs.destroy = test_destroy,
+		},
+		{
+			.xpath = "/frr-test-config:frr-test-config/item",
+			.cbs.create = test_create,
+			.cbs.destroy = test_destroy,
+		},
+		{
+			.xpath = "/frr-test-config:frr-test-config/item/weight",
+			.cbs.modify = test_modify,
+			.cbs.destroy = test_destroy,
+		},
+		{
+			.xpath = NULL,
+		},
+	}
+};
+/* clang-format on */
+
+static const struct frr_yang_module_info *const modules[] = {
+	&frr_test_config_info,
+};
+
+#define XPATH_BASE "/frr-test-config:frr-test-config"
+
+struct test_edit {
+	enum nb_operation operation;
+	const char *xpath;
+	const char *value;
+};
+
+struct test_step {
+	const char *desc;
+	struct test_edit edits[4];
+	/* whether the delta can be calculated from the journal */
+	bool journal;
+};
+
+/* clang-format off */
+static const struct test_step steps[] = {
+	{
+		.desc = "create sibling leafs",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_BASE "/mode", "extended"},
+			{NB_OP_MODIFY, XPATH_BASE "/port", "179"},
+		},
+		.journal = true,
+	},
+	{
+		.desc = "enable the \"extra\" container",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_BASE "/options/enabled", "true"},
+			{NB_OP_MODIFY, XPATH_BASE "/extra/value", "10"},
+		},
+		.journal = false,
+	},
+	{
+		.desc = "auto-delete the \"extra\" container",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_BASE "/options/enabled", "false"},
+		},
+		.journal = false,
+	},
+	{
+		.desc = "create a list entry",
+		.edits = {
+			{NB_OP_CREATE, XPATH_BASE "/item[name='a']", NULL},
+			{NB_OP_MODIFY, XPATH_BASE "/item[name='a']/weight", "1"},
+		},
+		.journal = true,
+	},
+	{
+		.desc = "auto-delete a sibling leaf",
+		.edits = {
+			{NB_OP_MODIFY, XPATH_BASE "/mode", "plain"},
+		},
+		.journal = true,
+	},
+	{
+		.desc = "delete a leaf and a list entry",
+		.edits = {
+			{NB_OP_DESTROY, XPATH_BASE "/item[name='a']/weight", NULL},
+			{NB_OP_DESTROY, XPATH_BASE "/item[name='a']", NULL},
+		},
+		.journal = true,
+	},
+};
+/* clang-format on */
+
+static void test_run_step(struct nb_config *candidate,
+			  const struct test_step *step)
+{
+	bool journal, match;
+	int ret;
+
+	printf("%s\n", step->desc);
+
+	for (size_t i = 0; i < array_size(step->edits); i++) {
+		const struct test_edit *edit = &step->edits[i];
+		struct nb_node *nb_node;
+		struct yang_data *data;
+
+		if (!edit->xpath)
+			break;
+
+		nb_node = nb_node_find(edit->xpath);
+		assert(nb_node);
+		data = yang_data_new(edit->xpath, edit->value);
+		ret = nb_candidate_edit(candidate, nb_node, edit->operation,
+					edit->xpath, NULL, data);
+		yang_data_free(data);
+		assert(ret == NB_OK);
+	}
+
+	/* Let libyang apply defaults and "when" auto-deletions. */
+	ret = nb_candidate_validate(candidate);
+	assert(ret == NB_OK);
+
+	match = nb_config_diff_check(running_config, candidate, &journal);
+	assert(match);
+	assert(journal == step->journal);
+
+	ret = nb_candidate_commit(candidate, NB_CLIENT_NONE, NULL, false, NULL,
+				  NULL);
+	assert(ret == NB_OK);
+}
+
+int main(int argc, char **argv)
+{
+	struct nb_config *candidate;
+
+	master = thread_master_create(NULL);
+
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+
+	/* Library inits. */
+	cmd_init(1);
+	cmd_hostname_set("test");
+	vty_init(master, false);
+	lib_cmd_init();
+	yang_init(true);
+	nb_init(master, modules, array_size(modules));
+
+	candidate = nb_config_dup(running_config);
+	for (size_t i = 0; i < array_size(steps); i++)
+		test_run_step(candidate, &steps[i]);
+	nb_config_free(candidate);
+
+	cmd_terminate();
+	vty_terminate();
+	nb_terminate();
+	yang_terminate();
+	thread_master_free(master);
+
+	printf("Configuration diff test successful.\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+import frrtest
+
+class TestNbConfigDiff(frrtest.TestMultiOut):
+    program = './test_config_diff'
+
+TestNbConfigDiff.onesimple('Configuration diff test successful.')
@@ -21,6 +21,9 @@
 
 DEFINE_MGROUP(TEST_MEMORY, "memory test")
 DEFINE_MTYPE_STATIC(TEST_MEMORY, TEST, "generic test mtype")
+DEFINE_MTYPE_STATIC_SLAB(TEST_MEMORY, TEST_SLAB, "slab test mtype", 40)
+DEFINE_MTYPE_STATIC_SLAB(TEST_MEMORY, TEST_SLAB_EXIT, "slab exit test mtype",
+			 40)
 
 /* Memory torture tests
  *
@@ -44,10 +47,81 @@ struct thread_master *master;
 
 #define TIMES 10
 
+/* enough objects to run through several magazines and chunks */
+#define SLAB_OBJS 10000
+#define SLAB_THREADS 4
+
+static void *slab_torture(void *arg)
+{
+	unsigned char **objs;
+	int i, j, round;
+
+	objs = calloc(SLAB_OBJS, sizeof(*objs));
+
+	for (round = 0; round < TIMES; round++) {
+		for (i = 0; i < SLAB_OBJS; i++) {
+			objs[i] = XCALLOC(MTYPE_TEST_SLAB, 40);
+			for (j = 0; j < 40; j++)
+				assert(objs[i][j] == 0);
+			memset(objs[i], round + 1, 40);
+		}
+		for (i = 0; i < SLAB_OBJS; i++) {
+			for (j = 0; j < 40; j++)
+				assert(objs[i][j] == round + 1);
+			XFREE(MTYPE_TEST_SLAB, objs[i]);
+		}
+	}
+
+	free(objs);
+	return NULL;
+}
+
+/* more than a magazine holds */
+#define SLAB_EXIT_OBJS 100
+
+static pthread_key_t slab_exit_key;
+static void *slab_exit_objs[SLAB_EXIT_OBJS];
+
+/* runs after the slab code handed back the exiting thread's magazines, the
+ * slab key having been created first */
+static void slab_exit_free(void *arg)
+{
+	int i;
+
+	for (i = 0; i < SLAB_EXIT_OBJS; i++)
+		XFREE(MTYPE_TEST_SLAB_EXIT, ((void **)arg)[i]);
+}
+
+static void *slab_exit(void *arg)
+{
+	void **objs = calloc(SLAB_EXIT_OBJS, sizeof(*objs));
+	int i;
+
+	for (i = 0; i < SLAB_EXIT_OBJS; i++) {
+		objs[i] = XMALLOC(MTYPE_TEST_SLAB_EXIT, 40);
+		slab_exit_objs[i] = objs[i];
+	}
+	pthread_setspecific(slab_exit_key, objs);
+	return NULL;
+}
+
+/* whether obj is one of those freed by slab_exit_free() */
+static bool slab_exit_reused(void *obj)
+{
+	int i;
+
+	for (i = 0; i < SLAB_EXIT_OBJS; i++)
+		if (slab_exit_objs[i] == obj)
+			return true;
+	return false;
+}
+
 int main(int argc, char **argv)
 {
 	void *a[10];
-	int i;
+	void *objs[SLAB_EXIT_OBJS];
+	pthread_t thread;
+	int i, lost = 0;
 
 	printf("malloc x, malloc x, free, malloc x, free free\n\n");
 	/* simple case, test cache */
@@ -116,5 +190,44 @@ int main(int argc, char **argv)
 		XFREE(MTYPE_TEST, a[2]);
 		/* alloc == 0, cache valid next request */
 	}
+
+	printf("slab, %d threads\n\n", SLAB_THREADS);
+	/* objects freed by one thread end up in the depot, and are reused
+	 * by the others */
+	pthread_t threads[SLAB_THREADS];
+	struct memslab_stats stats;
+
+	for (i = 0; i < SLAB_THREADS; i++)
+		pthread_create(&threads[i], NULL, slab_torture, NULL);
+	for (i = 0; i < SLAB_THREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	assert(mtype_stats_alloc(MTYPE_TEST_SLAB) == 0);
+	if (mtype_slab_stats(MTYPE_TEST_SLAB, &stats))
+		printf("slab: %zu bytes reserved, %zu cached, %zu hits, %zu misses\n",
+		       stats.reserved, stats.cached, stats.hits, stats.misses);
+
+	printf("slab, freeing on thread exit\n\n");
+	/* objects freed after the thread's magazines went back to the depot
+	 * are reused rather than lost */
+	pthread_key_create(&slab_exit_key, slab_exit_free);
+	pthread_create(&thread, NULL, slab_exit, NULL);
+	pthread_join(thread, NULL);
+
+	assert(mtype_stats_alloc(MTYPE_TEST_SLAB_EXIT) == 0);
+	for (i = 0; i < SLAB_EXIT_OBJS; i++) {
+		objs[i] = XMALLOC(MTYPE_TEST_SLAB_EXIT, 40);
+		if (!slab_exit_reused(objs[i]))
+			lost++;
+	}
+	for (i = 0; i < SLAB_EXIT_OBJS; i++)
+		XFREE(MTYPE_TEST_SLAB_EXIT, objs[i]);
+
+	if (lost && mtype_slab_stats(MTYPE_TEST_SLAB_EXIT, &stats)) {
+		printf("%d objects freed on thread exit not reused\n", lost);
+		return 1;
+	}
+
+	printf("Memory test successful.\n");
 	return 0;
 }
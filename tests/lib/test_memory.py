@@ -0,0 +1,6 @@
+import frrtest
+
+class TestMemory(frrtest.TestMultiOut):
+    program = './test_memory'
+
+TestMemory.onesimple('Memory test successful.')
@@ -0,0 +1,174 @@
+/*
+ * Benchmark for the lock-free SPSC ring, against a mutex guarded stream_fifo,
+ * moving packets from one pthread to another the way bgpd's I/O pthread hands
+ * them to the main pthread.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "monotime.h"
+#include "spsc_ring.h"
+#include "stream.h"
+
+/* packets to move, kept small for make check; can be overridden on the
+ * command line for benchmarking */
+#define PACKETS 200000
+/* same as BGP_IBUF_RING_SIZE */
+#define RING_SIZE 1024
+/* size of a BGP KEEPALIVE */
+#define PACKET_SIZE 19
+
+static unsigned long packets = PACKETS;
+
+static struct spsc_ring *ring;
+
+static struct stream_fifo *fifo;
+static pthread_mutex_t fifo_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long out_of_order;
+
+static struct stream *make_packet(uint32_t seq)
+{
+	struct stream *s = stream_new(PACKET_SIZE);
+
+	stream_putl(s, seq);
+	return s;
+}
+
+static void check_packet(struct stream *s, uint32_t seq)
+{
+	if (stream_getl(s) != seq)
+		out_of_order++;
+	stream_free(s);
+}
+
+static void *ring_producer(void *arg)
+{
+	struct stream *s;
+	unsigned long i;
+
+	for (i = 0; i < packets; i++) {
+		s = make_packet(i);
+		while (!spsc_ring_push(ring, s))
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static void ring_consumer(void)
+{
+	struct stream *s;
+	unsigned long i;
+
+	for (i = 0; i < packets; i++) {
+		while (!(s = spsc_ring_pop(ring)))
+			sched_yield();
+		check_packet(s, i);
+	}
+}
+
+static void *fifo_producer(void *arg)
+{
+	struct stream *s;
+	unsigned long i;
+
+	for (i = 0; i < packets; i++) {
+		s = make_packet(i);
+		pthread_mutex_lock(&fifo_mtx);
+		stream_fifo_push(fifo, s);
+		pthread_mutex_unlock(&fifo_mtx);
+	}
+
+	return NULL;
+}
+
+static void fifo_consumer(void)
+{
+	struct stream *s;
+	unsigned long i;
+
+	for (i = 0; i < packets; i++) {
+		while (true) {
+			pthread_mutex_lock(&fifo_mtx);
+			s = stream_fifo_pop(fifo);
+			pthread_mutex_unlock(&fifo_mtx);
+
+			if (s)
+				break;
+			sched_yield();
+		}
+		check_packet(s, i);
+	}
+}
+
+static unsigned long run(void *(*producer)(void *), void (*consumer)(void))
+{
+	struct timeval start;
+	pthread_t thread;
+
+	monotime(&start);
+
+	pthread_create(&thread, NULL, producer, NULL);
+	consumer();
+	pthread_join(thread, NULL);
+
+	return monotime_since(&start, NULL);
+}
+
+static void report(const char *what, unsigned long usec, unsigned long base)
+{
+	printf("%-32s %lu.%06lu seconds, %.0f packets/s", what,
+	       usec / 1000000, usec % 1000000,
+	       usec ? packets * 1000000.0 / usec : 0.0);
+	if (base)
+		printf(", speedup %.2fx", usec ? (double)base / usec : 0.0);
+	printf("\n");
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long t_fifo, t_ring;
+
+	if (argc > 1)
+		packets = strtoul(argv[1], NULL, 10);
+
+	ring = spsc_ring_new(RING_SIZE);
+	fifo = stream_fifo_new();
+
+	printf("%lu packets, ring of %zu\n", packets, spsc_ring_size(ring));
+
+	t_fifo = run(fifo_producer, fifo_consumer);
+	report("stream_fifo + mutex:", t_fifo, 0);
+
+	t_ring = run(ring_producer, ring_consumer);
+	report("spsc_ring:", t_ring, t_fifo);
+
+	spsc_ring_del(ring, NULL);
+	stream_fifo_free(fifo);
+
+	if (out_of_order) {
+		printf("%lu packets out of order\n", out_of_order);
+		return 1;
+	}
+
+	printf("SPSC ring test successful.\n");
+	return 0;
+}
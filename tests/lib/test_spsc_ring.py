@@ -0,0 +1,6 @@
+import frrtest
+
+class TestSpscRing(frrtest.TestMultiOut):
+    program = './test_spsc_ring'
+
+TestSpscRing.onesimple('SPSC ring test successful.')
@@ -21,6 +21,7 @@
 
 #include <zebra.h>
 
+#include "monotime.h"
 #include "prefix.h"
 #include "table.h"
 
@@ -492,6 +493,234 @@ static void test_iter_pause(void)
 	route_table_finish(table);
 }
 
+/*
+ * Random prefixes with roughly the length distribution of a full IPv4
+ * table: mostly /24s, then /22s, /23s and /16s to /21s, a few shorter ones.
+ */
+static uint32_t rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static void rand_prefix(struct prefix_ipv4 *p)
+{
+	static const uint8_t lens[] = {24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+				       24, 24, 23, 23, 22, 22, 22, 21, 20, 19,
+				       18, 17, 16, 16, 15, 12, 8, 32};
+
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = lens[rand_next() % array_size(lens)];
+	p->prefix.s_addr = rand_next();
+	apply_mask_ipv4(p);
+}
+
+static void add_random(struct route_table *table, const struct prefix_ipv4 *p)
+{
+	struct route_node *rn;
+
+	rn = route_node_get(table, (struct prefix *)p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = rn;
+}
+
+static void del_random(struct route_table *table, const struct prefix_ipv4 *p)
+{
+	struct route_node *rn;
+
+	rn = route_node_lookup(table, (struct prefix *)p);
+	if (!rn)
+		return;
+
+	rn->info = NULL;
+	route_unlock_node(rn);
+	route_unlock_node(rn);
+}
+
+static struct route_node *match_addr(struct route_table *table, uint32_t addr)
+{
+	struct in_addr in = {.s_addr = addr};
+	struct route_node *rn;
+
+	rn = route_node_match_ipv4(table, &in);
+	if (rn)
+		route_unlock_node(rn);
+	return rn;
+}
+
+/* Half of the addresses looked up fall into one of the first num_prefixes
+ * prefixes, so that the longer ones get hit as well. */
+static void verify_same_matches(struct route_table *plain,
+				struct route_table *indexed,
+				const struct prefix_ipv4 *prefixes,
+				int num_prefixes, int lookups)
+{
+	struct route_node *rn1, *rn2;
+	const struct prefix_ipv4 *p;
+	uint32_t addr;
+	int i;
+
+	for (i = 0; i < lookups; i++) {
+		addr = rand_next();
+		if (i % 2) {
+			p = &prefixes[addr % num_prefixes];
+			addr = ntohl(p->prefix.s_addr);
+			if (p->prefixlen < 32)
+				addr |= rand_next() >> p->prefixlen;
+			addr = htonl(addr);
+		}
+		rn1 = match_addr(plain, addr);
+		rn2 = match_addr(indexed, addr);
+
+		assert(!rn1 == !rn2);
+		assert(!rn1 || prefix_same(&rn1->p, &rn2->p));
+	}
+}
+
+/*
+ * test_match_index
+ *
+ * Longest prefix matches must not depend on whether the table is indexed,
+ * while it grows and while it shrinks.
+ */
+static void test_match_index(void)
+{
+	struct route_table *plain, *indexed;
+	struct prefix_ipv4 *prefixes;
+	int i, num_prefixes = 20000;
+
+	printf("\n\nTesting route_node_match() on an indexed table\n");
+
+	prefixes = calloc(num_prefixes, sizeof(*prefixes));
+	assert(prefixes);
+
+	plain = route_table_init();
+	indexed = route_table_init();
+
+	/* the threshold is only looked at when adding nodes */
+	for (i = 0; i < num_prefixes; i++) {
+		rand_prefix(&prefixes[i]);
+		route_table_set_index_threshold(0);
+		add_random(plain, &prefixes[i]);
+		route_table_set_index_threshold(1000);
+		add_random(indexed, &prefixes[i]);
+		if (i % 1000 == 0)
+			verify_same_matches(plain, indexed, prefixes, i + 1,
+					    1000);
+	}
+
+	assert(!route_table_indexed(plain));
+	assert(route_table_indexed(indexed));
+	verify_same_matches(plain, indexed, prefixes, num_prefixes,
+			    100000);
+
+	for (i = 0; i < num_prefixes; i += 2) {
+		del_random(plain, &prefixes[i]);
+		del_random(indexed, &prefixes[i]);
+	}
+	assert(route_table_indexed(indexed));
+	verify_same_matches(plain, indexed, prefixes, num_prefixes,
+			    100000);
+
+	for (i = 1; i < num_prefixes; i += 2) {
+		del_random(plain, &prefixes[i]);
+		del_random(indexed, &prefixes[i]);
+		if (i % 1000 == 1)
+			verify_same_matches(plain, indexed, prefixes,
+					    num_prefixes, 1000);
+	}
+	assert(!route_table_indexed(indexed));
+	assert(route_table_count(indexed) == 0);
+
+	route_table_finish(plain);
+	route_table_finish(indexed);
+	free(prefixes);
+
+	route_table_set_index_threshold(ROUTE_TABLE_INDEX_THRESHOLD);
+	printf("Verified indexed matches on tables with up to %d prefixes\n",
+	       num_prefixes);
+}
+
+/*
+ * bench_table
+ *
+ * Builds a table of num_prefixes random prefixes, then times lookups of
+ * random addresses.
+ */
+static void bench_table(const char *what, const struct prefix_ipv4 *prefixes,
+			int num_prefixes, const uint32_t *addrs, int lookups,
+			unsigned long threshold)
+{
+	struct route_table *table;
+	struct timeval start;
+	int64_t t_insert, t_match;
+	unsigned long found = 0;
+	size_t mem;
+	int i;
+
+	route_table_set_index_threshold(threshold);
+	table = route_table_init();
+
+	monotime(&start);
+	for (i = 0; i < num_prefixes; i++)
+		add_random(table, &prefixes[i]);
+	t_insert = monotime_since(&start, NULL);
+
+	monotime(&start);
+	for (i = 0; i < lookups; i++)
+		if (match_addr(table, addrs[i]))
+			found++;
+	t_match = monotime_since(&start, NULL);
+
+	mem = route_table_count(table) * sizeof(struct route_node);
+	if (route_table_indexed(table))
+		mem += sizeof(struct route_node *) << ROUTE_TABLE_INDEX_BITS;
+
+	printf("%-10s insert %7.1f ns/prefix, match %7.1f ns/lookup (%lu found), %zu nodes, %zu KiB\n",
+	       what, t_insert * 1000.0 / num_prefixes,
+	       t_match * 1000.0 / lookups, found,
+	       (size_t)route_table_count(table), mem / 1024);
+
+	route_table_finish(table);
+}
+
+/*
+ * run_bench
+ *
+ * Not part of the regular tests: "test_table bench [prefixes]" compares
+ * the plain tree against the indexed one.
+ */
+static void run_bench(int num_prefixes)
+{
+	struct prefix_ipv4 *prefixes;
+	uint32_t *addrs;
+	int i, lookups = 4000000;
+
+	prefixes = calloc(num_prefixes, sizeof(*prefixes));
+	addrs = calloc(lookups, sizeof(*addrs));
+	assert(prefixes && addrs);
+
+	for (i = 0; i < num_prefixes; i++)
+		rand_prefix(&prefixes[i]);
+	for (i = 0; i < lookups; i++)
+		addrs[i] = rand_next();
+
+	printf("%d prefixes, %d lookups\n", num_prefixes, lookups);
+	bench_table("tree:", prefixes, num_prefixes, addrs, lookups, 0);
+	bench_table("indexed:", prefixes, num_prefixes, addrs, lookups,
+		    ROUTE_TABLE_INDEX_THRESHOLD);
+
+	free(prefixes);
+	free(addrs);
+}
+
 /*
  * run_tests
  */
@@ -500,12 +729,18 @@ static void run_tests(void)
 	test_prefix_iter_cmp();
 	test_get_next();
 	test_iter_pause();
+	test_match_index();
 }
 
 /*
  * main
  */
-int main(void)
+int main(int argc, char **argv)
 {
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		run_bench(argc > 2 ? atoi(argv[2]) : 800000);
+		return 0;
+	}
+
 	run_tests();
 }
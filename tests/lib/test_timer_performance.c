@@ -30,8 +30,7 @@
 #include "thread.h"
 #include "prng.h"
 
-#define SCHEDULE_TIMERS 1000000
-#define REMOVE_TIMERS    500000
+static const int timer_counts[] = {10000, 100000, 1000000};
 
 struct thread_master *master;
 
@@ -40,33 +39,35 @@ static int dummy_func(struct thread *thread)
 	return 0;
 }
 
-int main(int argc, char **argv)
+static void run_bench(bool wheel, int schedule_timers)
 {
 	struct prng *prng;
 	int i;
+	int remove_timers = schedule_timers / 2;
 	struct thread **timers;
 	struct timeval tv_start, tv_lap, tv_stop;
 	unsigned long t_schedule, t_remove;
 
+	thread_master_set_timer_wheel(wheel);
 	master = thread_master_create(NULL);
 	prng = prng_new(0);
-	timers = calloc(SCHEDULE_TIMERS, sizeof(*timers));
+	timers = calloc(schedule_timers, sizeof(*timers));
 
 	/* create thread structures so they won't be allocated during the
 	 * time measurement */
-	for (i = 0; i < SCHEDULE_TIMERS; i++) {
+	for (i = 0; i < schedule_timers; i++) {
 		timers[i] = NULL;
 		thread_add_timer_msec(master, dummy_func, NULL, 0, &timers[i]);
 	}
-	for (i = 0; i < SCHEDULE_TIMERS; i++)
+	for (i = 0; i < schedule_timers; i++)
 		thread_cancel(timers[i]);
 
 	monotime(&tv_start);
 
-	for (i = 0; i < SCHEDULE_TIMERS; i++) {
+	for (i = 0; i < schedule_timers; i++) {
 		long interval_msec;
 
-		interval_msec = prng_rand(prng) % (100 * SCHEDULE_TIMERS);
+		interval_msec = prng_rand(prng) % (100 * schedule_timers);
 		timers[i] = NULL;
 		thread_add_timer_msec(master, dummy_func, NULL, interval_msec,
 				      &timers[i]);
@@ -74,10 +75,10 @@ int main(int argc, char **argv)
 
 	monotime(&tv_lap);
 
-	for (i = 0; i < REMOVE_TIMERS; i++) {
+	for (i = 0; i < remove_timers; i++) {
 		int index;
 
-		index = prng_rand(prng) % SCHEDULE_TIMERS;
+		index = prng_rand(prng) % schedule_timers;
 		if (timers[index])
 			thread_cancel(timers[index]);
 		timers[index] = NULL;
@@ -91,14 +92,26 @@ int main(int argc, char **argv)
 	t_remove = 1000 * (tv_stop.tv_sec - tv_lap.tv_sec);
 	t_remove += (tv_stop.tv_usec - tv_lap.tv_usec) / 1000;
 
-	printf("Scheduling %d random timers took %lu.%03lu seconds.\n",
-	       SCHEDULE_TIMERS, t_schedule / 1000, t_schedule % 1000);
-	printf("Removing %d random timers took %lu.%03lu seconds.\n",
-	       REMOVE_TIMERS, t_remove / 1000, t_remove % 1000);
+	printf("%s: scheduling %d random timers took %lu.%03lu seconds.\n",
+	       wheel ? "wheel" : "heap", schedule_timers, t_schedule / 1000,
+	       t_schedule % 1000);
+	printf("%s: removing %d random timers took %lu.%03lu seconds.\n",
+	       wheel ? "wheel" : "heap", remove_timers, t_remove / 1000,
+	       t_remove % 1000);
 	fflush(stdout);
 
 	free(timers);
 	thread_master_free(master);
 	prng_free(prng);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int i;
+
+	for (i = 0; i < array_size(timer_counts); i++) {
+		run_bench(false, timer_counts[i]);
+		run_bench(true, timer_counts[i]);
+	}
 	return 0;
 }
@@ -0,0 +1,225 @@
+/*
+ * Round trip of ZEBRA_ROUTE_ADD_BATCH and ZEBRA_ROUTE_DELETE_BATCH messages
+ * through zapi_route_batch_encode() and the batch decoders.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "stream.h"
+#include "zclient.h"
+
+struct thread_master *master;
+
+/* more than fit into one message */
+#define TEST_PREFIXES 5000
+
+static struct prefix prefixes[TEST_PREFIXES];
+static unsigned int errors;
+
+#define test_check(cond)                                                       \
+	do {                                                                   \
+		if (!(cond)) {                                                 \
+			printf("  %s:%d: %s failed\n", __func__, __LINE__,     \
+			       #cond);                                         \
+			errors++;                                              \
+		}                                                              \
+	} while (0)
+
+static void test_prefixes_init(void)
+{
+	char buf[PREFIX_STRLEN];
+	unsigned int i;
+
+	/* mixed families and lengths */
+	for (i = 0; i < TEST_PREFIXES; i++) {
+		if (i % 3)
+			snprintf(buf, sizeof(buf), "10.%u.%u.0/%u", i / 256,
+				 i % 256, 24 + i % 9);
+		else
+			snprintf(buf, sizeof(buf), "2001:db8:%x::/%u", i,
+				 48 + i % 81);
+		str2prefix(buf, &prefixes[i]);
+		apply_mask(&prefixes[i]);
+	}
+}
+
+static void test_api_init(struct zapi_route *api, bool nexthops)
+{
+	memset(api, 0, sizeof(*api));
+	api->type = ZEBRA_ROUTE_BGP;
+	api->instance = 2;
+	api->flags = ZEBRA_FLAG_IBGP;
+	api->safi = SAFI_UNICAST;
+	api->vrf_id = VRF_DEFAULT;
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_DISTANCE);
+	api->distance = 200;
+	SET_FLAG(api->message, ZAPI_MESSAGE_METRIC);
+	api->metric = 42;
+	SET_FLAG(api->message, ZAPI_MESSAGE_TAG);
+	api->tag = 7;
+
+	if (!nexthops)
+		return;
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP);
+	api->nexthop_num = 2;
+	api->nexthops[0].type = NEXTHOP_TYPE_IPV4;
+	api->nexthops[0].vrf_id = VRF_DEFAULT;
+	inet_pton(AF_INET, "192.0.2.1", &api->nexthops[0].gate.ipv4);
+	api->nexthops[1].type = NEXTHOP_TYPE_IPV4;
+	api->nexthops[1].vrf_id = VRF_DEFAULT;
+	inet_pton(AF_INET, "192.0.2.2", &api->nexthops[1].gate.ipv4);
+}
+
+/* Reads the header the way zebra does before calling the handlers. */
+static void test_header_check(struct stream *s, uint16_t cmd)
+{
+	uint16_t size, rcmd;
+	uint8_t marker, version;
+	vrf_id_t vrf_id;
+
+	size = stream_getw(s);
+	marker = stream_getc(s);
+	version = stream_getc(s);
+	vrf_id = stream_getl(s);
+	rcmd = stream_getw(s);
+
+	test_check(size == stream_get_endp(s));
+	test_check(marker == ZEBRA_HEADER_MARKER);
+	test_check(version == ZSERV_VERSION);
+	test_check(vrf_id == VRF_DEFAULT);
+	test_check(rcmd == cmd);
+}
+
+static void test_api_check(const struct zapi_route *api,
+			   const struct zapi_route *ref)
+{
+	uint16_t i;
+
+	test_check(api->type == ref->type);
+	test_check(api->instance == ref->instance);
+	test_check(api->flags == ref->flags);
+	test_check(api->message == ref->message);
+	test_check(api->safi == ref->safi);
+	test_check(api->distance == ref->distance);
+	test_check(api->metric == ref->metric);
+	test_check(api->tag == ref->tag);
+	test_check(api->nexthop_num == ref->nexthop_num);
+
+	for (i = 0; i < api->nexthop_num && i < ref->nexthop_num; i++) {
+		test_check(api->nexthops[i].type == ref->nexthops[i].type);
+		test_check(api->nexthops[i].vrf_id == ref->nexthops[i].vrf_id);
+		test_check(IPV4_ADDR_SAME(&api->nexthops[i].gate.ipv4,
+					  &ref->nexthops[i].gate.ipv4));
+	}
+}
+
+static void test_round_trip(uint8_t cmd, bool nexthops)
+{
+	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	struct zapi_route api, ref;
+	uint32_t done = 0;
+	uint16_t count, i;
+	int n = 0;
+
+	printf("%s\n", zserv_command_string(cmd));
+
+	/* the way zclient_route_batch_send() splits them into messages */
+	while (done < TEST_PREFIXES) {
+		test_api_init(&ref, nexthops);
+		n = zapi_route_batch_encode(cmd, s, &ref, prefixes + done,
+					    TEST_PREFIXES - done);
+		if (n <= 0) {
+			printf("  %d routes encoded\n", n);
+			errors++;
+			break;
+		}
+
+		test_header_check(s, cmd);
+
+		if (zapi_route_batch_decode(s, &api, &count) < 0) {
+			printf("  decoding failed\n");
+			errors++;
+			break;
+		}
+		test_api_check(&api, &ref);
+		test_check(count == n);
+
+		for (i = 0; i < count; i++) {
+			if (zapi_route_batch_decode_prefix(s, &api) < 0) {
+				printf("  decoding prefix %u failed\n",
+				       done + i);
+				errors++;
+				break;
+			}
+			test_check(prefix_same(&api.prefix,
+					       &prefixes[done + i]));
+		}
+		test_check(STREAM_READABLE(s) == 0);
+
+		done += n;
+	}
+
+	/* one message can't hold them all */
+	test_check(done == TEST_PREFIXES && n < TEST_PREFIXES);
+
+	stream_free(s);
+}
+
+static void test_unbatchable(void)
+{
+	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	struct zapi_route api;
+
+	printf("unbatchable routes\n");
+
+	test_api_init(&api, true);
+	SET_FLAG(api.message, ZAPI_MESSAGE_SRCPFX);
+	str2prefix_ipv6("2001:db8::/64", &api.src_prefix);
+	test_check(zapi_route_batch_encode(ZEBRA_ROUTE_ADD_BATCH, s, &api,
+					   prefixes, 1)
+		   < 0);
+
+	test_api_init(&api, true);
+	SET_FLAG(api.flags, ZEBRA_FLAG_EVPN_ROUTE);
+	test_check(zapi_route_batch_encode(ZEBRA_ROUTE_ADD_BATCH, s, &api,
+					   prefixes, 1)
+		   < 0);
+
+	stream_free(s);
+}
+
+int main(int argc, char **argv)
+{
+	test_prefixes_init();
+
+	test_round_trip(ZEBRA_ROUTE_ADD_BATCH, true);
+	test_round_trip(ZEBRA_ROUTE_DELETE_BATCH, false);
+	test_unbatchable();
+
+	if (errors) {
+		printf("%u errors\n", errors);
+		return 1;
+	}
+
+	printf("ZAPI batch test successful.\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+import frrtest
+
+class TestZapiBatch(frrtest.TestMultiOut):
+    program = './test_zapi_batch'
+
+TestZapiBatch.onesimple('ZAPI batch test successful.')
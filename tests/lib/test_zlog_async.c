@@ -0,0 +1,275 @@
+/*
+ * Test for asynchronous log file writing: several pthreads log to the same
+ * file, once with the file target writing synchronously and once through
+ * the log writer pthread.  Every message needs to make it into the file, in
+ * order for each of the logging pthreads.
+ *
+ * A child process also "crashes" with messages still queued;  the crash
+ * handler needs to get all of them into the file.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+#include <pthread.h>
+#include <sys/wait.h>
+
+#include "frrcu.h"
+#include "monotime.h"
+#include "zlog.h"
+#include "zlog_targets.h"
+
+/* messages per pthread, can be overridden on the command line */
+#define MESSAGES 100000
+#define PRODUCERS 4
+
+static unsigned long messages = MESSAGES;
+static unsigned long errors;
+
+static void *producer(void *arg)
+{
+	struct rcu_thread *rcu_thread = arg;
+	static _Atomic unsigned int ids;
+	unsigned int id;
+	unsigned long i;
+
+	rcu_thread_start(rcu_thread);
+	rcu_read_unlock();
+
+	id = atomic_fetch_add_explicit(&ids, 1, memory_order_relaxed);
+
+	/* not debug level, those could be dropped */
+	for (i = 0; i < messages; i++)
+		zlog_notice("producer %u message %lu", id, i);
+
+	return NULL;
+}
+
+static void run(const char *what, struct zlog_cfg_file *zcf, bool async)
+{
+	pthread_t threads[PRODUCERS];
+	struct timeval start;
+	unsigned long usec;
+	unsigned int i;
+
+	zcf->async = async;
+	zlog_file_set_other(zcf);
+
+	monotime(&start);
+
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_create(&threads[i], NULL, producer,
+			       rcu_thread_prepare());
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_join(threads[i], NULL);
+
+	usec = monotime_since(&start, NULL);
+	printf("%-16s %lu.%06lu seconds spent logging\n", what,
+	       usec / 1000000, usec % 1000000);
+	fflush(stdout);
+}
+
+/* producer ids continue across runs, each logged 0 .. messages - 1 */
+static void check(const char *filename)
+{
+	unsigned long next[2 * PRODUCERS] = {};
+	unsigned long seq;
+	unsigned int id;
+	char line[256];
+	const char *msg;
+	FILE *fp;
+
+	fp = fopen(filename, "r");
+	if (!fp) {
+		printf("cannot open %s: %s\n", filename, strerror(errno));
+		errors++;
+		return;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		msg = strstr(line, "producer ");
+		if (!msg || sscanf(msg, "producer %u message %lu", &id, &seq) != 2
+		    || id >= array_size(next)) {
+			errors++;
+			continue;
+		}
+		if (seq != next[id])
+			errors++;
+		next[id] = seq + 1;
+	}
+	fclose(fp);
+
+	for (id = 0; id < array_size(next); id++)
+		if (next[id] != messages)
+			errors++;
+}
+
+#define CRASH_MARK "simulated crash"
+
+/* runs in a child process, the writer pthread is never stopped */
+static void __attribute__((noreturn)) crash(const char *filename)
+{
+	pthread_t threads[PRODUCERS];
+	struct zlog_cfg_file zcf;
+	unsigned int i;
+
+	zlog_aux_init("test: ", ZLOG_DISABLED);
+
+	zlog_file_init(&zcf);
+	zcf.prio_min = LOG_DEBUG;
+	zcf.async = true;
+	zlog_file_set_filename(&zcf, filename);
+
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_create(&threads[i], NULL, producer,
+			       rcu_thread_prepare());
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_join(threads[i], NULL);
+
+	/* what the crash handlers do, with messages still queued */
+	zlog_sigsafe(CRASH_MARK, strlen(CRASH_MARK));
+
+	/* let a writev() the writer was in the middle of complete, as it
+	 * would in a process being killed
+	 */
+	usleep(100000);
+	_exit(0);
+}
+
+/* messages may show up twice after a crash, but none may be missing */
+static void check_crash(const char *filename)
+{
+	uint8_t *seen;
+	unsigned long seq, i;
+	unsigned int id;
+	bool marked = false;
+	char line[256];
+	const char *msg;
+	FILE *fp;
+
+	fp = fopen(filename, "r");
+	if (!fp) {
+		printf("cannot open %s: %s\n", filename, strerror(errno));
+		errors++;
+		return;
+	}
+
+	seen = calloc(PRODUCERS * messages, 1);
+	assert(seen);
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (strstr(line, CRASH_MARK)) {
+			marked = true;
+			continue;
+		}
+		msg = strstr(line, "producer ");
+		if (!msg || sscanf(msg, "producer %u message %lu", &id, &seq) != 2
+		    || id >= PRODUCERS || seq >= messages) {
+			errors++;
+			continue;
+		}
+		seen[id * messages + seq] = 1;
+	}
+	fclose(fp);
+
+	if (!marked) {
+		printf("crash message missing\n");
+		errors++;
+	}
+	for (i = 0; i < PRODUCERS * messages; i++) {
+		if (!seen[i]) {
+			printf("message lost in crash: producer %lu message %lu\n",
+			       i / messages, i % messages);
+			errors++;
+			break;
+		}
+	}
+	free(seen);
+}
+
+int main(int argc, char **argv)
+{
+	struct zlog_async_stats stats;
+	struct zlog_cfg_file zcf;
+	char filename[] = "/tmp/test_zlog_async.XXXXXX";
+	char crashname[] = "/tmp/test_zlog_async_crash.XXXXXX";
+	pid_t pid;
+	int fd, status;
+
+	if (argc > 1)
+		messages = strtoul(argv[1], NULL, 10);
+
+	fd = mkstemp(filename);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+	fd = mkstemp(crashname);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+
+	/* before any pthreads get started here */
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return 1;
+	}
+	if (pid == 0)
+		crash(crashname);
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)
+	    || WEXITSTATUS(status)) {
+		printf("crash child failed\n");
+		errors++;
+	} else
+		check_crash(crashname);
+	unlink(crashname);
+
+	zlog_aux_init("test: ", ZLOG_DISABLED);
+
+	zlog_file_init(&zcf);
+	zcf.prio_min = LOG_DEBUG;
+	zlog_file_set_filename(&zcf, filename);
+
+	printf("%u pthreads, %lu messages each\n", PRODUCERS, messages);
+
+	run("synchronous:", &zcf, false);
+	run("asynchronous:", &zcf, true);
+
+	/* stops the writer, after it's done with everything queued */
+	zlog_fini();
+	zlog_file_fini(&zcf);
+
+	zlog_async_get_stats(&stats);
+	printf("%" PRIu64 " batches queued, %" PRIu64 " written, %" PRIu64
+	       " dropped, %" PRIu64 " stalls\n",
+	       stats.queued, stats.written, stats.dropped, stats.stalls);
+	if (stats.queued != stats.written || stats.dropped)
+		errors++;
+
+	check(filename);
+	unlink(filename);
+
+	if (errors) {
+		printf("%lu errors\n", errors);
+		return 1;
+	}
+
+	printf("Asynchronous logging test successful.\n");
+	return 0;
+}
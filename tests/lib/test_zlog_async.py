@@ -0,0 +1,6 @@
+import frrtest
+
+class TestZlogAsync(frrtest.TestMultiOut):
+    program = './test_zlog_async'
+
+TestZlogAsync.onesimple('Asynchronous logging test successful.')
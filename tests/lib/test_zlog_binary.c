@@ -0,0 +1,268 @@
+/*
+ * Test for the binary log target: logs messages with a variety of format
+ * strings, decodes the file and compares against printfrr's output.  Also
+ * times logging to the binary target against a text log file;  the timings
+ * are only printed, they never fail the test.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+#include <sys/mman.h>
+
+#include "monotime.h"
+#include "printfrr.h"
+#include "zlog.h"
+#include "zlog_targets.h"
+#include "zlog_binary.h"
+
+/* messages for the timing runs, can be overridden on the command line;
+ * enough to wrap around the ring a few times
+ */
+#define MESSAGES 200000
+
+static unsigned long messages = MESSAGES;
+static unsigned long errors;
+
+#define NUM_EXPECT 16
+
+static char expect[NUM_EXPECT][512];
+static unsigned int num_expect, num_seen;
+
+/* logs a message and records what it should look like */
+#define LOG(fmt, ...)                                                          \
+	do {                                                                   \
+		assert(num_expect < NUM_EXPECT);                               \
+		snprintfrr(expect[num_expect++], sizeof(expect[0]), fmt,       \
+			   __VA_ARGS__);                                       \
+		zlog_notice(fmt, __VA_ARGS__);                                 \
+	} while (0)
+
+static void log_messages(void)
+{
+	struct in_addr addr = { .s_addr = htonl(0xc0000201) };
+	char fmt[64];
+	int width = 12;
+
+	LOG("integers: %d %i %u %x %X %o", -1, 42, 4000000000U, 0xbeef,
+	    0xcafe, 0755);
+	LOG("sizes: %hhd %hd %ld %lld %zu %jd %td", (signed char)-3,
+	    (short)-1234, -123456789L, -1234567890123LL, (size_t)99,
+	    (intmax_t)-7, (ptrdiff_t)8);
+	LOG("flags: [%-8d] [%+d] [% d] [%08.3f] [%#x]", 1, 2, 3, 3.14159,
+	    255);
+	LOG("star: [%*d] [%-*s] [%.*s]", width, 5, 10, "abc", 2, "xyz");
+	LOG("floats: %f %e %g", 1.5, 12345.678, 0.0001);
+	/* more digits than a double has, stored as text */
+	LOG("long double: %.20Lf", (long double)1 / 3);
+	LOG("strings: %s [%.3s] %c%c", "hello", "truncate", 'o', 'k');
+	LOG("percent: 100%% %s", "done");
+	LOG("extension: %pI4 [%18pI4] %s", &addr, &addr, "after");
+
+	/* same format string pointer, different contents: stored as text */
+	strlcpy(fmt, "dynamic %d", sizeof(fmt));
+	LOG(fmt, 1);
+	strlcpy(fmt, "changed %s %d", sizeof(fmt));
+	LOG(fmt, "format", 2);
+
+	/* positional arguments aren't supported, stored as text */
+	LOG("positional: %2$s %1$s", "world", "hello");
+}
+
+static void decode_cb(void *arg, const struct zlog_bin_msg *msg)
+{
+	if (num_seen >= num_expect) {
+		printf("extra message: \"%s\"\n", msg->text);
+		errors++;
+		return;
+	}
+	if (msg->prio != LOG_NOTICE || strcmp(msg->prefix, "test: ")
+	    || msg->textlen != strlen(msg->text)
+	    || strcmp(msg->text, expect[num_seen])) {
+		printf("mismatch:\n  expected \"%s\"\n  decoded  \"%s\"\n",
+		       expect[num_seen], msg->text);
+		errors++;
+	}
+	num_seen++;
+}
+
+static void *map_file(const char *filename, size_t *size)
+{
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		printf("cannot open %s: %s\n", filename, strerror(errno));
+		errors++;
+		if (fd >= 0)
+			close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		errors++;
+		return NULL;
+	}
+	*size = st.st_size;
+	return map;
+}
+
+static void check(const char *filename)
+{
+	size_t size;
+	void *map;
+
+	map = map_file(filename, &size);
+	if (!map)
+		return;
+
+	if (zlog_bin_decode(map, size, decode_cb, NULL) != num_expect
+	    || num_seen != num_expect)
+		errors++;
+	munmap(map, size);
+}
+
+static unsigned long wrap_first, wrap_last, wrap_count;
+
+static void wrap_cb(void *arg, const struct zlog_bin_msg *msg)
+{
+	unsigned long seq;
+
+	if (sscanf(msg->text, "timing message %lu", &seq) != 1
+	    || (wrap_count && seq != wrap_last + 1)) {
+		errors++;
+		return;
+	}
+	if (!wrap_count)
+		wrap_first = seq;
+	wrap_last = seq;
+	wrap_count++;
+}
+
+/* the oldest messages are gone, the rest needs to be there, in order */
+static void check_wrap(const char *filename)
+{
+	size_t size;
+	void *map;
+
+	map = map_file(filename, &size);
+	if (!map)
+		return;
+
+	if (zlog_bin_decode(map, size, wrap_cb, NULL) < 0 || !wrap_count
+	    || wrap_last != messages - 1 || wrap_first == 0)
+		errors++;
+	munmap(map, size);
+}
+
+static void timing(const char *what, unsigned long n)
+{
+	struct timeval start;
+	unsigned long i, usec;
+
+	monotime(&start);
+	for (i = 0; i < n; i++)
+		zlog_notice("timing message %lu: %s %d", i, "abc", 123);
+	usec = monotime_since(&start, NULL);
+
+	printf("%-16s %lu.%06lu seconds spent logging\n", what,
+	       usec / 1000000, usec % 1000000);
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	struct zlog_cfg_bin zcb;
+	struct zlog_cfg_file zcf;
+	char binname[] = "/tmp/test_zlog_binary.XXXXXX";
+	char prevname[sizeof(binname) + 5];
+	char textname[] = "/tmp/test_zlog_binary_text.XXXXXX";
+	int fd;
+
+	if (argc > 1)
+		messages = strtoul(argv[1], NULL, 10);
+
+	fd = mkstemp(binname);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+	snprintf(prevname, sizeof(prevname), "%s.prev", binname);
+	fd = mkstemp(textname);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+
+	zlog_aux_init("test: ", ZLOG_DISABLED);
+
+	zlog_bin_init(&zcb);
+	zcb.prio_min = LOG_DEBUG;
+	zcb.size = 1024 * 1024;
+	if (!zlog_bin_set_filename(&zcb, binname)) {
+		printf("cannot set up binary log: %s\n", strerror(errno));
+		return 1;
+	}
+
+	log_messages();
+	check(binname);
+
+	printf("%lu messages\n", messages);
+
+	/* 1MiB wraps around a lot */
+	timing("binary:", messages);
+	check_wrap(binname);
+
+	/* another level keeps logging into the same file;  another size
+	 * starts a new one, moving the old one to FILENAME.prev
+	 */
+	zcb.prio_min = LOG_INFO;
+	zlog_bin_set_other(&zcb);
+	zcb.size = 2 * 1024 * 1024;
+	zlog_bin_set_other(&zcb);
+	wrap_count = 0;
+	check_wrap(prevname);
+
+	zcb.prio_min = ZLOG_DISABLED;
+	zlog_bin_set_other(&zcb);
+
+	zlog_file_init(&zcf);
+	zcf.prio_min = LOG_DEBUG;
+	zlog_file_set_filename(&zcf, textname);
+
+	timing("text:", messages);
+
+	zlog_fini();
+	zlog_file_fini(&zcf);
+	zlog_bin_fini(&zcb);
+
+	unlink(binname);
+	unlink(prevname);
+	unlink(textname);
+
+	if (errors) {
+		printf("%lu errors\n", errors);
+		return 1;
+	}
+
+	printf("Binary log test successful.\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+import frrtest
+
+class TestZlogBinary(frrtest.TestMultiOut):
+    program = './test_zlog_binary'
+
+TestZlogBinary.onesimple('Binary log test successful.')
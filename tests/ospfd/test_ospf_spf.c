@@ -0,0 +1,315 @@
+/*
+ * Checks that per-area SPF calculated on the worker pthreads gives the same
+ * routing table as calculating the areas one after the other, for areas
+ * that reach the same networks at different or equal cost.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "linklist.h"
+#include "prefix.h"
+#include "if.h"
+#include "table.h"
+#include "privs.h"
+#include "frr_pthread.h"
+
+#include "ospfd/ospfd.h"
+#include "ospfd/ospf_interface.h"
+#include "ospfd/ospf_lsa.h"
+#include "ospfd/ospf_lsdb.h"
+#include "ospfd/ospf_spf.h"
+#include "ospfd/ospf_route.h"
+
+/* need these to link in libfrrospf */
+struct thread_master *master;
+struct zebra_privs_t ospfd_privs = {};
+
+/*
+ * Each area has this router, 1.1.1.1, and one neighbor, 192.168.0.<area>,
+ * on the network 10.0.<area>.0/24.  The neighbor also has the network as a
+ * stub link, at the same cost, so that the route is added by the transit
+ * rule and then updated by the stub rule.  This router has a stub link to
+ * the next area's network, and the neighbor stub links to networks shared
+ * by all areas at varying cost.
+ */
+#define TEST_AREAS 4
+#define TEST_SHARED_NETS 8
+
+#define TEST_ROUTER_ID 0x01010101	/* 1.1.1.1 */
+#define TEST_NEIGHBOR_ID(a) (0xc0a80000 | (a)) /* 192.168.0.<a> */
+#define TEST_NET(a) (0x0a000000 | ((a) << 8))	/* 10.0.<a>.0 */
+#define TEST_SHARED_NET(n) (0xac100000 | ((n) << 8)) /* 172.16.<n>.0 */
+#define TEST_MASK 0xffffff00
+
+static struct interface test_ifps[TEST_AREAS];
+static struct connected test_connected[TEST_AREAS];
+
+static void test_link_set(struct router_lsa *rl, unsigned int i,
+			  uint32_t link_id, uint32_t link_data, uint8_t type,
+			  uint16_t metric)
+{
+	rl->link[i].link_id.s_addr = htonl(link_id);
+	rl->link[i].link_data.s_addr = htonl(link_data);
+	rl->link[i].type = type;
+	rl->link[i].tos = 0;
+	rl->link[i].metric = htons(metric);
+}
+
+static struct ospf_lsa *test_lsa_add(struct ospf_area *area, uint8_t type,
+				     uint32_t id, uint32_t adv_router,
+				     size_t length)
+{
+	struct ospf_lsa *lsa;
+
+	lsa = ospf_lsa_new_and_data(length);
+	memset(lsa->data, 0, length);
+	lsa->data->type = type;
+	lsa->data->id.s_addr = htonl(id);
+	lsa->data->adv_router.s_addr = htonl(adv_router);
+	lsa->data->length = htons(length);
+	lsa->area = area;
+
+	ospf_lsdb_add(area->lsdb, lsa);
+	return lsa;
+}
+
+static void test_area_add(struct ospf *ospf, unsigned int a)
+{
+	struct ospf_area *area;
+	struct ospf_interface *oi;
+	struct ospf_lsa *lsa;
+	struct router_lsa *rl;
+	struct network_lsa *nl;
+	struct in_addr area_id = {.s_addr = htonl(a)};
+	unsigned int nlinks, i;
+
+	area = ospf_area_get(ospf, area_id);
+
+	/* this router */
+	nlinks = 2;
+	lsa = test_lsa_add(area, OSPF_ROUTER_LSA, TEST_ROUTER_ID,
+			   TEST_ROUTER_ID,
+			   OSPF_LSA_HEADER_SIZE + 4
+				   + nlinks * OSPF_ROUTER_LSA_LINK_SIZE);
+	SET_FLAG(lsa->flags, OSPF_LSA_SELF);
+	rl = (struct router_lsa *)lsa->data;
+	rl->flags = ROUTER_LSA_BORDER;
+	rl->links = htons(nlinks);
+	test_link_set(rl, 0, TEST_NET(a) | 1, TEST_NET(a) | 1,
+		      LSA_LINK_TYPE_TRANSIT, 10);
+	test_link_set(rl, 1, TEST_NET(a + 1), TEST_MASK, LSA_LINK_TYPE_STUB,
+		      5 * a);
+	area->router_lsa_self = lsa;
+
+	/* the neighbor */
+	nlinks = 2 + TEST_SHARED_NETS;
+	lsa = test_lsa_add(area, OSPF_ROUTER_LSA, TEST_NEIGHBOR_ID(a),
+			   TEST_NEIGHBOR_ID(a),
+			   OSPF_LSA_HEADER_SIZE + 4
+				   + nlinks * OSPF_ROUTER_LSA_LINK_SIZE);
+	rl = (struct router_lsa *)lsa->data;
+	rl->flags = ROUTER_LSA_BORDER;
+	rl->links = htons(nlinks);
+	test_link_set(rl, 0, TEST_NET(a) | 1, TEST_NET(a) | 2,
+		      LSA_LINK_TYPE_TRANSIT, 10);
+	test_link_set(rl, 1, TEST_NET(a), TEST_MASK, LSA_LINK_TYPE_STUB, 0);
+	for (i = 0; i < TEST_SHARED_NETS; i++)
+		test_link_set(rl, 2 + i, TEST_SHARED_NET(i), TEST_MASK,
+			      LSA_LINK_TYPE_STUB, (i + a) % 3 + 1);
+
+	/* the network between them, this router is DR */
+	lsa = test_lsa_add(area, OSPF_NETWORK_LSA, TEST_NET(a) | 1,
+			   TEST_ROUTER_ID, OSPF_LSA_HEADER_SIZE + 4 + 2 * 4);
+	nl = (struct network_lsa *)lsa->data;
+	nl->mask.s_addr = htonl(TEST_MASK);
+	nl->routers[0].s_addr = htonl(TEST_ROUTER_ID);
+	nl->routers[1].s_addr = htonl(TEST_NEIGHBOR_ID(a));
+
+	/* the interface this router's links go out of */
+	snprintf(test_ifps[a - 1].name, sizeof(test_ifps[a - 1].name),
+		 "eth%u", a);
+	test_ifps[a - 1].ifindex = a;
+
+	oi = XCALLOC(MTYPE_TMP, sizeof(*oi));
+	oi->ospf = ospf;
+	oi->area = area;
+	oi->ifp = &test_ifps[a - 1];
+	oi->connected = &test_connected[a - 1];
+	oi->type = OSPF_IFTYPE_BROADCAST;
+	oi->lsa_pos_beg = 0;
+	oi->lsa_pos_end = 2;
+	ospf_area_add_if(area, oi);
+}
+
+static unsigned int test_table_count(struct route_table *rt)
+{
+	struct route_node *rn;
+	unsigned int count = 0;
+
+	for (rn = route_top(rt); rn; rn = route_next(rn))
+		if (rn->info)
+			count++;
+
+	return count;
+}
+
+static bool test_route_same(struct ospf_route *or1, struct ospf_route *or2)
+{
+	struct listnode *node;
+	struct ospf_path *path;
+
+	if (or1->cost != or2->cost || or1->path_type != or2->path_type
+	    || !IPV4_ADDR_SAME(&or1->u.std.area_id, &or2->u.std.area_id)
+	    || or1->u.std.origin != or2->u.std.origin)
+		return false;
+
+	if (listcount(or1->paths) != listcount(or2->paths))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(or1->paths, node, path))
+		if (!ospf_path_lookup(or2->paths, path))
+			return false;
+
+	return true;
+}
+
+static unsigned int test_compare(struct route_table *rt,
+				 struct route_table *rtrs,
+				 struct route_table *ref_rt,
+				 struct route_table *ref_rtrs)
+{
+	struct route_node *rn, *rn2;
+	unsigned int errors = 0;
+	char buf[PREFIX_STRLEN];
+
+	if (test_table_count(rt) != test_table_count(ref_rt)) {
+		printf("  %u network routes, expected %u\n",
+		       test_table_count(rt), test_table_count(ref_rt));
+		errors++;
+	}
+
+	for (rn = route_top(ref_rt); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(rt, &rn->p);
+		if (!rn2 || !test_route_same(rn->info, rn2->info)) {
+			printf("  route to %s differs\n",
+			       prefix2str(&rn->p, buf, sizeof(buf)));
+			errors++;
+		}
+		if (rn2)
+			route_unlock_node(rn2);
+	}
+
+	for (rn = route_top(ref_rtrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(rtrs, &rn->p);
+		if (!rn2
+		    || listcount((struct list *)rn->info)
+			       != listcount((struct list *)rn2->info)) {
+			printf("  routes to router %s differ\n",
+			       prefix2str(&rn->p, buf, sizeof(buf)));
+			errors++;
+		}
+		if (rn2)
+			route_unlock_node(rn2);
+	}
+
+	return errors;
+}
+
+static unsigned int test_run(struct ospf *ospf, unsigned int threads,
+			     struct route_table *ref_rt,
+			     struct route_table *ref_rtrs)
+{
+	struct route_table *rt, *rtrs;
+	unsigned int errors;
+	int areas;
+
+	printf("%u SPF threads\n", threads);
+
+	ospf->spf_threads = threads;
+	rt = route_table_init();
+	rtrs = route_table_init();
+
+	areas = ospf_spf_calculate_areas(ospf, rt, rtrs);
+	if (areas != TEST_AREAS) {
+		printf("  %d areas calculated, expected %d\n", areas,
+		       TEST_AREAS);
+		errors = 1;
+	} else
+		errors = test_compare(rt, rtrs, ref_rt, ref_rtrs);
+
+	ospf_route_table_free(rt);
+	ospf_rtrs_free(rtrs);
+
+	return errors;
+}
+
+int main(int argc, char **argv)
+{
+	struct route_table *ref_rt, *ref_rtrs;
+	struct ospf *ospf;
+	unsigned int a, errors = 0;
+
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	master = thread_master_create(NULL);
+	frr_pthread_init();
+
+	ospf = XCALLOC(MTYPE_TMP, sizeof(*ospf));
+	ospf->router_id.s_addr = htonl(TEST_ROUTER_ID);
+	ospf->areas = list_new();
+	ospf->oiflist = list_new();
+	ospf->vlinks = list_new();
+
+	/* in area ID order, as ospf_new() sorts them */
+	for (a = 1; a <= TEST_AREAS; a++)
+		test_area_add(ospf, a);
+
+	/* the areas one after the other */
+	ospf->spf_threads = 1;
+	ref_rt = route_table_init();
+	ref_rtrs = route_table_init();
+	if (ospf_spf_calculate_areas(ospf, ref_rt, ref_rtrs) != TEST_AREAS) {
+		printf("areas not calculated\n");
+		return 1;
+	}
+
+	errors += test_run(ospf, TEST_AREAS, ref_rt, ref_rtrs);
+	/* fewer threads than the pool was started with */
+	errors += test_run(ospf, 2, ref_rt, ref_rtrs);
+
+	ospf_route_table_free(ref_rt);
+	ospf_rtrs_free(ref_rtrs);
+	ospf_spf_workers_finish();
+	frr_pthread_finish();
+
+	if (errors) {
+		printf("%u errors\n", errors);
+		return 1;
+	}
+
+	printf("OSPF SPF test successful.\n");
+	return 0;
+}
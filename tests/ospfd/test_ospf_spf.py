@@ -0,0 +1,6 @@
+import frrtest
+
+class TestOspfSpf(frrtest.TestMultiOut):
+    program = './test_ospf_spf'
+
+TestOspfSpf.onesimple('OSPF SPF test successful.')
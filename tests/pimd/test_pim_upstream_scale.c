@@ -0,0 +1,268 @@
+/*
+ * Scale test for the PIM upstream table: creates a large number of (S,G)
+ * entries, then a burst of (*,G) entries which have to adopt them, and
+ * checks the parent/child linkage along the way.
+ *
+ * This file is part of FRRouting.
+ *
+ * FRRouting is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRRouting is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "hash.h"
+#include "vrf.h"
+#include "privs.h"
+#include "memory.h"
+#include "monotime.h"
+
+#include "pimd/pimd.h"
+#include "pimd/pim_instance.h"
+#include "pimd/pim_upstream.h"
+#include "pimd/pim_oil.h"
+#include "pimd/pim_rp.h"
+#include "pimd/pim_msdp.h"
+#include "pimd/pim_rpf.h"
+#include "pimd/pim_nht.h"
+#include "pimd/pim_zebra.h"
+
+/* number of groups, kept small for make check;  give a larger number on the
+ * command line to see how the table scales
+ */
+#define GROUPS 1000
+/* (S,G) entries per group */
+#define SOURCES 2
+
+/* need these to link in libpim */
+struct zebra_privs_t pimd_privs = {
+	.user = NULL,
+	.group = NULL,
+	.vty_group = NULL,
+};
+
+static struct pim_instance *pim;
+static unsigned long groups = GROUPS;
+static unsigned long errors;
+
+static void pim_create_fake(void)
+{
+	struct vrf *vrf;
+
+	router = XCALLOC(MTYPE_TMP, sizeof(*router));
+	router->master = thread_master_create(NULL);
+	router->infinite_assert_metric.rpt_bit_flag = 1;
+	router->infinite_assert_metric.metric_preference =
+		PIM_ASSERT_METRIC_PREFERENCE_MAX;
+	router->infinite_assert_metric.route_metric =
+		PIM_ASSERT_ROUTE_METRIC_MAX;
+	router->vrf_id = VRF_DEFAULT;
+
+	vrf_init(NULL, NULL, NULL, NULL, NULL);
+	vrf = vrf_lookup_by_id(VRF_DEFAULT);
+
+	pim = XCALLOC(MTYPE_TMP, sizeof(*pim));
+	pim->vrf = vrf;
+	pim->vrf_id = VRF_DEFAULT;
+	pim->keep_alive_time = PIM_KEEPALIVE_PERIOD;
+	vrf->info = pim;
+
+	pim_msdp_init(pim, router->master);
+	pim_rp_init(pim);
+	pim_oil_init(pim);
+	pim_upstream_init(pim);
+
+	/*
+	 * (S,G) entries register their source for nexthop tracking and look up
+	 * the RPF interface, which needs the NHT cache and the zclients.  The
+	 * latter never get to connect; see nht_answer() for the lookups.
+	 */
+	pim->rpf_hash = hash_create_size(256, pim_rpf_hash_key, pim_rpf_equal,
+					 "PIM RPF Hash");
+	pim_zebra_init();
+}
+
+static struct prefix_sg make_sg(unsigned long group, unsigned long source)
+{
+	struct prefix_sg sg;
+
+	memset(&sg, 0, sizeof(sg));
+	/* 239.0.0.0/8, well beyond GROUPS */
+	sg.grp.s_addr = htonl(0xef000000 + group);
+	/* source 0 is the (*,G) */
+	if (source)
+		sg.src.s_addr = htonl(0x0a000000 + source);
+
+	return sg;
+}
+
+/*
+ * Tracks the sources' nexthops, with an answer from "zebra" that there are
+ * none, so RPF lookups take them from the cache instead of trying to ask
+ * zebra for every (S,G).  The tracking stays on while no (S,G) is left.
+ */
+static void nht_answer(void)
+{
+	struct pim_nexthop_cache *pnc;
+	struct pim_rpf rpf;
+	struct prefix_sg sg;
+	unsigned long source;
+
+	for (source = 1; source <= SOURCES; source++) {
+		sg = make_sg(0, source);
+
+		memset(&rpf, 0, sizeof(rpf));
+		rpf.rpf_addr.family = AF_INET;
+		rpf.rpf_addr.prefixlen = IPV4_MAX_BITLEN;
+		rpf.rpf_addr.u.prefix4 = sg.src;
+
+		pim_find_or_track_nexthop(pim, &rpf.rpf_addr, NULL, NULL, true,
+					  NULL);
+		pnc = pim_nexthop_cache_find(pim, &rpf);
+		SET_FLAG(pnc->flags, PIM_NEXTHOP_ANSWER_RECEIVED);
+	}
+}
+
+static struct pim_upstream *find(unsigned long group, unsigned long source)
+{
+	struct prefix_sg sg = make_sg(group, source);
+
+	return pim_upstream_find(pim, &sg);
+}
+
+static void add(unsigned long group, unsigned long source)
+{
+	struct prefix_sg sg = make_sg(group, source);
+
+	if (!pim_upstream_add(pim, &sg, NULL, 0, __func__, NULL))
+		errors++;
+}
+
+static void del(unsigned long group, unsigned long source)
+{
+	struct pim_upstream *up = find(group, source);
+
+	if (!up || pim_upstream_del(pim, up, __func__))
+		errors++;
+}
+
+/* Check the linkage of one group, with or without its (*,G). */
+static void check(unsigned long group, bool star)
+{
+	struct pim_upstream *starup = find(group, 0);
+	struct pim_upstream *up;
+	unsigned long source;
+
+	if (!star) {
+		if (starup)
+			errors++;
+		for (source = 1; source <= SOURCES; source++) {
+			up = find(group, source);
+			if (!up || up->parent)
+				errors++;
+		}
+		return;
+	}
+
+	if (!starup || starup->parent
+	    || rb_pim_upstream_sources_count(&starup->sources) != SOURCES) {
+		errors++;
+		return;
+	}
+	for (source = 1; source <= SOURCES; source++) {
+		up = find(group, source);
+		if (!up || up->parent != starup
+		    || rb_pim_upstream_sources_find(&starup->sources, up) != up)
+			errors++;
+	}
+}
+
+static void report(const char *what, unsigned long count,
+		   struct timeval *start)
+{
+	unsigned long usec = monotime_since(start, NULL);
+
+	printf("%-24s %8lu entries, %lu.%06lu seconds\n", what, count,
+	       usec / 1000000, usec % 1000000);
+	fflush(stdout);
+	monotime(start);
+}
+
+int main(int argc, char **argv)
+{
+	struct timeval start;
+	unsigned long group, source;
+
+	if (argc > 1)
+		groups = strtoul(argv[1], NULL, 10);
+
+	qobj_init();
+	pim_create_fake();
+	nht_answer();
+
+	printf("%lu groups, %u sources each\n", groups, SOURCES);
+
+	monotime(&start);
+	for (group = 0; group < groups; group++)
+		for (source = 1; source <= SOURCES; source++)
+			add(group, source);
+	report("create (S,G):", groups * SOURCES, &start);
+
+	/* each (*,G) has to find the (S,G)s created above */
+	for (group = 0; group < groups; group++)
+		add(group, 0);
+	report("create (*,G):", groups, &start);
+
+	for (group = 0; group < groups; group++)
+		check(group, true);
+
+	for (group = 0; group < groups; group++)
+		del(group, 0);
+	report("delete (*,G):", groups, &start);
+
+	for (group = 0; group < groups; group++)
+		check(group, false);
+
+	/* (*,G) first this time, (S,G)s find their parent on creation */
+	for (group = 0; group < groups; group++)
+		add(group, 0);
+	for (group = 0; group < groups; group++)
+		for (source = 1; source <= SOURCES; source++) {
+			del(group, source);
+			add(group, source);
+		}
+	report("re-create (S,G):", groups * SOURCES, &start);
+
+	for (group = 0; group < groups; group++)
+		check(group, true);
+
+	for (group = 0; group < groups; group++) {
+		for (source = 1; source <= SOURCES; source++)
+			del(group, source);
+		del(group, 0);
+	}
+	report("delete all:", groups * (SOURCES + 1), &start);
+
+	if (rb_pim_upstream_count(&pim->upstream_head))
+		errors++;
+
+	if (errors) {
+		printf("%lu errors\n", errors);
+		return 1;
+	}
+
+	printf("PIM upstream scale test successful.\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+import frrtest
+
+class TestPimUpstreamScale(frrtest.TestMultiOut):
+    program = './test_pim_upstream_scale'
+
+TestPimUpstreamScale.onesimple('PIM upstream scale test successful.')
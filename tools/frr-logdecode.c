@@ -0,0 +1,129 @@
+/*
+ * Decodes binary log files written by "log binary-file" into text.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <zebra.h>
+#include <sys/mman.h>
+
+#include "zlog.h"
+#include "zlog_binary.h"
+
+#define USAGE "usage: frr-logdecode [-p] [-u] FILE..."
+
+/* same as the text log files with "log record-priority" */
+static const char * const prionames[] = {
+	[LOG_EMERG] =	"emergencies: ",
+	[LOG_ALERT] =	"alerts: ",
+	[LOG_CRIT] =	"critical: ",
+	[LOG_ERR] =	"errors: ",
+	[LOG_WARNING] =	"warnings: ",
+	[LOG_NOTICE] =	"notifications: ",
+	[LOG_INFO] =	"informational: ",
+	[LOG_DEBUG] =	"debugging: ",
+};
+
+struct decode_opts {
+	bool priority;
+	bool utc;
+};
+
+static void decode_msg(void *arg, const struct zlog_bin_msg *msg)
+{
+	const struct decode_opts *opts = arg;
+	char ts[32];
+	struct tm tm;
+
+	if (opts->utc)
+		gmtime_r(&msg->ts.tv_sec, &tm);
+	else
+		localtime_r(&msg->ts.tv_sec, &tm);
+	strftime(ts, sizeof(ts), "%Y/%m/%d %H:%M:%S", &tm);
+
+	printf("%s.%06ld %s%s%.*s\n", ts, msg->ts.tv_nsec / 1000,
+	       (opts->priority && msg->prio >= 0 && msg->prio <= LOG_DEBUG)
+		       ? prionames[msg->prio]
+		       : "",
+	       msg->prefix, (int)msg->textlen, msg->text);
+}
+
+static int decode_file(const char *filename, struct decode_opts *opts)
+{
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return 1;
+	}
+
+	/* the daemon may still be writing to it;  we get whatever is in the
+	 * file at this point, possibly with a partial message at the end
+	 */
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+		return 1;
+	}
+
+	if (zlog_bin_decode(map, st.st_size, decode_msg, opts) < 0) {
+		fprintf(stderr, "%s: not a binary log file\n", filename);
+		munmap(map, st.st_size);
+		return 1;
+	}
+
+	munmap(map, st.st_size);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct decode_opts opts = {};
+	int opt, ret = 0;
+
+	while ((opt = getopt(argc, argv, "puh")) != -1) {
+		switch (opt) {
+		case 'p':
+			opts.priority = true;
+			break;
+		case 'u':
+			opts.utc = true;
+			break;
+		default:
+			fprintf(stderr, USAGE "\n");
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, USAGE "\n");
+		return 1;
+	}
+
+	for (; optind < argc; optind++)
+		ret |= decode_file(argv[optind], &opts);
+
+	return ret;
+}
@@ -2557,6 +2557,29 @@ DEFUNSH(VTYSH_ALL, no_vtysh_log_file, no_vtysh_log_file_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUNSH(VTYSH_ALL, vtysh_log_binfile, vtysh_log_binfile_cmd,
+	"log binary-file FILENAME [size (1-1024)] [<emergencies|alerts|critical|errors|warnings|notifications|informational|debugging>]",
+	"Logging control\n"
+	"Logging to a binary ring buffer file\n"
+	"Logging filename, the daemon name is appended\n"
+	"Set the file size\n"
+	"File size in MiB\n" LOG_LEVEL_DESC)
+{
+	return CMD_SUCCESS;
+}
+
+DEFUNSH(VTYSH_ALL, no_vtysh_log_binfile, no_vtysh_log_binfile_cmd,
+	"no log binary-file [FILENAME [size (1-1024)] [LEVEL]]", NO_STR
+	"Logging control\n"
+	"Cancel logging to a binary file\n"
+	"Logging file name\n"
+	"Set the file size\n"
+	"File size in MiB\n"
+	"Logging level\n")
+{
+	return CMD_SUCCESS;
+}
+
 DEFUNSH(VTYSH_ALL, vtysh_log_monitor, vtysh_log_monitor_cmd,
 	"log monitor [<emergencies|alerts|critical|errors|warnings|notifications|informational|debugging>]",
 	"Logging control\n"
@@ -2626,6 +2649,22 @@ DEFUNSH(VTYSH_ALL, no_vtysh_log_record_priority,
 	return CMD_SUCCESS;
 }
 
+DEFUNSH(VTYSH_ALL, vtysh_log_async, vtysh_log_async_cmd,
+	"log asynchronous",
+	"Logging control\n"
+	"Write log files and stdout from a separate pthread\n")
+{
+	return CMD_SUCCESS;
+}
+
+DEFUNSH(VTYSH_ALL, no_vtysh_log_async, no_vtysh_log_async_cmd,
+	"no log asynchronous", NO_STR
+	"Logging control\n"
+	"Write log files and stdout from the pthread logging the message\n")
+{
+	return CMD_SUCCESS;
+}
+
 DEFUNSH(VTYSH_ALL, vtysh_log_timestamp_precision,
 	vtysh_log_timestamp_precision_cmd, "log timestamp precision (0-6)",
 	"Logging control\n"
@@ -4015,6 +4054,8 @@ void vtysh_init_vty(void)
 	install_element(CONFIG_NODE, &vtysh_log_file_cmd);
 	install_element(CONFIG_NODE, &vtysh_log_file_level_cmd);
 	install_element(CONFIG_NODE, &no_vtysh_log_file_cmd);
+	install_element(CONFIG_NODE, &vtysh_log_binfile_cmd);
+	install_element(CONFIG_NODE, &no_vtysh_log_binfile_cmd);
 	install_element(CONFIG_NODE, &vtysh_log_monitor_cmd);
 	install_element(CONFIG_NODE, &no_vtysh_log_monitor_cmd);
 	install_element(CONFIG_NODE, &vtysh_log_syslog_cmd);
@@ -4025,6 +4066,8 @@ void vtysh_init_vty(void)
 	install_element(CONFIG_NODE, &no_vtysh_log_record_priority_cmd);
 	install_element(CONFIG_NODE, &vtysh_log_timestamp_precision_cmd);
 	install_element(CONFIG_NODE, &no_vtysh_log_timestamp_precision_cmd);
+	install_element(CONFIG_NODE, &vtysh_log_async_cmd);
+	install_element(CONFIG_NODE, &no_vtysh_log_async_cmd);
 
 	install_element(CONFIG_NODE, &vtysh_service_password_encrypt_cmd);
 	install_element(CONFIG_NODE, &no_vtysh_service_password_encrypt_cmd);
@@ -60,6 +60,14 @@
 #define SO_RCVBUFFORCE  (33)
 #endif
 
+/* Default size of a batch of dataplane updates, and how full it gets
+ * before being sent to the kernel.
+ */
+#define NL_DEFAULT_BATCH_BUFSIZE (16 * NL_PKT_BUF_SIZE)
+#define NL_DEFAULT_BATCH_SEND_THRESHOLD (15 * NL_PKT_BUF_SIZE)
+
+DEFINE_MTYPE_STATIC(ZEBRA, NL_BUF, "Zebra Netlink batch buffer")
+
 /* Hack for GNU libc version 2. */
 #ifndef MSG_TRUNC
 #define MSG_TRUNC      0x20
@@ -151,6 +159,11 @@ extern uint32_t nl_rcvbufsize;
 
 extern struct zebra_privs_t zserv_privs;
 
+/* Batching of dataplane updates; the dplane pthreads read these */
+static _Atomic bool nl_batch_enabled = true;
+static _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
+static _Atomic uint32_t nl_batch_send_threshold =
+	NL_DEFAULT_BATCH_SEND_THRESHOLD;
 
 int netlink_talk_filter(struct nlmsghdr *h, ns_id_t ns_id, int startup)
 {
@@ -437,66 +450,70 @@ static int kernel_read(struct thread *thread)
  * so that we only had to write one way to handle incoming
  * address add/delete changes.
  */
-static void netlink_install_filter(int sock, __u32 pid, __u32 dplane_pid)
+static void netlink_install_filter(int sock, const __u32 *pids, int npids)
 {
+	struct sock_filter filter[DPLANE_WORKERS_MAX + 8];
+	int i, n = 0;
+
 	/*
 	 * BPF_JUMP instructions and where you jump to are based upon
 	 * 0 as being the next statement.  So count from 0.  Writing
 	 * this down because every time I look at this I have to
 	 * re-remember it.
+	 *
+	 * Logic:
+	 *   if (nlmsg_pid is one of pids) {
+	 *       if (the incoming nlmsg_type ==
+	 *           RTM_NEWADDR | RTM_DELADDR)
+	 *           keep this message
+	 *       else
+	 *           skip this message
+	 *   } else
+	 *       keep this netlink message
 	 */
-	struct sock_filter filter[] = {
-		/*
-		 * Logic:
-		 *   if (nlmsg_pid == pid ||
-		 *       nlmsg_pid == dplane_pid) {
-		 *       if (the incoming nlmsg_type ==
-		 *           RTM_NEWADDR | RTM_DELADDR)
-		 *           keep this message
-		 *       else
-		 *           skip this message
-		 *   } else
-		 *       keep this netlink message
-		 */
-		/*
-		 * 0: Load the nlmsg_pid into the BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_W,
-			 offsetof(struct nlmsghdr, nlmsg_pid)),
-		/*
-		 * 1: Compare to pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(pid), 1, 0),
-		/*
-		 * 2: Compare to dplane pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(dplane_pid), 0, 4),
-		/*
-		 * 3: Load the nlmsg_type into BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_H,
-			 offsetof(struct nlmsghdr, nlmsg_type)),
-		/*
-		 * 4: Compare to RTM_NEWADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 2, 0),
-		/*
-		 * 5: Compare to RTM_DELADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 1, 0),
-		/*
-		 * 6: This is the end state of we want to skip the
-		 *    message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0),
-		/* 7: This is the end state of we want to keep
-		 *     the message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0xffff),
-	};
+	assert(npids > 0 && npids <= DPLANE_WORKERS_MAX + 2);
+
+	/*
+	 * 0: Load the nlmsg_pid into the BPF register
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_W, offsetof(struct nlmsghdr, nlmsg_pid));
+	/*
+	 * 1 .. npids: Compare to each of our own pids; on a match go on to
+	 * the type check, if none matches jump to the end and keep it
+	 */
+	for (i = 0; i < npids; i++)
+		filter[n++] = (struct sock_filter)BPF_JUMP(
+			BPF_JMP | BPF_JEQ | BPF_K, htonl(pids[i]),
+			npids - 1 - i, i == npids - 1 ? 4 : 0);
+	/*
+	 * npids + 1: Load the nlmsg_type into BPF register
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_H, offsetof(struct nlmsghdr, nlmsg_type));
+	/*
+	 * npids + 2: Compare to RTM_NEWADDR
+	 */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 2, 0);
+	/*
+	 * npids + 3: Compare to RTM_DELADDR
+	 */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 1, 0);
+	/*
+	 * npids + 4: This is the end state of we want to skip the
+	 *    message
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+	/*
+	 * npids + 5: This is the end state of we want to keep
+	 *     the message
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffff);
 
 	struct sock_fprog prog = {
-		.len = array_size(filter), .filter = filter,
+		.len = n, .filter = filter,
 	};
 
 	if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))
@@ -1058,6 +1075,401 @@ int netlink_talk(int (*filter)(struct nlmsghdr *, ns_id_t, int startup),
 	return netlink_talk_info(filter, n, &dp_info, startup);
 }
 
+/*
+ * Batching of dataplane updates
+ *
+ * The messages for many updates are packed into one buffer and handed to
+ * the kernel with a single sendmsg().  They are sent without NLM_F_ACK,
+ * so the kernel only answers the ones that fail; rtnetlink processes the
+ * whole buffer before sendmsg() returns, so once the socket has been
+ * drained every message without an error has been applied.  Errors are
+ * matched back to their context by sequence number and message type.
+ *
+ * Each dplane pthread keeps its batch, and the buffers behind it, for its
+ * whole lifetime; they are only reallocated if the configured size
+ * changes, and freed when the pthread exits.
+ */
+static pthread_key_t nl_batch_key;
+
+static void nl_batch_free(void *arg)
+{
+	struct nl_batch *bth = arg;
+
+	XFREE(MTYPE_NL_BUF, bth->buf);
+	XFREE(MTYPE_NL_BUF, bth->msgs);
+	XFREE(MTYPE_NL_BUF, bth);
+}
+
+static void nl_batch_key_init(void) __attribute__((_CONSTRUCTOR(500)));
+static void nl_batch_key_init(void)
+{
+	pthread_key_create(&nl_batch_key, nl_batch_free);
+}
+
+static void nl_batch_key_fini(void) __attribute__((_DESTRUCTOR(500)));
+static void nl_batch_key_fini(void)
+{
+	pthread_key_delete(nl_batch_key);
+}
+
+struct nl_batch *nl_batch_init(void)
+{
+	struct nl_batch *bth = pthread_getspecific(nl_batch_key);
+	size_t bufsiz;
+
+	if (!bth) {
+		bth = XCALLOC(MTYPE_NL_BUF, sizeof(*bth));
+		pthread_setspecific(nl_batch_key, bth);
+	}
+
+	bufsiz = atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
+	bth->threshold = atomic_load_explicit(&nl_batch_send_threshold,
+					      memory_order_relaxed);
+
+	if (bth->bufsiz != bufsiz) {
+		XFREE(MTYPE_NL_BUF, bth->buf);
+		XFREE(MTYPE_NL_BUF, bth->msgs);
+
+		bth->bufsiz = bufsiz;
+		bth->buf = XMALLOC(MTYPE_NL_BUF, bth->bufsiz);
+
+		/* Enough for a buffer full of the smallest messages we send */
+		bth->msgmax =
+			bth->bufsiz / NLMSG_LENGTH(sizeof(struct rtmsg)) + 1;
+		bth->msgs = XCALLOC(MTYPE_NL_BUF,
+				    bth->msgmax * sizeof(*bth->msgs));
+	}
+
+	bth->curlen = 0;
+	bth->msgcnt = 0;
+	bth->dp_info = NULL;
+
+	return bth;
+}
+
+void nl_batch_fini(struct nl_batch *bth)
+{
+	nl_batch_flush(bth);
+}
+
+/* Find the message an error from the kernel refers to */
+static struct nl_batch_msg *nl_batch_msg_lookup(struct nl_batch *bth,
+						uint32_t *cursor,
+						uint32_t seq, uint16_t type)
+{
+	uint32_t i;
+
+	/* Errors come back in the order the messages were sent */
+	for (i = *cursor; i < bth->msgcnt; i++) {
+		if (bth->msgs[i].seq == seq && bth->msgs[i].type == type) {
+			*cursor = i + 1;
+			return &bth->msgs[i];
+		}
+	}
+
+	for (i = 0; i < *cursor && i < bth->msgcnt; i++) {
+		if (bth->msgs[i].seq == seq && bth->msgs[i].type == type)
+			return &bth->msgs[i];
+	}
+
+	return NULL;
+}
+
+static void nl_batch_error(struct nl_batch *bth, struct nl_batch_msg *bmsg,
+			   const struct nlmsgerr *err)
+{
+	const struct nlsock *nl = &bth->dp_info->nls;
+	int errnum = err->error;
+	int msg_type = err->msg.nlmsg_type;
+
+	/*
+	 * Same as netlink_parse_info() for the dataplane socket (is_cmd):
+	 * errors that occur because of races in link handling don't fail
+	 * the update.
+	 */
+	if ((msg_type == RTM_DELROUTE
+	     && (-errnum == ENODEV || -errnum == ESRCH))
+	    || (msg_type == RTM_NEWROUTE
+		&& (-errnum == ENETDOWN || -errnum == EEXIST))) {
+		if (IS_ZEBRA_DEBUG_KERNEL)
+			zlog_debug("%s: error: %s type=%s(%u), seq=%u, pid=%u",
+				   nl->name, safe_strerror(-errnum),
+				   nl_msg_type_to_str(msg_type), msg_type,
+				   err->msg.nlmsg_seq, err->msg.nlmsg_pid);
+		return;
+	}
+
+	/* These are known to happen, don't log them as errors */
+	if (msg_type == RTM_DELNEIGH
+	    || (msg_type == RTM_NEWROUTE
+		&& (-errnum == ESRCH || -errnum == ENETUNREACH))) {
+		if (IS_ZEBRA_DEBUG_KERNEL)
+			zlog_debug("%s error: %s, type=%s(%u), seq=%u, pid=%u",
+				   nl->name, safe_strerror(-errnum),
+				   nl_msg_type_to_str(msg_type), msg_type,
+				   err->msg.nlmsg_seq, err->msg.nlmsg_pid);
+	} else {
+		flog_err(EC_ZEBRA_UNEXPECTED_MESSAGE,
+			 "%s error: %s, type=%s(%u), seq=%u, pid=%u",
+			 nl->name, safe_strerror(-errnum),
+			 nl_msg_type_to_str(msg_type), msg_type,
+			 err->msg.nlmsg_seq, err->msg.nlmsg_pid);
+	}
+
+	if (!bmsg) {
+		if (IS_ZEBRA_DEBUG_KERNEL)
+			zlog_debug("%s: no batched message for seq %u",
+				   nl->name, err->msg.nlmsg_seq);
+		return;
+	}
+
+	/* Only the last message for an update decides its outcome */
+	if (bmsg->result)
+		dplane_ctx_set_status(bmsg->ctx,
+				      ZEBRA_DPLANE_REQUEST_FAILURE);
+}
+
+/* Read back the kernel's answers to the messages just sent */
+static void nl_batch_read_resp(struct nl_batch *bth)
+{
+	const struct nlsock *nl = &bth->dp_info->nls;
+	uint32_t cursor = 0, i;
+	int status;
+
+	while (1) {
+		char buf[NL_RCV_PKT_BUF_SIZE];
+		struct iovec iov = {.iov_base = buf, .iov_len = sizeof(buf)};
+		struct sockaddr_nl snl;
+		struct msghdr msg = {.msg_name = (void *)&snl,
+				     .msg_namelen = sizeof(snl),
+				     .msg_iov = &iov,
+				     .msg_iovlen = 1};
+		struct nlmsghdr *h;
+		struct nlmsgerr *err;
+
+		status = recvmsg(nl->sock, &msg, 0);
+		if (status < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EWOULDBLOCK || errno == EAGAIN)
+				return;
+
+			/* Some answers were lost: we can't tell which
+			 * updates went through, so report them all failed.
+			 */
+			flog_err(EC_ZEBRA_RECVMSG_OVERRUN,
+				 "%s recvmsg overrun: %s", nl->name,
+				 safe_strerror(errno));
+
+			for (i = 0; i < bth->msgcnt; i++)
+				if (bth->msgs[i].result)
+					dplane_ctx_set_status(
+						bth->msgs[i].ctx,
+						ZEBRA_DPLANE_REQUEST_FAILURE);
+			return;
+		}
+
+		if (status == 0) {
+			flog_err_sys(EC_LIB_SOCKET, "%s EOF", nl->name);
+			return;
+		}
+
+		if (IS_ZEBRA_DEBUG_KERNEL_MSGDUMP_RECV) {
+			zlog_debug("%s: << netlink message dump [recv]",
+				   __func__);
+			zlog_hexdump(buf, status);
+		}
+
+		for (h = (struct nlmsghdr *)buf;
+		     (status >= 0 && NLMSG_OK(h, (unsigned int)status));
+		     h = NLMSG_NEXT(h, status)) {
+			if (h->nlmsg_type != NLMSG_ERROR) {
+				if (IS_ZEBRA_DEBUG_KERNEL)
+					zlog_debug("%s: %s unexpected type %s(%u)",
+						   __func__, nl->name,
+						   nl_msg_type_to_str(
+							   h->nlmsg_type),
+						   h->nlmsg_type);
+				continue;
+			}
+
+			if (h->nlmsg_len
+			    < NLMSG_LENGTH(sizeof(struct nlmsgerr))) {
+				flog_err(EC_ZEBRA_NETLINK_LENGTH_ERROR,
+					 "%s error: message truncated",
+					 nl->name);
+				continue;
+			}
+
+			err = (struct nlmsgerr *)NLMSG_DATA(h);
+
+			if (h->nlmsg_flags & NLM_F_ACK_TLVS)
+				netlink_parse_extended_ack(h);
+
+			if (err->error == 0)
+				continue;
+
+			nl_batch_error(bth,
+				       nl_batch_msg_lookup(bth, &cursor,
+							   err->msg.nlmsg_seq,
+							   err->msg.nlmsg_type),
+				       err);
+		}
+	}
+}
+
+/* Send everything queued on the batch */
+void nl_batch_flush(struct nl_batch *bth)
+{
+	struct sockaddr_nl snl = {.nl_family = AF_NETLINK};
+	struct iovec iov = {.iov_base = bth->buf, .iov_len = bth->curlen};
+	struct msghdr msg = {.msg_name = (void *)&snl,
+			     .msg_namelen = sizeof(snl),
+			     .msg_iov = &iov,
+			     .msg_iovlen = 1};
+	const struct nlsock *nl;
+	int status = 0, save_errno = 0;
+	uint32_t i;
+
+	if (bth->curlen == 0)
+		return;
+
+	nl = &bth->dp_info->nls;
+
+	if (IS_ZEBRA_DEBUG_KERNEL)
+		zlog_debug("%s: %s sending %u messages, len=%zu", __func__,
+			   nl->name, bth->msgcnt, bth->curlen);
+
+	frr_with_privs(&zserv_privs) {
+		status = sendmsg(nl->sock, &msg, 0);
+		save_errno = errno;
+	}
+
+	if (IS_ZEBRA_DEBUG_KERNEL_MSGDUMP_SEND) {
+		zlog_debug("%s: >> netlink message dump [sent]", __func__);
+		zlog_hexdump(bth->buf, bth->curlen);
+	}
+
+	if (status < 0) {
+		flog_err_sys(EC_LIB_SOCKET, "%s sendmsg() error: %s",
+			     nl->name, safe_strerror(save_errno));
+
+		for (i = 0; i < bth->msgcnt; i++)
+			if (bth->msgs[i].result)
+				dplane_ctx_set_status(
+					bth->msgs[i].ctx,
+					ZEBRA_DPLANE_REQUEST_FAILURE);
+	} else
+		nl_batch_read_resp(bth);
+
+	bth->curlen = 0;
+	bth->msgcnt = 0;
+	bth->dp_info = NULL;
+}
+
+/*
+ * Queue a message for ctx onto the batch, using the context's netlink
+ * socket and the given sequence number.  result says whether the
+ * message's outcome is the outcome of the update.  The context's status
+ * is set to success here, and to failure if the kernel rejects the
+ * message.
+ */
+void nl_batch_add_msg(struct nl_batch *bth, struct zebra_dplane_ctx *ctx,
+		      struct nlmsghdr *n, uint32_t seq, bool result)
+{
+	const struct zebra_dplane_info *dp_info = dplane_ctx_get_ns(ctx);
+	struct nl_batch_msg *bmsg;
+	size_t len = NLMSG_ALIGN(n->nlmsg_len);
+
+	/* Updates for another namespace go out on another socket */
+	if (bth->dp_info && bth->dp_info->nls.sock != dp_info->nls.sock)
+		nl_batch_flush(bth);
+
+	if (bth->curlen + len > bth->bufsiz || bth->msgcnt == bth->msgmax)
+		nl_batch_flush(bth);
+
+	if (len > bth->bufsiz) {
+		flog_err(EC_ZEBRA_NETLINK_LENGTH_ERROR,
+			 "%s: message of %zu bytes does not fit in batch",
+			 __func__, len);
+		if (result)
+			dplane_ctx_set_status(ctx,
+					      ZEBRA_DPLANE_REQUEST_FAILURE);
+		return;
+	}
+
+	n->nlmsg_seq = seq;
+	n->nlmsg_pid = dp_info->nls.snl.nl_pid;
+
+	if (IS_ZEBRA_DEBUG_KERNEL)
+		zlog_debug("%s: %s type %s(%u), len=%d seq=%u flags 0x%x",
+			   __func__, dp_info->nls.name,
+			   nl_msg_type_to_str(n->nlmsg_type), n->nlmsg_type,
+			   n->nlmsg_len, n->nlmsg_seq, n->nlmsg_flags);
+
+	memcpy(bth->buf + bth->curlen, n, n->nlmsg_len);
+	memset(bth->buf + bth->curlen + n->nlmsg_len, 0,
+	       len - n->nlmsg_len);
+	bth->curlen += len;
+	bth->dp_info = dp_info;
+
+	bmsg = &bth->msgs[bth->msgcnt++];
+	bmsg->ctx = ctx;
+	bmsg->seq = seq;
+	bmsg->type = n->nlmsg_type;
+	bmsg->result = result;
+
+	if (result)
+		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
+
+	if (bth->curlen >= bth->threshold)
+		nl_batch_flush(bth);
+}
+
+bool netlink_batch_enabled(void)
+{
+	return atomic_load_explicit(&nl_batch_enabled, memory_order_relaxed);
+}
+
+void netlink_set_batching(bool enable)
+{
+	atomic_store_explicit(&nl_batch_enabled, enable, memory_order_relaxed);
+}
+
+/*
+ * Set the batch buffer size and send threshold; set == false restores
+ * the defaults.
+ */
+void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold,
+				   bool set)
+{
+	if (!set) {
+		size = NL_DEFAULT_BATCH_BUFSIZE;
+		threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
+	}
+
+	atomic_store_explicit(&nl_batch_bufsize, size, memory_order_relaxed);
+	atomic_store_explicit(&nl_batch_send_threshold, threshold,
+			      memory_order_relaxed);
+}
+
+void netlink_batch_config_write(struct vty *vty)
+{
+	uint32_t size, threshold;
+
+	if (!netlink_batch_enabled())
+		vty_out(vty, "no zebra kernel netlink batching\n");
+
+	size = atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
+	threshold = atomic_load_explicit(&nl_batch_send_threshold,
+					 memory_order_relaxed);
+
+	if (size != NL_DEFAULT_BATCH_BUFSIZE
+	    || threshold != NL_DEFAULT_BATCH_SEND_THRESHOLD)
+		vty_out(vty, "zebra kernel netlink batch-tx-buf %u %u\n", size,
+			threshold);
+}
+
 /* Issue request message to kernel via netlink socket. GET messages
  * are issued through this interface.
  */
@@ -1101,6 +1513,10 @@ int netlink_request(struct nlsock *nl, void *req)
 void kernel_init(struct zebra_ns *zns)
 {
 	uint32_t groups;
+	uint32_t i;
+	struct nlsock *nls;
+	__u32 pids[DPLANE_WORKERS_MAX + 2];
+	int npids = 0;
 #if defined SOL_NETLINK
 	int one, ret;
 #endif
@@ -1152,6 +1568,33 @@ void kernel_init(struct zebra_ns *zns)
 		exit(-1);
 	}
 
+	/* Each dplane worker pthread talks to the kernel on its own socket */
+	for (i = 0; i < zrouter.dplane_workers; i++) {
+		nls = &zns->netlink_dplane_workers[i];
+
+		snprintf(nls->name, sizeof(nls->name),
+			 "netlink-dp%u (NS %u)", i + 1, zns->ns_id);
+		nls->sock = -1;
+		if (netlink_socket(nls, 0, zns->ns_id) < 0) {
+			zlog_err("Failure to create %s socket", nls->name);
+			exit(-1);
+		}
+
+#if defined SOL_NETLINK
+		one = 1;
+		ret = setsockopt(nls->sock, SOL_NETLINK, NETLINK_EXT_ACK, &one,
+				 sizeof(one));
+
+		if (ret < 0)
+			zlog_notice("Registration for extended %s ACK failed : %d %s",
+				    nls->name, errno, safe_strerror(errno));
+#endif
+
+		if (fcntl(nls->sock, F_SETFL, O_NONBLOCK) < 0)
+			zlog_err("Can't set %s socket error: %s(%d)",
+				 nls->name, safe_strerror(errno), errno);
+	}
+
 	/*
 	 * SOL_NETLINK is not available on all platforms yet
 	 * apparently.  It's in bits/socket.h which I am not
@@ -1196,9 +1639,15 @@ void kernel_init(struct zebra_ns *zns)
 	if (nl_rcvbufsize)
 		netlink_recvbuf(&zns->netlink, nl_rcvbufsize);
 
-	netlink_install_filter(zns->netlink.sock,
-			       zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane.snl.nl_pid);
+	/* Our own changes, including those made by the dplane workers, are
+	 * filtered out of the listen socket.
+	 */
+	pids[npids++] = zns->netlink_cmd.snl.nl_pid;
+	pids[npids++] = zns->netlink_dplane.snl.nl_pid;
+	for (i = 0; i < zrouter.dplane_workers; i++)
+		pids[npids++] = zns->netlink_dplane_workers[i].snl.nl_pid;
+
+	netlink_install_filter(zns->netlink.sock, pids, npids);
 
 	zns->t_netlink = NULL;
 
@@ -1210,6 +1659,8 @@ void kernel_init(struct zebra_ns *zns)
 
 void kernel_terminate(struct zebra_ns *zns, bool complete)
 {
+	uint32_t i;
+
 	THREAD_READ_OFF(zns->t_netlink);
 
 	if (zns->netlink.sock >= 0) {
@@ -1230,6 +1681,13 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
 			close(zns->netlink_dplane.sock);
 			zns->netlink_dplane.sock = -1;
 		}
+
+		for (i = 0; i < zrouter.dplane_workers; i++) {
+			if (zns->netlink_dplane_workers[i].sock >= 0) {
+				close(zns->netlink_dplane_workers[i].sock);
+				zns->netlink_dplane_workers[i].sock = -1;
+			}
+		}
 	}
 }
 #endif /* HAVE_NETLINK */
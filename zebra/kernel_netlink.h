@@ -70,6 +70,47 @@ int netlink_talk_info(int (*filter)(struct nlmsghdr *, ns_id_t, int startup),
 
 extern int netlink_request(struct nlsock *nl, void *req);
 
+struct vty;
+
+/* A message queued on a batch */
+struct nl_batch_msg {
+	struct zebra_dplane_ctx *ctx;
+	uint32_t seq;
+	uint16_t type;
+	/* The kernel's answer to this message is the update's result */
+	bool result;
+};
+
+/* Dataplane updates waiting to be sent to the kernel together */
+struct nl_batch {
+	uint8_t *buf;
+	size_t bufsiz;
+	size_t curlen;
+	/* Send once this many bytes are queued */
+	size_t threshold;
+
+	/* Namespace and socket of the queued messages */
+	const struct zebra_dplane_info *dp_info;
+
+	struct nl_batch_msg *msgs;
+	uint32_t msgcnt;
+	uint32_t msgmax;
+};
+
+/* Get the calling pthread's batch, empty and ready for messages */
+extern struct nl_batch *nl_batch_init(void);
+extern void nl_batch_fini(struct nl_batch *bth);
+extern void nl_batch_add_msg(struct nl_batch *bth,
+			     struct zebra_dplane_ctx *ctx, struct nlmsghdr *n,
+			     uint32_t seq, bool result);
+extern void nl_batch_flush(struct nl_batch *bth);
+
+extern bool netlink_batch_enabled(void);
+extern void netlink_set_batching(bool enable);
+extern void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold,
+					  bool set);
+extern void netlink_batch_config_write(struct vty *vty);
+
 #endif /* HAVE_NETLINK */
 
 #ifdef __cplusplus
@@ -83,6 +83,7 @@ uint32_t nl_rcvbufsize = 4194304;
 #endif /* HAVE_NETLINK */
 
 #define OPTION_V6_RR_SEMANTICS 2000
+#define OPTION_DPLANE_WORKERS 2001
 /* Command line options. */
 const struct option longopts[] = {
 	{"batch", no_argument, NULL, 'b'},
@@ -97,6 +98,7 @@ const struct option longopts[] = {
 	{"vrfwnetns", no_argument, NULL, 'n'},
 	{"nl-bufsize", required_argument, NULL, 's'},
 	{"v6-rr-semantics", no_argument, NULL, OPTION_V6_RR_SEMANTICS},
+	{"dplane-workers", required_argument, NULL, OPTION_DPLANE_WORKERS},
 #endif /* HAVE_NETLINK */
 	{0}};
 
@@ -307,6 +309,7 @@ int main(int argc, char **argv)
 		"  -n, --vrfwnetns          Use NetNS as VRF backend\n"
 		"  -s, --nl-bufsize         Set netlink receive buffer size\n"
 		"      --v6-rr-semantics    Use v6 RR semantics\n"
+		"      --dplane-workers     Number of pthreads programming routes into the kernel\n"
 #endif /* HAVE_NETLINK */
 #if defined(HANDLE_ZAPI_FUZZING)
 		"  -c <file>                Bypass normal startup and use this file for testing of zapi\n"
@@ -374,6 +377,18 @@ int main(int argc, char **argv)
 		case OPTION_V6_RR_SEMANTICS:
 			v6_rr_semantics = true;
 			break;
+		case OPTION_DPLANE_WORKERS: {
+			unsigned long workers = strtoul(optarg, NULL, 10);
+
+			if (workers > DPLANE_WORKERS_MAX) {
+				fprintf(stderr,
+					"Number of dplane workers must be at most %u\n",
+					DPLANE_WORKERS_MAX);
+				exit(1);
+			}
+			zrouter.dplane_workers = workers;
+			break;
+		}
 #endif /* HAVE_NETLINK */
 #if defined(HANDLE_ZAPI_FUZZING)
 		case 'c':
@@ -51,6 +51,13 @@ extern enum zebra_dplane_result kernel_route_update(
 extern enum zebra_dplane_result
 kernel_nexthop_update(struct zebra_dplane_ctx *ctx);
 
+/*
+ * Program a list of route and nexthop updates, in order, setting the
+ * status of each context. Where the platform allows, the updates are
+ * sent to the kernel as a batch.
+ */
+extern void kernel_update_multi(struct dplane_ctx_q *ctx_list);
+
 extern enum zebra_dplane_result kernel_lsp_update(
 	struct zebra_dplane_ctx *ctx);
 
@@ -1944,24 +1944,29 @@ static void _netlink_nexthop_build_group(struct nlmsghdr *n, size_t req_size,
 }
 
 /**
- * netlink_nexthop() - Nexthop change via the netlink interface
+ * netlink_nexthop_msg_encode() - Encode a nexthop change netlink message
  *
+ * @cmd:	RTM_NEWNEXTHOP or RTM_DELNEXTHOP
  * @ctx:	Dataplane ctx
+ * @buf:	Buffer to build the message in
+ * @buflen:	Size of buf
  *
- * Return:	Result status
+ * Return:	Length of the message, 0 if there is nothing to send, or -1
  */
-static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
+static ssize_t netlink_nexthop_msg_encode(int cmd,
+					  const struct zebra_dplane_ctx *ctx,
+					  void *buf, size_t buflen)
 {
 	struct {
 		struct nlmsghdr n;
 		struct nhmsg nhm;
-		char buf[NL_PKT_BUF_SIZE];
-	} req;
+		char buf[];
+	} *req = buf;
 
 	mpls_lse_t out_lse[MPLS_MAX_LABELS];
 	char label_buf[256];
 	int num_labels = 0;
-	size_t req_size = sizeof(req);
+	size_t req_size = buflen;
 
 	/* Nothing to do if the kernel doesn't support nexthop objects */
 	if (!kernel_nexthops_supported())
@@ -1969,18 +1974,18 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 
 	label_buf[0] = '\0';
 
-	memset(&req, 0, req_size);
+	memset(req, 0, sizeof(*req));
 
-	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct nhmsg));
-	req.n.nlmsg_flags = NLM_F_CREATE | NLM_F_REQUEST;
+	req->n.nlmsg_len = NLMSG_LENGTH(sizeof(struct nhmsg));
+	req->n.nlmsg_flags = NLM_F_CREATE | NLM_F_REQUEST;
 
 	if (cmd == RTM_NEWNEXTHOP)
-		req.n.nlmsg_flags |= NLM_F_REPLACE;
+		req->n.nlmsg_flags |= NLM_F_REPLACE;
 
-	req.n.nlmsg_type = cmd;
-	req.n.nlmsg_pid = dplane_ctx_get_ns(ctx)->nls.snl.nl_pid;
+	req->n.nlmsg_type = cmd;
+	req->n.nlmsg_pid = dplane_ctx_get_ns(ctx)->nls.snl.nl_pid;
 
-	req.nhm.nh_family = AF_UNSPEC;
+	req->nhm.nh_family = AF_UNSPEC;
 	/* TODO: Scope? */
 
 	uint32_t id = dplane_ctx_get_nhe_id(ctx);
@@ -1992,7 +1997,7 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 		return -1;
 	}
 
-	addattr32(&req.n, req_size, NHA_ID, id);
+	addattr32(&req->n, req_size, NHA_ID, id);
 
 	if (cmd == RTM_NEWNEXTHOP) {
 		/*
@@ -2003,7 +2008,7 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 		 */
 		if (dplane_ctx_get_nhe_nh_grp_count(ctx))
 			_netlink_nexthop_build_group(
-				&req.n, req_size, id,
+				&req->n, req_size, id,
 				dplane_ctx_get_nhe_nh_grp(ctx),
 				dplane_ctx_get_nhe_nh_grp_count(ctx));
 		else {
@@ -2012,23 +2017,23 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 			afi_t afi = dplane_ctx_get_nhe_afi(ctx);
 
 			if (afi == AFI_IP)
-				req.nhm.nh_family = AF_INET;
+				req->nhm.nh_family = AF_INET;
 			else if (afi == AFI_IP6)
-				req.nhm.nh_family = AF_INET6;
+				req->nhm.nh_family = AF_INET6;
 
 			switch (nh->type) {
 			case NEXTHOP_TYPE_IPV4:
 			case NEXTHOP_TYPE_IPV4_IFINDEX:
-				addattr_l(&req.n, req_size, NHA_GATEWAY,
+				addattr_l(&req->n, req_size, NHA_GATEWAY,
 					  &nh->gate.ipv4, IPV4_MAX_BYTELEN);
 				break;
 			case NEXTHOP_TYPE_IPV6:
 			case NEXTHOP_TYPE_IPV6_IFINDEX:
-				addattr_l(&req.n, req_size, NHA_GATEWAY,
+				addattr_l(&req->n, req_size, NHA_GATEWAY,
 					  &nh->gate.ipv6, IPV6_MAX_BYTELEN);
 				break;
 			case NEXTHOP_TYPE_BLACKHOLE:
-				addattr_l(&req.n, req_size, NHA_BLACKHOLE, NULL,
+				addattr_l(&req->n, req_size, NHA_BLACKHOLE, NULL,
 					  0);
 				/* Blackhole shouldn't have anymore attributes
 				 */
@@ -2045,10 +2050,10 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 				return -1;
 			}
 
-			addattr32(&req.n, req_size, NHA_OIF, nh->ifindex);
+			addattr32(&req->n, req_size, NHA_OIF, nh->ifindex);
 
 			if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_ONLINK))
-				req.nhm.nh_flags |= RTNH_F_ONLINK;
+				req->nhm.nh_flags |= RTNH_F_ONLINK;
 
 			num_labels =
 				build_label_stack(nh->nh_label, out_lse,
@@ -2062,10 +2067,10 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 				/*
 				 * TODO: MPLS unsupported for now in kernel.
 				 */
-				if (req.nhm.nh_family == AF_MPLS)
+				if (req->nhm.nh_family == AF_MPLS)
 					goto nexthop_done;
 #if 0
-					addattr_l(&req.n, req_size, NHA_NEWDST,
+					addattr_l(&req->n, req_size, NHA_NEWDST,
 						  &out_lse,
 						  num_labels
 							  * sizeof(mpls_lse_t));
@@ -2074,16 +2079,16 @@ static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
 					struct rtattr *nest;
 					uint16_t encap = LWTUNNEL_ENCAP_MPLS;
 
-					addattr_l(&req.n, req_size,
+					addattr_l(&req->n, req_size,
 						  NHA_ENCAP_TYPE, &encap,
 						  sizeof(uint16_t));
-					nest = addattr_nest(&req.n, req_size,
+					nest = addattr_nest(&req->n, req_size,
 							    NHA_ENCAP);
-					addattr_l(&req.n, req_size,
+					addattr_l(&req->n, req_size,
 						  MPLS_IPTUNNEL_DST, &out_lse,
 						  num_labels
 							  * sizeof(mpls_lse_t));
-					addattr_nest_end(&req.n, nest);
+					addattr_nest_end(&req->n, nest);
 				}
 			}
 
@@ -2096,7 +2101,7 @@ nexthop_done:
 					   nh->vrf_id, label_buf);
 		}
 
-		req.nhm.nh_protocol = zebra2proto(dplane_ctx_get_nhe_type(ctx));
+		req->nhm.nh_protocol = zebra2proto(dplane_ctx_get_nhe_type(ctx));
 
 	} else if (cmd != RTM_DELNEXTHOP) {
 		flog_err(
@@ -2110,7 +2115,27 @@ nexthop_done:
 		zlog_debug("%s: %s, id=%u", __func__, nl_msg_type_to_str(cmd),
 			   id);
 
-	return netlink_talk_info(netlink_talk_filter, &req.n,
+	return req->n.nlmsg_len;
+}
+
+/**
+ * netlink_nexthop() - Nexthop change via the netlink interface
+ *
+ * @ctx:	Dataplane ctx
+ *
+ * Return:	Result status
+ */
+static int netlink_nexthop(int cmd, struct zebra_dplane_ctx *ctx)
+{
+	uint8_t nl_pkt[NL_PKT_BUF_SIZE];
+	ssize_t len;
+
+	len = netlink_nexthop_msg_encode(cmd, ctx, nl_pkt, sizeof(nl_pkt));
+	if (len <= 0)
+		return len;
+
+	return netlink_talk_info(netlink_talk_filter,
+				 (struct nlmsghdr *)nl_pkt,
 				 dplane_ctx_get_ns(ctx), 0);
 }
 
@@ -2237,6 +2262,176 @@ enum zebra_dplane_result kernel_route_update(struct zebra_dplane_ctx *ctx)
 		ZEBRA_DPLANE_REQUEST_SUCCESS : ZEBRA_DPLANE_REQUEST_FAILURE);
 }
 
+/*
+ * Queue the netlink messages for a route update onto a batch; the
+ * equivalent of kernel_route_update(). An update may need a delete
+ * first, which goes out with the context's first sequence number; the
+ * message that decides the outcome uses the second one.
+ */
+static void netlink_batch_route_update(struct nl_batch *bth,
+				       struct zebra_dplane_ctx *ctx)
+{
+	const struct prefix *p = dplane_ctx_get_dest(ctx);
+	uint32_t seq = dplane_ctx_get_ns(ctx)->nls.seq;
+	uint8_t nl_pkt[NL_PKT_BUF_SIZE];
+	bool is_update = false;
+	int cmd;
+
+	if (dplane_ctx_get_op(ctx) == DPLANE_OP_ROUTE_DELETE) {
+		cmd = RTM_DELROUTE;
+	} else if (dplane_ctx_get_op(ctx) == DPLANE_OP_ROUTE_INSTALL) {
+		cmd = RTM_NEWROUTE;
+	} else if (dplane_ctx_get_op(ctx) == DPLANE_OP_ROUTE_UPDATE) {
+		cmd = RTM_NEWROUTE;
+		is_update = true;
+
+		/* See kernel_route_update() */
+		if (((p->family == AF_INET || v6_rr_semantics)
+		     && RSYSTEM_ROUTE(dplane_ctx_get_type(ctx))
+		     && !RSYSTEM_ROUTE(dplane_ctx_get_old_type(ctx)))
+		    || (p->family != AF_INET && !v6_rr_semantics
+			&& !RSYSTEM_ROUTE(dplane_ctx_get_old_type(ctx)))) {
+			netlink_route_multipath(RTM_DELROUTE, ctx, nl_pkt,
+						sizeof(nl_pkt), false);
+			nl_batch_add_msg(bth, ctx, (struct nlmsghdr *)nl_pkt,
+					 seq, false);
+		}
+	} else {
+		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_FAILURE);
+		return;
+	}
+
+	if (RSYSTEM_ROUTE(dplane_ctx_get_type(ctx))) {
+		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
+		return;
+	}
+
+	netlink_route_multipath(cmd, ctx, nl_pkt, sizeof(nl_pkt), false);
+	nl_batch_add_msg(bth, ctx, (struct nlmsghdr *)nl_pkt,
+			 is_update ? seq + 1 : seq, true);
+}
+
+/*
+ * Queue the netlink message for a nexthop update onto a batch; the
+ * equivalent of kernel_nexthop_update().
+ */
+static void netlink_batch_nexthop_update(struct nl_batch *bth,
+					 struct zebra_dplane_ctx *ctx)
+{
+	uint8_t nl_pkt[NL_PKT_BUF_SIZE];
+	enum dplane_op_e op;
+	ssize_t len;
+	int cmd;
+
+	op = dplane_ctx_get_op(ctx);
+	if (op == DPLANE_OP_NH_INSTALL || op == DPLANE_OP_NH_UPDATE)
+		cmd = RTM_NEWNEXTHOP;
+	else if (op == DPLANE_OP_NH_DELETE)
+		cmd = RTM_DELNEXTHOP;
+	else {
+		flog_err(EC_ZEBRA_NHG_FIB_UPDATE,
+			 "Context received for kernel nexthop update with incorrect OP code (%u)",
+			 op);
+		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_FAILURE);
+		return;
+	}
+
+	len = netlink_nexthop_msg_encode(cmd, ctx, nl_pkt, sizeof(nl_pkt));
+	if (len <= 0) {
+		dplane_ctx_set_status(ctx,
+				      len == 0 ? ZEBRA_DPLANE_REQUEST_SUCCESS
+					       : ZEBRA_DPLANE_REQUEST_FAILURE);
+		return;
+	}
+
+	nl_batch_add_msg(bth, ctx, (struct nlmsghdr *)nl_pkt,
+			 dplane_ctx_get_ns(ctx)->nls.seq, true);
+}
+
+/*
+ * Program a list of route and nexthop updates, in order. Unless batching
+ * has been turned off, the netlink messages for all of them are sent
+ * together rather than one sendmsg() and reply per update.
+ */
+void kernel_update_multi(struct dplane_ctx_q *ctx_list)
+{
+	struct dplane_ctx_q handled_list;
+	struct zebra_dplane_ctx *ctx;
+	struct nexthop *nexthop;
+	struct nl_batch *bth = NULL;
+	enum dplane_op_e op;
+	bool batch;
+
+	TAILQ_INIT(&handled_list);
+
+	batch = netlink_batch_enabled();
+	if (batch)
+		bth = nl_batch_init();
+
+	while ((ctx = dplane_ctx_dequeue(ctx_list)) != NULL) {
+		switch (dplane_ctx_get_op(ctx)) {
+		case DPLANE_OP_ROUTE_INSTALL:
+		case DPLANE_OP_ROUTE_UPDATE:
+		case DPLANE_OP_ROUTE_DELETE:
+			if (batch)
+				netlink_batch_route_update(bth, ctx);
+			else
+				dplane_ctx_set_status(
+					ctx, kernel_route_update(ctx));
+			break;
+
+		case DPLANE_OP_NH_INSTALL:
+		case DPLANE_OP_NH_UPDATE:
+		case DPLANE_OP_NH_DELETE:
+			if (batch)
+				netlink_batch_nexthop_update(bth, ctx);
+			else
+				dplane_ctx_set_status(
+					ctx, kernel_nexthop_update(ctx));
+			break;
+
+		default:
+			dplane_ctx_set_status(ctx,
+					      ZEBRA_DPLANE_REQUEST_FAILURE);
+			break;
+		}
+
+		dplane_ctx_enqueue_tail(&handled_list, ctx);
+	}
+
+	if (!batch) {
+		dplane_ctx_list_append(ctx_list, &handled_list);
+		return;
+	}
+
+	nl_batch_fini(bth);
+
+	/* Now that the kernel has answered, mark the installed nexthops
+	 * as kernel_route_update() does.
+	 */
+	while ((ctx = dplane_ctx_dequeue(&handled_list)) != NULL) {
+		op = dplane_ctx_get_op(ctx);
+		if ((op == DPLANE_OP_ROUTE_INSTALL
+		     || op == DPLANE_OP_ROUTE_UPDATE)
+		    && dplane_ctx_get_status(ctx)
+			       == ZEBRA_DPLANE_REQUEST_SUCCESS) {
+			for (ALL_NEXTHOPS_PTR(dplane_ctx_get_ng(ctx),
+					      nexthop)) {
+				if (CHECK_FLAG(nexthop->flags,
+					       NEXTHOP_FLAG_RECURSIVE))
+					continue;
+
+				if (CHECK_FLAG(nexthop->flags,
+					       NEXTHOP_FLAG_ACTIVE))
+					SET_FLAG(nexthop->flags,
+						 NEXTHOP_FLAG_FIB);
+			}
+		}
+
+		dplane_ctx_enqueue_tail(ctx_list, ctx);
+	}
+}
+
 /**
  * netlink_nexthop_process_nh() - Parse the gatway/if info from a new nexthop
  *
@@ -370,6 +370,39 @@ enum zebra_dplane_result kernel_nexthop_update(struct zebra_dplane_ctx *ctx)
 	return ZEBRA_DPLANE_REQUEST_SUCCESS;
 }
 
+/* No batching on routing sockets, just one update after the other */
+void kernel_update_multi(struct dplane_ctx_q *ctx_list)
+{
+	struct dplane_ctx_q handled_list;
+	struct zebra_dplane_ctx *ctx;
+	enum zebra_dplane_result res;
+
+	TAILQ_INIT(&handled_list);
+
+	while ((ctx = dplane_ctx_dequeue(ctx_list)) != NULL) {
+		switch (dplane_ctx_get_op(ctx)) {
+		case DPLANE_OP_ROUTE_INSTALL:
+		case DPLANE_OP_ROUTE_UPDATE:
+		case DPLANE_OP_ROUTE_DELETE:
+			res = kernel_route_update(ctx);
+			break;
+		case DPLANE_OP_NH_INSTALL:
+		case DPLANE_OP_NH_UPDATE:
+		case DPLANE_OP_NH_DELETE:
+			res = kernel_nexthop_update(ctx);
+			break;
+		default:
+			res = ZEBRA_DPLANE_REQUEST_FAILURE;
+			break;
+		}
+
+		dplane_ctx_set_status(ctx, res);
+		dplane_ctx_enqueue_tail(&handled_list, ctx);
+	}
+
+	dplane_ctx_list_append(ctx_list, &handled_list);
+}
+
 int kernel_neigh_update(int add, int ifindex, uint32_t addr, char *lla,
 			int llalen, ns_id_t ns_id)
 {
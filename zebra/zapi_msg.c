@@ -1538,74 +1538,24 @@ done:
 	return nexthop;
 }
 
-static void zread_route_add(ZAPI_HANDLER_ARGS)
+/*
+ * Converts the nexthops and backup nexthops of a zapi_route into a temporary
+ * nexthop group and backup info, for the caller to free.
+ */
+static bool zapi_read_nexthops(struct zserv *client, struct zapi_route *api,
+			       struct route_entry *re,
+			       struct nexthop_group **png,
+			       struct nhg_backup_info **pbnhg)
 {
-	struct stream *s;
-	struct zapi_route api;
 	struct zapi_nexthop *api_nh;
-	afi_t afi;
-	struct prefix_ipv6 *src_p = NULL;
-	struct route_entry *re;
 	struct nexthop *nexthop = NULL, *last_nh;
 	struct nexthop_group *ng = NULL;
 	struct nhg_backup_info *bnhg = NULL;
-	int i, ret;
-	vrf_id_t vrf_id;
-	struct nhg_hash_entry nhe;
+	int i;
 	enum lsp_types_t label_type;
 	char nhbuf[NEXTHOP_STRLEN];
 	char labelbuf[MPLS_LABEL_STRLEN];
 
-	s = msg;
-	if (zapi_route_decode(s, &api) < 0) {
-		if (IS_ZEBRA_DEBUG_RECV)
-			zlog_debug("%s: Unable to decode zapi_route sent",
-				   __func__);
-		return;
-	}
-
-	if (IS_ZEBRA_DEBUG_RECV) {
-		char buf_prefix[PREFIX_STRLEN];
-
-		prefix2str(&api.prefix, buf_prefix, sizeof(buf_prefix));
-		zlog_debug("%s: p=%s, msg flags=0x%x, flags=0x%x",
-			   __func__, buf_prefix, (int)api.message, api.flags);
-	}
-
-	/* Allocate new route. */
-	vrf_id = zvrf_id(zvrf);
-	re = XCALLOC(MTYPE_RE, sizeof(struct route_entry));
-	re->type = api.type;
-	re->instance = api.instance;
-	re->flags = api.flags;
-	re->uptime = monotime(NULL);
-	re->vrf_id = vrf_id;
-
-	if (api.tableid)
-		re->table = api.tableid;
-	else
-		re->table = zvrf->table_id;
-
-	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP)
-	    || api.nexthop_num == 0) {
-		flog_warn(EC_ZEBRA_RX_ROUTE_NO_NEXTHOPS,
-			  "%s: received a route without nexthops for prefix %pFX from client %s",
-			  __func__, &api.prefix,
-			  zebra_route_string(client->proto));
-
-		XFREE(MTYPE_RE, re);
-		return;
-	}
-
-	/* Report misuse of the backup flag */
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_BACKUP_NEXTHOPS) &&
-	    api.backup_nexthop_num == 0) {
-		if (IS_ZEBRA_DEBUG_RECV || IS_ZEBRA_DEBUG_EVENT)
-			zlog_debug("%s: client %s: BACKUP flag set but no backup nexthops, prefix %pFX",
-				__func__,
-				zebra_route_string(client->proto), &api.prefix);
-	}
-
 	/* Use temporary list of nexthops */
 	ng = nexthop_group_new();
 
@@ -1614,19 +1564,18 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	 * api_nh->vrf_id instead of re->vrf_id ? I only changed
 	 * for cases NEXTHOP_TYPE_IPV4 and NEXTHOP_TYPE_IPV6.
 	 */
-	for (i = 0; i < api.nexthop_num; i++) {
-		api_nh = &api.nexthops[i];
+	for (i = 0; i < api->nexthop_num; i++) {
+		api_nh = &api->nexthops[i];
 
 		/* Convert zapi nexthop */
-		nexthop = nexthop_from_zapi(re, api_nh, &api);
+		nexthop = nexthop_from_zapi(re, api_nh, api);
 		if (!nexthop) {
 			flog_warn(
 				EC_ZEBRA_NEXTHOP_CREATION_FAILED,
 				"%s: Nexthops Specified: %d but we failed to properly create one",
-				__func__, api.nexthop_num);
+				__func__, api->nexthop_num);
 			nexthop_group_delete(&ng);
-			XFREE(MTYPE_RE, re);
-			return;
+			return false;
 		}
 
 		/* MPLS labels for BGP-LU or Segment Routing */
@@ -1670,10 +1619,10 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	}
 
 	/* Allocate temporary list of backup nexthops, if necessary */
-	if (api.backup_nexthop_num > 0) {
+	if (api->backup_nexthop_num > 0) {
 		if (IS_ZEBRA_DEBUG_RECV)
 			zlog_debug("%s: adding %d backup nexthops",
-				   __func__, api.backup_nexthop_num);
+				   __func__, api->backup_nexthop_num);
 
 		bnhg = zebra_nhg_backup_alloc();
 		nexthop = NULL;
@@ -1681,20 +1630,19 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	}
 
 	/* Copy backup nexthops also, if present */
-	for (i = 0; i < api.backup_nexthop_num; i++) {
-		api_nh = &api.backup_nexthops[i];
+	for (i = 0; i < api->backup_nexthop_num; i++) {
+		api_nh = &api->backup_nexthops[i];
 
 		/* Convert zapi backup nexthop */
-		nexthop = nexthop_from_zapi(re, api_nh, &api);
+		nexthop = nexthop_from_zapi(re, api_nh, api);
 		if (!nexthop) {
 			flog_warn(
 				EC_ZEBRA_NEXTHOP_CREATION_FAILED,
 				"%s: Backup Nexthops Specified: %d but we failed to properly create one",
-				__func__, api.backup_nexthop_num);
+				__func__, api->backup_nexthop_num);
 			nexthop_group_delete(&ng);
 			zebra_nhg_backup_free(&bnhg);
-			XFREE(MTYPE_RE, re);
-			return;
+			return false;
 		}
 
 		/* Backup nexthops can't have backups; that's not valid. */
@@ -1750,14 +1698,96 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 		last_nh = nexthop;
 	}
 
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_DISTANCE))
-		re->distance = api.distance;
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_METRIC))
-		re->metric = api.metric;
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_TAG))
-		re->tag = api.tag;
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_MTU))
-		re->mtu = api.mtu;
+	*png = ng;
+	*pbnhg = bnhg;
+	return true;
+}
+
+/* Allocates a route entry for the route type and attributes of api. */
+static struct route_entry *zapi_route_entry_new(struct zebra_vrf *zvrf,
+						const struct zapi_route *api)
+{
+	struct route_entry *re;
+
+	re = XCALLOC(MTYPE_RE, sizeof(struct route_entry));
+	re->type = api->type;
+	re->instance = api->instance;
+	re->flags = api->flags;
+	re->uptime = monotime(NULL);
+	re->vrf_id = zvrf_id(zvrf);
+
+	if (api->tableid)
+		re->table = api->tableid;
+	else
+		re->table = zvrf->table_id;
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_DISTANCE))
+		re->distance = api->distance;
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_METRIC))
+		re->metric = api->metric;
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_TAG))
+		re->tag = api->tag;
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_MTU))
+		re->mtu = api->mtu;
+
+	return re;
+}
+
+static void zread_route_add(ZAPI_HANDLER_ARGS)
+{
+	struct stream *s;
+	struct zapi_route api;
+	afi_t afi;
+	struct prefix_ipv6 *src_p = NULL;
+	struct route_entry *re;
+	struct nexthop_group *ng = NULL;
+	struct nhg_backup_info *bnhg = NULL;
+	int ret;
+	struct nhg_hash_entry nhe;
+
+	s = msg;
+	if (zapi_route_decode(s, &api) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route sent",
+				   __func__);
+		return;
+	}
+
+	if (IS_ZEBRA_DEBUG_RECV) {
+		char buf_prefix[PREFIX_STRLEN];
+
+		prefix2str(&api.prefix, buf_prefix, sizeof(buf_prefix));
+		zlog_debug("%s: p=%s, msg flags=0x%x, flags=0x%x",
+			   __func__, buf_prefix, (int)api.message, api.flags);
+	}
+
+	/* Allocate new route. */
+	re = zapi_route_entry_new(zvrf, &api);
+
+	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP)
+	    || api.nexthop_num == 0) {
+		flog_warn(EC_ZEBRA_RX_ROUTE_NO_NEXTHOPS,
+			  "%s: received a route without nexthops for prefix %pFX from client %s",
+			  __func__, &api.prefix,
+			  zebra_route_string(client->proto));
+
+		XFREE(MTYPE_RE, re);
+		return;
+	}
+
+	/* Report misuse of the backup flag */
+	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_BACKUP_NEXTHOPS) &&
+	    api.backup_nexthop_num == 0) {
+		if (IS_ZEBRA_DEBUG_RECV || IS_ZEBRA_DEBUG_EVENT)
+			zlog_debug("%s: client %s: BACKUP flag set but no backup nexthops, prefix %pFX",
+				__func__,
+				zebra_route_string(client->proto), &api.prefix);
+	}
+
+	if (!zapi_read_nexthops(client, &api, re, &ng, &bnhg)) {
+		XFREE(MTYPE_RE, re);
+		return;
+	}
 
 	afi = family2afi(api.prefix.family);
 	if (afi != AFI_IP6 && CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX)) {
@@ -1859,6 +1889,150 @@ static void zread_route_del(ZAPI_HANDLER_ARGS)
 	}
 }
 
+/*
+ * Many routes sharing nexthops and attributes: the nexthops are converted
+ * once, and the nexthop group is only looked up for the first route of
+ * each address family, the others attach to the same group by its ID.
+ */
+static void zread_route_add_batch(ZAPI_HANDLER_ARGS)
+{
+	struct zapi_route api;
+	struct route_entry *re;
+	struct nexthop_group *ng = NULL;
+	struct nhg_backup_info *bnhg = NULL;
+	struct nhg_hash_entry nhe;
+	uint32_t nhe_id[AFI_MAX] = {0};
+	uint16_t count, i;
+	afi_t afi;
+	int ret;
+
+	if (zapi_route_batch_decode(msg, &api, &count) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route batch sent",
+				   __func__);
+		return;
+	}
+
+	if (IS_ZEBRA_DEBUG_RECV)
+		zlog_debug("%s: %u routes, msg flags=0x%x, flags=0x%x",
+			   __func__, count, (int)api.message, api.flags);
+
+	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP)
+	    || api.nexthop_num == 0) {
+		flog_warn(EC_ZEBRA_RX_ROUTE_NO_NEXTHOPS,
+			  "%s: received %u routes without nexthops from client %s",
+			  __func__, count, zebra_route_string(client->proto));
+		return;
+	}
+
+	if (api.safi != SAFI_UNICAST && api.safi != SAFI_MULTICAST) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: Received safi: %d but we can only accept UNICAST or MULTICAST",
+			  __func__, api.safi);
+		return;
+	}
+
+	/* EVPN nexthops are set up for the route's prefix, which isn't
+	 * known yet when the shared nexthops are read */
+	if (CHECK_FLAG(api.flags, ZEBRA_FLAG_EVPN_ROUTE)) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: Received EVPN routes from client %s, they can't be batched",
+			  __func__, zebra_route_string(client->proto));
+		return;
+	}
+
+	/* only used as a template for the nexthops' VRF */
+	re = zapi_route_entry_new(zvrf, &api);
+	if (!zapi_read_nexthops(client, &api, re, &ng, &bnhg)) {
+		XFREE(MTYPE_RE, re);
+		return;
+	}
+	XFREE(MTYPE_RE, re);
+
+	for (i = 0; i < count; i++) {
+		if (zapi_route_batch_decode_prefix(msg, &api) < 0)
+			break;
+
+		afi = family2afi(api.prefix.family);
+		re = zapi_route_entry_new(zvrf, &api);
+
+		zebra_nhe_init(&nhe, afi, ng->nexthop);
+		nhe.nhg.nexthop = ng->nexthop;
+		nhe.backup_info = bnhg;
+		nhe.id = nhe_id[afi];
+
+		ret = rib_add_multipath_nhe(afi, api.safi, &api.prefix, NULL,
+					    re, &nhe);
+		if (ret < 0) {
+			XFREE(MTYPE_RE, re);
+			nhe_id[afi] = 0;
+		} else
+			nhe_id[afi] = re->nhe_id;
+
+		/* Stats */
+		switch (api.prefix.family) {
+		case AF_INET:
+			if (ret > 0)
+				client->v4_route_add_cnt++;
+			else if (ret < 0)
+				client->v4_route_upd8_cnt++;
+			break;
+		case AF_INET6:
+			if (ret > 0)
+				client->v6_route_add_cnt++;
+			else if (ret < 0)
+				client->v6_route_upd8_cnt++;
+			break;
+		}
+	}
+
+	nexthop_group_delete(&ng);
+	if (bnhg)
+		zebra_nhg_backup_free(&bnhg);
+}
+
+static void zread_route_del_batch(ZAPI_HANDLER_ARGS)
+{
+	struct zapi_route api;
+	uint32_t table_id;
+	uint16_t count, i;
+
+	if (zapi_route_batch_decode(msg, &api, &count) < 0)
+		return;
+
+	if (api.safi != SAFI_UNICAST && api.safi != SAFI_MULTICAST) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: Received safi: %d but we can only accept UNICAST or MULTICAST",
+			  __func__, api.safi);
+		return;
+	}
+
+	if (api.tableid)
+		table_id = api.tableid;
+	else
+		table_id = zvrf->table_id;
+
+	for (i = 0; i < count; i++) {
+		if (zapi_route_batch_decode_prefix(msg, &api) < 0)
+			break;
+
+		rib_delete(family2afi(api.prefix.family), api.safi,
+			   zvrf_id(zvrf), api.type, api.instance, api.flags,
+			   &api.prefix, NULL, NULL, 0, table_id, api.metric,
+			   api.distance, false);
+
+		/* Stats */
+		switch (api.prefix.family) {
+		case AF_INET:
+			client->v4_route_del_cnt++;
+			break;
+		case AF_INET6:
+			client->v6_route_del_cnt++;
+			break;
+		}
+	}
+}
+
 /* MRIB Nexthop lookup for IPv4. */
 static void zread_ipv4_nexthop_lookup_mrib(ZAPI_HANDLER_ARGS)
 {
@@ -2872,7 +3046,9 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_MLAG_CLIENT_REGISTER] = zebra_mlag_client_register,
 	[ZEBRA_MLAG_CLIENT_UNREGISTER] = zebra_mlag_client_unregister,
 	[ZEBRA_MLAG_FORWARD_MSG] = zebra_mlag_forward_client_msg,
-	[ZEBRA_CLIENT_CAPABILITIES] = zread_client_capabilities
+	[ZEBRA_CLIENT_CAPABILITIES] = zread_client_capabilities,
+	[ZEBRA_ROUTE_ADD_BATCH] = zread_route_add_batch,
+	[ZEBRA_ROUTE_DELETE_BATCH] = zread_route_del_batch,
 };
 
 #if defined(HANDLE_ZAPI_FUZZING)
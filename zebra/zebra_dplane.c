@@ -25,6 +25,7 @@
 #include "lib/debug.h"
 #include "lib/frratomic.h"
 #include "lib/frr_pthread.h"
+#include "lib/jhash.h"
 #include "lib/memory.h"
 #include "lib/queue.h"
 #include "lib/zebra.h"
@@ -36,9 +37,8 @@
 #include "zebra/rt.h"
 #include "zebra/debug.h"
 
-/* Memory type for context blocks */
-DEFINE_MTYPE_STATIC(ZEBRA, DP_CTX, "Zebra DPlane Ctx")
 DEFINE_MTYPE_STATIC(ZEBRA, DP_PROV, "Zebra DPlane Provider")
+DEFINE_MTYPE_STATIC(ZEBRA, DP_BATCH, "Zebra DPlane worker batch")
 
 #ifndef AOK
 #  define AOK 0
@@ -53,6 +53,11 @@ const uint32_t DPLANE_DEFAULT_MAX_QUEUED = 200;
 /* Default value for new work per cycle */
 const uint32_t DPLANE_DEFAULT_NEW_WORK = 100;
 
+/* Below this many route updates in a row, the dplane pthread programs them
+ * itself rather than waking up the workers.
+ */
+#define DPLANE_WORKER_MIN_BATCH 8
+
 /* Validation check macro for context blocks */
 /* #define DPLANE_DEBUG 1 */
 
@@ -247,6 +252,10 @@ struct zebra_dplane_ctx {
 	TAILQ_ENTRY(zebra_dplane_ctx) zd_q_entries;
 };
 
+/* Memory type for context blocks */
+DEFINE_MTYPE_STATIC_SLAB(ZEBRA, DP_CTX, "Zebra DPlane Ctx",
+			 sizeof(struct zebra_dplane_ctx))
+
 /* Flag that can be set by a pre-kernel provider as a signal that an update
  * should bypass the kernel.
  */
@@ -301,6 +310,25 @@ struct zebra_dplane_provider {
 	TAILQ_ENTRY(zebra_dplane_provider) dp_prov_link;
 };
 
+/*
+ * Kernel route programming is shared between the dplane pthread (worker 0)
+ * and any additional worker pthreads configured at startup.  Each worker
+ * talks to the kernel on its own netlink socket.
+ */
+struct dplane_worker {
+	/* Worker index; the dplane pthread itself is 0 */
+	uint32_t dw_id;
+
+	/* Worker pthread, NULL for the dplane pthread */
+	struct frr_pthread *dw_pthread;
+
+	/* Counters */
+	_Atomic uint32_t dw_updates;
+	_Atomic uint32_t dw_batches;
+	_Atomic uint32_t dw_max_batch;
+	_Atomic uint64_t dw_usecs;
+};
+
 /*
  * Globals
  */
@@ -375,6 +403,26 @@ static struct zebra_dplane_globals {
 	/* Event pointer for pending shutdown check loop */
 	struct thread *dg_t_shutdown_check;
 
+	/* Kernel provider */
+	struct zebra_dplane_provider *dg_kernel_prov;
+
+	/* Number of worker pthreads, in addition to the dplane pthread */
+	uint32_t dg_nworkers;
+	struct dplane_worker dg_workers[DPLANE_WORKERS_MAX + 1];
+
+	/* Kernel provider work being shared out to the workers: each
+	 * worker handles the contexts in [start, end) whose shard is its id.
+	 */
+	struct zebra_dplane_ctx **dg_batch;
+	uint8_t *dg_batch_shard;
+	uint32_t dg_batch_start;
+	uint32_t dg_batch_end;
+
+	/* Number of workers still busy with the current batch */
+	pthread_mutex_t dg_worker_mutex;
+	pthread_cond_t dg_worker_cond;
+	uint32_t dg_workers_pending;
+
 } zdplane_info;
 
 /*
@@ -392,6 +440,7 @@ static struct zebra_dplane_globals {
 
 /* Prototypes */
 static int dplane_thread_loop(struct thread *event);
+static void dplane_workers_stop(void);
 static void dplane_info_from_zns(struct zebra_dplane_info *ns_info,
 				 struct zebra_ns *zns);
 static enum zebra_dplane_result lsp_update_internal(zebra_lsp_t *lsp,
@@ -2770,6 +2819,39 @@ neigh_update_internal(enum dplane_op_e op,
 	return result;
 }
 
+/*
+ * Per-worker counters for 'show dplane'
+ */
+static void dplane_show_workers(struct vty *vty)
+{
+	struct dplane_worker *w;
+	uint64_t updates, batches, max_batch, usecs;
+	uint32_t i;
+
+	vty_out(vty, "Kernel workers:           %u\n",
+		zdplane_info.dg_nworkers + 1);
+
+	for (i = 0; i <= zdplane_info.dg_nworkers; i++) {
+		w = &zdplane_info.dg_workers[i];
+
+		updates = atomic_load_explicit(&w->dw_updates,
+					       memory_order_relaxed);
+		batches = atomic_load_explicit(&w->dw_batches,
+					       memory_order_relaxed);
+		max_batch = atomic_load_explicit(&w->dw_max_batch,
+						 memory_order_relaxed);
+		usecs = atomic_load_explicit(&w->dw_usecs,
+					     memory_order_relaxed);
+
+		vty_out(vty,
+			"  Worker %u: updates %"PRIu64", batches %"PRIu64", "
+			"batch max %"PRIu64", busy %"PRIu64" ms, "
+			"%"PRIu64" updates/sec\n",
+			w->dw_id, updates, batches, max_batch, usecs / 1000,
+			usecs ? updates * 1000000 / usecs : 0);
+	}
+}
+
 /*
  * Handler for 'show dplane'
  */
@@ -2805,6 +2887,20 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 	vty_out(vty, "Route update queue max:   %"PRIu64"\n", queue_max);
 	vty_out(vty, "Dplane update yields:     %"PRIu64"\n", yields);
 
+	if (zdplane_info.dg_kernel_prov) {
+		queued = atomic_load_explicit(
+			&zdplane_info.dg_kernel_prov->dp_in_queued,
+			memory_order_relaxed);
+		queue_max = atomic_load_explicit(
+			&zdplane_info.dg_kernel_prov->dp_in_max,
+			memory_order_relaxed);
+		vty_out(vty, "Kernel queue depth:       %"PRIu64"\n", queued);
+		vty_out(vty, "Kernel queue max:         %"PRIu64"\n", queue_max);
+	}
+
+	if (zdplane_info.dg_nworkers)
+		dplane_show_workers(vty);
+
 	incoming = atomic_load_explicit(&zdplane_info.dg_lsps_in,
 					memory_order_relaxed);
 	errs = atomic_load_explicit(&zdplane_info.dg_lsp_errors,
@@ -3101,6 +3197,7 @@ static void dplane_info_from_zns(struct zebra_dplane_info *ns_info,
 #if defined(HAVE_NETLINK)
 	ns_info->is_cmd = true;
 	ns_info->nls = zns->netlink_dplane;
+	ns_info->nls_workers = zns->netlink_dplane_workers;
 #endif /* NETLINK */
 }
 
@@ -3329,99 +3426,367 @@ kernel_dplane_neigh_update(struct zebra_dplane_ctx *ctx)
 }
 
 /*
- * Kernel provider callback
+ * Program one context into the kernel and record the result
  */
-static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
+static void kernel_dplane_process_ctx(struct zebra_dplane_ctx *ctx)
 {
 	enum zebra_dplane_result res;
+
+	/* A previous provider plugin may have asked to skip the
+	 * kernel update.
+	 */
+	if (dplane_ctx_is_skip_kernel(ctx)) {
+		res = ZEBRA_DPLANE_REQUEST_SUCCESS;
+		goto skip_one;
+	}
+
+	/* Dispatch to appropriate kernel-facing apis */
+	switch (dplane_ctx_get_op(ctx)) {
+
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		res = kernel_dplane_route_update(ctx);
+		break;
+
+	case DPLANE_OP_NH_INSTALL:
+	case DPLANE_OP_NH_UPDATE:
+	case DPLANE_OP_NH_DELETE:
+		res = kernel_dplane_nexthop_update(ctx);
+		break;
+
+	case DPLANE_OP_LSP_INSTALL:
+	case DPLANE_OP_LSP_UPDATE:
+	case DPLANE_OP_LSP_DELETE:
+		res = kernel_dplane_lsp_update(ctx);
+		break;
+
+	case DPLANE_OP_PW_INSTALL:
+	case DPLANE_OP_PW_UNINSTALL:
+		res = kernel_dplane_pw_update(ctx);
+		break;
+
+	case DPLANE_OP_ADDR_INSTALL:
+	case DPLANE_OP_ADDR_UNINSTALL:
+		res = kernel_dplane_address_update(ctx);
+		break;
+
+	case DPLANE_OP_MAC_INSTALL:
+	case DPLANE_OP_MAC_DELETE:
+		res = kernel_dplane_mac_update(ctx);
+		break;
+
+	case DPLANE_OP_NEIGH_INSTALL:
+	case DPLANE_OP_NEIGH_UPDATE:
+	case DPLANE_OP_NEIGH_DELETE:
+	case DPLANE_OP_VTEP_ADD:
+	case DPLANE_OP_VTEP_DELETE:
+		res = kernel_dplane_neigh_update(ctx);
+		break;
+
+	/* Ignore 'notifications' - no-op */
+	case DPLANE_OP_SYS_ROUTE_ADD:
+	case DPLANE_OP_SYS_ROUTE_DELETE:
+	case DPLANE_OP_ROUTE_NOTIFY:
+	case DPLANE_OP_LSP_NOTIFY:
+		res = ZEBRA_DPLANE_REQUEST_SUCCESS;
+		break;
+
+	default:
+		atomic_fetch_add_explicit(
+			&zdplane_info.dg_other_errors, 1,
+			memory_order_relaxed);
+
+		res = ZEBRA_DPLANE_REQUEST_FAILURE;
+		break;
+	}
+
+skip_one:
+	dplane_ctx_set_status(ctx, res);
+}
+
+/*
+ * Route and nexthop updates can be sent to the kernel in batches with
+ * kernel_update_multi().
+ */
+static bool kernel_dplane_ctx_is_multi(const struct zebra_dplane_ctx *ctx)
+{
+	if (dplane_ctx_is_skip_kernel(ctx))
+		return false;
+
+	switch (ctx->zd_op) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+	case DPLANE_OP_NH_INSTALL:
+	case DPLANE_OP_NH_UPDATE:
+	case DPLANE_OP_NH_DELETE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Program a run of route and nexthop updates with kernel_update_multi().
+ * If prov is set, the contexts are handed on to the next provider
+ * afterwards, otherwise they are left on ctx_list.
+ */
+static void kernel_dplane_update_multi(struct dplane_ctx_q *ctx_list,
+				       struct zebra_dplane_provider *prov)
+{
+	struct dplane_ctx_q done_list;
 	struct zebra_dplane_ctx *ctx;
-	int counter, limit;
 
-	limit = dplane_provider_get_work_limit(prov);
+	TAILQ_INIT(&done_list);
 
-	if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
-		zlog_debug("dplane provider '%s': processing",
-			   dplane_provider_get_name(prov));
+	kernel_update_multi(ctx_list);
 
-	for (counter = 0; counter < limit; counter++) {
+	while ((ctx = dplane_ctx_dequeue(ctx_list)) != NULL) {
+		if (ctx->zd_status != ZEBRA_DPLANE_REQUEST_SUCCESS) {
+			if (ctx->zd_op == DPLANE_OP_NH_INSTALL
+			    || ctx->zd_op == DPLANE_OP_NH_UPDATE
+			    || ctx->zd_op == DPLANE_OP_NH_DELETE)
+				atomic_fetch_add_explicit(
+					&zdplane_info.dg_nexthop_errors, 1,
+					memory_order_relaxed);
+			else
+				atomic_fetch_add_explicit(
+					&zdplane_info.dg_route_errors, 1,
+					memory_order_relaxed);
+		}
 
-		ctx = dplane_provider_dequeue_in_ctx(prov);
-		if (ctx == NULL)
-			break;
+		if (prov)
+			dplane_provider_enqueue_out_ctx(prov, ctx);
+		else
+			TAILQ_INSERT_TAIL(&done_list, ctx, zd_q_entries);
+	}
+
+	TAILQ_CONCAT(ctx_list, &done_list, zd_q_entries);
+}
+
+/*
+ * Pick the worker for a context. Only route updates are spread out, by
+ * prefix, so that the updates for any one prefix are still applied in
+ * order. Everything else returns false and is handled as a barrier.
+ */
+static bool kernel_dplane_ctx_shard(const struct zebra_dplane_ctx *ctx,
+				    uint8_t *shard)
+{
+	uint32_t key;
+
+	if (dplane_ctx_is_skip_kernel(ctx))
+		return false;
+
+	switch (ctx->zd_op) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		break;
+	default:
+		return false;
+	}
+
+	key = jhash_1word(ctx->zd_table_id,
+			  prefix_hash_key(&ctx->u.rinfo.zd_dest));
+	*shard = key % (zdplane_info.dg_nworkers + 1);
+
+	return true;
+}
+
+/*
+ * Process this worker's share of the current batch. Runs on the dplane
+ * pthread for worker 0, and on the worker's own pthread otherwise.
+ */
+static void dplane_worker_process(struct dplane_worker *w)
+{
+	struct dplane_ctx_q work_list;
+	struct zebra_dplane_ctx *ctx;
+	struct timeval start;
+	uint32_t i, count = 0, high;
+
+	TAILQ_INIT(&work_list);
+	monotime(&start);
+
+	for (i = zdplane_info.dg_batch_start; i < zdplane_info.dg_batch_end;
+	     i++) {
+		if (zdplane_info.dg_batch_shard[i] != w->dw_id)
+			continue;
 
-		/* A previous provider plugin may have asked to skip the
-		 * kernel update.
+		ctx = zdplane_info.dg_batch[i];
+
+#if defined(HAVE_NETLINK)
+		/* Use this worker's own socket, but keep the sequence
+		 * number assigned when the context was built.
 		 */
-		if (dplane_ctx_is_skip_kernel(ctx)) {
-			res = ZEBRA_DPLANE_REQUEST_SUCCESS;
-			goto skip_one;
+		if (w->dw_id && ctx->zd_ns_info.nls_workers) {
+			int seq = ctx->zd_ns_info.nls.seq;
+
+			ctx->zd_ns_info.nls =
+				ctx->zd_ns_info.nls_workers[w->dw_id - 1];
+			ctx->zd_ns_info.nls.seq = seq;
 		}
+#endif
 
-		/* Dispatch to appropriate kernel-facing apis */
-		switch (dplane_ctx_get_op(ctx)) {
+		dplane_ctx_enqueue_tail(&work_list, ctx);
+		count++;
+	}
 
-		case DPLANE_OP_ROUTE_INSTALL:
-		case DPLANE_OP_ROUTE_UPDATE:
-		case DPLANE_OP_ROUTE_DELETE:
-			res = kernel_dplane_route_update(ctx);
-			break;
+	/* All route updates, so they can go to the kernel as one batch */
+	if (count)
+		kernel_dplane_update_multi(&work_list, NULL);
 
-		case DPLANE_OP_NH_INSTALL:
-		case DPLANE_OP_NH_UPDATE:
-		case DPLANE_OP_NH_DELETE:
-			res = kernel_dplane_nexthop_update(ctx);
-			break;
+	atomic_fetch_add_explicit(&w->dw_updates, count,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->dw_batches, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->dw_usecs, monotime_since(&start, NULL),
+				  memory_order_relaxed);
+	high = atomic_load_explicit(&w->dw_max_batch, memory_order_relaxed);
+	if (count > high)
+		atomic_store_explicit(&w->dw_max_batch, count,
+				      memory_order_relaxed);
+}
 
-		case DPLANE_OP_LSP_INSTALL:
-		case DPLANE_OP_LSP_UPDATE:
-		case DPLANE_OP_LSP_DELETE:
-			res = kernel_dplane_lsp_update(ctx);
-			break;
+/*
+ * Event handler on a worker pthread
+ */
+static int dplane_worker_run(struct thread *event)
+{
+	struct dplane_worker *w = THREAD_ARG(event);
 
-		case DPLANE_OP_PW_INSTALL:
-		case DPLANE_OP_PW_UNINSTALL:
-			res = kernel_dplane_pw_update(ctx);
-			break;
+	dplane_worker_process(w);
 
-		case DPLANE_OP_ADDR_INSTALL:
-		case DPLANE_OP_ADDR_UNINSTALL:
-			res = kernel_dplane_address_update(ctx);
-			break;
+	frr_with_mutex(&zdplane_info.dg_worker_mutex) {
+		if (--zdplane_info.dg_workers_pending == 0)
+			pthread_cond_signal(&zdplane_info.dg_worker_cond);
+	}
 
-		case DPLANE_OP_MAC_INSTALL:
-		case DPLANE_OP_MAC_DELETE:
-			res = kernel_dplane_mac_update(ctx);
-			break;
+	return 0;
+}
 
-		case DPLANE_OP_NEIGH_INSTALL:
-		case DPLANE_OP_NEIGH_UPDATE:
-		case DPLANE_OP_NEIGH_DELETE:
-		case DPLANE_OP_VTEP_ADD:
-		case DPLANE_OP_VTEP_DELETE:
-			res = kernel_dplane_neigh_update(ctx);
-			break;
+/*
+ * Program the route updates in [start, end) of the current batch, spread
+ * over all workers, and wait for them to finish.
+ */
+static void dplane_workers_run(uint32_t start, uint32_t end)
+{
+	uint32_t i;
 
-		/* Ignore 'notifications' - no-op */
-		case DPLANE_OP_SYS_ROUTE_ADD:
-		case DPLANE_OP_SYS_ROUTE_DELETE:
-		case DPLANE_OP_ROUTE_NOTIFY:
-		case DPLANE_OP_LSP_NOTIFY:
-			res = ZEBRA_DPLANE_REQUEST_SUCCESS;
-			break;
+	zdplane_info.dg_batch_start = start;
+	zdplane_info.dg_batch_end = end;
 
-		default:
-			atomic_fetch_add_explicit(
-				&zdplane_info.dg_other_errors, 1,
-				memory_order_relaxed);
+	/* Not worth a round-trip through the workers */
+	if (end - start < DPLANE_WORKER_MIN_BATCH) {
+		for (i = start; i < end; i++)
+			zdplane_info.dg_batch_shard[i] = 0;
 
-			res = ZEBRA_DPLANE_REQUEST_FAILURE;
-			break;
-		}
+		dplane_worker_process(&zdplane_info.dg_workers[0]);
+		return;
+	}
 
-skip_one:
-		dplane_ctx_set_status(ctx, res);
+	frr_with_mutex(&zdplane_info.dg_worker_mutex) {
+		zdplane_info.dg_workers_pending = zdplane_info.dg_nworkers;
+	}
 
-		dplane_provider_enqueue_out_ctx(prov, ctx);
+	for (i = 1; i <= zdplane_info.dg_nworkers; i++)
+		thread_add_event(zdplane_info.dg_workers[i].dw_pthread->master,
+				 dplane_worker_run, &zdplane_info.dg_workers[i],
+				 0, NULL);
+
+	dplane_worker_process(&zdplane_info.dg_workers[0]);
+
+	frr_with_mutex(&zdplane_info.dg_worker_mutex) {
+		while (zdplane_info.dg_workers_pending)
+			pthread_cond_wait(&zdplane_info.dg_worker_cond,
+					  &zdplane_info.dg_worker_mutex);
+	}
+}
+
+/*
+ * Kernel provider work loop when there are worker pthreads. Runs of
+ * consecutive route updates are programmed in parallel; any other
+ * update (nexthop groups in particular, which routes may refer to) is
+ * programmed by the dplane pthread alone once all route updates before
+ * it are done. Results are handed on in the original order.
+ */
+static int kernel_dplane_process_workers(struct zebra_dplane_provider *prov)
+{
+	struct dplane_ctx_q work_list;
+	struct zebra_dplane_ctx *ctx;
+	uint32_t count = 0, start = 0, i;
+
+	TAILQ_INIT(&work_list);
+	dplane_provider_dequeue_in_list(prov, &work_list);
+
+	while ((ctx = TAILQ_FIRST(&work_list)) != NULL) {
+		TAILQ_REMOVE(&work_list, ctx, zd_q_entries);
+		zdplane_info.dg_batch[count++] = ctx;
+	}
+
+	for (i = 0; i <= count; i++) {
+		if (i < count
+		    && kernel_dplane_ctx_shard(zdplane_info.dg_batch[i],
+					       &zdplane_info.dg_batch_shard[i]))
+			continue;
+
+		if (i > start)
+			dplane_workers_run(start, i);
+
+		if (i < count)
+			kernel_dplane_process_ctx(zdplane_info.dg_batch[i]);
+
+		start = i + 1;
+	}
+
+	for (i = 0; i < count; i++)
+		dplane_provider_enqueue_out_ctx(prov, zdplane_info.dg_batch[i]);
+
+	return count;
+}
+
+/*
+ * Kernel provider callback
+ */
+static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
+{
+	struct dplane_ctx_q multi_list;
+	struct zebra_dplane_ctx *ctx;
+	int counter, limit;
+
+	limit = dplane_provider_get_work_limit(prov);
+
+	if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
+		zlog_debug("dplane provider '%s': processing",
+			   dplane_provider_get_name(prov));
+
+	TAILQ_INIT(&multi_list);
+
+	if (zdplane_info.dg_nworkers) {
+		counter = kernel_dplane_process_workers(prov);
+	} else {
+		for (counter = 0; counter < limit; counter++) {
+
+			ctx = dplane_provider_dequeue_in_ctx(prov);
+			if (ctx == NULL)
+				break;
+
+			/* Collect runs of route and nexthop updates */
+			if (kernel_dplane_ctx_is_multi(ctx)) {
+				TAILQ_INSERT_TAIL(&multi_list, ctx,
+						  zd_q_entries);
+				continue;
+			}
+
+			if (!TAILQ_EMPTY(&multi_list))
+				kernel_dplane_update_multi(&multi_list, prov);
+
+			kernel_dplane_process_ctx(ctx);
+
+			dplane_provider_enqueue_out_ctx(prov, ctx);
+		}
+
+		if (!TAILQ_EMPTY(&multi_list))
+			kernel_dplane_update_multi(&multi_list, prov);
 	}
 
 	/* Ensure that we'll run the work loop again if there's still
@@ -3519,7 +3884,7 @@ static void dplane_provider_init(void)
 				       DPLANE_PROV_FLAGS_DEFAULT, NULL,
 				       kernel_dplane_process_func,
 				       NULL,
-				       NULL, NULL);
+				       NULL, &zdplane_info.dg_kernel_prov);
 
 	if (ret != AOK)
 		zlog_err("Unable to register kernel dplane provider: %d",
@@ -3881,6 +4246,9 @@ void zebra_dplane_shutdown(void)
 	zdplane_info.dg_pthread = NULL;
 	zdplane_info.dg_master = NULL;
 
+	/* The dplane pthread was the only user of the workers */
+	dplane_workers_stop();
+
 	/* TODO -- Notify provider(s) of final shutdown */
 
 	/* TODO -- Clean-up provider objects */
@@ -3896,6 +4264,8 @@ static void zebra_dplane_init_internal(void)
 	memset(&zdplane_info, 0, sizeof(zdplane_info));
 
 	pthread_mutex_init(&zdplane_info.dg_mutex, NULL);
+	pthread_mutex_init(&zdplane_info.dg_worker_mutex, NULL);
+	pthread_cond_init(&zdplane_info.dg_worker_cond, NULL);
 
 	TAILQ_INIT(&zdplane_info.dg_update_ctx_q);
 	TAILQ_INIT(&zdplane_info.dg_providers_q);
@@ -3908,6 +4278,69 @@ static void zebra_dplane_init_internal(void)
 	dplane_provider_init();
 }
 
+/*
+ * Start the worker pthreads that share kernel programming with the dplane
+ * pthread, if any were asked for at startup.
+ */
+static void dplane_workers_start(void)
+{
+	struct frr_pthread_attr pattr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop
+	};
+	struct dplane_worker *w;
+	char name[64];
+	char os_name[OS_THREAD_NAMELEN];
+	uint32_t i;
+
+#if defined(HAVE_NETLINK)
+	zdplane_info.dg_nworkers = MIN(zrouter.dplane_workers,
+				       DPLANE_WORKERS_MAX);
+#endif
+
+	for (i = 0; i <= zdplane_info.dg_nworkers; i++)
+		zdplane_info.dg_workers[i].dw_id = i;
+
+	if (zdplane_info.dg_nworkers == 0)
+		return;
+
+	zdplane_info.dg_batch = XCALLOC(
+		MTYPE_DP_BATCH, sizeof(*zdplane_info.dg_batch)
+					* zdplane_info.dg_updates_per_cycle);
+	zdplane_info.dg_batch_shard = XCALLOC(
+		MTYPE_DP_BATCH, sizeof(*zdplane_info.dg_batch_shard)
+					* zdplane_info.dg_updates_per_cycle);
+
+	for (i = 1; i <= zdplane_info.dg_nworkers; i++) {
+		w = &zdplane_info.dg_workers[i];
+
+		snprintf(name, sizeof(name), "Zebra dplane worker %u", i);
+		snprintf(os_name, sizeof(os_name), "zebra_dplane%u", i);
+
+		w->dw_pthread = frr_pthread_new(&pattr, name, os_name);
+		frr_pthread_run(w->dw_pthread, NULL);
+	}
+}
+
+static void dplane_workers_stop(void)
+{
+	struct dplane_worker *w;
+	uint32_t i;
+
+	for (i = 1; i <= zdplane_info.dg_nworkers; i++) {
+		w = &zdplane_info.dg_workers[i];
+
+		frr_pthread_stop(w->dw_pthread, NULL);
+		frr_pthread_destroy(w->dw_pthread);
+		w->dw_pthread = NULL;
+	}
+
+	zdplane_info.dg_nworkers = 0;
+
+	XFREE(MTYPE_DP_BATCH, zdplane_info.dg_batch);
+	XFREE(MTYPE_DP_BATCH, zdplane_info.dg_batch_shard);
+}
+
 /*
  * Start the dataplane pthread. This step needs to be run later than the
  * 'init' step, in case zebra has fork-ed.
@@ -3927,6 +4360,8 @@ void zebra_dplane_start(void)
 
 	zdplane_info.dg_master = zdplane_info.dg_pthread->master;
 
+	dplane_workers_start();
+
 	zdplane_info.dg_run = true;
 
 	/* Enqueue an initial event for the dataplane pthread */
@@ -43,6 +43,8 @@ struct zebra_dplane_info {
 #if defined(HAVE_NETLINK)
 	struct nlsock nls;
 	bool is_cmd;
+	/* dataplane channels of the dplane workers, if any */
+	const struct nlsock *nls_workers;
 #endif
 };
 
@@ -55,6 +57,7 @@ zebra_dplane_info_from_zns(struct zebra_dplane_info *zns_info,
 
 #if defined(HAVE_NETLINK)
 	zns_info->is_cmd = is_cmd;
+	zns_info->nls_workers = NULL;
 	if (is_cmd) {
 		zns_info->nls = zns->netlink_cmd;
 	} else {
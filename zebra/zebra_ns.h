@@ -42,6 +42,11 @@ struct nlsock {
 };
 #endif
 
+/* Upper bound on the number of dplane worker pthreads; each of them has its
+ * own dataplane channel in every namespace.
+ */
+#define DPLANE_WORKERS_MAX 16
+
 struct zebra_ns {
 	/* net-ns name.  */
 	char name[VRF_NAMSIZ];
@@ -53,6 +58,8 @@ struct zebra_ns {
 	struct nlsock netlink;        /* kernel messages */
 	struct nlsock netlink_cmd;    /* command channel */
 	struct nlsock netlink_dplane; /* dataplane channel */
+	/* dataplane channels of the dplane worker pthreads */
+	struct nlsock netlink_dplane_workers[DPLANE_WORKERS_MAX];
 	struct thread *t_netlink;
 #endif
 
@@ -617,8 +617,12 @@ static int rib_can_delete_dest(rib_dest_t *dest)
 void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq)
 {
 	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	const struct prefix *changed;
 	struct rnh *rnh;
 
+	srcdest_rnode_prefixes(rn, &changed, NULL);
+	zebra_rnh_stats.route_changes++;
+
 	/*
 	 * We are storing the rnh's associated withb
 	 * the tracked nexthop as a list of the rn's.
@@ -626,7 +630,9 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq)
 	 * of the tree list.( 0.0.0.0/0 for v4 and 0::0/0 for v6 )
 	 * As such for each rn we need to walk up the tree
 	 * and see if any rnh's need to see if they
-	 * would match a more specific route
+	 * would match a more specific route.
+	 * Only the ones within the changed prefix can, the
+	 * resolution of the others does not depend on it.
 	 */
 	while (rn) {
 		if (IS_ZEBRA_DEBUG_NHT_DETAILED) {
@@ -688,7 +694,13 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq)
 				continue;
 			}
 
+			if (!prefix_match(changed, p)) {
+				zebra_rnh_stats.change_skips++;
+				continue;
+			}
+
 			rnh->seqno = seq;
+			zebra_rnh_stats.change_evals++;
 			zebra_evaluate_rnh(zvrf, family2afi(p->family), 0,
 					   rnh->type, p);
 		}
@@ -62,6 +62,8 @@ static int send_client(struct rnh *rnh, struct zserv *client, rnh_type_t type,
 static void print_rnh(struct route_node *rn, struct vty *vty);
 static int zebra_client_cleanup_rnh(struct zserv *client);
 
+struct zebra_rnh_stats zebra_rnh_stats;
+
 void zebra_rnh_init(void)
 {
 	hook_register(zserv_client_close, zebra_client_cleanup_rnh);
@@ -802,10 +804,11 @@ static void zebra_rnh_eval_nexthop_entry(struct zebra_vrf *zvrf, afi_t afi,
 	}
 }
 
-/* Evaluate one tracked entry */
-static void zebra_rnh_evaluate_entry(struct zebra_vrf *zvrf, afi_t afi,
-				     int force, rnh_type_t type,
-				     struct route_node *nrn)
+/* Evaluate one tracked entry, returns the route entry resolving it */
+static struct route_entry *zebra_rnh_evaluate_entry(struct zebra_vrf *zvrf,
+						    afi_t afi, int force,
+						    rnh_type_t type,
+						    struct route_node *nrn)
 {
 	struct rnh *rnh;
 	struct route_entry *re;
@@ -819,6 +822,7 @@ static void zebra_rnh_evaluate_entry(struct zebra_vrf *zvrf, afi_t afi,
 	}
 
 	rnh = nrn->info;
+	zebra_rnh_stats.evals++;
 
 	/* Identify route entry (RE) resolving this tracked entry. */
 	if (type == RNH_IMPORT_CHECK_TYPE)
@@ -830,7 +834,7 @@ static void zebra_rnh_evaluate_entry(struct zebra_vrf *zvrf, afi_t afi,
 	 * there is nothing further to do.
 	 */
 	if (!re && rnh->state == NULL && !force)
-		return;
+		return NULL;
 
 	/* Process based on type of entry. */
 	if (type == RNH_IMPORT_CHECK_TYPE)
@@ -839,36 +843,8 @@ static void zebra_rnh_evaluate_entry(struct zebra_vrf *zvrf, afi_t afi,
 	else
 		zebra_rnh_eval_nexthop_entry(zvrf, afi, force, nrn, rnh, prn,
 					     re);
-}
-
-/*
- * Clear the ROUTE_ENTRY_NEXTHOPS_CHANGED flag
- * from the re entries.
- *
- * Please note we are doing this *after* we have
- * notified the world about each nexthop as that
- * we can have a situation where one re entry
- * covers multiple nexthops we are interested in.
- */
-static void zebra_rnh_clear_nhc_flag(struct zebra_vrf *zvrf, afi_t afi,
-				     rnh_type_t type, struct route_node *nrn)
-{
-	struct rnh *rnh;
-	struct route_entry *re;
-	struct route_node *prn;
-
-	rnh = nrn->info;
-
-	/* Identify route entry (RIB) resolving this tracked entry. */
-	if (type == RNH_IMPORT_CHECK_TYPE)
-		re = zebra_rnh_resolve_import_entry(zvrf, afi, nrn, rnh,
-						    &prn);
-	else
-		re = zebra_rnh_resolve_nexthop_entry(zvrf, afi, nrn, rnh,
-						     &prn);
 
-	if (re)
-		UNSET_FLAG(re->status, ROUTE_ENTRY_LABELS_CHANGED);
+	return re;
 }
 
 /* Evaluate all tracked entries (nexthops or routes for import into BGP)
@@ -893,23 +869,66 @@ void zebra_evaluate_rnh(struct zebra_vrf *zvrf, afi_t afi, int force,
 		if (nrn)
 			route_unlock_node(nrn);
 	} else {
+		struct list *nhc = NULL;
+		struct listnode *node;
+		struct route_entry *re;
+
+		zebra_rnh_stats.table_walks++;
+
 		/* Evaluate entire table. */
 		nrn = route_top(rnh_table);
 		while (nrn) {
-			if (nrn->info)
-				zebra_rnh_evaluate_entry(zvrf, afi, force, type,
-							 nrn);
+			if (nrn->info) {
+				re = zebra_rnh_evaluate_entry(zvrf, afi, force,
+							      type, nrn);
+				if (re
+				    && CHECK_FLAG(re->status,
+						  ROUTE_ENTRY_LABELS_CHANGED)) {
+					if (!nhc)
+						nhc = list_new();
+					listnode_add(nhc, re);
+				}
+			}
 			nrn = route_next(nrn); /* this will also unlock nrn */
 		}
-		nrn = route_top(rnh_table);
-		while (nrn) {
-			if (nrn->info)
-				zebra_rnh_clear_nhc_flag(zvrf, afi, type, nrn);
-			nrn = route_next(nrn); /* this will also unlock nrn */
+
+		/*
+		 * Clear the ROUTE_ENTRY_LABELS_CHANGED flag from the resolving
+		 * re entries only *after* we have notified the world about
+		 * each nexthop, as one re entry can cover multiple nexthops
+		 * we are interested in.  Nothing changed in the RIB since, so
+		 * these are the same entries another lookup would find.
+		 */
+		if (nhc) {
+			for (ALL_LIST_ELEMENTS_RO(nhc, node, re))
+				UNSET_FLAG(re->status,
+					   ROUTE_ENTRY_LABELS_CHANGED);
+			list_delete(&nhc);
 		}
 	}
 }
 
+void zebra_rnh_stats_show(struct vty *vty)
+{
+	struct zebra_rnh_stats *stats = &zebra_rnh_stats;
+
+	vty_out(vty, "Route changes checked: %" PRIu64 "\n",
+		stats->route_changes);
+	vty_out(vty,
+		"  Dependents evaluated: %" PRIu64 " (%.2f per change)\n",
+		stats->change_evals,
+		stats->route_changes ? (double)stats->change_evals
+					       / stats->route_changes
+				     : 0.0);
+	vty_out(vty, "  Dependents skipped: %" PRIu64 "\n",
+		stats->change_skips);
+	vty_out(vty, "Full table evaluations: %" PRIu64 "\n",
+		stats->table_walks);
+	vty_out(vty, "Total evaluations: %" PRIu64 "\n", stats->evals);
+	vty_out(vty, "Client notifications: %" PRIu64 "\n",
+		stats->notifications);
+}
+
 void zebra_print_rnh_table(vrf_id_t vrfid, afi_t afi, struct vty *vty,
 			   rnh_type_t type, struct prefix *p)
 {
@@ -1061,6 +1080,7 @@ static int send_client(struct rnh *rnh, struct zserv *client, rnh_type_t type,
 
 	client->nh_last_upd_time = monotime(NULL);
 	client->last_write_cmd = cmd;
+	zebra_rnh_stats.notifications++;
 	return zserv_send_message(client, s);
 }
 
@@ -31,6 +31,25 @@ extern "C" {
 
 extern void zebra_rnh_init(void);
 
+/* Nexthop tracking work counters, see "show zebra nht statistics". */
+struct zebra_rnh_stats {
+	/* route nodes whose change was checked for dependent nexthops */
+	uint64_t route_changes;
+	/* tracked entries re-evaluated because of those changes */
+	uint64_t change_evals;
+	/* dependents of a less specific route not covered by the change */
+	uint64_t change_skips;
+	/* whole table evaluations, after configuration changes */
+	uint64_t table_walks;
+	/* all evaluations of a tracked entry, whatever the reason */
+	uint64_t evals;
+	/* updates sent to clients */
+	uint64_t notifications;
+};
+
+extern struct zebra_rnh_stats zebra_rnh_stats;
+extern void zebra_rnh_stats_show(struct vty *vty);
+
 static inline const char *rnh_type2str(rnh_type_t type)
 {
 	switch (type) {
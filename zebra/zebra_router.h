@@ -163,6 +163,11 @@ struct zebra_router {
 
 	uint32_t multipath_num;
 
+	/* Number of dplane worker pthreads sharing kernel route programming,
+	 * fixed at startup.  0 means the dplane pthread does it all.
+	 */
+	uint32_t dplane_workers;
+
 	/* RPF Lookup behavior */
 	enum multicast_mode ipv4_multicast_mode;
 
@@ -54,6 +54,7 @@
 #include "zebra/zebra_pbr.h"
 #include "zebra/zebra_nhg.h"
 #include "zebra/interface.h"
+#include "zebra/kernel_netlink.h"
 
 extern int allow_delete;
 
@@ -1088,6 +1089,18 @@ DEFPY (show_ip_nht,
 	return CMD_SUCCESS;
 }
 
+DEFUN (show_zebra_nht_statistics,
+       show_zebra_nht_statistics_cmd,
+       "show zebra nht statistics",
+       SHOW_STR
+       ZEBRA_STR
+       "Nexthop tracking\n"
+       "Nexthop tracking work counters\n")
+{
+	zebra_rnh_stats_show(vty);
+	return CMD_SUCCESS;
+}
+
 DEFUN (ip_nht_default_route,
        ip_nht_default_route_cmd,
        "ip nht resolve-via-default",
@@ -3151,6 +3164,10 @@ static int config_write_protocol(struct vty *vty)
 	if (!zebra_nhg_kernel_nexthops_enabled())
 		vty_out(vty, "no zebra nexthop kernel enable\n");
 
+#ifdef HAVE_NETLINK
+	netlink_batch_config_write(vty);
+#endif
+
 	return 1;
 }
 
@@ -3380,6 +3397,63 @@ DEFUN (no_zebra_dplane_queue_limit,
 	return CMD_SUCCESS;
 }
 
+#ifdef HAVE_NETLINK
+DEFUN (zebra_kernel_netlink_batching,
+       zebra_kernel_netlink_batching_cmd,
+       "[no] zebra kernel netlink batching",
+       NO_STR
+       ZEBRA_STR
+       "Zebra kernel interface\n"
+       "Set Netlink parameters\n"
+       "Send route and nexthop updates to the kernel in batches\n")
+{
+	netlink_set_batching(strcmp(argv[0]->text, "no") != 0);
+
+	return CMD_SUCCESS;
+}
+
+DEFUN (zebra_kernel_netlink_batch_tx_buf,
+       zebra_kernel_netlink_batch_tx_buf_cmd,
+       "zebra kernel netlink batch-tx-buf (8192-1048576) (1-1048576)",
+       ZEBRA_STR
+       "Zebra kernel interface\n"
+       "Set Netlink parameters\n"
+       "Set batch buffer size and send threshold\n"
+       "Size of the buffer\n"
+       "Send threshold\n")
+{
+	uint32_t bufsize = 0, threshold = 0;
+
+	bufsize = strtoul(argv[4]->arg, NULL, 10);
+	threshold = strtoul(argv[5]->arg, NULL, 10);
+
+	if (threshold > bufsize) {
+		vty_out(vty,
+			"%% Send threshold cannot be larger than the buffer\n");
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+
+	netlink_set_batch_buffer_size(bufsize, threshold, true);
+
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_zebra_kernel_netlink_batch_tx_buf,
+       no_zebra_kernel_netlink_batch_tx_buf_cmd,
+       "no zebra kernel netlink batch-tx-buf [(0-1048576)] [(0-1048576)]",
+       NO_STR ZEBRA_STR
+       "Zebra kernel interface\n"
+       "Set Netlink parameters\n"
+       "Set batch buffer size and send threshold\n"
+       "Size of the buffer\n"
+       "Send threshold\n")
+{
+	netlink_set_batch_buffer_size(0, 0, false);
+
+	return CMD_SUCCESS;
+}
+#endif /* HAVE_NETLINK */
+
 DEFUN (zebra_show_routing_tables_summary,
        zebra_show_routing_tables_summary_cmd,
        "show zebra router table summary",
@@ -3533,6 +3607,7 @@ void zebra_vty_init(void)
 	install_element(VIEW_NODE, &show_route_detail_cmd);
 	install_element(VIEW_NODE, &show_route_summary_cmd);
 	install_element(VIEW_NODE, &show_ip_nht_cmd);
+	install_element(VIEW_NODE, &show_zebra_nht_statistics_cmd);
 
 	install_element(VIEW_NODE, &show_ip_rpf_cmd);
 	install_element(VIEW_NODE, &show_ip_rpf_addr_cmd);
@@ -3590,6 +3665,11 @@ void zebra_vty_init(void)
 	install_element(VIEW_NODE, &show_dataplane_providers_cmd);
 	install_element(CONFIG_NODE, &zebra_dplane_queue_limit_cmd);
 	install_element(CONFIG_NODE, &no_zebra_dplane_queue_limit_cmd);
+#ifdef HAVE_NETLINK
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_batching_cmd);
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_tx_buf_cmd);
+	install_element(CONFIG_NODE, &no_zebra_kernel_netlink_batch_tx_buf_cmd);
+#endif
 
 	install_element(VIEW_NODE, &zebra_show_routing_tables_summary_cmd);
 }